@@ -86,6 +86,7 @@ bool FCDAnimated::AddCurve(size_t index, FCDAnimationCurve* curve)
 	FUAssert(index < GetValueCount(), return false);
 	curves.at(index).push_back(curve);
 	SetNewChildFlag();
+	GetDocument()->UpdateAnimationRevision();
 	return true;
 }
 
@@ -94,6 +95,7 @@ bool FCDAnimated::AddCurve(size_t index, FCDAnimationCurveList& curve)
 	FUAssert(index < GetValueCount() && !curve.empty(), return false);
 	curves.at(index).insert(curves.at(index).end(), curve.begin(), curve.end());
 	SetNewChildFlag();
+	GetDocument()->UpdateAnimationRevision();
 	return true;
 }
 
@@ -104,9 +106,24 @@ bool FCDAnimated::RemoveCurve(size_t index)
 	bool hasCurve = !curves[index].empty();
 	curves[index].clear();
 	SetNewChildFlag();
+	GetDocument()->UpdateAnimationRevision();
 	return hasCurve;
 }
 
+FCDAnimationCurveListList& FCDAnimated::GetCurves()
+{
+	// The caller may modify the curve lists.
+	GetDocument()->UpdateAnimationRevision();
+	return curves;
+}
+
+void FCDAnimated::SetValue(size_t index, float* value)
+{
+	FUAssert(index < GetValueCount(), return);
+	values.at(index) = value;
+	GetDocument()->UpdateAnimationRevision();
+}
+
 const fm::string& FCDAnimated::GetQualifier(size_t index) const
 {
 	FUAssert(index < GetValueCount(), return emptyString);
@@ -282,6 +299,7 @@ FCDAnimated* FCDAnimated::Clone(FCDAnimated* clone) const
 			clone->qualifiers[i] = qualifiers[i];
 			clone->curves[i] = curves[i];
 		}
+		clone->GetDocument()->UpdateAnimationRevision();
 	}
 	return clone;
 }
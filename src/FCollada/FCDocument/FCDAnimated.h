@@ -123,8 +123,9 @@ public:
 
 	/** Retrieves the list of the curves affecting the values of an animated element.
 		This list may contain the nullptr pointer, where a value is not animated.
+		Retrieving the modifiable list invalidates the animation program of the document.
 		@return The list of animation curves. */
-	inline FCDAnimationCurveListList& GetCurves() { return curves; }
+	FCDAnimationCurveListList& GetCurves();
 	inline const FCDAnimationCurveListList& GetCurves() const { return curves; } /**< See above. */
 
 	/** Assigns a curve to a value of the animated element.
@@ -153,7 +154,7 @@ public:
 		Used when changing the list size within FCDParameterAnimatableList.
 		@param index The value index.
 		@param value The new value pointer for this index. */
-	inline void SetValue(size_t index, float* value) { FUAssert(index < GetValueCount(), return); values.at(index) = value; }
+	void SetValue(size_t index, float* value);
 
 	/** Retrieves the qualifier of the value of an animated element.
 		@param index The value index.
@@ -13,6 +13,7 @@
 */
 
 #include "StdAfx.h"
+#include "FCDocument/FCDocument.h"
 #include "FCDocument/FCDAnimated.h"
 #include "FCDocument/FCDAnimationCurve.h"
 #include "FCDocument/FCDAnimationClip.h"
@@ -34,6 +35,11 @@ float FindT(float cp0x, float cp1x, float cp2x, float cp3x, float input, float i
 	float highT = 1.0f;
 	float lowT = 0.0f;
 
+	// The initial guess is exact when the control points are evenly spaced, as they are for the reduced curves.
+	float guessTi = 1.0f - initialGuess;
+	float guessTime = cp0x*guessTi*guessTi*guessTi + 3*cp1x*initialGuess*guessTi*guessTi + 3*cp2x*initialGuess*initialGuess*guessTi + cp3x*initialGuess*initialGuess*initialGuess;
+	if (fabsf(guessTime - input) <= localTolerance) return initialGuess;
+
 	//Optimize here, start with a more intuitive value than 0.5
 	float midT = 0.5f;
 	if (initialGuess <= 0.1) midT = 0.1f; //clamp to 10% or 90%, because if miss, the cost is too high.
@@ -93,6 +99,21 @@ static void ComputeTCBTangent(const FCDAnimationKey* previousKey, const FCDAnima
 	rightTangent.y = k3 * pCurrentMinusPrevious.y + k4 * pNextMinusCurrent.y;
 }
 
+// The key classes, by interpolation type: the simple keys, the Bezier keys and the TCB keys.
+static const size_t keyClassSizes[3] = { sizeof(FCDAnimationKey), sizeof(FCDAnimationKeyBezier), sizeof(FCDAnimationKeyTCB) };
+static const size_t minimumKeyBlockSize = 256;
+static const size_t maximumKeyBlockGrowth = 16384;
+
+static inline size_t GetKeyClass(uint32 interpolation)
+{
+	switch (interpolation)
+	{
+	case FUDaeInterpolation::BEZIER: return 1;
+	case FUDaeInterpolation::TCB: return 2;
+	default: return 0;
+	}
+}
+
 //
 // FCDAnimationCurve
 //
@@ -103,6 +124,7 @@ FCDAnimationCurve::FCDAnimationCurve(FCDocument* document, FCDAnimationChannel*
  :	FCDObject(document), parent(_parent),
 	targetElement(-1),
 	preInfinity(FUDaeInfinity::CONSTANT), postInfinity(FUDaeInfinity::CONSTANT),
+	keyBlockUsed(0), keyBlockCapacity(0), packedKeySize(0),
 	inputDriver(nullptr), inputDriverIndex(0)
 {
 	currentClip = nullptr;
@@ -111,12 +133,81 @@ FCDAnimationCurve::FCDAnimationCurve(FCDocument* document, FCDAnimationChannel*
 
 FCDAnimationCurve::~FCDAnimationCurve()
 {
-	CLEAR_POINTER_VECTOR(keys);
+	// The keys have no destructors: releasing their blocks is enough.
+	keys.clear();
+	for (size_t i = 0; i < 3; ++i) freeKeys[i].clear();
+	for (fm::pvector<uint8>::iterator it = keyBlocks.begin(); it != keyBlocks.end(); ++it) fm::Release(*it);
+	keyBlocks.clear();
 
 	inputDriver = nullptr;
 	parent = nullptr;
 	clips.clear();
 	clipOffsets.clear();
+
+	// The animated values forget this curve: their animation program must too.
+	GetDocument()->UpdateAnimationRevision();
+}
+
+void FCDAnimationCurve::ReserveKeyStorage(size_t byteCount)
+{
+	if (keyBlockCapacity - keyBlockUsed >= byteCount) return;
+
+	// Grow the blocks geometrically, up to a limit, to bound the unused tail of the last block.
+	size_t capacity = min(max(keyBlockCapacity * 2, minimumKeyBlockSize), maximumKeyBlockGrowth);
+	capacity = max(capacity, byteCount);
+	uint8* block = (uint8*) fm::Allocate(capacity);
+	FUAssert(block != nullptr, return);
+	keyBlocks.push_back(block);
+	keyBlockUsed = 0;
+	keyBlockCapacity = capacity;
+}
+
+FCDAnimationKey* FCDAnimationCurve::NewKey(FUDaeInterpolation::Interpolation interpolation)
+{
+	size_t keyClass = GetKeyClass((uint32) interpolation);
+	FCDAnimationKey* key;
+	if (!freeKeys[keyClass].empty())
+	{
+		key = freeKeys[keyClass].back();
+		freeKeys[keyClass].pop_back();
+	}
+	else
+	{
+		ReserveKeyStorage(keyClassSizes[keyClass]);
+		key = (FCDAnimationKey*) (keyBlocks.back() + keyBlockUsed);
+		keyBlockUsed += keyClassSizes[keyClass];
+	}
+
+	switch (keyClass)
+	{
+	case 1: fm::Construct((FCDAnimationKeyBezier*) key); break;
+	case 2: fm::Construct((FCDAnimationKeyTCB*) key); break;
+	default: fm::Construct(key); break;
+	}
+	key->interpolation = (uint32) interpolation;
+	return key;
+}
+
+void FCDAnimationCurve::InsertKey(size_t index, FCDAnimationKey* key)
+{
+	// The keys stay packed while each new key of the same class is appended right after the last key.
+	size_t keySize = keyClassSizes[GetKeyClass(key->interpolation)];
+	if (keys.empty()) packedKeySize = keySize;
+	else if (index != keys.size() || keySize != packedKeySize || (uint8*) key != ((uint8*) keys.back()) + keySize) packedKeySize = 0;
+
+	if (index == keys.size()) keys.push_back(key);
+	else keys.insert(keys.begin() + index, key);
+}
+
+void FCDAnimationCurve::ReleaseKey(FCDAnimationKey* key)
+{
+	freeKeys[GetKeyClass(key->interpolation)].push_back(key);
+}
+
+void FCDAnimationCurve::ReserveKeys(size_t count, FUDaeInterpolation::Interpolation interpolation)
+{
+	keys.reserve(keys.size() + count);
+	ReserveKeyStorage(count * keyClassSizes[GetKeyClass((uint32) interpolation)]);
 }
 
 void FCDAnimationCurve::SetKeyCount(size_t count, FUDaeInterpolation::Interpolation interpolation)
@@ -124,12 +215,21 @@ void FCDAnimationCurve::SetKeyCount(size_t count, FUDaeInterpolation::Interpolat
 	size_t oldCount = GetKeyCount();
 	if (oldCount < count)
 	{
-		keys.reserve(count);
+		ReserveKeys(count - oldCount, interpolation);
 		for (; oldCount < count; ++oldCount) AddKey(interpolation);
 	}
+	else if (count == 0)
+	{
+		// No key is left in the blocks: release them all.
+		keys.clear();
+		for (size_t i = 0; i < 3; ++i) freeKeys[i].clear();
+		for (fm::pvector<uint8>::iterator it = keyBlocks.begin(); it != keyBlocks.end(); ++it) fm::Release(*it);
+		keyBlocks.clear();
+		keyBlockUsed = keyBlockCapacity = packedKeySize = 0;
+	}
 	else if (count < oldCount)
 	{
-		for (FCDAnimationKeyList::iterator it = keys.begin() + count; it != keys.end(); ++it) delete (*it);
+		for (FCDAnimationKeyList::iterator it = keys.begin() + count; it != keys.end(); ++it) ReleaseKey(*it);
 		keys.resize(count);
 	}
 	SetDirtyFlag();
@@ -137,17 +237,16 @@ void FCDAnimationCurve::SetKeyCount(size_t count, FUDaeInterpolation::Interpolat
 
 FCDAnimationKey* FCDAnimationCurve::AddKey(FUDaeInterpolation::Interpolation interpolation)
 {
-	FCDAnimationKey* key;
 	switch (interpolation)
 	{
-	case FUDaeInterpolation::STEP: key = new FCDAnimationKey; break;
-	case FUDaeInterpolation::LINEAR: key = new FCDAnimationKey; break;
-	case FUDaeInterpolation::BEZIER: key = new FCDAnimationKeyBezier; break;
-	case FUDaeInterpolation::TCB: key = new FCDAnimationKeyTCB; break;
-	default: FUFail(key = new FCDAnimationKey; break;);
+	case FUDaeInterpolation::STEP:
+	case FUDaeInterpolation::LINEAR:
+	case FUDaeInterpolation::BEZIER:
+	case FUDaeInterpolation::TCB: break;
+	default: FUFail(break);
 	}
-	key->interpolation = (uint32) interpolation;
-	keys.push_back(key);
+	FCDAnimationKey* key = NewKey(interpolation);
+	InsertKey(keys.size(), key);
 	SetDirtyFlag();
 	return key;
 }
@@ -156,27 +255,28 @@ FCDAnimationKey* FCDAnimationCurve::AddKey(FUDaeInterpolation::Interpolation int
 // Insert a new key into the ordered array at a certain time
 FCDAnimationKey* FCDAnimationCurve::AddKey(FUDaeInterpolation::Interpolation interpolation, float input, size_t& index)
 {
-	FCDAnimationKey* key;
 	switch (interpolation)
 	{
-	case FUDaeInterpolation::STEP: key = new FCDAnimationKey; break;
-	case FUDaeInterpolation::LINEAR: key = new FCDAnimationKey; break;
-	case FUDaeInterpolation::BEZIER: key = new FCDAnimationKeyBezier; break;
-	case FUDaeInterpolation::TCB: key = new FCDAnimationKeyTCB; break;
+	case FUDaeInterpolation::STEP:
+	case FUDaeInterpolation::LINEAR:
+	case FUDaeInterpolation::BEZIER:
+	case FUDaeInterpolation::TCB: break;
 	default: FUFail(return nullptr);
 	}
-	key->interpolation = (uint32) interpolation;
+	FCDAnimationKey* key = NewKey(interpolation);
 	key->input = input;
-	FCDAnimationKeyList::iterator insertIdx = keys.begin();
-	FCDAnimationKeyList::iterator finalIdx = keys.end();
 
-	// TODO: Not cabbage search :-)
-	for (index = 0; insertIdx != finalIdx; insertIdx++, index++)
+	// Binary search for the first key with a greater input.
+	size_t start = 0, terminate = keys.size();
+	while (start < terminate)
 	{
-		if ((*insertIdx)->input > input) break;
+		size_t middle = start + (terminate - start) / 2;
+		if (keys[middle]->input > input) terminate = middle;
+		else start = middle + 1;
 	}
+	index = start;
 
-	keys.insert(insertIdx, key);
+	InsertKey(index, key);
 	SetDirtyFlag();
 	return key;
 }
@@ -186,8 +286,9 @@ bool FCDAnimationCurve::DeleteKey(FCDAnimationKey* key)
 	FCDAnimationKeyList::iterator kitr = keys.find(key);
 	if (kitr == keys.end()) return false;
 
+	if (kitr != keys.end() - 1) packedKeySize = 0;
 	keys.erase(kitr);
-	delete key;
+	ReleaseKey(key);
 	return true;
 }
 
@@ -224,8 +325,14 @@ FCDAnimationCurve* FCDAnimationCurve::Clone(FCDAnimationCurve* clone, bool inclu
 	clone->SetTargetQualifier(targetQualifier);
 
 	// Pre-buffer the list of keys and clone them.
-	clone->keys.clear();
+	size_t byteCount = 0;
+	for (FCDAnimationKeyList::const_iterator it = keys.begin(); it != keys.end(); ++it)
+	{
+		byteCount += keyClassSizes[GetKeyClass((*it)->interpolation)];
+	}
+	clone->SetKeyCount(0, FUDaeInterpolation::DEFAULT);
 	clone->keys.reserve(keys.size());
+	clone->ReserveKeyStorage(byteCount);
 	for (FCDAnimationKeyList::const_iterator it = keys.begin(); it != keys.end(); ++it)
 	{
 		FCDAnimationKey* key = clone->AddKey((FUDaeInterpolation::Interpolation) (*it)->interpolation);
@@ -303,71 +410,56 @@ void FCDAnimationCurve::SetCurrentAnimationClip(FCDAnimationClip* clip)
 	SetDirtyFlag();
 }
 
-// Main workhorse for the animation system:
-// Evaluates the curve for a given input
-float FCDAnimationCurve::Evaluate(float input) const
+size_t FCDAnimationCurve::FindKeyIndex(float input, size_t hint) const
 {
-	// Check for empty curves and poses (curves with 1 key).
-	if (keys.size() == 0) return 0.0f;
-	if (keys.size() == 1) return keys.front()->output;
-
-	float inputStart = keys.front()->input;
-	float inputEnd = keys.back()->input;
-	float inputSpan = inputEnd - inputStart;
-	float outputStart = keys.front()->output;
-	float outputEnd = keys.back()->output;
-	float outputSpan = outputEnd - outputStart;
-
-	// Account for pre-infinity mode
-	float outputOffset = 0.0f;
-	if (input < inputStart)
+	// Sequential evaluations stay within the hinted key interval or move to the next one.
+	size_t keyCount = keys.size();
+	if (hint > 0 && hint < keyCount && keys[hint - 1]->input < input)
 	{
-		float inputDifference = inputStart - input;
-		switch (preInfinity)
-		{
-		case FUDaeInfinity::CONSTANT: return outputStart;
-		case FUDaeInfinity::LINEAR: return outputStart + inputDifference * (keys[1]->output - outputStart) / (keys[1]->input - inputStart);
-		case FUDaeInfinity::CYCLE: { float cycleCount = ceilf(inputDifference / inputSpan); input += cycleCount * inputSpan; break; }
-		case FUDaeInfinity::CYCLE_RELATIVE: { float cycleCount = ceilf(inputDifference / inputSpan); input += cycleCount * inputSpan; outputOffset -= cycleCount * outputSpan; break; }
-		case FUDaeInfinity::OSCILLATE: { float cycleCount = ceilf(inputDifference / (2.0f * inputSpan)); input += cycleCount * 2.0f * inputSpan; input = inputEnd - fabsf(input - inputEnd); break; }
-		case FUDaeInfinity::UNKNOWN: default: return outputStart;
-		}
+		if (input <= keys[hint]->input) return hint;
+		if (hint + 1 < keyCount && input <= keys[hint + 1]->input) return hint + 1;
 	}
 
-	// Account for post-infinity mode
-	else if (input >= inputEnd)
+	size_t start = 0, terminate = keyCount;
+	if (packedKeySize != 0)
 	{
-		float inputDifference = input - inputEnd;
-		switch (postInfinity)
+		// Binary search directly in the key block.
+		const uint8* packedKeys = (const uint8*) keys.front();
+		while (terminate - start > 3)
 		{
-		case FUDaeInfinity::CONSTANT: return outputEnd;
-		case FUDaeInfinity::LINEAR: return outputEnd + inputDifference * (keys[keys.size() - 2]->output - outputEnd) / (keys[keys.size() - 2]->input - inputEnd);
-		case FUDaeInfinity::CYCLE: { float cycleCount = ceilf(inputDifference / inputSpan); input -= cycleCount * inputSpan; break; }
-		case FUDaeInfinity::CYCLE_RELATIVE: { float cycleCount = ceilf(inputDifference / inputSpan); input -= cycleCount * inputSpan; outputOffset += cycleCount * outputSpan; break; }
-		case FUDaeInfinity::OSCILLATE: { float cycleCount = ceilf(inputDifference / (2.0f * inputSpan)); input -= cycleCount * 2.0f * inputSpan; input = inputStart + fabsf(input - inputStart); break; }
-		case FUDaeInfinity::UNKNOWN: default: return outputEnd;
+			size_t middle = start + (terminate - start) / 2;
+			if (((const FCDAnimationKey*) (packedKeys + middle * packedKeySize))->input > input) terminate = middle;
+			else start = middle;
+		}
+		// Linear search is more efficient on the last interval
+		for (; start != terminate; ++start)
+		{
+			if (((const FCDAnimationKey*) (packedKeys + start * packedKeySize))->input >= input) break;
 		}
 	}
-
-	// Find the current interval
-	FCDAnimationKeyList::const_iterator it, start = keys.begin(), terminate = keys.end();
-	while (terminate - start > 3)
+	else
 	{
 		// Binary search.
-		it = (const FCDAnimationKey**) ((((size_t) terminate) / 2 + ((size_t) start) / 2) & ~((sizeof(size_t)-1)));
-		if ((*it)->input > input) terminate = it;
-		else start = it;
-	}
-	// Linear search is more efficient on the last interval
-	for (it = start; it != terminate; ++it)
-	{
-		if ((*it)->input >= input) break;
+		while (terminate - start > 3)
+		{
+			size_t middle = start + (terminate - start) / 2;
+			if (keys[middle]->input > input) terminate = middle;
+			else start = middle;
+		}
+		// Linear search is more efficient on the last interval
+		for (; start != terminate; ++start)
+		{
+			if (keys[start]->input >= input) break;
+		}
 	}
-	if (it == keys.begin()) return outputOffset + outputStart;
+	return start;
+}
 
+float FCDAnimationCurve::Interpolate(size_t keyIndex, float input) const
+{
 	// Get the keys and values for this interval
-	const FCDAnimationKey* startKey = *(it - 1);
-	const FCDAnimationKey* endKey = *it;
+	const FCDAnimationKey* startKey = keys[keyIndex - 1];
+	const FCDAnimationKey* endKey = keys[keyIndex];
 	float inputInterval = endKey->input - startKey->input;
 	float outputInterval = endKey->output - startKey->output;
 
@@ -401,7 +493,7 @@ float FCDAnimationCurve::Evaluate(float input) const
 			FCDAnimationKeyTCB* tkey2 = (FCDAnimationKeyTCB*) endKey;
 			FMVector2 tempTangent;
 			tempTangent.x = tempTangent.y = 0.0f;
-			const FCDAnimationKey* nextKey = (it + 1) < keys.end() ? (*(it + 1)) : nullptr;
+			const FCDAnimationKey* nextKey = (keyIndex + 1 < keys.size()) ? keys[keyIndex + 1] : nullptr;
 			ComputeTCBTangent(startKey, endKey, nextKey, tkey2->tension, tkey2->continuity, tkey2->bias, inTangent, tempTangent);
 			//Change this when we've figured out the values of the vectors from TCB...
 			inTangent.x = endKey->input + inTangent.x;
@@ -437,7 +529,7 @@ float FCDAnimationCurve::Evaluate(float input) const
 		FCDAnimationKeyTCB* tkey1 = (FCDAnimationKeyTCB*) startKey;
 		FMVector2 startTangent, tempTangent, endTangent;
 		startTangent.x = startTangent.y = tempTangent.x = tempTangent.y = endTangent.x = endTangent.y = 0.0f;
-		const FCDAnimationKey* previousKey = (it - 1) > keys.begin() ? (*(it - 2)) : nullptr;
+		const FCDAnimationKey* previousKey = (keyIndex > 1) ? keys[keyIndex - 2] : nullptr;
 		ComputeTCBTangent(previousKey, startKey, endKey, tkey1->tension, tkey1->continuity, tkey1->bias, tempTangent, startTangent);
 
 		// Calculate the end key's in-tangent.
@@ -445,7 +537,7 @@ float FCDAnimationCurve::Evaluate(float input) const
 		float bx = 0.0f, cx = 0.0f; //will be used in FindT.. x equivalent of the point at b and c
 		if (endKey->interpolation == FUDaeInterpolation::TCB) {
 			FCDAnimationKeyTCB* tkey2 = (FCDAnimationKeyTCB*) endKey;
-			const FCDAnimationKey* nextKey = (it + 1) < keys.end() ? (*(it + 1)) : nullptr;
+			const FCDAnimationKey* nextKey = (keyIndex + 1 < keys.size()) ? keys[keyIndex + 1] : nullptr;
 			ComputeTCBTangent(startKey, endKey, nextKey, tkey2->tension, tkey2->continuity, tkey2->bias, endTangent, tempTangent);
 			cy = endKey->output + endTangent.y; //Assuming the tangent is GOING from the point.
 			cx = endKey->output + endTangent.x;
@@ -456,7 +548,7 @@ float FCDAnimationCurve::Evaluate(float input) const
 			cy = endTangent.y;
 			cx = endTangent.x;
 		}
-		float t = (input - inputStart) / inputInterval;
+		float t = (input - keys.front()->input) / inputInterval;
 		by = startKey->output - startTangent.y; //Assuming the tangent is GOING from the point.
 		bx = startKey->input - startTangent.x;
 
@@ -477,7 +569,97 @@ float FCDAnimationCurve::Evaluate(float input) const
 		output = startKey->output;
 		break;
 	}
-	return outputOffset + output;
+	return output;
+}
+
+// Main workhorse for the animation system:
+// Evaluates the curve for a given input
+float FCDAnimationCurve::Evaluate(float input) const
+{
+	size_t keyIndex = 0;
+	return Evaluate(input, keyIndex);
+}
+
+float FCDAnimationCurve::Evaluate(float input, size_t& keyIndex) const
+{
+	// Check for empty curves and poses (curves with 1 key).
+	if (keys.size() == 0) return 0.0f;
+	if (keys.size() == 1) return keys.front()->output;
+
+	float inputStart = keys.front()->input;
+	float inputEnd = keys.back()->input;
+	float inputSpan = inputEnd - inputStart;
+	float outputStart = keys.front()->output;
+	float outputEnd = keys.back()->output;
+	float outputSpan = outputEnd - outputStart;
+
+	// Account for pre-infinity mode
+	float outputOffset = 0.0f;
+	if (input < inputStart)
+	{
+		float inputDifference = inputStart - input;
+		switch (preInfinity)
+		{
+		case FUDaeInfinity::CONSTANT: return outputStart;
+		case FUDaeInfinity::LINEAR: return outputStart + inputDifference * (keys[1]->output - outputStart) / (keys[1]->input - inputStart);
+		case FUDaeInfinity::CYCLE: { float cycleCount = ceilf(inputDifference / inputSpan); input += cycleCount * inputSpan; break; }
+		case FUDaeInfinity::CYCLE_RELATIVE: { float cycleCount = ceilf(inputDifference / inputSpan); input += cycleCount * inputSpan; outputOffset -= cycleCount * outputSpan; break; }
+		case FUDaeInfinity::OSCILLATE: { float cycleCount = ceilf(inputDifference / (2.0f * inputSpan)); input += cycleCount * 2.0f * inputSpan; input = inputEnd - fabsf(input - inputEnd); break; }
+		case FUDaeInfinity::UNKNOWN: default: return outputStart;
+		}
+	}
+
+	// Account for post-infinity mode
+	else if (input >= inputEnd)
+	{
+		float inputDifference = input - inputEnd;
+		switch (postInfinity)
+		{
+		case FUDaeInfinity::CONSTANT: return outputEnd;
+		case FUDaeInfinity::LINEAR: return outputEnd + inputDifference * (keys[keys.size() - 2]->output - outputEnd) / (keys[keys.size() - 2]->input - inputEnd);
+		case FUDaeInfinity::CYCLE: { float cycleCount = ceilf(inputDifference / inputSpan); input -= cycleCount * inputSpan; break; }
+		case FUDaeInfinity::CYCLE_RELATIVE: { float cycleCount = ceilf(inputDifference / inputSpan); input -= cycleCount * inputSpan; outputOffset += cycleCount * outputSpan; break; }
+		case FUDaeInfinity::OSCILLATE: { float cycleCount = ceilf(inputDifference / (2.0f * inputSpan)); input -= cycleCount * 2.0f * inputSpan; input = inputStart + fabsf(input - inputStart); break; }
+		case FUDaeInfinity::UNKNOWN: default: return outputEnd;
+		}
+	}
+
+	// Find the current interval
+	keyIndex = FindKeyIndex(input, keyIndex);
+	if (keyIndex == 0) return outputOffset + outputStart;
+	else if (keyIndex == keys.size()) return outputOffset + outputEnd;
+	return outputOffset + Interpolate(keyIndex, input);
+}
+
+void FCDAnimationCurve::Evaluate(const float* inputs, size_t count, float* outputs) const
+{
+	size_t keyCount = keys.size();
+	if (keyCount < 2)
+	{
+		float output = (keyCount == 0) ? 0.0f : keys.front()->output;
+		for (size_t i = 0; i < count; ++i) outputs[i] = output;
+		return;
+	}
+
+	float inputStart = keys.front()->input;
+	float inputEnd = keys.back()->input;
+	size_t keyIndex = 1;
+	for (size_t i = 0; i < count; ++i)
+	{
+		float input = inputs[i];
+		if (input <= inputStart || input >= inputEnd)
+		{
+			// Leave the infinity modes to the complete evaluation.
+			outputs[i] = Evaluate(input, keyIndex);
+			if (keyIndex == 0) keyIndex = 1;
+			continue;
+		}
+
+		// Within the curve, walk forward through the keys: the last key stops the walk.
+		if (keys[keyIndex - 1]->input >= input) keyIndex = FindKeyIndex(input, keyIndex);
+		while (keys[keyIndex]->input < input) ++keyIndex;
+		outputs[i] = Interpolate(keyIndex, input);
+	}
 }
 
 // Apply a conversion function on the key values and tangents
@@ -58,6 +58,17 @@ private:
 	// Curve information
 	FCDAnimationKeyList keys;
 	FUDaeInfinity::Infinity preInfinity, postInfinity;
+
+	// Key storage: the keys are allocated, in creation order, from blocks owned by the curve.
+	// The deleted keys are kept for re-use in one list per key class.
+	fm::pvector<uint8> keyBlocks;
+	size_t keyBlockUsed;
+	size_t keyBlockCapacity;
+	FCDAnimationKeyList freeKeys[3];
+
+	// When all the keys are of the same class and follow each other in one block,
+	// the size of their class: the evaluation then finds the keys without the key list.
+	size_t packedKeySize;
 	
 	// Driver information
 	FUTrackedPtr<FCDAnimated> inputDriver;
@@ -70,6 +81,24 @@ private:
 	float currentOffset;
 	static bool is2DEvaluation;
 
+	// Allocates a key of the class matching the interpolation type from the key storage.
+	FCDAnimationKey* NewKey(FUDaeInterpolation::Interpolation interpolation);
+
+	// Finds the first key with an input greater or equal to the given input, trying the hinted key first.
+	size_t FindKeyIndex(float input, size_t hint) const;
+
+	// Interpolates the output within the key interval ending at the given key.
+	float Interpolate(size_t keyIndex, float input) const;
+
+	// Inserts a key in the key list and keeps track of the key packing.
+	void InsertKey(size_t index, FCDAnimationKey* key);
+
+	// Returns a key to the key storage, for re-use.
+	void ReleaseKey(FCDAnimationKey* key);
+
+	// Makes sure that the current key block has room for a number of bytes.
+	void ReserveKeyStorage(size_t byteCount);
+
 public:
 	DeclareFlag(AnimChanged, 0);	// On Member Value Changed
 	DeclareFlagCount(1);
@@ -101,11 +130,21 @@ public:
 	inline size_t GetKeyCount() const { return keys.size(); }
 
 	/** Sets the number of keys within the animation curve.
+		Removing all the keys releases their storage, so that the next keys are packed again.
 		@param count The new number of keys in the curve.
 		@param interpolation If creating new keys, the interpolation type
 			for the new keys. */
 	void SetKeyCount(size_t count, FUDaeInterpolation::Interpolation interpolation);
 
+	/** Reserves the storage for a number of new keys.
+		The keys added afterwards are allocated contiguously, which is
+		faster to create and to evaluate. Call this before adding many keys.
+		@param count The number of keys that will be added.
+		@param interpolation The interpolation type of the new keys.
+			For mixed interpolation types, give the type with the largest key class:
+			TCB, then BEZIER, then any other type. */
+	void ReserveKeys(size_t count, FUDaeInterpolation::Interpolation interpolation);
+
 	/** Retrieves one key in the animation curve.
 		@param index The index of the key to retrieve.
 		@return The key. */
@@ -240,6 +279,24 @@ public:
 		@return The sampled value of the curve at the given input value. */
 	float Evaluate(float input) const;
 
+	/** Evaluates the animation curve, starting the key search from a hint.
+		Use this or a FCDAnimationCurveCursor to evaluate the curve
+		at increasing inputs: the search then takes constant time, on average.
+		@param input An input value.
+		@param keyIndex [IN/OUT] The key search hint, set to the index of
+			the key that ends the evaluated interval. Start with zero.
+		@return The sampled value of the curve at the given input value. */
+	float Evaluate(float input, size_t& keyIndex) const;
+
+	/** Evaluates the animation curve at a list of inputs.
+		The infinity checks and the key search are done once for
+		the inputs within each key interval, when the inputs are sorted.
+		Unsorted inputs are evaluated correctly, but more slowly.
+		@param inputs A list of input values, preferably in increasing order.
+		@param count The number of input values.
+		@param outputs An array of count floating-point values to fill in with the sampled values. */
+	void Evaluate(const float* inputs, size_t count, float* outputs) const;
+
 	/** [INTERNAL] Adds an animation clip to the list of animation clips that use this curve.
 		@param clip An animation clip. */
 	void RegisterAnimationClip(FCDAnimationClip* clip);
@@ -284,6 +341,37 @@ public:
 	static bool Is2DCurveEvaluation() {return is2DEvaluation; }
 };
 
+/**
+	A cursor for the sequential evaluation of an animation curve.
+	The cursor remembers the last evaluated key interval, so that
+	the timeline playback does not search the curve keys at each frame.
+
+	@ingroup FCDocument
+*/
+class FCOLLADA_EXPORT FCDAnimationCurveCursor
+{
+private:
+	const FCDAnimationCurve* curve;
+	size_t keyIndex;
+
+public:
+	/** Constructor.
+		@param _curve The animation curve to evaluate. */
+	FCDAnimationCurveCursor(const FCDAnimationCurve* _curve) : curve(_curve), keyIndex(0) {}
+
+	/** Retrieves the evaluated animation curve.
+		@return The animation curve. */
+	inline const FCDAnimationCurve* GetCurve() const { return curve; }
+
+	/** Forgets the last evaluated key interval. */
+	inline void Reset() { keyIndex = 0; }
+
+	/** Evaluates the animation curve.
+		@param input An input value. Successive inputs are expected to be close and increasing.
+		@return The sampled value of the curve at the given input value. */
+	inline float Evaluate(float input) { return curve->Evaluate(input, keyIndex); }
+};
+
 /** A simple conversion functor. */
 class FCDConversionFunctor
 {
@@ -7,11 +7,14 @@
 */
 
 #include "StdAfx.h"
+#include "FCDocument/FCDAnimation.h"
 #include "FCDocument/FCDAnimationCurve.h"
 #include "FCDocument/FCDAnimationChannel.h"
 #include "FCDocument/FCDAnimationCurveTools.h"
 #include "FCDocument/FCDAnimationKey.h"
 #include "FCDocument/FCDAnimationMultiCurve.h"
+#include "FCDocument/FCDLibrary.h"
+#include "FUtils/FUThreadPool.h"
 
 #define SMALL_DELTA	0.001f
 
@@ -258,4 +261,270 @@ namespace FCDAnimationCurveTools
 			v += values[i];
 		return v / count;
 	}
+
+	//
+	// Key reduction
+	//
+
+	// One segment of a reduced curve: it goes from the end of the previous segment to one of the original keys.
+	struct ReducedSegment
+	{
+		size_t endKey;
+		bool isLinear;
+		FMVector2 outTangent, inTangent;
+	};
+	typedef fm::vector<ReducedSegment, true> ReducedSegmentList;
+
+	// The samples that the reduced curve must follow: the input and the output of
+	// the original curve at each key, at the even indices, and halfway between the keys.
+	struct ReductionSamples
+	{
+		FloatList inputs;
+		FloatList outputs;
+	};
+
+	static bool IsReducible(const FCDAnimationCurve* curve)
+	{
+		// The linear infinities extrapolate the first and the last key intervals, which the reduction modifies.
+		if (curve->GetKeyCount() < 3) return false;
+		if (curve->GetPreInfinity() == FUDaeInfinity::LINEAR || curve->GetPostInfinity() == FUDaeInfinity::LINEAR) return false;
+		const FCDAnimationKey** keys = curve->GetKeys();
+		for (size_t i = 0; i < curve->GetKeyCount(); ++i)
+		{
+			if (keys[i]->interpolation != FUDaeInterpolation::LINEAR && keys[i]->interpolation != FUDaeInterpolation::BEZIER) return false;
+		}
+		return true;
+	}
+
+	// Fits a segment between two samples: first a line, then a cubic Bezier with its
+	// control inputs at the thirds of the interval and its control outputs given by least squares.
+	static bool FitSegment(const ReductionSamples& samples, size_t first, size_t last, float tolerance, ReducedSegment& segment)
+	{
+		const float* inputs = samples.inputs.begin();
+		const float* outputs = samples.outputs.begin();
+		double x0 = inputs[first], y0 = outputs[first];
+		double x3 = inputs[last], y3 = outputs[last];
+		double interval = x3 - x0;
+		if (interval <= 0.0) return false;
+
+		double error = 0.0;
+		for (size_t k = first + 1; k < last && error <= tolerance; ++k)
+		{
+			double s = (inputs[k] - x0) / interval;
+			error = max(error, fabs(y0 + s * (y3 - y0) - outputs[k]));
+		}
+		if (error <= tolerance)
+		{
+			segment.isLinear = true;
+			return true;
+		}
+
+		// Solve the 2x2 normal equations for the two control outputs, with the end points fixed.
+		double a11 = 0.0, a12 = 0.0, a22 = 0.0, r1 = 0.0, r2 = 0.0;
+		for (size_t k = first + 1; k < last; ++k)
+		{
+			double s = (inputs[k] - x0) / interval, si = 1.0 - s;
+			double b1 = 3.0 * si * si * s, b2 = 3.0 * si * s * s;
+			double r = outputs[k] - si * si * si * y0 - s * s * s * y3;
+			a11 += b1 * b1; a12 += b1 * b2; a22 += b2 * b2;
+			r1 += b1 * r; r2 += b2 * r;
+		}
+		double determinant = a11 * a22 - a12 * a12;
+		if (fabs(determinant) < 1e-12) return false;
+		double c1 = (r1 * a22 - r2 * a12) / determinant;
+		double c2 = (r2 * a11 - r1 * a12) / determinant;
+
+		error = 0.0;
+		for (size_t k = first + 1; k < last && error <= tolerance; ++k)
+		{
+			double s = (inputs[k] - x0) / interval, si = 1.0 - s;
+			double y = si * si * si * y0 + 3.0 * si * si * s * c1 + 3.0 * si * s * s * c2 + s * s * s * y3;
+			error = max(error, fabs(y - outputs[k]));
+		}
+		if (error > tolerance) return false;
+		segment.isLinear = false;
+		segment.outTangent = FMVector2((float) (x0 + interval / 3.0), (float) c1);
+		segment.inTangent = FMVector2((float) (x3 - interval / 3.0), (float) c2);
+		return true;
+	}
+
+	bool ReduceKeys(FCDAnimationCurve* curve, float tolerance, FCDAnimationCurveReduction* reduction)
+	{
+		FUAssert(curve != nullptr, return false);
+		if (!IsReducible(curve)) return false;
+		size_t keyCount = curve->GetKeyCount();
+		const FCDAnimationKey** keys = const_cast<const FCDAnimationCurve*>(curve)->GetKeys();
+
+		// Sample the original curve at its keys and halfway between them.
+		ReductionSamples samples;
+		samples.inputs.reserve(2 * keyCount - 1);
+		for (size_t i = 0; i < keyCount; ++i)
+		{
+			if (i > 0) samples.inputs.push_back((keys[i - 1]->input + keys[i]->input) * 0.5f);
+			samples.inputs.push_back(keys[i]->input);
+		}
+		samples.outputs.resize(samples.inputs.size());
+		curve->Evaluate(samples.inputs.begin(), samples.inputs.size(), samples.outputs.begin());
+
+		// Extend each segment as far as it fits: double the number of keys it spans, then
+		// bisect. A segment over one key interval keeps the original interpolation.
+		ReducedSegmentList segments;
+		bool hasBezier = false;
+		for (size_t start = 0; start < keyCount - 1;)
+		{
+			ReducedSegment segment, candidate;
+			const FCDAnimationKey* startKey = keys[start];
+			const FCDAnimationKey* endKey = keys[start + 1];
+			segment.endKey = start + 1;
+			segment.isLinear = startKey->interpolation != FUDaeInterpolation::BEZIER || endKey->interpolation != FUDaeInterpolation::BEZIER;
+			if (!segment.isLinear)
+			{
+				segment.outTangent = ((const FCDAnimationKeyBezier*) startKey)->outTangent;
+				segment.inTangent = ((const FCDAnimationKeyBezier*) endKey)->inTangent;
+			}
+
+			size_t fitted = start + 1, step = 1;
+			while (fitted + step < keyCount && FitSegment(samples, 2 * start, 2 * (fitted + step), tolerance, candidate))
+			{
+				fitted += step;
+				step *= 2;
+				segment = candidate;
+				segment.endKey = fitted;
+			}
+			size_t failed = min(fitted + step, keyCount);
+			while (failed - fitted > 1)
+			{
+				size_t middle = fitted + (failed - fitted) / 2;
+				if (FitSegment(samples, 2 * start, 2 * middle, tolerance, candidate))
+				{
+					fitted = middle;
+					segment = candidate;
+					segment.endKey = fitted;
+				}
+				else failed = middle;
+			}
+
+			hasBezier |= !segment.isLinear;
+			segments.push_back(segment);
+			start = segment.endKey;
+		}
+
+		// Rebuild the keys. With any Bezier segment, all the keys are Bezier keys, so that
+		// they stay packed, and the linear segments get control points along the line.
+		FUDaeInterpolation::Interpolation interpolation = hasBezier ? FUDaeInterpolation::BEZIER : FUDaeInterpolation::LINEAR;
+		size_t reducedKeyCount = segments.size() + 1;
+		FloatList reducedInputs, reducedOutputs;
+		reducedInputs.reserve(reducedKeyCount);
+		reducedOutputs.reserve(reducedKeyCount);
+		reducedInputs.push_back(keys[0]->input);
+		reducedOutputs.push_back(keys[0]->output);
+		for (ReducedSegment* it = segments.begin(); it != segments.end(); ++it)
+		{
+			reducedInputs.push_back(keys[(*it).endKey]->input);
+			reducedOutputs.push_back(keys[(*it).endKey]->output);
+			if ((*it).isLinear)
+			{
+				size_t index = reducedInputs.size() - 1;
+				FMVector2 start(reducedInputs[index - 1], reducedOutputs[index - 1]), end(reducedInputs[index], reducedOutputs[index]);
+				(*it).outTangent = start + (end - start) / 3.0f;
+				(*it).inTangent = end - (end - start) / 3.0f;
+			}
+		}
+
+		curve->SetKeyCount(0, interpolation);
+		curve->ReserveKeys(reducedKeyCount, interpolation);
+		for (size_t i = 0; i < reducedKeyCount; ++i)
+		{
+			FCDAnimationKey* key = curve->AddKey(interpolation);
+			key->input = reducedInputs[i];
+			key->output = reducedOutputs[i];
+			if (hasBezier)
+			{
+				// The first and the last keys mirror their only tangent.
+				FCDAnimationKeyBezier* bkey = (FCDAnimationKeyBezier*) key;
+				FMVector2 position(key->input, key->output);
+				bkey->inTangent = (i > 0) ? segments[i - 1].inTangent : position * 2.0f - segments[i].outTangent;
+				bkey->outTangent = (i < reducedKeyCount - 1) ? segments[i].outTangent : position * 2.0f - segments[i - 1].inTangent;
+			}
+		}
+
+		// Measure the error of the reduced curve at the samples.
+		float maximumError = 0.0f;
+		size_t keyIndex = 0;
+		for (size_t i = 0; i < samples.inputs.size(); ++i)
+		{
+			maximumError = max(maximumError, fabsf(curve->Evaluate(samples.inputs[i], keyIndex) - samples.outputs[i]));
+		}
+
+		if (reduction != nullptr)
+		{
+			reduction->curveCount++;
+			reduction->originalKeyCount += keyCount;
+			reduction->reducedKeyCount += reducedKeyCount;
+			reduction->maximumError = max(reduction->maximumError, maximumError);
+		}
+		return true;
+	}
+
+	struct LibraryReduction
+	{
+		FCDAnimationCurveList curves;
+		fm::vector<FCDAnimationCurveReduction> reductions;
+		float tolerance;
+	};
+
+	static void ListCurves(FCDAnimation* animation, FCDAnimationCurveList& curves)
+	{
+		size_t channelCount = animation->GetChannelCount();
+		for (size_t i = 0; i < channelCount; ++i)
+		{
+			FCDAnimationChannel* channel = animation->GetChannel(i);
+			size_t curveCount = channel->GetCurveCount();
+			for (size_t j = 0; j < curveCount; ++j) curves.push_back(channel->GetCurve(j));
+		}
+		size_t childCount = animation->GetChildrenCount();
+		for (size_t i = 0; i < childCount; ++i) ListCurves(animation->GetChild(i), curves);
+	}
+
+	static void ReduceKeysTask(void* userData, size_t index)
+	{
+		LibraryReduction* data = (LibraryReduction*) userData;
+		ReduceKeys(data->curves[index], data->tolerance, &data->reductions[index]);
+	}
+
+	size_t ReduceKeys(FCDAnimationLibrary* library, float tolerance, FCDAnimationCurveReduction& reduction)
+	{
+		reduction = FCDAnimationCurveReduction();
+		FUAssert(library != nullptr, return 0);
+
+		LibraryReduction data;
+		data.tolerance = tolerance;
+		size_t entityCount = library->GetEntityCount();
+		for (size_t i = 0; i < entityCount; ++i) ListCurves(library->GetEntity(i), data.curves);
+		size_t curveCount = data.curves.size();
+		if (curveCount == 0) return 0;
+		data.reductions.resize(curveCount);
+
+		// Each curve only modifies its own keys: reduce them in parallel.
+		size_t threadCount = min(curveCount, FUThreadPool::GetProcessorCount());
+		if (threadCount <= 1)
+		{
+			for (size_t i = 0; i < curveCount; ++i) ReduceKeysTask(&data, i);
+		}
+		else
+		{
+			FUThreadPool pool(threadCount);
+			pool.Run(ReduceKeysTask, &data, curveCount);
+		}
+
+		for (size_t i = 0; i < curveCount; ++i)
+		{
+			const FCDAnimationCurveReduction& curveReduction = data.reductions[i];
+			reduction.curveCount += curveReduction.curveCount;
+			reduction.originalKeyCount += curveReduction.originalKeyCount;
+			reduction.reducedKeyCount += curveReduction.reducedKeyCount;
+			reduction.maximumError = max(reduction.maximumError, curveReduction.maximumError);
+		}
+		return reduction.curveCount;
+	}
 };
@@ -14,13 +14,33 @@
 #ifndef _FCD_ANIMATION_CURVE_TOOLS_H_
 #define _FCD_ANIMATION_CURVE_TOOLS_H_
 
+class FCDAnimation;
 class FCDAnimationCurve;
 class FCDAnimationMultiCurve;
+template <class T> class FCDLibrary;
+
+typedef FCDLibrary<FCDAnimation> FCDAnimationLibrary; /**< A COLLADA library of animation entities. */
 
 typedef fm::pvector<FCDAnimationCurve> FCDAnimationCurveList; /**< A dynamically-sized array of animation curves. */
 typedef fm::pvector<const FCDAnimationCurve> FCDAnimationCurveConstList; /**< A dynamically-sized array of constant animation curve pointers. */
 typedef float (*FCDCollapsingFunction)(float* values, uint32 count); /**< A collapsing function. It converts multiple floating-point values into one floating-point value. */
 
+/** The results of an animation curve key reduction. */
+struct FCDAnimationCurveReduction
+{
+	size_t curveCount; /**< The number of curves that were reduced. */
+	size_t originalKeyCount; /**< The number of keys of these curves, before the reduction. */
+	size_t reducedKeyCount; /**< The number of keys of these curves, after the reduction. */
+	float maximumError; /**< The largest difference between a reduced curve and its original curve. */
+
+	/** Constructor. */
+	FCDAnimationCurveReduction() : curveCount(0), originalKeyCount(0), reducedKeyCount(0), maximumError(0.0f) {}
+
+	/** Retrieves the compression ratio of the reduction.
+		@return The number of original keys for each reduced key. */
+	inline float GetCompressionRatio() const { return (reducedKeyCount > 0) ? (float) originalKeyCount / (float) reducedKeyCount : 1.0f; }
+};
+
 /** Contains tools to merge, collapse and otherwise modify animation curve. */
 namespace FCDAnimationCurveTools
 {
@@ -55,6 +75,33 @@ namespace FCDAnimationCurveTools
 		@param values The list of floating-point values.
 		@param count The number of values within the given list. */
 	float Average(float* values, uint32 count);
+
+	/** Replaces the keys of an animation curve with as few linear or Bezier
+		keys as possible, while staying within an error tolerance of the original curve.
+		This is meant for the baked animations, which have one key per frame.
+		Only the curves with linear and Bezier keys are reduced: the curves
+		with step or TCB keys, with linear infinities or with less than three keys are left as is.
+		The first and the last keys are kept. The error is measured at the original
+		key inputs and halfway between them.
+		Different curves may be reduced on different threads at once.
+		@param curve The animation curve to reduce.
+		@param tolerance The largest allowed difference between the
+			outputs of the reduced curve and of the original curve.
+		@param reduction The results to accumulate the key counts and the error of
+			this reduction into. This pointer may be nullptr.
+		@return Whether the curve was reduced. */
+	FCOLLADA_EXPORT bool ReduceKeys(FCDAnimationCurve* curve, float tolerance, FCDAnimationCurveReduction* reduction = nullptr);
+
+	/** Reduces the keys of all the animation curves of an animation library.
+		The curves are reduced in parallel, on a pool of worker threads.
+		@see ReduceKeys
+		@param library The animation library. The child animations are processed too.
+		@param tolerance The largest allowed difference between the
+			outputs of the reduced curves and of the original curves.
+		@param reduction The results to fill in with the key counts and the error of
+			the reduced curves. They are reset first.
+		@return The number of reduced curves. */
+	FCOLLADA_EXPORT size_t ReduceKeys(FCDAnimationLibrary* library, float tolerance, FCDAnimationCurveReduction& reduction);
 };
 
 #endif // _FCD_ANIMATION_CURVE_TOOLS_H_
@@ -18,6 +18,11 @@
 #include "FCDocument/FCDAnimationMultiCurve.h"
 #include "FUtils/FUDaeEnum.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FCD_MULTI_CURVE_SSE
+#include <xmmintrin.h>
+#endif
+
 // Implemented in FCDAnimationCurve.cpp
 extern float FindT(float cp0x, float cp1x, float cp2x, float cp3x, float input, float initialGuess);
 
@@ -76,8 +81,161 @@ FCDAnimationMKey* FCDAnimationMultiCurve::AddKey(FUDaeInterpolation::Interpolati
 	return key;
 }
 
+// Linear interpolation of all the dimensions, with the interval factor: start + factor * (end - start).
+static void InterpolateLinear(const float* start, const float* end, float factor, float* output, uint32 dimension)
+{
+	uint32 i = 0;
+#ifdef FCD_MULTI_CURVE_SSE
+	__m128 factors = _mm_set1_ps(factor);
+	for (; i + 4 <= dimension; i += 4)
+	{
+		__m128 a = _mm_loadu_ps(start + i);
+		__m128 b = _mm_loadu_ps(end + i);
+		_mm_storeu_ps(output + i, _mm_add_ps(a, _mm_mul_ps(factors, _mm_sub_ps(b, a))));
+	}
+#endif // FCD_MULTI_CURVE_SSE
+	for (; i < dimension; ++i) output[i] = start[i] + factor * (end[i] - start[i]);
+}
+
+// Bezier interpolation of all the dimensions.
+// The end in-tangents are nullptr when the end key is not a Bezier key.
+static void InterpolateBezier(const FCDAnimationMKeyBezier* startKey, const FCDAnimationMKey* endKey, const FMVector2* endInTangents, float input, float* output, uint32 dimension, bool is2DEvaluation)
+{
+	float inputInterval = endKey->input - startKey->input;
+	float intervalT = (input - startKey->input) / inputInterval;
+	uint32 i = 0;
+#ifdef FCD_MULTI_CURVE_SSE
+	for (; i + 4 <= dimension; i += 4)
+	{
+		// De-interleave the tangents of four dimensions.
+		const FMVector2* outTangents = startKey->outTangent + i;
+		__m128 low = _mm_loadu_ps(&outTangents[0].u), high = _mm_loadu_ps(&outTangents[2].u);
+		__m128 outU = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 outV = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+		__m128 inU, inV;
+		if (endInTangents != nullptr)
+		{
+			low = _mm_loadu_ps(&endInTangents[i].u); high = _mm_loadu_ps(&endInTangents[i + 2].u);
+			inU = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+			inV = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+		else
+		{
+			inU = _mm_set1_ps(endKey->input);
+			inV = _mm_setzero_ps();
+		}
+
+		// Finding the Bezier parameter is iterative and stays scalar.
+		__m128 t;
+		if (is2DEvaluation)
+		{
+			float ts[4];
+			_mm_storeu_ps(ts, inU);
+			for (uint32 j = 0; j < 4; ++j) ts[j] = FindT(startKey->input, outTangents[j].x, ts[j], endKey->input, input, intervalT);
+			t = _mm_loadu_ps(ts);
+		}
+		else t = _mm_set1_ps(intervalT);
+
+		__m128 interval = _mm_set1_ps(inputInterval);
+		__m128 minimum = _mm_set1_ps(0.01f), maximum = _mm_set1_ps(100.0f);
+		__m128 br = _mm_div_ps(interval, _mm_sub_ps(outU, _mm_set1_ps(startKey->input)));
+		__m128 cr = _mm_div_ps(interval, _mm_sub_ps(_mm_set1_ps(endKey->input), inU));
+		br = _mm_min_ps(_mm_max_ps(br, minimum), maximum);
+		cr = _mm_min_ps(_mm_max_ps(cr, minimum), maximum);
+
+		__m128 ti = _mm_sub_ps(_mm_set1_ps(1.0f), t);
+		__m128 startOutput = _mm_loadu_ps(startKey->output + i);
+		__m128 endOutput = _mm_loadu_ps(endKey->output + i);
+		__m128 result = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(startOutput, ti), ti), ti);
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_mul_ps(br, outV), ti), ti), t));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_mul_ps(cr, inV), ti), t), t));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(endOutput, t), t), t));
+		_mm_storeu_ps(output + i, result);
+	}
+#endif // FCD_MULTI_CURVE_SSE
+	for (; i < dimension; ++i)
+	{
+		FMVector2 inTangent;
+		if (endInTangents != nullptr) inTangent = endInTangents[i];
+		else inTangent = FMVector2(endKey->input, 0.0f);
+
+		float t = intervalT;
+		if (is2DEvaluation) t = FindT(startKey->input, startKey->outTangent[i].x, inTangent.x, endKey->input, input, t);
+		float b = startKey->outTangent[i].v;
+		float c = inTangent.v;
+		float ti = 1.0f - t;
+		float br = inputInterval / (startKey->outTangent[i].u - startKey->input);
+		float cr = inputInterval / (endKey->input - inTangent.u);
+		br = FMath::Clamp(br, 0.01f, 100.0f);
+		cr = FMath::Clamp(cr, 0.01f, 100.0f);
+
+		output[i] = startKey->output[i] * ti * ti * ti + br * b * ti * ti * t + cr * c * ti * t * t + endKey->output[i] * t * t * t;
+	}
+}
+
+size_t FCDAnimationMultiCurve::FindKeyIndex(float input, size_t hint) const
+{
+	// Sequential evaluations stay within the hinted key interval or move to the next one.
+	size_t keyCount = keys.size();
+	if (hint > 0 && hint < keyCount && keys[hint - 1]->input <= input)
+	{
+		if (input < keys[hint]->input) return hint;
+		if (hint + 1 < keyCount && input < keys[hint + 1]->input) return hint + 1;
+	}
+
+	size_t start = 0, terminate = keyCount;
+	while (terminate - start > 3)
+	{
+		// Binary search.
+		size_t middle = start + (terminate - start) / 2;
+		if (keys[middle]->input > input) terminate = middle;
+		else start = middle;
+	}
+	// Linear search is more efficient on the last interval
+	for (; start != terminate; ++start)
+	{
+		if (keys[start]->input > input) break;
+	}
+	return start;
+}
+
+void FCDAnimationMultiCurve::Interpolate(size_t keyIndex, float input, float* output) const
+{
+	// Get the keys and values for this interval
+	const FCDAnimationMKey* startKey = keys[keyIndex - 1];
+	const FCDAnimationMKey* endKey = keys[keyIndex];
+
+	// Interpolate the outputs.
+	// Similar code is found in FCDAnimationCurve.cpp. If you update this, update the other one too.
+	switch (startKey->interpolation)
+	{
+	case FUDaeInterpolation::LINEAR:
+		InterpolateLinear(startKey->output, endKey->output, (input - startKey->input) / (endKey->input - startKey->input), output, dimension);
+		break;
+
+	case FUDaeInterpolation::BEZIER: {
+		const FMVector2* endInTangents = nullptr;
+		if (endKey->interpolation == FUDaeInterpolation::BEZIER) endInTangents = ((const FCDAnimationMKeyBezier*) endKey)->inTangent;
+		InterpolateBezier((const FCDAnimationMKeyBezier*) startKey, endKey, endInTangents, input, output, dimension, is2DEvaluation);
+		break; }
+
+	case FUDaeInterpolation::TCB: // Not implemented..
+	case FUDaeInterpolation::UNKNOWN:
+	case FUDaeInterpolation::STEP:
+	default:
+		for (uint32 i = 0; i < dimension; ++i) output[i] = startKey->output[i];
+		break;
+	}
+}
+
 // Samples all the curves for a given input
 void FCDAnimationMultiCurve::Evaluate(float input, float* output) const
+{
+	size_t keyIndex = 0;
+	Evaluate(input, output, keyIndex);
+}
+
+void FCDAnimationMultiCurve::Evaluate(float input, float* output, size_t& keyIndex) const
 {
 	// Check for empty curves and poses (curves with 1 key).
 	if (keys.size() == 0)
@@ -91,27 +249,14 @@ void FCDAnimationMultiCurve::Evaluate(float input, float* output) const
 	else
 	{
 		// Find the current interval
-		FCDAnimationMKeyList::const_iterator it, start = keys.begin(), terminate = keys.end();
-		while (terminate - start > 3)
-		{
-			// Binary search.
-			it = (const FCDAnimationMKey**) ((((size_t) terminate) / 2 + ((size_t) start) / 2) & ~((sizeof(size_t)-1)));
-			if ((*it)->input > input) terminate = it;
-			else start = it;
-		}
-		// Linear search is more efficient on the last interval
-		for (it = start; it != terminate; ++it)
-		{
-			if ((*it)->input > input) break;
-		}
-
-		if (it == keys.end())
+		keyIndex = FindKeyIndex(input, keyIndex);
+		if (keyIndex == keys.size())
 		{
 			// We're sampling after the curve, return the last values
 			const FCDAnimationMKey* lastKey = keys.back();
 			for (uint32 i = 0; i < dimension; ++i) output[i] = lastKey->output[i];
 		}
-		else if (it == keys.begin())
+		else if (keyIndex == 0)
 		{
 			// We're sampling before the curve, return the first values
 			const FCDAnimationMKey* firstKey = keys.front();
@@ -119,52 +264,16 @@ void FCDAnimationMultiCurve::Evaluate(float input, float* output) const
 		}
 		else
 		{
-			// Get the keys and values for this interval
-			const FCDAnimationMKey* startKey = *(it - 1);
-			const FCDAnimationMKey* endKey = *it;
-			float inputInterval = endKey->input - startKey->input;
-
-			// Interpolate the outputs.
-			// Similar code is found in FCDAnimationCurve.cpp. If you update this, update the other one too.
-			switch (startKey->interpolation)
-			{
-			case FUDaeInterpolation::LINEAR:
-				for (uint32 i = 0; i < dimension; ++i)
-				{
-					output[i] = startKey->output[i] + (input - startKey->input) / inputInterval * (endKey->output[i] - startKey->output[i]);
-				}
-				break;
-
-			case FUDaeInterpolation::BEZIER: {
-				FCDAnimationMKeyBezier* bkey1 = (FCDAnimationMKeyBezier*) startKey;
-				for (uint32 i = 0; i < dimension; ++i)
-				{
-					FMVector2 inTangent;
-					if (endKey->interpolation == FUDaeInterpolation::BEZIER) inTangent = ((FCDAnimationMKeyBezier*) endKey)->inTangent[i];
-					else inTangent = FMVector2(endKey->input, 0.0f);
-
-					float t = (input - startKey->input) / inputInterval;
-					if (is2DEvaluation) t = FindT(startKey->input, bkey1->outTangent[i].x, inTangent.x, endKey->input, input, t);
-					float b = bkey1->outTangent[i].v;
-					float c = inTangent.v;
-					float ti = 1.0f - t;
-					float br = inputInterval / (bkey1->outTangent[i].u - startKey->input);
-					float cr = inputInterval / (endKey->input - inTangent.u);
-					br = FMath::Clamp(br, 0.01f, 100.0f);
-					cr = FMath::Clamp(cr, 0.01f, 100.0f);
-
-					output[i] = startKey->output[i] * ti * ti * ti + br* b * ti * ti * t + cr * c * ti * t * t + endKey->output[i] * t * t * t;
-				}
-				break; }
-
-			case FUDaeInterpolation::TCB: // Not implemented..
-			case FUDaeInterpolation::UNKNOWN:
-			case FUDaeInterpolation::STEP:
-			default:
-				for (uint32 i = 0; i < dimension; ++i) output[i] = startKey->output[i];
-				break;
-			}
+			Interpolate(keyIndex, input, output);
 		}
 	}
 }
 
+void FCDAnimationMultiCurve::Evaluate(const float* inputs, size_t count, float* outputs) const
+{
+	size_t keyIndex = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		Evaluate(inputs[i], outputs + i * dimension, keyIndex);
+	}
+}
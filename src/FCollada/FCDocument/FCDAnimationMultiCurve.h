@@ -62,6 +62,12 @@ private:
 	//What sort of evaluation we do, 1D or 2D
 	static bool is2DEvaluation;
 
+	// Finds the first key with an input greater than the given input, trying the hinted key first.
+	size_t FindKeyIndex(float input, size_t hint) const;
+
+	// Interpolates the outputs within the key interval ending at the given key.
+	void Interpolate(size_t keyIndex, float input, float* output) const;
+
 public:
 	/** Constructor.
 		The number of dimensions will not change in the lifetime of a
@@ -132,6 +138,22 @@ public:
 		@param output An array of floating-point values to fill in with the sampled values. */
 	void Evaluate(float input, float* output) const;
 
+	/** Evaluates the animation curve, starting the key search from a hint.
+		Use this or a FCDAnimationMultiCurveCursor to evaluate the curve
+		at increasing inputs: the search then takes constant time, on average.
+		@param input An input value.
+		@param output An array of floating-point values to fill in with the sampled values.
+		@param keyIndex [IN/OUT] The key search hint, set to the index of
+			the key that ends the evaluated interval. Start with zero. */
+	void Evaluate(float input, float* output, size_t& keyIndex) const;
+
+	/** Evaluates the animation curve at a list of inputs.
+		@param inputs A list of input values, preferably in increasing order.
+		@param count The number of input values.
+		@param outputs An array of floating-point values to fill in with the sampled values:
+			the values of all the dimensions, for each input value in turn. */
+	void Evaluate(const float* inputs, size_t count, float* outputs) const;
+
 	/** [INTERNAL] Retrieves the target element suffix for the curve.
 		This will be -1 if the animated element does not belong to an
 		animated element list.
@@ -160,4 +182,35 @@ public:
 	inline bool Is2DCurveEvaluation() {return is2DEvaluation; }
 };
 
+/**
+	A cursor for the sequential evaluation of a multi-dimensional animation curve.
+	The cursor remembers the last evaluated key interval, so that
+	the timeline playback does not search the curve keys at each frame.
+
+	@ingroup FCDocument
+*/
+class FCOLLADA_EXPORT FCDAnimationMultiCurveCursor
+{
+private:
+	const FCDAnimationMultiCurve* curve;
+	size_t keyIndex;
+
+public:
+	/** Constructor.
+		@param _curve The multi-dimensional animation curve to evaluate. */
+	FCDAnimationMultiCurveCursor(const FCDAnimationMultiCurve* _curve) : curve(_curve), keyIndex(0) {}
+
+	/** Retrieves the evaluated animation curve.
+		@return The multi-dimensional animation curve. */
+	inline const FCDAnimationMultiCurve* GetCurve() const { return curve; }
+
+	/** Forgets the last evaluated key interval. */
+	inline void Reset() { keyIndex = 0; }
+
+	/** Evaluates the animation curve.
+		@param input An input value. Successive inputs are expected to be close and increasing.
+		@param output An array of floating-point values to fill in with the sampled values. */
+	inline void Evaluate(float input, float* output) { curve->Evaluate(input, output, keyIndex); }
+};
+
 #endif // _FCD_ANIMATION_MULTI_CURVE_H_
@@ -0,0 +1,191 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#include "StdAfx.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDAnimated.h"
+#include "FCDocument/FCDAnimationCurve.h"
+#include "FCDocument/FCDAnimationProgram.h"
+#include "FCDocument/FCDExternalReferenceManager.h"
+#include "FCDocument/FCDPlaceHolder.h"
+#include "FUtils/FUThreadPool.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FCD_ANIMATION_PROGRAM_SSE
+#include <xmmintrin.h>
+#endif // SSE
+
+// The number of curve evaluations given to a worker thread at once.
+static const size_t evaluationChunkSize = 2048;
+
+// How far ahead the curves and the values are fetched into the cache.
+static const size_t prefetchDistance = 8;
+
+// The worker threads are shared by all the animation programs.
+static FUThreadPool* animationPool = nullptr;
+static FUCriticalSection animationPoolCriticalSection;
+
+static FUThreadPool* GetAnimationPool()
+{
+	animationPoolCriticalSection.Enter();
+	if (animationPool == nullptr) animationPool = new FUThreadPool();
+	FUThreadPool* pool = animationPool;
+	animationPoolCriticalSection.Leave();
+	return pool;
+}
+
+//
+// FCDAnimationProgram
+//
+
+FCDAnimationProgram::FCDAnimationProgram(FCDocument* _document)
+:	document(_document), isCompiled(false), currentTime(0.0f)
+{
+}
+
+FCDAnimationProgram::~FCDAnimationProgram()
+{
+	document = nullptr;
+}
+
+void FCDAnimationProgram::ReleaseWorkerThreads()
+{
+	animationPoolCriticalSection.Enter();
+	SAFE_DELETE(animationPool);
+	animationPoolCriticalSection.Leave();
+}
+
+size_t FCDAnimationProgram::GetChunkCount() const
+{
+	return (evaluations.size() + evaluationChunkSize - 1) / evaluationChunkSize;
+}
+
+bool FCDAnimationProgram::IsValid() const
+{
+	if (!isCompiled) return false;
+	size_t index = 0;
+	return MatchDocuments(document, index) && index == documents.size();
+}
+
+bool FCDAnimationProgram::MatchDocuments(const FCDocument* _document, size_t& index) const
+{
+	// Follow the same walk as the compilation: the documents already visited are skipped.
+	for (size_t i = 0; i < index; ++i)
+	{
+		if (documents[i].document == _document) return true;
+	}
+	if (index >= documents.size()) return false;
+	if (documents[index].document != _document || documents[index].revision != _document->GetAnimationRevision()) return false;
+	++index;
+
+	const FCDExternalReferenceManager* manager = _document->GetExternalReferenceManager();
+	size_t placeHolderCount = manager->GetPlaceHolderCount();
+	for (size_t i = 0; i < placeHolderCount; ++i)
+	{
+		const FCDPlaceHolder* placeHolder = manager->GetPlaceHolder(i);
+		if (placeHolder->IsTargetLoaded() && !MatchDocuments(placeHolder->GetTarget(), index)) return false;
+	}
+	return true;
+}
+
+void FCDAnimationProgram::Compile()
+{
+	evaluations.clear();
+	targets.clear();
+	documents.clear();
+	CompileDocument(document);
+	isCompiled = true;
+}
+
+void FCDAnimationProgram::CompileDocument(FCDocument* _document)
+{
+	// The external references may form cycles: compile each document once.
+	for (DocumentRevisionList::iterator it = documents.begin(); it != documents.end(); ++it)
+	{
+		if ((*it).document == _document) return;
+	}
+	DocumentRevision revision = { _document, _document->GetAnimationRevision() };
+	documents.push_back(revision);
+
+	for (FCDocument::FCDAnimatedSet::iterator itA = _document->animatedValues.begin(); itA != _document->animatedValues.end(); ++itA)
+	{
+		FCDAnimated* animated = (*itA).first;
+		const FCDAnimationCurveListList& curves = const_cast<const FCDAnimated*>(animated)->GetCurves();
+		size_t count = min(curves.size(), animated->GetValueCount());
+		bool isEvaluated = false;
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (curves[i].empty()) continue;
+
+			// As in FCDAnimated::Evaluate, only the first curve of each value is evaluated.
+			Evaluation evaluation = { curves[i][0], animated->GetValue(i), 0 };
+			if (evaluation.curve == nullptr || evaluation.value == nullptr) continue;
+			evaluations.push_back(evaluation);
+			isEvaluated = true;
+		}
+		if (isEvaluated && animated->GetTargetObject() != nullptr) targets.push_back(animated->GetTargetObject());
+	}
+
+	// Flatten the loaded external documents as well.
+	FCDExternalReferenceManager* manager = _document->GetExternalReferenceManager();
+	for (size_t i = 0; i < manager->GetPlaceHolderCount(); ++i)
+	{
+		FCDPlaceHolder* placeHolder = manager->GetPlaceHolder(i);
+		if (placeHolder->IsTargetLoaded()) CompileDocument(placeHolder->GetTarget());
+	}
+}
+
+void FCDAnimationProgram::Evaluate(float time)
+{
+	if (!IsValid()) Compile();
+
+	size_t chunkCount = GetChunkCount();
+	if (chunkCount > 1 && FCollada::GetParallelAnimationFlag())
+	{
+		currentTime = time;
+		GetAnimationPool()->Run(EvaluateChunkTask, this, chunkCount);
+	}
+	else
+	{
+		for (size_t i = 0; i < chunkCount; ++i) EvaluateChunk(i, time);
+	}
+
+	// Several targets may share their dirty flags, like the transforms of
+	// one scene node: notify them on the calling thread only.
+	for (fm::pvector<FCDObject>::iterator it = targets.begin(); it != targets.end(); ++it)
+	{
+		(*it)->SetValueChange();
+	}
+}
+
+void FCDAnimationProgram::EvaluateChunk(size_t chunk, float time)
+{
+	Evaluation* it = evaluations.begin() + chunk * evaluationChunkSize;
+	Evaluation* end = evaluations.begin() + min(evaluations.size(), (chunk + 1) * evaluationChunkSize);
+	for (; it != end; ++it)
+	{
+#ifdef FCD_ANIMATION_PROGRAM_SSE
+		// The curves are scattered in memory: fetch the next ones while evaluating this one.
+		if (it + prefetchDistance < end)
+		{
+			const char* curve = (const char*) it[prefetchDistance].curve;
+			_mm_prefetch(curve, _MM_HINT_T0);
+			_mm_prefetch(curve + 64, _MM_HINT_T0);
+			_mm_prefetch(curve + 128, _MM_HINT_T0);
+			_mm_prefetch((const char*) it[prefetchDistance].value, _MM_HINT_T0);
+		}
+#endif // FCD_ANIMATION_PROGRAM_SSE
+		*(*it).value = (*it).curve->Evaluate(time, (*it).keyIndex);
+	}
+}
+
+void FCDAnimationProgram::EvaluateChunkTask(void* program, size_t chunk)
+{
+	FCDAnimationProgram* p = (FCDAnimationProgram*) program;
+	p->EvaluateChunk(chunk, p->currentTime);
+}
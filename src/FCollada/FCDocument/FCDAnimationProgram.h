@@ -0,0 +1,114 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/**
+	@file FCDAnimationProgram.h
+	This file contains the FCDAnimationProgram class.
+*/
+
+#ifndef _FCD_ANIMATION_PROGRAM_H_
+#define _FCD_ANIMATION_PROGRAM_H_
+
+class FCDocument;
+class FCDObject;
+class FCDAnimationCurve;
+
+/**
+	A compiled list of the animated values of a COLLADA document.
+
+	The animation program flattens the animated values of a document
+	and of its loaded external documents into one contiguous list of
+	curve evaluations. Each evaluation remembers its last key interval,
+	so that the timeline playback does not search the curve keys at each frame.
+
+	The evaluation list is cut into chunks which, when the global parallel
+	animation flag is set, are evaluated on a pool of worker threads.
+	The animated targets are then notified of their new values on the
+	calling thread.
+
+	The program compiles itself again whenever an animated value or its
+	curves change, in any of its documents, and whenever an external
+	document is loaded or unloaded.
+
+	@see FCDocument::SetCurrentTime FCollada::SetParallelAnimationFlag
+	@ingroup FCDocument
+*/
+class FCOLLADA_EXPORT FCDAnimationProgram
+{
+private:
+	struct Evaluation
+	{
+		const FCDAnimationCurve* curve;
+		float* value;
+		size_t keyIndex;
+	};
+	struct DocumentRevision
+	{
+		const FCDocument* document;
+		uint32 revision;
+	};
+	typedef fm::vector<Evaluation, true> EvaluationList;
+	typedef fm::vector<DocumentRevision, true> DocumentRevisionList;
+
+	FCDocument* document;
+	EvaluationList evaluations;
+	fm::pvector<FCDObject> targets;
+	DocumentRevisionList documents;
+	bool isCompiled;
+
+	// The time evaluated by the worker threads.
+	float currentTime;
+
+public:
+	/** Constructor.
+		The program is compiled on its first evaluation.
+		@param document The COLLADA document to evaluate. */
+	FCDAnimationProgram(FCDocument* document);
+
+	/** Destructor. */
+	~FCDAnimationProgram();
+
+	/** Retrieves the evaluated COLLADA document.
+		@return The COLLADA document. */
+	inline FCDocument* GetDocument() { return document; }
+	inline const FCDocument* GetDocument() const { return document; } /**< See above. */
+
+	/** Retrieves whether the program is up-to-date with the animated values
+		of its documents.
+		@return Whether the program is up-to-date. */
+	bool IsValid() const;
+
+	/** Flattens the animated values of the document and of its loaded
+		external documents into the evaluation list. */
+	void Compile();
+
+	/** Evaluates all the animated values at the given time.
+		The program is compiled again first, if it is not up-to-date.
+		@param time The time to evaluate the animated values at. */
+	void Evaluate(float time);
+
+	/** Retrieves the number of curve evaluations within the program.
+		@return The number of curve evaluations. */
+	inline size_t GetEvaluationCount() const { return evaluations.size(); }
+
+	/** Retrieves the number of chunks that the evaluation list is cut into.
+		@return The number of evaluation chunks. */
+	size_t GetChunkCount() const;
+
+	/** [INTERNAL] Releases the worker threads shared by the animation programs.
+		Called when the FCollada library is released. */
+	static void ReleaseWorkerThreads();
+
+private:
+	void CompileDocument(FCDocument* document);
+	bool MatchDocuments(const FCDocument* document, size_t& index) const;
+	void EvaluateChunk(size_t chunk, float time);
+	static void EvaluateChunkTask(void* program, size_t chunk);
+};
+
+#endif // _FCD_ANIMATION_PROGRAM_H_
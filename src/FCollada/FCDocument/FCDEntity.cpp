@@ -40,10 +40,12 @@ FCDEntity::FCDEntity(FCDocument* document, const char* baseId)
 ,	InitializeParameterNoArg(m_Note)
 {
 	m_Extra = new FCDExtra(document, this);
+	document->RegisterPendingEntity(this);
 }
 
 FCDEntity::~FCDEntity()
 {
+	GetDocument()->UnregisterPendingEntity(this);
 }
 
 // Structure cloning
@@ -14,6 +14,12 @@
 #include "FCDocument/FCDGeometryPolygonsTools.h"
 #include "FCDocument/FCDGeometrySource.h"
 #include "FCDocument/FCDAnimated.h"
+#include "FUtils/FUThreadPool.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FCD_POLYGONS_TOOLS_SSE
+#include <xmmintrin.h>
+#endif // SSE
 
 namespace FCDGeometryPolygonsTools
 {
@@ -121,247 +127,646 @@ namespace FCDGeometryPolygonsTools
 		if (recalculate) polygons->Recalculate();
 	}
 
-	static uint32 CompressSortedVector(FMVector3& toInsert, FloatList& insertedList, UInt32List& compressIndexReferences)
+	// The cells of the welding grid are this many times as large as the tolerance.
+	static const double weldCellScale = 4.0;
+
+	// Welds values onto the first equivalent value inserted before them, through a uniform grid.
+	// Each inserted value is added to all the cells overlapped by the box of its tolerance,
+	// so that the values equivalent to a value are all found within the cell of that value.
+	// Only the first three components of the values are gridded. The cells are hashed into
+	// an open-addressing table on their coordinates, truncated to 32 bits: the cells that
+	// collide only share their list of values, which are all compared anyway.
+	class WeldGrid
 	{
-		// Look for this vector within the already inserted list.
-		size_t start = 0, end = compressIndexReferences.size(), mid;
-		for (mid = (start + end) / 2; start < end; mid = (start + end) / 2)
+	private:
+		struct Cell
+		{
+			uint32 coordinates[3];
+			uint32 firstNode; // ~0 for an empty slot.
+		};
+		struct Node
 		{
-			uint32 index = compressIndexReferences[mid];
-			if (toInsert.m_X == insertedList[3 * index]) break;
-			else if (toInsert.m_X < insertedList[3 * index]) end = mid;
-			else start = mid + 1;
+			uint32 value;
+			uint32 nextNode;
+		};
+
+		uint32 stride;
+		uint32 dimension;
+		float tolerance;
+		double inverseCellSize;
+		fm::vector<Cell, true> cells; // A power of two, kept at most half full.
+		size_t cellCount;
+		fm::vector<Node, true> nodes; // Links the values of each cell.
+		uint32 valueCount;
+
+		static inline uint32 HashCell(const uint32* coordinates)
+		{
+			uint64 hash = ((uint64) coordinates[0] * 0x9E3779B97F4A7C15ULL) ^ ((uint64) coordinates[1] * 0xC2B2AE3D27D4EB4FULL) ^ ((uint64) coordinates[2] * 0x165667B19E3779F9ULL);
+			hash ^= hash >> 29;
+			hash *= 0xBF58476D1CE4E5B9ULL;
+			return (uint32) (hash >> 32);
 		}
 
-		// Look for the tolerable range within the binary-sorted dimension.
-		size_t rangeStart, rangeEnd;
-		for (rangeStart = mid; rangeStart > 0; --rangeStart)
+		inline uint32 GetCellCoordinate(double component) const
 		{
-			uint32 index = compressIndexReferences[rangeStart - 1];
-			if (!IsEquivalent(insertedList[3 * index], toInsert.m_X)) break;
+			return (uint32) (int64) floor(component * inverseCellSize);
+		}
+
+		// Retrieves the slot of a cell: either the cell or the empty slot where it belongs.
+		inline size_t FindSlot(const uint32* coordinates) const
+		{
+			size_t slotMask = cells.size() - 1;
+			for (size_t slot = HashCell(coordinates) & slotMask;; slot = (slot + 1) & slotMask)
+			{
+				const Cell& cell = cells[slot];
+				if (cell.firstNode == ~(uint32) 0 || (cell.coordinates[0] == coordinates[0] && cell.coordinates[1] == coordinates[1] && cell.coordinates[2] == coordinates[2])) return slot;
+			}
 		}
-		for (rangeEnd = min(mid + 1, compressIndexReferences.size()); rangeEnd < compressIndexReferences.size(); ++rangeEnd)
+
+		void ResizeCells(size_t slotCount)
 		{
-			uint32 index = compressIndexReferences[rangeEnd];
-			if (!IsEquivalent(insertedList[3 * index], toInsert.m_X)) break;
+			fm::vector<Cell, true> oldCells;
+			oldCells.reserve(cells.size());
+			oldCells.insert(oldCells.end(), cells.begin(), cells.end());
+			cells.clear();
+			cells.reserve(slotCount);
+			cells.resize(slotCount);
+			for (Cell* it = cells.begin(); it != cells.end(); ++it) it->firstNode = ~(uint32) 0;
+			for (const Cell* it = oldCells.begin(); it != oldCells.end(); ++it)
+			{
+				if (it->firstNode != ~(uint32) 0) cells[FindSlot(it->coordinates)] = *it;
+			}
 		}
-		FUAssert(rangeStart < rangeEnd || (rangeStart == rangeEnd && rangeEnd == compressIndexReferences.size()), return 0);
 
-		// Look for an equivalent vector within the tolerable range
-		for (size_t g = rangeStart; g < rangeEnd; ++g)
+		void AddToCell(const uint32* coordinates, uint32 value)
 		{
-			uint32 index = compressIndexReferences[g];
-			if (IsEquivalent(toInsert, *(const FMVector3*) &insertedList[3 * index])) return index;
+			Cell* cell = cells.begin() + FindSlot(coordinates);
+			if (cell->firstNode == ~(uint32) 0)
+			{
+				if (2 * (cellCount + 1) > cells.size())
+				{
+					ResizeCells(2 * cells.size());
+					cell = cells.begin() + FindSlot(coordinates);
+				}
+				memcpy(cell->coordinates, coordinates, sizeof(cell->coordinates));
+				++cellCount;
+			}
+			if (nodes.size() == nodes.capacity()) nodes.reserve(max(2 * nodes.capacity(), (size_t) 16));
+			Node node = { value, cell->firstNode };
+			cell->firstNode = (uint32) nodes.size();
+			nodes.push_back(node);
 		}
 
-		// Insert this new vector in the list and add the index reference at the correct position.
-		uint32 compressIndex = (uint32) (insertedList.size() / 3);
-		compressIndexReferences.insert(compressIndexReferences.begin() + mid, compressIndex);
-		insertedList.push_back(toInsert.m_X);
-		insertedList.push_back(toInsert.m_Y);
-		insertedList.push_back(toInsert.m_Z);
-		return compressIndex;
+	public:
+		WeldGrid(uint32 _stride, float _tolerance, size_t expectedValueCount)
+		:	stride(_stride), dimension(min(_stride, 3u)), tolerance(_tolerance)
+		,	inverseCellSize(1.0 / (weldCellScale * (double) _tolerance)), cellCount(0), valueCount(0)
+		{
+			size_t slotCount = 16;
+			while (slotCount < expectedValueCount) slotCount *= 2;
+			ResizeCells(slotCount);
+			nodes.reserve(expectedValueCount);
+		}
+
+		// Retrieves the index of the first inserted value equivalent to a value,
+		// or appends the value, with the stride of the grid, to the inserted values.
+		uint32 Insert(const float* value, FloatList& values)
+		{
+			uint32 coordinates[3] = { 0, 0, 0 };
+			for (uint32 d = 0; d < dimension; ++d) coordinates[d] = GetCellCoordinate((double) value[d]);
+
+			// Look for the first equivalent value within the cell.
+			uint32 equivalentValue = ~(uint32) 0;
+			for (uint32 n = cells[FindSlot(coordinates)].firstNode; n != ~(uint32) 0; n = nodes[n].nextNode)
+			{
+				uint32 v = nodes[n].value;
+				if (v > equivalentValue) continue;
+				const float* other = values.begin() + (size_t) v * stride;
+				uint32 d;
+				for (d = 0; d < stride; ++d)
+				{
+					if (!IsEquivalent(value[d], other[d], tolerance)) break;
+				}
+				if (d == stride) equivalentValue = v;
+			}
+			if (equivalentValue != ~(uint32) 0) return equivalentValue;
+
+			// Append this new value to the list and to the cells overlapped by its tolerance.
+			uint32 newValue = valueCount++;
+			if (values.size() + stride > values.capacity()) values.reserve(max(2 * values.capacity(), values.size() + stride));
+			values.insert(values.end(), value, value + stride);
+
+			uint32 low[3] = { 0, 0, 0 }, high[3] = { 0, 0, 0 };
+			for (uint32 d = 0; d < dimension; ++d)
+			{
+				low[d] = GetCellCoordinate((double) value[d] - (double) tolerance);
+				high[d] = GetCellCoordinate((double) value[d] + (double) tolerance);
+			}
+			for (coordinates[2] = low[2];; ++coordinates[2])
+			{
+				for (coordinates[1] = low[1];; ++coordinates[1])
+				{
+					for (coordinates[0] = low[0];; ++coordinates[0])
+					{
+						AddToCell(coordinates, newValue);
+						if (coordinates[0] == high[0]) break;
+					}
+					if (coordinates[1] == high[1]) break;
+				}
+				if (coordinates[2] == high[2]) break;
+			}
+			return newValue;
+		}
+	};
+
+	//
+	// Texture tangents
+	//
+
+	// The number of face-vertex pairs, and of tangential vertices, given to a worker thread at once.
+	static const size_t tangentChunkSize = 4096;
+
+	// The tangent math works on the three first lanes of a SSE register, or on a FMVector3.
+	// Both versions do the same operations in the same order, for the same results.
+#ifdef FCD_POLYGONS_TOOLS_SSE
+	typedef __m128 TangentVector;
+
+	static inline TangentVector LoadVector(const float* v) { return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*) v), _mm_load_ss(v + 2)); }
+	static inline void StoreVector(float* out, TangentVector v) { _mm_storel_pi((__m64*) out, v); _mm_store_ss(out + 2, _mm_movehl_ps(v, v)); }
+	static inline TangentVector MakeVector(float x, float y, float z) { return _mm_setr_ps(x, y, z, 0.0f); }
+	static inline TangentVector AddVectors(TangentVector a, TangentVector b) { return _mm_add_ps(a, b); }
+	static inline TangentVector SubtractVectors(TangentVector a, TangentVector b) { return _mm_sub_ps(a, b); }
+	static inline TangentVector ScaleVector(TangentVector a, float s) { return _mm_mul_ps(a, _mm_set1_ps(s)); }
+	static inline TangentVector DivideVector(TangentVector a, float s) { return _mm_div_ps(a, _mm_set1_ps(s)); }
+	static inline float DotVectors(TangentVector a, TangentVector b)
+	{
+		__m128 p = _mm_mul_ps(a, b);
+		return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1))), _mm_movehl_ps(p, p)));
+	}
+	static inline TangentVector CrossVectors(TangentVector a, TangentVector b)
+	{
+		__m128 a1 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)), b1 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+		__m128 a2 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2)), b2 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+		return _mm_sub_ps(_mm_mul_ps(a1, b1), _mm_mul_ps(a2, b2));
+	}
+#else
+	typedef FMVector3 TangentVector;
+
+	static inline TangentVector LoadVector(const float* v) { return FMVector3(v); }
+	static inline void StoreVector(float* out, const TangentVector& v) { out[0] = v.m_X; out[1] = v.m_Y; out[2] = v.m_Z; }
+	static inline TangentVector MakeVector(float x, float y, float z) { return FMVector3(x, y, z); }
+	static inline TangentVector AddVectors(const TangentVector& a, const TangentVector& b) { return a + b; }
+	static inline TangentVector SubtractVectors(const TangentVector& a, const TangentVector& b) { return a - b; }
+	static inline TangentVector ScaleVector(const TangentVector& a, float s) { return a * s; }
+	static inline TangentVector DivideVector(const TangentVector& a, float s) { return a / s; }
+	static inline float DotVectors(const TangentVector& a, const TangentVector& b) { return a * b; }
+	static inline TangentVector CrossVectors(const TangentVector& a, const TangentVector& b) { return a ^ b; }
+#endif // FCD_POLYGONS_TOOLS_SSE
+
+	static inline TangentVector NormalizeVector(TangentVector v, TangentVector fallback)
+	{
+		float length = sqrtf(DotVectors(v, v));
+		return (length > 0.0f) ? DivideVector(v, length) : fallback;
 	}
 
-	struct TangentialVertex
+	// Takes a vector out of the plane of a normal.
+	static inline TangentVector ProjectVector(TangentVector v, TangentVector normal)
 	{
-		float* normalPointer;
-		float* texCoordPointer;
-		FMVector3 tangent;
-		uint32 count;
-		uint32 tangentId;
-		uint32 binormalId;
+		return SubtractVectors(v, ScaleVector(normal, DotVectors(v, normal)));
+	}
+
+	// A polygons set whose texture tangents are generated.
+	struct TangentPolygons
+	{
+		FCDGeometryPolygons* polygons;
+		FCDGeometryPolygonsInput* texcoordInput;
+		const uint32* positionIndices;
+		const uint32* normalIndices;
+		const uint32* texcoordIndices;
+		const float* positionData;
+		const float* normalData;
+		const float* texcoordData;
+		uint32 positionStride;
+		uint32 normalStride;
+		uint32 texcoordStride;
+		const uint32* positionKeys; // For the MikkTSpace convention: the first index of each position value.
+		const uint32* normalKeys;
+		uint32 positionKeyBase; // Keeps apart the values of different sources.
+		uint32 normalKeyBase;
+		size_t firstCorner; // The index of the first face-vertex pair of the set, among all the sets.
+		size_t cornerCount;
 	};
-	typedef fm::vector<TangentialVertex> TangentialVertexList;
+	typedef fm::vector<TangentPolygons> TangentPolygonsList;
 
-	// Generates the texture tangents and binormals for a given source of texture coordinates.
-	void GenerateTextureTangentBasis(FCDGeometryMesh* mesh, FCDGeometrySource* texcoordSource, bool generateBinormals)
+	// A chunk of faces, processed on one thread.
+	struct TangentFaceChunk
 	{
-		if (texcoordSource == nullptr || mesh == nullptr) return;
+		size_t polygons;
+		size_t firstFace;
+		size_t faceEnd;
+		size_t firstCorner; // Within the polygons set.
+	};
+	typedef fm::vector<TangentFaceChunk> TangentFaceChunkList;
+
+	// The state of one texture tangent generation, shared by its tasks.
+	struct TangentGeneration
+	{
+		TangentBasisConvention convention;
+		bool generateBinormals;
+		TangentPolygonsList polygons;
+		TangentFaceChunkList faceChunks;
+		fm::vector<float, true> cornerTangents; // Four floats per face-vertex pair.
+		UInt32List cornerKeys; // Four keys per face-vertex pair: its position, normal, texture coordinate and orientation.
+		UInt32List cornerVertices; // For each face-vertex pair, its tangential vertex.
+		UInt32List vertexOffsets; // For each tangential vertex, its first face-vertex pair within the vertexCorners.
+		UInt32List vertexCorners; // The face-vertex pairs of the tangential vertices, in order.
+		fm::vector<float, true> vertexTangents; // Four floats per tangential vertex: the tangent and its handedness.
+		fm::vector<float, true> vertexBinormals; // Three floats per tangential vertex.
+	};
 
-		// First count the positions.
-		FCDGeometrySource* positionSource = mesh->FindSourceByType(FUDaeGeometryInput::POSITION);
-		if (positionSource == nullptr) return;
-		size_t globalVertexCount = positionSource->GetValueCount();
+	// The former convention: the Maya formula gives the tangent of the triangle of a face-vertex
+	// pair and its two neighbours, which is taken out of the normal of the pair and normalized.
+	// The formula is from the Maya 7.0 API documentation: "Appendix A: Tangent and binormal vectors".
+	static inline TangentVector CalculateAveragedTangent(const float* previousPosition, const float* currentPosition, const float* nextPosition,
+		const float* previousTexcoord, const float* currentTexcoord, const float* nextTexcoord, TangentVector normal)
+	{
+		TangentVector current = LoadVector(currentPosition);
+		TangentVector previousDisplacement = SubtractVectors(LoadVector(previousPosition), current);
+		TangentVector nextDisplacement = SubtractVectors(LoadVector(nextPosition), current);
+		float previousU = previousTexcoord[0] - currentTexcoord[0], previousV = previousTexcoord[1] - currentTexcoord[1];
+		float nextU = nextTexcoord[0] - currentTexcoord[0], nextV = nextTexcoord[1] - currentTexcoord[1];
+		float determinant = nextU * previousV - nextV * previousU;
+		if (IsEquivalent(determinant, 0.0f)) determinant = 1.0f; // degenerate
+
+		TangentVector tangent = DivideVector(SubtractVectors(ScaleVector(previousDisplacement, nextV), ScaleVector(nextDisplacement, previousV)), determinant);
+		return NormalizeVector(ProjectVector(tangent, normal), MakeVector(0.0f, 0.0f, 1.0f));
+	}
 
-		// Allocate the tangential vertices.
-		// This temporary buffer is necessary to ensure we have smooth tangents/binormals.
-		TangentialVertexList* globalVertices = new TangentialVertexList[globalVertexCount];
-		memset(globalVertices, 0, sizeof(TangentialVertexList) * globalVertexCount);
+	// The MikkTSpace convention: the tangent of the triangle, along the first texture coordinate
+	// and flipped when the triangle mirrors the texture, is taken out of the normal of the face-vertex
+	// pair, normalized, then weighted by the angle of the corner within the plane of the normal.
+	static inline TangentVector CalculateMikkTSpaceTangent(const float* previousPosition, const float* currentPosition, const float* nextPosition,
+		const float* previousTexcoord, const float* currentTexcoord, const float* nextTexcoord, TangentVector normal, bool& orientationPreserving)
+	{
+		TangentVector zero = MakeVector(0.0f, 0.0f, 0.0f);
+		TangentVector current = LoadVector(currentPosition);
+		TangentVector nextEdge = SubtractVectors(LoadVector(nextPosition), current);
+		TangentVector previousEdge = SubtractVectors(LoadVector(previousPosition), current);
+		float nextU = nextTexcoord[0] - currentTexcoord[0], nextV = nextTexcoord[1] - currentTexcoord[1];
+		float previousU = previousTexcoord[0] - currentTexcoord[0], previousV = previousTexcoord[1] - currentTexcoord[1];
+		float signedArea = nextU * previousV - nextV * previousU;
+
+		// The degenerate triangles join the orientation-preserving vertices, without any weight.
+		orientationPreserving = !(signedArea < 0.0f);
+		if (fabsf(signedArea) <= FLT_MIN) return zero;
+		TangentVector tangent = SubtractVectors(ScaleVector(nextEdge, previousV), ScaleVector(previousEdge, nextV));
+		if (!orientationPreserving) tangent = ScaleVector(tangent, -1.0f);
+		tangent = NormalizeVector(ProjectVector(tangent, normal), zero);
+
+		TangentVector previousDirection = NormalizeVector(ProjectVector(previousEdge, normal), zero);
+		TangentVector nextDirection = NormalizeVector(ProjectVector(nextEdge, normal), zero);
+		float cosine = max(-1.0f, min(1.0f, DotVectors(previousDirection, nextDirection)));
+		return ScaleVector(tangent, acosf(cosine));
+	}
 
-		// This operation is done on the tessellation: fill in the list of tangential vertices.
-		size_t polygonsCount = mesh->GetPolygonsCount();
-		for (size_t i = 0; i < polygonsCount; ++i)
+	// Calculates the tangents of the face-vertex pairs of a chunk of faces, along with their keys.
+	static void CalculateCornerTangentsTask(void* userData, size_t index)
+	{
+		TangentGeneration& generation = *(TangentGeneration*) userData;
+		const TangentFaceChunk& chunk = generation.faceChunks[index];
+		const TangentPolygons& set = generation.polygons[chunk.polygons];
+		const uint32* faceVertexCounts = set.polygons->GetFaceVertexCounts();
+		bool mikkTSpace = generation.convention == TANGENT_BASIS_MIKKTSPACE;
+
+		size_t faceOffset = chunk.firstCorner;
+		for (size_t f = chunk.firstFace; f < chunk.faceEnd; ++f)
 		{
-			FCDGeometryPolygons* polygons = mesh->GetPolygons(i);
+			size_t faceVertexCount = faceVertexCounts[f];
+			for (size_t v = 0; v < faceVertexCount; ++v)
+			{
+				size_t previous = faceOffset + ((v > 0) ? v - 1 : faceVertexCount - 1);
+				size_t current = faceOffset + v;
+				size_t next = faceOffset + ((v + 1 < faceVertexCount) ? v + 1 : 0);
+				const float* previousPosition = set.positionData + set.positionIndices[previous] * set.positionStride;
+				const float* currentPosition = set.positionData + set.positionIndices[current] * set.positionStride;
+				const float* nextPosition = set.positionData + set.positionIndices[next] * set.positionStride;
+				const float* previousTexcoord = set.texcoordData + set.texcoordIndices[previous] * set.texcoordStride;
+				const float* currentTexcoord = set.texcoordData + set.texcoordIndices[current] * set.texcoordStride;
+				const float* nextTexcoord = set.texcoordData + set.texcoordIndices[next] * set.texcoordStride;
+				TangentVector normal = LoadVector(set.normalData + set.normalIndices[current] * set.normalStride);
+
+				size_t corner = set.firstCorner + current;
+				uint32* keys = generation.cornerKeys.begin() + 4 * corner;
+				bool orientationPreserving = true;
+				TangentVector tangent;
+				if (mikkTSpace)
+				{
+					tangent = CalculateMikkTSpaceTangent(previousPosition, currentPosition, nextPosition, previousTexcoord, currentTexcoord, nextTexcoord, normal, orientationPreserving);
+					keys[0] = set.positionKeyBase + set.positionKeys[set.positionIndices[current]];
+					keys[1] = set.normalKeyBase + set.normalKeys[set.normalIndices[current]];
+				}
+				else
+				{
+					tangent = CalculateAveragedTangent(previousPosition, currentPosition, nextPosition, previousTexcoord, currentTexcoord, nextTexcoord, normal);
+					keys[0] = set.positionKeyBase + set.positionIndices[current];
+					keys[1] = set.normalKeyBase + set.normalIndices[current];
+				}
+				keys[2] = set.texcoordIndices[current];
+				keys[3] = orientationPreserving ? 1 : 0;
+				StoreVector(generation.cornerTangents.begin() + 4 * corner, tangent);
+			}
+			faceOffset += faceVertexCount;
+		}
+	}
 
-			// Verify that this polygons set uses the given texture coordinate source.
-			FCDGeometryPolygonsInput* texcoordInput = polygons->FindInput(texcoordSource);
-			if (texcoordInput == nullptr) continue;
+	// Sums the tangents of the face-vertex pairs of a chunk of tangential vertices, in order,
+	// then calculates their tangents and binormals.
+	static void CalculateVertexTangentsTask(void* userData, size_t index)
+	{
+		TangentGeneration& generation = *(TangentGeneration*) userData;
+		size_t vertexCount = generation.vertexOffsets.size() - 1;
+		size_t start = index * tangentChunkSize, end = min(vertexCount, start + tangentChunkSize);
+		for (size_t v = start; v < end; ++v)
+		{
+			const uint32* corners = generation.vertexCorners.begin() + generation.vertexOffsets[v];
+			size_t cornerCount = generation.vertexOffsets[v + 1] - generation.vertexOffsets[v];
+			TangentVector sum = LoadVector(generation.cornerTangents.begin() + 4 * corners[0]);
+			for (size_t c = 1; c < cornerCount; ++c) sum = AddVectors(sum, LoadVector(generation.cornerTangents.begin() + 4 * corners[c]));
+
+			TangentVector xAxis = MakeVector(1.0f, 0.0f, 0.0f);
+			TangentVector tangent = NormalizeVector(sum, xAxis);
+			float handedness = (generation.cornerKeys[4 * corners[0] + 3] != 0) ? 1.0f : -1.0f;
+			StoreVector(generation.vertexTangents.begin() + 4 * v, tangent);
+			generation.vertexTangents[4 * v + 3] = handedness;
+
+			if (generation.generateBinormals)
+			{
+				// Find the normal of the tangential vertex, through its first face-vertex pair.
+				const TangentPolygons* set = generation.polygons.end() - 1;
+				while (set->firstCorner > corners[0]) --set;
+				const float* normal = set->normalData + set->normalIndices[corners[0] - set->firstCorner] * set->normalStride;
+				TangentVector binormal = ScaleVector(NormalizeVector(CrossVectors(LoadVector(normal), tangent), xAxis), handedness);
+				StoreVector(generation.vertexBinormals.begin() + 3 * v, binormal);
+			}
+		}
+	}
 
-			// Retrieve the data and index buffer of positions/normals/texcoords for this polygons set.
-			FCDGeometryPolygonsInput* positionInput = polygons->FindInput(FUDaeGeometryInput::POSITION);
-			FCDGeometryPolygonsInput* normalsInput = polygons->FindInput(FUDaeGeometryInput::NORMAL);
-			if (positionInput == nullptr || normalsInput == nullptr) continue;
-			FCDGeometrySource* currentPositionSource = positionInput->GetSource();
-			FCDGeometrySource* normalsSource = normalsInput->GetSource();
-			FCDGeometrySource* currentTexcoordSource = texcoordInput->GetSource();
-			if (currentPositionSource == nullptr || normalsSource == nullptr || currentTexcoordSource == nullptr) continue;
-			uint32 positionStride = currentPositionSource->GetStride();
-			uint32 normalsStride = normalsSource->GetStride();
-			uint32 texcoordStride = currentTexcoordSource->GetStride();
-			if (positionStride < 3 || normalsStride < 3 || texcoordStride < 2) continue;
-			uint32* positionIndices = positionInput->GetIndices();
-			uint32* normalsIndices = normalsInput->GetIndices();
-			uint32* texcoordIndices = texcoordInput->GetIndices();
-			size_t indexCount = positionInput->GetIndexCount();
-			if (positionIndices == nullptr || normalsIndices == nullptr || texcoordIndices == nullptr) continue;
-			if (indexCount == 0 || indexCount != normalsInput->GetIndexCount() || indexCount != texcoordInput->GetIndexCount()) continue;
-			float* positionData = currentPositionSource->GetData();
-			float* normalsData = normalsSource->GetData();
-			float* texcoordData = currentTexcoordSource->GetData();
-			size_t positionDataLength = currentPositionSource->GetDataCount();
-			size_t normalsDataLength = normalsSource->GetDataCount();
-			size_t texcoordDataLength = currentTexcoordSource->GetDataCount();
-			if (positionDataLength == 0 || normalsDataLength == 0 || texcoordDataLength == 0) continue;
-
-			// Iterate of the faces of the polygons set. This includes holes.
-			size_t faceCount = polygons->GetFaceVertexCountCount();
-			size_t faceVertexOffset = 0;
-			for (size_t faceIndex = 0; faceIndex < faceCount; ++faceIndex)
+	static inline bool AreIndicesInRange(const uint32* indices, size_t indexCount, size_t valueCount)
+	{
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			if (indices[i] >= valueCount) return false;
+		}
+		return true;
+	}
+
+	// Finds, for each value of a source, the first value with the same components.
+	static void FindFirstEqualValues(const FCDGeometrySource* source, UInt32List& firstValues)
+	{
+		size_t valueCount = source->GetValueCount();
+		uint32 stride = source->GetStride();
+		const float* data = source->GetData();
+		firstValues.resize(valueCount);
+
+		size_t slotCount = 16;
+		while (slotCount < 2 * valueCount) slotCount *= 2;
+		size_t slotMask = slotCount - 1;
+		UInt32List slots(slotCount, ~(uint32) 0);
+		for (size_t i = 0; i < valueCount; ++i)
+		{
+			const float* value = data + i * stride;
+			uint32 hash = 0x9E3779B9;
+			for (uint32 d = 0; d < stride; ++d)
 			{
-				size_t faceVertexCount = polygons->GetFaceVertexCounts()[faceIndex];
-				for (size_t vertexIndex = 0; vertexIndex < faceVertexCount; ++vertexIndex)
+				float component = value[d] + 0.0f; // Merges the negative zeroes.
+				uint32 bits;
+				memcpy(&bits, &component, sizeof(bits));
+				hash = (hash ^ bits) * 0x85EBCA6B;
+				hash ^= hash >> 13;
+			}
+			for (size_t slot = hash & slotMask;; slot = (slot + 1) & slotMask)
+			{
+				uint32 other = slots[slot];
+				if (other == ~(uint32) 0) { slots[slot] = (uint32) i; firstValues[i] = (uint32) i; break; }
+				const float* otherValue = data + other * stride;
+				uint32 d;
+				for (d = 0; d < stride; ++d)
 				{
-					// For each face-vertex pair, retrieve the current/previous/next vertex position/normal/texcoord.
-					size_t previousVertexIndex = (vertexIndex > 0) ? vertexIndex - 1 : faceVertexCount - 1;
-					size_t nextVertexIndex = (vertexIndex < faceVertexCount - 1) ? vertexIndex + 1 : 0;
-					FMVector3& previousPosition = *(FMVector3*)&positionData[positionIndices[faceVertexOffset + previousVertexIndex] * positionStride];
-					FMVector2& previousTexcoord = *(FMVector2*)&texcoordData[texcoordIndices[faceVertexOffset + previousVertexIndex] * texcoordStride];
-					FMVector3& currentPosition = *(FMVector3*)&positionData[positionIndices[faceVertexOffset + vertexIndex] * positionStride];
-					float* texcoordPtr = &texcoordData[texcoordIndices[faceVertexOffset + vertexIndex] * texcoordStride];
-					FMVector2& currentTexcoord = *(FMVector2*)texcoordPtr;
-					FMVector3& nextPosition = *(FMVector3*)&positionData[positionIndices[faceVertexOffset + nextVertexIndex] * positionStride];
-					FMVector2& nextTexcoord = *(FMVector2*)&texcoordData[texcoordIndices[faceVertexOffset + nextVertexIndex] * texcoordStride];
-					float* normalPtr = &normalsData[normalsIndices[faceVertexOffset + vertexIndex] * normalsStride];
-					FMVector3& normal = *(FMVector3*)normalPtr;
-
-					// The formulae to calculate the tangent-space basis vectors is taken from Maya 7.0 API documentation:
-					// "Appendix A: Tangent and binormal vectors".
-
-					// Prepare the edge vectors.
-					FMVector3 previousEdge(0.0f, previousTexcoord.x - currentTexcoord.x, previousTexcoord.y - currentTexcoord.y);
-					FMVector3 nextEdge(0.0f, nextTexcoord.x - currentTexcoord.x, nextTexcoord.y - currentTexcoord.y);
-					FMVector3 previousDisplacement = (previousPosition - currentPosition);
-					FMVector3 nextDisplacement = (nextPosition - currentPosition);
-					FMVector3 tangent;
-
-					// Calculate the X-coordinate of the tangent vector.
-					previousEdge.m_X = previousDisplacement.m_X;
-					nextEdge.m_X = nextDisplacement.m_X;
-					FMVector3 crossEdge = nextEdge ^ previousEdge;
-					if (IsEquivalent(crossEdge.m_X, 0.0f)) crossEdge.m_X = 1.0f; // degenerate
-					tangent.m_X = crossEdge.m_Y / crossEdge.m_X;
-
-					// Calculate the Y-coordinate of the tangent vector.
-					previousEdge.m_X = previousDisplacement.m_Y;
-					nextEdge.m_X = nextDisplacement.m_Y;
-					crossEdge = nextEdge ^ previousEdge;
-					if (IsEquivalent(crossEdge.m_X, 0.0f)) crossEdge.m_X = 1.0f; // degenerate
-					tangent.m_Y = crossEdge.m_Y / crossEdge.m_X;
-
-					// Calculate the Z-coordinate of the tangent vector.
-					previousEdge.m_X = previousDisplacement.m_Z;
-					nextEdge.m_X = nextDisplacement.m_Z;
-					crossEdge = nextEdge ^ previousEdge;
-					if (IsEquivalent(crossEdge.m_X, 0.0f)) crossEdge.m_X = 1.0f; // degenerate
-					tangent.m_Z = crossEdge.m_Y / crossEdge.m_X;
-
-					// Take the normal vector at this face-vertex pair, out of the calculated tangent vector
-					tangent = tangent - normal * (tangent * normal);
-					tangent.NormalizeIt();
-
-					// Add this tangent to our tangential vertex.
-					FUAssert(positionIndices[faceVertexOffset + vertexIndex] < globalVertexCount, continue);
-					TangentialVertexList& list = globalVertices[positionIndices[faceVertexOffset + vertexIndex]];
-					size_t vertexCount = list.size();
-					bool found = false;
-					for (size_t v = 0; v < vertexCount; ++v)
-					{
-						if ((normalPtr == list[v].normalPointer) && (texcoordPtr == list[v].texCoordPointer))
-						{
-							list[v].tangent += tangent;
-							list[v].count++;
-							found = true;
-						}
-					}
-					if (!found)
-					{
-						TangentialVertex v;
-						v.normalPointer = normalPtr;
-						v.texCoordPointer = texcoordPtr;
-						v.count = 1; v.tangent = tangent;
-						v.tangentId = v.binormalId = ~(uint32)0;
-						list.push_back(v);
-					}
+					if (value[d] != otherValue[d]) break;
 				}
-				faceVertexOffset += faceVertexCount;
+				if (d == stride) { firstValues[i] = other; break; }
 			}
 		}
+	}
 
-		FCDGeometrySource* tangentSource = nullptr;
-		FCDGeometrySource* binormalSource = nullptr;
-		FloatList tangentData;
-		FloatList binormalData;
-		UInt32List tangentCompressionIndices;
-		UInt32List binormalCompressionIndices;
+	// Retrieves the keys of a source within the face-vertex pair keys.
+	static void FindSourceKeys(const FCDGeometrySource* source, bool mikkTSpace, fm::pvector<const FCDGeometrySource>& keySources,
+		UInt32List& keyBases, FCDNewIndicesList& keyValues, uint32& keyBase, const uint32*& keys)
+	{
+		size_t s = keySources.find(source) - keySources.begin();
+		if (s == keySources.size())
+		{
+			keySources.push_back(source);
+			keyBases.push_back((s > 0) ? keyBases.back() + (uint32) keySources[s - 1]->GetValueCount() : 0);
+			keyValues.push_back(UInt32List());
+			if (mikkTSpace) FindFirstEqualValues(source, keyValues.back());
+		}
+		keyBase = keyBases[s];
+		keys = keyValues[s].begin();
+	}
+
+	// Groups the face-vertex pairs with the same keys into tangential vertices, numbered in the order
+	// of their first face-vertex pair, and lists the face-vertex pairs of each tangential vertex in order.
+	static void GroupTangentialVertices(TangentGeneration& generation, size_t cornerCount)
+	{
+		size_t slotCount = 16;
+		while (slotCount < 2 * cornerCount) slotCount *= 2;
+		size_t slotMask = slotCount - 1;
+		UInt32List slots(slotCount, ~(uint32) 0);
+		UInt32List& vertexOffsets = generation.vertexOffsets;
+		vertexOffsets.clear();
+		generation.cornerVertices.resize(cornerCount);
+		const uint32* cornerKeys = generation.cornerKeys.begin();
+		uint32 vertexCount = 0;
+		for (size_t c = 0; c < cornerCount; ++c)
+		{
+			const uint32* keys = cornerKeys + 4 * c;
+			uint32 hash = 0x9E3779B9;
+			for (size_t k = 0; k < 4; ++k)
+			{
+				hash = (hash ^ keys[k]) * 0x85EBCA6B;
+				hash ^= hash >> 13;
+			}
+			for (size_t slot = hash & slotMask;; slot = (slot + 1) & slotMask)
+			{
+				uint32 other = slots[slot];
+				if (other == ~(uint32) 0)
+				{
+					slots[slot] = (uint32) c;
+					generation.cornerVertices[c] = vertexCount++;
+					break;
+				}
+				if (memcmp(cornerKeys + 4 * other, keys, sizeof(uint32) * 4) == 0)
+				{
+					generation.cornerVertices[c] = generation.cornerVertices[other];
+					break;
+				}
+			}
+		}
+
+		// Count the face-vertex pairs of each tangential vertex, then fill them in backwards.
+		vertexOffsets.resize(vertexCount + 1, 0);
+		for (size_t c = 0; c < cornerCount; ++c) ++vertexOffsets[generation.cornerVertices[c] + 1];
+		for (size_t v = 0; v < vertexCount; ++v) vertexOffsets[v + 1] += vertexOffsets[v];
+		generation.vertexCorners.resize(cornerCount);
+		UInt32List ends(vertexOffsets.begin() + 1, vertexCount);
+		for (size_t c = cornerCount; c > 0; --c) generation.vertexCorners[--ends[generation.cornerVertices[c - 1]]] = (uint32) (c - 1);
+	}
+
+	static void RunTangentTasks(FUThreadPool* pool, FUThreadPool::TaskFunction function, TangentGeneration& generation, size_t taskCount)
+	{
+		if (pool != nullptr && taskCount > 1) pool->Run(function, &generation, taskCount);
+		else for (size_t t = 0; t < taskCount; ++t) (*function)(&generation, t);
+	}
 
-		// Iterate over the polygons again: this time create the source/inputs for the tangents and binormals.
+	// Generates the texture tangents and binormals for a given source of texture coordinates.
+	void GenerateTextureTangentBasis(FCDGeometryMesh* mesh, FCDGeometrySource* texcoordSource, bool generateBinormals)
+	{
+		GenerateTextureTangentBasis(mesh, texcoordSource, generateBinormals, TANGENT_BASIS_AVERAGED);
+	}
+
+	void GenerateTextureTangentBasis(FCDGeometryMesh* mesh, FCDGeometrySource* texcoordSource, bool generateBinormals, TangentBasisConvention convention, size_t threadCount)
+	{
+		if (texcoordSource == nullptr || mesh == nullptr) return;
+		bool mikkTSpace = convention == TANGENT_BASIS_MIKKTSPACE;
+
+		TangentGeneration generation;
+		generation.convention = convention;
+		generation.generateBinormals = generateBinormals;
+		fm::pvector<const FCDGeometrySource> keySources;
+		UInt32List keyBases;
+		FCDNewIndicesList keyValues;
+		UInt32List texcoordKeys;
+		if (mikkTSpace) FindFirstEqualValues(texcoordSource, texcoordKeys);
+
+		// List the polygons sets that use the given texture coordinate source, along with their positions and normals.
+		size_t cornerCount = 0;
+		size_t polygonsCount = mesh->GetPolygonsCount();
 		for (size_t i = 0; i < polygonsCount; ++i)
 		{
 			FCDGeometryPolygons* polygons = mesh->GetPolygons(i);
-
-			// Verify that this polygons set uses the given texture coordinate source.
 			FCDGeometryPolygonsInput* texcoordInput = polygons->FindInput(texcoordSource);
 			if (texcoordInput == nullptr) continue;
 
-			// Retrieve the data and index buffer of positions/normals/texcoords for this polygons set.
 			FCDGeometryPolygonsInput* positionInput = polygons->FindInput(FUDaeGeometryInput::POSITION);
 			FCDGeometryPolygonsInput* normalsInput = polygons->FindInput(FUDaeGeometryInput::NORMAL);
 			if (positionInput == nullptr || normalsInput == nullptr) continue;
-			FCDGeometrySource* normalsSource = normalsInput->GetSource();
-			FCDGeometrySource* currentTexcoordSource = texcoordInput->GetSource();
-			if (normalsSource == nullptr || currentTexcoordSource == nullptr) continue;
-			uint32 normalsStride = normalsSource->GetStride();
-			uint32 texcoordStride = currentTexcoordSource->GetStride();
-			if (normalsStride < 3 || texcoordStride < 2) continue;
-			uint32* positionIndices = positionInput->GetIndices();
-			uint32* normalsIndices = normalsInput->GetIndices();
-			uint32* texcoordIndices = texcoordInput->GetIndices();
+			const FCDGeometrySource* positionSource = positionInput->GetSource();
+			const FCDGeometrySource* normalsSource = normalsInput->GetSource();
+			if (positionSource == nullptr || normalsSource == nullptr) continue;
+			if (positionSource->GetStride() < 3 || normalsSource->GetStride() < 3 || texcoordSource->GetStride() < 2) continue;
 			size_t indexCount = positionInput->GetIndexCount();
-			if (positionIndices == nullptr || normalsIndices == nullptr || texcoordIndices == nullptr) continue;
 			if (indexCount == 0 || indexCount != normalsInput->GetIndexCount() || indexCount != texcoordInput->GetIndexCount()) continue;
-			float* normalsData = normalsSource->GetData();
-			float* texcoordData = currentTexcoordSource->GetData();
-			size_t normalsDataLength = normalsSource->GetDataCount();
-			size_t texcoordDataLength = currentTexcoordSource->GetDataCount();
-			if (normalsDataLength == 0 || texcoordDataLength == 0) continue;
-
-			// Create the texture tangents/binormals sources
-			if (tangentSource == nullptr)
+
+			TangentPolygons set;
+			set.polygons = polygons;
+			set.texcoordInput = texcoordInput;
+			set.positionIndices = positionInput->GetIndices();
+			set.normalIndices = normalsInput->GetIndices();
+			set.texcoordIndices = texcoordInput->GetIndices();
+			if (!AreIndicesInRange(set.positionIndices, indexCount, positionSource->GetValueCount())
+				|| !AreIndicesInRange(set.normalIndices, indexCount, normalsSource->GetValueCount())
+				|| !AreIndicesInRange(set.texcoordIndices, indexCount, texcoordSource->GetValueCount())) continue;
+
+			// The faces, including the holes, must cover the face-vertex pairs.
+			size_t faceCount = polygons->GetFaceVertexCountCount();
+			const uint32* faceVertexCounts = polygons->GetFaceVertexCounts();
+			size_t faceVertexCount = 0;
+			for (size_t f = 0; f < faceCount; ++f) faceVertexCount += faceVertexCounts[f];
+			if (faceVertexCount != indexCount) continue;
+
+			set.positionData = positionSource->GetData();
+			set.normalData = normalsSource->GetData();
+			set.texcoordData = texcoordSource->GetData();
+			set.positionStride = positionSource->GetStride();
+			set.normalStride = normalsSource->GetStride();
+			set.texcoordStride = texcoordSource->GetStride();
+			FindSourceKeys(positionSource, mikkTSpace, keySources, keyBases, keyValues, set.positionKeyBase, set.positionKeys);
+			FindSourceKeys(normalsSource, mikkTSpace, keySources, keyBases, keyValues, set.normalKeyBase, set.normalKeys);
+			set.firstCorner = cornerCount;
+			set.cornerCount = indexCount;
+
+			// Cut the faces in chunks for the worker threads.
+			TangentFaceChunk chunk = { generation.polygons.size(), 0, 0, 0 };
+			size_t chunkCorner = 0;
+			for (size_t f = 0; f < faceCount; ++f)
 			{
-				tangentSource = mesh->AddSource(FUDaeGeometryInput::TEXTANGENT);
-				tangentSource->SetDaeId(currentTexcoordSource->GetDaeId() + "-tangents");
-				tangentData.reserve(currentTexcoordSource->GetDataCount());
-				if (generateBinormals)
+				chunkCorner += faceVertexCounts[f];
+				if (chunkCorner - chunk.firstCorner >= tangentChunkSize || f + 1 == faceCount)
 				{
-					binormalSource = mesh->AddSource(FUDaeGeometryInput::TEXBINORMAL);
-					binormalSource->SetDaeId(currentTexcoordSource->GetDaeId() + "-binormals");
-					binormalData.reserve(tangentSource->GetDataCount());
+					chunk.faceEnd = f + 1;
+					generation.faceChunks.push_back(chunk);
+					chunk.firstFace = f + 1;
+					chunk.firstCorner = chunkCorner;
 				}
 			}
+			generation.polygons.push_back(set);
+			cornerCount += indexCount;
+		}
+		if (generation.polygons.empty()) return;
+
+		// Calculate the tangents of all the face-vertex pairs, then sum them up per tangential vertex, in parallel.
+		// The sums are done one tangential vertex at a time, in the order of the face-vertex pairs: the results
+		// do not depend on the number of threads.
+		FUThreadPool* pool = nullptr;
+		if (threadCount == 0) threadCount = FUThreadPool::GetProcessorCount();
+		threadCount = min(threadCount, generation.faceChunks.size());
+		if (threadCount > 1) pool = new FUThreadPool(threadCount);
+
+		generation.cornerTangents.resize(4 * cornerCount);
+		generation.cornerKeys.resize(4 * cornerCount);
+		RunTangentTasks(pool, CalculateCornerTangentsTask, generation, generation.faceChunks.size());
+		if (mikkTSpace)
+		{
+			// The texture coordinates are also welded by value.
+			for (size_t c = 0; c < cornerCount; ++c) generation.cornerKeys[4 * c + 2] = texcoordKeys[generation.cornerKeys[4 * c + 2]];
+		}
+		GroupTangentialVertices(generation, cornerCount);
+		size_t vertexCount = generation.vertexOffsets.size() - 1;
+		generation.vertexTangents.resize(4 * vertexCount);
+		if (generateBinormals) generation.vertexBinormals.resize(3 * vertexCount);
+		RunTangentTasks(pool, CalculateVertexTangentsTask, generation, (vertexCount + tangentChunkSize - 1) / tangentChunkSize);
+		SAFE_DELETE(pool);
+
+		// Weld the tangents and the binormals, in the order of the tangential vertices.
+		uint32 tangentStride = mikkTSpace ? 4 : 3;
+		FloatList tangentData, binormalData;
+		UInt32List tangentIds(vertexCount), binormalIds(generateBinormals ? vertexCount : 0);
+		WeldGrid tangentGrid(tangentStride, FLT_TOLERANCE, vertexCount);
+		WeldGrid binormalGrid(3, FLT_TOLERANCE, generateBinormals ? vertexCount : 0);
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			tangentIds[v] = tangentGrid.Insert(generation.vertexTangents.begin() + 4 * v, tangentData);
+			if (generateBinormals) binormalIds[v] = binormalGrid.Insert(generation.vertexBinormals.begin() + 3 * v, binormalData);
+		}
 
+		// Create the tangent and binormal sources, and their inputs within the polygons sets.
+		FCDGeometrySource* tangentSource = mesh->AddSource(FUDaeGeometryInput::TEXTANGENT);
+		tangentSource->SetDaeId(texcoordSource->GetDaeId() + "-tangents");
+		tangentSource->SetData(tangentData, tangentStride);
+		FCDGeometrySource* binormalSource = nullptr;
+		if (generateBinormals)
+		{
+			binormalSource = mesh->AddSource(FUDaeGeometryInput::TEXBINORMAL);
+			binormalSource->SetDaeId(texcoordSource->GetDaeId() + "-binormals");
+			binormalSource->SetData(binormalData, 3);
+		}
+
+		UInt32List indices;
+		for (TangentPolygons* it = generation.polygons.begin(); it != generation.polygons.end(); ++it)
+		{
 			// Calculate the next available offset
+			FCDGeometryPolygons* polygons = it->polygons;
 			uint32 inputOffset = 0;
 			size_t inputCount = polygons->GetInputCount();
 			for (size_t j = 0; j < inputCount; ++j)
@@ -369,219 +774,289 @@ namespace FCDGeometryPolygonsTools
 				inputOffset = max(inputOffset, polygons->GetInput(j)->GetOffset());
 			}
 
-			// Create the polygons set input for both the tangents and binormals
+			const uint32* cornerVertices = generation.cornerVertices.begin() + it->firstCorner;
+			indices.resize(it->cornerCount);
 			FCDGeometryPolygonsInput* tangentInput = polygons->AddInput(tangentSource, inputOffset + 1);
-			tangentInput->SetSet(texcoordInput->GetSet());
-			tangentInput->ReserveIndexCount(indexCount);
-			FCDGeometryPolygonsInput* binormalInput = nullptr;
+			tangentInput->SetSet(it->texcoordInput->GetSet());
+			for (size_t c = 0; c < it->cornerCount; ++c) indices[c] = tangentIds[cornerVertices[c]];
+			tangentInput->SetIndices(indices.begin(), indices.size());
 			if (binormalSource != nullptr)
 			{
-				binormalInput = polygons->AddInput(binormalSource, inputOffset + 2);
+				FCDGeometryPolygonsInput* binormalInput = polygons->AddInput(binormalSource, inputOffset + 2);
 				binormalInput->SetSet(tangentInput->GetSet());
-				binormalInput->ReserveIndexCount(indexCount);
+				for (size_t c = 0; c < it->cornerCount; ++c) indices[c] = binormalIds[cornerVertices[c]];
+				binormalInput->SetIndices(indices.begin(), indices.size());
 			}
+		}
+	}
+
+	typedef fm::pvector<FCDGeometryPolygonsInput> InputList;
+	typedef fm::pvector<FCDGeometryIndexTranslationMap> FCDGeometryIndexTranslationMapList;
+
+	// The unique vertices of one polygons set.
+	struct UniqueVertexSet
+	{
+		FCDGeometryPolygons* polygons;
+		bool process;
+		UInt32List indices; // For each face-vertex pair, the index of its unique vertex within this set.
+		UInt32List firstCorners; // For each unique vertex, its first face-vertex pair.
+		uint32 firstIndex; // The new index of the first unique vertex: the sets are numbered in order.
+	};
+	typedef fm::vector<UniqueVertexSet> UniqueVertexSetList;
+
+	// Mixes all the indices of a face-vertex pair into a hash value.
+	static inline uint32 HashIndexTuple(const uint32* const* indices, size_t listCount, size_t i)
+	{
+		uint32 hash = 0x9E3779B9;
+		for (size_t l = 0; l < listCount; ++l)
+		{
+			hash = (hash ^ indices[l][i]) * 0x85EBCA6B;
+			hash ^= hash >> 13;
+		}
+		hash *= 0xC2B2AE35;
+		return hash ^ (hash >> 16);
+	}
 
-			// Iterate of the faces of the polygons set. This includes holes.
-			size_t vertexCount = positionInput->GetIndexCount();
-			size_t faceVertexOffset = 0;
-			for (size_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+	// Merges the face-vertex pairs of a polygons set with the same indices in all its index lists.
+	static void GenerateUniqueVertices(UniqueVertexSet& set)
+	{
+		// Find all the index lists.
+		FCDGeometryPolygons* polygons = set.polygons;
+		InputList idxOwners;
+		size_t inputCount = polygons->GetInputCount();
+		for (size_t i = 0; i < inputCount; ++i)
+		{
+			FCDGeometryPolygonsInput* input = polygons->GetInput(i);
+			if (input->OwnsIndices())
+			{
+				// Drop index lists with the wrong number of values and avoid repeats
+				FUAssert(idxOwners.empty() || idxOwners.front()->GetIndexCount() == input->GetIndexCount(), continue);
+				if (idxOwners.find(input) == idxOwners.end()) idxOwners.push_back(input);
+			}
+		}
+		size_t listCount = idxOwners.size();
+		if (listCount == 0) return; // no inputs?
+
+		fm::pvector<const uint32> indices;
+		indices.reserve(listCount);
+		for (size_t l = 0; l < listCount; ++l) indices.push_back(idxOwners[l]->GetIndices());
+		size_t indexCount = idxOwners.front()->GetIndexCount();
+
+		// An open-addressing hash table, at most half full, with linear probing.
+		// Each slot holds a unique vertex and its hash value, which rejects most
+		// of the other unique vertices without looking at their indices.
+		size_t slotCount = 16;
+		while (slotCount < 2 * indexCount) slotCount *= 2;
+		size_t slotMask = slotCount - 1;
+		UInt32List slots;
+		slots.resize(2 * slotCount, ~(uint32) 0);
+
+		set.indices.resize(indexCount);
+		set.firstCorners.resize(indexCount);
+		uint32* outIndices = set.indices.begin();
+		uint32* firstCorners = set.firstCorners.begin();
+		uint32 uniqueCount = 0;
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			uint32 hash = HashIndexTuple(indices.begin(), listCount, i);
+			size_t slot = hash & slotMask;
+			for (;; slot = (slot + 1) & slotMask)
 			{
-				// For each face-vertex pair retrieve the current vertex normal&texcoord.
-				float* normalPtr = &normalsData[normalsIndices[faceVertexOffset + vertexIndex] * normalsStride];
-				float* texcoordPtr =
-						&texcoordData[texcoordIndices[faceVertexOffset + vertexIndex] * texcoordStride];
-
-				FUAssert(positionIndices[faceVertexOffset + vertexIndex] < globalVertexCount, continue);
-				TangentialVertexList& list = globalVertices[positionIndices[faceVertexOffset + vertexIndex]];
-				for (size_t v = 0; v < list.size(); ++v)
+				uint32 vertex = slots[2 * slot];
+				if (vertex == ~(uint32) 0)
 				{
-					if ((list[v].normalPointer == normalPtr) && (list[v].texCoordPointer == texcoordPtr))
-					{
-						if (list[v].tangentId == ~(uint32)0)
-						{
-							list[v].tangent /= (float) list[v].count; // Average the tangent.
-							list[v].tangent.Normalize();
-							list[v].tangentId = CompressSortedVector(list[v].tangent, tangentData, tangentCompressionIndices);
-						}
-						tangentInput->AddIndex(list[v].tangentId);
+					// A new unique vertex.
+					slots[2 * slot] = uniqueCount;
+					slots[2 * slot + 1] = hash;
+					firstCorners[uniqueCount] = (uint32) i;
+					outIndices[i] = uniqueCount++;
+					break;
+				}
+				if (slots[2 * slot + 1] != hash) continue;
 
-						if (binormalInput != nullptr)
-						{
-							if (list[v].binormalId == ~(uint32)0)
-							{
-								// Calculate and store the binormal.
-								FMVector3 binormal = (*(FMVector3*)normalPtr ^ list[v].tangent).Normalize();
-								uint32 compressedIndex = CompressSortedVector(binormal, binormalData, binormalCompressionIndices);
-								list[v].binormalId = compressedIndex;
-							}
-							binormalInput->AddIndex(list[v].binormalId);
-						}
-					}
+				size_t firstCorner = firstCorners[vertex], l;
+				for (l = 0; l < listCount; ++l)
+				{
+					if (indices[l][i] != indices[l][firstCorner]) break;
+				}
+				if (l == listCount)
+				{
+					// We have a match: re-use this index.
+					outIndices[i] = vertex;
+					break;
 				}
 			}
 		}
+		set.firstCorners.resize(uniqueCount);
+	}
 
-		if (tangentSource != nullptr) tangentSource->SetData(tangentData, 3);
-		if (binormalSource != nullptr) binormalSource->SetData(binormalData, 3);
+	static void GenerateUniqueVerticesTask(void* userData, size_t index)
+	{
+		UniqueVertexSet& set = ((UniqueVertexSet*) userData)[index];
+		if (set.process) GenerateUniqueVertices(set);
 	}
 
-	struct HashIndexMapItem { UInt32List allValues; UInt32List newIndex; };
-	typedef fm::vector<UInt32List> UInt32ListList;
-	typedef fm::pvector<FCDGeometryPolygonsInput> InputList;
-	typedef fm::map<uint32, HashIndexMapItem> HashIndexMap;
-	typedef fm::pvector<FCDGeometryIndexTranslationMap> FCDGeometryIndexTranslationMapList;
+	// The smallest number of face-vertex pairs worth merging on worker threads.
+	static const size_t uniqueVertexParallelCount = 16384;
 
-	void GenerateUniqueIndices(FCDGeometryMesh* mesh, FCDGeometryPolygons* polygonsToProcess, FCDNewIndicesList& outIndices, FCDGeometryIndexTranslationMapList& outTranslationMaps)
+	// Generates the unique vertices of the polygons sets to process, each on its own thread.
+	// Returns false, with nothing generated past it, when a set of points is found.
+	static bool GenerateUniqueVertexSets(FCDGeometryMesh* mesh, FCDGeometryPolygons* polygonsToProcess, UniqueVertexSetList& sets)
 	{
-		// Prepare a list of unique index buffers.
 		size_t polygonsCount = mesh->GetPolygonsCount();
-		if (polygonsCount == 0) return;
-		size_t totalVertexCount = 0;
-
-		size_t outIndicesMinSize = (polygonsToProcess == nullptr) ? polygonsCount : 1;
-		if (outIndices.size() < outIndicesMinSize) outIndices.resize(outIndicesMinSize);
-
-		// Fill in the index buffers for each polygons set.
-		for (size_t p = 0; p < polygonsCount; ++p)
+		sets.resize(polygonsCount);
+		size_t setCount = 0, processCount = 0, faceVertexCount = 0;
+		bool hasPoints = false;
+		for (; setCount < polygonsCount; ++setCount)
 		{
-			FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
+			UniqueVertexSet& set = sets[setCount];
+			set.polygons = mesh->GetPolygons(setCount);
+			set.process = false;
+			set.firstIndex = 0;
+
 			// DO NOT -EVER- TOUCH MY INDICES - (Says Psuedo-FCDGeometryPoints)
 			// Way to much code assumes (and carefully guards) the existing sorted structure
-			if (polygons->GetPrimitiveType() == FCDGeometryPolygons::POINTS) return;
-			if (polygonsToProcess != nullptr && polygons != polygonsToProcess) continue;
+			if (set.polygons->GetPrimitiveType() == FCDGeometryPolygons::POINTS) { hasPoints = true; break; }
+			set.process = polygonsToProcess == nullptr || set.polygons == polygonsToProcess;
+			if (set.process && set.polygons->GetInputCount() > 0) { ++processCount; faceVertexCount += set.polygons->GetInput(0)->GetIndexCount(); }
+		}
+		for (size_t p = setCount; p < polygonsCount; ++p) { sets[p].polygons = mesh->GetPolygons(p); sets[p].process = false; sets[p].firstIndex = 0; }
 
-			// Find the list we are going to pump our new indices into
-			UInt32List& outPolyIndices = (polygonsToProcess == nullptr) ? outIndices[p] : outIndices.front();
+		// The polygons sets only read their own indices: merge them in parallel.
+		size_t threadCount = min(processCount, FUThreadPool::GetProcessorCount());
+		if (threadCount <= 1 || faceVertexCount < uniqueVertexParallelCount)
+		{
+			for (size_t p = 0; p < setCount; ++p) GenerateUniqueVerticesTask(sets.begin(), p);
+		}
+		else
+		{
+			FUThreadPool pool(threadCount);
+			pool.Run(GenerateUniqueVerticesTask, sets.begin(), setCount);
+		}
 
-			// Find all the indices list to determine the hash size.
-			InputList idxOwners;
-			size_t inputCount = polygons->GetInputCount();
-			for (size_t i = 0; i < inputCount; ++i)
+		// Number the unique vertices of the sets one after the other.
+		uint32 vertexCount = 0;
+		for (size_t p = 0; p < setCount; ++p)
+		{
+			sets[p].firstIndex = vertexCount;
+			vertexCount += (uint32) sets[p].firstCorners.size();
+		}
+		return !hasPoints;
+	}
+
+	// Lists, for each value of a source, the new indices of the unique vertices that use it.
+	static void GenerateTranslationTable(FCDGeometrySource* source, const UniqueVertexSetList& sets, FCDGeometryIndexTranslationTable& table)
+	{
+		size_t valueCount = source->GetValueCount();
+		table.offsets.clear();
+		table.offsets.resize(valueCount + 1, 0);
+		table.values.clear();
+		if (valueCount == 0) return;
+
+		// Count the new indices of each value, then find where each list ends.
+		uint32* offsets = table.offsets.begin();
+		for (const UniqueVertexSet* set = sets.begin(); set != sets.end(); ++set)
+		{
+			if (!set->process) continue;
+			FCDGeometryPolygonsInput* input = set->polygons->FindInput(source);
+			if (input == nullptr || input->GetIndices() == nullptr) continue;
+			const uint32* oldIndices = input->GetIndices();
+			size_t oldIndexCount = input->GetIndexCount();
+			for (const uint32* corner = set->firstCorners.begin(); corner != set->firstCorners.end(); ++corner)
 			{
-				if (polygons->GetInput(i)->OwnsIndices())
-				{
-					// Drop index lists with the wrong number of values and avoid repeats
-					FUAssert(idxOwners.empty() || idxOwners.front()->GetIndexCount() == polygons->GetInput(i)->GetIndexCount(), continue);
-					if (idxOwners.find(polygons->GetInput(i)) == idxOwners.end())
-					{
-						idxOwners.push_back(polygons->GetInput(i));
-					}
-				}
+				if (*corner < oldIndexCount && oldIndices[*corner] < valueCount) ++offsets[oldIndices[*corner]];
 			}
-			size_t listCount = idxOwners.size();
-			if (listCount == 0) continue; // no inputs?
-
-			// Set-up a simple hashing function.
-			UInt32List hashingFunction;
-			uint32 hashSize = (uint32) listCount;
-			hashingFunction.reserve(hashSize);
-			for (uint32 h = 0; h < hashSize; ++h) hashingFunction.push_back(32 * h / hashSize);
-
-			// Iterate over the index lists, hashing/merging the indices.
-			HashIndexMap hashMap;
-			size_t originalIndexCount = idxOwners.front()->GetIndexCount();
-			outPolyIndices.reserve(originalIndexCount);
-
-			// optimization: cache the indices
-			uint32** indices = new uint32*[listCount];
-			for (size_t l = 0; l < listCount; ++l)
+		}
+		for (size_t v = 1; v < valueCount; ++v) offsets[v] += offsets[v - 1];
+		offsets[valueCount] = offsets[valueCount - 1];
+		table.values.resize(offsets[valueCount]);
+
+		// Fill the lists backwards, which leaves each offset at the start of its list
+		// and the new indices of each list in increasing order.
+		uint32* values = table.values.begin();
+		for (size_t p = sets.size(); p > 0; --p)
+		{
+			const UniqueVertexSet& set = sets[p - 1];
+			if (!set.process) continue;
+			FCDGeometryPolygonsInput* input = set.polygons->FindInput(source);
+			if (input == nullptr || input->GetIndices() == nullptr) continue;
+			const uint32* oldIndices = input->GetIndices();
+			size_t oldIndexCount = input->GetIndexCount();
+			for (size_t v = set.firstCorners.size(); v > 0; --v)
 			{
-				indices[l] = idxOwners[l]->GetIndices();
+				uint32 corner = set.firstCorners[v - 1];
+				if (corner < oldIndexCount && oldIndices[corner] < valueCount) values[--offsets[oldIndices[corner]]] = set.firstIndex + (uint32) (v - 1);
 			}
-			for (size_t i = 0; i < originalIndexCount; ++i)
+		}
+	}
+
+	// Adds the new indices of a translation table to a translation map.
+	static void AddToTranslationMap(const FCDGeometryIndexTranslationTable& table, FCDGeometryIndexTranslationMap& translationMap)
+	{
+		size_t oldIndexCount = table.GetOldIndexCount();
+		for (uint32 oldIndex = 0; oldIndex < oldIndexCount; ++oldIndex)
+		{
+			size_t newIndexCount = table.GetNewIndexCount(oldIndex);
+			if (newIndexCount == 0) continue;
+			const uint32* newIndices = table.GetNewIndices(oldIndex);
+			FCDGeometryIndexTranslationMap::iterator itU = translationMap.find(oldIndex);
+			if (itU == translationMap.end()) { itU = translationMap.insert(oldIndex, UInt32List()); }
+			UInt32List& list = itU->second;
+			bool merge = !list.empty();
+			list.reserve(list.size() + newIndexCount);
+			for (size_t i = 0; i < newIndexCount; ++i)
 			{
-				// Generate the hash value for this vertex-face pair.
-				uint32 hashValue = 0;
-				for (size_t l = 0; l < listCount; ++l)
-				{
-					hashValue ^= (indices[l][i]) << hashingFunction[l];
-				}
+				if (!merge || list.find(newIndices[i]) == list.end()) list.push_back(newIndices[i]);
+			}
+		}
+	}
 
-				// Look for this value in the already-collected ones.
-				HashIndexMap::iterator it = hashMap.find(hashValue);
-				HashIndexMapItem* hashItem;
-				uint32 newIndex = (uint32) totalVertexCount;
-				if (it != hashMap.end())
-				{
-					hashItem = &((*it).second);
-					size_t repeatCount = hashItem->allValues.size() / listCount;
-					for (size_t r = 0; r < repeatCount && newIndex == totalVertexCount; ++r)
-					{
-						size_t l;
-						for (l = 0; l < listCount; ++l)
-						{
-							if (indices[l][i] != hashItem->allValues[r * listCount + l]) break;
-						}
-						if (l == listCount)
-						{
-							// We have a match: re-use this index.
-							newIndex = hashItem->newIndex[r];
-						}
-					}
-				}
-				else
-				{
-					HashIndexMap::iterator k = hashMap.insert(hashValue, HashIndexMapItem());
-					hashItem = &k->second;
+	void GenerateUniqueIndices(FCDGeometryMesh* mesh, FCDGeometryPolygons* polygonsToProcess, FCDNewIndicesList& outIndices, FCDGeometryIndexTranslationTableList& outTranslationTables)
+	{
+		// Prepare a list of unique index buffers.
+		size_t polygonsCount = mesh->GetPolygonsCount();
+		if (polygonsCount == 0) return;
 
-					// optimization: since we will be adding the indices to allValues, know there will be listCount
-					hashItem->allValues.reserve(listCount);
-				}
+		size_t outIndicesMinSize = (polygonsToProcess == nullptr) ? polygonsCount : 1;
+		if (outIndices.size() < outIndicesMinSize) outIndices.resize(outIndicesMinSize);
 
-				if (newIndex == totalVertexCount)
-				{
-					// Append this new value/index to the hash map item and to the index buffer.
-					for (size_t l = 0; l < listCount; ++l)
-					{
-						hashItem->allValues.push_back(indices[l][i]);
-					}
-					hashItem->newIndex.push_back(newIndex);
-					totalVertexCount++;
-				}
-				outPolyIndices.push_back(newIndex);
-			}
-			SAFE_DELETE_ARRAY(indices);
+		// Fill in the index buffers for each polygons set.
+		UniqueVertexSetList sets;
+		bool complete = GenerateUniqueVertexSets(mesh, polygonsToProcess, sets);
+		for (size_t p = 0; p < polygonsCount; ++p)
+		{
+			const UniqueVertexSet& set = sets[p];
+			if (!set.process) continue;
+
+			// Find the list we are going to pump our new indices into
+			UInt32List& outPolyIndices = (polygonsToProcess == nullptr) ? outIndices[p] : outIndices.front();
+			size_t start = outPolyIndices.size();
+			outPolyIndices.resize(start + set.indices.size());
+			for (size_t i = 0; i < set.indices.size(); ++i) outPolyIndices[start + i] = set.firstIndex + set.indices[i];
 		}
+		if (!complete) return;
 
-		// We now have lists of new indices.  Create maps so we can quickly
+		// We now have lists of new indices.  Create tables so we can quickly
 		// map the old data to match the new stuff.
 		size_t meshSourceCount = mesh->GetSourceCount();
-		if (outTranslationMaps.size() < meshSourceCount) outTranslationMaps.resize(meshSourceCount);
+		if (outTranslationTables.size() < meshSourceCount) outTranslationTables.resize(meshSourceCount);
 		for (size_t d = 0; d < meshSourceCount; ++d)
 		{
-			FCDGeometrySource* oldSource = mesh->GetSource(d);
-			FCDGeometryIndexTranslationMap* thisMap = new FCDGeometryIndexTranslationMap();
-			outTranslationMaps[d] = thisMap;
-
-			// When processing just one polygons set, duplicate the source
-			// so that the other polygons set can correctly point to the original source.
-			for (size_t p = 0; p < polygonsCount; ++p)
-			{
-				FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
-				if (polygonsToProcess != nullptr && polygonsToProcess  != polygons) continue;
-				const UInt32List& outPolyIndices = (polygonsToProcess == nullptr) ? outIndices[p] : outIndices.front();
-				FCDGeometryPolygonsInput* oldInput = polygons->FindInput(oldSource);
-				if (oldInput == nullptr) continue;
-
-				// Retrieve the old list of indices and de-reference the data values.
-				uint32* oldIndexList = oldInput->GetIndices();
-				size_t oldIndexCount = oldInput->GetIndexCount();
-				if (oldIndexList == nullptr || oldIndexCount == 0) continue;
+			GenerateTranslationTable(mesh->GetSource(d), sets, outTranslationTables[d]);
+		}
+	}
 
-				size_t indexCount = min(oldIndexCount, outPolyIndices.size());
-				for (size_t i = 0; i < indexCount; ++i)
-				{
-					uint32 newIndex = outPolyIndices[i];
-					uint32 oldIndex = oldIndexList[i];
-					if (oldIndex >= oldSource->GetValueCount()) continue;
-
-					// Add this value to the translation map.
-					FCDGeometryIndexTranslationMap::iterator itU = thisMap->find(oldIndex);
-					if (itU == thisMap->end()) { itU = thisMap->insert(oldIndex, UInt32List()); }
-					UInt32List::iterator itF = itU->second.find(newIndex);
-					if (itF == itU->second.end()) itU->second.push_back(newIndex);
-				}
-			}
+	void GenerateUniqueIndices(FCDGeometryMesh* mesh, FCDGeometryPolygons* polygonsToProcess, FCDNewIndicesList& outIndices, FCDGeometryIndexTranslationMapList& outTranslationMaps)
+	{
+		FCDGeometryIndexTranslationTableList translationTables;
+		GenerateUniqueIndices(mesh, polygonsToProcess, outIndices, translationTables);
+
+		if (outTranslationMaps.size() < translationTables.size()) outTranslationMaps.resize(translationTables.size());
+		for (size_t d = 0; d < translationTables.size(); ++d)
+		{
+			FCDGeometryIndexTranslationMap* thisMap = new FCDGeometryIndexTranslationMap();
+			outTranslationMaps[d] = thisMap;
+			AddToTranslationMap(translationTables[d], *thisMap);
 		}
 	}
 
@@ -590,106 +1065,9 @@ namespace FCDGeometryPolygonsTools
 		// Prepare a list of unique index buffers.
 		size_t polygonsCount = mesh->GetPolygonsCount();
 		if (polygonsCount == 0) return;
-		UInt32ListList indexBuffers; indexBuffers.resize(polygonsCount);
-		size_t totalVertexCount = 0;
-
-		// Fill in the index buffers for each polygons set.
-		for (size_t p = 0; p < polygonsCount; ++p)
-		{
-			UInt32List& indexBuffer = indexBuffers[p];
-			FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
-			// DO NOT -EVER- TOUCH MY INDICES - (Says Psuedo-FCDGeometryPoints)
-			// Way to much code assumes (and carefully guards) the existing sorted structure
-			if (polygons->GetPrimitiveType() == FCDGeometryPolygons::POINTS) return;
-			if (polygonsToProcess != nullptr && polygons != polygonsToProcess) continue;
-
-			// Find all the indices list to determine the hash size.
-			InputList idxOwners;
-			size_t inputCount = polygons->GetInputCount();
-			for (size_t i = 0; i < inputCount; ++i)
-			{
-				FCDGeometryPolygonsInput* input = polygons->GetInput(i);
-				if (input->OwnsIndices())
-				{
-					// Drop index lists with the wrong number of values and avoid repeats
-					FUAssert(idxOwners.empty() || idxOwners.front()->GetIndexCount() == input->GetIndexCount(), continue);
-					if (idxOwners.find(input) == idxOwners.end()) idxOwners.push_back(input);
-				}
-			}
-			size_t listCount = idxOwners.size();
-			if (listCount == 0) continue; // no inputs?
-
-			// Set-up a simple hashing function.
-			UInt32List hashingFunction;
-			uint32 hashSize = (uint32) listCount;
-			hashingFunction.reserve(hashSize);
-			for (uint32 h = 0; h < hashSize; ++h) hashingFunction.push_back(32 * h / hashSize);
-
-			// Iterate over the index lists, hashing/merging the indices.
-			HashIndexMap hashMap;
-			size_t originalIndexCount = idxOwners.front()->GetIndexCount();
-			indexBuffer.reserve(originalIndexCount);
-
-			// optimization: cache the indices
-			uint32** indices = new uint32*[listCount];
-			for (size_t l = 0; l < listCount; ++l)
-			{
-				indices[l] = idxOwners[l]->GetIndices();
-			}
-			for (size_t i = 0; i < originalIndexCount; ++i)
-			{
-				// Generate the hash value for this vertex-face pair.
-				uint32 hashValue = 0;
-				for (size_t l = 0; l < listCount; ++l)
-				{
-					hashValue ^= (indices[l][i]) << hashingFunction[l];
-				}
-
-				// Look for this value in the already-collected ones.
-				HashIndexMap::iterator it = hashMap.find(hashValue);
-				HashIndexMapItem* hashItem;
-				uint32 newIndex = (uint32) totalVertexCount;
-				if (it != hashMap.end())
-				{
-					hashItem = &((*it).second);
-					size_t repeatCount = hashItem->allValues.size() / listCount;
-					for (size_t r = 0; r < repeatCount && newIndex == totalVertexCount; ++r)
-					{
-						size_t l;
-						for (l = 0; l < listCount; ++l)
-						{
-							if (indices[l][i] != hashItem->allValues[r * listCount + l]) break;
-						}
-						if (l == listCount)
-						{
-							// We have a match: re-use this index.
-							newIndex = hashItem->newIndex[r];
-						}
-					}
-				}
-				else
-				{
-					HashIndexMap::iterator k = hashMap.insert(hashValue, HashIndexMapItem());
-					hashItem = &k->second;
-
-					// optimization: since we will be adding the indices to allValues, know there will be listCount
-					hashItem->allValues.reserve(listCount);
-				}
-
-				if (newIndex == totalVertexCount)
-				{
-					// Append this new value/index to the hash map item and to the index buffer.
-					for (size_t l = 0; l < listCount; ++l)
-					{
-						hashItem->allValues.push_back(indices[l][i]);
-					}
-					hashItem->newIndex.push_back(newIndex);
-					totalVertexCount++;
-				}
-				indexBuffer.push_back(newIndex);
-			}
-			SAFE_DELETE_ARRAY(indices);
-		}
+		UniqueVertexSetList sets;
+		if (!GenerateUniqueVertexSets(mesh, polygonsToProcess, sets)) return;
+		size_t totalVertexCount = sets.back().firstIndex + sets.back().firstCorners.size();
 
 		// De-reference the source data so that all the vertex data match the new indices.
 		size_t meshSourceCount = mesh->GetSourceCount();
@@ -698,21 +1076,44 @@ namespace FCDGeometryPolygonsTools
 			FCDGeometrySource* oldSource = mesh->GetSource(d);
 			uint32 stride = oldSource->GetStride();
 			const float* oldVertexData = oldSource->GetData();
-			bool isPositionSource = oldSource->GetType() == FUDaeGeometryInput::POSITION && translationMap != nullptr;
+			size_t oldValueCount = oldSource->GetValueCount();
 			FloatList vertexBuffer;
 			vertexBuffer.resize(stride * totalVertexCount, 0.0f);
 
+			// Add the values of the vertex positions to the translation map.
+			if (oldSource->GetType() == FUDaeGeometryInput::POSITION && translationMap != nullptr)
+			{
+				FCDGeometryIndexTranslationTable table;
+				GenerateTranslationTable(oldSource, sets, table);
+				AddToTranslationMap(table, *translationMap);
+			}
+
+			// Find the animated value, if any, of each old value.
+			FUObjectContainer<FCDAnimated>& animatedValues = oldSource->GetAnimatedValues();
+			fm::pvector<FCDAnimated> oldAnimatedValues;
+			if (!animatedValues.empty() && stride > 0)
+			{
+				oldAnimatedValues.insert(oldAnimatedValues.end(), oldValueCount);
+				for (size_t j = 0; j < animatedValues.size(); j++)
+				{
+					FCDAnimated* animated = animatedValues[j];
+					const float* value = animated->GetValue(0);
+					if (value < oldVertexData || value >= oldVertexData + stride * oldValueCount) continue;
+					size_t offset = value - oldVertexData;
+					if (offset % stride == 0 && oldAnimatedValues[offset / stride] == nullptr) oldAnimatedValues[offset / stride] = animated;
+				}
+			}
+
 			// When processing just one polygons set, duplicate the source
 			// so that the other polygons set can correctly point to the original source.
 			FCDGeometrySource* newSource = (polygonsToProcess != nullptr) ? mesh->AddSource(oldSource->GetType()) : oldSource;
 
 			FCDAnimatedList newAnimatedList;
-			newAnimatedList.clear();
 			for (size_t p = 0; p < polygonsCount; ++p)
 			{
-				const UInt32List& indexBuffer = indexBuffers[p];
-				FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
-				if (polygonsToProcess != nullptr && polygonsToProcess != polygons) continue;
+				const UniqueVertexSet& set = sets[p];
+				if (!set.process) continue;
+				FCDGeometryPolygons* polygons = set.polygons;
 				FCDGeometryPolygonsInput* oldInput = polygons->FindInput(oldSource);
 				if (oldInput == nullptr) continue;
 
@@ -721,24 +1122,17 @@ namespace FCDGeometryPolygonsTools
 				size_t oldIndexCount = oldInput->GetIndexCount();
 				if (oldIndexList == nullptr || oldIndexCount == 0) continue;
 
-				size_t indexCount = min(oldIndexCount, indexBuffer.size());
-				for (size_t i = 0; i < indexCount; ++i)
+				// All the face-vertex pairs of a unique vertex have the same old index.
+				size_t uniqueCount = set.firstCorners.size();
+				for (size_t v = 0; v < uniqueCount; ++v)
 				{
-					uint32 newIndex = indexBuffer[i];
-					uint32 oldIndex = oldIndexList[i];
-					if (oldIndex >= oldSource->GetValueCount()) continue;
+					uint32 corner = set.firstCorners[v];
+					if (corner >= oldIndexCount) continue;
+					uint32 newIndex = set.firstIndex + (uint32) v;
+					uint32 oldIndex = oldIndexList[corner];
+					if (oldIndex >= oldValueCount) continue;
 
-					FUObjectContainer<FCDAnimated>& animatedValues = oldSource->GetAnimatedValues();
-					FCDAnimated* oldAnimated = nullptr;
-					for (size_t j = 0; j < animatedValues.size(); j++)
-					{
-						FCDAnimated* animated = animatedValues[j];
-						if (animated->GetValue(0) == &(oldVertexData[stride * oldIndex]))
-						{
-							oldAnimated = animated;
-							break;
-						}
-					}
+					FCDAnimated* oldAnimated = oldAnimatedValues.empty() ? nullptr : oldAnimatedValues[oldIndex];
 					if (oldAnimated != nullptr)
 					{
 						FCDAnimated* newAnimated = oldAnimated->Clone(oldAnimated->GetDocument());
@@ -746,29 +1140,19 @@ namespace FCDGeometryPolygonsTools
 						newAnimatedList.push_back(newAnimated);
 					}
 
-					// [GLaforte - 12-10-2006] Potential performance optimization: this may copy the same data over itself many times.
 					for (uint32 s = 0; s < stride; ++s)
 					{
 						vertexBuffer[stride * newIndex + s] = oldVertexData[stride * oldIndex + s];
 					}
-
-					// Add this value to the vertex position translation map.
-					if (isPositionSource)
-					{
-						FCDGeometryIndexTranslationMap::iterator itU = translationMap->find(oldIndex);
-						if (itU == translationMap->end()) { itU = translationMap->insert(oldIndex, UInt32List()); }
-						UInt32List::iterator itF = itU->second.find(newIndex);
-						if (itF == itU->second.end()) itU->second.push_back(newIndex);
-					}
 				}
 
 				if (polygonsToProcess != nullptr)
 				{
 					// Change the relevant input, if it exists, to point towards the new source.
-					uint32 set = oldInput->GetSet();
+					uint32 inputSet = oldInput->GetSet();
 					SAFE_RELEASE(oldInput);
 					FCDGeometryPolygonsInput* newInput = polygons->AddInput(newSource, 0);
-					newInput->SetSet(set);
+					newInput->SetSet(inputSet);
 				}
 			}
 
@@ -804,21 +1188,23 @@ namespace FCDGeometryPolygonsTools
 		}
 
 		// Enforce the index buffers.
+		UInt32List indexBuffer;
 		for (size_t p = 0; p < polygonsCount; ++p)
 		{
-			const UInt32List& indexBuffer = indexBuffers[p];
-			FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
-			if (polygonsToProcess != nullptr && polygons != polygonsToProcess) continue;
-
+			const UniqueVertexSet& set = sets[p];
+			if (!set.process) continue;
+			// [ewhittom] Allow empty index buffers with non-empty vertex buffers
+			if (set.indices.empty()) continue;
+			indexBuffer.resize(set.indices.size());
+			for (size_t i = 0; i < set.indices.size(); ++i) indexBuffer[i] = set.firstIndex + set.indices[i];
+
+			FCDGeometryPolygons* polygons = set.polygons;
 			size_t inputCount = polygons->GetInputCount();
 			for (size_t i = 0; i < inputCount; i++)
 			{
 				FCDGeometryPolygonsInput* anyInput = polygons->GetInput(i);
 				if (anyInput->GetSource()->GetDataCount() == 0) continue;
-				// [ewhittom] Allow empty index buffers with non-empty vertex buffers
-				if (indexBuffer.empty()) continue;
-
-				anyInput->SetIndices(&indexBuffer.front(), indexBuffer.size());
+				anyInput->SetIndices(indexBuffer.begin(), indexBuffer.size());
 			}
 		}
 	}
@@ -840,6 +1226,20 @@ namespace FCDGeometryPolygonsTools
 		}
 	}
 
+	void ApplyUniqueIndices(float* targData, const float* srcData, uint32 stride, const FCDGeometryIndexTranslationTable& translationTable)
+	{
+		size_t oldIndexCount = translationTable.GetOldIndexCount();
+		for (uint32 oldIndex = 0; oldIndex < oldIndexCount; ++oldIndex)
+		{
+			const float* srcValue = srcData + stride * oldIndex;
+			for (uint32 i = translationTable.offsets[oldIndex]; i < translationTable.offsets[oldIndex + 1]; ++i)
+			{
+				float* targValue = targData + stride * translationTable.values[i];
+				for (uint32 s = 0; s < stride; ++s) targValue[s] = srcValue[s];
+			}
+		}
+	}
+
 	void ApplyUniqueIndices(FCDGeometrySource* targSource, uint32 nValues, const FCDGeometryIndexTranslationMap* translationMap)
 	{
 		size_t tmSize = translationMap->size();
@@ -1198,4 +1598,533 @@ namespace FCDGeometryPolygonsTools
 		}
 	}
 
+	// The number of entries of the LRU vertex cache modeled when ordering the triangles.
+	static const size_t orderingCacheSize = 32;
+
+	// The number of entries of the FIFO vertex cache simulated when splitting the overdraw clusters.
+	static const size_t overdrawCacheSize = 16;
+
+	// The largest ratio between the average cache miss ratio of an overdraw cluster and the one of the whole polygons set.
+	static const float overdrawClusterThreshold = 1.05f;
+
+	// Lists the inputs that own the indices of a polygons set, when they all hold the same indices.
+	static bool FindUnifiedIndexOwners(FCDGeometryPolygons* polygons, InputList& owners)
+	{
+		owners.clear();
+		size_t inputCount = polygons->GetInputCount();
+		for (size_t i = 0; i < inputCount; ++i)
+		{
+			FCDGeometryPolygonsInput* input = polygons->GetInput(i);
+			if (input->OwnsIndices()) owners.push_back(input);
+		}
+		if (owners.empty()) return false;
+
+		size_t indexCount = owners.front()->GetIndexCount();
+		for (size_t i = 1; i < owners.size(); ++i)
+		{
+			if (owners[i]->GetIndexCount() != indexCount) return false;
+			if (memcmp(owners[i]->GetIndices(), owners.front()->GetIndices(), sizeof(uint32) * indexCount) != 0) return false;
+		}
+		return true;
+	}
+
+	// Checks whether a polygons set is a list of triangles, without holes.
+	static bool IsTriangleList(const FCDGeometryPolygons* polygons, size_t indexCount)
+	{
+		if (polygons->GetPrimitiveType() != FCDGeometryPolygons::POLYGONS || polygons->GetHoleFaceCount() > 0) return false;
+		const uint32* faceVertexCounts = polygons->GetFaceVertexCounts();
+		size_t faceCount = polygons->GetFaceVertexCountCount();
+		for (size_t f = 0; f < faceCount; ++f)
+		{
+			if (faceVertexCounts[f] != 3) return false;
+		}
+		return faceCount > 0 && indexCount == 3 * faceCount;
+	}
+
+	// Scores a vertex from its position in the modeled cache and from its number of triangles left to order.
+	static inline float ScoreVertex(int32 cachePosition, uint32 triangleCount, const float* cacheScores)
+	{
+		if (triangleCount == 0) return -1.0f;
+		float score = (cachePosition >= 0) ? cacheScores[cachePosition] : 0.0f;
+		return score + 2.0f / sqrtf((float) triangleCount);
+	}
+
+	// Orders the triangles of an index buffer with the linear-speed vertex cache optimization
+	// of Tom Forsyth. The vertices are scored from their position in a modeled LRU cache and
+	// from their number of triangles left, which finishes off the lonely vertices. Each next
+	// triangle is the best-scored triangle of the cached vertices. When no cached vertex has
+	// triangles left, the ordering restarts from the first triangle left and a cluster starts.
+	static void OrderTrianglesForVertexCache(const uint32* indices, size_t triangleCount, size_t vertexCount, UInt32List& outTriangles, UInt32List& outClusterStarts)
+	{
+		float cacheScores[orderingCacheSize];
+		for (size_t c = 0; c < orderingCacheSize; ++c)
+		{
+			// The vertices of the last triangle get a fixed score, so that the triangle strips are not favored.
+			cacheScores[c] = (c < 3) ? 0.75f : powf(1.0f - (float) (c - 3) / (float) (orderingCacheSize - 3), 1.5f);
+		}
+
+		// The triangles of each vertex, as compressed rows. Each row only keeps the triangles left.
+		size_t indexCount = 3 * triangleCount;
+		UInt32List offsets;
+		offsets.resize(vertexCount + 1, 0);
+		for (size_t i = 0; i < indexCount; ++i) ++offsets[indices[i] + 1];
+		for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+		UInt32List adjacency, triangleCounts;
+		adjacency.resize(indexCount);
+		triangleCounts.resize(vertexCount, 0);
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			uint32 v = indices[i];
+			adjacency[offsets[v] + triangleCounts[v]++] = (uint32) (i / 3);
+		}
+
+		fm::vector<int32, true> cachePositions;
+		cachePositions.resize(vertexCount, -1);
+		FloatList vertexScores;
+		vertexScores.resize(vertexCount);
+		for (size_t v = 0; v < vertexCount; ++v) vertexScores[v] = ScoreVertex(-1, triangleCounts[v], cacheScores);
+		fm::vector<uint8, true> orderedTriangles;
+		orderedTriangles.resize(triangleCount, 0);
+
+		uint32 cache[orderingCacheSize + 3], newCache[orderingCacheSize + 3];
+		size_t cacheCount = 0, nextTriangle = 0;
+		uint32 bestTriangle = ~(uint32) 0;
+		outTriangles.resize(triangleCount);
+		outClusterStarts.clear();
+		for (size_t n = 0; n < triangleCount; ++n)
+		{
+			if (bestTriangle == ~(uint32) 0)
+			{
+				while (orderedTriangles[nextTriangle] != 0) ++nextTriangle;
+				bestTriangle = (uint32) nextTriangle;
+				outClusterStarts.push_back((uint32) n);
+			}
+			outTriangles[n] = bestTriangle;
+			orderedTriangles[bestTriangle] = 1;
+
+			// Remove the triangle from the rows of its vertices and move them to the front of the cache.
+			const uint32* triangle = indices + 3 * bestTriangle;
+			size_t newCacheCount = 0;
+			for (size_t k = 0; k < 3; ++k)
+			{
+				uint32 v = triangle[k];
+				uint32* row = adjacency.begin() + offsets[v];
+				uint32 count = triangleCounts[v];
+				for (uint32 j = 0; j < count; ++j)
+				{
+					if (row[j] == bestTriangle) { row[j] = row[count - 1]; break; }
+				}
+				triangleCounts[v] = count - 1;
+				if (k == 0 || (v != triangle[0] && (k == 1 || v != triangle[1]))) newCache[newCacheCount++] = v;
+			}
+			for (size_t c = 0; c < cacheCount; ++c)
+			{
+				uint32 v = cache[c];
+				if (v != triangle[0] && v != triangle[1] && v != triangle[2]) newCache[newCacheCount++] = v;
+			}
+
+			// Score the cached vertices, and the vertices pushed out of the cache.
+			for (size_t c = 0; c < newCacheCount; ++c)
+			{
+				uint32 v = newCache[c];
+				cachePositions[v] = (c < orderingCacheSize) ? (int32) c : -1;
+				vertexScores[v] = ScoreVertex(cachePositions[v], triangleCounts[v], cacheScores);
+			}
+			cacheCount = min(newCacheCount, orderingCacheSize);
+			memcpy(cache, newCache, sizeof(uint32) * cacheCount);
+
+			// The next triangle is the best-scored triangle of the cached vertices.
+			bestTriangle = ~(uint32) 0;
+			float bestScore = -1.0f;
+			for (size_t c = 0; c < cacheCount; ++c)
+			{
+				uint32 v = cache[c];
+				const uint32* row = adjacency.begin() + offsets[v];
+				for (uint32 j = 0; j < triangleCounts[v]; ++j)
+				{
+					const uint32* candidate = indices + 3 * row[j];
+					float score = vertexScores[candidate[0]] + vertexScores[candidate[1]] + vertexScores[candidate[2]];
+					if (score > bestScore) { bestScore = score; bestTriangle = row[j]; }
+				}
+			}
+		}
+	}
+
+	// Counts the vertices transformed by the triangles of an index buffer, through a FIFO cache.
+	// A vertex is cached when it was transformed less than cacheSize transforms ago.
+	// The stamps hold, for each vertex, one more than the number of transforms before its last
+	// transform. The stamps of the earlier simulations are at most the transform base.
+	static size_t SimulateVertexCache(const uint32* indices, const uint32* triangles, size_t triangleCount, size_t cacheSize, UInt32List& transformStamps, size_t transformBase)
+	{
+		size_t transformCount = 0;
+		for (size_t n = 0; n < triangleCount; ++n)
+		{
+			const uint32* triangle = indices + 3 * ((triangles != nullptr) ? triangles[n] : n);
+			for (size_t k = 0; k < 3; ++k)
+			{
+				uint32& stamp = transformStamps[triangle[k]];
+				size_t count = transformBase + transformCount;
+				if (stamp <= transformBase || count - stamp >= cacheSize)
+				{
+					stamp = (uint32) (count + 1);
+					++transformCount;
+				}
+			}
+		}
+		return transformCount;
+	}
+
+	struct OverdrawCluster
+	{
+		float key;
+		uint32 index;
+
+		inline bool operator<(const OverdrawCluster& other) const { return key > other.key || (key == other.key && index < other.index); }
+	};
+
+	// Orders the clusters of triangles for overdraw, after Tipsify. The clusters that do not
+	// share vertices are split further where splitting barely raises the average cache miss
+	// ratio. The clusters that face away from the center of the polygons set, which tend to
+	// hide the other ones, are drawn first.
+	static void OrderClustersForOverdraw(const uint32* indices, size_t vertexCount, const FCDGeometrySource* positionSource, UInt32List& triangles, UInt32List& clusterStarts)
+	{
+		size_t triangleCount = triangles.size();
+		const float* positions = positionSource->GetData();
+		uint32 positionStride = positionSource->GetStride();
+		size_t positionCount = positionSource->GetValueCount();
+		if (positionStride < 3 || positionCount < vertexCount) return;
+
+		// The average cache miss ratio of each new cluster, drawn from an empty cache,
+		// must stay close to the one of the whole polygons set.
+		UInt32List transformStamps;
+		transformStamps.resize(vertexCount, 0);
+		size_t transformCount = SimulateVertexCache(indices, triangles.begin(), triangleCount, overdrawCacheSize, transformStamps, 0);
+		float threshold = overdrawClusterThreshold * (float) transformCount / (float) triangleCount;
+		UInt32List starts;
+		starts.reserve(clusterStarts.size());
+		size_t transformTotal = transformCount;
+		for (size_t c = 0; c < clusterStarts.size(); ++c)
+		{
+			size_t start = clusterStarts[c], end = (c + 1 < clusterStarts.size()) ? clusterStarts[c + 1] : triangleCount;
+			size_t clusterBase = transformTotal;
+			starts.push_back((uint32) start);
+			for (size_t n = start; n < end; ++n)
+			{
+				const uint32* triangle = indices + 3 * triangles[n];
+				for (size_t k = 0; k < 3; ++k)
+				{
+					uint32& stamp = transformStamps[triangle[k]];
+					if (stamp <= clusterBase || transformTotal - stamp >= overdrawCacheSize) stamp = (uint32) ++transformTotal;
+				}
+				if (n + 1 < end && (float) (transformTotal - clusterBase) <= threshold * (float) (n + 1 - start))
+				{
+					if (starts.size() == starts.capacity()) starts.reserve(2 * starts.size());
+					starts.push_back((uint32) (n + 1));
+					start = n + 1;
+					clusterBase = transformTotal;
+				}
+			}
+		}
+
+		// The area-weighted centers and normals of the clusters and of the whole polygons set.
+		size_t clusterCount = starts.size();
+		fm::vector<FMVector3> centers, normals;
+		centers.resize(clusterCount, FMVector3::Zero);
+		normals.resize(clusterCount, FMVector3::Zero);
+		FloatList areas;
+		areas.resize(clusterCount, 0.0f);
+		FMVector3 center = FMVector3::Zero;
+		float area = 0.0f;
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			size_t end = (c + 1 < clusterCount) ? starts[c + 1] : triangleCount;
+			for (size_t n = starts[c]; n < end; ++n)
+			{
+				const uint32* triangle = indices + 3 * triangles[n];
+				FMVector3 p0(positions + positionStride * triangle[0]), p1(positions + positionStride * triangle[1]), p2(positions + positionStride * triangle[2]);
+				FMVector3 normal = (p1 - p0) ^ (p2 - p0);
+				float triangleArea = normal.Length();
+				centers[c] += (p0 + p1 + p2) * (triangleArea / 3.0f);
+				normals[c] += normal;
+				areas[c] += triangleArea;
+			}
+			center += centers[c];
+			area += areas[c];
+		}
+		if (area > 0.0f) center /= area;
+
+		fm::vector<OverdrawCluster> clusters;
+		clusters.resize(clusterCount);
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			clusters[c].index = (uint32) c;
+			clusters[c].key = 0.0f;
+			float normalLength = normals[c].Length();
+			if (areas[c] > 0.0f && normalLength > 0.0f) clusters[c].key = ((centers[c] / areas[c]) - center) * (normals[c] / normalLength);
+		}
+		std::sort(clusters.begin(), clusters.end());
+
+		UInt32List orderedTriangles;
+		orderedTriangles.reserve(triangleCount);
+		clusterStarts.clear();
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			uint32 cluster = clusters[c].index;
+			size_t end = (cluster + 1 < clusterCount) ? starts[cluster + 1] : triangleCount;
+			clusterStarts.push_back((uint32) orderedTriangles.size());
+			orderedTriangles.insert(orderedTriangles.end(), triangles.begin() + starts[cluster], triangles.begin() + end);
+		}
+		triangles.clear();
+		triangles.insert(triangles.end(), orderedTriangles.begin(), orderedTriangles.end());
+	}
+
+	// Sorts the vertices of a mesh in the order of their first use, over all its polygons sets.
+	static bool SortVerticesByFirstUse(FCDGeometryMesh* mesh, UInt32List* vertexRemap)
+	{
+		// All the polygons sets must share one index buffer per set and all the sources must have one value per vertex.
+		size_t polygonsCount = mesh->GetPolygonsCount();
+		fm::pvector<FCDGeometrySource> sources;
+		size_t vertexCount = 0;
+		InputList owners;
+		for (size_t p = 0; p < polygonsCount; ++p)
+		{
+			FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
+			if (polygons->GetPrimitiveType() == FCDGeometryPolygons::POINTS || !FindUnifiedIndexOwners(polygons, owners)) return false;
+			size_t inputCount = polygons->GetInputCount();
+			for (size_t i = 0; i < inputCount; ++i)
+			{
+				FCDGeometrySource* source = polygons->GetInput(i)->GetSource();
+				if (source == nullptr || sources.contains(source)) continue;
+				if (!source->GetAnimatedValues().empty()) return false;
+				if (sources.empty()) vertexCount = source->GetValueCount();
+				else if (source->GetValueCount() != vertexCount) return false;
+				sources.push_back(source);
+			}
+		}
+		if (sources.empty() || vertexCount == 0) return false;
+
+		UInt32List remap;
+		remap.resize(vertexCount, ~(uint32) 0);
+		uint32 nextVertex = 0;
+		for (size_t p = 0; p < polygonsCount; ++p)
+		{
+			FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
+			FindUnifiedIndexOwners(polygons, owners);
+			const uint32* indices = owners.front()->GetIndices();
+			size_t indexCount = owners.front()->GetIndexCount();
+			for (size_t i = 0; i < indexCount; ++i)
+			{
+				if (indices[i] >= vertexCount) return false;
+				if (remap[indices[i]] == ~(uint32) 0) remap[indices[i]] = nextVertex++;
+			}
+		}
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			if (remap[v] == ~(uint32) 0) remap[v] = nextVertex++;
+		}
+
+		// Move the vertex data and re-index the polygons sets.
+		FloatList values;
+		for (FCDGeometrySource** it = sources.begin(); it != sources.end(); ++it)
+		{
+			FCDGeometrySource* source = *it;
+			uint32 stride = source->GetStride();
+			float* data = source->GetData();
+			values.clear();
+			values.insert(values.end(), data, data + stride * vertexCount);
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				memcpy(data + stride * remap[v], values.begin() + stride * v, sizeof(float) * stride);
+			}
+			source->SetDirtyFlag();
+		}
+		UInt32List indexBuffer;
+		for (size_t p = 0; p < polygonsCount; ++p)
+		{
+			FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
+			FindUnifiedIndexOwners(polygons, owners);
+			const uint32* indices = owners.front()->GetIndices();
+			size_t indexCount = owners.front()->GetIndexCount();
+			indexBuffer.resize(indexCount);
+			for (size_t i = 0; i < indexCount; ++i) indexBuffer[i] = remap[indices[i]];
+			for (size_t o = 0; o < owners.size(); ++o) owners[o]->SetIndices(indexBuffer.begin(), indexCount);
+		}
+
+		if (vertexRemap != nullptr)
+		{
+			vertexRemap->clear();
+			vertexRemap->insert(vertexRemap->end(), remap.begin(), remap.end());
+		}
+		return true;
+	}
+
+	bool OptimizeVertexCache(FCDGeometryMesh* mesh, bool optimizeOverdraw, UInt32List* vertexRemap)
+	{
+		if (vertexRemap != nullptr) vertexRemap->clear();
+		if (mesh == nullptr) return false;
+
+		InputList owners;
+		UInt32List triangles, clusterStarts, indexBuffer;
+		size_t polygonsCount = mesh->GetPolygonsCount();
+		for (size_t p = 0; p < polygonsCount; ++p)
+		{
+			FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
+			if (!FindUnifiedIndexOwners(polygons, owners)) continue;
+			const uint32* indices = owners.front()->GetIndices();
+			size_t indexCount = owners.front()->GetIndexCount();
+			if (!IsTriangleList(polygons, indexCount)) continue;
+
+			uint32 vertexCount = 0;
+			for (size_t i = 0; i < indexCount; ++i) vertexCount = max(vertexCount, indices[i] + 1);
+			size_t triangleCount = indexCount / 3;
+			OrderTrianglesForVertexCache(indices, triangleCount, vertexCount, triangles, clusterStarts);
+			if (optimizeOverdraw)
+			{
+				FCDGeometryPolygonsInput* positionInput = polygons->FindInput(FUDaeGeometryInput::POSITION);
+				if (positionInput != nullptr && positionInput->GetSource() != nullptr)
+				{
+					OrderClustersForOverdraw(indices, vertexCount, positionInput->GetSource(), triangles, clusterStarts);
+				}
+			}
+
+			indexBuffer.resize(indexCount);
+			for (size_t n = 0; n < triangleCount; ++n)
+			{
+				memcpy(indexBuffer.begin() + 3 * n, indices + 3 * triangles[n], sizeof(uint32) * 3);
+			}
+			for (size_t o = 0; o < owners.size(); ++o) owners[o]->SetIndices(indexBuffer.begin(), indexCount);
+		}
+
+		return SortVerticesByFirstUse(mesh, vertexRemap);
+	}
+
+	FCDVertexCacheStatistics CalculateVertexCacheStatistics(const FCDGeometryMesh* mesh, size_t cacheSize)
+	{
+		FCDVertexCacheStatistics statistics;
+		statistics.triangleCount = statistics.vertexCount = statistics.transformCount = 0;
+		if (mesh == nullptr || cacheSize == 0) return statistics;
+
+		UInt32List transformStamps, vertexStamps;
+		size_t transformBase = 0;
+		size_t polygonsCount = mesh->GetPolygonsCount();
+		for (size_t p = 0; p < polygonsCount; ++p)
+		{
+			// Each polygons set is drawn with an empty cache.
+			const FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
+			if (polygons->GetInputCount() == 0) continue;
+			const uint32* indices = polygons->GetInput(0)->GetIndices();
+			size_t indexCount = polygons->GetInput(0)->GetIndexCount();
+			if (indices == nullptr || !IsTriangleList(polygons, indexCount)) continue;
+
+			uint32 vertexCount = 0;
+			for (size_t i = 0; i < indexCount; ++i) vertexCount = max(vertexCount, indices[i] + 1);
+			if (transformStamps.size() < vertexCount) transformStamps.resize(vertexCount, 0);
+			if (vertexStamps.size() < vertexCount) vertexStamps.resize(vertexCount, 0);
+			size_t transformCount = SimulateVertexCache(indices, nullptr, indexCount / 3, cacheSize, transformStamps, transformBase);
+			transformBase += transformCount;
+
+			// Count the distinct vertices of the set.
+			for (size_t i = 0; i < indexCount; ++i)
+			{
+				if (vertexStamps[indices[i]] != (uint32) p + 1) { vertexStamps[indices[i]] = (uint32) p + 1; ++statistics.vertexCount; }
+			}
+			statistics.triangleCount += indexCount / 3;
+			statistics.transformCount += transformCount;
+		}
+		return statistics;
+	}
+
+	// Remaps the indices of the inputs of a polygons set that reference a source.
+	// The inputs that share their indices with the inputs of other sources are moved to a new offset.
+	static void RemapSourceIndices(FCDGeometryPolygons* polygons, const FCDGeometrySource* source, const UInt32List& remap)
+	{
+		InputList remapped;
+		size_t inputCount = polygons->GetInputCount();
+		for (size_t i = 0; i < inputCount; ++i)
+		{
+			FCDGeometryPolygonsInput* input = polygons->GetInput(i);
+			if (input->GetSource() != source || remapped.contains(input)) continue;
+
+			// Gather the inputs with the same offset.
+			uint32 offset = input->GetOffset(), maximumOffset = 0;
+			InputList sourceInputs, otherInputs;
+			for (size_t j = 0; j < inputCount; ++j)
+			{
+				FCDGeometryPolygonsInput* other = polygons->GetInput(j);
+				maximumOffset = max(maximumOffset, other->GetOffset());
+				if (other->GetOffset() != offset) continue;
+				if (other->GetSource() == source) sourceInputs.push_back(other);
+				else otherInputs.push_back(other);
+			}
+			remapped.insert(remapped.end(), sourceInputs.begin(), sourceInputs.end());
+
+			if (!otherInputs.empty())
+			{
+				// Move the inputs of the source to a new offset: the owner of the indices
+				// keeps them, and the other side receives a copy.
+				UInt32List indices;
+				indices.insert(indices.end(), input->GetIndices(), input->GetIndices() + input->GetIndexCount());
+				for (size_t j = 0; j < sourceInputs.size(); ++j) sourceInputs[j]->SetOffset(maximumOffset + 1);
+				if (sourceInputs.front()->GetIndexCount() != indices.size()) sourceInputs.front()->SetIndices(indices.begin(), indices.size());
+				if (otherInputs.front()->GetIndexCount() != indices.size()) otherInputs.front()->SetIndices(indices.begin(), indices.size());
+			}
+
+			uint32* indices = input->GetIndices();
+			size_t indexCount = input->GetIndexCount();
+			for (size_t n = 0; n < indexCount; ++n)
+			{
+				if (indices[n] < remap.size()) indices[n] = remap[indices[n]];
+			}
+		}
+	}
+
+	bool WeldSource(FCDGeometryMesh* mesh, FCDGeometrySource* source, float tolerance, UInt32List* valueRemap)
+	{
+		if (valueRemap != nullptr) valueRemap->clear();
+		if (mesh == nullptr || source == nullptr || !(tolerance > 0.0f)) return false;
+		uint32 stride = source->GetStride();
+		size_t valueCount = source->GetValueCount();
+		if (stride == 0 || !source->GetAnimatedValues().empty()) return false;
+
+		// The vertex sources share the indices of the vertex input: one cannot be welded without the others.
+		size_t polygonsCount = mesh->GetPolygonsCount();
+		if (mesh->IsVertexSource(source))
+		{
+			for (size_t p = 0; p < polygonsCount; ++p)
+			{
+				FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
+				FCDGeometryPolygonsInput* input = polygons->FindInput(source);
+				if (input == nullptr) continue;
+				size_t inputCount = polygons->GetInputCount();
+				for (size_t i = 0; i < inputCount; ++i)
+				{
+					const FCDGeometryPolygonsInput* other = polygons->GetInput(i);
+					if (other->GetOffset() == input->GetOffset() && other->GetSource() != source && mesh->IsVertexSource(other->GetSource())) return false;
+				}
+			}
+		}
+
+		// Weld the values, in order.
+		UInt32List remap;
+		remap.resize(valueCount);
+		FloatList weldedData;
+		weldedData.reserve(valueCount * stride);
+		WeldGrid grid(stride, tolerance, valueCount);
+		const float* data = source->GetData();
+		for (size_t i = 0; i < valueCount; ++i)
+		{
+			remap[i] = grid.Insert(data + i * stride, weldedData);
+		}
+
+		if (weldedData.size() < valueCount * stride)
+		{
+			for (size_t p = 0; p < polygonsCount; ++p)
+			{
+				RemapSourceIndices(mesh->GetPolygons(p), source, remap);
+			}
+			source->SetData(weldedData, stride);
+		}
+		if (valueRemap != nullptr) valueRemap->insert(valueRemap->end(), remap.begin(), remap.end());
+		return true;
+	}
 }
@@ -25,6 +25,51 @@ typedef fm::map<uint32, UInt32List> FCDGeometryIndexTranslationMap;
 typedef fm::pvector<FCDGeometryIndexTranslationMap> FCDGeometryIndexTranslationMapList; /**< A dynamically-sized array of translation maps. */
 typedef fm::vector<UInt32List> FCDNewIndicesList; /**< A dynamically-sized array of index lists. */
 
+/** A translation table between the old vertex indices of a source and the new indices.
+	It holds the information of a translation map in two flat arrays, without any per-entry
+	allocation: the new indices of the old index i are the values from offsets[i] to
+	offsets[i + 1] - 1, in increasing order.
+	It is generated in the FCDGeometryPolygonsTools::GenerateUniqueIndices function. */
+struct FCDGeometryIndexTranslationTable
+{
+	UInt32List offsets; /**< For each old index, the position of its first new index. One last offset ends the values. */
+	UInt32List values; /**< The new indices, ordered by old index. */
+
+	/** Retrieves the number of old indices.
+		@return The number of old indices: the number of values of the source. */
+	inline size_t GetOldIndexCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+	/** Retrieves the number of new indices for an old index.
+		@param oldIndex An old index.
+		@return The number of new indices. */
+	inline size_t GetNewIndexCount(uint32 oldIndex) const { return offsets[oldIndex + 1] - offsets[oldIndex]; }
+
+	/** Retrieves the new indices for an old index.
+		@param oldIndex An old index.
+		@return The new indices. */
+	inline const uint32* GetNewIndices(uint32 oldIndex) const { return values.begin() + offsets[oldIndex]; }
+};
+typedef fm::vector<FCDGeometryIndexTranslationTable> FCDGeometryIndexTranslationTableList; /**< A dynamically-sized array of translation tables. */
+
+/** The efficiency of a post-transform vertex cache over the triangle lists of a mesh.
+	It is calculated in the FCDGeometryPolygonsTools::CalculateVertexCacheStatistics function. */
+struct FCDVertexCacheStatistics
+{
+	size_t triangleCount; /**< The number of triangles. */
+	size_t vertexCount; /**< The number of distinct vertices used by the triangles of each polygons set. */
+	size_t transformCount; /**< The number of vertices transformed: the number of cache misses. */
+
+	/** Retrieves the average cache miss ratio: the number of vertices transformed per triangle.
+		It ranges from 3.0, without any reuse, down to about 0.5 for large regular meshes.
+		@return The average cache miss ratio. */
+	inline float GetACMR() const { return (triangleCount > 0) ? (float) transformCount / (float) triangleCount : 0.0f; }
+
+	/** Retrieves the average transform to vertex ratio: the number of times each vertex is transformed.
+		It is 1.0 when each vertex is transformed only once.
+		@return The average transform to vertex ratio. */
+	inline float GetATVR() const { return (vertexCount > 0) ? (float) transformCount / (float) vertexCount : 0.0f; }
+};
+
 /** Holds commonly-used transformation functions for meshes and polygons sets. */
 namespace FCDGeometryPolygonsTools
 {
@@ -33,6 +78,21 @@ namespace FCDGeometryPolygonsTools
 		It represents the usual upper limit of video cards on buffer submission size*/
 	#define MAX_BUFFER_COUNT	((uint16)~0) 
 
+	/** The conventions of the texture tangents generated by the GenerateTextureTangentBasis function. */
+	enum TangentBasisConvention
+	{
+		/** The tangents of the face-vertex pairs that share their position, normal and texture coordinate indices
+			are averaged. The tangents have three components and the binormals are the normalized cross-products
+			of the normals and the tangents. */
+		TANGENT_BASIS_AVERAGED,
+
+		/** The conventions of MikkTSpace: the vertices are merged by the values of their position, normal and
+			texture coordinate and by the orientation of their texture mapping, and the tangents of their face-vertex
+			pairs are weighted by their angles. The tangents have four components: the fourth one is the handedness,
+			1 or -1, and the binormals are the cross-products of the normals and the tangents, times the handedness. */
+		TANGENT_BASIS_MIKKTSPACE
+	};
+
 	/** Triangulates a mesh.
 		@param mesh The mesh to triangulate. */
 	FCOLLADA_EXPORT void Triangulate(FCDGeometryMesh* mesh);
@@ -51,6 +111,17 @@ namespace FCDGeometryPolygonsTools
 			Do note that the binormal is always the cross-product of the tangent and the normal at a vertex-face pair. */
 	FCOLLADA_EXPORT void GenerateTextureTangentBasis(FCDGeometryMesh* mesh, FCDGeometrySource* texcoordSource, bool generateBinormals = true);
 
+	/** Generates the texture tangents and binormals for a given source of texture coordinates.
+		The tangents of the face-vertex pairs are calculated in parallel, over chunks of faces, then
+		summed up per tangential vertex in the order of the face-vertex pairs: the results do not
+		depend on the number of threads.
+		@param mesh The mesh that contains the texture coordinate source.
+		@param texcoordSource The source of texture coordinates that needs its tangents and binormals generated.
+		@param generateBinormals Whether the binormals should also be generated.
+		@param convention How the tangents are calculated and merged.
+		@param threadCount The number of threads to use. When zero, one thread per processor is used. */
+	FCOLLADA_EXPORT void GenerateTextureTangentBasis(FCDGeometryMesh* mesh, FCDGeometrySource* texcoordSource, bool generateBinormals, TangentBasisConvention convention, size_t threadCount = 0);
+
 	/** Prepares the mesh for using its geometry sources in vertex buffers with a unique index buffer.
 		This is useful for older engines and the applications that only support one index
 		per face-vertex pair.
@@ -72,6 +143,17 @@ namespace FCDGeometryPolygonsTools
         @param outTranslationMaps How the vertex data needs to be relocated in order to use the unique index buffer data. */
 	FCOLLADA_EXPORT void GenerateUniqueIndices(FCDGeometryMesh* mesh, FCDGeometryPolygons* polygonsToProcess, FCDNewIndicesList& outIndices, FCDGeometryIndexTranslationMapList& outTranslationMaps);
 
+	/** Prepares the mesh for using its geometry sources in vertex buffers with a unique index buffer.
+		This version of the GenerateUniqueIndices function fills in one translation table per mesh source,
+		but does not modify the data in the FCDGeometryPolygon objects.
+		The face-vertex pairs of each polygons set are merged on their own thread.
+		@param mesh The mesh to process.
+		@param polygonsToProcess The polygons set to isolate and process. If this pointer is nullptr, the whole mesh is processed
+			for one index buffer.
+		@param outIndices The unique index buffer data.
+		@param outTranslationTables How the vertex data needs to be relocated in order to use the unique index buffer data. */
+	FCOLLADA_EXPORT void GenerateUniqueIndices(FCDGeometryMesh* mesh, FCDGeometryPolygons* polygonsToProcess, FCDNewIndicesList& outIndices, FCDGeometryIndexTranslationTableList& outTranslationTables);
+
 	/** Applies the translation map onto some vertex data.
         Refer to the information within the translation map to pre-cache the necessary amount of vertices. 
         @param targData The vertex buffer data to be filled-in.
@@ -80,6 +162,13 @@ namespace FCDGeometryPolygonsTools
         @param translationMap How to relocate the vertex data. */
 	FCOLLADA_EXPORT void ApplyUniqueIndices(float* targData, float* srcData, uint32 stride, const FCDGeometryIndexTranslationMap* translationMap);
 
+	/** Applies the translation table onto some vertex data.
+		@param targData The vertex buffer data to be filled-in.
+		@param srcData The original vertex data.
+		@param stride The stride within the target vertex buffer data and within the orignal vertex data.
+		@param translationTable How to relocate the vertex data. */
+	FCOLLADA_EXPORT void ApplyUniqueIndices(float* targData, const float* srcData, uint32 stride, const FCDGeometryIndexTranslationTable& translationTable);
+
 	/** Applies the translation map onto some vertex data.
         Refer to the information within the translation map to pre-cache the necessary amount of vertices. 
         @param targMesh The mesh object to be modified in-place.
@@ -155,6 +244,42 @@ namespace FCDGeometryPolygonsTools
 		@param maximumIndexCount The maximum number of indices to have within each polygons set. */
 	FCOLLADA_EXPORT void FitIndexBuffers(FCDGeometryMesh* mesh, size_t maximumIndexCount);
 
+	/** Reorders the triangles of a mesh for the post-transform vertex cache, then sorts its vertices
+		in the order of their first use. Only the lists of triangles whose inputs all share the same
+		indices are reordered: run the Triangulate and the GenerateUniqueIndices tools first.
+		The vertices are sorted when all the polygons sets share their indices and all their sources
+		have one non-animated value per vertex. As with GenerateUniqueIndices, the skins and the morphers
+		of the mesh should then be translated with the vertex remap.
+		@param mesh The mesh to process.
+		@param optimizeOverdraw Whether the clusters of triangles should then be ordered to lower the overdraw,
+			drawing first the clusters that face away from the center of their polygons set.
+		@param vertexRemap An optional list that receives the new index of each old vertex.
+			It is left empty when the vertices are not sorted.
+		@return Whether the vertices were sorted. */
+	FCOLLADA_EXPORT bool OptimizeVertexCache(FCDGeometryMesh* mesh, bool optimizeOverdraw = false, UInt32List* vertexRemap = nullptr);
+
+	/** Simulates a FIFO post-transform vertex cache over the lists of triangles of a mesh.
+		Each polygons set is drawn from an empty cache, with the indices of its first input.
+		@param mesh The mesh to measure.
+		@param cacheSize The number of vertices held by the cache.
+		@return The efficiency of the cache. */
+	FCOLLADA_EXPORT FCDVertexCacheStatistics CalculateVertexCacheStatistics(const FCDGeometryMesh* mesh, size_t cacheSize = 16);
+
+	/** Welds the values of a source that are equivalent within a tolerance, as compared by the
+		IsEquivalent function on each of their components: each value is merged into the first
+		equivalent value before it. The values are looked up in a uniform grid, hashed on their
+		first three components, in linear expected time. The indices of all the polygons inputs
+		that reference the source are remapped; the inputs that share their indices with the inputs
+		of other sources are moved to a new offset, with their own indices. When welding positions,
+		the skins and the morphers of the mesh should then be translated with the value remap.
+		@param mesh The mesh that contains the source.
+		@param source The source to weld: positions, normals, texture coordinates or any other source.
+		@param tolerance The tolerance for each component. It must be positive.
+		@param valueRemap An optional list that receives the new index of each old value.
+		@return Whether the source was welded. Animated sources are not welded, nor are the vertex
+			sources that share their indices with other vertex sources. */
+	FCOLLADA_EXPORT bool WeldSource(FCDGeometryMesh* mesh, FCDGeometrySource* source, float tolerance = FLT_TOLERANCE, UInt32List* valueRemap = nullptr);
+
 	/** Reverses all the normals of a mesh.
 		Since they are related to normals, this function also reverses geometric
 		tangents and binormals as well as texture tangents and binormals.
@@ -21,6 +21,9 @@
 #ifndef _FCD_ENTITY_H_
 #include "FCDocument/FCDEntity.h"
 #endif // _FCD_ENITTY_H_
+#ifndef _FC_DOCUMENT_H_
+#include "FCDocument/FCDocument.h"
+#endif // _FC_DOCUMENT_H_
 
 template <class T>
 FCDLibrary<T>::FCDLibrary(FCDocument* document)
@@ -59,14 +62,11 @@ const T* FCDLibrary<T>::FindDaeId(const fm::string& daeId) const
 	FUAssert (daeId.empty() || daeId[0] != '#',);
 #endif
 
-	size_t entityCount = entities.size();
-	for (size_t i = 0; i < entityCount; ++i)
+	// The document holds the map of unique ids of all its objects.
+	const FCDObjectWithId* found = GetDocument()->FindDaeId(daeId);
+	if (found != nullptr && found->GetObjectType() == T::GetClassType())
 	{
-		const FCDEntity* found = entities[i]->FindDaeId(daeId);
-		if (found != nullptr && found->GetObjectType() == T::GetClassType())
-		{
-			return (T*) found;
-		}
+		return (const T*) found;
 	}
 	return nullptr;
 }
@@ -0,0 +1,295 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#include "StdAfx.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDController.h"
+#include "FCDocument/FCDGeometry.h"
+#include "FCDocument/FCDGeometryMesh.h"
+#include "FCDocument/FCDGeometrySource.h"
+#include "FCDocument/FCDMorphController.h"
+#include "FCDocument/FCDMorphDeformer.h"
+#include "FUtils/FUThreadPool.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FCD_MORPH_DEFORMER_SSE
+#include <xmmintrin.h>
+#endif // SSE
+
+// The number of positions or normals given to a worker thread at once.
+static const size_t valueChunkSize = 4096;
+
+// The worker threads are shared by all the morph deformers.
+static FUThreadPool* morphingPool = nullptr;
+static FUCriticalSection morphingPoolCriticalSection;
+
+static FUThreadPool* GetMorphingPool()
+{
+	morphingPoolCriticalSection.Enter();
+	if (morphingPool == nullptr) morphingPool = new FUThreadPool();
+	FUThreadPool* pool = morphingPool;
+	morphingPoolCriticalSection.Leave();
+	return pool;
+}
+
+#ifdef FCD_MORPH_DEFORMER_SSE
+static inline void StoreVector3(float* out, __m128 v)
+{
+	_mm_storel_pi((__m64*) out, v);
+	_mm_store_ss(out + 2, _mm_movehl_ps(v, v));
+}
+#endif // FCD_MORPH_DEFORMER_SSE
+
+//
+// FCDMorphDeformer
+//
+
+FCDMorphDeformer::FCDMorphDeformer()
+{
+	ClearStream(positions);
+	ClearStream(normals);
+}
+
+FCDMorphDeformer::~FCDMorphDeformer()
+{
+}
+
+void FCDMorphDeformer::ReleaseWorkerThreads()
+{
+	morphingPoolCriticalSection.Enter();
+	SAFE_DELETE(morphingPool);
+	morphingPoolCriticalSection.Leave();
+}
+
+bool FCDMorphDeformer::Compile(const FCDMorphController* morph, float tolerance)
+{
+	targets.clear();
+	activeTargets.clear();
+	activeWeights.clear();
+	ClearStream(positions);
+	ClearStream(normals);
+
+	// Retrieve the base mesh and its position and normal sources.
+	if (morph == nullptr || morph->GetParent() == nullptr) return false;
+	const FCDGeometry* geometry = morph->GetParent()->GetBaseGeometry();
+	const FCDGeometryMesh* mesh = (geometry != nullptr) ? geometry->GetMesh() : nullptr;
+	if (mesh == nullptr) return false;
+	const FCDGeometrySource* positionSource = mesh->FindSourceByType(FUDaeGeometryInput::POSITION);
+	if (positionSource == nullptr || positionSource->GetStride() < 3) return false;
+	size_t vertexCount = positionSource->GetValueCount();
+	const FCDGeometrySource* normalSource = mesh->FindSourceByType(FUDaeGeometryInput::NORMAL);
+	if (normalSource != nullptr && normalSource->GetStride() < 3) normalSource = nullptr;
+
+	// The morph targets without a geometry do not move the base mesh.
+	size_t targetCount = morph->GetTargetCount();
+	fm::pvector<const FCDGeometrySource> targetPositionSources, targetNormalSources;
+	targetPositionSources.reserve(targetCount);
+	targetNormalSources.reserve(targetCount);
+	for (size_t t = 0; t < targetCount; ++t)
+	{
+		const FCDGeometry* targetGeometry = morph->GetTarget(t)->GetGeometry();
+		const FCDGeometrySource* targetPositionSource = nullptr, * targetNormalSource = nullptr;
+		if (targetGeometry != nullptr)
+		{
+			const FCDGeometryMesh* targetMesh = targetGeometry->GetMesh();
+			FUAssert(targetMesh != nullptr, return false);
+			targetPositionSource = targetMesh->FindSourceByType(FUDaeGeometryInput::POSITION);
+			FUAssert(targetPositionSource != nullptr && targetPositionSource->GetStride() >= 3 && targetPositionSource->GetValueCount() == vertexCount, return false);
+			targetNormalSource = targetMesh->FindSourceByType(FUDaeGeometryInput::NORMAL);
+			if (normalSource != nullptr && (targetNormalSource == nullptr || targetNormalSource->GetStride() < 3
+				|| targetNormalSource->GetValueCount() != normalSource->GetValueCount()))
+			{
+				normalSource = nullptr;
+			}
+		}
+		targetPositionSources.push_back(targetPositionSource);
+		targetNormalSources.push_back(targetNormalSource);
+	}
+
+	bool relative = morph->GetMethod() == FUDaeMorphMethod::RELATIVE;
+	CompileStream(positions, positionSource, targetPositionSources, relative, tolerance);
+	if (normalSource != nullptr)
+	{
+		CompileStream(normals, normalSource, targetNormalSources, relative, tolerance);
+		normals.normalize = true;
+	}
+
+	targets.reserve(targetCount);
+	for (size_t t = 0; t < targetCount; ++t) targets.push_back(morph->GetTarget(t));
+	activeTargets.reserve(targetCount);
+	activeWeights.reserve(targetCount);
+	return true;
+}
+
+void FCDMorphDeformer::ClearStream(Stream& stream)
+{
+	stream.valueCount = 0;
+	stream.chunkCount = 0;
+	stream.base.clear();
+	stream.indices.clear();
+	stream.deltas.clear();
+	stream.offsets.clear();
+	stream.blended.clear();
+	stream.output.clear();
+	stream.normalize = false;
+}
+
+void FCDMorphDeformer::CompileStream(Stream& stream, const FCDGeometrySource* source, const fm::pvector<const FCDGeometrySource>& targetSources, bool relative, float tolerance)
+{
+	stream.valueCount = source->GetValueCount();
+	stream.chunkCount = (stream.valueCount + valueChunkSize - 1) / valueChunkSize;
+
+	// The base values, padded to four floating-point values.
+	uint32 stride = source->GetStride();
+	const float* data = source->GetData();
+	stream.base.resize(4 * stream.valueCount);
+	for (size_t v = 0; v < stream.valueCount; ++v)
+	{
+		float* out = stream.base.begin() + 4 * v;
+		out[0] = data[v * stride]; out[1] = data[v * stride + 1]; out[2] = data[v * stride + 2]; out[3] = 0.0f;
+	}
+	stream.blended.resize(4 * stream.valueCount);
+	stream.output.resize(3 * stream.valueCount);
+
+	// For each target and each chunk, the differences larger than the tolerance.
+	stream.offsets.reserve(targetSources.size() * (stream.chunkCount + 1));
+	for (size_t t = 0; t < targetSources.size(); ++t)
+	{
+		const FCDGeometrySource* targetSource = targetSources[t];
+		uint32 targetStride = (targetSource != nullptr) ? targetSource->GetStride() : 0;
+		const float* targetData = (targetSource != nullptr) ? targetSource->GetData() : nullptr;
+		for (size_t c = 0; c < stream.chunkCount; ++c)
+		{
+			stream.offsets.push_back((uint32) stream.indices.size());
+			if (targetData == nullptr) continue;
+			size_t end = min(stream.valueCount, (c + 1) * valueChunkSize);
+			for (size_t v = c * valueChunkSize; v < end; ++v)
+			{
+				const float* value = targetData + v * targetStride;
+				const float* base = stream.base.begin() + 4 * v;
+				float dx = value[0], dy = value[1], dz = value[2];
+				if (!relative) { dx -= base[0]; dy -= base[1]; dz -= base[2]; }
+				if (fabsf(dx) <= tolerance && fabsf(dy) <= tolerance && fabsf(dz) <= tolerance) continue;
+
+				// Grow the sparse stream geometrically.
+				if (stream.indices.size() == stream.indices.capacity())
+				{
+					size_t capacity = max((size_t) 1024, 2 * stream.indices.capacity());
+					stream.indices.reserve(capacity);
+					stream.deltas.reserve(4 * capacity);
+				}
+				stream.indices.push_back((uint32) v);
+				stream.deltas.push_back(dx); stream.deltas.push_back(dy); stream.deltas.push_back(dz); stream.deltas.push_back(0.0f);
+			}
+		}
+		stream.offsets.push_back((uint32) stream.indices.size());
+	}
+}
+
+bool FCDMorphDeformer::Deform(const float* weights, size_t weightCount)
+{
+	if (positions.base.empty()) return false;
+	FUAssert(weightCount == targets.size(), return false);
+
+	// Only the morph targets with a non-zero weight are blended.
+	activeTargets.clear();
+	activeWeights.clear();
+	for (size_t t = 0; t < weightCount; ++t)
+	{
+		if (weights[t] == 0.0f) continue;
+		activeTargets.push_back((uint32) t);
+		activeWeights.push_back(weights[t]);
+	}
+
+	size_t chunkCount = positions.chunkCount + normals.chunkCount;
+	if (chunkCount > 1 && FCollada::GetParallelAnimationFlag())
+	{
+		GetMorphingPool()->Run(BlendChunkTask, this, chunkCount);
+	}
+	else
+	{
+		for (size_t i = 0; i < positions.chunkCount; ++i) BlendChunk(positions, i);
+		for (size_t i = 0; i < normals.chunkCount; ++i) BlendChunk(normals, i);
+	}
+	return true;
+}
+
+bool FCDMorphDeformer::Deform()
+{
+	targetWeights.resize(targets.size());
+	for (size_t t = 0; t < targets.size(); ++t)
+	{
+		targetWeights[t] = *targets[t]->GetWeight();
+	}
+	return Deform(targetWeights.begin(), targetWeights.size());
+}
+
+void FCDMorphDeformer::BlendChunk(Stream& stream, size_t chunk)
+{
+	size_t start = chunk * valueChunkSize;
+	size_t end = min(stream.valueCount, start + valueChunkSize);
+	memcpy(stream.blended.begin() + 4 * start, stream.base.begin() + 4 * start, 4 * sizeof(float) * (end - start));
+
+	// Add the weighted differences, in the order of the morph targets.
+	float* blended = stream.blended.begin();
+	for (size_t a = 0; a < activeTargets.size(); ++a)
+	{
+		const uint32* offsets = stream.offsets.begin() + activeTargets[a] * (stream.chunkCount + 1) + chunk;
+		const uint32* index = stream.indices.begin() + offsets[0];
+		const uint32* lastIndex = stream.indices.begin() + offsets[1];
+		const float* delta = stream.deltas.begin() + 4 * offsets[0];
+#ifdef FCD_MORPH_DEFORMER_SSE
+		__m128 weight = _mm_set1_ps(activeWeights[a]);
+		for (; index < lastIndex; ++index, delta += 4)
+		{
+			float* out = blended + 4 * (*index);
+			_mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(_mm_loadu_ps(delta), weight)));
+		}
+#else
+		float weight = activeWeights[a];
+		for (; index < lastIndex; ++index, delta += 4)
+		{
+			float* out = blended + 4 * (*index);
+			out[0] += delta[0] * weight; out[1] += delta[1] * weight; out[2] += delta[2] * weight;
+		}
+#endif // FCD_MORPH_DEFORMER_SSE
+	}
+
+	// Repack the blended values, normalizing the normals.
+	const float* in = blended + 4 * start;
+	float* out = stream.output.begin() + 3 * start;
+	for (size_t v = start; v < end; ++v, in += 4, out += 3)
+	{
+#ifdef FCD_MORPH_DEFORMER_SSE
+		__m128 value = _mm_loadu_ps(in);
+		if (stream.normalize)
+		{
+			__m128 squares = _mm_mul_ps(value, value);
+			__m128 length = _mm_sqrt_ss(_mm_add_ss(_mm_add_ss(squares, _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(1, 1, 1, 1))),
+				_mm_movehl_ps(squares, squares)));
+			if (_mm_cvtss_f32(length) > 0.0f) value = _mm_div_ps(value, _mm_shuffle_ps(length, length, 0));
+		}
+		StoreVector3(out, value);
+#else
+		FMVector3 value(in[0], in[1], in[2]);
+		if (stream.normalize)
+		{
+			float length = value.Length();
+			if (length > 0.0f) value /= length;
+		}
+		out[0] = value.m_X; out[1] = value.m_Y; out[2] = value.m_Z;
+#endif // FCD_MORPH_DEFORMER_SSE
+	}
+}
+
+void FCDMorphDeformer::BlendChunkTask(void* deformer, size_t chunk)
+{
+	FCDMorphDeformer* d = (FCDMorphDeformer*) deformer;
+	if (chunk < d->positions.chunkCount) d->BlendChunk(d->positions, chunk);
+	else d->BlendChunk(d->normals, chunk - d->positions.chunkCount);
+}
@@ -0,0 +1,134 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/**
+	@file FCDMorphDeformer.h
+	This file contains the FCDMorphDeformer class.
+*/
+
+#ifndef _FCD_MORPH_DEFORMER_H_
+#define _FCD_MORPH_DEFORMER_H_
+
+class FCDGeometrySource;
+class FCDMorphController;
+class FCDMorphTarget;
+
+/**
+	A compiled morph controller, which blends the positions and the normals
+	of its morph targets into its base mesh on the CPU.
+
+	On compilation, the difference between each morph target and the base
+	mesh is stored once, as a sparse stream of the vertices that the morph
+	target moves. With the NORMALIZED method, the differences are taken from
+	the absolute target positions. With the RELATIVE method, the target
+	positions are already the differences.
+	For each deformation, the morph targets with a zero weight are skipped and
+	the differences of the others are weighted and added to the base mesh.
+	The blended normals are normalized.
+
+	The vertices are cut into chunks which, when the global parallel
+	animation flag is set, are blended on a pool of worker threads.
+	The results do not depend on the number of threads.
+
+	@see FCollada::SetParallelAnimationFlag FUDaeMorphMethod
+	@ingroup FCDocument
+*/
+class FCOLLADA_EXPORT FCDMorphDeformer
+{
+private:
+	// The base values and the sparse differences of one vertex attribute.
+	struct Stream
+	{
+		size_t valueCount;
+		size_t chunkCount;
+		FloatList base; // Four floating-point values per value.
+		UInt32List indices; // The value indices of the differences.
+		FloatList deltas; // Four floating-point values per difference.
+		UInt32List offsets; // For each target and each chunk, the first difference.
+		FloatList blended; // Four floating-point values per value.
+		FloatList output; // Three floating-point values per value.
+		bool normalize;
+	};
+
+	fm::pvector<const FCDMorphTarget> targets;
+	Stream positions;
+	Stream normals;
+	UInt32List activeTargets;
+	FloatList activeWeights;
+	FloatList targetWeights;
+
+public:
+	/** Constructor.
+		The deformer is empty until it is compiled. */
+	FCDMorphDeformer();
+
+	/** Destructor. */
+	~FCDMorphDeformer();
+
+	/** Compiles a morph controller.
+		The base target and the morph target geometries must be meshes with
+		the same number of positions. The normals are blended only when the
+		base mesh and all the morph target meshes have the same number of normals.
+		The morph controller and its targets must outlive the compiled deformer.
+		@param morph The morph controller.
+		@param tolerance The largest difference, on each coordinate, that is
+			not stored in the sparse streams.
+		@return Whether the morph controller was compiled. */
+	bool Compile(const FCDMorphController* morph, float tolerance = 0.0f);
+
+	/** Blends the morph targets with the given weights.
+		@param weights The weight of each morph target.
+		@param weightCount The number of weights.
+			This number should be the number of morph targets.
+		@return Whether the morph targets were blended. */
+	bool Deform(const float* weights, size_t weightCount);
+
+	/** Blends the morph targets with their current weights.
+		@return Whether the morph targets were blended. */
+	bool Deform();
+
+	/** Retrieves the number of morph targets.
+		@return The number of morph targets. */
+	inline size_t GetTargetCount() const { return targets.size(); }
+
+	/** Retrieves the number of morph targets blended by the last deformation.
+		@return The number of morph targets with a non-zero weight. */
+	inline size_t GetActiveTargetCount() const { return activeTargets.size(); }
+
+	/** Retrieves the number of stored position differences, for all the morph targets.
+		@return The number of position differences. */
+	inline size_t GetPositionDeltaCount() const { return positions.indices.size(); }
+
+	/** Retrieves the number of vertices of the base mesh.
+		@return The number of vertices. */
+	inline size_t GetVertexCount() const { return positions.valueCount; }
+
+	/** Retrieves the blended positions.
+		@return The blended positions, three floating-point values per vertex. */
+	inline const float* GetPositions() const { return positions.output.begin(); }
+
+	/** Retrieves the number of normals of the base mesh.
+		@return The number of normals. This number is zero when the normals are not blended. */
+	inline size_t GetNormalCount() const { return normals.valueCount; }
+
+	/** Retrieves the blended normals.
+		@return The blended normals, three floating-point values per normal. */
+	inline const float* GetNormals() const { return normals.output.begin(); }
+
+	/** [INTERNAL] Releases the worker threads shared by the morph deformers.
+		Called when the FCollada library is released. */
+	static void ReleaseWorkerThreads();
+
+private:
+	static void CompileStream(Stream& stream, const FCDGeometrySource* source, const fm::pvector<const FCDGeometrySource>& targetSources, bool relative, float tolerance);
+	static void ClearStream(Stream& stream);
+	void BlendChunk(Stream& stream, size_t chunk);
+	static void BlendChunkTask(void* deformer, size_t chunk);
+};
+
+#endif // _FCD_MORPH_DEFORMER_H_
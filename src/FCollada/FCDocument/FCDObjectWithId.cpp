@@ -9,7 +9,6 @@
 #include "StdAfx.h"
 #include "FCDocument.h"
 #include "FCDObjectWithId.h"
-#include "FUtils/FUUniqueStringMap.h"
 
 static const size_t MAX_ID_LENGTH = 512;
 
@@ -33,6 +32,7 @@ FCDObjectWithId::~FCDObjectWithId()
 
 void FCDObjectWithId::Clone(FCDObjectWithId* clone) const
 {
+	clone->RemoveDaeId();
 	clone->m_DaeId = m_DaeId;
 	const_cast<FCDObjectWithId*>(this)->RemoveDaeId();
 }
@@ -43,9 +43,9 @@ const fm::string& FCDObjectWithId::GetDaeId() const
 	{
 		// Generate a new id
 		FCDObjectWithId* e = const_cast<FCDObjectWithId*>(this);
-		FUSUniqueStringMap* names = e->GetDocument()->GetUniqueNameMap();
+		FCDocument* document = e->GetDocument();
 		FUAssert(!e->m_DaeId->empty(), e->m_DaeId = "unknown_object");
-		names->insert(e->m_DaeId);
+		document->RegisterDaeId(e, e->m_DaeId);
 		e->SetUniqueIdFlag();
 	}
 	return m_DaeId;
@@ -56,9 +56,9 @@ void FCDObjectWithId::SetDaeId(const fm::string& id)
 	RemoveDaeId();
 
 	// Use this id to enforce a unique id.
-	FUSUniqueStringMap* names = GetDocument()->GetUniqueNameMap();
+	FCDocument* document = GetDocument();
 	m_DaeId = CleanId(id);
-	names->insert(m_DaeId);
+	document->RegisterDaeId(this, m_DaeId);
 	SetUniqueIdFlag();
 	SetDirtyFlag();
 }
@@ -73,8 +73,7 @@ void FCDObjectWithId::RemoveDaeId()
 {
 	if (GetUniqueIdFlag())
 	{
-		FUSUniqueStringMap* names = GetDocument()->GetUniqueNameMap();
-		names->erase(m_DaeId);
+		GetDocument()->UnregisterDaeId(this, m_DaeId);
 		ResetUniqueIdFlag();
 		SetDirtyFlag();
 	}
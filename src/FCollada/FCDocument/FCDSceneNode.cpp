@@ -51,6 +51,7 @@ FCDSceneNode::FCDSceneNode(FCDocument* document)
 ,	InitializeParameterAnimatable(visibility, 1.0f)
 ,	targetCount(0)
 ,	InitializeParameterNoArg(daeSubId)
+,	isLocalTransformCached(false), isWorldTransformCached(false)
 {
 	SetTransformsDirtyFlag();
 	ResetJointFlag();
@@ -65,6 +66,7 @@ FCDSceneNode::~FCDSceneNode()
 	{
 		FCDSceneNode* child = children.front();
 		child->parents.erase(this);
+		child->InvalidateWorldTransform();
 
 		if (child->parents.empty()) { SAFE_RELEASE(child); }
 		else
@@ -112,6 +114,7 @@ bool FCDSceneNode::AddChildNode(FCDSceneNode* sceneNode)
 
 	children.push_back(sceneNode);
 	sceneNode->parents.push_back(this);
+	sceneNode->InvalidateWorldTransform();
 	SetNewChildFlag();
 	return true;
 }
@@ -127,6 +130,7 @@ void FCDSceneNode::RemoveChildNode(FCDSceneNode* sceneNode)
 {
 	sceneNode->parents.erase(this);
 	children.erase(sceneNode);
+	sceneNode->InvalidateWorldTransform();
 }
 
 // Instantiates an entity
@@ -157,7 +161,7 @@ FCDTransform* FCDSceneNode::AddTransform(FCDTransform::Type type, size_t index)
 		else transforms.insert(index, transform);
 	}
 	SetNewChildFlag();
-	SetTransformsDirtyFlag();
+	InvalidateTransforms();
 	return transform;
 }
 
@@ -247,27 +251,67 @@ void FCDSceneNode::GetHierarchicalAssets(FCDAssetConstList& assets) const
 // Calculate the transform matrix for a given scene node
 FMMatrix44 FCDSceneNode::ToMatrix() const
 {
-	FMMatrix44 localTransform = FMMatrix44::Identity;
-	for (const FCDTransform** it = transforms.begin(); it != transforms.end(); ++it)
+	if (transforms.empty()) return FMMatrix44::Identity;
+	FMMatrix44 localTransform = transforms.front()->ToMatrix();
+	for (const FCDTransform** it = transforms.begin() + 1; it != transforms.end(); ++it)
 	{
 		localTransform = localTransform * (*it)->ToMatrix();
 	}
 	return localTransform;
 }
 
+FMMatrix44 FCDSceneNode::CalculateLocalTransform() const
+{
+	if (!isLocalTransformCached)
+	{
+		cachedLocalTransform = ToMatrix();
+		isLocalTransformCached = true;
+	}
+	return cachedLocalTransform;
+}
+
 FMMatrix44 FCDSceneNode::CalculateWorldTransform() const
 {
+	if (isWorldTransformCached) return cachedWorldTransform;
+
+	// A cached world transform implies cached world transforms for all the parents:
+	// list the parents without one, then compute their world transforms from the top down.
 	const FCDSceneNode* parent = GetParent();
-	if (parent != nullptr)
+	if (parent != nullptr && !parent->isWorldTransformCached)
 	{
-		//FMMatrix44 tm1 = parent->CalculateWorldTransform();
-		//FMMatrix44 tm2 = CalculateLocalTransform();
-		//return tm1 * tm2;
-		return parent->CalculateWorldTransform() * CalculateLocalTransform();
+		fm::pvector<const FCDSceneNode> uncached;
+		for (; parent != nullptr && !parent->isWorldTransformCached; parent = parent->GetParent()) uncached.push_back(parent);
+		for (size_t i = uncached.size(); i > 0; --i) uncached[i - 1]->CalculateWorldTransform();
+		parent = GetParent();
 	}
-	else
+	if (parent != nullptr) cachedWorldTransform = parent->cachedWorldTransform * CalculateLocalTransform();
+	else cachedWorldTransform = CalculateLocalTransform();
+	isWorldTransformCached = true;
+	return cachedWorldTransform;
+}
+
+void FCDSceneNode::InvalidateTransforms()
+{
+	SetTransformsDirtyFlag();
+	isLocalTransformCached = false;
+	InvalidateWorldTransform();
+}
+
+void FCDSceneNode::InvalidateWorldTransform()
+{
+	// The descendants of a node without a cached world transform don't have one either.
+	if (!isWorldTransformCached) return;
+	fm::pvector<FCDSceneNode> queue;
+	queue.push_back(this);
+	while (!queue.empty())
 	{
-		return CalculateLocalTransform();
+		FCDSceneNode* node = queue.back();
+		queue.pop_back();
+		node->isWorldTransformCached = false;
+		for (FCDSceneNode** it = node->children.begin(); it != node->children.end(); ++it)
+		{
+			if ((*it)->isWorldTransformCached) queue.push_back(*it);
+		}
 	}
 }
 
@@ -323,6 +367,7 @@ FCDEntity* FCDSceneNode::Clone(FCDEntity* _clone, bool cloneChildren) const
 			FCDEntityInstance* instance = clone->AddInstance((*it)->GetEntityType());
 			(*it)->Clone(instance);
 		}
+		clone->InvalidateTransforms();
 	}
 
 	return _clone;
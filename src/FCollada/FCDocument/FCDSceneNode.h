@@ -72,6 +72,12 @@ private:
 	// Mainly for joints.
 	DeclareParameter(fm::string, FUParameterQualifiers::SIMPLE, daeSubId, FC("Sub-id"));
 
+	// The cached transforms, valid until the transforms of this node or of its parents change.
+	mutable FMMatrix44 cachedLocalTransform;
+	mutable FMMatrix44 cachedWorldTransform;
+	mutable bool isLocalTransformCached;
+	mutable bool isWorldTransformCached;
+
 public:
 	DeclareFlag(TransformsDirty, 0); /**< Whether the transforms have been dirtied. */
 	DeclareFlag(Joint, 1); /**< Whether the scene node is a joint. */
@@ -265,16 +271,28 @@ public:
 	FMMatrix44 ToMatrix() const;
 
 	/** Retrieves the local transform for this visual scene node.
-		This is a shortcut to the above function. The above function
-		will be deprecated in the future.
+		The local transform is cached until the transforms of this
+		visual scene node change. This function does not handle or apply animations.
 		@return The local transform. */
-	inline FMMatrix44 CalculateLocalTransform() const { return ToMatrix(); }
+	FMMatrix44 CalculateLocalTransform() const;
 
 	/** Retrieves the world transform for this visual scene node.
-		This function is not optimized and will not work with node instances.
+		The world transform is cached until the transforms of this visual
+		scene node or of one of its parents change. For node instances,
+		only the first parent is considered.
+		To update the world transforms of a whole visual scene at once,
+		use the FCDSceneNodeTools::UpdateWorldTransforms function.
 		@return The world transform. */
 	FMMatrix44 CalculateWorldTransform() const;
 
+	/** Flags the transforms of this visual scene node as modified.
+		This function sets the TransformsDirty flag and invalidates the cached
+		local transform of this visual scene node along with the cached world
+		transforms of this visual scene node and of its descendants.
+		It is called by the FCDTransform::SetValueChange function: when modifying
+		the values of a transform directly, call FCDTransform::SetValueChange. */
+	void InvalidateTransforms();
+
 	/** Copies the entity information into a clone.
 		All the overwriting functions of this function should call this function
 		to copy the COLLADA id and the other entity-level information.
@@ -297,6 +315,10 @@ public:
 	/** [INTERNAL] Cleans up the sub identifiers.
 		The sub identifiers must be unique with respect to its parent. This method corrects the sub ids if there are conflicts. */
 	virtual void CleanSubId();
+
+private:
+	// Invalidates the cached world transforms of this node and of its descendants.
+	void InvalidateWorldTransform();
 };
 
 #endif // _FCD_SCENE_NODE_
@@ -8,21 +8,58 @@
 
 #include "StdAfx.h"
 #include "FCDocument/FCDSceneNode.h"
+#include "FCDocument/FCDSceneNodeIterator.h"
+#ifndef __APPLE__
+#include "FCDocument/FCDSceneNodeIterator.hpp"
+#endif // __APPLE__
 #include "FCDocument/FCDSceneNodeTools.h"
 #include "FCDocument/FCDTransform.h"
 #include "FCDocument/FCDAnimated.h"
 #include "FCDocument/FCDAnimationCurve.h"
 #include "FCDocument/FCDAnimationKey.h"
+#include "FUtils/FUThreadPool.h"
 
 namespace FCDSceneNodeTools
 {
 	static FloatList sampleKeys;
 	static FMMatrix44List sampleValues;
 
-	void GenerateSampledAnimation(FCDSceneNode* node)
+	// Merges a list of increasing times in with the sample keys, which are also in increasing order.
+	// The times equivalent to a sample key are dropped.
+	static void MergeSampleKeys(FloatList& keys, const float* times, size_t timeCount, FloatList& merged)
 	{
-		sampleKeys.clear();
-		sampleValues.clear();
+		merged.clear();
+		merged.reserve(keys.size() + timeCount);
+		size_t keyCount = keys.size();
+		size_t s = 0;
+		size_t c = 0;
+		while (s < keyCount && c < timeCount)
+		{
+			float sampleKey = keys[s], curveKey = times[c];
+			if (IsEquivalent(sampleKey, curveKey)) { merged.push_back(sampleKey); ++s; ++c; }
+			else if (sampleKey < curveKey) merged.push_back(keys[s++]);
+			else merged.push_back(times[c++]);
+		}
+
+		// Add all the left-over keys and times.
+		while (s < keyCount) merged.push_back(keys[s++]);
+		while (c < timeCount) merged.push_back(times[c++]);
+		keys.clear();
+		keys.insert(keys.end(), merged.begin(), merged.size());
+	}
+
+	struct SampledValue
+	{
+		const FCDAnimationCurve* curve;
+		float* value;
+		size_t keyIndex;
+	};
+	typedef fm::vector<SampledValue, true> SampledValueList;
+
+	void GenerateSampledAnimation(FCDSceneNode* node, FloatList& keys, FMMatrix44List& matrices)
+	{
+		keys.clear();
+		matrices.clear();
 
 		FCDAnimatedList animateds;
 		// Special case for rotation angles: need to check for changes that are greater than 180 degrees.
@@ -34,9 +71,9 @@ namespace FCDSceneNodeTools
 		{
 			FCDTransform* transform = node->GetTransform(t);
 			FCDAnimated* animated = transform->GetAnimated();
-			if (animated != nullptr)
+			if (animated != nullptr && animated->HasCurve())
 			{
-				if (animated->HasCurve()) animateds.push_back(animated);
+				animateds.push_back(animated);
 
 				// Figure out whether this is a rotation and then, which animated value contains the angle.
 				if (!transform->HasType(FCDTRotation::GetClassType())) angleIndices.push_back(-1);
@@ -46,46 +83,38 @@ namespace FCDSceneNodeTools
 		if (animateds.empty()) return;
 
 		// Make a list of the ordered key times to sample
+		FloatList curveTimes, merged;
+		SampledValueList sampledValues;
 		size_t animatedsCount = animateds.size();
 		for (size_t i = 0; i < animatedsCount; ++i)
 		{
 			FCDAnimated* animated = animateds[i];
 			int32 angleIndex = angleIndices[i];
 
-			const FCDAnimationCurveListList& allCurves = animated->GetCurves();
+			const FCDAnimationCurveListList& allCurves = const_cast<const FCDAnimated*>(animated)->GetCurves();
 			size_t valueCount = allCurves.size();
 			for (size_t curveIndex = 0; curveIndex < valueCount; ++curveIndex)
 			{
 				const FCDAnimationCurveTrackList& curves = allCurves[curveIndex];
 				if (curves.empty()) continue;
 
-				size_t curveKeyCount = curves.front()->GetKeyCount();
-				const FCDAnimationKey** curveKeys = curves.front()->GetKeys();
-				size_t sampleKeyCount = sampleKeys.size();
+				// List the value to sample, as FCDAnimated::Evaluate does.
+				SampledValue sampledValue = { curves.front(), (curveIndex < animated->GetValueCount()) ? animated->GetValue(curveIndex) : nullptr, 0 };
+				if (sampledValue.curve != nullptr && sampledValue.value != nullptr) sampledValues.push_back(sampledValue);
 
 				// Merge this curve's keys in with the sample keys
 				// This assumes both key lists are in increasing order
-				size_t s = 0;
-				size_t c = 0;
-				while (s < sampleKeyCount && c < curveKeyCount)
-				{
-					float sampleKey = sampleKeys[s], curveKey = curveKeys[c]->input;
-					if (IsEquivalent(sampleKey, curveKey)) { ++s; ++c; }
-					else if (sampleKey < curveKey) { ++s; }
-					else
-					{
-						// Add this curve key to the sampling key list
-						sampleKeys.insert(sampleKeys.begin() + (s++), curveKeys[c++]->input);
-						sampleKeyCount++;
-					}
-				}
-
-				// Add all the left-over curve keys to the sampling key list
-				while (c < curveKeyCount) sampleKeys.push_back(curveKeys[c++]->input);
+				size_t curveKeyCount = curves.front()->GetKeyCount();
+				const FCDAnimationKey** curveKeys = curves.front()->GetKeys();
+				curveTimes.clear();
+				curveTimes.reserve(curveKeyCount);
+				for (size_t c = 0; c < curveKeyCount; ++c) curveTimes.push_back(curveKeys[c]->input);
+				MergeSampleKeys(keys, curveTimes.begin(), curveTimes.size(), merged);
 
 				// Check for large angular rotations..
 				if (angleIndex == (intptr_t) curveIndex)
 				{
+					curveTimes.clear();
 					for (size_t f = 1; f < curveKeyCount; ++f)
 					{
 						const FCDAnimationKey* previousKey = curveKeys[f - 1];
@@ -100,46 +129,151 @@ namespace FCDSceneNodeTools
 							{
 								float fd = (float) d;
 								float fid = (float) (addSampleCount + 1 - d);
-								float addSampleTime = (currentKey->input * fd + previousKey->input * fid) / (fd + fid);
-
-								// Sorted insert.
-								float* endIt = sampleKeys.end();
-								for (float* sampleKeyTime = sampleKeys.begin(); sampleKeyTime != endIt; ++sampleKeyTime)
-								{
-									if (IsEquivalent(*sampleKeyTime, addSampleTime)) break;
-									else if (*sampleKeyTime > addSampleTime)
-									{
-										sampleKeys.insert(sampleKeyTime, addSampleTime);
-										break;
-									}
-								}
+								curveTimes.push_back((currentKey->input * fd + previousKey->input * fid) / (fd + fid));
 							}
 						}
 					}
+					if (!curveTimes.empty()) MergeSampleKeys(keys, curveTimes.begin(), curveTimes.size(), merged);
 				}
 			}
 		}
-		size_t sampleKeyCount = sampleKeys.size();
+		size_t sampleKeyCount = keys.size();
 		if (sampleKeyCount == 0) return;
 
 		// Pre-allocate the value array;
-		sampleValues.reserve(sampleKeyCount);
+		matrices.reserve(sampleKeyCount);
 
 		// Sample the scene node transform
 		for (size_t i = 0; i < sampleKeyCount; ++i)
 		{
-			float sampleTime = sampleKeys[i];
-			for (FCDAnimatedList::iterator it = animateds.begin(); it != animateds.end(); ++it)
+			// Sample each curve, which changes the transform values directly.
+			// The sample times increase: each curve search starts from its last key interval.
+			float sampleTime = keys[i];
+			for (SampledValue* it = sampledValues.begin(); it != sampledValues.end(); ++it)
 			{
-				// Sample each animated, which changes the transform values directly
-				(*it)->Evaluate(sampleTime);
+				*(*it).value = (*it).curve->Evaluate(sampleTime, (*it).keyIndex);
 			}
 
 			// Retrieve the new transform matrix for the COLLADA scene node
-			sampleValues.push_back(node->ToMatrix());
+			matrices.push_back(node->ToMatrix());
+		}
+
+		// Flag the sampled transforms as modified.
+		for (FCDAnimatedList::iterator it = animateds.begin(); it != animateds.end(); ++it)
+		{
+			FCDObject* target = (*it)->GetTargetObject();
+			if (target != nullptr) target->SetValueChange();
 		}
 	}
 
+	void GenerateSampledAnimation(FCDSceneNode* node)
+	{
+		GenerateSampledAnimation(node, sampleKeys, sampleValues);
+	}
+
+	static void GenerateSampledAnimationTask(void* animations, size_t index)
+	{
+		FCDSceneNodeSampledAnimation& animation = ((FCDSceneNodeSampledAnimation*) animations)[index];
+		GenerateSampledAnimation(animation.sceneNode, animation.keys, animation.matrices);
+	}
+
+	void GenerateSampledAnimations(FCDSceneNode* sceneNode, FCDSceneNodeSampledAnimationList& animations)
+	{
+		animations.clear();
+
+		// List the animated scene nodes.
+		for (FCDSceneNodeIterator it(sceneNode, FCDSceneNodeIterator::BREADTH_FIRST, true); !it.IsDone(); ++it)
+		{
+			FCDSceneNode* node = *it;
+			size_t transformCount = node->GetTransformCount();
+			for (size_t t = 0; t < transformCount; ++t)
+			{
+				const FCDAnimated* animated = node->GetTransform(t)->GetAnimated();
+				if (animated != nullptr && animated->HasCurve())
+				{
+					animations.push_back(FCDSceneNodeSampledAnimation());
+					animations.back().sceneNode = node;
+					break;
+				}
+			}
+		}
+		if (animations.empty()) return;
+
+		// Each scene node only modifies its own transforms: sample them in parallel.
+		size_t threadCount = min(animations.size(), FUThreadPool::GetProcessorCount());
+		if (threadCount <= 1)
+		{
+			for (size_t i = 0; i < animations.size(); ++i) GenerateSampledAnimationTask(animations.begin(), i);
+		}
+		else
+		{
+			FUThreadPool pool(threadCount);
+			pool.Run(GenerateSampledAnimationTask, animations.begin(), animations.size());
+		}
+	}
+
+	// The number of scene nodes per task when updating the world transforms.
+	static const size_t worldTransformTaskSize = 256;
+
+	struct WorldTransformLevel
+	{
+		FCDSceneNode** nodes;
+		size_t nodeCount;
+	};
+
+	static void UpdateWorldTransformsTask(void* userData, size_t index)
+	{
+		WorldTransformLevel* level = (WorldTransformLevel*) userData;
+		size_t end = min(level->nodeCount, (index + 1) * worldTransformTaskSize);
+		for (size_t i = index * worldTransformTaskSize; i < end; ++i)
+		{
+			// The world transform of the parent is up-to-date: only this node is updated.
+			level->nodes[i]->CalculateWorldTransform();
+		}
+	}
+
+	size_t UpdateWorldTransforms(FCDSceneNode* sceneNode)
+	{
+		if (sceneNode == nullptr) return 0;
+
+		// List the scene nodes, level by level.
+		fm::pvector<FCDSceneNode> nodes;
+		fm::vector<size_t, true> levelEnds;
+		nodes.push_back(sceneNode);
+		for (size_t start = 0; start < nodes.size();)
+		{
+			size_t end = nodes.size();
+			levelEnds.push_back(end);
+			for (size_t n = start; n < end; ++n)
+			{
+				FCDSceneNode* node = nodes[n];
+				size_t childCount = node->GetChildrenCount();
+				for (size_t c = 0; c < childCount; ++c)
+				{
+					FCDSceneNode* child = node->GetChild(c);
+					if (child->GetParent() != node) continue;
+					if (nodes.size() == nodes.capacity()) nodes.reserve(2 * nodes.size());
+					nodes.push_back(child);
+				}
+			}
+			start = end;
+		}
+
+		// The root may have parents of its own: update it first, on this thread.
+		sceneNode->CalculateWorldTransform();
+		size_t threadCount = min(nodes.size() / worldTransformTaskSize, FUThreadPool::GetProcessorCount());
+		FUThreadPool* pool = (threadCount > 1) ? new FUThreadPool(threadCount) : nullptr;
+		for (size_t l = 1; l < levelEnds.size(); ++l)
+		{
+			WorldTransformLevel level = { nodes.begin() + levelEnds[l - 1], levelEnds[l] - levelEnds[l - 1] };
+			size_t taskCount = (level.nodeCount + worldTransformTaskSize - 1) / worldTransformTaskSize;
+			if (pool != nullptr && taskCount > 1) pool->Run(UpdateWorldTransformsTask, &level, taskCount);
+			else for (size_t t = 0; t < taskCount; ++t) UpdateWorldTransformsTask(&level, t);
+		}
+		SAFE_DELETE(pool);
+		return nodes.size();
+	}
+
 	const FloatList& GetSampledAnimationKeys()
 	{
 		return sampleKeys;
@@ -156,4 +290,3 @@ namespace FCDSceneNodeTools
 		sampleValues.clear();
 	}
 };
-
@@ -16,6 +16,16 @@
 
 class FCDSceneNode;
 
+/** The sampled animation of the local transform of a scene node. */
+struct FCDSceneNodeSampledAnimation
+{
+	FCDSceneNode* sceneNode; /**< The animated scene node. */
+	FloatList keys; /**< The sample times, in increasing order. */
+	FMMatrix44List matrices; /**< The local transforms of the scene node at each sample time. */
+};
+
+typedef fm::vector<FCDSceneNodeSampledAnimation> FCDSceneNodeSampledAnimationList; /**< A dynamically-sized array of sampled scene node animations. */
+
 /** A set of tools that operates or modifies visual scene nodes. */
 namespace FCDSceneNodeTools
 {
@@ -29,9 +39,40 @@ namespace FCDSceneNodeTools
 		or retrieve the resulting animation curve. Finally, optionally
 		call ClearSampledAnimation in order to free up the internal memory buffers.
 		Every call to GenerateSampledAnimation start by calling ClearSampledAnimation.
+		This function is not reentrant: prefer the overload that fills in
+		caller-owned lists.
 		@param sceneNode The scene node. */
 	FCOLLADA_EXPORT void GenerateSampledAnimation(FCDSceneNode* sceneNode);
 
+	/** Generate a list of matrices, with corresponding key times that
+		represent an animation curve for the local transform of a scene node.
+		This function will <b>permanently</b> modify the transforms of this visual scene node.
+		Different scene nodes may be sampled on different threads at once.
+		@param sceneNode The scene node.
+		@param keys The list to fill in with the sample times. It is cleared first.
+		@param matrices The list to fill in with the local transforms of the
+			scene node at each sample time. It is cleared first. */
+	FCOLLADA_EXPORT void GenerateSampledAnimation(FCDSceneNode* sceneNode, FloatList& keys, FMMatrix44List& matrices);
+
+	/** Generates the sampled animations of all the animated scene nodes of a visual scene.
+		The scene nodes are sampled in parallel, on a pool of worker threads.
+		This function will <b>permanently</b> modify the transforms of the sampled scene nodes.
+		The instanced scene nodes are sampled through their first parent only.
+		@param sceneNode The root scene node of the visual scene.
+		@param animations The list to fill in with one sampled animation per
+			animated scene node. It is cleared first. */
+	FCOLLADA_EXPORT void GenerateSampledAnimations(FCDSceneNode* sceneNode, FCDSceneNodeSampledAnimationList& animations);
+
+	/** Updates the cached world transforms of a scene node and of all its descendants.
+		The scene nodes are processed one level of the hierarchy at a time: the
+		scene nodes of a level are updated in parallel, on a pool of worker threads.
+		The instanced scene nodes are updated through their first parent only.
+		Afterwards, FCDSceneNode::CalculateWorldTransform returns without any computation,
+		until transforms change.
+		@param sceneNode The root scene node.
+		@return The number of updated scene nodes. */
+	FCOLLADA_EXPORT size_t UpdateWorldTransforms(FCDSceneNode* sceneNode);
+
 	/** Retrieves the generated sampled animation curve's keys.
 		@see GenerateSampledAnimation.
 		@return The generated sampled animation curve's keys. */
@@ -0,0 +1,357 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#include "StdAfx.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDController.h"
+#include "FCDocument/FCDControllerInstance.h"
+#include "FCDocument/FCDGeometry.h"
+#include "FCDocument/FCDGeometryMesh.h"
+#include "FCDocument/FCDGeometryPolygons.h"
+#include "FCDocument/FCDGeometryPolygonsInput.h"
+#include "FCDocument/FCDGeometrySource.h"
+#include "FCDocument/FCDSceneNode.h"
+#include "FCDocument/FCDSkinController.h"
+#include "FCDocument/FCDSkinDeformer.h"
+#include "FUtils/FUThreadPool.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FCD_SKIN_DEFORMER_SSE
+#include <xmmintrin.h>
+#endif // SSE
+
+// The number of positions or normals given to a worker thread at once.
+static const size_t vertexChunkSize = 4096;
+
+// The worker threads are shared by all the skin deformers.
+static FUThreadPool* skinningPool = nullptr;
+static FUCriticalSection skinningPoolCriticalSection;
+
+static FUThreadPool* GetSkinningPool()
+{
+	skinningPoolCriticalSection.Enter();
+	if (skinningPool == nullptr) skinningPool = new FUThreadPool();
+	FUThreadPool* pool = skinningPool;
+	skinningPoolCriticalSection.Leave();
+	return pool;
+}
+
+#ifdef FCD_SKIN_DEFORMER_SSE
+static inline void StoreVector3(float* out, __m128 v)
+{
+	_mm_storel_pi((__m64*) out, v);
+	_mm_store_ss(out + 2, _mm_movehl_ps(v, v));
+}
+#endif // FCD_SKIN_DEFORMER_SSE
+
+//
+// FCDSkinDeformer
+//
+
+FCDSkinDeformer::FCDSkinDeformer()
+:	influenceWidth(0)
+{
+}
+
+FCDSkinDeformer::~FCDSkinDeformer()
+{
+}
+
+void FCDSkinDeformer::ReleaseWorkerThreads()
+{
+	skinningPoolCriticalSection.Enter();
+	SAFE_DELETE(skinningPool);
+	skinningPoolCriticalSection.Leave();
+}
+
+bool FCDSkinDeformer::Compile(const FCDSkinController* skin, size_t maximumInfluenceCount)
+{
+	instanceJoints.clear();
+	influences.clear();
+	bindMatrices.clear();
+	bindPositions.clear();
+	bindNormals.clear();
+	normalVertices.clear();
+	positions.clear();
+	normals.clear();
+	influenceWidth = 0;
+
+	// Retrieve the base mesh and its position and normal sources.
+	if (skin == nullptr) return false;
+	const FCDGeometry* geometry = skin->GetParent()->GetBaseGeometry();
+	const FCDGeometryMesh* mesh = (geometry != nullptr) ? geometry->GetMesh() : nullptr;
+	if (mesh == nullptr) return false;
+	const FCDGeometrySource* positionSource = mesh->FindSourceByType(FUDaeGeometryInput::POSITION);
+	if (positionSource == nullptr || positionSource->GetStride() < 3) return false;
+	size_t vertexCount = positionSource->GetValueCount();
+	FUAssert(skin->GetInfluenceCount() == vertexCount, return false);
+	const FCDGeometrySource* normalSource = mesh->FindSourceByType(FUDaeGeometryInput::NORMAL);
+	if (normalSource != nullptr && normalSource->GetStride() < 3) normalSource = nullptr;
+
+	// The bind matrices of the joints, followed by the bind-shape transform.
+	size_t jointCount = skin->GetJointCount();
+	const FMMatrix44& bindShapeTransform = skin->GetBindShapeTransform();
+	bindMatrices.reserve(jointCount + 1);
+	for (size_t j = 0; j < jointCount; ++j)
+	{
+		bindMatrices.push_back(skin->GetJoint(j)->GetBindPoseInverse() * bindShapeTransform);
+	}
+	bindMatrices.push_back(bindShapeTransform);
+	uint32 bindShapeMatrix = (uint32) jointCount;
+
+	// Repack the influences into a fixed number of joint-weight pairs per vertex.
+	const FCDSkinControllerVertex* vertices = skin->GetVertexInfluences();
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		influenceWidth = max(influenceWidth, vertices[v].GetPairCount());
+	}
+	if (maximumInfluenceCount > 0) influenceWidth = min(influenceWidth, maximumInfluenceCount);
+	influenceWidth = max(influenceWidth, (size_t) 1);
+
+	// One more vertex, transformed by the bind-shape transform only, for the unused normals.
+	Influence padding = { bindShapeMatrix, 0.0f };
+	influences.resize((vertexCount + 1) * influenceWidth, padding);
+	fm::vector<FCDJointWeightPair, true> pairs;
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		Influence* out = influences.begin() + v * influenceWidth;
+		size_t pairCount = vertices[v].GetPairCount();
+		if (pairCount == 0)
+		{
+			out->weight = 1.0f;
+			continue;
+		}
+
+		// Keep the strongest influences and scale their weights back to their former total.
+		pairs.clear();
+		float totalWeight = 0.0f;
+		for (size_t p = 0; p < pairCount; ++p)
+		{
+			const FCDJointWeightPair* pair = vertices[v].GetPair(p);
+			pairs.push_back(*pair);
+			totalWeight += pair->weight;
+		}
+		float scale = 1.0f;
+		if (pairCount > influenceWidth)
+		{
+			float keptWeight = 0.0f;
+			for (size_t p = 0; p < influenceWidth; ++p)
+			{
+				size_t strongest = p;
+				for (size_t q = p + 1; q < pairCount; ++q)
+				{
+					if (pairs[q].weight > pairs[strongest].weight) strongest = q;
+				}
+				FCDJointWeightPair swapped = pairs[p];
+				pairs[p] = pairs[strongest];
+				pairs[strongest] = swapped;
+				keptWeight += pairs[p].weight;
+			}
+			if (keptWeight > 0.0f) scale = totalWeight / keptWeight;
+			pairCount = influenceWidth;
+		}
+		for (size_t p = 0; p < pairCount; ++p)
+		{
+			int32 jointIndex = pairs[p].jointIndex;
+			out[p].matrix = (jointIndex >= 0 && (size_t) jointIndex < jointCount) ? (uint32) jointIndex : bindShapeMatrix;
+			out[p].weight = pairs[p].weight * scale;
+		}
+	}
+	influences[vertexCount * influenceWidth].weight = 1.0f;
+
+	// Copy the bind positions and normals.
+	uint32 positionStride = positionSource->GetStride();
+	const float* positionData = positionSource->GetData();
+	bindPositions.reserve(3 * vertexCount);
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		bindPositions.push_back(positionData[v * positionStride]);
+		bindPositions.push_back(positionData[v * positionStride + 1]);
+		bindPositions.push_back(positionData[v * positionStride + 2]);
+	}
+	positions.resize(bindPositions.size());
+	if (normalSource != nullptr)
+	{
+		size_t normalCount = normalSource->GetValueCount();
+		uint32 normalStride = normalSource->GetStride();
+		const float* normalData = normalSource->GetData();
+		bindNormals.reserve(3 * normalCount);
+		for (size_t n = 0; n < normalCount; ++n)
+		{
+			bindNormals.push_back(normalData[n * normalStride]);
+			bindNormals.push_back(normalData[n * normalStride + 1]);
+			bindNormals.push_back(normalData[n * normalStride + 2]);
+		}
+		normals.resize(bindNormals.size());
+
+		// Each normal uses the influences of the first position it is used with.
+		normalVertices.resize(normalCount, (uint32) vertexCount);
+		size_t polygonsCount = mesh->GetPolygonsCount();
+		for (size_t p = 0; p < polygonsCount; ++p)
+		{
+			const FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
+			const FCDGeometryPolygonsInput* positionInput = polygons->FindInput(positionSource);
+			const FCDGeometryPolygonsInput* normalInput = polygons->FindInput(normalSource);
+			if (positionInput == nullptr || normalInput == nullptr) continue;
+			size_t indexCount = min(positionInput->GetIndexCount(), normalInput->GetIndexCount());
+			const uint32* positionIndices = positionInput->GetIndices();
+			const uint32* normalIndices = normalInput->GetIndices();
+			for (size_t i = 0; i < indexCount; ++i)
+			{
+				uint32 n = normalIndices[i], v = positionIndices[i];
+				if (n < normalCount && v < vertexCount && normalVertices[n] == vertexCount) normalVertices[n] = v;
+			}
+		}
+	}
+	return true;
+}
+
+bool FCDSkinDeformer::Compile(const FCDControllerInstance* instance, size_t maximumInfluenceCount)
+{
+	if (instance == nullptr) return false;
+	const FCDEntity* entity = instance->GetEntity();
+	const FCDSkinController* skin = nullptr;
+	while (entity != nullptr && entity->GetType() == FCDEntity::CONTROLLER && skin == nullptr)
+	{
+		const FCDController* controller = (const FCDController*) entity;
+		if (controller->IsSkin()) skin = controller->GetSkinController();
+		else entity = controller->GetBaseTarget();
+	}
+	if (!Compile(skin, maximumInfluenceCount)) return false;
+
+	size_t jointCount = instance->GetJointCount();
+	if (jointCount != skin->GetJointCount()) return false;
+	instanceJoints.reserve(jointCount);
+	for (size_t j = 0; j < jointCount; ++j) instanceJoints.push_back(instance->GetJoint(j));
+	return true;
+}
+
+bool FCDSkinDeformer::Deform(const FMMatrix44* jointWorldTransforms, size_t jointTransformCount)
+{
+	if (bindMatrices.empty()) return false;
+	size_t jointCount = bindMatrices.size() - 1;
+	FUAssert(jointTransformCount == jointCount, return false);
+
+	// The skinning matrices take the bind-shape positions to the world.
+	skinningMatrices.resize(bindMatrices.size());
+	MultiplyMatrices(jointWorldTransforms, bindMatrices.begin(), jointCount, skinningMatrices.begin());
+	skinningMatrices.back() = bindMatrices.back();
+
+	size_t positionChunkCount = GetPositionChunkCount();
+	size_t chunkCount = positionChunkCount + GetNormalChunkCount();
+	if (chunkCount > 1 && FCollada::GetParallelAnimationFlag())
+	{
+		GetSkinningPool()->Run(DeformChunkTask, this, chunkCount);
+	}
+	else
+	{
+		for (size_t i = 0; i < positionChunkCount; ++i) DeformPositions(i);
+		for (size_t i = positionChunkCount; i < chunkCount; ++i) DeformNormals(i - positionChunkCount);
+	}
+	return true;
+}
+
+bool FCDSkinDeformer::Deform()
+{
+	if (bindMatrices.empty() || instanceJoints.size() != bindMatrices.size() - 1) return false;
+	jointTransforms.resize(instanceJoints.size());
+	for (size_t j = 0; j < instanceJoints.size(); ++j)
+	{
+		jointTransforms[j] = instanceJoints[j]->CalculateWorldTransform();
+	}
+	return Deform(jointTransforms.begin(), jointTransforms.size());
+}
+
+size_t FCDSkinDeformer::GetPositionChunkCount() const
+{
+	return (GetVertexCount() + vertexChunkSize - 1) / vertexChunkSize;
+}
+
+size_t FCDSkinDeformer::GetNormalChunkCount() const
+{
+	return (GetNormalCount() + vertexChunkSize - 1) / vertexChunkSize;
+}
+
+void FCDSkinDeformer::DeformPositions(size_t chunk)
+{
+	size_t start = chunk * vertexChunkSize;
+	size_t end = min(GetVertexCount(), start + vertexChunkSize);
+	const FMMatrix44* matrices = skinningMatrices.begin();
+	const Influence* influence = influences.begin() + start * influenceWidth;
+	const float* in = bindPositions.begin() + 3 * start;
+	float* out = positions.begin() + 3 * start;
+	for (size_t v = start; v < end; ++v, in += 3, out += 3)
+	{
+#ifdef FCD_SKIN_DEFORMER_SSE
+		__m128 x = _mm_set1_ps(in[0]), y = _mm_set1_ps(in[1]), z = _mm_set1_ps(in[2]);
+		__m128 sum = _mm_setzero_ps();
+		for (size_t i = 0; i < influenceWidth; ++i, ++influence)
+		{
+			const FMMatrix44& m = matrices[influence->matrix];
+			__m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(m[0]), x), _mm_mul_ps(_mm_loadu_ps(m[1]), y)),
+				_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(m[2]), z), _mm_loadu_ps(m[3])));
+			sum = _mm_add_ps(sum, _mm_mul_ps(p, _mm_set1_ps(influence->weight)));
+		}
+		StoreVector3(out, sum);
+#else
+		FMVector3 position(in[0], in[1], in[2]), sum = FMVector3::Zero;
+		for (size_t i = 0; i < influenceWidth; ++i, ++influence)
+		{
+			sum += matrices[influence->matrix].TransformCoordinate(position) * influence->weight;
+		}
+		out[0] = sum.m_X; out[1] = sum.m_Y; out[2] = sum.m_Z;
+#endif // FCD_SKIN_DEFORMER_SSE
+	}
+}
+
+void FCDSkinDeformer::DeformNormals(size_t chunk)
+{
+	size_t start = chunk * vertexChunkSize;
+	size_t end = min(GetNormalCount(), start + vertexChunkSize);
+	const FMMatrix44* matrices = skinningMatrices.begin();
+	const float* in = bindNormals.begin() + 3 * start;
+	float* out = normals.begin() + 3 * start;
+	for (size_t n = start; n < end; ++n, in += 3, out += 3)
+	{
+		const Influence* influence = influences.begin() + normalVertices[n] * influenceWidth;
+#ifdef FCD_SKIN_DEFORMER_SSE
+		__m128 x = _mm_set1_ps(in[0]), y = _mm_set1_ps(in[1]), z = _mm_set1_ps(in[2]);
+		__m128 sum = _mm_setzero_ps();
+		for (size_t i = 0; i < influenceWidth; ++i, ++influence)
+		{
+			const FMMatrix44& m = matrices[influence->matrix];
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(m[0]), x), _mm_mul_ps(_mm_loadu_ps(m[1]), y)), _mm_mul_ps(_mm_loadu_ps(m[2]), z));
+			sum = _mm_add_ps(sum, _mm_mul_ps(d, _mm_set1_ps(influence->weight)));
+		}
+
+		// Normalize the three first components.
+		__m128 squares = _mm_mul_ps(sum, sum);
+		__m128 length = _mm_sqrt_ss(_mm_add_ss(_mm_add_ss(squares, _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(1, 1, 1, 1))),
+			_mm_movehl_ps(squares, squares)));
+		if (_mm_cvtss_f32(length) > 0.0f) sum = _mm_div_ps(sum, _mm_shuffle_ps(length, length, 0));
+		StoreVector3(out, sum);
+#else
+		FMVector3 normal(in[0], in[1], in[2]), sum = FMVector3::Zero;
+		for (size_t i = 0; i < influenceWidth; ++i, ++influence)
+		{
+			sum += matrices[influence->matrix].TransformVector(normal) * influence->weight;
+		}
+		float length = sum.Length();
+		if (length > 0.0f) sum /= length;
+		out[0] = sum.m_X; out[1] = sum.m_Y; out[2] = sum.m_Z;
+#endif // FCD_SKIN_DEFORMER_SSE
+	}
+}
+
+void FCDSkinDeformer::DeformChunkTask(void* deformer, size_t chunk)
+{
+	FCDSkinDeformer* d = (FCDSkinDeformer*) deformer;
+	size_t positionChunkCount = d->GetPositionChunkCount();
+	if (chunk < positionChunkCount) d->DeformPositions(chunk);
+	else d->DeformNormals(chunk - positionChunkCount);
+}
@@ -0,0 +1,136 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/**
+	@file FCDSkinDeformer.h
+	This file contains the FCDSkinDeformer class.
+*/
+
+#ifndef _FCD_SKIN_DEFORMER_H_
+#define _FCD_SKIN_DEFORMER_H_
+
+class FCDControllerInstance;
+class FCDSceneNode;
+class FCDSkinController;
+
+/**
+	A compiled skin controller, which deforms the positions and the normals
+	of its base mesh on the CPU.
+
+	The vertex influences of the skin controller are repacked once, on
+	compilation, into a fixed number of joint-weight pairs per vertex.
+	For each deformation, the skinning matrix of each joint is calculated
+	from its world transform, its inverse bind-pose and the bind-shape
+	transform. Each position is then transformed by the skinning matrices
+	of its influences and blended with their weights. The normals use the
+	influences of the first position they are used with in the polygons
+	and are normalized after blending.
+
+	The influences with the special joint index -1 use the bind-shape transform.
+	The vertices without influences are only transformed by the bind-shape transform.
+
+	The vertices are cut into chunks which, when the global parallel
+	animation flag is set, are deformed on a pool of worker threads.
+
+	@see FCollada::SetParallelAnimationFlag
+	@ingroup FCDocument
+*/
+class FCOLLADA_EXPORT FCDSkinDeformer
+{
+private:
+	struct Influence
+	{
+		uint32 matrix;
+		float weight;
+	};
+	typedef fm::vector<Influence, true> InfluenceList;
+
+	fm::pvector<const FCDSceneNode> instanceJoints;
+	size_t influenceWidth;
+	InfluenceList influences;
+	FMMatrix44List bindMatrices;
+	FMMatrix44List skinningMatrices;
+	FMMatrix44List jointTransforms;
+	FloatList bindPositions;
+	FloatList bindNormals;
+	UInt32List normalVertices;
+	FloatList positions;
+	FloatList normals;
+
+public:
+	/** Constructor.
+		The deformer is empty until it is compiled. */
+	FCDSkinDeformer();
+
+	/** Destructor. */
+	~FCDSkinDeformer();
+
+	/** Compiles a skin controller.
+		The base mesh of the skin controller must have a position source
+		with one value per vertex influence.
+		@param skin The skin controller.
+		@param maximumInfluenceCount The maximum number of influences per vertex.
+			The strongest influences are kept and their weights are scaled back
+			to their former total. When zero, all the influences are kept.
+		@return Whether the skin controller was compiled. */
+	bool Compile(const FCDSkinController* skin, size_t maximumInfluenceCount = 0);
+
+	/** Compiles the skin controller of a controller instance and remembers
+		its joints, for the deformations with the current world transforms.
+		@param instance The controller instance.
+		@param maximumInfluenceCount The maximum number of influences per vertex.
+			When zero, all the influences are kept.
+		@return Whether the skin controller was compiled and the controller
+			instance has one joint per skin controller joint. */
+	bool Compile(const FCDControllerInstance* instance, size_t maximumInfluenceCount = 0);
+
+	/** Deforms the base mesh with the given joint world transforms.
+		@param jointWorldTransforms The world transform of each joint of the skin controller.
+		@param jointTransformCount The number of joint world transforms.
+			This number should be the number of joints of the skin controller.
+		@return Whether the base mesh was deformed. */
+	bool Deform(const FMMatrix44* jointWorldTransforms, size_t jointTransformCount);
+
+	/** Deforms the base mesh with the current world transforms
+		of the joints of the compiled controller instance.
+		@return Whether the base mesh was deformed. */
+	bool Deform();
+
+	/** Retrieves the number of vertices of the base mesh.
+		@return The number of vertices. */
+	inline size_t GetVertexCount() const { return bindPositions.size() / 3; }
+
+	/** Retrieves the number of joint-weight pairs stored for each vertex.
+		@return The number of influences per vertex. */
+	inline size_t GetInfluenceWidth() const { return influenceWidth; }
+
+	/** Retrieves the deformed positions.
+		@return The deformed positions, three floating-point values per vertex. */
+	inline const float* GetPositions() const { return positions.begin(); }
+
+	/** Retrieves the number of normals of the base mesh.
+		@return The number of normals. */
+	inline size_t GetNormalCount() const { return bindNormals.size() / 3; }
+
+	/** Retrieves the deformed normals.
+		@return The deformed normals, three floating-point values per normal. */
+	inline const float* GetNormals() const { return normals.begin(); }
+
+	/** [INTERNAL] Releases the worker threads shared by the skin deformers.
+		Called when the FCollada library is released. */
+	static void ReleaseWorkerThreads();
+
+private:
+	size_t GetPositionChunkCount() const;
+	size_t GetNormalChunkCount() const;
+	void DeformPositions(size_t chunk);
+	void DeformNormals(size_t chunk);
+	static void DeformChunkTask(void* deformer, size_t chunk);
+};
+
+#endif // _FCD_SKIN_DEFORMER_H_
@@ -33,6 +33,7 @@ FCDTransform::FCDTransform(FCDocument* document, FCDSceneNode* _parent)
 
 FCDTransform::~FCDTransform()
 {
+	if (parent != nullptr) parent->InvalidateTransforms();
 	parent = nullptr;
 }
 
@@ -51,7 +52,7 @@ void FCDTransform::SetValueChange()
 {
 	SetValueChangedFlag();
 	// parent == nullptr is a valid value in ColladaPhysics.
-	if (parent != nullptr) parent->SetTransformsDirtyFlag();
+	if (parent != nullptr) parent->InvalidateTransforms();
 }
 
 //
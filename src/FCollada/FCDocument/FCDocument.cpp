@@ -19,6 +19,7 @@
 #include "FCDocument/FCDAnimationChannel.h"
 #include "FCDocument/FCDAnimationClip.h"
 #include "FCDocument/FCDAnimationCurve.h"
+#include "FCDocument/FCDAnimationProgram.h"
 #include "FCDocument/FCDAsset.h"
 #include "FCDocument/FCDCamera.h"
 #include "FCDocument/FCDController.h"
@@ -52,6 +53,11 @@
 
 ImplementObjectType(FCDocument);
 
+// The animation revisions are unique across the documents, so that an animation
+// program never mistakes a new document for a released one at the same address.
+static uint32 animationRevisionCounter = 0;
+static FUCriticalSection animationRevisionCriticalSection;
+
 ImplementParameterObject(FCDocument, FCDEntityReference, visualSceneRoot, new FCDEntityReference(parent->GetDocument(), nullptr));
 ImplementParameterObject(FCDocument, FCDEntityReference, physicsSceneRoots, new FCDEntityReference(parent->GetDocument(), nullptr));
 ImplementParameterObject(FCDocument, FCDAsset, asset, new FCDAsset(parent->GetDocument()));
@@ -97,8 +103,11 @@ FCDocument::FCDocument()
 ,	InitializeParameterNoArg(physicsSceneLibrary)
 ,	InitializeParameterNoArg(visualSceneLibrary)
 ,	InitializeParameterNoArg(emitterLibrary)
+,	animationRevision(0), animationProgram(nullptr)
+,	arena(nullptr)
 {
 	DEBUG_OUT("In ctor");
+	UpdateAnimationRevision();
 	fileManager = new FUFileManager();
 	version = new FCDVersion(DAE_SCHEMA_VERSION);
 	uniqueNameMap = new FUSUniqueStringMap();
@@ -131,6 +140,13 @@ FCDocument::~FCDocument()
 	// before all clearing the entities.
 	FUTrackable::Detach();
 	DEBUG_OUT("In dtor");
+
+	// The objects that come from the arena are released through the cache of this thread.
+	// The arena is freed once all these objects are released.
+	fm::Arena* documentArena = arena;
+	arena = nullptr;
+	fm::ArenaScope arenaScope(documentArena);
+	SAFE_DELETE(animationProgram);
 	externalReferenceManager = nullptr;
 
 	// Release the libraries and the asset
@@ -159,6 +175,17 @@ FCDocument::~FCDocument()
 	SAFE_DELETE(fileManager);
 	SAFE_DELETE(uniqueNameMap);
 	SAFE_DELETE(version);
+	fm::ReleaseArena(documentArena);
+}
+
+void FCDocument::SetArenaAllocation(bool useArena)
+{
+	if (useArena && arena == nullptr) arena = fm::CreateArena();
+	else if (!useArena && arena != nullptr)
+	{
+		fm::ReleaseArena(arena);
+		arena = nullptr;
+	}
 }
 
 const FCDSceneNode* FCDocument::GetVisualSceneInstance() const
@@ -224,30 +251,99 @@ FCDPhysicsModel* FCDocument::FindPhysicsModel(const fm::string& daeId) { return
 const FCDSceneNode* FCDocument::FindSceneNode(const char* daeId) const { return visualSceneLibrary->FindDaeId(daeId); }
 FCDEntity* FCDocument::FindEntity(const fm::string& daeId)
 {
-#define CHECK_LIB(libraryName) { \
-	FCDEntity* e = libraryName->FindDaeId(daeId); \
-	if (e != nullptr) return e; }
-
-	CHECK_LIB(animationLibrary);
-	CHECK_LIB(animationClipLibrary);
-	CHECK_LIB(cameraLibrary);
-	CHECK_LIB(controllerLibrary);
-	CHECK_LIB(effectLibrary);
-	CHECK_LIB(emitterLibrary);
-	CHECK_LIB(forceFieldLibrary);
-	CHECK_LIB(geometryLibrary);
-	CHECK_LIB(imageLibrary);
-	CHECK_LIB(lightLibrary);
-	CHECK_LIB(materialLibrary);
-	CHECK_LIB(visualSceneLibrary);
-	CHECK_LIB(physicsSceneLibrary);
-	CHECK_LIB(physicsMaterialLibrary);
-	CHECK_LIB(physicsModelLibrary);
-#undef CHECK_LIB
+	FCDObjectWithId* object = FindDaeId(daeId);
+	if (object == nullptr) return nullptr;
+
+	// Only the entities held by the libraries are considered.
+#define CHECK_TYPE(className) \
+	if (object->GetObjectType() == className::GetClassType()) return (className*) object;
+
+	CHECK_TYPE(FCDAnimation);
+	CHECK_TYPE(FCDAnimationClip);
+	CHECK_TYPE(FCDCamera);
+	CHECK_TYPE(FCDController);
+	CHECK_TYPE(FCDEffect);
+	CHECK_TYPE(FCDEmitter);
+	CHECK_TYPE(FCDForceField);
+	CHECK_TYPE(FCDGeometry);
+	CHECK_TYPE(FCDImage);
+	CHECK_TYPE(FCDLight);
+	CHECK_TYPE(FCDMaterial);
+	CHECK_TYPE(FCDSceneNode);
+	CHECK_TYPE(FCDPhysicsScene);
+	CHECK_TYPE(FCDPhysicsMaterial);
+	CHECK_TYPE(FCDPhysicsModel);
+#undef CHECK_TYPE
 
 	return nullptr;
 }
 
+// Registers the unique id of an object, for the look-ups.
+void FCDocument::RegisterDaeId(FCDObjectWithId* object, fm::string& daeId)
+{
+	registrationCriticalSection.Enter();
+	uniqueNameMap->insert(daeId);
+	objectsWithId.insert(daeId, object);
+	pendingEntities.erase(object);
+	registrationCriticalSection.Leave();
+}
+
+// Unregisters the unique id of an object.
+void FCDocument::UnregisterDaeId(FCDObjectWithId* object, const fm::string& daeId)
+{
+	registrationCriticalSection.Enter();
+	uniqueNameMap->erase(daeId);
+	FCDObjectWithIdMap::iterator it = objectsWithId.find(daeId);
+	if (it != objectsWithId.end() && it->second == object) objectsWithId.erase(it);
+
+	// Within the destructors, the object type is no longer the entity type.
+	if (object->HasType(FCDEntity::GetClassType())) pendingEntities.insert(object, object);
+	registrationCriticalSection.Leave();
+}
+
+void FCDocument::RegisterPendingEntity(FCDEntity* entity)
+{
+	registrationCriticalSection.Enter();
+	pendingEntities.insert(entity, entity);
+	registrationCriticalSection.Leave();
+}
+
+void FCDocument::UnregisterPendingEntity(FCDEntity* entity)
+{
+	registrationCriticalSection.Enter();
+	pendingEntities.erase(entity);
+	registrationCriticalSection.Leave();
+}
+
+// Search for an object of any type with a given COLLADA id.
+const FCDObjectWithId* FCDocument::FindDaeId(const fm::string& daeId) const
+{
+	FCDocument* document = const_cast<FCDocument*>(this);
+
+	// Make the ids of the pending entities unique: this registers them.
+	// The pending entities may be registered on other threads: copy them within the lock.
+	fm::pvector<FCDObjectWithId> pending;
+	document->registrationCriticalSection.Enter();
+	if (!pendingEntities.empty())
+	{
+		pending.reserve(pendingEntities.size());
+		for (FCDObjectWithIdSet::const_iterator it = pendingEntities.begin(); it != pendingEntities.end(); ++it) pending.push_back(it->first);
+	}
+	document->registrationCriticalSection.Leave();
+	for (fm::pvector<FCDObjectWithId>::iterator it = pending.begin(); it != pending.end(); ++it) (*it)->GetDaeId();
+
+	document->registrationCriticalSection.Enter();
+	FCDObjectWithIdMap::const_iterator it = objectsWithId.find(daeId);
+	const FCDObjectWithId* object = (it != objectsWithId.end()) ? it->second : nullptr;
+	document->registrationCriticalSection.Leave();
+	return object;
+}
+
+FCDObjectWithId* FCDocument::FindDaeId(const fm::string& daeId)
+{
+	return const_cast<FCDObjectWithId*>(const_cast<const FCDocument*>(this)->FindDaeId(daeId));
+}
+
 // Add an animated value to the list
 void FCDocument::RegisterAnimatedValue(FCDAnimated* animated)
 {
@@ -260,7 +356,10 @@ void FCDocument::RegisterAnimatedValue(FCDAnimated* animated)
 	}
 
 	// List the new animated value
+	registrationCriticalSection.Enter();
 	animatedValues.insert(animated, animated);
+	registrationCriticalSection.Leave();
+	UpdateAnimationRevision();
 
 	//// Also add to the map the individual values for easy retrieval
 	//size_t count = animated->GetValueCount();
@@ -279,6 +378,7 @@ void FCDocument::UnregisterAnimatedValue(FCDAnimated* animated)
 		// Intentionally search from the end:
 		// - In the destructor of the document, we delete from the end.
 		// - In animation exporters, we add to the end and are likely to delete right away.
+		registrationCriticalSection.Enter();
 		FCDAnimatedSet::iterator it = animatedValues.find(animated);
 		if (it != animatedValues.end())
 		{
@@ -296,8 +396,28 @@ void FCDocument::UnregisterAnimatedValue(FCDAnimated* animated)
 			//	}
 			//}
 		}
+		registrationCriticalSection.Leave();
+		UpdateAnimationRevision();
 	}
 }
+
+// Lists an extra tree within the document
+void FCDocument::RegisterExtraTree(FCDExtra* tree)
+{
+	registrationCriticalSection.Enter();
+	extraTrees.insert(tree, tree);
+	registrationCriticalSection.Leave();
+}
+
+// Removes an extra tree from the document's list
+void FCDocument::UnregisterExtraTree(FCDExtra* tree)
+{
+	registrationCriticalSection.Enter();
+	FCDExtraSet::iterator it = extraTrees.find(tree);
+	FUAssert(it != extraTrees.end(),);
+	if (it != extraTrees.end()) extraTrees.erase(it);
+	registrationCriticalSection.Leave();
+}
 //
 //// Retrieve an animated value, given a value pointer
 //const FCDAnimated* FCDocument::FindAnimatedValue(const float* ptr) const
@@ -359,18 +479,16 @@ void FCDocument::SetFileUrl(const fstring& filename)
 
 void FCDocument::SetCurrentTime(float time)
 {
-	for (FCDAnimatedSet::iterator itA = animatedValues.begin(); itA != animatedValues.end(); ++itA)
-	{
-		FCDAnimated* animated = (*itA).first;
-		animated->Evaluate(time);
-	}
+	// The animation program evaluates our child documents as well.
+	if (animationProgram == nullptr) animationProgram = new FCDAnimationProgram(this);
+	animationProgram->Evaluate(time);
+}
 
-	// We must evaluate all our child documents as well!
-	for (size_t i = 0; i < externalReferenceManager->GetPlaceHolderCount(); i++)
-	{
-		FCDPlaceHolder* placeHolder = externalReferenceManager->GetPlaceHolder(i);
-		if (placeHolder->IsTargetLoaded()) placeHolder->GetTarget()->SetCurrentTime(time);
-	}
+void FCDocument::UpdateAnimationRevision()
+{
+	animationRevisionCriticalSection.Enter();
+	animationRevision = ++animationRevisionCounter;
+	animationRevisionCriticalSection.Leave();
 }
 
 // More linker-tricking for DLL support.
@@ -26,6 +26,9 @@
 #ifndef _FU_PARAMETER_H_
 #include "FUtils/FUParameter.h"
 #endif // _FU_PARAMETER_H_
+#ifndef _FM_HASH_MAP_H_
+#include "FMath/FMHashMap.h"
+#endif // _FM_HASH_MAP_H_
 
 #if defined(WIN32)
 template <class T> class FCOLLADA_EXPORT FCDLibrary; /**< Trick Doxygen. */
@@ -39,6 +42,7 @@ class FCDAnimated;
 class FCDAnimation;
 class FCDAnimationChannel;
 class FCDAnimationClip;
+class FCDAnimationProgram;
 class FCDAsset;
 class FCDCamera;
 class FCDController;
@@ -54,6 +58,7 @@ class FCDImage;
 class FCDLight;
 class FCDMaterial;
 class FCDObject;
+class FCDObjectWithId;
 class FCDPhysicsMaterial;
 class FCDPhysicsModel;
 class FCDPhysicsScene;
@@ -92,6 +97,8 @@ typedef FCDLibrary<FCDPhysicsMaterial> FCDPhysicsMaterialLibrary; /**< A COLLADA
 typedef	FCDLibrary<FCDPhysicsScene> FCDPhysicsSceneLibrary; /**< A COLLADA library of physics scene nodes. */
 typedef FUUniqueStringMapT<char> FUSUniqueStringMap; /**< A set of unique strings. */
 typedef fm::map<FCDExtra*, FCDExtra*> FCDExtraSet; /**< A set of extra trees. */
+typedef fm::hash_map<fm::string, FCDObjectWithId*> FCDObjectWithIdMap; /**< A map of the objects with unique ids, by id. */
+typedef fm::hash_map<FCDObjectWithId*, FCDObjectWithId*> FCDObjectWithIdSet; /**< A set of objects with ids. */
 
 /** @defgroup FCDocument COLLADA Document Object Model. */
 
@@ -118,6 +125,9 @@ private:
 	FCDExtraSet extraTrees;
 
 	FUSUniqueStringMap* uniqueNameMap;
+	FCDObjectWithIdMap objectsWithId; // The objects with unique ids, for the look-ups.
+	FCDObjectWithIdSet pendingEntities; // The entities whose ids are not yet unique.
+	FUCriticalSection registrationCriticalSection;
 	DeclareParameterRef(FCDEntityReference, visualSceneRoot, FC("Root Visual Scene"));
 	DeclareParameterContainer(FCDEntityReference, physicsSceneRoots, FC("Root Physics Scenes"));
 
@@ -149,6 +159,11 @@ private:
 	// Animated values
 	typedef fm::map<FCDAnimated*, FCDAnimated*> FCDAnimatedSet;
 	FCDAnimatedSet animatedValues;
+	uint32 animationRevision;
+	FCDAnimationProgram* animationProgram;
+	friend class FCDAnimationProgram;
+
+	fm::Arena* arena;
 
 public:
 	/** Construct a new COLLADA document. */
@@ -179,6 +194,24 @@ public:
 	inline FUFileManager* GetFileManager() { return fileManager; }
 	inline const FUFileManager* GetFileManager() const { return fileManager; } /**< See above. */
 
+	/** Sets whether the objects loaded into this COLLADA document come from a document arena.
+		The small objects, lists and trees created while the document is loaded are then
+		allocated from the size-class pools of the arena, and the memory of the arena is
+		freed at once when the document and all these objects are released.
+		Set this flag before loading the document. The objects created by the worker
+		threads and outside of the loading functions come from the heap.
+		@see fm::Arena
+		@param useArena Whether the loaded objects come from a document arena. */
+	void SetArenaAllocation(bool useArena);
+
+	/** Retrieves whether the objects loaded into this COLLADA document come from a document arena.
+		@return Whether the document has an arena. */
+	inline bool HasArenaAllocation() const { return arena != nullptr; }
+
+	/** [INTERNAL] Retrieves the arena of the COLLADA document.
+		@return The document arena. This pointer is nullptr when the arena allocation is disabled. */
+	inline fm::Arena* GetArena() { return arena; }
+
 	/** Retrieves the currently instanced visual scene.
 		NOTE: GetVisualSceneRoot is deprecated. Please start using GetVisualSceneInstance.
 		@return The currently instanced visual scene. */
@@ -225,6 +258,43 @@ public:
 	inline FUSUniqueStringMap* GetUniqueNameMap() { return uniqueNameMap; }
 	inline const FUSUniqueStringMap* GetUniqueNameMap() const { return uniqueNameMap; } /**< See above. */
 
+	/** [INTERNAL] Registers the unique id of an object with the document.
+		The id is made unique and the object is then found by the FindDaeId function.
+		@param object The object with an id.
+		@param daeId The id of the object. This reference is directly
+			modified to hold the unique id. */
+	void RegisterDaeId(FCDObjectWithId* object, fm::string& daeId);
+
+	/** [INTERNAL] Unregisters the unique id of an object from the document.
+		An entity is kept as pending, until its id is made unique again.
+		@param object The object with an id.
+		@param daeId The unique id of the object. */
+	void UnregisterDaeId(FCDObjectWithId* object, const fm::string& daeId);
+
+	/** [INTERNAL] Registers an entity whose id is not yet unique.
+		The id of the pending entities is made unique before the
+		look-ups, so that these entities are also found.
+		@param entity The new entity. */
+	void RegisterPendingEntity(FCDEntity* entity);
+
+	/** [INTERNAL] Unregisters a pending entity, before it is released.
+		@param entity The entity to release. */
+	void UnregisterPendingEntity(FCDEntity* entity);
+
+	/** Retrieves the object, of any type, that has the given COLLADA id.
+		The look-up uses the document map of unique ids and
+		takes constant time.
+		@param daeId A valid COLLADA id.
+		@return The object. This pointer will be nullptr if no object has this id. */
+	FCDObjectWithId* FindDaeId(const fm::string& daeId);
+	const FCDObjectWithId* FindDaeId(const fm::string& daeId) const; /**< See above. */
+
+	/** [INTERNAL] Retrieves the critical section that protects the document-wide registrations:
+		the map of unique ids, the animated values and the extra trees.
+		The entities of a document may be imported on several threads at once.
+		@return The registration critical section. */
+	inline FUCriticalSection& GetRegistrationCriticalSection() { return registrationCriticalSection; }
+
 	/** Retrieves the external reference manager.
 		@return The external reference manager. */
 	inline FCDExternalReferenceManager* GetExternalReferenceManager() { return externalReferenceManager; }
@@ -259,9 +329,13 @@ public:
 		@param time The document end time. */
 	inline void SetEndTime(float time) { endTime = time; hasEndTime = true; }
 
-	/** Evaluate the animation objects at the given time
+	/** Evaluate the animation objects at the given time.
+		The animated values of this document and of its loaded external documents
+		are evaluated through an animation program, which is compiled on the first
+		call and again whenever the animated values change.
+		@see FCDAnimationProgram
 		@param time The time to evaluate the objects at */
-	inline void SetCurrentTime(float time);
+	void SetCurrentTime(float time);
 
 	/** Retrieves the list of entity layers.
 		@return The list of entity layers. */
@@ -426,7 +500,7 @@ public:
 	FCDEffect* FindEffect(const fm::string& daeId);
 
 	/** Retrieves the entity that matches the given COLLADA id.
-		This function will look through all the libraries for any entity
+		This function will look for an entity of any of the libraries
 		with the given COLLADA id.
 		@param daeId A valid COLLADA id.
 		@return The entity. This pointer will be nullptr if no matching entity was found. */
@@ -506,15 +580,24 @@ public:
 		@param animated The animated value to un-list from the document. */
 	void UnregisterAnimatedValue(FCDAnimated* animated);
 
+	/** [INTERNAL] Retrieves the revision of the animated values of the document.
+		The revisions are unique across all the documents.
+		@return The animation revision. */
+	inline uint32 GetAnimationRevision() const { return animationRevision; }
+
+	/** [INTERNAL] Signals that an animated value of the document or its curves changed.
+		The animation programs that evaluate this document are then compiled again. */
+	void UpdateAnimationRevision();
+
 	/** [INTERNAL] Registers an extra tree with the document.
 		All extra trees are listed within the document to support extra-technique plug-ins.
 		@param tree The new extra tree to list within the document. */
-	inline void RegisterExtraTree(FCDExtra* tree) { extraTrees.insert(tree, tree); }
+	void RegisterExtraTree(FCDExtra* tree);
 
 	/** [INTERNAL] Unregisters an extra tree of the document.
 		All extra trees are listed within the document to support extra-technique plug-ins.
 		@param tree The extra tree to un-list from the document. */
-	inline void UnregisterExtraTree(FCDExtra* tree) { FUAssert(extraTrees.find(tree) != extraTrees.end(), return); extraTrees.erase(tree); }
+	void UnregisterExtraTree(FCDExtra* tree);
 
 	/** [INTERNAL] Retrieves the set of extra trees.
 		This function is meant only to be used for supporting the extra-technique plug-ins.
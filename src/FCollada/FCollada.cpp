@@ -8,6 +8,9 @@
 
 #include "StdAfx.h"
 #include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDAnimationProgram.h"
+#include "FCDocument/FCDMorphDeformer.h"
+#include "FCDocument/FCDSkinDeformer.h"
 #include "FCDocument/FCDExternalReferenceManager.h"
 #include "FCDocument/FCDPlaceHolder.h"
 #include "FUtils/FUTestBed.h"
@@ -26,13 +29,39 @@ extern "C"
 //	FCOLLADA_EXPORT
 #endif // WIN32
 	FUPlugin* CreatePlugin(uint32);
+
+	extern
+#ifdef WIN32
+	__declspec(dllexport)
+#endif // WIN32
+	uint32 GetPluginCount();
 }
 
 namespace FCollada
 {
+	// The list of top documents. Documents may be created, loaded and released
+	// on different threads, so all the accesses to this list are serialized.
+	class FCTopDocumentList : public FUTrackedList<FCDocument>
+	{
+	public:
+		FUCriticalSection criticalSection;
+
+	protected:
+		virtual void OnObjectReleased(FUTrackable* object)
+		{
+			criticalSection.Enter();
+			FUTrackedList<FCDocument>::OnObjectReleased(object);
+			criticalSection.Leave();
+		}
+	};
+
 	static size_t libraryInitializationCount = 0;
-	static FUTrackedList<FCDocument> topDocuments;
+	static FCTopDocumentList topDocuments;
 	static bool dereferenceFlag = true;
+	static bool streamingImportFlag = false;
+	static bool streamingExportFlag = false;
+	static bool parallelImportFlag = false;
+	static bool parallelAnimationFlag = false;
 	FColladaPluginManager* pluginManager = nullptr; // Externed in FCDExtra.cpp.
 	CancelLoadingCallback cancelLoadingCallback = nullptr;
 
@@ -45,7 +74,8 @@ namespace FCollada
 		if (pluginManager == nullptr)
 		{
 			pluginManager = new FColladaPluginManager();
-			pluginManager->RegisterPlugin(CreatePlugin(0));
+			uint32 pluginCount = GetPluginCount();
+			for (uint32 i = 0; i < pluginCount; ++i) pluginManager->RegisterPlugin(CreatePlugin(i));
 		}
 		++libraryInitializationCount;
 	}
@@ -61,6 +91,10 @@ namespace FCollada
 
 			FUAssert(topDocuments.empty(),);
 			while (!topDocuments.empty()) topDocuments.back()->Release();
+
+			FCDAnimationProgram::ReleaseWorkerThreads();
+			FCDMorphDeformer::ReleaseWorkerThreads();
+			FCDSkinDeformer::ReleaseWorkerThreads();
 		}
 		return libraryInitializationCount;
 	}
@@ -70,7 +104,9 @@ namespace FCollada
 		// Just add the top documents to the above tracker: this will add one global tracker and the
 		// document will not be released automatically by the document placeholders.
 		FCDocument* document = new FCDocument();
+		topDocuments.criticalSection.Enter();
 		topDocuments.push_back(document);
+		topDocuments.criticalSection.Leave();
 		return document;
 	}
 
@@ -79,15 +115,39 @@ namespace FCollada
 		return new FCDocument;
 	}
 
-	FCOLLADA_EXPORT size_t GetTopDocumentCount() { return topDocuments.size(); }
-	FCOLLADA_EXPORT FCDocument* GetTopDocument(size_t index) { FUAssert(index < topDocuments.size(), return nullptr); return topDocuments.at(index); }
-	FCOLLADA_EXPORT bool IsTopDocument(FCDocument* document) { return topDocuments.contains(document); }
+	FCOLLADA_EXPORT size_t GetTopDocumentCount()
+	{
+		topDocuments.criticalSection.Enter();
+		size_t count = topDocuments.size();
+		topDocuments.criticalSection.Leave();
+		return count;
+	}
+
+	FCOLLADA_EXPORT FCDocument* GetTopDocument(size_t index)
+	{
+		topDocuments.criticalSection.Enter();
+		FCDocument* document = (index < topDocuments.size()) ? topDocuments.at(index) : nullptr;
+		topDocuments.criticalSection.Leave();
+		FUAssert(document != nullptr, return nullptr);
+		return document;
+	}
+
+	FCOLLADA_EXPORT bool IsTopDocument(FCDocument* document)
+	{
+		topDocuments.criticalSection.Enter();
+		bool isTopDocument = topDocuments.contains(document);
+		topDocuments.criticalSection.Leave();
+		return isTopDocument;
+	}
 
 	FCOLLADA_EXPORT void GetAllDocuments(FCDocumentList& documents)
 	{
 		documents.clear();
+		topDocuments.criticalSection.Enter();
 		documents.insert(documents.end(), topDocuments.begin(), topDocuments.end());
-		for (size_t index = 0; index < topDocuments.size(); ++index)
+		topDocuments.criticalSection.Leave();
+		size_t topDocumentCount = documents.size();
+		for (size_t index = 0; index < topDocumentCount; ++index)
 		{
 			FCDocument* document = documents[index];
 			
@@ -117,6 +177,7 @@ namespace FCollada
 	FCOLLADA_EXPORT bool LoadDocumentFromFile(FCDocument* document, const fchar* filename)
 	{
 		FUAssert(pluginManager != nullptr, return false);
+		fm::ArenaScope arenaScope((document != nullptr) ? document->GetArena() : nullptr);
 		return pluginManager->LoadDocumentFromFile(document, filename);
 	}
 
@@ -131,6 +192,7 @@ namespace FCollada
 	FCOLLADA_EXPORT bool LoadDocumentFromMemory(const fchar* filename, FCDocument* document, void* data, size_t length)
 	{
 		FUAssert(pluginManager != nullptr, return false);
+		fm::ArenaScope arenaScope((document != nullptr) ? document->GetArena() : nullptr);
 		return pluginManager->LoadDocumentFromMemory(filename, document, data, length);
 	}
 
@@ -150,6 +212,46 @@ namespace FCollada
 		dereferenceFlag = flag;
 	}
 
+	FCOLLADA_EXPORT bool GetStreamingImportFlag()
+	{
+		return streamingImportFlag;
+	}
+
+	FCOLLADA_EXPORT void SetStreamingImportFlag(bool flag)
+	{
+		streamingImportFlag = flag;
+	}
+
+	FCOLLADA_EXPORT bool GetStreamingExportFlag()
+	{
+		return streamingExportFlag;
+	}
+
+	FCOLLADA_EXPORT void SetStreamingExportFlag(bool flag)
+	{
+		streamingExportFlag = flag;
+	}
+
+	FCOLLADA_EXPORT bool GetParallelImportFlag()
+	{
+		return parallelImportFlag;
+	}
+
+	FCOLLADA_EXPORT void SetParallelImportFlag(bool flag)
+	{
+		parallelImportFlag = flag;
+	}
+
+	FCOLLADA_EXPORT bool GetParallelAnimationFlag()
+	{
+		return parallelAnimationFlag;
+	}
+
+	FCOLLADA_EXPORT void SetParallelAnimationFlag(bool flag)
+	{
+		parallelAnimationFlag = flag;
+	}
+
 	FCOLLADA_EXPORT bool RegisterPlugin(FUPlugin* plugin)
 	{
 		// This function is deprecated.
@@ -170,7 +272,7 @@ namespace FCollada
 };
 
 #ifndef RETAIL
-extern FUTestSuite* _testFMArray,* _testFMTree, * _testFMQuaternion;
+extern FUTestSuite* _testFMAllocator, * _testFMArray,* _testFMTree, * _testFMHashMap, * _testFMQuaternion, * _testFMMatrix44;
 extern FUTestSuite* _testFUObject, * _testFUCrc32, * _testFUFunctor;
 extern FUTestSuite* _testFUEvent, * _testFUString, * _testFUFileManager;
 extern FUTestSuite* _testFUBoundingTest;
@@ -180,9 +282,12 @@ namespace FCollada
 	FCOLLADA_EXPORT void RunTests(FUTestBed& testBed)
 	{
 		// FMath tests
+		testBed.RunTestSuite(::_testFMAllocator);
 		testBed.RunTestSuite(::_testFMArray);
 		testBed.RunTestSuite(::_testFMTree);
+		testBed.RunTestSuite(::_testFMHashMap);
 		testBed.RunTestSuite(::_testFMQuaternion);
+		testBed.RunTestSuite(::_testFMMatrix44);
 
 		// FUtils tests
 		testBed.RunTestSuite(::_testFUObject);
@@ -140,6 +140,8 @@ namespace FCollada
 	FCOLLADA_EXPORT void GetAllDocuments(FCDocumentList& documents);
 
 	/** Load document.
+		Different documents may be loaded at the same time on different threads,
+		as long as they do not reference each other.
 		@param filename the string of the file to load from
 		@return the loaded FCDocument. nullptr is returned if any error occurs. */
 	FCOLLADA_EXPORT bool LoadDocumentFromFile(FCDocument* document, const fchar* filename);
@@ -174,6 +176,63 @@ namespace FCollada
 		@param flag Whether to automatically dereference the entity instances. */
 	FCOLLADA_EXPORT void SetDereferenceFlag(bool flag);
 
+	/** Retrieves the global streaming import flag.
+		Setting this flag will force the XML archive plug-in to read the
+		COLLADA documents one element at a time, rather than parsing the whole
+		XML tree before importing it. This lowers the peak memory used while
+		loading large documents, at the cost of reading the file twice.
+		The default behavior is to parse the whole XML tree.
+		@return Whether to stream the XML data when importing documents. */
+	FCOLLADA_EXPORT bool GetStreamingImportFlag();
+
+	/** Sets the global streaming import flag.
+		See GetStreamingImportFlag for more information.
+		@param flag Whether to stream the XML data when importing documents. */
+	FCOLLADA_EXPORT void SetStreamingImportFlag(bool flag);
+
+	/** Retrieves the global streaming export flag.
+		Setting this flag will force the XML archive plug-in to write out
+		the COLLADA documents one library entity at a time, rather than building
+		the whole XML tree before writing it. This lowers the peak memory used while
+		saving large documents. The written documents are identical.
+		The default behavior is to build the whole XML tree.
+		@return Whether to stream the XML data when exporting documents. */
+	FCOLLADA_EXPORT bool GetStreamingExportFlag();
+
+	/** Sets the global streaming export flag.
+		See GetStreamingExportFlag for more information.
+		@param flag Whether to stream the XML data when exporting documents. */
+	FCOLLADA_EXPORT void SetStreamingExportFlag(bool flag);
+
+	/** Retrieves the global parallel import flag.
+		Setting this flag will force the XML archive plug-in to load the entities
+		of the image, effect, geometry and animation libraries on a pool of
+		worker threads. The entities are then linked together on the calling thread.
+		The libraries read one element at a time, when the XML data is streamed,
+		are always loaded on the calling thread.
+		The default behavior is to load all the entities on the calling thread.
+		@return Whether to load the library entities in parallel. */
+	FCOLLADA_EXPORT bool GetParallelImportFlag();
+
+	/** Sets the global parallel import flag.
+		See GetParallelImportFlag for more information.
+		@param flag Whether to load the library entities in parallel. */
+	FCOLLADA_EXPORT void SetParallelImportFlag(bool flag);
+
+	/** Retrieves the global parallel animation flag.
+		Setting this flag will force the animation programs to evaluate
+		their curves on a pool of worker threads, when calling
+		FCDocument::SetCurrentTime. The animated objects are still
+		notified of their new values on the calling thread.
+		The default behavior is to evaluate all the curves on the calling thread.
+		@return Whether to evaluate the animation curves in parallel. */
+	FCOLLADA_EXPORT bool GetParallelAnimationFlag();
+
+	/** Sets the global parallel animation flag.
+		See GetParallelAnimationFlag for more information.
+		@param flag Whether to evaluate the animation curves in parallel. */
+	FCOLLADA_EXPORT void SetParallelAnimationFlag(bool flag);
+
 	/**	Registers a new FUPlugin plug-in to the FColladaPluginManager.
 		@deprecated Use GetPluginManager()->AddPlugin() instead.
 		@param plugin The new plugin to register. */
@@ -17,6 +17,64 @@
 #include "FCDocument/FCDLibrary.h"
 #include "FCDocument/FCDSceneNode.h"
 #include "FCDocument/FCDSceneNodeTools.h"
+#include "FCDocument/FCDTransform.h"
+#include "FUtils/FUFile.h"
+
+namespace FCTestAnimation
+{
+	// Writes out a node animated by nested animations: each channel targets
+	// one qualified value of a transform, and the scale is driven by the translation.
+	static bool WriteLinkedAnimationDocument(const fchar* filename)
+	{
+		static const char* curveSource = "<technique_common><accessor source=\"#%s-array\" count=\"2\"><param type=\"float\"/></accessor></technique_common></source>\n";
+		static const char* channels[][4] = {
+			// { id, output values, target, driver }
+			{ "translate-x", "2 4", "box/translate.X", nullptr },
+			{ "rotate-z", "0 90", "box/rotateZ.ANGLE", nullptr },
+			{ "scale-y", "1 3", "box/scale.Y", "box/translate(0)" },
+			{ "translate-z", "5 6", "box/translate.Z", nullptr } };
+		static const size_t channelCount = sizeof(channels) / sizeof(*channels);
+
+		FUSStringBuilder builder("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			"<COLLADA xmlns=\"http://www.collada.org/2005/11/COLLADASchema\" version=\"1.4.1\">\n<library_animations>\n");
+		for (size_t i = 0; i < channelCount; ++i)
+		{
+			// The first animation holds the second one, which holds the third one.
+			// The last animation is a separate entity, targeting the same transform as the first one.
+			fm::string id = channels[i][0];
+			if (i == channelCount - 1) builder.append("</animation></animation></animation>\n");
+			builder.append("<animation id=\""); builder.append(id); builder.append("\">\n");
+			const char* inputs = (channels[i][3] != nullptr) ? "0 10" : "0 1";
+			const char* sourceValues[2] = { inputs, channels[i][1] };
+			const char* sourceSuffixes[2] = { "-input", "-output" };
+			for (size_t s = 0; s < 2; ++s)
+			{
+				fm::string sourceId = id + sourceSuffixes[s];
+				builder.append("<source id=\""); builder.append(sourceId); builder.append("\"><float_array id=\"");
+				builder.append(sourceId); builder.append("-array\" count=\"2\">"); builder.append(sourceValues[s]);
+				builder.append("</float_array>");
+				char accessor[256]; snprintf(accessor, sizeof(accessor), curveSource, sourceId.c_str());
+				builder.append(accessor);
+			}
+			builder.append("<sampler id=\""); builder.append(id); builder.append("-sampler\">");
+			builder.append("<input semantic=\"INPUT\" source=\"#"); builder.append(id); builder.append("-input\"/>");
+			builder.append("<input semantic=\"OUTPUT\" source=\"#"); builder.append(id); builder.append("-output\"/>");
+			if (channels[i][3] != nullptr)
+			{
+				builder.append("<input semantic=\"DRIVER\" source=\"#"); builder.append(channels[i][3]); builder.append("\"/>");
+			}
+			builder.append("</sampler>\n<channel source=\"#"); builder.append(id); builder.append("-sampler\" target=\"");
+			builder.append(channels[i][2]); builder.append("\"/>\n");
+		}
+		builder.append("</animation>\n</library_animations>\n<library_visual_scenes><visual_scene id=\"scene\">"
+			"<node id=\"box\"><translate sid=\"translate\">0 0 0</translate><rotate sid=\"rotateZ\">0 0 1 0</rotate>"
+			"<scale sid=\"scale\">1 1 1</scale></node></visual_scene></library_visual_scenes>\n"
+			"<scene><instance_visual_scene url=\"#scene\"/></scene>\n</COLLADA>\n");
+
+		FUFile file(filename, FUFile::WRITE);
+		return file.IsOpen() && file.Write(builder.ToCharPtr(), builder.length());
+	}
+};
 
 TESTSUITE_START(FCDAnimation)
 
@@ -37,8 +95,29 @@ TESTSUITE_TEST(0, Sampling)
 	const FMMatrix44List& values = FCDSceneNodeTools::GetSampledAnimationMatrices();
 	FailIf(keys.size() > 30);
 	PassIf(keys.size() == values.size());
+
+	// The reentrant and the parallel sampling must give the same animations.
+	FloatList nodeKeys;
+	FMMatrix44List nodeValues;
+	FCDSceneNodeTools::GenerateSampledAnimation(node, nodeKeys, nodeValues);
+	PassIf(nodeKeys == keys);
+	PassIf(nodeValues.size() == values.size());
 	FCDSceneNodeTools::ClearSampledAnimation();
 
+	FCDSceneNodeSampledAnimationList animations;
+	FCDSceneNodeTools::GenerateSampledAnimations(document->GetVisualSceneLibrary()->GetEntity(0), animations);
+	PassIf(animations.size() > 1);
+	bool hasBone = false;
+	for (size_t i = 0; i < animations.size(); ++i)
+	{
+		FCDSceneNodeTools::GenerateSampledAnimation(animations[i].sceneNode, nodeKeys, nodeValues);
+		PassIf(animations[i].keys == nodeKeys);
+		PassIf(animations[i].matrices.size() == nodeValues.size());
+		for (size_t k = 0; k < nodeValues.size(); ++k) PassIf(animations[i].matrices[k] == nodeValues[k]);
+		hasBone |= animations[i].sceneNode == node;
+	}
+	PassIf(hasBone);
+
 TESTSUITE_TEST(1, CurveMerging)
 	// Test the merge of single curves into multiple curves.
 	FUObjectRef<FCDocument> document = FCollada::NewTopDocument();
@@ -107,4 +186,266 @@ TESTSUITE_TEST(1, CurveMerging)
 	SAFE_RELEASE(c2);
 	SAFE_RELEASE(multiCurve);
 
+TESTSUITE_TEST(2, ChannelLinking)
+	// Links the animated values and the drivers to the channels of nested animations.
+	FUErrorSimpleHandler errorHandler;
+	PassIf(FCTestAnimation::WriteLinkedAnimationDocument(FC("LinkedAnimationOut.dae")));
+	FUObjectRef<FCDocument> document = FCollada::NewTopDocument();
+	PassIf(FCollada::LoadDocumentFromFile(document, FC("LinkedAnimationOut.dae")));
+	PassIf(errorHandler.IsSuccessful());
+	PassIf(document->GetAnimationLibrary()->GetEntityCount() == 2);
+
+	FCDSceneNode* node = document->FindSceneNode("box");
+	FailIf(node == nullptr);
+	PassIf(node->GetTransformCount() == 3);
+	FCDAnimated* translation = node->GetTransform(0)->GetAnimated();
+	FCDAnimated* rotation = node->GetTransform(1)->GetAnimated();
+	FCDAnimated* scale = node->GetTransform(2)->GetAnimated();
+	FailIf(translation == nullptr || rotation == nullptr || scale == nullptr);
+
+	// Each curve is linked to the value of its target qualifier only.
+	FCDAnimationCurve* translateX = translation->FindCurve(".X");
+	FCDAnimationCurve* translateZ = translation->FindCurve(".Z");
+	FCDAnimationCurve* rotateAngle = rotation->FindCurve(".ANGLE");
+	FCDAnimationCurve* scaleY = scale->FindCurve(".Y");
+	FailIf(translateX == nullptr || translateZ == nullptr || rotateAngle == nullptr || scaleY == nullptr);
+	PassIf(translation->FindCurve(".Y") == nullptr);
+	PassIf(rotation->FindCurve(".Z") == nullptr);
+	PassIf(scale->FindCurve(".X") == nullptr && scale->FindCurve(".Z") == nullptr);
+	PassIf(IsEquivalent(translateX->GetKey(1)->output, 4.0f));
+	PassIf(IsEquivalent(translateZ->GetKey(1)->output, 6.0f));
+	PassIf(IsEquivalent(rotateAngle->GetKey(1)->output, 90.0f));
+	PassIf(IsEquivalent(scaleY->GetKey(1)->output, 3.0f));
+
+	// The curves come from the nested animations and from the separate animation entity.
+	PassIf(translateX->GetParent()->GetParent()->GetDaeId() == "translate-x");
+	PassIf(rotateAngle->GetParent()->GetParent()->GetDaeId() == "rotate-z");
+	PassIf(scaleY->GetParent()->GetParent()->GetDaeId() == "scale-y");
+	PassIf(translateZ->GetParent()->GetParent()->GetDaeId() == "translate-z");
+
+	// The scale is driven by the first value of the translation.
+	PassIf(scaleY->HasDriver());
+	PassIf(scaleY->GetDriverPtr() == translation);
+	PassIf(scaleY->GetDriverIndex() == 0);
+	PassIf(!translateX->HasDriver() && !rotateAngle->HasDriver());
+
+TESTSUITE_TEST(3, KeyStorage)
+	// The curve keys are allocated in blocks: check the evaluation and the key edits on them.
+	FUObjectRef<FCDocument> document = FCollada::NewTopDocument();
+	FCDAnimation* animation = document->GetAnimationLibrary()->AddEntity();
+	FCDAnimationCurve* curve = animation->AddChannel()->AddCurve();
+	static const size_t keyCount = 100;
+	curve->ReserveKeys(keyCount, FUDaeInterpolation::LINEAR);
+	for (size_t i = 0; i < keyCount; ++i)
+	{
+		FCDAnimationKey* key = curve->AddKey(FUDaeInterpolation::LINEAR);
+		key->input = (float) i;
+		key->output = 2.0f * (float) i;
+	}
+	PassIf(curve->GetKeyCount() == keyCount);
+	PassIf(IsEquivalent(curve->Evaluate(0.0f), 0.0f));
+	PassIf(IsEquivalent(curve->Evaluate(37.5f), 75.0f));
+	PassIf(IsEquivalent(curve->Evaluate(98.25f), 196.5f));
+	PassIf(IsEquivalent(curve->Evaluate(200.0f), 198.0f));
+
+	// Insert a Bezier key in the middle: the key order and the evaluation must follow.
+	size_t index = 0;
+	FCDAnimationKeyBezier* bkey = (FCDAnimationKeyBezier*) curve->AddKey(FUDaeInterpolation::BEZIER, 37.5f, index);
+	FailIf(bkey == nullptr);
+	bkey->output = 10.0f;
+	bkey->inTangent = FMVector2(37.25f, 10.0f);
+	bkey->outTangent = FMVector2(37.75f, 10.0f);
+	PassIf(index == 38);
+	PassIf(curve->GetKey(index) == bkey);
+	PassIf(IsEquivalent(curve->Evaluate(37.5f), 10.0f));
+	PassIf(IsEquivalent(curve->Evaluate(12.5f), 25.0f));
+	PassIf(IsEquivalent(curve->Evaluate(80.5f), 161.0f));
+
+	// Delete keys and re-use their storage.
+	PassIf(curve->DeleteKey(bkey));
+	PassIf(!curve->DeleteKey(bkey));
+	PassIf(curve->DeleteKey(curve->GetKey(10)));
+	PassIf(curve->GetKeyCount() == keyCount - 1);
+	PassIf(IsEquivalent(curve->Evaluate(10.0f), 20.0f));
+	FCDAnimationKey* key = curve->AddKey(FUDaeInterpolation::LINEAR, 10.0f, index);
+	key->output = 0.0f;
+	PassIf(index == 10);
+	PassIf(IsEquivalent(curve->Evaluate(10.5f), 11.0f));
+
+	// Clone the curve and shrink the original.
+	FCDAnimationCurve* clone = curve->Clone(nullptr, false);
+	curve->SetKeyCount(50, FUDaeInterpolation::LINEAR);
+	PassIf(curve->GetKeyCount() == 50);
+	PassIf(IsEquivalent(curve->Evaluate(49.5f), 98.0f));
+	PassIf(clone->GetKeyCount() == keyCount);
+	PassIf(IsEquivalent(clone->Evaluate(10.5f), 11.0f));
+	PassIf(IsEquivalent(clone->Evaluate(98.25f), 196.5f));
+	SAFE_RELEASE(clone);
+
+TESTSUITE_TEST(4, SequentialEvaluation)
+	// The cursor and the batch evaluations must give the same values as the single evaluations.
+	FUObjectRef<FCDocument> document = FCollada::NewTopDocument();
+	FCDAnimation* animation = document->GetAnimationLibrary()->AddEntity();
+	FCDAnimationChannel* channel = animation->AddChannel();
+	static const size_t keyCount = 20;
+	static const size_t dimension = 5;
+	FCDAnimationCurveList curves;
+	for (size_t d = 0; d < dimension; ++d)
+	{
+		FCDAnimationCurve* curve = channel->AddCurve();
+		for (size_t i = 0; i < keyCount; ++i)
+		{
+			FCDAnimationKeyBezier* key = (FCDAnimationKeyBezier*) curve->AddKey(FUDaeInterpolation::BEZIER);
+			key->input = (float) i;
+			key->output = (float) ((i * 7) % 5);
+			key->inTangent = FMVector2(key->input - 0.3f, key->output - 1.0f);
+			key->outTangent = FMVector2(key->input + 0.3f, key->output + 1.0f);
+		}
+		curves.push_back(curve);
+	}
+	curves[0]->SetPreInfinity(FUDaeInfinity::CYCLE);
+	curves[0]->SetPostInfinity(FUDaeInfinity::OSCILLATE);
+
+	// Sample before, within and after the curve, then go backwards.
+	static const size_t sampleCount = 200;
+	FloatList inputs;
+	for (size_t i = 0; i < sampleCount; ++i) inputs.push_back(-10.0f + 0.2f * (float) i);
+	inputs.push_back(3.5f);
+	inputs.push_back(0.0f);
+	FloatList outputs(inputs.size(), 0.0f);
+	curves[0]->Evaluate(inputs.begin(), inputs.size(), outputs.begin());
+	FCDAnimationCurveCursor cursor(curves[0]);
+	for (size_t i = 0; i < inputs.size(); ++i)
+	{
+		float expected = curves[0]->Evaluate(inputs[i]);
+		PassIf(outputs[i] == expected);
+		PassIf(cursor.Evaluate(inputs[i]) == expected);
+	}
+
+	// The multi-dimensional curve of identical curves: the vectorized
+	// and the remaining dimensions must give the same values.
+	FloatList defaultValues(dimension, 0.0f);
+	FCDAnimationMultiCurve* multiCurve = FCDAnimationCurveTools::MergeCurves(curves, defaultValues);
+	FailIf(multiCurve == nullptr);
+	FloatList multiOutputs(inputs.size() * dimension, 0.0f);
+	multiCurve->Evaluate(inputs.begin(), inputs.size(), multiOutputs.begin());
+	FCDAnimationMultiCurveCursor multiCursor(multiCurve);
+	float values[dimension];
+	for (size_t i = 0; i < inputs.size(); ++i)
+	{
+		multiCursor.Evaluate(inputs[i], values);
+		for (size_t d = 0; d < dimension; ++d)
+		{
+			PassIf(multiOutputs[i * dimension + d] == multiOutputs[i * dimension]);
+			PassIf(values[d] == multiOutputs[i * dimension + d]);
+		}
+	}
+	for (int twoD = 0; twoD < 2; ++twoD)
+	{
+		multiCurve->Set2DCurveEvaluation(twoD != 0);
+		multiCurve->Evaluate(4.25f, values);
+		for (size_t d = 1; d < dimension; ++d) PassIf(values[d] == values[0]);
+	}
+	SAFE_RELEASE(multiCurve);
+
+TESTSUITE_TEST(5, AnimationProgram)
+	// Enough animated translations for several evaluation chunks.
+	FUObjectRef<FCDocument> document = FCollada::NewTopDocument();
+	FCDSceneNode* visualScene = document->AddVisualScene();
+	FCDAnimation* animation = document->GetAnimationLibrary()->AddEntity();
+	static const size_t nodeCount = 3000;
+	fm::pvector<FCDTTranslation> translations;
+	FCDAnimationCurveList curves;
+	for (size_t i = 0; i < nodeCount; ++i)
+	{
+		FCDTTranslation* translation = (FCDTTranslation*) visualScene->AddChildNode()->AddTransform(FCDTransform::TRANSLATION);
+		FCDAnimationCurve* curve = animation->AddChannel()->AddCurve();
+		for (size_t k = 0; k < 4; ++k)
+		{
+			FCDAnimationKey* key = curve->AddKey(FUDaeInterpolation::LINEAR);
+			key->input = (float) k;
+			key->output = (float) ((i + k * 3) % 7);
+		}
+		translation->GetAnimated()->AddCurve(1, curve);
+		translations.push_back(translation);
+		curves.push_back(curve);
+	}
+
+	// The serial and the parallel evaluations must give the values of the curves.
+	for (int parallel = 0; parallel < 2; ++parallel)
+	{
+		FCollada::SetParallelAnimationFlag(parallel != 0);
+		for (float time = -0.5f; time < 4.0f; time += 0.75f)
+		{
+			document->SetCurrentTime(time);
+			for (size_t i = 0; i < nodeCount; ++i)
+			{
+				PassIf(translations[i]->GetTranslation()->m_Y == curves[i]->Evaluate(time));
+				PassIf(translations[i]->GetParent()->GetTransformsDirtyFlag());
+			}
+			visualScene->ResetTransformsDirtyFlag();
+		}
+	}
+	FCollada::SetParallelAnimationFlag(false);
+
+	// The program must follow the new and the released curves.
+	FCDTTranslation* translation = (FCDTTranslation*) visualScene->AddChildNode()->AddTransform(FCDTransform::TRANSLATION);
+	FCDAnimationCurve* curve = animation->AddChannel()->AddCurve();
+	curve->AddKey(FUDaeInterpolation::STEP)->output = 5.0f;
+	translation->GetAnimated()->AddCurve(2, curve);
+	document->SetCurrentTime(1.0f);
+	PassIf(translation->GetTranslation()->m_Z == 5.0f);
+	curve->Release();
+	translation->GetTranslation()->m_Z = 2.0f;
+	document->SetCurrentTime(2.0f);
+	PassIf(translation->GetTranslation()->m_Z == 2.0f);
+	PassIf(translations[0]->GetTranslation()->m_Y == curves[0]->Evaluate(2.0f));
+
+TESTSUITE_TEST(6, KeyReduction)
+	// Baked curves: one key per frame, at 30 frames per second, over two seconds.
+	FUObjectRef<FCDocument> document = FCollada::NewTopDocument();
+	FCDAnimation* animation = document->GetAnimationLibrary()->AddEntity();
+	FCDAnimationCurve* line = animation->AddChannel()->AddCurve();
+	FCDAnimationCurve* wave = animation->AddChannel()->AddCurve();
+	FCDAnimationCurve* steps = animation->AddChannel()->AddCurve();
+	FCDAnimationCurve* childWave = animation->AddChild()->AddChannel()->AddCurve();
+	for (size_t k = 0; k <= 60; ++k)
+	{
+		float input = (float) k / 30.0f;
+		FCDAnimationKey* key = line->AddKey(FUDaeInterpolation::LINEAR);
+		key->input = input;
+		key->output = 2.0f * input - 1.0f;
+		key = wave->AddKey(FUDaeInterpolation::LINEAR);
+		key->input = input;
+		key->output = 10.0f * sinf(3.0f * input);
+		key = childWave->AddKey(FUDaeInterpolation::LINEAR);
+		key->input = input;
+		key->output = 5.0f * cosf(2.0f * input);
+		key = steps->AddKey(FUDaeInterpolation::STEP);
+		key->input = input;
+		key->output = (float) (k % 3);
+	}
+	FCDAnimationCurve* original = wave->Clone();
+
+	// The step curve is left as is, the other curves stay within the tolerance.
+	static const float tolerance = 0.01f;
+	FCDAnimationCurveReduction reduction;
+	PassIf(FCDAnimationCurveTools::ReduceKeys(document->GetAnimationLibrary(), tolerance, reduction) == 3);
+	PassIf(reduction.curveCount == 3);
+	PassIf(reduction.originalKeyCount == 3 * 61);
+	PassIf(reduction.reducedKeyCount == line->GetKeyCount() + wave->GetKeyCount() + childWave->GetKeyCount());
+	PassIf(reduction.GetCompressionRatio() > 2.0f);
+	PassIf(reduction.maximumError <= tolerance * 1.01f);
+	PassIf(line->GetKeyCount() == 2);
+	PassIf(line->GetKey(0)->interpolation == FUDaeInterpolation::LINEAR);
+	PassIf(steps->GetKeyCount() == 61);
+	FailIf(FCDAnimationCurveTools::ReduceKeys(steps, tolerance));
+	PassIf(wave->GetKeyCount() < 30);
+	for (float time = -0.5f; time < 2.5f; time += 0.01f)
+	{
+		PassIf(IsEquivalent(line->Evaluate(time), 2.0f * FMath::Clamp(time, 0.0f, 2.0f) - 1.0f));
+		PassIf(fabsf(wave->Evaluate(time) - original->Evaluate(time)) <= tolerance * 1.01f);
+	}
+	SAFE_RELEASE(original);
+
 TESTSUITE_END
@@ -10,7 +10,172 @@
 #include "FCDocument/FCDocument.h"
 #include "FCDocument/FCDLibrary.h"
 #include "FCDocument/FCDLight.h"
+#include "FCDocument/FCDAnimation.h"
+#include "FCDocument/FCDAnimationChannel.h"
+#include "FCDocument/FCDAnimationCurve.h"
+#include "FCDocument/FCDAnimationKey.h"
+#include "FCDocument/FCDCamera.h"
+#include "FCDocument/FCDController.h"
+#include "FCDocument/FCDEffect.h"
+#include "FCDocument/FCDGeometry.h"
+#include "FCDocument/FCDGeometryMesh.h"
+#include "FCDocument/FCDGeometrySource.h"
+#include "FCDocument/FCDImage.h"
+#include "FCDocument/FCDMaterial.h"
+#include "FCDocument/FCDSceneNode.h"
 #include "FUtils/FUFile.h"
+#include "FUtils/FUThread.h"
+
+namespace FCTestArchiving
+{
+	static const char* szTestName = "FCTestArchiving";
+
+	// One document loaded on a worker thread.
+	struct ConcurrentLoad
+	{
+		const fchar* filename;
+		FCDocument* document;
+		bool status;
+	};
+
+	static void LoadDocumentThread(void* parameter)
+	{
+		ConcurrentLoad* load = (ConcurrentLoad*) parameter;
+		load->status = FCollada::LoadDocumentFromFile(load->document, load->filename);
+	}
+
+	// Writes out a document whose geometries repeat their ids: the first ones
+	// also repeat the ids of their sources, the other ones only their own id.
+	static bool WriteDuplicateIdDocument(const fchar* filename)
+	{
+		static const size_t geometryCount = 16;
+		FUSStringBuilder builder("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			"<COLLADA xmlns=\"http://www.collada.org/2005/11/COLLADASchema\" version=\"1.4.1\">\n<library_geometries>\n");
+		for (size_t i = 0; i < geometryCount; ++i)
+		{
+			FUSStringBuilder sourceIdBuilder("positions-");
+			sourceIdBuilder.append((uint32) i);
+			fm::string sourceId = (i < geometryCount / 2) ? fm::string("shared-positions") : sourceIdBuilder.ToString();
+			builder.append("<geometry id=\"duplicate\"><mesh><source id=\""); builder.append(sourceId);
+			builder.append("\"><float_array id=\""); builder.append(sourceId);
+			builder.append("-array\" count=\"9\">0 0 0 1 0 0 0 1 0</float_array><technique_common><accessor source=\"#");
+			builder.append(sourceId);
+			builder.append("-array\" count=\"3\" stride=\"3\"><param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/>"
+				"<param name=\"Z\" type=\"float\"/></accessor></technique_common></source><vertices id=\"");
+			builder.append(sourceId); builder.append("-vertices\"><input semantic=\"POSITION\" source=\"#"); builder.append(sourceId);
+			builder.append("\"/></vertices><triangles count=\"1\"><input semantic=\"VERTEX\" source=\"#"); builder.append(sourceId);
+			builder.append("-vertices\" offset=\"0\"/><p>0 1 2</p></triangles></mesh></geometry>\n");
+		}
+		builder.append("</library_geometries>\n</COLLADA>\n");
+
+		FUFile file(filename, FUFile::WRITE);
+		return file.IsOpen() && file.Write(builder.ToCharPtr(), builder.length());
+	}
+
+	template <class T>
+	static bool CheckSameEntities(FULogFile& fileOut, FCDLibrary<T>* library1, FCDLibrary<T>* library2)
+	{
+		PassIf(library1->GetEntityCount() == library2->GetEntityCount());
+		for (size_t i = 0; i < library1->GetEntityCount(); ++i)
+		{
+			PassIf(library1->GetEntity(i)->GetDaeId() == library2->GetEntity(i)->GetDaeId());
+			PassIf(library1->GetEntity(i)->GetName() == library2->GetEntity(i)->GetName());
+		}
+		return true;
+	}
+
+	static bool CheckSameAnimation(FULogFile& fileOut, FCDAnimation* animation1, FCDAnimation* animation2)
+	{
+		PassIf(animation1->GetChildrenCount() == animation2->GetChildrenCount());
+		for (size_t i = 0; i < animation1->GetChildrenCount(); ++i)
+		{
+			PassIf(CheckSameAnimation(fileOut, animation1->GetChild(i), animation2->GetChild(i)));
+		}
+		PassIf(animation1->GetChannelCount() == animation2->GetChannelCount());
+		for (size_t i = 0; i < animation1->GetChannelCount(); ++i)
+		{
+			FCDAnimationChannel* channel1 = animation1->GetChannel(i);
+			FCDAnimationChannel* channel2 = animation2->GetChannel(i);
+			PassIf(channel1->GetCurveCount() == channel2->GetCurveCount());
+			for (size_t j = 0; j < channel1->GetCurveCount(); ++j)
+			{
+				FCDAnimationCurve* curve1 = channel1->GetCurve(j);
+				FCDAnimationCurve* curve2 = channel2->GetCurve(j);
+				PassIf(curve1->GetKeyCount() == curve2->GetKeyCount());
+				for (size_t k = 0; k < curve1->GetKeyCount(); ++k)
+				{
+					PassIf(curve1->GetKey(k)->input == curve2->GetKey(k)->input);
+					PassIf(curve1->GetKey(k)->output == curve2->GetKey(k)->output);
+				}
+			}
+		}
+		return true;
+	}
+
+	static bool CheckSameSceneNode(FULogFile& fileOut, FCDSceneNode* node1, FCDSceneNode* node2)
+	{
+		PassIf(node1->GetDaeId() == node2->GetDaeId());
+		PassIf(node1->GetTransformCount() == node2->GetTransformCount());
+		PassIf(node1->GetInstanceCount() == node2->GetInstanceCount());
+		PassIf(node1->GetChildrenCount() == node2->GetChildrenCount());
+		for (size_t i = 0; i < node1->GetChildrenCount(); ++i)
+		{
+			PassIf(CheckSameSceneNode(fileOut, node1->GetChild(i), node2->GetChild(i)));
+		}
+		return true;
+	}
+
+	// Verifies that two loads of the same file hold the same data.
+	static bool CheckSameDocument(FULogFile& fileOut, FCDocument* document1, FCDocument* document2)
+	{
+		PassIf(CheckSameEntities(fileOut, document1->GetAnimationLibrary(), document2->GetAnimationLibrary()));
+		PassIf(CheckSameEntities(fileOut, document1->GetCameraLibrary(), document2->GetCameraLibrary()));
+		PassIf(CheckSameEntities(fileOut, document1->GetControllerLibrary(), document2->GetControllerLibrary()));
+		PassIf(CheckSameEntities(fileOut, document1->GetEffectLibrary(), document2->GetEffectLibrary()));
+		PassIf(CheckSameEntities(fileOut, document1->GetGeometryLibrary(), document2->GetGeometryLibrary()));
+		PassIf(CheckSameEntities(fileOut, document1->GetImageLibrary(), document2->GetImageLibrary()));
+		PassIf(CheckSameEntities(fileOut, document1->GetLightLibrary(), document2->GetLightLibrary()));
+		PassIf(CheckSameEntities(fileOut, document1->GetMaterialLibrary(), document2->GetMaterialLibrary()));
+		PassIf(CheckSameEntities(fileOut, document1->GetVisualSceneLibrary(), document2->GetVisualSceneLibrary()));
+
+		FCDGeometryLibrary* geometries1 = document1->GetGeometryLibrary();
+		FCDGeometryLibrary* geometries2 = document2->GetGeometryLibrary();
+		for (size_t i = 0; i < geometries1->GetEntityCount(); ++i)
+		{
+			PassIf(geometries1->GetEntity(i)->IsMesh() == geometries2->GetEntity(i)->IsMesh());
+			if (!geometries1->GetEntity(i)->IsMesh()) continue;
+			FCDGeometryMesh* mesh1 = geometries1->GetEntity(i)->GetMesh();
+			FCDGeometryMesh* mesh2 = geometries2->GetEntity(i)->GetMesh();
+			PassIf(mesh1->GetPolygonsCount() == mesh2->GetPolygonsCount());
+			PassIf(mesh1->GetSourceCount() == mesh2->GetSourceCount());
+			for (size_t j = 0; j < mesh1->GetSourceCount(); ++j)
+			{
+				FCDGeometrySource* source1 = mesh1->GetSource(j);
+				FCDGeometrySource* source2 = mesh2->GetSource(j);
+				PassIf(source1->GetDaeId() == source2->GetDaeId());
+				PassIf(source1->GetDataCount() == source2->GetDataCount());
+				PassIf(source1->GetDataCount() == 0 || memcmp(source1->GetData(), source2->GetData(), source1->GetDataCount() * sizeof(float)) == 0);
+			}
+		}
+
+		FCDAnimationLibrary* animations1 = document1->GetAnimationLibrary();
+		FCDAnimationLibrary* animations2 = document2->GetAnimationLibrary();
+		for (size_t i = 0; i < animations1->GetEntityCount(); ++i)
+		{
+			PassIf(CheckSameAnimation(fileOut, animations1->GetEntity(i), animations2->GetEntity(i)));
+		}
+
+		FCDVisualSceneNodeLibrary* scenes1 = document1->GetVisualSceneLibrary();
+		FCDVisualSceneNodeLibrary* scenes2 = document2->GetVisualSceneLibrary();
+		for (size_t i = 0; i < scenes1->GetEntityCount(); ++i)
+		{
+			PassIf(CheckSameSceneNode(fileOut, scenes1->GetEntity(i), scenes2->GetEntity(i)));
+		}
+		return true;
+	}
+};
+
+using namespace FCTestArchiving;
 
 TESTSUITE_START(FColladaArchiving)
 
@@ -50,4 +215,165 @@ TESTSUITE_TEST(0, FileArchiving)
 	PassIf(light3->GetLightType() == light->GetLightType());
 	PassIf(IsEquivalent(light->GetIntensity(), light->GetIntensity()));
 
+TESTSUITE_TEST(1, ConcurrentLoading)
+	static const fchar* filenames[] = { FC("Eagle.DAE"), FC("TestSphere.dae") };
+	static const size_t filenameCount = sizeof(filenames) / sizeof(*filenames);
+	static const size_t threadCount = 8;
+	static const size_t roundCount = 4;
+	FUErrorSimpleHandler errorHandler;
+
+	// Load each file serially, to get the reference documents.
+	FUObjectRef<FCDocument> serialDocuments[filenameCount];
+	for (size_t i = 0; i < filenameCount; ++i)
+	{
+		serialDocuments[i] = FCollada::NewTopDocument();
+		PassIf(FCollada::LoadDocumentFromFile(serialDocuments[i], filenames[i]));
+	}
+	PassIf(errorHandler.IsSuccessful());
+
+	// Load the same files on several threads at once, a few times over.
+	for (size_t round = 0; round < roundCount; ++round)
+	{
+		ConcurrentLoad loads[threadCount];
+		FUThread* threads[threadCount];
+		for (size_t i = 0; i < threadCount; ++i)
+		{
+			loads[i].filename = filenames[(i + round) % filenameCount];
+			loads[i].document = FCollada::NewTopDocument();
+			loads[i].status = false;
+		}
+		for (size_t i = 0; i < threadCount; ++i)
+		{
+			threads[i] = FUThread::CreateFUThread(LoadDocumentThread, &loads[i]);
+		}
+		bool threadsCreated = true;
+		for (size_t i = 0; i < threadCount; ++i)
+		{
+			threadsCreated &= threads[i] != nullptr;
+			FUThread::ExitFUThread(threads[i]);
+		}
+		PassIf(threadsCreated);
+
+		// The concurrent loads must match the serial loads.
+		for (size_t i = 0; i < threadCount; ++i)
+		{
+			PassIf(loads[i].status);
+			PassIf(CheckSameDocument(fileOut, serialDocuments[(i + round) % filenameCount], loads[i].document));
+			loads[i].document->Release();
+		}
+	}
+	PassIf(errorHandler.IsSuccessful());
+
+	// The repeated ids are made unique with suffixes: the library entities loaded
+	// in parallel must get the same ids and suffixes as when loaded serially.
+	PassIf(WriteDuplicateIdDocument(FC("DuplicateIdOut.dae")));
+	FUErrorSimpleHandler duplicateErrorHandler;
+	FUObjectRef<FCDocument> serialDuplicateDocument = FCollada::NewTopDocument();
+	FCollada::LoadDocumentFromFile(serialDuplicateDocument, FC("DuplicateIdOut.dae"));
+	PassIf(serialDuplicateDocument->GetGeometryLibrary()->GetEntityCount() > 0);
+	FCollada::SetParallelImportFlag(true);
+	bool duplicateIdsMatch = true;
+	for (size_t round = 0; round < roundCount; ++round)
+	{
+		ConcurrentLoad loads[threadCount];
+		FUThread* threads[threadCount];
+		for (size_t i = 0; i < threadCount; ++i)
+		{
+			loads[i].filename = FC("DuplicateIdOut.dae");
+			loads[i].document = FCollada::NewTopDocument();
+			threads[i] = FUThread::CreateFUThread(LoadDocumentThread, &loads[i]);
+		}
+		for (size_t i = 0; i < threadCount; ++i)
+		{
+			FUThread::ExitFUThread(threads[i]);
+			duplicateIdsMatch &= CheckSameDocument(fileOut, serialDuplicateDocument, loads[i].document);
+			loads[i].document->Release();
+		}
+	}
+	FCollada::SetParallelImportFlag(false);
+	PassIf(duplicateIdsMatch);
+
+TESTSUITE_TEST(2, ParallelImport)
+	static const fchar* filenames[] = { FC("Eagle.DAE"), FC("TestSphere.dae") };
+	static const size_t filenameCount = sizeof(filenames) / sizeof(*filenames);
+	static const size_t threadCount = 4;
+	FUErrorSimpleHandler errorHandler;
+
+	// Load each file serially, to get the reference documents.
+	FUObjectRef<FCDocument> serialDocuments[filenameCount];
+	for (size_t i = 0; i < filenameCount; ++i)
+	{
+		serialDocuments[i] = FCollada::NewTopDocument();
+		PassIf(FCollada::LoadDocumentFromFile(serialDocuments[i], filenames[i]));
+	}
+
+	// Load the library entities on the worker threads.
+	FCollada::SetParallelImportFlag(true);
+	bool documentsMatch = true;
+	for (size_t i = 0; i < filenameCount; ++i)
+	{
+		FUObjectRef<FCDocument> parallelDocument = FCollada::NewTopDocument();
+		documentsMatch &= FCollada::LoadDocumentFromFile(parallelDocument, filenames[i]);
+		documentsMatch &= CheckSameDocument(fileOut, serialDocuments[i], parallelDocument);
+	}
+
+	// Parallel imports started on several threads at once share the worker threads.
+	ConcurrentLoad loads[threadCount];
+	FUThread* threads[threadCount];
+	for (size_t i = 0; i < threadCount; ++i)
+	{
+		loads[i].filename = filenames[i % filenameCount];
+		loads[i].document = FCollada::NewTopDocument();
+		loads[i].status = false;
+		threads[i] = FUThread::CreateFUThread(LoadDocumentThread, &loads[i]);
+	}
+	bool threadsCreated = true;
+	for (size_t i = 0; i < threadCount; ++i)
+	{
+		threadsCreated &= threads[i] != nullptr;
+		FUThread::ExitFUThread(threads[i]);
+	}
+	FCollada::SetParallelImportFlag(false);
+	PassIf(documentsMatch);
+	PassIf(threadsCreated);
+
+	for (size_t i = 0; i < threadCount; ++i)
+	{
+		PassIf(loads[i].status);
+		PassIf(CheckSameDocument(fileOut, serialDocuments[i % filenameCount], loads[i].document));
+		loads[i].document->Release();
+	}
+	PassIf(errorHandler.IsSuccessful());
+
+TESTSUITE_TEST(3, ArenaLoading)
+	static const fchar* filenames[] = { FC("Eagle.DAE"), FC("TestSphere.dae") };
+	static const size_t filenameCount = sizeof(filenames) / sizeof(*filenames);
+	FUErrorSimpleHandler errorHandler;
+
+	// The documents loaded into an arena must match the documents loaded from the heap,
+	// with and without the worker threads.
+	for (size_t parallel = 0; parallel < 2; ++parallel)
+	{
+		FCollada::SetParallelImportFlag(parallel > 0);
+		for (size_t i = 0; i < filenameCount; ++i)
+		{
+			FUObjectRef<FCDocument> heapDocument = FCollada::NewTopDocument();
+			PassIf(FCollada::LoadDocumentFromFile(heapDocument, filenames[i]));
+			FCDocument* arenaDocument = FCollada::NewTopDocument();
+			arenaDocument->SetArenaAllocation(true);
+			PassIf(arenaDocument->HasArenaAllocation());
+			PassIf(FCollada::LoadDocumentFromFile(arenaDocument, filenames[i]));
+			PassIf(fm::GetCurrentArena() == nullptr);
+			PassIf(CheckSameDocument(fileOut, heapDocument, arenaDocument));
+
+			// The objects added after the loading come from the heap.
+			FCDSceneNode* sceneNode = arenaDocument->AddVisualScene();
+			sceneNode->SetName(FC("AddedAfterLoading"));
+			sceneNode->AddChildNode();
+			arenaDocument->Release();
+		}
+	}
+	FCollada::SetParallelImportFlag(false);
+	PassIf(errorHandler.IsSuccessful());
+
 TESTSUITE_END
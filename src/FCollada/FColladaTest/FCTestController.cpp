@@ -11,7 +11,37 @@
 #include "FCDocument/FCDSceneNode.h"
 #include "FCDocument/FCDSkinController.h"
 #include "FCDocument/FCDController.h"
+#include "FCDocument/FCDControllerInstance.h"
+#include "FCDocument/FCDGeometry.h"
+#include "FCDocument/FCDGeometryMesh.h"
+#include "FCDocument/FCDGeometryPolygons.h"
+#include "FCDocument/FCDGeometryPolygonsInput.h"
+#include "FCDocument/FCDGeometrySource.h"
 #include "FCDocument/FCDLibrary.h"
+#include "FCDocument/FCDMorphController.h"
+#include "FCDocument/FCDMorphDeformer.h"
+#include "FCDocument/FCDSkinDeformer.h"
+#include "FCDocument/FCDTransform.h"
+
+// Adds a geometry with one triangle and one normal.
+static FCDGeometry* AddTriangleGeometry(FCDocument* document, const float* positions, const FMVector3& normal)
+{
+	static const uint32 positionIndices[3] = { 0, 1, 2 };
+	static const uint32 normalIndices[3] = { 0, 0, 0 };
+	FCDGeometry* geometry = document->GetGeometryLibrary()->AddEntity();
+	FCDGeometryMesh* mesh = geometry->CreateMesh();
+	FCDGeometrySource* positionSource = mesh->AddVertexSource(FUDaeGeometryInput::POSITION);
+	positionSource->SetData(FloatList(positions, 9), 3);
+	FCDGeometrySource* normalSource = mesh->AddSource(FUDaeGeometryInput::NORMAL);
+	float normalData[3] = { normal.m_X, normal.m_Y, normal.m_Z };
+	normalSource->SetData(FloatList(normalData, 3), 3);
+	FCDGeometryPolygons* polygons = mesh->AddPolygons();
+	polygons->AddInput(normalSource, 1);
+	polygons->AddFace(3);
+	polygons->FindInput(positionSource)->SetIndices(positionIndices, 3);
+	polygons->FindInput(normalSource)->SetIndices(normalIndices, 3);
+	return geometry;
+}
 
 TESTSUITE_START(FCDControllers)
 
@@ -204,4 +234,136 @@ TESTSUITE_TEST(2, ReduceInfluence_Bulvan)
 		}
 	}
 
+TESTSUITE_TEST(3, SkinDeformer)
+	// Two triangles and two normals, skinned to a chain of two joints.
+	FUObjectRef<FCDocument> document = FCollada::NewTopDocument();
+	FCDGeometry* geometry = document->GetGeometryLibrary()->AddEntity();
+	FCDGeometryMesh* mesh = geometry->CreateMesh();
+	static const float positionData[12] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 2.0f, 0.0f, 1.0f, 2.0f, 0.5f };
+	static const float normalData[6] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.6f, 0.8f };
+	static const uint32 positionIndices[6] = { 0, 1, 2, 2, 1, 3 };
+	static const uint32 normalIndices[6] = { 0, 0, 0, 1, 1, 1 };
+	FCDGeometrySource* positionSource = mesh->AddVertexSource(FUDaeGeometryInput::POSITION);
+	positionSource->SetData(FloatList(positionData, 12), 3);
+	FCDGeometrySource* normalSource = mesh->AddSource(FUDaeGeometryInput::NORMAL);
+	normalSource->SetData(FloatList(normalData, 6), 3);
+	FCDGeometryPolygons* polygons = mesh->AddPolygons();
+	polygons->AddInput(normalSource, 1);
+	polygons->AddFace(3); polygons->AddFace(3);
+	polygons->FindInput(positionSource)->SetIndices(positionIndices, 6);
+	polygons->FindInput(normalSource)->SetIndices(normalIndices, 6);
+
+	FCDSceneNode* scene = document->AddVisualScene();
+	FCDSceneNode* upper = scene->AddChildNode();
+	FCDSceneNode* lower = upper->AddChildNode();
+	FCDTTranslation* upperTranslation = (FCDTTranslation*) upper->AddTransform(FCDTransform::TRANSLATION);
+	upperTranslation->SetTranslation(0.0f, 0.0f, 1.0f);
+	FCDTRotation* lowerRotation = (FCDTRotation*) lower->AddTransform(FCDTransform::ROTATION);
+	lowerRotation->SetRotation(FMVector3::XAxis, 0.0f);
+
+	FCDController* controller = document->GetControllerLibrary()->AddEntity();
+	FCDSkinController* skin = controller->CreateSkinController();
+	skin->SetTarget(geometry);
+	skin->SetBindShapeTransform(FMMatrix44::TranslationMatrix(FMVector3(0.0f, 0.0f, -1.0f)));
+	skin->AddJoint("upper", upper->CalculateWorldTransform().Inverted());
+	skin->AddJoint("lower", lower->CalculateWorldTransform().Inverted());
+	PassIf(skin->GetInfluenceCount() == 4);
+	skin->GetVertexInfluence(0)->AddPair(0, 1.0f);
+	skin->GetVertexInfluence(1)->AddPair(0, 0.5f);
+	skin->GetVertexInfluence(1)->AddPair(1, 0.5f);
+	skin->GetVertexInfluence(2)->AddPair(1, 1.0f);
+	skin->GetVertexInfluence(3)->AddPair(-1, 0.25f);
+	skin->GetVertexInfluence(3)->AddPair(0, 0.25f);
+	skin->GetVertexInfluence(3)->AddPair(1, 0.5f);
+	FCDControllerInstance* instance = (FCDControllerInstance*) scene->AddInstance(controller);
+	instance->AddJoint(upper);
+	instance->AddJoint(lower);
+
+	// Pose the joints and deform the mesh through the controller instance.
+	upperTranslation->SetTranslation(2.0f, 0.0f, 1.0f);
+	lowerRotation->SetAngle(90.0f);
+	lowerRotation->SetValueChange();
+	FCDSkinDeformer deformer;
+	PassIf(deformer.Compile(instance));
+	PassIf(deformer.GetVertexCount() == 4 && deformer.GetNormalCount() == 2);
+	PassIf(deformer.GetInfluenceWidth() == 3);
+	PassIf(deformer.Deform());
+
+	// Compare with the skinning equation, one influence at a time.
+	FMMatrix44 skinning[3];
+	skinning[0] = upper->CalculateWorldTransform() * skin->GetJoint(0)->GetBindPoseInverse() * skin->GetBindShapeTransform();
+	skinning[1] = lower->CalculateWorldTransform() * skin->GetJoint(1)->GetBindPoseInverse() * skin->GetBindShapeTransform();
+	skinning[2] = skin->GetBindShapeTransform();
+	for (size_t v = 0; v < 4; ++v)
+	{
+		FMVector3 position(positionData, (uint32) (3 * v)), expected = FMVector3::Zero;
+		const FCDSkinControllerVertex* influences = skin->GetVertexInfluence(v);
+		for (size_t p = 0; p < influences->GetPairCount(); ++p)
+		{
+			int32 joint = influences->GetPair(p)->jointIndex;
+			expected += skinning[joint >= 0 ? joint : 2].TransformCoordinate(position) * influences->GetPair(p)->weight;
+		}
+		PassIf(IsEquivalent(FMVector3(deformer.GetPositions(), (uint32) (3 * v)), expected));
+	}
+	PassIf(IsEquivalent(FMVector3(deformer.GetNormals(), 0), skinning[0].TransformVector(FMVector3::ZAxis)));
+	PassIf(IsEquivalent(FMVector3(deformer.GetNormals(), 3), skinning[1].TransformVector(FMVector3(normalData, 3))));
+	PassIf(IsEquivalent(FMVector3(deformer.GetNormals(), 3), FMVector3(0.0f, -0.8f, 0.6f)));
+
+	// The explicit joint transforms, with the two strongest influences only.
+	FMMatrix44 worlds[2] = { upper->CalculateWorldTransform(), lower->CalculateWorldTransform() };
+	PassIf(deformer.Compile(skin, 2));
+	PassIf(deformer.GetInfluenceWidth() == 2);
+	PassIf(!deformer.Deform());
+	PassIf(deformer.Deform(worlds, 2));
+	FMVector3 lastPosition(positionData, 9);
+	FMVector3 expected = (skinning[1].TransformCoordinate(lastPosition) * 0.5f + skinning[0].TransformCoordinate(lastPosition) * 0.25f) / 0.75f;
+	PassIf(IsEquivalent(FMVector3(deformer.GetPositions(), 9), expected));
+
+TESTSUITE_TEST(4, MorphDeformer)
+	// A triangle, with one morph target moving its last vertex and one moving its second vertex.
+	FUObjectRef<FCDocument> document = FCollada::NewTopDocument();
+	static const float basePositions[9] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+	static const float raisedPositions[9] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f };
+	static const float stretchedPositions[9] = { 0.0f, 0.0f, 0.0f, 2.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+	FCDGeometry* base = AddTriangleGeometry(document, basePositions, FMVector3::ZAxis);
+	FCDGeometry* raised = AddTriangleGeometry(document, raisedPositions, FMVector3::YAxis);
+	FCDGeometry* stretched = AddTriangleGeometry(document, stretchedPositions, FMVector3::ZAxis);
+	FCDController* controller = document->GetControllerLibrary()->AddEntity();
+	FCDMorphController* morph = controller->CreateMorphController();
+	morph->SetBaseTarget(base);
+	PassIf(morph->AddTarget(raised, 0.5f) != nullptr);
+	PassIf(morph->AddTarget(stretched, 0.25f) != nullptr);
+
+	// With the NORMALIZED method, only the moved vertices are stored.
+	FCDMorphDeformer deformer;
+	PassIf(!deformer.Deform());
+	PassIf(deformer.Compile(morph));
+	PassIf(deformer.GetTargetCount() == 2 && deformer.GetVertexCount() == 3 && deformer.GetNormalCount() == 1);
+	PassIf(deformer.GetPositionDeltaCount() == 2);
+	PassIf(deformer.Deform());
+	PassIf(deformer.GetActiveTargetCount() == 2);
+	PassIf(IsEquivalent(FMVector3(deformer.GetPositions(), 0), FMVector3::Zero));
+	PassIf(IsEquivalent(FMVector3(deformer.GetPositions(), 3), FMVector3(1.25f, 0.0f, 0.0f)));
+	PassIf(IsEquivalent(FMVector3(deformer.GetPositions(), 6), FMVector3(0.0f, 1.0f, 0.5f)));
+	PassIf(IsEquivalent(FMVector3(deformer.GetNormals(), 0), FMVector3(0.0f, 1.0f, 1.0f).Normalize()));
+
+	// The morph targets with a zero weight are skipped.
+	static const float weights[2] = { 0.0f, 1.0f };
+	PassIf(deformer.Deform(weights, 2));
+	PassIf(deformer.GetActiveTargetCount() == 1);
+	PassIf(IsEquivalent(FMVector3(deformer.GetPositions(), 3), FMVector3(2.0f, 0.0f, 0.0f)));
+	PassIf(IsEquivalent(FMVector3(deformer.GetPositions(), 6), FMVector3(0.0f, 1.0f, 0.0f)));
+	PassIf(IsEquivalent(FMVector3(deformer.GetNormals(), 0), FMVector3::ZAxis));
+
+	// With the RELATIVE method, the morph target positions are the differences.
+	morph->SetMethod(FUDaeMorphMethod::RELATIVE);
+	PassIf(deformer.Compile(morph));
+	PassIf(deformer.GetPositionDeltaCount() == 4);
+	static const float relativeWeights[2] = { 0.5f, 0.0f };
+	PassIf(deformer.Deform(relativeWeights, 2));
+	PassIf(IsEquivalent(FMVector3(deformer.GetPositions(), 0), FMVector3::Zero));
+	PassIf(IsEquivalent(FMVector3(deformer.GetPositions(), 3), FMVector3(1.5f, 0.0f, 0.0f)));
+	PassIf(IsEquivalent(FMVector3(deformer.GetPositions(), 6), FMVector3(0.0f, 1.5f, 0.5f)));
+	PassIf(IsEquivalent(FMVector3(deformer.GetNormals(), 0), FMVector3(0.0f, 0.5f, 1.0f).Normalize()));
+
 TESTSUITE_END
@@ -25,11 +25,77 @@
 #include "FCDocument/FCDEffectStandard.h"
 #include "FCDocument/FCDEffectParameter.h"
 
+#include "FCDocument/FCDAnimated.h"
+#include "FCDocument/FCDAnimation.h"
+#include "FCDocument/FCDAnimationChannel.h"
+#include "FCDocument/FCDAnimationCurve.h"
+#include "FCDocument/FCDAnimationKey.h"
+
 #include "FCTestExportImport.h"
+#include "FUtils/FUFile.h"
+#include "FUtils/FUFunctor.h"
+#if defined(LINUX) && defined(__GLIBC__)
+#include <malloc.h>
+#endif
 using namespace FCTestExportImport;
 
 static fm::string sceneNode1Id, sceneNode2Id, sceneNode3Id;
 
+// Samples the heap memory while the animations of a streamed document are loaded,
+// before any of its geometries are loaded.
+static FCDocument* sampledDocument = nullptr;
+static size_t sampledHeapPeak = 0, sampleCount = 0;
+
+static size_t GetHeapSize()
+{
+#if defined(LINUX) && defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+	struct mallinfo2 info = mallinfo2();
+	return info.uordblks + info.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+static bool SampleHeapSize()
+{
+	if (sampledDocument != nullptr && sampledDocument->GetAnimationLibrary()->GetEntityCount() > 0
+		&& sampledDocument->GetGeometryLibrary()->GetEntityCount() == 0)
+	{
+		size_t heapSize = GetHeapSize();
+		if (heapSize > sampledHeapPeak) sampledHeapPeak = heapSize;
+		++sampleCount;
+	}
+	return false;
+}
+
+// Reads back an exported document.
+static fm::string ReadDocumentText(const fchar* filename)
+{
+	FUFile file(filename, FUFile::READ);
+	if (!file.IsOpen()) return fm::string();
+	size_t length = file.GetLength();
+	fm::vector<char> data;
+	data.resize(length);
+	if (length == 0 || !file.Read(data.begin(), length)) return fm::string();
+	return fm::string(data.begin(), length);
+}
+
+// Reads back an exported document, without its modification date.
+// Appends a little-endian 32-bit value to a binary archive.
+static void AppendUInt32(fm::vector<uint8>& data, uint32 value)
+{
+	for (size_t i = 0; i < 4; ++i) data.push_back((uint8) (value >> (8 * i)));
+}
+
+static fm::string ReadExportedDocument(const fchar* filename)
+{
+	fm::string text = ReadDocumentText(filename);
+	size_t start = text.find("<modified>");
+	size_t end = text.find("</modified>");
+	if (start == fm::string::npos || end == fm::string::npos || end < start) return text;
+	return text.substr(0, start) + text.substr(end);
+}
+
 // Test import of a code-generated scene, with library entities.
 // Does the export, re-import and validates that the information is intact.
 TESTSUITE_START(FCDExportReimport)
@@ -312,4 +378,217 @@ TESTSUITE_TEST(2, paramImport)
 	PassIf(instanceShininess2 == FCDEffectTools::FindEffectParameterByReference(geometryInstance2, "myShininessAnimated"));
 	PassIf(instanceShininess2->IsAnimator());
 
+TESTSUITE_TEST(3, StreamedReimport)
+	// Import back the exported document, one XML element at a time.
+	FUErrorSimpleHandler errorHandler;
+	FCollada::SetStreamingImportFlag(true);
+	FUObjectRef<FCDocument> idoc = FCollada::NewTopDocument();
+	bool loaded = FCollada::LoadDocumentFromFile(idoc, FC("TestOut.dae"));
+	FCollada::SetStreamingImportFlag(false);
+	PassIf(loaded);
+	PassIf(errorHandler.IsSuccessful());
+
+	// The streamed document must hold the same data as the parsed document.
+	FCDSceneNode* found2 = nullptr;
+	FCDVisualSceneNodeLibrary* vsl = idoc->GetVisualSceneLibrary();
+	for (size_t i = 0; i < vsl->GetEntityCount(); ++i)
+	{
+		if (vsl->GetEntity(i)->GetDaeId() == sceneNode2Id) found2 = vsl->GetEntity(i);
+	}
+	PassIf(found2 != nullptr);
+	PassIf(CheckLayers(fileOut, idoc));
+	PassIf(CheckVisualScene(fileOut, found2));
+	PassIf(CheckImageLibrary(fileOut, idoc->GetImageLibrary()));
+	PassIf(CheckCameraLibrary(fileOut, idoc->GetCameraLibrary()));
+	PassIf(CheckEmitterLibrary(fileOut, idoc->GetEmitterLibrary()));
+	PassIf(CheckForceFieldLibrary(fileOut, idoc->GetForceFieldLibrary()));
+	PassIf(CheckLightLibrary(fileOut, idoc->GetLightLibrary()));
+	PassIf(CheckGeometryLibrary(fileOut, idoc->GetGeometryLibrary()));
+	PassIf(CheckControllerLibrary(fileOut, idoc->GetControllerLibrary()));
+	PassIf(CheckMaterialLibrary(fileOut, idoc->GetMaterialLibrary()));
+	PassIf(CheckAnimationLibrary(fileOut, idoc->GetAnimationLibrary()));
+	PassIf(CheckPhysics(fileOut, idoc));
+	PassIf(idoc->GetExtra()->FindType("TOTO") != nullptr);
+
+	// Load a larger sample both ways and compare the libraries.
+	FUObjectRef<FCDocument> parsedDoc = FCollada::NewTopDocument();
+	PassIf(FCollada::LoadDocumentFromFile(parsedDoc, FC("Eagle.DAE")));
+	FCollada::SetStreamingImportFlag(true);
+	FUObjectRef<FCDocument> streamedDoc = FCollada::NewTopDocument();
+	loaded = FCollada::LoadDocumentFromFile(streamedDoc, FC("Eagle.DAE"));
+	FCollada::SetStreamingImportFlag(false);
+	PassIf(loaded);
+	PassIf(parsedDoc->GetAnimationLibrary()->GetEntityCount() == streamedDoc->GetAnimationLibrary()->GetEntityCount());
+	PassIf(parsedDoc->GetMaterialLibrary()->GetEntityCount() == streamedDoc->GetMaterialLibrary()->GetEntityCount());
+	PassIf(parsedDoc->GetControllerLibrary()->GetEntityCount() == streamedDoc->GetControllerLibrary()->GetEntityCount());
+	PassIf(parsedDoc->GetVisualSceneLibrary()->GetEntityCount() == streamedDoc->GetVisualSceneLibrary()->GetEntityCount());
+	FCDGeometryLibrary* parsedGeometries = parsedDoc->GetGeometryLibrary();
+	FCDGeometryLibrary* streamedGeometries = streamedDoc->GetGeometryLibrary();
+	PassIf(parsedGeometries->GetEntityCount() == streamedGeometries->GetEntityCount());
+	for (size_t i = 0; i < parsedGeometries->GetEntityCount(); ++i)
+	{
+		FCDGeometry* parsedGeometry = parsedGeometries->GetEntity(i);
+		FCDGeometry* streamedGeometry = streamedGeometries->GetEntity(i);
+		PassIf(parsedGeometry->GetDaeId() == streamedGeometry->GetDaeId());
+		PassIf(parsedGeometry->IsMesh() == streamedGeometry->IsMesh());
+		if (!parsedGeometry->IsMesh()) continue;
+		FCDGeometryMesh* parsedMesh = parsedGeometry->GetMesh();
+		FCDGeometryMesh* streamedMesh = streamedGeometry->GetMesh();
+		PassIf(parsedMesh->GetSourceCount() == streamedMesh->GetSourceCount());
+		PassIf(parsedMesh->GetPolygonsCount() == streamedMesh->GetPolygonsCount());
+		for (size_t j = 0; j < parsedMesh->GetSourceCount(); ++j)
+		{
+			PassIf(parsedMesh->GetSource(j)->GetDataCount() == streamedMesh->GetSource(j)->GetDataCount());
+		}
+	}
+	PassIf(streamedDoc->GetVisualSceneInstance() != nullptr);
+
+TESTSUITE_TEST(4, StreamedExport)
+	// Export the same document with the whole XML tree and one library entity at a time.
+	FUErrorSimpleHandler errorHandler;
+	FUObjectRef<FCDocument> treeDoc = FCollada::NewTopDocument();
+	PassIf(FCollada::LoadDocumentFromFile(treeDoc, FC("Eagle.DAE")));
+	PassIf(FCollada::SaveDocument(treeDoc, FC("EagleTreeOut.dae")));
+	FUObjectRef<FCDocument> streamedDoc = FCollada::NewTopDocument();
+	PassIf(FCollada::LoadDocumentFromFile(streamedDoc, FC("Eagle.DAE")));
+	FCollada::SetStreamingExportFlag(true);
+	bool saved = FCollada::SaveDocument(streamedDoc, FC("EagleStreamedOut.dae"));
+	FCollada::SetStreamingExportFlag(false);
+	PassIf(saved);
+	PassIf(errorHandler.IsSuccessful());
+
+	// The temporary file of the deferred libraries is removed.
+	FUFile deferredFile(FC("EagleStreamedOut.dae.deferred"), FUFile::READ);
+	PassIf(!deferredFile.IsOpen());
+
+	// The animation library must keep its place, before the other libraries.
+	fm::string treeText = ReadExportedDocument(FC("EagleTreeOut.dae"));
+	fm::string streamedText = ReadExportedDocument(FC("EagleStreamedOut.dae"));
+	PassIf(!treeText.empty());
+	PassIf(treeText.find("<library_animations>") < treeText.find("<library_geometries>"));
+	PassIf(IsEquivalent(treeText, streamedText));
+
+TESTSUITE_TEST(5, BinaryArchive)
+	// Write out a document in the binary form and read it back in:
+	// the document must be written out in the XML form exactly as before.
+	FUErrorSimpleHandler errorHandler;
+	FUObjectRef<FCDocument> xmlDoc = FCollada::NewTopDocument();
+	PassIf(FCollada::LoadDocumentFromFile(xmlDoc, FC("Eagle.DAE")));
+	PassIf(FCollada::SaveDocument(xmlDoc, FC("EagleXmlOut.dae")));
+	PassIf(FCollada::SaveDocument(xmlDoc, FC("EagleBinaryOut.fcb")));
+	FUObjectRef<FCDocument> binaryDoc = FCollada::NewTopDocument();
+	PassIf(FCollada::LoadDocumentFromFile(binaryDoc, FC("EagleBinaryOut.fcb")));
+	PassIf(FCollada::SaveDocument(binaryDoc, FC("EagleBinaryOut.dae")));
+	PassIf(errorHandler.IsSuccessful());
+
+	fm::string xmlText = ReadExportedDocument(FC("EagleXmlOut.dae"));
+	fm::string binaryText = ReadExportedDocument(FC("EagleBinaryOut.dae"));
+	PassIf(!xmlText.empty());
+	PassIf(IsEquivalent(xmlText, binaryText));
+
+	// The binary form may also be read in from memory.
+	FUFile file(FC("EagleBinaryOut.fcb"), FUFile::READ);
+	size_t dataLength = file.GetLength();
+	fm::vector<uint8> data;
+	data.resize(dataLength);
+	PassIf(file.Read(data.begin(), dataLength));
+	file.Close();
+	FUObjectRef<FCDocument> memoryDoc = FCollada::NewTopDocument();
+	PassIf(FCollada::LoadDocumentFromMemory(FC("EagleBinaryOut.fcb"), memoryDoc, data.begin(), dataLength));
+	PassIf(FCollada::SaveDocument(memoryDoc, FC("EagleBinaryOut.dae")));
+	PassIf(IsEquivalent(xmlText, ReadExportedDocument(FC("EagleBinaryOut.dae"))));
+
+	// A damaged binary form must be rejected.
+	FUObjectRef<FCDocument> damagedDoc = FCollada::NewTopDocument();
+	FUErrorSimpleHandler damagedErrorHandler;
+	PassIf(!FCollada::LoadDocumentFromMemory(FC("EagleBinaryOut.fcb"), damagedDoc, data.begin(), dataLength / 2));
+
+	// A binary form with elements nested too deeply must be rejected before the stack runs out.
+	// It has the header of the written out binary form, a single name and one million nested elements.
+	static const uint32 deepElementCount = 1000000;
+	fm::vector<uint8> deepData(data.begin(), 8);
+	AppendUInt32(deepData, 1);
+	AppendUInt32(deepData, 4);
+	deepData.insert(deepData.end(), (const uint8*) "node", 5);
+	deepData.reserve(deepData.size() + deepElementCount * 13);
+	for (uint32 i = 0; i < deepElementCount; ++i)
+	{
+		deepData.push_back(1); // Element record
+		AppendUInt32(deepData, 0); // Name index
+		AppendUInt32(deepData, 0); // Attribute count
+		AppendUInt32(deepData, (i < deepElementCount - 1) ? 1 : 0); // Child record count
+	}
+	FUObjectRef<FCDocument> deepDoc = FCollada::NewTopDocument();
+	PassIf(!FCollada::LoadDocumentFromMemory(FC("DeepBinaryOut.fcb"), deepDoc, deepData.begin(), deepData.size()));
+
+TESTSUITE_TEST(6, StreamedAnimationsLast)
+	// Write out a document with large meshes and an animated node.
+	static const size_t geometryCount = 64;
+	static const size_t positionCount = 15000;
+	FUErrorSimpleHandler errorHandler;
+	FUObjectRef<FCDocument> doc = FCollada::NewTopDocument();
+	FloatList positions(positionCount, 0.0f);
+	for (size_t i = 0; i < positionCount; ++i) positions[i] = 0.123456789f * (float) i;
+	for (size_t i = 0; i < geometryCount; ++i)
+	{
+		FCDGeometry* geometry = doc->GetGeometryLibrary()->AddEntity();
+		FCDGeometrySource* positionSource = geometry->CreateMesh()->AddVertexSource(FUDaeGeometryInput::POSITION);
+		positionSource->SetData(positions, 3);
+	}
+	FCDSceneNode* node = doc->AddVisualScene()->AddChildNode();
+	FCDTransform* translation = node->AddTransform(FCDTransform::TRANSLATION);
+	FCDAnimationCurve* curve = doc->GetAnimationLibrary()->AddEntity()->AddChannel()->AddCurve();
+	curve->AddKey(FUDaeInterpolation::LINEAR, 0.0f)->output = 1.0f;
+	curve->AddKey(FUDaeInterpolation::LINEAR, 1.0f)->output = 2.0f;
+	translation->GetAnimated()->AddCurve(0, curve);
+	PassIf(FCollada::SaveDocument(doc, FC("AnimationsLastOut.dae")));
+
+	// Move the animation library after the other libraries, as most modelers do.
+	fm::string text = ReadDocumentText(FC("AnimationsLastOut.dae"));
+	size_t animationStart = text.find("<library_animations>");
+	size_t animationEnd = text.find("</library_animations>");
+	size_t sceneStart = text.find("<scene>");
+	PassIf(animationStart < animationEnd && animationEnd < sceneStart && sceneStart != fm::string::npos);
+	animationEnd += strlen("</library_animations>");
+	fm::string animationText = text.substr(animationStart, animationEnd - animationStart);
+	text = text.substr(0, animationStart) + text.substr(animationEnd, sceneStart - animationEnd) + animationText + text.substr(sceneStart);
+	PassIf(text.find("<library_geometries>") < text.find("<library_animations>"));
+	{
+		FUFile file(FC("AnimationsLastOut.dae"), FUFile::WRITE);
+		PassIf(file.Write(text.c_str(), text.length()));
+	}
+
+	// Stream the document back in: the geometries must not be held in memory
+	// while the animations, which are loaded first, are loaded. The reader only
+	// holds on to the memory for the largest text node it has gone through.
+	FUObjectRef<FCDocument> streamedDoc = FCollada::NewTopDocument();
+	sampledDocument = streamedDoc;
+	sampleCount = 0;
+	size_t heapSize = sampledHeapPeak = GetHeapSize();
+	FUStaticFunctor0<bool> sampleCallback(SampleHeapSize);
+	FCollada::SetCancelLoadingCallback(&sampleCallback);
+	FCollada::SetStreamingImportFlag(true);
+	bool loaded = FCollada::LoadDocumentFromFile(streamedDoc, FC("AnimationsLastOut.dae"));
+	FCollada::SetStreamingImportFlag(false);
+	FCollada::SetCancelLoadingCallback(nullptr);
+	sampledDocument = nullptr;
+	PassIf(loaded);
+	PassIf(errorHandler.IsSuccessful());
+	PassIf(sampleCount > 0);
+	PassIf(sampledHeapPeak - heapSize < text.length() / 4);
+
+	// The libraries must all be loaded and linked.
+	PassIf(streamedDoc->GetGeometryLibrary()->GetEntityCount() == geometryCount);
+	for (size_t i = 0; i < geometryCount; ++i)
+	{
+		FCDGeometry* streamedGeometry = streamedDoc->GetGeometryLibrary()->GetEntity(i);
+		PassIf(streamedGeometry->IsMesh() && streamedGeometry->GetMesh()->GetSourceCount() == 1);
+		PassIf(streamedGeometry->GetMesh()->GetSource(0)->GetDataCount() == positionCount);
+	}
+	PassIf(streamedDoc->GetVisualSceneLibrary()->GetEntityCount() == 1);
+	FCDSceneNode* streamedNode = streamedDoc->GetVisualSceneLibrary()->GetEntity(0)->GetChild(0);
+	PassIf(streamedNode != nullptr && streamedNode->GetTransformCount() == 1);
+	PassIf(streamedNode->GetTransform(0)->IsAnimated());
+	PassIf(streamedNode->GetTransform(0)->GetAnimated()->GetCurve(0)->GetKeyCount() == 2);
+
 TESTSUITE_END
@@ -14,6 +14,7 @@
 #include "FCDocument/FCDGeometryPolygons.h"
 #include "FCDocument/FCDGeometryPolygonsInput.h"
 #include "FCDocument/FCDGeometryPolygonsTools.h"
+#include "FCDocument/FCDGeometrySource.h"
 
 TESTSUITE_START(FCDGeometryPolygonsTools)
 
@@ -99,4 +100,338 @@ TESTSUITE_TEST(1, GenerateUniqueIndices)
 	PassIf(newVertexIndexCount == newNormalIndexCount);
 	PassIf(newVertexList == newNormalList);
 
+TESTSUITE_TEST(2, GenerateUniqueIndexTables)
+	FUErrorSimpleHandler errorHandler;
+
+	// Import of the Eagle sample and split its mesh into three polygons sets.
+	FUObjectRef<FCDocument> document = FCollada::NewTopDocument();
+	PassIf(FCollada::LoadDocumentFromFile(document, FC("Eagle.DAE")));
+	PassIf(errorHandler.IsSuccessful());
+	FailIf(document->GetGeometryLibrary()->GetEntityCount() == 0);
+	FCDGeometry* geometry = document->GetGeometryLibrary()->GetEntity(0);
+	FailIf(geometry == nullptr || !geometry->IsMesh());
+	FCDGeometryMesh* mesh = geometry->GetMesh();
+	FailIf(mesh == nullptr);
+	FCDGeometryPolygonsTools::FitIndexBuffers(mesh, 90);
+	PassIf(mesh->GetPolygonsCount() == 3);
+
+	FCDNewIndicesList tableIndices, mapIndices;
+	FCDGeometryIndexTranslationTableList translationTables;
+	FCDGeometryIndexTranslationMapList translationMaps;
+	FCDGeometryPolygonsTools::GenerateUniqueIndices(mesh, nullptr, tableIndices, translationTables);
+	FCDGeometryPolygonsTools::GenerateUniqueIndices(mesh, nullptr, mapIndices, translationMaps);
+	PassIf(tableIndices.size() == 3 && mapIndices.size() == 3);
+	PassIf(translationTables.size() == mesh->GetSourceCount() && translationMaps.size() == mesh->GetSourceCount());
+
+	// The face-vertex pairs of a polygons set share a new index exactly when they share all their indices.
+	// The new indices are numbered in order of appearance, one polygons set after the other.
+	uint32 nextIndex = 0;
+	for (size_t p = 0; p < 3; ++p)
+	{
+		FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
+		const UInt32List& indices = tableIndices[p];
+		PassIf(indices == mapIndices[p]);
+		PassIf(indices.size() == polygons->GetFaceVertexCount());
+		uint32 firstIndex = nextIndex;
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			if (indices[i] == nextIndex) ++nextIndex;
+			PassIf(indices[i] >= firstIndex && indices[i] < nextIndex);
+			for (size_t j = 0; j < i; ++j)
+			{
+				bool sameIndices = true;
+				for (size_t k = 0; k < polygons->GetInputCount(); ++k)
+				{
+					const uint32* inputIndices = polygons->GetInput(k)->GetIndices();
+					sameIndices &= inputIndices[i] == inputIndices[j];
+				}
+				PassIf(sameIndices == (indices[i] == indices[j]));
+			}
+		}
+	}
+
+	// The translation tables hold the same new indices as the translation maps.
+	for (size_t d = 0; d < mesh->GetSourceCount(); ++d)
+	{
+		const FCDGeometryIndexTranslationTable& table = translationTables[d];
+		const FCDGeometryIndexTranslationMap& map = *translationMaps[d];
+		PassIf(table.GetOldIndexCount() == mesh->GetSource(d)->GetValueCount());
+		size_t mapValueCount = 0;
+		for (FCDGeometryIndexTranslationMap::const_iterator it = map.begin(); it != map.end(); ++it)
+		{
+			PassIf(table.GetNewIndexCount(it->first) == it->second.size());
+			PassIf(memcmp(table.GetNewIndices(it->first), it->second.begin(), sizeof(uint32) * it->second.size()) == 0);
+			mapValueCount += it->second.size();
+		}
+		PassIf(table.values.size() == mapValueCount);
+
+		// Relocate the source data and verify it against the old indices.
+		FCDGeometrySource* source = mesh->GetSource(d);
+		uint32 stride = source->GetStride();
+		FloatList vertexBuffer(stride * nextIndex, 0.0f);
+		FCDGeometryPolygonsTools::ApplyUniqueIndices(vertexBuffer.begin(), source->GetData(), stride, table);
+		for (size_t p = 0; p < 3; ++p)
+		{
+			FCDGeometryPolygonsInput* input = mesh->GetPolygons(p)->FindInput(source);
+			FailIf(input == nullptr);
+			const UInt32List& indices = tableIndices[p];
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				PassIf(memcmp(&vertexBuffer[stride * indices[i]], source->GetData() + stride * input->GetIndices()[i], sizeof(float) * stride) == 0);
+			}
+		}
+	}
+	CLEAR_POINTER_VECTOR(translationMaps);
+
+TESTSUITE_TEST(3, OptimizeVertexCache)
+	FUErrorSimpleHandler errorHandler;
+
+	// Import of the Eagle sample and prepare its mesh for one index buffer.
+	FUObjectRef<FCDocument> document = FCollada::NewTopDocument();
+	PassIf(FCollada::LoadDocumentFromFile(document, FC("Eagle.DAE")));
+	PassIf(errorHandler.IsSuccessful());
+	FailIf(document->GetGeometryLibrary()->GetEntityCount() == 0);
+	FCDGeometry* geometry = document->GetGeometryLibrary()->GetEntity(0);
+	FailIf(geometry == nullptr || !geometry->IsMesh());
+	FCDGeometryMesh* mesh = geometry->GetMesh();
+	FailIf(mesh == nullptr);
+	FCDGeometryPolygonsTools::Triangulate(mesh);
+	FCDGeometryPolygonsTools::GenerateUniqueIndices(mesh);
+	FCDGeometryPolygons* polygons = mesh->GetPolygons(0);
+	FCDGeometrySource* positionSource = mesh->FindSourceByType(FUDaeGeometryInput::POSITION);
+	FailIf(positionSource == nullptr);
+	UInt32List oldIndices(polygons->GetInput(0)->GetIndices(), polygons->GetInput(0)->GetIndexCount());
+	FloatList oldPositions(positionSource->GetData(), positionSource->GetDataCount());
+	FCDVertexCacheStatistics before = FCDGeometryPolygonsTools::CalculateVertexCacheStatistics(mesh);
+	PassIf(before.triangleCount == oldIndices.size() / 3);
+
+	UInt32List vertexRemap;
+	PassIf(FCDGeometryPolygonsTools::OptimizeVertexCache(mesh, false, &vertexRemap));
+	FCDVertexCacheStatistics after = FCDGeometryPolygonsTools::CalculateVertexCacheStatistics(mesh);
+	PassIf(after.triangleCount == before.triangleCount && after.vertexCount == before.vertexCount);
+	PassIf(after.GetACMR() <= before.GetACMR());
+	PassIf(vertexRemap.size() == positionSource->GetValueCount());
+
+	// The vertex data moved with the vertices, which are sorted in the order of their first use.
+	const uint32* newIndices = polygons->GetInput(0)->GetIndices();
+	PassIf(polygons->GetInput(0)->GetIndexCount() == oldIndices.size());
+	for (size_t v = 0; v < vertexRemap.size(); ++v)
+	{
+		PassIf(memcmp(positionSource->GetData() + 3 * vertexRemap[v], oldPositions.begin() + 3 * v, sizeof(float) * 3) == 0);
+	}
+	uint32 nextVertex = 0;
+	for (size_t i = 0; i < oldIndices.size(); ++i)
+	{
+		PassIf(newIndices[i] <= nextVertex);
+		if (newIndices[i] == nextVertex) ++nextVertex;
+	}
+
+	// The triangles are only reordered.
+	fm::vector<uint8, true> matchedTriangles(oldIndices.size() / 3, 0);
+	for (size_t n = 0; n < oldIndices.size() / 3; ++n)
+	{
+		bool found = false;
+		for (size_t t = 0; t < oldIndices.size() / 3 && !found; ++t)
+		{
+			found = matchedTriangles[t] == 0 && vertexRemap[oldIndices[3 * t]] == newIndices[3 * n]
+				&& vertexRemap[oldIndices[3 * t + 1]] == newIndices[3 * n + 1] && vertexRemap[oldIndices[3 * t + 2]] == newIndices[3 * n + 2];
+			if (found) matchedTriangles[t] = 1;
+		}
+		PassIf(found);
+	}
+
+	// A grid with shuffled triangles must end up close to one transform per vertex.
+	FCDGeometry* gridGeometry = document->GetGeometryLibrary()->AddEntity();
+	FCDGeometryMesh* grid = gridGeometry->CreateMesh();
+	const uint32 gridSize = 17;
+	FloatList gridPositions;
+	for (uint32 y = 0; y < gridSize; ++y)
+	{
+		for (uint32 x = 0; x < gridSize; ++x) { gridPositions.push_back((float) x); gridPositions.push_back((float) y); gridPositions.push_back(0.0f); }
+	}
+	FCDGeometrySource* gridSource = grid->AddVertexSource(FUDaeGeometryInput::POSITION);
+	gridSource->SetData(gridPositions, 3);
+	UInt32List gridIndices;
+	for (uint32 y = 0; y + 1 < gridSize; ++y)
+	{
+		for (uint32 x = 0; x + 1 < gridSize; ++x)
+		{
+			uint32 v0 = y * gridSize + x, v1 = v0 + 1, v2 = v0 + gridSize, v3 = v2 + 1;
+			gridIndices.push_back(v0); gridIndices.push_back(v2); gridIndices.push_back(v1);
+			gridIndices.push_back(v1); gridIndices.push_back(v2); gridIndices.push_back(v3);
+		}
+	}
+	uint32 seed = 1;
+	for (size_t t = gridIndices.size() / 3 - 1; t > 0; --t)
+	{
+		seed = seed * 1664525 + 1013904223;
+		size_t s = (seed >> 8) % (t + 1);
+		for (size_t k = 0; k < 3; ++k) { uint32 index = gridIndices[3 * t + k]; gridIndices[3 * t + k] = gridIndices[3 * s + k]; gridIndices[3 * s + k] = index; }
+	}
+	FCDGeometryPolygons* gridPolygons = grid->AddPolygons();
+	for (size_t t = 0; t < gridIndices.size() / 3; ++t) gridPolygons->AddFaceVertexCount(3);
+	gridPolygons->FindInput(gridSource)->SetIndices(gridIndices.begin(), gridIndices.size());
+	before = FCDGeometryPolygonsTools::CalculateVertexCacheStatistics(grid);
+	PassIf(FCDGeometryPolygonsTools::OptimizeVertexCache(grid, true));
+	after = FCDGeometryPolygonsTools::CalculateVertexCacheStatistics(grid);
+	PassIf(before.GetACMR() > 1.5f);
+	PassIf(after.GetACMR() < 0.8f);
+	PassIf(after.GetATVR() < 1.4f);
+
+TESTSUITE_TEST(4, WeldSource)
+	// A soup of triangles over a grid: each triangle has its own jittered positions,
+	// and its texture coordinates share the indices of the positions.
+	FUObjectRef<FCDocument> document = FCollada::NewTopDocument();
+	FCDGeometry* geometry = document->GetGeometryLibrary()->AddEntity();
+	FCDGeometryMesh* mesh = geometry->CreateMesh();
+	const uint32 gridSize = 9;
+	const float tolerance = 0.01f;
+	FloatList positions, texcoords;
+	uint32 seed = 1;
+	for (uint32 y = 0; y + 1 < gridSize; ++y)
+	{
+		for (uint32 x = 0; x + 1 < gridSize; ++x)
+		{
+			static const uint32 corners[6][2] = { { 0, 0 }, { 0, 1 }, { 1, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } };
+			for (size_t c = 0; c < 6; ++c)
+			{
+				for (size_t k = 0; k < 3; ++k)
+				{
+					seed = seed * 1664525 + 1013904223;
+					float jitter = (float) ((seed >> 8) % 1000) / 1000.0f * 0.4f * tolerance - 0.2f * tolerance;
+					float coordinate = (k == 0) ? (float) (x + corners[c][0]) : ((k == 1) ? (float) (y + corners[c][1]) : 0.0f);
+					positions.push_back(coordinate + jitter);
+				}
+				texcoords.push_back((float) positions.size()); texcoords.push_back(0.0f);
+			}
+		}
+	}
+	size_t soupCount = positions.size() / 3;
+	FCDGeometrySource* positionSource = mesh->AddVertexSource(FUDaeGeometryInput::POSITION);
+	positionSource->SetData(positions, 3);
+	FCDGeometrySource* texcoordSource = mesh->AddSource(FUDaeGeometryInput::TEXCOORD);
+	texcoordSource->SetData(texcoords, 2);
+	FCDGeometryPolygons* polygons = mesh->AddPolygons();
+	FCDGeometryPolygonsInput* positionInput = polygons->FindInput(positionSource);
+	FCDGeometryPolygonsInput* texcoordInput = polygons->AddInput(texcoordSource, positionInput->GetOffset());
+	UInt32List soupIndices;
+	for (uint32 i = 0; i < (uint32) soupCount; ++i) soupIndices.push_back(i);
+	for (size_t f = 0; f < soupCount / 3; ++f) polygons->AddFaceVertexCount(3);
+	positionInput->SetIndices(soupIndices.begin(), soupIndices.size());
+	PassIf(texcoordInput->GetIndexCount() == soupCount);
+
+	// The positions are welded into the grid vertices, in the order of their first use.
+	UInt32List valueRemap;
+	PassIf(FCDGeometryPolygonsTools::WeldSource(mesh, positionSource, tolerance, &valueRemap));
+	PassIf(positionSource->GetValueCount() == gridSize * gridSize);
+	PassIf(valueRemap.size() == soupCount);
+	uint32 nextValue = 0;
+	for (size_t i = 0; i < soupCount; ++i)
+	{
+		PassIf(valueRemap[i] <= nextValue);
+		if (valueRemap[i] == nextValue) ++nextValue;
+		PassIf(positionInput->GetIndices()[i] == valueRemap[i]);
+		const float* welded = positionSource->GetData() + 3 * valueRemap[i];
+		for (size_t k = 0; k < 3; ++k) PassIf(IsEquivalent(welded[k], positions[3 * i + k], tolerance));
+	}
+
+	// The texture coordinates keep their own indices, at the former offset.
+	PassIf(positionInput->GetOffset() != texcoordInput->GetOffset());
+	PassIf(texcoordInput->GetIndexCount() == soupCount);
+	PassIf(memcmp(texcoordInput->GetIndices(), soupIndices.begin(), sizeof(uint32) * soupCount) == 0);
+
+	// Welding again changes nothing, and distinct texture coordinates are left alone.
+	PassIf(FCDGeometryPolygonsTools::WeldSource(mesh, positionSource, tolerance, &valueRemap));
+	PassIf(positionSource->GetValueCount() == gridSize * gridSize);
+	PassIf(FCDGeometryPolygonsTools::WeldSource(mesh, texcoordSource, 0.5f));
+	PassIf(texcoordSource->GetValueCount() == soupCount);
+	FailIf(FCDGeometryPolygonsTools::WeldSource(mesh, positionSource, 0.0f));
+
+TESTSUITE_TEST(5, GenerateTextureTangentBasis)
+	// A flat grid, with its texture mirrored on its right half, spread over several chunks of faces.
+	// The tangents are generated on one and on three threads, for both conventions.
+	FUObjectRef<FCDocument> document = FCollada::NewTopDocument();
+	const uint32 gridSize = 41, mirror = gridSize / 2;
+	FloatList positions, texcoords, normals;
+	for (uint32 y = 0; y < gridSize; ++y)
+	{
+		for (uint32 x = 0; x < gridSize; ++x)
+		{
+			positions.push_back((float) x); positions.push_back((float) y); positions.push_back(0.0f);
+			texcoords.push_back((float) (x > mirror ? x - mirror : mirror - x) / (float) gridSize); texcoords.push_back((float) y / (float) gridSize);
+		}
+	}
+	normals.push_back(0.0f); normals.push_back(0.0f); normals.push_back(1.0f);
+	UInt32List positionIndices;
+	for (uint32 y = 0; y + 1 < gridSize; ++y)
+	{
+		for (uint32 x = 0; x + 1 < gridSize; ++x)
+		{
+			uint32 v0 = y * gridSize + x, v1 = v0 + 1, v2 = v0 + gridSize, v3 = v2 + 1;
+			positionIndices.push_back(v0); positionIndices.push_back(v1); positionIndices.push_back(v2);
+			positionIndices.push_back(v1); positionIndices.push_back(v3); positionIndices.push_back(v2);
+		}
+	}
+	UInt32List normalIndices(positionIndices.size(), 0);
+
+	FCDGeometryMesh* meshes[4];
+	for (size_t m = 0; m < 4; ++m)
+	{
+		FCDGeometryMesh* mesh = meshes[m] = document->GetGeometryLibrary()->AddEntity()->CreateMesh();
+		FCDGeometrySource* positionSource = mesh->AddVertexSource(FUDaeGeometryInput::POSITION);
+		positionSource->SetData(positions, 3);
+		FCDGeometrySource* normalSource = mesh->AddSource(FUDaeGeometryInput::NORMAL);
+		normalSource->SetData(normals, 3);
+		FCDGeometrySource* texcoordSource = mesh->AddSource(FUDaeGeometryInput::TEXCOORD);
+		texcoordSource->SetData(texcoords, 2);
+		FCDGeometryPolygons* polygons = mesh->AddPolygons();
+		polygons->AddInput(normalSource, 1);
+		polygons->AddInput(texcoordSource, 2);
+		for (size_t f = 0; f < positionIndices.size() / 3; ++f) polygons->AddFaceVertexCount(3);
+		polygons->FindInput(positionSource)->SetIndices(positionIndices.begin(), positionIndices.size());
+		polygons->FindInput(normalSource)->SetIndices(normalIndices.begin(), normalIndices.size());
+		polygons->FindInput(texcoordSource)->SetIndices(positionIndices.begin(), positionIndices.size());
+		FCDGeometryPolygonsTools::TangentBasisConvention convention = (m < 2) ? FCDGeometryPolygonsTools::TANGENT_BASIS_AVERAGED : FCDGeometryPolygonsTools::TANGENT_BASIS_MIKKTSPACE;
+		FCDGeometryPolygonsTools::GenerateTextureTangentBasis(mesh, texcoordSource, true, convention, (m % 2 == 0) ? 1 : 3);
+	}
+
+	// The results do not depend on the number of threads.
+	for (size_t m = 0; m < 4; m += 2)
+	{
+		for (size_t s = 0; s < 2; ++s)
+		{
+			FUDaeGeometryInput::Semantic type = (s == 0) ? FUDaeGeometryInput::TEXTANGENT : FUDaeGeometryInput::TEXBINORMAL;
+			const FCDGeometrySource* single = meshes[m]->FindSourceByType(type);
+			const FCDGeometrySource* parallel = meshes[m + 1]->FindSourceByType(type);
+			FailIf(single == nullptr || parallel == nullptr);
+			PassIf(single->GetDataCount() == parallel->GetDataCount() && single->GetStride() == parallel->GetStride());
+			PassIf(memcmp(single->GetData(), parallel->GetData(), sizeof(float) * single->GetDataCount()) == 0);
+			const FCDGeometryPolygonsInput* singleInput = meshes[m]->GetPolygons(0)->FindInput(single);
+			const FCDGeometryPolygonsInput* parallelInput = meshes[m + 1]->GetPolygons(0)->FindInput(parallel);
+			PassIf(singleInput->GetIndexCount() == positionIndices.size() && parallelInput->GetIndexCount() == positionIndices.size());
+			PassIf(memcmp(singleInput->GetIndices(), parallelInput->GetIndices(), sizeof(uint32) * positionIndices.size()) == 0);
+		}
+	}
+
+	// The averaged tangents are normalized.
+	const FCDGeometrySource* tangents = meshes[0]->FindSourceByType(FUDaeGeometryInput::TEXTANGENT);
+	PassIf(tangents->GetStride() == 3);
+	for (size_t t = 0; t < tangents->GetValueCount(); ++t) PassIf(IsEquivalent(FMVector3(tangents->GetData() + 3 * t).Length(), 1.0f));
+
+	// The MikkTSpace tangents follow the texture, with their handedness, and the binormals are all along Y.
+	tangents = meshes[2]->FindSourceByType(FUDaeGeometryInput::TEXTANGENT);
+	const FCDGeometrySource* binormals = meshes[2]->FindSourceByType(FUDaeGeometryInput::TEXBINORMAL);
+	PassIf(tangents->GetStride() == 4 && tangents->GetValueCount() == 2);
+	PassIf(binormals->GetStride() == 3 && binormals->GetValueCount() == 1);
+	PassIf(IsEquivalent(FMVector3(binormals->GetData()), FMVector3::YAxis));
+	const uint32* tangentIndices = meshes[2]->GetPolygons(0)->FindInput(tangents)->GetIndices();
+	for (size_t i = 0; i < positionIndices.size(); ++i)
+	{
+		const float* tangent = tangents->GetData() + 4 * tangentIndices[i];
+		PassIf(IsEquivalent(tangent[0] * tangent[3], 1.0f) && IsEquivalent(tangent[1], 0.0f) && IsEquivalent(tangent[2], 0.0f));
+		const uint32* face = positionIndices.begin() + (i - i % 3);
+		uint32 column = min(face[0] % gridSize, min(face[1] % gridSize, face[2] % gridSize));
+		PassIf(IsEquivalent(tangent[3], (column >= mirror) ? 1.0f : -1.0f));
+	}
+
 TESTSUITE_END
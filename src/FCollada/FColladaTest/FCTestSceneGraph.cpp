@@ -8,8 +8,20 @@
 
 #include "StdAfx.h"
 #include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDGeometry.h"
+#include "FCDocument/FCDLibrary.h"
 #include "FCDocument/FCDSceneNode.h"
 #include "FCDocument/FCDSceneNodeIterator.h"
+#include "FCDocument/FCDSceneNodeTools.h"
+#include "FCDocument/FCDTransform.h"
+
+// Computes the world transform of a scene node without the cached transforms.
+static FMMatrix44 ComputeWorldTransform(const FCDSceneNode* node)
+{
+	FMMatrix44 world = node->ToMatrix();
+	for (node = node->GetParent(); node != nullptr; node = node->GetParent()) world = node->ToMatrix() * world;
+	return world;
+}
 
 TESTSUITE_START(FCDSceneNode)
 
@@ -76,5 +88,111 @@ TESTSUITE_TEST(0, Iterator)
 	++it4;
 	PassIf(it4.IsDone());
 
+TESTSUITE_TEST(1, FindDaeId)
+	FUObjectRef<FCDocument> doc = FCollada::NewTopDocument();
+	FCDSceneNode* top = doc->AddVisualScene();
+	top->SetDaeId("top");
+	FCDSceneNode* child = top->AddChildNode();
+	child->SetDaeId("child");
+	FCDGeometry* geometry = doc->GetGeometryLibrary()->AddEntity();
+	geometry->SetDaeId("mesh");
+
+	// The child nodes are found as well as the library entities, only with their own type.
+	PassIf(doc->FindSceneNode("top") == top);
+	PassIf(doc->FindSceneNode("child") == child);
+	PassIf(doc->FindVisualScene("child") == child);
+	PassIf(doc->FindGeometry("mesh") == geometry);
+	PassIf(doc->FindEntity("mesh") == geometry);
+	PassIf(doc->FindEntity("child") == child);
+	PassIf(doc->FindGeometry("child") == nullptr);
+	PassIf(doc->FindSceneNode("mesh") == nullptr);
+	PassIf(doc->FindEntity("unknown") == nullptr);
+
+	// Renaming an entity moves it within the map of unique ids.
+	child->SetDaeId("renamed");
+	PassIf(doc->FindSceneNode("child") == nullptr);
+	PassIf(doc->FindSceneNode("renamed") == child);
+
+	// A duplicate id is made unique and the original entity is still found.
+	FCDSceneNode* duplicate = top->AddChildNode();
+	fm::string duplicateId = "renamed";
+	duplicate->SetDaeId(duplicateId);
+	PassIf(duplicateId != "renamed");
+	PassIf(doc->FindSceneNode("renamed") == child);
+	PassIf(doc->FindSceneNode(duplicateId.c_str()) == duplicate);
+
+	// An entity whose id was never made unique is found with its default id.
+	FCDGeometry* unnamed = doc->GetGeometryLibrary()->AddEntity();
+	PassIf(doc->FindGeometry("Geometry") == unnamed);
+	PassIf(unnamed->GetDaeId() == "Geometry");
+
+	// Released entities are no longer found.
+	SAFE_RELEASE(child);
+	PassIf(doc->FindSceneNode("renamed") == nullptr);
+	PassIf(doc->FindSceneNode(duplicateId.c_str()) == duplicate);
+	SAFE_RELEASE(geometry);
+	PassIf(doc->FindGeometry("mesh") == nullptr);
+	PassIf(doc->FindEntity("mesh") == nullptr);
+
+TESTSUITE_TEST(2, WorldTransforms)
+	FUObjectRef<FCDocument> doc = FCollada::NewTopDocument();
+	FCDSceneNode* top = doc->AddVisualScene();
+	FCDSceneNode* arm = top->AddChildNode();
+	FCDSceneNode* hand = arm->AddChildNode();
+	FCDSceneNode* other = top->AddChildNode();
+	FCDTTranslation* topTranslation = (FCDTTranslation*) top->AddTransform(FCDTransform::TRANSLATION);
+	topTranslation->SetTranslation(1.0f, 2.0f, 3.0f);
+	FCDTRotation* armRotation = (FCDTRotation*) arm->AddTransform(FCDTransform::ROTATION);
+	armRotation->SetRotation(FMVector3::XAxis, 30.0f);
+	((FCDTTranslation*) arm->AddTransform(FCDTransform::TRANSLATION))->SetTranslation(0.0f, 4.0f, 0.0f);
+	((FCDTScale*) hand->AddTransform(FCDTransform::SCALE))->SetScale(2.0f, 2.0f, 2.0f);
+	FCDTTranslation* otherTranslation = (FCDTTranslation*) other->AddTransform(FCDTransform::TRANSLATION);
+	otherTranslation->SetTranslation(-5.0f, 0.0f, 0.0f);
+	PassIf(IsEquivalent(hand->CalculateWorldTransform(), ComputeWorldTransform(hand)));
+	PassIf(IsEquivalent(arm->CalculateLocalTransform(), arm->ToMatrix()));
+
+	// Modifying a transform invalidates the world transforms of the descendants.
+	topTranslation->SetTranslation(0.0f, -1.0f, 0.0f);
+	PassIf(IsEquivalent(hand->CalculateWorldTransform(), ComputeWorldTransform(hand)));
+	PassIf(IsEquivalent(other->CalculateWorldTransform().GetTranslation(), FMVector3(-5.0f, -1.0f, 0.0f)));
+	armRotation->GetAngle() = 60.0f;
+	armRotation->SetValueChange();
+	PassIf(IsEquivalent(hand->CalculateWorldTransform(), ComputeWorldTransform(hand)));
+	PassIf(IsEquivalent(other->CalculateWorldTransform().GetTranslation(), FMVector3(-5.0f, -1.0f, 0.0f)));
+
+	// So do the releases of transforms and the changes of parent.
+	SAFE_RELEASE(armRotation);
+	PassIf(IsEquivalent(hand->CalculateWorldTransform(), ComputeWorldTransform(hand)));
+	arm->RemoveChildNode(hand);
+	PassIf(IsEquivalent(hand->CalculateWorldTransform(), hand->ToMatrix()));
+	other->AddChildNode(hand);
+	PassIf(IsEquivalent(hand->CalculateWorldTransform(), ComputeWorldTransform(hand)));
+	SAFE_RELEASE(topTranslation);
+	PassIf(IsEquivalent(hand->CalculateWorldTransform(), ComputeWorldTransform(hand)));
+
+	// The bulk update processes all the levels of a larger hierarchy.
+	FCDSceneNode* scene = doc->AddVisualScene();
+	size_t nodeCount = 1;
+	fm::pvector<FCDSceneNode> level;
+	level.push_back(scene);
+	for (size_t depth = 0; depth < 4; ++depth)
+	{
+		fm::pvector<FCDSceneNode> nextLevel;
+		for (size_t n = 0; n < level.size(); ++n)
+		{
+			for (size_t c = 0; c < 8; ++c, ++nodeCount)
+			{
+				FCDSceneNode* child = level[n]->AddChildNode();
+				((FCDTTranslation*) child->AddTransform(FCDTransform::TRANSLATION))->SetTranslation((float) c, (float) depth, 1.0f);
+				((FCDTRotation*) child->AddTransform(FCDTransform::ROTATION))->SetRotation(FMVector3::YAxis, (float) (n + c));
+				nextLevel.push_back(child);
+			}
+		}
+		level.clear();
+		level.insert(level.end(), nextLevel.begin(), nextLevel.end());
+	}
+	PassIf(FCDSceneNodeTools::UpdateWorldTransforms(scene) == nodeCount);
+	for (size_t n = 0; n < level.size(); ++n) PassIf(IsEquivalent(level[n]->CalculateWorldTransform(), ComputeWorldTransform(level[n])));
+
 TESTSUITE_END
 
@@ -2,19 +2,188 @@
 	Copyright (C) 2005-2007 Feeling Software Inc.
 	Portions of the code are:
 	Copyright (C) 2005-2007 Sony Computer Entertainment America
-	
+
 	MIT License: http://www.opensource.org/licenses/mit-license.php
 */
 
 #include "StdAfx.h"
 #include "FMAllocator.h"
+#include "FUtils/FUCriticalSection.h"
 
 namespace fm
 {
 	// default to something: static initialization!
 	AllocateFunc af = malloc;
 	FreeFunc ff = free;
-	
+
+	// Each buffer is preceded by a header, which records the arena it comes from.
+	// The header size keeps the buffers aligned on 16 bytes.
+	struct BufferHeader
+	{
+		Arena* arena; // nullptr for the buffers allocated from the heap.
+		size_t sizeClass;
+	};
+	static const size_t headerSize = 16;
+
+	// The arenas serve the buffers of up to 1,024 bytes, in size classes of 16 bytes.
+	static const size_t sizeClassGranularity = 16;
+	static const size_t sizeClassCount = 64;
+	static const size_t arenaChunkSize = 256 * 1024;
+
+	// The released buffers are linked through their first pointer.
+	struct BufferList
+	{
+		uint8* first;
+		uint8* last;
+
+		inline void Push(uint8* buffer) { *(uint8**) buffer = first; if (first == nullptr) last = buffer; first = buffer; }
+		inline uint8* Pop() { uint8* buffer = first; first = *(uint8**) buffer; if (first == nullptr) last = nullptr; return buffer; }
+		inline void Splice(BufferList& other) { if (other.first == nullptr) return; *(uint8**) other.last = first; if (first == nullptr) last = other.last; first = other.first; other.first = other.last = nullptr; }
+	};
+
+	// The state of the arena current on a thread. The thread allocates and releases
+	// the buffers of its arena through this cache, without entering its critical section.
+	struct ArenaCache
+	{
+		Arena* arena;
+		intptr_t bufferCountChange; // Not yet counted by the arena.
+		uint8* chunkCursor;
+		uint8* chunkEnd;
+		BufferList freeBuffers[sizeClassCount + 1];
+	};
+	static thread_local ArenaCache currentCache;
+
+	class Arena
+	{
+	public:
+		FUCriticalSection criticalSection;
+		bool owned;
+		size_t cacheCount;
+		intptr_t bufferCount;
+		uint8* chunks; // Linked through their first pointer.
+		uint8* spareChunkCursor; // The unused end of a chunk, left by a cache.
+		uint8* spareChunkEnd;
+		BufferList freeBuffers[sizeClassCount + 1];
+
+		Arena()
+		:	owned(true), cacheCount(0), bufferCount(0)
+		,	chunks(nullptr), spareChunkCursor(nullptr), spareChunkEnd(nullptr)
+		{
+			for (size_t i = 0; i <= sizeClassCount; ++i) freeBuffers[i].first = freeBuffers[i].last = nullptr;
+		}
+
+		~Arena()
+		{
+			while (chunks != nullptr)
+			{
+				uint8* next = *(uint8**) chunks;
+				(*ff)(chunks);
+				chunks = next;
+			}
+		}
+
+		// The arena is freed once its owner, its caches and its buffers are all gone.
+		inline bool IsUnused() const { return !owned && cacheCount == 0 && bufferCount == 0; }
+
+		void Attach(ArenaCache& cache)
+		{
+			criticalSection.Enter();
+			++cacheCount;
+			cache.chunkCursor = spareChunkCursor;
+			cache.chunkEnd = spareChunkEnd;
+			spareChunkCursor = spareChunkEnd = nullptr;
+			criticalSection.Leave();
+			cache.arena = this;
+			cache.bufferCountChange = 0;
+			for (size_t i = 0; i <= sizeClassCount; ++i) cache.freeBuffers[i].first = cache.freeBuffers[i].last = nullptr;
+		}
+
+		void Detach(ArenaCache& cache)
+		{
+			criticalSection.Enter();
+			bufferCount += cache.bufferCountChange;
+			if (owned)
+			{
+				for (size_t i = 0; i <= sizeClassCount; ++i) freeBuffers[i].Splice(cache.freeBuffers[i]);
+				if (cache.chunkEnd - cache.chunkCursor > spareChunkEnd - spareChunkCursor)
+				{
+					spareChunkCursor = cache.chunkCursor;
+					spareChunkEnd = cache.chunkEnd;
+				}
+			}
+			--cacheCount;
+			bool isUnused = IsUnused();
+			criticalSection.Leave();
+			cache.arena = nullptr;
+			if (isUnused) delete this;
+		}
+
+		// Refills a cache with the released buffers of the arena, or with a new chunk.
+		bool Refill(ArenaCache& cache, size_t sizeClass)
+		{
+			criticalSection.Enter();
+			cache.freeBuffers[sizeClass].Splice(freeBuffers[sizeClass]);
+			if (cache.freeBuffers[sizeClass].first == nullptr)
+			{
+				uint8* chunk = (uint8*) (*af)(arenaChunkSize);
+				if (chunk == nullptr) { criticalSection.Leave(); return false; }
+				*(uint8**) chunk = chunks;
+				chunks = chunk;
+				cache.chunkCursor = chunk + headerSize;
+				cache.chunkEnd = chunk + arenaChunkSize;
+			}
+			criticalSection.Leave();
+			return true;
+		}
+
+		// Releases a buffer from a thread where the arena is not current.
+		void Release(uint8* buffer, size_t sizeClass)
+		{
+			criticalSection.Enter();
+			if (owned) freeBuffers[sizeClass].Push(buffer);
+			--bufferCount;
+			bool isUnused = IsUnused();
+			criticalSection.Leave();
+			if (isUnused) delete this;
+		}
+
+		void ReleaseOwnership()
+		{
+			criticalSection.Enter();
+			owned = false;
+			for (size_t i = 0; i <= sizeClassCount; ++i) freeBuffers[i].first = freeBuffers[i].last = nullptr;
+			bool isUnused = IsUnused();
+			criticalSection.Leave();
+			if (isUnused) delete this;
+		}
+	};
+
+	static uint8* AllocateFromCache(ArenaCache& cache, size_t sizeClass)
+	{
+		uint8* buffer;
+		size_t size = headerSize + sizeClass * sizeClassGranularity;
+		if (cache.freeBuffers[sizeClass].first != nullptr)
+		{
+			buffer = cache.freeBuffers[sizeClass].Pop();
+		}
+		else if (cache.chunkCursor != nullptr && (size_t) (cache.chunkEnd - cache.chunkCursor) >= size)
+		{
+			buffer = cache.chunkCursor;
+			cache.chunkCursor += size;
+		}
+		else
+		{
+			if (!cache.arena->Refill(cache, sizeClass)) return nullptr;
+			return AllocateFromCache(cache, sizeClass);
+		}
+		++cache.bufferCountChange;
+
+		BufferHeader* header = (BufferHeader*) buffer;
+		header->arena = cache.arena;
+		header->sizeClass = sizeClass;
+		return buffer + headerSize;
+	}
+
 	void SetAllocationFunctions(AllocateFunc a, FreeFunc f)
 	{
 		af = a;
@@ -25,12 +194,63 @@ namespace fm
 	// always allocating/releasing memory from the same heap.
 	void* Allocate(size_t byteCount)
 	{
-		return (*af)(byteCount);
+		size_t sizeClass = max((byteCount + sizeClassGranularity - 1) / sizeClassGranularity, (size_t) 1);
+		ArenaCache& cache = currentCache;
+		if (cache.arena != nullptr && sizeClass <= sizeClassCount) return AllocateFromCache(cache, sizeClass);
+
+		uint8* buffer = (uint8*) (*af)(byteCount + headerSize);
+		if (buffer == nullptr) return nullptr;
+		BufferHeader* header = (BufferHeader*) buffer;
+		header->arena = nullptr;
+		header->sizeClass = 0;
+		return buffer + headerSize;
 	}
 
 	void Release(void* buffer)
 	{
-		(*ff)(buffer);
+		if (buffer == nullptr) return;
+		uint8* start = (uint8*) buffer - headerSize;
+		const BufferHeader* header = (const BufferHeader*) start;
+		Arena* arena = header->arena;
+		if (arena == nullptr)
+		{
+			(*ff)(start);
+			return;
+		}
+
+		ArenaCache& cache = currentCache;
+		if (cache.arena == arena)
+		{
+			cache.freeBuffers[header->sizeClass].Push(start);
+			--cache.bufferCountChange;
+		}
+		else arena->Release(start, header->sizeClass);
+	}
+
+	Arena* CreateArena()
+	{
+		return new Arena();
 	}
-};
 
+	void ReleaseArena(Arena* arena)
+	{
+		if (arena != nullptr) arena->ReleaseOwnership();
+	}
+
+	Arena* GetCurrentArena()
+	{
+		return currentCache.arena;
+	}
+
+	Arena* SetCurrentArena(Arena* arena)
+	{
+		ArenaCache& cache = currentCache;
+		Arena* previousArena = cache.arena;
+		if (arena != previousArena)
+		{
+			if (previousArena != nullptr) previousArena->Detach(cache);
+			if (arena != nullptr) arena->Attach(cache);
+		}
+		return previousArena;
+	}
+};
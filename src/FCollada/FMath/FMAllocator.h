@@ -44,9 +44,62 @@ namespace fm
 	FCOLLADA_EXPORT void* Allocate(size_t byteCount);
 
 	/** Releases a memory buffer.
+		The buffer may come from the heap or from an arena.
 		@param buffer The memory buffer to release. */
 	FCOLLADA_EXPORT void Release(void* buffer);
 
+	/** A memory arena.
+		While an arena is current on a thread, the small buffers allocated by
+		that thread are taken from the arena: from recycled buffers of the same
+		size class, or from large memory chunks. The larger buffers still come
+		from the allocation function.
+		A thread allocates and releases the buffers of its current arena through
+		a per-thread cache, without locking. The other threads release them through
+		the critical section of the arena. Releasing a buffer never returns memory
+		to the heap: an arena frees all its chunks at once, when its owner has
+		released it and when all its buffers are released, in any order.
+		The arena functions are thread-safe. */
+	class Arena;
+
+	/** Creates a memory arena.
+		@return The new arena, owned by the caller. */
+	FCOLLADA_EXPORT Arena* CreateArena();
+
+	/** Releases the caller's ownership of a memory arena.
+		The released buffers of the arena are no longer recycled and its
+		chunks are freed as soon as its last buffer is released and
+		it is no longer current on any thread.
+		@param arena The arena. */
+	FCOLLADA_EXPORT void ReleaseArena(Arena* arena);
+
+	/** Retrieves the arena current on the calling thread.
+		@return The current arena. This pointer is nullptr when the
+			buffers are allocated from the heap. */
+	FCOLLADA_EXPORT Arena* GetCurrentArena();
+
+	/** Sets the arena current on the calling thread.
+		@param arena The arena. Set this pointer to nullptr to allocate the
+			buffers from the heap.
+		@return The former current arena. */
+	FCOLLADA_EXPORT Arena* SetCurrentArena(Arena* arena);
+
+	/** Makes an arena current on the calling thread, for the lifetime of the scope. */
+	class ArenaScope
+	{
+	private:
+		Arena* previousArena;
+		bool active;
+
+	public:
+		/** Constructor.
+			@param arena The arena. When this pointer is nullptr,
+				the current arena is left unchanged. */
+		ArenaScope(Arena* arena) : previousArena(nullptr), active(arena != nullptr) { if (active) previousArena = SetCurrentArena(arena); }
+
+		/** Destructor. Restores the former current arena. */
+		~ArenaScope() { if (active) SetCurrentArena(previousArena); }
+	};
+
 	/** Construct the object at a given pointer.
 		@param o A pointer to the object. */
 	template <class Type1>
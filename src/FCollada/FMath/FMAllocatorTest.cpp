@@ -0,0 +1,52 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#include "StdAfx.h"
+#include "FMAllocator.h"
+#include "FUtils/FUTestBed.h"
+
+////////////////////////////////////////////////////////////////////////
+TESTSUITE_START(FMAllocator)
+
+TESTSUITE_TEST(0, Arena)
+	PassIf(fm::GetCurrentArena() == nullptr);
+	fm::Arena* arena = fm::CreateArena();
+	void* small,* recycled,* large;
+	fm::vector<uint32> values;
+	{
+		fm::ArenaScope scope(arena);
+		PassIf(fm::GetCurrentArena() == arena);
+
+		// A null arena leaves the current arena unchanged.
+		{
+			fm::ArenaScope nullScope(nullptr);
+			PassIf(fm::GetCurrentArena() == arena);
+		}
+
+		// The released small buffers are recycled in their size class.
+		small = fm::Allocate(40);
+		PassIf(small != nullptr && ((size_t) small % 16) == 0);
+		fm::Release(small);
+		recycled = fm::Allocate(33);
+		PassIf(recycled == small);
+		large = fm::Allocate(64 * 1024);
+		PassIf(large != nullptr && ((size_t) large % 16) == 0);
+		for (uint32 i = 0; i < 8; ++i) values.push_back(i);
+	}
+	PassIf(fm::GetCurrentArena() == nullptr);
+
+	// The buffers of the arena may outlive its scope and its owner.
+	for (uint32 i = 8; i < 1000; ++i) values.push_back(i);
+	fm::ReleaseArena(arena);
+	for (uint32 i = 0; i < 1000; ++i) FailIf(values[i] != i);
+	memset(recycled, 0xFF, 33);
+	fm::Release(recycled);
+	fm::Release(large);
+	values.clear();
+
+TESTSUITE_END
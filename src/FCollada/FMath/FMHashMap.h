@@ -0,0 +1,289 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/**
+	@file FMHashMap.h
+	The file contains the hash map class, an unordered map with constant-time look-ups.
+ */
+
+#ifndef _FM_HASH_MAP_H_
+#define _FM_HASH_MAP_H_
+
+#ifndef _FM_ARRAY_H_
+#include "FMath/FMArray.h"
+#endif // _FM_ARRAY_H_
+#ifndef _FM_TREE_H_
+#include "FMath/FMTree.h"
+#endif // _FM_TREE_H_
+
+namespace fm
+{
+	template <class CH> class stringT;
+
+	/** Hashes a buffer of bytes, using the 32-bit FNV-1a function.
+		@param buffer The bytes to hash.
+		@param byteCount The number of bytes to hash.
+		@return The hash value. */
+	inline uint32 HashBytes(const void* buffer, size_t byteCount)
+	{
+		const uint8* bytes = (const uint8*) buffer;
+		uint32 hash = 2166136261u;
+		for (size_t i = 0; i < byteCount; ++i) { hash ^= bytes[i]; hash *= 16777619u; }
+		return hash;
+	}
+
+	/**
+		The default hash function of the hash map.
+		Hashes the bytes of the key: this is valid for the integers, the pointers
+		and the structures without padding and without pointed-to data.
+		@ingroup FMath
+	*/
+	template <class KEY>
+	class hash
+	{
+	public:
+		/** Hashes a key.
+			@param key The key to hash.
+			@return The hash value. */
+		inline uint32 operator()(const KEY& key) const { return HashBytes(&key, sizeof(KEY)); }
+	};
+
+	/**
+		The hash function of the strings: hashes the string characters.
+		@ingroup FMath
+	*/
+	template <class CH>
+	class hash< fm::stringT<CH> >
+	{
+	public:
+		/** Hashes a string.
+			@param key The string to hash.
+			@return The hash value. */
+		inline uint32 operator()(const fm::stringT<CH>& key) const { return HashBytes(key.c_str(), key.length() * sizeof(CH)); }
+	};
+
+	/**
+		An unordered map with constant-time look-ups.
+
+		The key/data pairs are kept together in a dense array, in insertion order
+		until a pair is erased: erasing a pair moves the last pair in its place.
+		The look-ups go through a separate open-addressing table of pair indices,
+		with linear probing, that holds the hash value of each pair.
+		The iterators are pointers to the pairs: inserting or erasing
+		a pair invalidates all the iterators.
+
+		Intentionally has an interface similar to the tree class.
+
+		@ingroup FMath
+	*/
+	template <class KEY, class DATA, class HASH = fm::hash<KEY> >
+	class hash_map
+	{
+	public:
+		typedef fm::pair<KEY, DATA> pair; /**< A key/data pair. */
+		typedef pair* iterator; /**< An iterator over the pairs. */
+		typedef const pair* const_iterator; /**< A constant iterator over the pairs. */
+
+	private:
+		// The table slots hold one more than the pair index, or these two markers.
+		enum { EMPTY_SLOT = 0, ERASED_SLOT = ~0u };
+		struct slot { uint32 hash; uint32 index; };
+
+		fm::vector<pair, false> pairs;
+		slot* slots;
+		size_t slotCount; // Always zero or a power of two.
+		size_t usedSlotCount; // The pairs and the erased slots.
+		HASH hasher;
+
+	public:
+		/** Constructor. */
+		hash_map() : slots(nullptr), slotCount(0), usedSlotCount(0) {}
+
+		/** Copy constructor.
+			@param copy The hash map to copy. */
+		hash_map(const hash_map& copy) : pairs(copy.pairs), slots(nullptr), slotCount(0), usedSlotCount(0) { rehash(pairs.size()); }
+
+		/** Destructor. */
+		~hash_map() { if (slots != nullptr) fm::Release(slots); }
+
+		/** Retrieves the first pair.
+			@return An iterator to the first pair. */
+		inline iterator begin() { return pairs.begin(); }
+		inline const_iterator begin() const { return pairs.begin(); } /**< See above. */
+
+		/** Retrieves the iterator past the last pair.
+			@return The end iterator. */
+		inline iterator end() { return pairs.end(); }
+		inline const_iterator end() const { return pairs.end(); } /**< See above. */
+
+		/** Retrieves the pair with the given key.
+			@param key The key to look for.
+			@return The pair with this key. The end iterator if no pair has this key. */
+		inline iterator find(const KEY& key)
+		{
+			size_t s = find_slot(key, hasher(key));
+			return (s < slotCount) ? pairs.begin() + slots[s].index - 1 : end();
+		}
+		inline const_iterator find(const KEY& key) const { return const_cast<hash_map*>(this)->find(key); } /**< See above. */
+
+		/** Retrieves whether a pair has the given key.
+			@param key The key to look for.
+			@return Whether a pair has this key. */
+		inline bool contains(const KEY& key) const { return find(key) != end(); }
+
+		/** Inserts a pair, or overwrites the data of the pair with the same key.
+			@param key The key of the pair.
+			@param data The data of the pair.
+			@return The inserted pair. */
+		iterator insert(const KEY& key, const DATA& data)
+		{
+			uint32 h = hasher(key);
+			size_t s = find_slot(key, h);
+			if (s < slotCount)
+			{
+				pair* p = pairs.begin() + slots[s].index - 1;
+				p->second = data;
+				return p;
+			}
+
+			// Keep the table at most three quarters full, counting the erased slots.
+			if ((usedSlotCount + 1) * 4 > slotCount * 3) rehash(pairs.size() + 1);
+
+			size_t mask = slotCount - 1;
+			for (s = h & mask; slots[s].index != EMPTY_SLOT && slots[s].index != ERASED_SLOT; s = (s + 1) & mask) {}
+			if (slots[s].index == EMPTY_SLOT) ++usedSlotCount;
+			pairs.push_back(pair(key, data));
+			slots[s].hash = h;
+			slots[s].index = (uint32) pairs.size();
+			return pairs.end() - 1;
+		}
+
+		/** Retrieves the data of the pair with the given key.
+			A pair is inserted, with the default data, if no pair has this key.
+			@param key The key of the pair.
+			@return The data of the pair. */
+		inline DATA& operator[](const KEY& k) { iterator it = find(k); if (it != end()) return it->second; else { DATA d = DATA(); return insert(k, d)->second; } }
+
+		/** Erases the pair with the given key, if there is one.
+			@param key The key of the pair to erase. */
+		void erase(const KEY& key)
+		{
+			size_t s = find_slot(key, hasher(key));
+			if (s < slotCount) erase_slot(s);
+		}
+
+		/** Erases a pair.
+			@param it An iterator to the pair to erase. */
+		inline void erase(iterator it)
+		{
+			FUAssert(it >= begin() && it < end(), return);
+			erase_slot(find_index_slot(hasher(it->first), (uint32) (it - begin()) + 1));
+		}
+
+		/** Retrieves whether the hash map is empty.
+			@return Whether the hash map is empty. */
+		inline bool empty() const { return pairs.empty(); }
+
+		/** Retrieves the number of pairs.
+			@return The number of pairs. */
+		inline size_t size() const { return pairs.size(); }
+
+		/** Pre-allocates the memory for a number of pairs.
+			@param count The number of pairs. */
+		void reserve(size_t count)
+		{
+			if (count > pairs.size()) pairs.reserve(count);
+			if (count * 4 > slotCount * 3) rehash(count);
+		}
+
+		/** Erases all the pairs and releases the memory. */
+		void clear()
+		{
+			pairs.clear();
+			if (slots != nullptr) fm::Release(slots);
+			slots = nullptr;
+			slotCount = usedSlotCount = 0;
+		}
+
+		/** Copy operator.
+			@param copy The hash map to copy.
+			@return This hash map. */
+		hash_map& operator=(const hash_map& copy)
+		{
+			if (this != &copy)
+			{
+				clear();
+				pairs = copy.pairs;
+				rehash(pairs.size());
+			}
+			return *this;
+		}
+
+	private:
+		// Returns the slot of the pair with the given key, or slotCount.
+		size_t find_slot(const KEY& key, uint32 h) const
+		{
+			if (slotCount == 0) return slotCount;
+			size_t mask = slotCount - 1;
+			for (size_t s = h & mask; slots[s].index != EMPTY_SLOT; s = (s + 1) & mask)
+			{
+				if (slots[s].index != ERASED_SLOT && slots[s].hash == h && pairs[slots[s].index - 1].first == key) return s;
+			}
+			return slotCount;
+		}
+
+		// Returns the slot that points to the given pair.
+		size_t find_index_slot(uint32 h, uint32 index) const
+		{
+			size_t mask = slotCount - 1;
+			size_t s = h & mask;
+			while (slots[s].index != index) s = (s + 1) & mask;
+			return s;
+		}
+
+		void erase_slot(size_t s)
+		{
+			uint32 index = slots[s].index;
+			slots[s].index = ERASED_SLOT;
+
+			// Move the last pair in the place of the erased pair.
+			uint32 lastIndex = (uint32) pairs.size();
+			if (index != lastIndex)
+			{
+				size_t lastSlot = find_index_slot(hasher(pairs.back().first), lastIndex);
+				slots[lastSlot].index = index;
+				pairs[index - 1] = pairs.back();
+			}
+			pairs.pop_back();
+		}
+
+		// Rebuilds the table for the given number of pairs, which drops the erased slots.
+		void rehash(size_t count)
+		{
+			size_t newSlotCount = 16;
+			while (newSlotCount * 3 < count * 4 + 4) newSlotCount *= 2;
+			if (slots != nullptr) fm::Release(slots);
+			slots = (slot*) fm::Allocate(newSlotCount * sizeof(slot));
+			memset(slots, 0, newSlotCount * sizeof(slot));
+			slotCount = newSlotCount;
+			usedSlotCount = pairs.size();
+
+			size_t mask = slotCount - 1;
+			for (size_t i = 0; i < pairs.size(); ++i)
+			{
+				uint32 h = hasher(pairs[i].first);
+				size_t s = h & mask;
+				while (slots[s].index != EMPTY_SLOT) s = (s + 1) & mask;
+				slots[s].hash = h;
+				slots[s].index = (uint32) i + 1;
+			}
+		}
+	};
+};
+
+#endif // _FM_HASH_MAP_H_
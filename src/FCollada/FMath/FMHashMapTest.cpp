@@ -0,0 +1,123 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#include "StdAfx.h"
+#include "FMHashMap.h"
+#include "FUtils/FUTestBed.h"
+
+////////////////////////////////////////////////////////////////////////
+TESTSUITE_START(FMHashMap)
+
+TESTSUITE_TEST(0, Access)
+	// Create an empty hash map.
+	fm::hash_map<uint32, bool> map;
+	PassIf(map.begin() == map.end());
+	PassIf(map.empty());
+	PassIf(map.size() == 0);
+	PassIf(map.find(35) == map.end());
+
+	// Insert a few elements and look them up.
+	fm::hash_map<uint32, bool>::iterator it = map.insert(35, false);
+	PassIf(it->first == 35 && it->second == false);
+	map.insert(15, true);
+	map.insert(25, false);
+	PassIf(map.size() == 3);
+	it = map.find(15);
+	PassIf(it != map.end() && it->first == 15 && it->second == true);
+	it = map.find(25);
+	PassIf(it != map.end() && it->first == 25 && it->second == false);
+	PassIf(map.find(20) == map.end());
+	PassIf(map.contains(35));
+	PassIf(!map.contains(36));
+
+	// Inserting an existing key overwrites its data.
+	map.insert(25, true);
+	PassIf(map.size() == 3);
+	PassIf(map.find(25)->second == true);
+	map[35] = true;
+	PassIf(map.find(35)->second == true);
+	PassIf(map[45] == false);
+	PassIf(map.size() == 4);
+
+	// The pairs are kept in insertion order.
+	static const uint32 insertionOrder[4] = { 35, 15, 25, 45 };
+	size_t index = 0;
+	for (it = map.begin(); it != map.end(); ++it, ++index)
+	{
+		PassIf(it->first == insertionOrder[index]);
+	}
+	PassIf(index == 4);
+
+	// Clear the hash map and verify that it can still be used.
+	map.clear();
+	PassIf(map.empty());
+	PassIf(map.find(35) == map.end());
+	map.insert(14, false);
+	PassIf(map.find(14) != map.end());
+	PassIf(map.size() == 1);
+
+TESTSUITE_TEST(1, Containment)
+	// Fill in enough elements to grow the table a few times.
+	fm::hash_map<uint32, uint32> map;
+	for (uint32 i = 0; i < 1000; ++i) map.insert(i * 7, i);
+	PassIf(map.size() == 1000);
+	for (uint32 i = 0; i < 1000; ++i)
+	{
+		fm::hash_map<uint32, uint32>::iterator it = map.find(i * 7);
+		FailIf(it == map.end() || it->second != i);
+		FailIf(map.contains(i * 7 + 1));
+	}
+
+	// Erase every other element: the others must still be found.
+	for (uint32 i = 0; i < 1000; i += 2) map.erase(i * 7);
+	PassIf(map.size() == 500);
+	for (uint32 i = 0; i < 1000; ++i)
+	{
+		fm::hash_map<uint32, uint32>::iterator it = map.find(i * 7);
+		if ((i & 1) == 0) { FailIf(it != map.end()); }
+		else { FailIf(it == map.end() || it->second != i); }
+	}
+
+	// Erase through an iterator, then re-insert the erased elements.
+	map.erase(map.find(7));
+	PassIf(map.size() == 499);
+	FailIf(map.contains(7));
+	for (uint32 i = 0; i < 1000; i += 2) map.insert(i * 7, i);
+	map.insert(7, 1);
+	PassIf(map.size() == 1000);
+	for (uint32 i = 0; i < 1000; ++i)
+	{
+		fm::hash_map<uint32, uint32>::iterator it = map.find(i * 7);
+		FailIf(it == map.end() || it->second != i);
+	}
+
+TESTSUITE_TEST(2, Strings)
+	// Hash the strings by their characters, not their buffers.
+	fm::hash_map<fm::string, uint32> map;
+	map.insert(fm::string("geometry"), 1);
+	map.insert(fm::string("node"), 2);
+	map.insert(fm::string(""), 3);
+	PassIf(map.size() == 3);
+	PassIf(map.find(fm::string("geometry"))->second == 1);
+	PassIf(map.find(fm::string("node"))->second == 2);
+	PassIf(map.find(fm::string(""))->second == 3);
+	PassIf(map.find(fm::string("nodes")) == map.end());
+
+	// Copy the hash map: the copy is independent.
+	fm::hash_map<fm::string, uint32> copyMap(map);
+	map.erase(fm::string("node"));
+	PassIf(map.size() == 2);
+	PassIf(!map.contains(fm::string("node")));
+	PassIf(copyMap.size() == 3);
+	PassIf(copyMap.find(fm::string("node"))->second == 2);
+	copyMap = map;
+	PassIf(copyMap.size() == 2);
+	PassIf(copyMap.find(fm::string("geometry"))->second == 1);
+	PassIf(!copyMap.contains(fm::string("node")));
+
+TESTSUITE_END
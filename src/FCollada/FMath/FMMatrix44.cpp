@@ -10,6 +10,122 @@
 #include "FMMatrix44.h"
 #include <limits>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FM_MATRIX44_SSE
+#include <xmmintrin.h>
+#endif // SSE
+
+#ifdef FM_MATRIX44_SSE
+// The matrix elements are stored one axis after the other: m[0], m[1], m[2]
+// and the translation m[3] each fill one register.
+#define FM_SHUFFLE(v1, v2, x, y, z, w) _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(w, z, y, x))
+#define FM_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps(v, v, _MM_SHUFFLE(w, z, y, x))
+
+struct MatrixColumns
+{
+	__m128 c0, c1, c2, c3;
+};
+
+static inline void LoadColumns(const FMMatrix44& mx, MatrixColumns& c)
+{
+	c.c0 = _mm_loadu_ps(mx.m[0]);
+	c.c1 = _mm_loadu_ps(mx.m[1]);
+	c.c2 = _mm_loadu_ps(mx.m[2]);
+	c.c3 = _mm_loadu_ps(mx.m[3]);
+}
+
+// Returns c0 * x + c1 * y + c2 * z + c3 * w, in the order of the scalar code.
+static inline __m128 CombineColumns(const MatrixColumns& c, const float* v)
+{
+	__m128 r = _mm_mul_ps(c.c0, _mm_load1_ps(v));
+	r = _mm_add_ps(r, _mm_mul_ps(c.c1, _mm_load1_ps(v + 1)));
+	r = _mm_add_ps(r, _mm_mul_ps(c.c2, _mm_load1_ps(v + 2)));
+	return _mm_add_ps(r, _mm_mul_ps(c.c3, _mm_load1_ps(v + 3)));
+}
+
+// Returns c0 * x + c1 * y + c2 * z, plus c3 for a coordinate.
+static inline __m128 TransformColumns(const MatrixColumns& c, const float* v, bool isCoordinate)
+{
+	__m128 r = _mm_mul_ps(c.c0, _mm_load1_ps(v));
+	r = _mm_add_ps(r, _mm_mul_ps(c.c1, _mm_load1_ps(v + 1)));
+	r = _mm_add_ps(r, _mm_mul_ps(c.c2, _mm_load1_ps(v + 2)));
+	return isCoordinate ? _mm_add_ps(r, c.c3) : r;
+}
+
+// Multiplies m1 by m2 into out, which may be either of them.
+static inline void MultiplyColumns(const MatrixColumns& c, const FMMatrix44& m2, FMMatrix44& out)
+{
+	__m128 r0 = CombineColumns(c, m2.m[0]);
+	__m128 r1 = CombineColumns(c, m2.m[1]);
+	__m128 r2 = CombineColumns(c, m2.m[2]);
+	__m128 r3 = CombineColumns(c, m2.m[3]);
+	_mm_storeu_ps(out.m[0], r0);
+	_mm_storeu_ps(out.m[1], r1);
+	_mm_storeu_ps(out.m[2], r2);
+	_mm_storeu_ps(out.m[3], r3);
+}
+
+// Stores the three first elements of a register.
+static inline void StoreVector3(float* v, __m128 r)
+{
+	_mm_storel_pi((__m64*) v, r);
+	_mm_store_ss(v + 2, _mm_movehl_ps(r, r));
+}
+
+// The inverse and the determinant split the matrix into four 2x2 blocks, | A B | C D |,
+// each held in one register, and work with their determinants and their adjugates (A#).
+struct MatrixBlocks
+{
+	__m128 A, B, C, D;
+	__m128 detA, detB, detC, detD;
+	__m128 A_B, D_C; // A#B and D#C
+	__m128 det;
+};
+
+// 2x2 block product: A * B.
+static inline __m128 BlockMultiply(__m128 a, __m128 b)
+{
+	return _mm_add_ps(_mm_mul_ps(a, FM_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(FM_SWIZZLE(a, 1, 0, 3, 2), FM_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// 2x2 block product with the first adjugate: A# * B.
+static inline __m128 BlockAdjugateMultiply(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(FM_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(FM_SWIZZLE(a, 1, 1, 2, 2), FM_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// 2x2 block product with the second adjugate: A * B#.
+static inline __m128 BlockMultiplyAdjugate(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(a, FM_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(FM_SWIZZLE(a, 1, 0, 3, 2), FM_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+static inline void SplitBlocks(const FMMatrix44& mx, MatrixBlocks& b)
+{
+	__m128 r0 = _mm_loadu_ps(mx.m[0]), r1 = _mm_loadu_ps(mx.m[1]), r2 = _mm_loadu_ps(mx.m[2]), r3 = _mm_loadu_ps(mx.m[3]);
+	b.A = _mm_movelh_ps(r0, r1);
+	b.B = _mm_movehl_ps(r1, r0);
+	b.C = _mm_movelh_ps(r2, r3);
+	b.D = _mm_movehl_ps(r3, r2);
+
+	// The block determinants: (|A|, |B|, |C|, |D|).
+	__m128 dets = _mm_sub_ps(_mm_mul_ps(FM_SHUFFLE(r0, r2, 0, 2, 0, 2), FM_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+		_mm_mul_ps(FM_SHUFFLE(r0, r2, 1, 3, 1, 3), FM_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+	b.detA = FM_SWIZZLE(dets, 0, 0, 0, 0);
+	b.detB = FM_SWIZZLE(dets, 1, 1, 1, 1);
+	b.detC = FM_SWIZZLE(dets, 2, 2, 2, 2);
+	b.detD = FM_SWIZZLE(dets, 3, 3, 3, 3);
+	b.A_B = BlockAdjugateMultiply(b.A, b.B);
+	b.D_C = BlockAdjugateMultiply(b.D, b.C);
+
+	// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+	__m128 trace = _mm_mul_ps(b.A_B, FM_SWIZZLE(b.D_C, 0, 2, 1, 3));
+	trace = _mm_add_ps(trace, FM_SWIZZLE(trace, 2, 3, 0, 1));
+	trace = _mm_add_ps(trace, FM_SWIZZLE(trace, 1, 0, 3, 2));
+	b.det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(b.detA, b.detD), _mm_mul_ps(b.detB, b.detC)), trace);
+}
+#endif // FM_MATRIX44_SSE
+
 static float __identity[] = { 1, 0, 0, 0, 0, 1, 0 ,0 ,0, 0, 1, 0, 0, 0, 0, 1 };
 FMMatrix44 FMMatrix44::Identity(__identity);
 
@@ -25,11 +141,19 @@ FMMatrix44::FMMatrix44(const double* _m)
 
 FMMatrix44& FMMatrix44::operator=(const FMMatrix44& copy)
 {
+#ifdef FM_MATRIX44_SSE
+	_mm_storeu_ps(m[0], _mm_loadu_ps(copy.m[0]));
+	_mm_storeu_ps(m[1], _mm_loadu_ps(copy.m[1]));
+	_mm_storeu_ps(m[2], _mm_loadu_ps(copy.m[2]));
+	_mm_storeu_ps(m[3], _mm_loadu_ps(copy.m[3]));
+	return *this;
+#else
 	m[0][0] = copy.m[0][0]; m[0][1] = copy.m[0][1]; m[0][2] = copy.m[0][2]; m[0][3] = copy.m[0][3];
 	m[1][0] = copy.m[1][0]; m[1][1] = copy.m[1][1]; m[1][2] = copy.m[1][2]; m[1][3] = copy.m[1][3];
 	m[2][0] = copy.m[2][0]; m[2][1] = copy.m[2][1]; m[2][2] = copy.m[2][2]; m[2][3] = copy.m[2][3];
 	m[3][0] = copy.m[3][0]; m[3][1] = copy.m[3][1]; m[3][2] = copy.m[3][2]; m[3][3] = copy.m[3][3];
 	return *this;
+#endif // FM_MATRIX44_SSE
 }
 
 void FMMatrix44::Set(const float* _m)
@@ -61,30 +185,83 @@ FMMatrix44 FMMatrix44::Transposed() const
 
 FMVector3 FMMatrix44::TransformCoordinate(const FMVector3& coordinate) const
 {
+#ifdef FM_MATRIX44_SSE
+	MatrixColumns c;
+	LoadColumns(*this, c);
+	FMVector3 out;
+	StoreVector3(&out.m_X, TransformColumns(c, &coordinate.m_X, true));
+	return out;
+#else
 	return FMVector3(
 		m[0][0] * coordinate.m_X + m[1][0] * coordinate.m_Y + m[2][0] * coordinate.m_Z + m[3][0],
 		m[0][1] * coordinate.m_X + m[1][1] * coordinate.m_Y + m[2][1] * coordinate.m_Z + m[3][1],
 		m[0][2] * coordinate.m_X + m[1][2] * coordinate.m_Y + m[2][2] * coordinate.m_Z + m[3][2]
 	);
+#endif // FM_MATRIX44_SSE
 }
 
 FMVector4 FMMatrix44::TransformCoordinate(const FMVector4& coordinate) const
 {
-	return FMVector4(
-		m[0][0] * coordinate.x + m[1][0] * coordinate.y + m[2][0] * coordinate.z + m[3][0] * coordinate.w,
-		m[0][1] * coordinate.x + m[1][1] * coordinate.y + m[2][1] * coordinate.z + m[3][1] * coordinate.w,
-		m[0][2] * coordinate.x + m[1][2] * coordinate.y + m[2][2] * coordinate.z + m[3][2] * coordinate.w,
-		m[0][3] * coordinate.x + m[1][3] * coordinate.y + m[2][3] * coordinate.z + m[3][3] * coordinate.w
-	);
+	return (*this) * coordinate;
 }
 
 FMVector3 FMMatrix44::TransformVector(const FMVector3& v) const
 {
+#ifdef FM_MATRIX44_SSE
+	MatrixColumns c;
+	LoadColumns(*this, c);
+	FMVector3 out;
+	StoreVector3(&out.m_X, TransformColumns(c, &v.m_X, false));
+	return out;
+#else
 	return FMVector3(
 		m[0][0] * v.m_X + m[1][0] * v.m_Y + m[2][0] * v.m_Z,
 		m[0][1] * v.m_X + m[1][1] * v.m_Y + m[2][1] * v.m_Z,
 		m[0][2] * v.m_X + m[1][2] * v.m_Y + m[2][2] * v.m_Z
 	);
+#endif // FM_MATRIX44_SSE
+}
+
+void FMMatrix44::TransformCoordinates(const float* coordinates, size_t count, size_t stride, float* out) const
+{
+	FUAssert(stride >= 3, return);
+#ifdef FM_MATRIX44_SSE
+	MatrixColumns c;
+	LoadColumns(*this, c);
+	for (size_t i = 0; i < count; ++i, coordinates += stride, out += stride)
+	{
+		StoreVector3(out, TransformColumns(c, coordinates, true));
+	}
+#else
+	for (size_t i = 0; i < count; ++i, coordinates += stride, out += stride)
+	{
+		float x = coordinates[0], y = coordinates[1], z = coordinates[2];
+		out[0] = m[0][0] * x + m[1][0] * y + m[2][0] * z + m[3][0];
+		out[1] = m[0][1] * x + m[1][1] * y + m[2][1] * z + m[3][1];
+		out[2] = m[0][2] * x + m[1][2] * y + m[2][2] * z + m[3][2];
+	}
+#endif // FM_MATRIX44_SSE
+}
+
+void FMMatrix44::TransformVectors(const float* vectors, size_t count, size_t stride, float* out) const
+{
+	FUAssert(stride >= 3, return);
+#ifdef FM_MATRIX44_SSE
+	MatrixColumns c;
+	LoadColumns(*this, c);
+	for (size_t i = 0; i < count; ++i, vectors += stride, out += stride)
+	{
+		StoreVector3(out, TransformColumns(c, vectors, false));
+	}
+#else
+	for (size_t i = 0; i < count; ++i, vectors += stride, out += stride)
+	{
+		float x = vectors[0], y = vectors[1], z = vectors[2];
+		out[0] = m[0][0] * x + m[1][0] * y + m[2][0] * z;
+		out[1] = m[0][1] * x + m[1][1] * y + m[2][1] * z;
+		out[2] = m[0][2] * x + m[1][2] * y + m[2][2] * z;
+	}
+#endif // FM_MATRIX44_SSE
 }
 
 static float det3x3(float a1, float a2, float a3, float b1, float b2, float b3, float c1, float c2, float c3);
@@ -177,6 +354,34 @@ static float det3x3(float a1, float a2, float a3, float b1, float b2, float b3,
 // Returns the inverse of this matrix
 FMMatrix44 FMMatrix44::Inverted() const
 {
+#ifdef FM_MATRIX44_SSE
+	// Block-wise inverse: with M = | A B | C D |, the inverse is 1/|M| * | X# Y# | Z# W# |#.
+	MatrixBlocks blocks;
+	SplitBlocks(*this, blocks);
+	__m128 X_ = _mm_sub_ps(_mm_mul_ps(blocks.detD, blocks.A), BlockMultiply(blocks.B, blocks.D_C));
+	__m128 W_ = _mm_sub_ps(_mm_mul_ps(blocks.detA, blocks.D), BlockMultiply(blocks.C, blocks.A_B));
+	__m128 Y_ = _mm_sub_ps(_mm_mul_ps(blocks.detB, blocks.C), BlockMultiplyAdjugate(blocks.D, blocks.A_B));
+	__m128 Z_ = _mm_sub_ps(_mm_mul_ps(blocks.detC, blocks.B), BlockMultiplyAdjugate(blocks.A, blocks.D_C));
+
+	// Same handling of the singular matrices as the scalar code.
+	double det = _mm_cvtss_f32(blocks.det);
+	double epsilon = std::numeric_limits<double>::epsilon();
+	if (det + epsilon >= 0.0f && det - epsilon <= 0.0f) det = FMath::Sign(det) * 0.0001f;
+	float oodet = (float) (1.0 / det);
+	__m128 scale = _mm_mul_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), _mm_set1_ps(oodet));
+	X_ = _mm_mul_ps(X_, scale);
+	Y_ = _mm_mul_ps(Y_, scale);
+	Z_ = _mm_mul_ps(Z_, scale);
+	W_ = _mm_mul_ps(W_, scale);
+
+	// Apply the adjugates while storing the blocks back.
+	FMMatrix44 b;
+	_mm_storeu_ps(b.m[0], FM_SHUFFLE(X_, Y_, 3, 1, 3, 1));
+	_mm_storeu_ps(b.m[1], FM_SHUFFLE(X_, Y_, 2, 0, 2, 0));
+	_mm_storeu_ps(b.m[2], FM_SHUFFLE(Z_, W_, 3, 1, 3, 1));
+	_mm_storeu_ps(b.m[3], FM_SHUFFLE(Z_, W_, 2, 0, 2, 0));
+	return b;
+#else
 	FMMatrix44 b;
 
 	b.m[0][0] =  det3x3(m[1][1], m[1][2], m[1][3], m[2][1], m[2][2], m[2][3], m[3][1], m[3][2], m[3][3]);
@@ -226,10 +431,16 @@ FMMatrix44 FMMatrix44::Inverted() const
 	b.m[3][3] *= oodet;
 
 	return b;
+#endif // FM_MATRIX44_SSE
 }
 
 float FMMatrix44::Determinant() const
 {
+#ifdef FM_MATRIX44_SSE
+	MatrixBlocks blocks;
+	SplitBlocks(*this, blocks);
+	return _mm_cvtss_f32(blocks.det);
+#else
 	float cofactor0 = det3x3(m[1][1], m[1][2], m[1][3], m[2][1], m[2][2],
 							 m[2][3], m[3][1], m[3][2], m[3][3]);
 	float cofactor1 = -det3x3(m[0][1], m[0][2], m[0][3], m[2][1], m[2][2],
@@ -240,11 +451,17 @@ float FMMatrix44::Determinant() const
 							  m[1][3], m[2][1], m[2][2], m[2][3]);
 	return (m[0][0] * cofactor0) + (m[1][0] * cofactor1) +
            (m[2][0] * cofactor2) + (m[3][0] * cofactor3);
+#endif // FM_MATRIX44_SSE
 }
 
 FMMatrix44 operator*(const FMMatrix44& m1, const FMMatrix44& m2)
 {
     FMMatrix44 mx;
+#ifdef FM_MATRIX44_SSE
+	MatrixColumns c;
+	LoadColumns(m1, c);
+	MultiplyColumns(c, m2, mx);
+#else
     mx.m[0][0] = m1.m[0][0] * m2.m[0][0] + m1.m[1][0] * m2.m[0][1] + m1.m[2][0] * m2.m[0][2] + m1.m[3][0] * m2.m[0][3];
     mx.m[0][1] = m1.m[0][1] * m2.m[0][0] + m1.m[1][1] * m2.m[0][1] + m1.m[2][1] * m2.m[0][2] + m1.m[3][1] * m2.m[0][3];
     mx.m[0][2] = m1.m[0][2] * m2.m[0][0] + m1.m[1][2] * m2.m[0][1] + m1.m[2][2] * m2.m[0][2] + m1.m[3][2] * m2.m[0][3];
@@ -261,16 +478,51 @@ FMMatrix44 operator*(const FMMatrix44& m1, const FMMatrix44& m2)
     mx.m[3][1] = m1.m[0][1] * m2.m[3][0] + m1.m[1][1] * m2.m[3][1] + m1.m[2][1] * m2.m[3][2] + m1.m[3][1] * m2.m[3][3];
     mx.m[3][2] = m1.m[0][2] * m2.m[3][0] + m1.m[1][2] * m2.m[3][1] + m1.m[2][2] * m2.m[3][2] + m1.m[3][2] * m2.m[3][3];
     mx.m[3][3] = m1.m[0][3] * m2.m[3][0] + m1.m[1][3] * m2.m[3][1] + m1.m[2][3] * m2.m[3][2] + m1.m[3][3] * m2.m[3][3];
+#endif // FM_MATRIX44_SSE
     return mx;
 }
 
+void MultiplyMatrices(const FMMatrix44* m1, const FMMatrix44* m2, size_t count, FMMatrix44* out)
+{
+#ifdef FM_MATRIX44_SSE
+	MatrixColumns c;
+	for (size_t i = 0; i < count; ++i)
+	{
+		LoadColumns(m1[i], c);
+		MultiplyColumns(c, m2[i], out[i]);
+	}
+#else
+	for (size_t i = 0; i < count; ++i) out[i] = m1[i] * m2[i];
+#endif // FM_MATRIX44_SSE
+}
+
+void MultiplyMatrices(const FMMatrix44& m1, const FMMatrix44* m2, size_t count, FMMatrix44* out)
+{
+#ifdef FM_MATRIX44_SSE
+	MatrixColumns c;
+	LoadColumns(m1, c);
+	for (size_t i = 0; i < count; ++i) MultiplyColumns(c, m2[i], out[i]);
+#else
+	FMMatrix44 left(m1);
+	for (size_t i = 0; i < count; ++i) out[i] = left * m2[i];
+#endif // FM_MATRIX44_SSE
+}
+
 FMVector4 operator*(const FMMatrix44& m, const FMVector4& v)
 {
+#ifdef FM_MATRIX44_SSE
+	MatrixColumns c;
+	LoadColumns(m, c);
+	FMVector4 out;
+	_mm_storeu_ps(&out.x, CombineColumns(c, &v.x));
+	return out;
+#else
 	float x = m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z + m[3][0] * v.w;
 	float y = m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z + m[3][1] * v.w;
 	float z = m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z + m[3][2] * v.w;
 	float w = m[0][3] * v.x + m[1][3] * v.y + m[2][3] * v.z + m[3][3] * v.w;
 	return FMVector4(x, y, z, w);
+#endif // FM_MATRIX44_SSE
 }
 
 FMMatrix44 operator*(float a, const FMMatrix44& m1)
@@ -121,6 +121,32 @@ public:
 		@return The FMVector3 representation of the transformed vector. */
 	FMVector3 TransformVector(const FMVector3& v) const;
 
+	/** Transforms a list of points by this matrix.
+		The points may be transformed in place.
+		@param coordinates The first point to transform. Each point is
+			three consecutive floating-point values.
+		@param count The number of points to transform.
+		@param stride The number of floating-point values from one point to the next,
+			at least three.
+		@param out The first transformed point. The values past the
+			three first values of each point are left untouched. */
+	void TransformCoordinates(const float* coordinates, size_t count, size_t stride, float* out) const;
+	inline void TransformCoordinates(const FMVector3* coordinates, size_t count, FMVector3* out) const { TransformCoordinates(&coordinates->m_X, count, sizeof(FMVector3) / sizeof(float), &out->m_X); } /**< See above. */
+	inline void TransformCoordinates(FMVector3List& coordinates) const { if (!coordinates.empty()) TransformCoordinates(coordinates.begin(), coordinates.size(), coordinates.begin()); } /**< See above. */
+
+	/** Transforms a list of vectors by this matrix: the translation is ignored.
+		The vectors may be transformed in place.
+		@param vectors The first vector to transform. Each vector is
+			three consecutive floating-point values.
+		@param count The number of vectors to transform.
+		@param stride The number of floating-point values from one vector to the next,
+			at least three.
+		@param out The first transformed vector. The values past the
+			three first values of each vector are left untouched. */
+	void TransformVectors(const float* vectors, size_t count, size_t stride, float* out) const;
+	inline void TransformVectors(const FMVector3* vectors, size_t count, FMVector3* out) const { TransformVectors(&vectors->m_X, count, sizeof(FMVector3) / sizeof(float), &out->m_X); } /**< See above. */
+	inline void TransformVectors(FMVector3List& vectors) const { if (!vectors.empty()) TransformVectors(vectors.begin(), vectors.size(), vectors.begin()); } /**< See above. */
+
 	/** Gets the translation component of this matrix.
 		@return A Reference to the FMVector3 representation of the translation. */
 	inline const FMVector3& GetTranslation() const { return GetAxis(FMath::TRANS); }
@@ -196,6 +222,21 @@ public:
 	@return The concatenation of the two matrix transformations. */
 FMMatrix44 FCOLLADA_EXPORT operator*(const FMMatrix44& m1, const FMMatrix44& m2);
 
+/** Multiplies two lists of matrices, one pair at a time: out[i] = m1[i] * m2[i].
+	@param m1 The first list of matrices.
+	@param m2 The second list of matrices.
+	@param count The number of matrices in each list.
+	@param out The list to fill in with the products. It may be either of the given lists. */
+void FCOLLADA_EXPORT MultiplyMatrices(const FMMatrix44* m1, const FMMatrix44* m2, size_t count, FMMatrix44* out);
+
+/** Left-multiplies a list of matrices by one matrix: out[i] = m1 * m2[i].
+	This concatenates one parent transform with many local transforms.
+	@param m1 The left matrix.
+	@param m2 The list of right matrices.
+	@param count The number of right matrices.
+	@param out The list to fill in with the products. It may be the list of right matrices. */
+void FCOLLADA_EXPORT MultiplyMatrices(const FMMatrix44& m1, const FMMatrix44* m2, size_t count, FMMatrix44* out);
+
 /** Transforms a four-dimensional vector by a given matrix.
 	If the 'w' value of the vector is 1.0, this is a coordinate transformation.
 	If the 'w' value of the vector is 0.0, this is a vector transformation.
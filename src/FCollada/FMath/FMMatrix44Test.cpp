@@ -0,0 +1,124 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#include "StdAfx.h"
+#include "FMMatrix44.h"
+#include "FUtils/FUTestBed.h"
+
+// Builds a well-conditioned transform: a translation, a rotation and a non-uniform scale.
+static FMMatrix44 MakeTransform(size_t seed)
+{
+	float s = (float) seed;
+	FMVector3 translation(s * 0.5f - 3.0f, 2.0f - s * 0.25f, s * 0.125f);
+	FMVector3 rotation(0.3f + s * 0.1f, -0.7f + s * 0.05f, 1.1f - s * 0.2f);
+	FMVector3 scale(1.0f + s * 0.1f, 0.5f + s * 0.05f, 2.0f - s * 0.1f);
+	FMMatrix44 mx;
+	mx.Recompose(scale, rotation, translation);
+	return mx;
+}
+
+TESTSUITE_START(FMMatrix44)
+
+TESTSUITE_TEST(0, Kernels)
+	// The multiplication, against its definition.
+	FMMatrix44 m1 = MakeTransform(1), m2 = MakeTransform(2);
+	m2[0][3] = 0.25f; // Not an affine transform.
+	FMMatrix44 product = m1 * m2;
+	for (size_t i = 0; i < 4; ++i)
+	{
+		for (size_t j = 0; j < 4; ++j)
+		{
+			float expected = m1[0][j] * m2[i][0] + m1[1][j] * m2[i][1] + m1[2][j] * m2[i][2] + m1[3][j] * m2[i][3];
+			PassIf(IsEquivalent(product[i][j], expected));
+		}
+	}
+
+	// The inverse and the determinant.
+	for (size_t seed = 0; seed < 8; ++seed)
+	{
+		FMMatrix44 mx = MakeTransform(seed);
+		PassIf(IsEquivalent(mx * mx.Inverted(), FMMatrix44::Identity));
+		PassIf(IsEquivalent(mx.Inverted() * mx, FMMatrix44::Identity));
+		FMVector3 scale(1.0f + seed * 0.1f, 0.5f + seed * 0.05f, 2.0f - seed * 0.1f);
+		PassIf(IsEquivalent(mx.Determinant(), scale.m_X * scale.m_Y * scale.m_Z));
+	}
+	PassIf(IsEquivalent(FMMatrix44::ScaleMatrix(FMVector3(2.0f, 3.0f, -4.0f)).Determinant(), -24.0f));
+	PassIf(IsEquivalent(FMMatrix44::ScaleMatrix(FMVector3(2.0f, 4.0f, 8.0f)).Inverted(), FMMatrix44::ScaleMatrix(FMVector3(0.5f, 0.25f, 0.125f))));
+
+	// The single transforms.
+	FMVector3 point(1.5f, -2.0f, 0.75f);
+	FMVector3 transformed = m1.TransformCoordinate(point);
+	PassIf(IsEquivalent(transformed.m_X, m1[0][0] * point.m_X + m1[1][0] * point.m_Y + m1[2][0] * point.m_Z + m1[3][0]));
+	PassIf(IsEquivalent(transformed.m_Y, m1[0][1] * point.m_X + m1[1][1] * point.m_Y + m1[2][1] * point.m_Z + m1[3][1]));
+	PassIf(IsEquivalent(transformed.m_Z, m1[0][2] * point.m_X + m1[1][2] * point.m_Y + m1[2][2] * point.m_Z + m1[3][2]));
+	PassIf(IsEquivalent(m1.TransformVector(point), transformed - m1.GetTranslation()));
+	FMVector4 homogeneous = m2 * FMVector4(point, 1.0f);
+	PassIf(IsEquivalent(homogeneous.w, m2[0][3] * point.m_X + m2[3][3]));
+	PassIf(IsEquivalent(FMVector3(homogeneous.x, homogeneous.y, homogeneous.z), m2.TransformCoordinate(point)));
+
+TESTSUITE_TEST(1, BatchTransforms)
+	FMMatrix44 mx = MakeTransform(3);
+	FMVector3List points;
+	for (size_t i = 0; i < 100; ++i) points.push_back(FMVector3((float) i, (float) (i % 7) - 3.0f, 0.5f * (float) i));
+
+	// The points and the vectors, in place.
+	FMVector3List coordinates, vectors;
+	coordinates.insert(coordinates.end(), points.begin(), points.size());
+	vectors.insert(vectors.end(), points.begin(), points.size());
+	mx.TransformCoordinates(coordinates);
+	mx.TransformVectors(vectors);
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		PassIf(IsEquivalent(coordinates[i], mx.TransformCoordinate(points[i])));
+		PassIf(IsEquivalent(vectors[i], mx.TransformVector(points[i])));
+	}
+
+	// Strided floating-point values: the values past each point are left untouched.
+	FloatList values;
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		values.push_back(points[i].m_X);
+		values.push_back(points[i].m_Y);
+		values.push_back(points[i].m_Z);
+		values.push_back(-1.0f);
+	}
+	mx.TransformCoordinates(values.begin(), points.size(), 4, values.begin());
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		PassIf(IsEquivalent(FMVector3(values.begin(), (uint32) (4 * i)), coordinates[i]));
+		PassIf(values[4 * i + 3] == -1.0f);
+	}
+
+	// The packed points, into another list.
+	FloatList packed, out;
+	for (size_t i = 0; i < points.size(); ++i) { packed.push_back(points[i].m_X); packed.push_back(points[i].m_Y); packed.push_back(points[i].m_Z); }
+	out.resize(packed.size());
+	mx.TransformVectors(packed.begin(), points.size(), 3, out.begin());
+	for (size_t i = 0; i < points.size(); ++i) PassIf(IsEquivalent(FMVector3(out.begin(), (uint32) (3 * i)), vectors[i]));
+
+TESTSUITE_TEST(2, BatchMultiplications)
+	FMMatrix44List lefts, rights, products;
+	for (size_t i = 0; i < 16; ++i)
+	{
+		lefts.push_back(MakeTransform(i));
+		rights.push_back(MakeTransform(i + 5));
+	}
+	products.resize(lefts.size());
+	MultiplyMatrices(lefts.begin(), rights.begin(), lefts.size(), products.begin());
+	for (size_t i = 0; i < lefts.size(); ++i) PassIf(IsEquivalent(products[i], lefts[i] * rights[i]));
+
+	// One parent with many children, in place.
+	FMMatrix44 parent = MakeTransform(9);
+	MultiplyMatrices(parent, rights.begin(), rights.size(), rights.begin());
+	for (size_t i = 0; i < rights.size(); ++i) PassIf(IsEquivalent(rights[i], parent * MakeTransform(i + 5)));
+
+	// The left matrices, in place.
+	MultiplyMatrices(lefts.begin(), products.begin(), lefts.size(), lefts.begin());
+	for (size_t i = 0; i < lefts.size(); ++i) PassIf(IsEquivalent(lefts[i], MakeTransform(i) * products[i]));
+
+TESTSUITE_END
@@ -13,6 +13,13 @@ FUCriticalSection::FUCriticalSection()
 {
 #ifdef WIN32
 	InitializeCriticalSection(&criticalSection);
+#else
+	// The mutex must be recursive, to match the WIN32 critical sections.
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&criticalSection, &attributes);
+	pthread_mutexattr_destroy(&attributes);
 #endif
 }
 
@@ -20,6 +27,8 @@ FUCriticalSection::~FUCriticalSection()
 {
 #ifdef WIN32
 	DeleteCriticalSection(&criticalSection);
+#else
+	pthread_mutex_destroy(&criticalSection);
 #endif
 }
 
@@ -27,6 +36,8 @@ void FUCriticalSection::Enter()
 {
 #ifdef WIN32
 	EnterCriticalSection(&criticalSection);
+#else
+	pthread_mutex_lock(&criticalSection);
 #endif
 }
 
@@ -34,6 +45,8 @@ void FUCriticalSection::Leave()
 {
 #ifdef WIN32
 	LeaveCriticalSection(&criticalSection);
+#else
+	pthread_mutex_unlock(&criticalSection);
 #endif
 }
 
@@ -14,14 +14,14 @@
 #ifndef _FU_CRITICAL_SECTION_H_
 #define _FU_CRITICAL_SECTION_H_
 
-#ifdef __APPLE__
-#include <CoreServices/CoreServices.h>
+#ifndef WIN32
+#include <pthread.h>
 #endif
 
 /**
 	An OS dependent critical section.
 	
-	Currently only supported for WIN32.
+	Based on the WIN32 critical sections and on recursive POSIX mutexes.
 
 	@ingroup FUtils
 */
@@ -30,12 +30,8 @@ class FCOLLADA_EXPORT FUCriticalSection
 private:
 #ifdef WIN32
 	CRITICAL_SECTION criticalSection; // WIN32
-#elif defined(__APPLE__)
-	//Do something here.
-	MPCriticalRegionID criticalSection;
-#elif defined(LINUX) || defined(__FreeBSD__) || defined(__FreeBSD_kernel__) || defined(__OpenBSD__)
 #else
-#warning "FUCriticalSection: Critical section not implemented for other platforms."
+	pthread_mutex_t criticalSection; // POSIX
 #endif
 
 public:
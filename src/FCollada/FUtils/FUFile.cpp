@@ -8,6 +8,12 @@
 
 #include "StdAfx.h"
 #include "FUFile.h"
+#ifdef WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // WIN32
 
 //
 // FUFile
@@ -16,6 +22,10 @@
 FUFile::FUFile(const fstring& filename, Mode mode)
 :	filePtr(nullptr)
 ,	filepath()
+,	mappedData(nullptr), mappedLength(0)
+#ifdef WIN32
+,	mappingHandle(nullptr)
+#endif // WIN32
 {
 	Open(filename, mode);
 }
@@ -23,6 +33,10 @@ FUFile::FUFile(const fstring& filename, Mode mode)
 FUFile::FUFile(const fchar* filename, Mode mode)
 :	filePtr(nullptr)
 ,	filepath()
+,	mappedData(nullptr), mappedLength(0)
+#ifdef WIN32
+,	mappingHandle(nullptr)
+#endif // WIN32
 {
 	Open(filename, mode);
 }
@@ -30,6 +44,10 @@ FUFile::FUFile(const fchar* filename, Mode mode)
 FUFile::FUFile()
 :	filePtr(nullptr)
 ,	filepath()
+,	mappedData(nullptr), mappedLength(0)
+#ifdef WIN32
+,	mappingHandle(nullptr)
+#endif // WIN32
 {}
 
 FUFile::~FUFile()
@@ -50,6 +68,7 @@ bool FUFile::Open(const fchar* filename, Mode mode)
 	{
 	case READ: openMode = FC("rb"); break;
 	case WRITE: openMode = FC("wb"); break;
+	case READ_MAPPED: openMode = FC("rb"); break;
 	default: openMode = FC("rb"); break;
 	}
 
@@ -86,13 +105,65 @@ bool FUFile::Open(const fchar* filename, Mode mode)
 #endif
 		return false;
 	}
+
+	// When the file cannot be mapped, it is still read through the buffered functions.
+	if (mode == READ_MAPPED) Map();
 	return true;
 }
 
+bool FUFile::Map()
+{
+#ifdef WIN32
+	HANDLE fileHandle = (HANDLE) _get_osfhandle(_fileno(filePtr));
+	LARGE_INTEGER size;
+	if (fileHandle == INVALID_HANDLE_VALUE || GetFileType(fileHandle) != FILE_TYPE_DISK) return false;
+	if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart <= 0 || (uint64) size.QuadPart > (uint64) (size_t) ~0) return false;
+	mappingHandle = CreateFileMapping(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle == nullptr) return false;
+	void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr)
+	{
+		CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+		return false;
+	}
+	mappedLength = (size_t) size.QuadPart;
+#else
+	int descriptor = fileno(filePtr);
+	struct stat status;
+	if (fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode)) return false;
+	if (status.st_size <= 0 || (uint64) status.st_size > (uint64) (size_t) ~0) return false;
+	void* data = mmap(nullptr, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	if (data == MAP_FAILED) return false;
+#ifdef MADV_SEQUENTIAL
+	madvise(data, (size_t) status.st_size, MADV_SEQUENTIAL);
+#endif // MADV_SEQUENTIAL
+	mappedLength = (size_t) status.st_size;
+#endif // WIN32
+
+	mappedData = (const uint8*) data;
+	return true;
+}
+
+void FUFile::Unmap()
+{
+	if (mappedData == nullptr) return;
+#ifdef WIN32
+	UnmapViewOfFile(mappedData);
+	CloseHandle(mappingHandle);
+	mappingHandle = nullptr;
+#else
+	munmap((void*) mappedData, mappedLength);
+#endif // WIN32
+	mappedData = nullptr;
+	mappedLength = 0;
+}
+
 // Retrieve the file length
 size_t FUFile::GetLength()
 {
 	FUAssert(IsOpen(), return 0);
+	if (mappedData != nullptr) return mappedLength;
 
 	size_t currentPosition = (size_t) ftell(filePtr);
 	if (fseek(filePtr, 0, SEEK_END) != 0) return 0;
@@ -110,6 +181,13 @@ bool FUFile::Read(void* buffer, size_t length)
 	return (fread(buffer, 1, length, filePtr) > 0);
 }
 
+// Reads in the next block of the file into the given buffer
+size_t FUFile::ReadBlock(void* buffer, size_t length)
+{
+	FUAssert(IsOpen(), return 0);
+	return fread(buffer, 1, length, filePtr);
+}
+
 // Write out some data to a file
 bool FUFile::Write(const void* buffer, size_t length)
 {
@@ -127,6 +205,7 @@ void FUFile::Flush()
 void FUFile::Close()
 {
 	FUAssert(IsOpen(),);
+	Unmap();
 	fclose(filePtr);
 	filePtr = nullptr;
 }
@@ -28,12 +28,19 @@ public:
 	enum Mode
 	{
 		READ, /**< Open for reading only. */
-		WRITE /**< Open for writing only. */
+		WRITE, /**< Open for writing only. */
+		READ_MAPPED /**< Open for reading only, with the whole file
+						mapped in memory when possible. See GetMappedData. */
 	};
 
 private:
 	FILE* filePtr;
 	fstring filepath;
+	const uint8* mappedData;
+	size_t mappedLength;
+#ifdef WIN32
+	HANDLE mappingHandle;
+#endif // WIN32
 
 public:
 	/** Constructor.
@@ -75,6 +82,15 @@ public:
 		@return The OS-specific file handle. */
 	FILE* GetHandle() { return filePtr; }
 
+	/** Retrieves the contents of a file opened in the READ_MAPPED mode.
+		The file is mapped read-only in memory rather than copied, and the
+		operating system is told that it will be read sequentially.
+		The contents remain valid until the file is closed.
+		@return The file contents, GetLength bytes long. This pointer is nullptr
+			when the file could not be mapped, for example when it is empty or
+			is not a regular file: use the Read function then. */
+	inline const uint8* GetMappedData() const { return mappedData; }
+
 	/** Reads length bytes of data from this file.
 		This function will fail if the file was not opened in READ mode.
 		This function will advance the FILE pointer length bytes ahead.
@@ -83,6 +99,15 @@ public:
 		@return True on success, false otherwise. */
 	bool Read(void* buffer, size_t length);
 
+	/** Reads up to length bytes of data from this file.
+		Use this function to stream through a file, one block at a time.
+		This function will fail if the file was not opened in READ mode.
+		@param buffer A buffer large enough to accept length bytes.
+		@param length The maximum number of bytes to read.
+		@return The number of bytes actually read. Zero is returned
+			at the end of the file or on failure. */
+	size_t ReadBlock(void* buffer, size_t length);
+
 	/** Writes length bytes of data to this file.
 		This function will fail if the file was not opened in WRITE mode.
 		@param buffer A buffer contained the data to write.
@@ -96,6 +121,10 @@ public:
 
 	/** Closes and detaches the file. */
 	void Close();
+
+private:
+	bool Map();
+	void Unmap();
 };
 
 #endif // _FU_FILE_H_
@@ -147,6 +147,11 @@ void FUFileManager::PopRootFile()
 
 // Open a file to read
 FUFile* FUFileManager::OpenFile(const fstring& filename, bool write, SchemeOnCompleteCallback* onComplete, size_t userData)
+{
+	return OpenFile(filename, write ? FUFile::WRITE : FUFile::READ, onComplete, userData);
+}
+
+FUFile* FUFileManager::OpenFile(const fstring& filename, FUFile::Mode mode, SchemeOnCompleteCallback* onComplete, size_t userData)
 {
 	// Make sure we have a absolute URI
 	fstring absoluteFilename = GetCurrentUri().MakeAbsolute(filename);
@@ -200,7 +205,9 @@ FUFile* FUFileManager::OpenFile(const fstring& filename, bool write, SchemeOnCom
 			} while(i != callbacks->openers.size()); // Allow pre-processes to process in any order
 		}
 	}
-	return new FUFile(absoluteFilename.c_str(), write ? FUFile::WRITE : FUFile::READ);
+	// Only map the local files: the files of the other schemes may still be arriving.
+	if (mode == FUFile::READ_MAPPED && uri.GetScheme() != FUUri::FILE) mode = FUFile::READ;
+	return new FUFile(absoluteFilename.c_str(), mode);
 }
 
 bool FUFileManager::MakeDirectory(const fstring& directory)
@@ -222,6 +229,13 @@ bool FUFileManager::MakeDirectory(const fstring& directory)
 	return false;
 }
 
+bool FUFileManager::RemoveFile(const fstring& filename)
+{
+	FUUri uri(filename);
+	fstring absoluteFilename = uri.GetAbsolutePath();
+	return remove(TO_STRING(absoluteFilename).c_str()) == 0;
+}
+
 bool FUFileManager::FileExists(const fstring& filename)
 {
 	// Make sure we have a absolute URI
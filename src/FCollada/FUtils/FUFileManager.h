@@ -23,7 +23,9 @@
 #include "FMath/FMArray.h"
 #endif //_FM_ARRAY_H_
 
-class FUFile;
+#ifndef _FU_FILE_H_
+#include "FUtils/FUFile.h"
+#endif //_FU_FILE_H_
 
 /** A scheme callback to load remote files.
 	Takes the remote file FUUri as parameter, and returns the absolute file
@@ -124,6 +126,17 @@ public:
 		@return The file handle. */
 	FUFile* OpenFile(const fstring& filename, bool write=false, SchemeOnCompleteCallback* onComplete=nullptr, size_t userData = 0);
 
+	/** Opens a file.
+		@see FUFile.
+		@param filename A file path with a filename.
+		@param mode The opening mode. The READ_MAPPED mode is only used
+			for the 'file' URI scheme: the files of the other schemes are
+			opened in the READ mode.
+		@param onComplete See above.
+		@param userData See above.
+		@return The file handle. */
+	FUFile* OpenFile(const fstring& filename, FUFile::Mode mode, SchemeOnCompleteCallback* onComplete=nullptr, size_t userData = 0);
+
 	/** Makes the directory.
 		Currently, the directory must be one level from a directory that exists
 		@param directory The path to the directory.
@@ -131,6 +144,11 @@ public:
 			directory does not exist. */
 	static bool MakeDirectory(const fstring& directory);
 
+	/** Removes a file.
+		@param filename The path to the file.
+		@return Whether the file was removed. */
+	static bool RemoveFile(const fstring& filename);
+
 	/** Determines whether a file exists or not.
 		@param filename A file path.
 		@return True if the file exists, false otherwise.*/
@@ -9,6 +9,7 @@
 #include "StdAfx.h"
 #include "FUTestBed.h"
 #include "FUFileManager.h"
+#include "FUFile.h"
 #include "FUUri.h"
 #if defined(WIN32)
 	#include <direct.h>
@@ -277,4 +278,36 @@ TESTSUITE_TEST(6, ApplicationFolderName)
 	FailIf(moduleFolderName.empty()); // really not much else I can test for..
 #endif
 
+TESTSUITE_TEST(7, MappedFiles)
+	// Write out a small file and read it back, mapped in memory.
+	const char contents[] = "<COLLADA>mapped contents</COLLADA>";
+	const size_t length = sizeof(contents) - 1;
+	{
+		FUFile file(FC("FUFileMappedTest.tmp"), FUFile::WRITE);
+		PassIf(file.IsOpen());
+		PassIf(file.Write(contents, length));
+	}
+	{
+		FUFile file(FC("FUFileMappedTest.tmp"), FUFile::READ_MAPPED);
+		PassIf(file.IsOpen());
+		PassIf(file.GetMappedData() != nullptr);
+		PassIf(file.GetLength() == length);
+		PassIf(memcmp(file.GetMappedData(), contents, length) == 0);
+		file.Close();
+		PassIf(file.GetMappedData() == nullptr);
+	}
+
+	// Files that cannot be mapped are still readable.
+	{
+		FUFile file(FC("FUFileMappedTest.tmp"), FUFile::WRITE);
+		PassIf(file.IsOpen());
+	}
+	{
+		FUFile file(FC("FUFileMappedTest.tmp"), FUFile::READ_MAPPED);
+		PassIf(file.IsOpen());
+		PassIf(file.GetMappedData() == nullptr);
+		PassIf(file.GetLength() == 0);
+	}
+	remove("FUFileMappedTest.tmp");
+
 TESTSUITE_END
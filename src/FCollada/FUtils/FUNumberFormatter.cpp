@@ -0,0 +1,378 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#include "StdAfx.h"
+#include "FUNumberFormatter.h"
+
+//
+// Integer digits
+//
+
+static const char kDigitPairs[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+static inline uint32 CountDigits32(uint32 value)
+{
+	if (value < 10) return 1;
+	if (value < 100) return 2;
+	if (value < 1000) return 3;
+	if (value < 10000) return 4;
+	if (value < 100000) return 5;
+	if (value < 1000000) return 6;
+	if (value < 10000000) return 7;
+	if (value < 100000000) return 8;
+	if (value < 1000000000) return 9;
+	return 10;
+}
+
+// Writes the digits of the value backwards, two at a time, ending just before the given character.
+template <class Char>
+static inline void WriteDigitsBackwards(uint32 value, Char* end)
+{
+	while (value >= 100)
+	{
+		const char* pair = kDigitPairs + 2 * (value % 100);
+		value /= 100;
+		*(--end) = (Char) pair[1];
+		*(--end) = (Char) pair[0];
+	}
+	if (value >= 10)
+	{
+		const char* pair = kDigitPairs + 2 * value;
+		*(--end) = (Char) pair[1];
+		*(--end) = (Char) pair[0];
+	}
+	else *(--end) = (Char) ('0' + value);
+}
+
+template <class Char>
+static size_t WriteUInt32(uint32 value, Char* buffer)
+{
+	uint32 length = CountDigits32(value);
+	WriteDigitsBackwards(value, buffer + length);
+	return length;
+}
+
+template <class Char>
+static size_t WriteInt32(int32 value, Char* buffer)
+{
+	if (value >= 0) return WriteUInt32((uint32) value, buffer);
+	*buffer = (Char) '-';
+	return 1 + WriteUInt32(0u - (uint32) value, buffer + 1);
+}
+
+template <class Char>
+static size_t WriteUInt64(uint64 value, Char* buffer)
+{
+	if ((value >> 32) == 0) return WriteUInt32((uint32) value, buffer);
+
+	// Split the value in groups of nine digits, which fit in 32 bits.
+	uint32 groups[3];
+	size_t groupCount = 0;
+	while (value >= 1000000000)
+	{
+		groups[groupCount++] = (uint32) (value % 1000000000);
+		value /= 1000000000;
+	}
+	size_t length = WriteUInt32((uint32) value, buffer);
+	while (groupCount > 0)
+	{
+		length += 9;
+		Char* end = buffer + length;
+		uint32 group = groups[--groupCount];
+		for (size_t i = 0; i < 9; ++i) { *(--end) = (Char) ('0' + group % 10); group /= 10; }
+	}
+	return length;
+}
+
+//
+// Ryu: shortest decimal representation of a binary32 value
+// Ulf Adams, "Ryu: fast float-to-string conversion", PLDI 2018.
+//
+
+#define FLOAT_MANTISSA_BITS 23
+#define FLOAT_EXPONENT_BIAS 127
+#define FLOAT_POW5_INV_BITCOUNT 59
+#define FLOAT_POW5_BITCOUNT 61
+
+// floor(2^(ceil(log2(5^i)) - 1 + 59) / 5^i) + 1
+static const uint64 kPowersOfFiveInverse[31] =
+{
+	0x0800000000000001ULL, 0x0666666666666667ULL, 0x051EB851EB851EB9ULL, 0x04189374BC6A7EFAULL,
+	0x068DB8BAC710CB2AULL, 0x053E2D6238DA3C22ULL, 0x0431BDE82D7B634EULL, 0x06B5FCA6AF2BD216ULL,
+	0x055E63B88C230E78ULL, 0x044B82FA09B5A52DULL, 0x06DF37F675EF6EAEULL, 0x057F5FF85E592558ULL,
+	0x0465E6604B7A8447ULL, 0x0709709A125DA071ULL, 0x05A126E1A84AE6C1ULL, 0x0480EBE7B9D58567ULL,
+	0x0734ACA5F6226F0BULL, 0x05C3BD5191B525A3ULL, 0x049C97747490EAE9ULL, 0x0760F253EDB4AB0EULL,
+	0x05E72843249088D8ULL, 0x04B8ED0283A6D3E0ULL, 0x078E480405D7B966ULL, 0x060B6CD004AC9452ULL,
+	0x04D5F0A66A23A9DBULL, 0x07BCB43D769F762BULL, 0x063090312BB2C4EFULL, 0x04F3A68DBC8F03F3ULL,
+	0x07EC3DAF94180651ULL, 0x065697BFA9ACD1DAULL, 0x051212FFBAF0A7E2ULL,
+};
+
+// 5^i, scaled to 61 bits.
+static const uint64 kPowersOfFive[48] =
+{
+	0x1000000000000000ULL, 0x1400000000000000ULL, 0x1900000000000000ULL, 0x1F40000000000000ULL,
+	0x1388000000000000ULL, 0x186A000000000000ULL, 0x1E84800000000000ULL, 0x1312D00000000000ULL,
+	0x17D7840000000000ULL, 0x1DCD650000000000ULL, 0x12A05F2000000000ULL, 0x174876E800000000ULL,
+	0x1D1A94A200000000ULL, 0x12309CE540000000ULL, 0x16BCC41E90000000ULL, 0x1C6BF52634000000ULL,
+	0x11C37937E0800000ULL, 0x16345785D8A00000ULL, 0x1BC16D674EC80000ULL, 0x1158E460913D0000ULL,
+	0x15AF1D78B58C4000ULL, 0x1B1AE4D6E2EF5000ULL, 0x10F0CF064DD59200ULL, 0x152D02C7E14AF680ULL,
+	0x1A784379D99DB420ULL, 0x108B2A2C28029094ULL, 0x14ADF4B7320334B9ULL, 0x19D971E4FE8401E7ULL,
+	0x1027E72F1F128130ULL, 0x1431E0FAE6D7217CULL, 0x193E5939A08CE9DBULL, 0x1F8DEF8808B02452ULL,
+	0x13B8B5B5056E16B3ULL, 0x18A6E32246C99C60ULL, 0x1ED09BEAD87C0378ULL, 0x13426172C74D822BULL,
+	0x1812F9CF7920E2B6ULL, 0x1E17B84357691B64ULL, 0x12CED32A16A1B11EULL, 0x178287F49C4A1D66ULL,
+	0x1D6329F1C35CA4BFULL, 0x125DFA371A19E6F7ULL, 0x16F578C4E0A060B5ULL, 0x1CB2D6F618C878E3ULL,
+	0x11EFC659CF7D4B8DULL, 0x166BB7F0435C9E71ULL, 0x1C06A5EC5433C60DULL, 0x118427B3B4A05BC8ULL,
+};
+
+// ceil(log2(5^e)), for e > 0. One, for e == 0.
+static inline int32 Pow5Bits(int32 e) { return (int32) (((uint32) e * 1217359) >> 19) + 1; }
+
+// floor(log10(2^e)) and floor(log10(5^e)), for e >= 0.
+static inline uint32 Log10Pow2(int32 e) { return ((uint32) e * 78913) >> 18; }
+static inline uint32 Log10Pow5(int32 e) { return ((uint32) e * 732923) >> 20; }
+
+static inline bool IsMultipleOfPowerOf5(uint32 value, uint32 p)
+{
+	uint32 count = 0;
+	while (value % 5 == 0) { value /= 5; ++count; }
+	return count >= p;
+}
+
+static inline bool IsMultipleOfPowerOf2(uint32 value, uint32 p)
+{
+	return (value & ((1u << p) - 1)) == 0;
+}
+
+// (m * factor) >> shift, with shift > 32.
+static inline uint32 MultiplyShift(uint32 m, uint64 factor, int32 shift)
+{
+	uint64 low = (uint64) m * (uint32) factor;
+	uint64 high = (uint64) m * (uint32) (factor >> 32);
+	return (uint32) (((low >> 32) + high) >> (shift - 32));
+}
+
+// Computes the shortest decimal digits, and their decimal exponent, of a finite non-zero value.
+static void ComputeShortestDigits(uint32 ieeeMantissa, uint32 ieeeExponent, uint32& digits, int32& exponent)
+{
+	int32 e2;
+	uint32 m2;
+	if (ieeeExponent == 0)
+	{
+		e2 = 1 - FLOAT_EXPONENT_BIAS - FLOAT_MANTISSA_BITS - 2;
+		m2 = ieeeMantissa;
+	}
+	else
+	{
+		e2 = (int32) ieeeExponent - FLOAT_EXPONENT_BIAS - FLOAT_MANTISSA_BITS - 2;
+		m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+	}
+	bool acceptBounds = (m2 & 1) == 0;
+
+	// The value and its halfway points with the neighbouring values, scaled by four.
+	uint32 mv = 4 * m2;
+	uint32 mp = 4 * m2 + 2;
+	uint32 mmShift = (ieeeMantissa != 0 || ieeeExponent <= 1) ? 1 : 0;
+	uint32 mm = 4 * m2 - 1 - mmShift;
+
+	// Convert them to decimal.
+	uint32 vr, vp, vm;
+	int32 e10;
+	bool vmIsTrailingZeros = false, vrIsTrailingZeros = false;
+	uint32 lastRemovedDigit = 0;
+	if (e2 >= 0)
+	{
+		uint32 q = Log10Pow2(e2);
+		e10 = (int32) q;
+		int32 k = FLOAT_POW5_INV_BITCOUNT + Pow5Bits((int32) q) - 1;
+		int32 i = -e2 + (int32) q + k;
+		vr = MultiplyShift(mv, kPowersOfFiveInverse[q], i);
+		vp = MultiplyShift(mp, kPowersOfFiveInverse[q], i);
+		vm = MultiplyShift(mm, kPowersOfFiveInverse[q], i);
+		if (q != 0 && (vp - 1) / 10 <= vm / 10)
+		{
+			// The digit removed by the loop below is needed for the rounding.
+			int32 l = FLOAT_POW5_INV_BITCOUNT + Pow5Bits((int32) q - 1) - 1;
+			lastRemovedDigit = MultiplyShift(mv, kPowersOfFiveInverse[q - 1], -e2 + (int32) q - 1 + l) % 10;
+		}
+		if (q <= 9)
+		{
+			// Only one of mp, mv and mm can be a multiple of 5, if any.
+			if (mv % 5 == 0) vrIsTrailingZeros = IsMultipleOfPowerOf5(mv, q);
+			else if (acceptBounds) vmIsTrailingZeros = IsMultipleOfPowerOf5(mm, q);
+			else vp -= IsMultipleOfPowerOf5(mp, q) ? 1 : 0;
+		}
+	}
+	else
+	{
+		uint32 q = Log10Pow5(-e2);
+		e10 = (int32) q + e2;
+		int32 i = -e2 - (int32) q;
+		int32 k = Pow5Bits(i) - FLOAT_POW5_BITCOUNT;
+		int32 j = (int32) q - k;
+		vr = MultiplyShift(mv, kPowersOfFive[i], j);
+		vp = MultiplyShift(mp, kPowersOfFive[i], j);
+		vm = MultiplyShift(mm, kPowersOfFive[i], j);
+		if (q != 0 && (vp - 1) / 10 <= vm / 10)
+		{
+			j = (int32) q - 1 - (Pow5Bits(i + 1) - FLOAT_POW5_BITCOUNT);
+			lastRemovedDigit = MultiplyShift(mv, kPowersOfFive[i + 1], j) % 10;
+		}
+		if (q <= 1)
+		{
+			// mv has at least q trailing zero bits, since it is a multiple of four.
+			vrIsTrailingZeros = true;
+			if (acceptBounds) vmIsTrailingZeros = mmShift == 1;
+			else --vp;
+		}
+		else if (q < 31)
+		{
+			vrIsTrailingZeros = IsMultipleOfPowerOf2(mv, q - 1);
+		}
+	}
+
+	// Remove the digits that are not needed to tell the value apart from its neighbours.
+	int32 removed = 0;
+	uint32 output;
+	if (vmIsTrailingZeros || vrIsTrailingZeros)
+	{
+		// Rare: the exact trailing zeroes matter for the rounding.
+		while (vp / 10 > vm / 10)
+		{
+			vmIsTrailingZeros &= vm % 10 == 0;
+			vrIsTrailingZeros &= lastRemovedDigit == 0;
+			lastRemovedDigit = vr % 10;
+			vr /= 10; vp /= 10; vm /= 10;
+			++removed;
+		}
+		if (vmIsTrailingZeros)
+		{
+			while (vm % 10 == 0)
+			{
+				vrIsTrailingZeros &= lastRemovedDigit == 0;
+				lastRemovedDigit = vr % 10;
+				vr /= 10; vp /= 10; vm /= 10;
+				++removed;
+			}
+		}
+		if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0)
+		{
+			// Round exact halfway cases to even.
+			lastRemovedDigit = 4;
+		}
+		output = vr + (((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5) ? 1 : 0);
+	}
+	else
+	{
+		while (vp / 10 > vm / 10)
+		{
+			lastRemovedDigit = vr % 10;
+			vr /= 10; vp /= 10; vm /= 10;
+			++removed;
+		}
+		output = vr + ((vr == vm || lastRemovedDigit >= 5) ? 1 : 0);
+	}
+
+	digits = output;
+	exponent = e10 + removed;
+}
+
+template <class Char>
+static size_t WriteFloat(float value, Char* buffer)
+{
+	uint32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	bool sign = (bits >> 31) != 0;
+	uint32 ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+	uint32 ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & 0xFF;
+
+	Char* c = buffer;
+	if (ieeeExponent == 0xFF)
+	{
+		if (ieeeMantissa != 0) { *(c++) = (Char) 'N'; *(c++) = (Char) 'a'; *(c++) = (Char) 'N'; }
+		else
+		{
+			if (sign) *(c++) = (Char) '-';
+			*(c++) = (Char) 'I'; *(c++) = (Char) 'N'; *(c++) = (Char) 'F';
+		}
+		return c - buffer;
+	}
+
+	if (sign) *(c++) = (Char) '-';
+	if (ieeeExponent == 0 && ieeeMantissa == 0)
+	{
+		*(c++) = (Char) '0';
+		return c - buffer;
+	}
+
+	uint32 digits;
+	int32 exponent;
+	ComputeShortestDigits(ieeeMantissa, ieeeExponent, digits, exponent);
+	int32 digitCount = (int32) CountDigits32(digits);
+
+	// The position of the decimal point, relative to the first digit.
+	int32 point = digitCount + exponent;
+	if (point > 0 && point <= 6)
+	{
+		if (point >= digitCount)
+		{
+			// Integer: DDD000
+			WriteDigitsBackwards(digits, c + digitCount);
+			c += digitCount;
+			for (int32 i = digitCount; i < point; ++i) *(c++) = (Char) '0';
+		}
+		else
+		{
+			// Simple number: DD.DDD
+			WriteDigitsBackwards(digits, c + digitCount + 1);
+			for (int32 i = 0; i < point; ++i) c[i] = c[i + 1];
+			c[point] = (Char) '.';
+			c += digitCount + 1;
+		}
+	}
+	else if (point <= 0 && point > -5)
+	{
+		// Small number: 0.000DDD
+		*(c++) = (Char) '0';
+		*(c++) = (Char) '.';
+		for (int32 i = point; i < 0; ++i) *(c++) = (Char) '0';
+		WriteDigitsBackwards(digits, c + digitCount);
+		c += digitCount;
+	}
+	else
+	{
+		// Scientific notation: D.DDDeX
+		WriteDigitsBackwards(digits, c + digitCount + 1);
+		c[0] = c[1];
+		if (digitCount > 1) { c[1] = (Char) '.'; c += digitCount + 1; }
+		else c += 1;
+		*(c++) = (Char) 'e';
+		int32 scientificExponent = point - 1;
+		if (scientificExponent < 0) { *(c++) = (Char) '-'; scientificExponent = -scientificExponent; }
+		c += WriteUInt32((uint32) scientificExponent, c);
+	}
+	return c - buffer;
+}
+
+//
+// FUNumberFormatter
+//
+
+size_t FUNumberFormatter::FormatFloat(float value, char* buffer) { return WriteFloat(value, buffer); }
+size_t FUNumberFormatter::FormatInt32(int32 value, char* buffer) { return WriteInt32(value, buffer); }
+size_t FUNumberFormatter::FormatUInt32(uint32 value, char* buffer) { return WriteUInt32(value, buffer); }
+size_t FUNumberFormatter::FormatUInt64(uint64 value, char* buffer) { return WriteUInt64(value, buffer); }
+
+#ifdef UNICODE
+size_t FUNumberFormatter::FormatFloat(float value, fchar* buffer) { return WriteFloat(value, buffer); }
+size_t FUNumberFormatter::FormatInt32(int32 value, fchar* buffer) { return WriteInt32(value, buffer); }
+size_t FUNumberFormatter::FormatUInt32(uint32 value, fchar* buffer) { return WriteUInt32(value, buffer); }
+size_t FUNumberFormatter::FormatUInt64(uint64 value, fchar* buffer) { return WriteUInt64(value, buffer); }
+#endif // UNICODE
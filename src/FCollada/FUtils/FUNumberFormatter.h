@@ -0,0 +1,81 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/**
+	@file FUNumberFormatter.h
+	This file contains the FUNumberFormatter class.
+*/
+
+#ifndef _FU_NUMBER_FORMATTER_H_
+#define _FU_NUMBER_FORMATTER_H_
+
+/**
+	A fast writer for numbers.
+
+	The floating-point values are written with the fewest significant digits
+	that read back to the exact same value. Of all the decimal numbers with
+	these digits, the one closest to the value is written. The digits are
+	generated with the Ryu algorithm, using only integer arithmetic.
+
+	The values from 0.00001 to one million are written in decimal
+	notation, the other values in scientific notation: "1.5e10" or "2e-7".
+	The infinite values are written as "INF" and "-INF", the impossible values as "NaN".
+
+	None of the functions writes a terminating null character.
+
+	@ingroup FUtils
+*/
+class FCOLLADA_EXPORT FUNumberFormatter
+{
+public:
+	/** The maximum number of characters written for one value. */
+	enum
+	{
+		MAX_FLOAT_LENGTH = 16, /**< For a floating-point value. */
+		MAX_INT32_LENGTH = 11, /**< For a signed 32-bit integer value. */
+		MAX_UINT32_LENGTH = 10, /**< For an unsigned 32-bit integer value. */
+		MAX_UINT64_LENGTH = 20 /**< For an unsigned 64-bit integer value. */
+	};
+
+	/** Writes out a floating-point value.
+		@param value The value.
+		@param buffer The character buffer. It must hold at least
+			MAX_FLOAT_LENGTH characters.
+		@return The number of characters written. */
+	static size_t FormatFloat(float value, char* buffer);
+
+	/** Writes out a signed integer value.
+		@param value The value.
+		@param buffer The character buffer. It must hold at least
+			MAX_INT32_LENGTH characters.
+		@return The number of characters written. */
+	static size_t FormatInt32(int32 value, char* buffer);
+
+	/** Writes out an unsigned integer value.
+		@param value The value.
+		@param buffer The character buffer. It must hold at least
+			MAX_UINT32_LENGTH characters.
+		@return The number of characters written. */
+	static size_t FormatUInt32(uint32 value, char* buffer);
+
+	/** Writes out an unsigned 64-bit integer value.
+		@param value The value.
+		@param buffer The character buffer. It must hold at least
+			MAX_UINT64_LENGTH characters.
+		@return The number of characters written. */
+	static size_t FormatUInt64(uint64 value, char* buffer);
+
+#ifdef UNICODE
+	static size_t FormatFloat(float value, fchar* buffer); /**< See above. */
+	static size_t FormatInt32(int32 value, fchar* buffer); /**< See above. */
+	static size_t FormatUInt32(uint32 value, fchar* buffer); /**< See above. */
+	static size_t FormatUInt64(uint64 value, fchar* buffer); /**< See above. */
+#endif // UNICODE
+};
+
+#endif // _FU_NUMBER_FORMATTER_H_
@@ -0,0 +1,706 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#include "StdAfx.h"
+#include "FUNumberParser.h"
+#include <cfloat>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FU_NUMBER_PARSER_SSE2
+#include <emmintrin.h>
+#endif
+
+// The eight-digit conversions expect the first character in the lowest byte of the register.
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_M_IX86) || defined(_M_X64)
+#define FU_NUMBER_PARSER_SWAR
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//
+// Bit manipulation helpers
+//
+
+static inline uint32 CountTrailingZeroes32(uint32 value)
+{
+#if defined(__GNUC__)
+	return (uint32) __builtin_ctz(value);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return (uint32) index;
+#else
+	uint32 count = 0;
+	while ((value & 1) == 0) { value >>= 1; ++count; }
+	return count;
+#endif
+}
+
+static inline uint32 CountTrailingZeroes64(uint64 value)
+{
+	uint32 low = (uint32) value;
+	return (low != 0) ? CountTrailingZeroes32(low) : 32 + CountTrailingZeroes32((uint32) (value >> 32));
+}
+
+static inline uint32 CountLeadingZeroes64(uint64 value)
+{
+#if defined(__GNUC__)
+	return (uint32) __builtin_clzll(value);
+#else
+	uint32 count = 0;
+	if ((value >> 32) == 0) { count += 32; value <<= 32; }
+	if ((value >> 48) == 0) { count += 16; value <<= 16; }
+	if ((value >> 56) == 0) { count += 8; value <<= 8; }
+	if ((value >> 60) == 0) { count += 4; value <<= 4; }
+	if ((value >> 62) == 0) { count += 2; value <<= 2; }
+	if ((value >> 63) == 0) { count += 1; }
+	return count;
+#endif
+}
+
+static inline uint32 CountBits16(uint32 value)
+{
+	value = value - ((value >> 1) & 0x5555);
+	value = (value & 0x3333) + ((value >> 2) & 0x3333);
+	value = (value + (value >> 4)) & 0x0F0F;
+	return (value + (value >> 8)) & 0x1F;
+}
+
+// Computes the full 128-bit product of two 64-bit values.
+static inline void Multiply64(uint64 a, uint64 b, uint64& high, uint64& low)
+{
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 product = (unsigned __int128) a * b;
+	high = (uint64) (product >> 64);
+	low = (uint64) product;
+#elif defined(_M_X64)
+	low = _umul128(a, b, &high);
+#else
+	uint64 aLow = (uint32) a, aHigh = a >> 32;
+	uint64 bLow = (uint32) b, bHigh = b >> 32;
+	uint64 lowLow = aLow * bLow, lowHigh = aLow * bHigh;
+	uint64 highLow = aHigh * bLow, highHigh = aHigh * bHigh;
+	uint64 middle = (lowLow >> 32) + (uint32) lowHigh + (uint32) highLow;
+	low = (middle << 32) | (uint32) lowLow;
+	high = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+#endif
+}
+
+//
+// Character classification
+//
+
+static inline bool IsWhitespace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+static inline bool IsDigit(char c) { return (uint8) (c - '0') < 10; }
+
+#ifdef FU_NUMBER_PARSER_SSE2
+// Retrieves a 16-bit mask of the whitespaces among sixteen characters.
+static inline uint32 WhitespaceMask(const char* s)
+{
+	__m128i chunk = _mm_loadu_si128((const __m128i*) s);
+	__m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+	__m128i newlines = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+	return (uint32) _mm_movemask_epi8(_mm_or_si128(spaces, newlines));
+}
+#endif // FU_NUMBER_PARSER_SSE2
+
+static inline const char* SkipWhitespaces(const char* s, const char* end)
+{
+	// Most values are separated by a single whitespace.
+	if (s < end && IsWhitespace(*s)) ++s;
+	if (s == end || !IsWhitespace(*s)) return s;
+
+#ifdef FU_NUMBER_PARSER_SSE2
+	while (end - s >= 16)
+	{
+		uint32 mask = WhitespaceMask(s);
+		if (mask != 0xFFFF) return s + CountTrailingZeroes32(~mask);
+		s += 16;
+	}
+#endif // FU_NUMBER_PARSER_SSE2
+
+	while (s < end && IsWhitespace(*s)) ++s;
+	return s;
+}
+
+// Skips the characters left in the current value, which are not part of a valid number.
+static inline const char* SkipToken(const char* s, const char* end)
+{
+	while (s < end && !IsWhitespace(*s)) ++s;
+	return s;
+}
+
+//
+// Digit conversion
+//
+
+static const uint64 kPowersOfTen[] =
+{
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL
+};
+
+#ifdef FU_NUMBER_PARSER_SWAR
+static inline uint64 Load64(const char* s)
+{
+	uint64 chunk;
+	memcpy(&chunk, s, sizeof(chunk));
+	return chunk;
+}
+
+// Retrieves the number of leading digits among eight characters.
+static inline uint32 CountDigits8(uint64 chunk)
+{
+	// For each digit, both the character and the character plus six have '3' as their high nibble.
+	uint64 nonDigits = ((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ^ 0x3333333333333333ULL;
+	return (nonDigits == 0) ? 8 : CountTrailingZeroes64(nonDigits) / 8;
+}
+
+// Converts the first digits of eight characters, in three multiplications.
+static inline uint32 ParseDigits8(uint64 chunk, uint32 count)
+{
+	// Drop the characters after the digits: the digits become the last characters, behind zeroes.
+	chunk = (chunk - 0x3030303030303030ULL) << (8 * (8 - count));
+	chunk = ((chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+	chunk = ((chunk & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+	return (uint32) (((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32);
+}
+#endif // FU_NUMBER_PARSER_SWAR
+
+// Reads a run of digits into a mantissa of at most nineteen digits.
+// The digits that do not fit are dropped. Returns the number of digits read.
+static inline size_t ReadDigits(const char*& s, const char* end, uint64& mantissa, int32& digitCount, bool& truncated)
+{
+	const char* start = s;
+
+#ifdef FU_NUMBER_PARSER_SWAR
+	while (end - s >= 8 && digitCount <= 19 - 8)
+	{
+		uint64 chunk = Load64(s);
+		uint32 count = CountDigits8(chunk);
+		if (count == 0) return s - start;
+		mantissa = mantissa * kPowersOfTen[count] + ParseDigits8(chunk, count);
+		digitCount += (int32) count;
+		s += count;
+		if (count < 8) return s - start;
+	}
+#endif // FU_NUMBER_PARSER_SWAR
+
+	for (; s < end && IsDigit(*s); ++s)
+	{
+		if (digitCount < 19) { mantissa = mantissa * 10 + (uint32) (*s - '0'); ++digitCount; }
+		else truncated |= (*s != '0');
+	}
+	return s - start;
+}
+
+static inline uint32 ParseUnsigned(const char*& s, const char* end)
+{
+	uint32 value = 0;
+
+#ifdef FU_NUMBER_PARSER_SWAR
+	if (end - s >= 8)
+	{
+		uint64 chunk = Load64(s);
+		uint32 count = CountDigits8(chunk);
+		if (count == 0) return 0;
+		value = ParseDigits8(chunk, count);
+		s += count;
+		if (count < 8) return value;
+	}
+#endif // FU_NUMBER_PARSER_SWAR
+
+	for (; s < end && IsDigit(*s); ++s) value = value * 10 + (uint32) (*s - '0');
+	return value;
+}
+
+static inline int32 ParseSigned(const char*& s, const char* end)
+{
+	bool negative = false;
+	if (s < end && (*s == '-' || *s == '+')) { negative = *s == '-'; ++s; }
+	uint32 value = ParseUnsigned(s, end);
+	return (int32) (negative ? 0 - value : value);
+}
+
+//
+// Floating-point conversion
+//
+
+// The 128-bit truncated powers of five, from 5^-65 to 5^38, with their most significant bit set.
+static const int32 kSmallestPowerOfTen = -65;
+static const int32 kLargestPowerOfTen = 38;
+static const uint64 kPowersOfFive[][2] =
+{
+	{ 0x86CCBB52EA94BAEAULL, 0x98E947129FC2B4E9ULL }, // 5^-65
+	{ 0xA87FEA27A539E9A5ULL, 0x3F2398D747B36224ULL }, // 5^-64
+	{ 0xD29FE4B18E88640EULL, 0x8EEC7F0D19A03AADULL }, // 5^-63
+	{ 0x83A3EEEEF9153E89ULL, 0x1953CF68300424ACULL }, // 5^-62
+	{ 0xA48CEAAAB75A8E2BULL, 0x5FA8C3423C052DD7ULL }, // 5^-61
+	{ 0xCDB02555653131B6ULL, 0x3792F412CB06794DULL }, // 5^-60
+	{ 0x808E17555F3EBF11ULL, 0xE2BBD88BBEE40BD0ULL }, // 5^-59
+	{ 0xA0B19D2AB70E6ED6ULL, 0x5B6ACEAEAE9D0EC4ULL }, // 5^-58
+	{ 0xC8DE047564D20A8BULL, 0xF245825A5A445275ULL }, // 5^-57
+	{ 0xFB158592BE068D2EULL, 0xEED6E2F0F0D56712ULL }, // 5^-56
+	{ 0x9CED737BB6C4183DULL, 0x55464DD69685606BULL }, // 5^-55
+	{ 0xC428D05AA4751E4CULL, 0xAA97E14C3C26B886ULL }, // 5^-54
+	{ 0xF53304714D9265DFULL, 0xD53DD99F4B3066A8ULL }, // 5^-53
+	{ 0x993FE2C6D07B7FABULL, 0xE546A8038EFE4029ULL }, // 5^-52
+	{ 0xBF8FDB78849A5F96ULL, 0xDE98520472BDD033ULL }, // 5^-51
+	{ 0xEF73D256A5C0F77CULL, 0x963E66858F6D4440ULL }, // 5^-50
+	{ 0x95A8637627989AADULL, 0xDDE7001379A44AA8ULL }, // 5^-49
+	{ 0xBB127C53B17EC159ULL, 0x5560C018580D5D52ULL }, // 5^-48
+	{ 0xE9D71B689DDE71AFULL, 0xAAB8F01E6E10B4A6ULL }, // 5^-47
+	{ 0x9226712162AB070DULL, 0xCAB3961304CA70E8ULL }, // 5^-46
+	{ 0xB6B00D69BB55C8D1ULL, 0x3D607B97C5FD0D22ULL }, // 5^-45
+	{ 0xE45C10C42A2B3B05ULL, 0x8CB89A7DB77C506AULL }, // 5^-44
+	{ 0x8EB98A7A9A5B04E3ULL, 0x77F3608E92ADB242ULL }, // 5^-43
+	{ 0xB267ED1940F1C61CULL, 0x55F038B237591ED3ULL }, // 5^-42
+	{ 0xDF01E85F912E37A3ULL, 0x6B6C46DEC52F6688ULL }, // 5^-41
+	{ 0x8B61313BBABCE2C6ULL, 0x2323AC4B3B3DA015ULL }, // 5^-40
+	{ 0xAE397D8AA96C1B77ULL, 0xABEC975E0A0D081AULL }, // 5^-39
+	{ 0xD9C7DCED53C72255ULL, 0x96E7BD358C904A21ULL }, // 5^-38
+	{ 0x881CEA14545C7575ULL, 0x7E50D64177DA2E54ULL }, // 5^-37
+	{ 0xAA242499697392D2ULL, 0xDDE50BD1D5D0B9E9ULL }, // 5^-36
+	{ 0xD4AD2DBFC3D07787ULL, 0x955E4EC64B44E864ULL }, // 5^-35
+	{ 0x84EC3C97DA624AB4ULL, 0xBD5AF13BEF0B113EULL }, // 5^-34
+	{ 0xA6274BBDD0FADD61ULL, 0xECB1AD8AEACDD58EULL }, // 5^-33
+	{ 0xCFB11EAD453994BAULL, 0x67DE18EDA5814AF2ULL }, // 5^-32
+	{ 0x81CEB32C4B43FCF4ULL, 0x80EACF948770CED7ULL }, // 5^-31
+	{ 0xA2425FF75E14FC31ULL, 0xA1258379A94D028DULL }, // 5^-30
+	{ 0xCAD2F7F5359A3B3EULL, 0x096EE45813A04330ULL }, // 5^-29
+	{ 0xFD87B5F28300CA0DULL, 0x8BCA9D6E188853FCULL }, // 5^-28
+	{ 0x9E74D1B791E07E48ULL, 0x775EA264CF55347EULL }, // 5^-27
+	{ 0xC612062576589DDAULL, 0x95364AFE032A819EULL }, // 5^-26
+	{ 0xF79687AED3EEC551ULL, 0x3A83DDBD83F52205ULL }, // 5^-25
+	{ 0x9ABE14CD44753B52ULL, 0xC4926A9672793543ULL }, // 5^-24
+	{ 0xC16D9A0095928A27ULL, 0x75B7053C0F178294ULL }, // 5^-23
+	{ 0xF1C90080BAF72CB1ULL, 0x5324C68B12DD6339ULL }, // 5^-22
+	{ 0x971DA05074DA7BEEULL, 0xD3F6FC16EBCA5E04ULL }, // 5^-21
+	{ 0xBCE5086492111AEAULL, 0x88F4BB1CA6BCF585ULL }, // 5^-20
+	{ 0xEC1E4A7DB69561A5ULL, 0x2B31E9E3D06C32E6ULL }, // 5^-19
+	{ 0x9392EE8E921D5D07ULL, 0x3AFF322E62439FD0ULL }, // 5^-18
+	{ 0xB877AA3236A4B449ULL, 0x09BEFEB9FAD487C3ULL }, // 5^-17
+	{ 0xE69594BEC44DE15BULL, 0x4C2EBE687989A9B4ULL }, // 5^-16
+	{ 0x901D7CF73AB0ACD9ULL, 0x0F9D37014BF60A11ULL }, // 5^-15
+	{ 0xB424DC35095CD80FULL, 0x538484C19EF38C95ULL }, // 5^-14
+	{ 0xE12E13424BB40E13ULL, 0x2865A5F206B06FBAULL }, // 5^-13
+	{ 0x8CBCCC096F5088CBULL, 0xF93F87B7442E45D4ULL }, // 5^-12
+	{ 0xAFEBFF0BCB24AAFEULL, 0xF78F69A51539D749ULL }, // 5^-11
+	{ 0xDBE6FECEBDEDD5BEULL, 0xB573440E5A884D1CULL }, // 5^-10
+	{ 0x89705F4136B4A597ULL, 0x31680A88F8953031ULL }, // 5^-9
+	{ 0xABCC77118461CEFCULL, 0xFDC20D2B36BA7C3EULL }, // 5^-8
+	{ 0xD6BF94D5E57A42BCULL, 0x3D32907604691B4DULL }, // 5^-7
+	{ 0x8637BD05AF6C69B5ULL, 0xA63F9A49C2C1B110ULL }, // 5^-6
+	{ 0xA7C5AC471B478423ULL, 0x0FCF80DC33721D54ULL }, // 5^-5
+	{ 0xD1B71758E219652BULL, 0xD3C36113404EA4A9ULL }, // 5^-4
+	{ 0x83126E978D4FDF3BULL, 0x645A1CAC083126EAULL }, // 5^-3
+	{ 0xA3D70A3D70A3D70AULL, 0x3D70A3D70A3D70A4ULL }, // 5^-2
+	{ 0xCCCCCCCCCCCCCCCCULL, 0xCCCCCCCCCCCCCCCDULL }, // 5^-1
+	{ 0x8000000000000000ULL, 0x0000000000000000ULL }, // 5^0
+	{ 0xA000000000000000ULL, 0x0000000000000000ULL }, // 5^1
+	{ 0xC800000000000000ULL, 0x0000000000000000ULL }, // 5^2
+	{ 0xFA00000000000000ULL, 0x0000000000000000ULL }, // 5^3
+	{ 0x9C40000000000000ULL, 0x0000000000000000ULL }, // 5^4
+	{ 0xC350000000000000ULL, 0x0000000000000000ULL }, // 5^5
+	{ 0xF424000000000000ULL, 0x0000000000000000ULL }, // 5^6
+	{ 0x9896800000000000ULL, 0x0000000000000000ULL }, // 5^7
+	{ 0xBEBC200000000000ULL, 0x0000000000000000ULL }, // 5^8
+	{ 0xEE6B280000000000ULL, 0x0000000000000000ULL }, // 5^9
+	{ 0x9502F90000000000ULL, 0x0000000000000000ULL }, // 5^10
+	{ 0xBA43B74000000000ULL, 0x0000000000000000ULL }, // 5^11
+	{ 0xE8D4A51000000000ULL, 0x0000000000000000ULL }, // 5^12
+	{ 0x9184E72A00000000ULL, 0x0000000000000000ULL }, // 5^13
+	{ 0xB5E620F480000000ULL, 0x0000000000000000ULL }, // 5^14
+	{ 0xE35FA931A0000000ULL, 0x0000000000000000ULL }, // 5^15
+	{ 0x8E1BC9BF04000000ULL, 0x0000000000000000ULL }, // 5^16
+	{ 0xB1A2BC2EC5000000ULL, 0x0000000000000000ULL }, // 5^17
+	{ 0xDE0B6B3A76400000ULL, 0x0000000000000000ULL }, // 5^18
+	{ 0x8AC7230489E80000ULL, 0x0000000000000000ULL }, // 5^19
+	{ 0xAD78EBC5AC620000ULL, 0x0000000000000000ULL }, // 5^20
+	{ 0xD8D726B7177A8000ULL, 0x0000000000000000ULL }, // 5^21
+	{ 0x878678326EAC9000ULL, 0x0000000000000000ULL }, // 5^22
+	{ 0xA968163F0A57B400ULL, 0x0000000000000000ULL }, // 5^23
+	{ 0xD3C21BCECCEDA100ULL, 0x0000000000000000ULL }, // 5^24
+	{ 0x84595161401484A0ULL, 0x0000000000000000ULL }, // 5^25
+	{ 0xA56FA5B99019A5C8ULL, 0x0000000000000000ULL }, // 5^26
+	{ 0xCECB8F27F4200F3AULL, 0x0000000000000000ULL }, // 5^27
+	{ 0x813F3978F8940984ULL, 0x4000000000000000ULL }, // 5^28
+	{ 0xA18F07D736B90BE5ULL, 0x5000000000000000ULL }, // 5^29
+	{ 0xC9F2C9CD04674EDEULL, 0xA400000000000000ULL }, // 5^30
+	{ 0xFC6F7C4045812296ULL, 0x4D00000000000000ULL }, // 5^31
+	{ 0x9DC5ADA82B70B59DULL, 0xF020000000000000ULL }, // 5^32
+	{ 0xC5371912364CE305ULL, 0x6C28000000000000ULL }, // 5^33
+	{ 0xF684DF56C3E01BC6ULL, 0xC732000000000000ULL }, // 5^34
+	{ 0x9A130B963A6C115CULL, 0x3C7F400000000000ULL }, // 5^35
+	{ 0xC097CE7BC90715B3ULL, 0x4B9F100000000000ULL }, // 5^36
+	{ 0xF0BDC21ABB48DB20ULL, 0x1E86D40000000000ULL }, // 5^37
+	{ 0x96769950B50D88F4ULL, 0x1314448000000000ULL }, // 5^38
+};
+
+static const uint32 kMantissaBits = 23;
+static const uint32 kInfinityBits = 0x7F800000;
+
+// Rounds mantissa * 10^exponent to the nearest float, with the Eisel-Lemire algorithm.
+// Returns false in the rare cases where 128 bits of the power of five are not enough to decide:
+// the float is then at most one away from the correctly rounded result.
+static bool ComputeFloatBits(uint64 mantissa, int32 exponent, uint32& bits)
+{
+	if (mantissa == 0 || exponent < kSmallestPowerOfTen) { bits = 0; return true; }
+	if (exponent > kLargestPowerOfTen) { bits = kInfinityBits; return true; }
+
+	uint32 leadingZeroes = CountLeadingZeroes64(mantissa);
+	mantissa <<= leadingZeroes;
+
+	// Multiply the mantissa by the power of five. The second half of the power is only
+	// needed when the bits that will be rounded away are all set.
+	const uint64* power = kPowersOfFive[exponent - kSmallestPowerOfTen];
+	uint64 high, low;
+	Multiply64(mantissa, power[0], high, low);
+	const uint64 precisionMask = ~0ULL >> (kMantissaBits + 3);
+	if ((high & precisionMask) == precisionMask)
+	{
+		uint64 secondHigh, secondLow;
+		Multiply64(mantissa, power[1], secondHigh, secondLow);
+		low += secondHigh;
+		if (secondHigh > low) ++high;
+	}
+	bool isPrecise = low != ~0ULL || (exponent >= -27 && exponent <= 55);
+
+	uint32 upperBit = (uint32) (high >> 63);
+	uint32 shift = upperBit + 64 - kMantissaBits - 3;
+	uint64 fraction = high >> shift;
+	int32 power2 = ((((152170 + 65536) * exponent) >> 16) + 63) + (int32) upperBit - (int32) leadingZeroes + 127;
+	if (power2 <= 0)
+	{
+		// Subnormal value.
+		if (-power2 + 1 >= 64) { bits = 0; return isPrecise; }
+		fraction >>= -power2 + 1;
+		fraction += (fraction & 1);
+		fraction >>= 1;
+		power2 = (fraction < (1ULL << kMantissaBits)) ? 0 : 1;
+		bits = (uint32) fraction | ((uint32) power2 << kMantissaBits);
+		return isPrecise;
+	}
+
+	// Exactly half-way between two floats: round to even.
+	if (low <= 1 && exponent >= -17 && exponent <= 10 && (fraction & 3) == 1 && (fraction << shift) == high)
+	{
+		fraction &= ~1ULL;
+	}
+
+	fraction += (fraction & 1);
+	fraction >>= 1;
+	if (fraction >= (2ULL << kMantissaBits))
+	{
+		fraction = 1ULL << kMantissaBits;
+		++power2;
+	}
+	fraction &= ~(1ULL << kMantissaBits);
+	if (power2 >= 0xFF) { bits = kInfinityBits; return isPrecise; }
+	bits = (uint32) fraction | ((uint32) power2 << kMantissaBits);
+	return isPrecise;
+}
+
+// An arbitrary-precision unsigned integer, used to round the values
+// that are too close to half-way between two floats.
+class FUNumberParserBigInteger
+{
+private:
+	UInt32List words; // Least significant first.
+
+public:
+	FUNumberParserBigInteger(uint64 value = 0)
+	{
+		for (; value != 0; value >>= 32) words.push_back((uint32) value);
+	}
+
+	void MultiplyAdd(uint32 factor, uint32 addend)
+	{
+		uint64 carry = addend;
+		for (uint32* it = words.begin(); it != words.end(); ++it)
+		{
+			carry += (uint64) *it * factor;
+			*it = (uint32) carry;
+			carry >>= 32;
+		}
+		if (carry != 0) words.push_back((uint32) carry);
+	}
+
+	void MultiplyPowerOfTen(uint32 exponent)
+	{
+		for (; exponent >= 9; exponent -= 9) MultiplyAdd(1000000000, 0);
+		MultiplyAdd((uint32) kPowersOfTen[exponent], 0);
+	}
+
+	void ShiftLeft(uint32 bitCount)
+	{
+		if (words.empty()) return;
+		uint32 wordShift = bitCount / 32, bitShift = bitCount % 32;
+		if (bitShift > 0)
+		{
+			uint32 carry = 0;
+			for (uint32* it = words.begin(); it != words.end(); ++it)
+			{
+				uint32 word = *it;
+				*it = (word << bitShift) | carry;
+				carry = word >> (32 - bitShift);
+			}
+			if (carry != 0) words.push_back(carry);
+		}
+		if (wordShift > 0) words.insert((size_t) 0, (size_t) wordShift, (uint32) 0);
+	}
+
+	int Compare(const FUNumberParserBigInteger& other) const
+	{
+		if (words.size() != other.words.size()) return (words.size() < other.words.size()) ? -1 : 1;
+		for (size_t i = words.size(); i > 0; --i)
+		{
+			if (words[i - 1] != other.words[i - 1]) return (words[i - 1] < other.words[i - 1]) ? -1 : 1;
+		}
+		return 0;
+	}
+};
+
+// Compares a decimal value with the value half-way between a float and the next one.
+static int CompareWithHalfWay(const char* digits, const char* digitsEnd, int32 exponent, uint32 bits)
+{
+	FUNumberParserBigInteger decimal;
+	bool isFraction = false;
+	for (const char* c = digits; c < digitsEnd; ++c)
+	{
+		if (*c == '.') { isFraction = true; continue; }
+		decimal.MultiplyAdd(10, (uint32) (*c - '0'));
+		if (isFraction) --exponent;
+	}
+
+	// The half-way value is (2m + 1) * 2^(e - 1), for the float m * 2^e.
+	uint32 biasedExponent = bits >> kMantissaBits;
+	uint64 fraction = bits & ((1 << kMantissaBits) - 1);
+	if (biasedExponent != 0) fraction |= 1 << kMantissaBits;
+	int32 binaryExponent = ((biasedExponent != 0) ? (int32) biasedExponent : 1) - 150 - 1;
+	FUNumberParserBigInteger halfWay(2 * fraction + 1);
+
+	if (exponent >= 0) decimal.MultiplyPowerOfTen((uint32) exponent);
+	else halfWay.MultiplyPowerOfTen((uint32) -exponent);
+	if (binaryExponent >= 0) halfWay.ShiftLeft((uint32) binaryExponent);
+	else decimal.ShiftLeft((uint32) -binaryExponent);
+	return decimal.Compare(halfWay);
+}
+
+// Rounds a decimal value exactly, given a float that is at most one away from the result.
+static uint32 RoundExactly(const char* digits, const char* digitsEnd, int32 exponent, uint32 bits)
+{
+	int comparison = CompareWithHalfWay(digits, digitsEnd, exponent, bits);
+	if (comparison > 0 || (comparison == 0 && (bits & 1) != 0)) return (bits < kInfinityBits) ? bits + 1 : bits;
+	if (bits > 0)
+	{
+		comparison = CompareWithHalfWay(digits, digitsEnd, exponent, bits - 1);
+		if (comparison < 0 || (comparison == 0 && (bits & 1) != 0)) return bits - 1;
+	}
+	return bits;
+}
+
+static const float kFloatPowersOfTen[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+static float ParseFloat(const char*& s, const char* end)
+{
+	bool negative = false;
+	if (s < end && (*s == '-' || *s == '+')) { negative = *s == '-'; ++s; }
+
+	// Read in up to nineteen significant digits: value = mantissa * 10^exponent.
+	const char* digits = s;
+	uint64 mantissa = 0;
+	int32 digitCount = 0, exponent = 0;
+	bool truncated = false;
+	size_t readCount = 0;
+	for (; s < end && *s == '0'; ++s) ++readCount;
+	size_t integerCount = ReadDigits(s, end, mantissa, digitCount, truncated);
+	exponent += (int32) integerCount - digitCount;
+	readCount += integerCount;
+	if (s < end && *s == '.')
+	{
+		++s;
+		if (digitCount == 0)
+		{
+			for (; s < end && *s == '0'; ++s) { --exponent; ++readCount; }
+		}
+		int32 integerDigitCount = digitCount;
+		readCount += ReadDigits(s, end, mantissa, digitCount, truncated);
+		exponent -= digitCount - integerDigitCount;
+	}
+	const char* digitsEnd = s;
+
+	if (readCount == 0)
+	{
+		// Not a number: check for the XML Schema special values.
+		if (end - s >= 3 && s[0] == 'I' && s[1] == 'N' && s[2] == 'F')
+		{
+			s += 3;
+			return negative ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+		}
+		else if (end - s >= 3 && s[0] == 'N' && s[1] == 'a' && s[2] == 'N')
+		{
+			s += 3;
+			return std::numeric_limits<float>::quiet_NaN();
+		}
+		return 0.0f;
+	}
+
+	int32 explicitExponent = 0;
+	if (s < end && (*s == 'e' || *s == 'E'))
+	{
+		const char* e = s + 1;
+		bool negativeExponent = false;
+		if (e < end && (*e == '-' || *e == '+')) { negativeExponent = *e == '-'; ++e; }
+		if (e < end && IsDigit(*e))
+		{
+			for (; e < end && IsDigit(*e); ++e)
+			{
+				if (explicitExponent < 100000) explicitExponent = explicitExponent * 10 + (*e - '0');
+			}
+			if (negativeExponent) explicitExponent = -explicitExponent;
+			exponent += explicitExponent;
+			s = e;
+		}
+	}
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+	// When the mantissa and the power of ten are exact floats, one operation rounds correctly.
+	if (!truncated && mantissa <= (1 << 24) && exponent >= -10 && exponent <= 10)
+	{
+		float value = (float) mantissa;
+		value = (exponent < 0) ? value / kFloatPowersOfTen[-exponent] : value * kFloatPowersOfTen[exponent];
+		return negative ? -value : value;
+	}
+#endif // FLT_EVAL_METHOD
+
+	uint32 bits;
+	bool exact = ComputeFloatBits(mantissa, exponent, bits);
+	if (exact && truncated)
+	{
+		// The dropped digits may only matter if the value is close to half-way between two floats.
+		uint32 upperBits;
+		exact = ComputeFloatBits(mantissa + 1, exponent, upperBits) && upperBits == bits;
+	}
+	if (!exact) bits = RoundExactly(digits, digitsEnd, explicitExponent, bits);
+
+	if (negative) bits |= 0x80000000;
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+//
+// FUNumberParser
+//
+
+FUNumberParser::FUNumberParser(const char* value)
+:	position(value), end(value)
+{
+	if (value != nullptr)
+	{
+		end = value + strlen(value);
+		position = SkipWhitespaces(value, end);
+	}
+}
+
+FUNumberParser::FUNumberParser(const char* value, size_t length)
+:	position(value), end(value)
+{
+	if (value != nullptr)
+	{
+		end = value + length;
+		position = SkipWhitespaces(value, end);
+	}
+}
+
+size_t FUNumberParser::CountValues() const
+{
+	const char* s = position;
+	size_t count = 0;
+	bool previousWhitespace = true;
+
+#ifdef FU_NUMBER_PARSER_SSE2
+	// A value starts on each non-whitespace character that follows a whitespace.
+	uint32 carry = 1;
+	for (; end - s >= 16; s += 16)
+	{
+		uint32 whitespaces = WhitespaceMask(s);
+		count += CountBits16(~whitespaces & ((whitespaces << 1) | carry) & 0xFFFF);
+		carry = whitespaces >> 15;
+	}
+	previousWhitespace = carry != 0;
+#endif // FU_NUMBER_PARSER_SSE2
+
+	for (; s < end; ++s)
+	{
+		bool whitespace = IsWhitespace(*s);
+		if (!whitespace && previousWhitespace) ++count;
+		previousWhitespace = whitespace;
+	}
+	return count;
+}
+
+float FUNumberParser::ReadFloat()
+{
+	float value;
+	return (ReadFloats(&value, 1) == 1) ? value : 0.0f;
+}
+
+int32 FUNumberParser::ReadInt32()
+{
+	int32 value;
+	return (ReadInt32s(&value, 1) == 1) ? value : 0;
+}
+
+uint32 FUNumberParser::ReadUInt32()
+{
+	uint32 value;
+	return (ReadUInt32s(&value, 1) == 1) ? value : 0;
+}
+
+size_t FUNumberParser::ReadFloats(float* values, size_t count)
+{
+	const char* s = position;
+	size_t i = 0;
+	for (; i < count && s != end; ++i)
+	{
+		values[i] = ParseFloat(s, end);
+		s = SkipWhitespaces(SkipToken(s, end), end);
+	}
+	position = s;
+	return i;
+}
+
+size_t FUNumberParser::ReadInt32s(int32* values, size_t count)
+{
+	const char* s = position;
+	size_t i = 0;
+	for (; i < count && s != end; ++i)
+	{
+		values[i] = ParseSigned(s, end);
+		s = SkipWhitespaces(SkipToken(s, end), end);
+	}
+	position = s;
+	return i;
+}
+
+size_t FUNumberParser::ReadUInt32s(uint32* values, size_t count)
+{
+	const char* s = position;
+	size_t i = 0;
+	for (; i < count && s != end; ++i)
+	{
+		values[i] = ParseUnsigned(s, end);
+		s = SkipWhitespaces(SkipToken(s, end), end);
+	}
+	position = s;
+	return i;
+}
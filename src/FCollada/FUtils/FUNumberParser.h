@@ -0,0 +1,92 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/**
+	@file FUNumberParser.h
+	This file contains the FUNumberParser class.
+*/
+
+#ifndef _FU_NUMBER_PARSER_H_
+#define _FU_NUMBER_PARSER_H_
+
+/**
+	A fast parser for lists of whitespace-separated numbers.
+
+	This parser reads the long lists of numbers found in the COLLADA
+	<float_array>, <int_array> and <p> elements. It follows the rules of
+	the FUStringConversion::ToFloat, ToInt32 and ToUInt32 functions:
+	a value that is not a valid number is read as zero and skipped.
+	Unlike these functions, the floating-point values are correctly rounded,
+	and a leading '+' sign is accepted.
+
+	On processors that support them, the whitespaces are classified
+	sixteen characters at a time with SSE2 instructions, and the digits
+	are converted eight at a time within a 64-bit register.
+
+	@ingroup FUtils
+*/
+class FCOLLADA_EXPORT FUNumberParser
+{
+private:
+	const char* position;
+	const char* end;
+
+public:
+	/** Constructor.
+		@param value A null-terminated string of whitespace-separated numbers. */
+	FUNumberParser(const char* value);
+
+	/** Constructor.
+		@param value A string of whitespace-separated numbers.
+		@param length The number of characters in the string. */
+	FUNumberParser(const char* value, size_t length);
+
+	/** Retrieves whether all the values were read.
+		@return Whether there are no more values to read. */
+	inline bool IsDone() const { return position == end; }
+
+	/** Retrieves the current position of the parser within the string.
+		@return The first character of the next value. */
+	inline const char* GetPosition() const { return position; }
+
+	/** Counts the values left to read, without reading them.
+		@return The number of values left. */
+	size_t CountValues() const;
+
+	/** Reads one floating-point value.
+		@return The value. Zero if there are no more values. */
+	float ReadFloat();
+
+	/** Reads one signed integer value.
+		@return The value. Zero if there are no more values. */
+	int32 ReadInt32();
+
+	/** Reads one unsigned integer value.
+		@return The value. Zero if there are no more values. */
+	uint32 ReadUInt32();
+
+	/** Reads a number of floating-point values.
+		@param values The array to fill in.
+		@param count The maximum number of values to read.
+		@return The number of values read. */
+	size_t ReadFloats(float* values, size_t count);
+
+	/** Reads a number of signed integer values.
+		@param values The array to fill in.
+		@param count The maximum number of values to read.
+		@return The number of values read. */
+	size_t ReadInt32s(int32* values, size_t count);
+
+	/** Reads a number of unsigned integer values.
+		@param values The array to fill in.
+		@param count The maximum number of values to read.
+		@return The number of values read. */
+	size_t ReadUInt32s(uint32* values, size_t count);
+};
+
+#endif // _FU_NUMBER_PARSER_H_
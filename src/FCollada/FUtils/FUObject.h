@@ -48,6 +48,16 @@ public:
 	/** Destructor. */
 	virtual ~FUObject();
 
+	/** Allocates an object through fm::Allocate, so that the objects
+		created while a memory arena is current come from the arena.
+		@param byteCount The size of the object, in bytes.
+		@return The object memory. */
+	static void* operator new(size_t byteCount) { return fm::Allocate(byteCount); }
+
+	/** Releases the memory of an object through fm::Release.
+		@param buffer The object memory. */
+	static void operator delete(void* buffer) { fm::Release(buffer); }
+
 	/** Releases this object.
 		This function essentially calls the destructor.
 		This function is virtual and is always
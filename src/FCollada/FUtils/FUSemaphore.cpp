@@ -12,11 +12,17 @@
 FUSemaphore::FUSemaphore(uint32 initialValue, uint32 maximumValue)
 #ifdef WIN32
 :	semaphoreHandle(nullptr)
+#else
+:	value(initialValue)
 #endif // WIN32
 {
-#ifdef WIN32
 	FUAssert(initialValue <= maximumValue, ;);
+#ifdef WIN32
 	semaphoreHandle = CreateSemaphore(nullptr, initialValue, maximumValue, nullptr);
+#else
+	(void) maximumValue;
+	pthread_mutex_init(&mutex, nullptr);
+	pthread_cond_init(&condition, nullptr);
 #endif
 }
 
@@ -24,6 +30,9 @@ FUSemaphore::~FUSemaphore()
 {
 #ifdef WIN32
 	CloseHandle(semaphoreHandle);
+#else
+	pthread_cond_destroy(&condition);
+	pthread_mutex_destroy(&mutex);
 #endif
 }
 
@@ -31,6 +40,11 @@ void FUSemaphore::Up()
 {
 #ifdef WIN32
 	ReleaseSemaphore(semaphoreHandle, 1, nullptr);
+#else
+	pthread_mutex_lock(&mutex);
+	++value;
+	pthread_cond_signal(&condition);
+	pthread_mutex_unlock(&mutex);
 #endif
 }
 
@@ -38,6 +52,11 @@ void FUSemaphore::Down()
 {
 #ifdef WIN32
 	WaitForSingleObject(semaphoreHandle, INFINITE);
+#else
+	pthread_mutex_lock(&mutex);
+	while (value == 0) pthread_cond_wait(&condition, &mutex);
+	--value;
+	pthread_mutex_unlock(&mutex);
 #endif
 }
 
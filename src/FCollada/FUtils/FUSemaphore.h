@@ -14,14 +14,14 @@
 #ifndef _FU_SEMAPHORE_H_
 #define _FU_SEMAPHORE_H_
 
-#ifdef __APPLE__
-#include <CoreServices/CoreServices.h>
+#ifndef WIN32
+#include <pthread.h>
 #endif
 
 /**
 	An OS independent semaphore.
 
-	Currently only supported for WIN32.
+	Based on the WIN32 semaphores and on POSIX mutexes and condition variables.
 
 	@ingroup FUtils
 */
@@ -30,10 +30,10 @@ class FCOLLADA_EXPORT FUSemaphore
 private:
 #ifdef WIN32
 	HANDLE semaphoreHandle; // WIN32
-#elif defined (__APPLE__)
-	MPTaskID semaphoreHandle;
 #else
-#warning "FUSemaphore: Semaphore not implemented for non Windows"
+	pthread_mutex_t mutex; // POSIX
+	pthread_cond_t condition;
+	uint32 value;
 #endif
 
 public:
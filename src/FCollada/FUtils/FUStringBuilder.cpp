@@ -31,53 +31,11 @@ template<> fstring FUStringBuilder::ToString() const
 	return fstring(ToCharPtr());
 }
 
-template<> void FUStringBuilder::append(uint32 i)
-{
-	fchar sz[128];
-	fsnprintf(sz, 128, FC("%u"), (unsigned int) i);
-	append(sz);
-}
-
-template<> void FUStringBuilder::append(uint64 i)
-{
-	fchar sz[128];
-	fsnprintf(sz, 128, FC("%u"), (unsigned int) i);
-	append(sz);
-}
-
-template<> void FUStringBuilder::append(int32 i)
-{
-	fchar sz[128];
-	fsnprintf(sz, 128, FC("%i"), (int) i);
-	append(sz);
-}
-
 #ifdef UNICODE
 template<> fm::string FUSStringBuilder::ToString() const
 {
 	return fm::string(ToCharPtr());
 }
-
-template<> void FUSStringBuilder::append(uint32 i)
-{
-	char sz[128];
-	snprintf(sz, 128, "%u", (unsigned int) i);
-	append(sz);
-}
-
-template<> void FUSStringBuilder::append(uint64 i)
-{
-	char sz[128];
-	snprintf(sz, 128, "%u", (unsigned int) i);
-	append(sz);
-}
-
-template<> void FUSStringBuilder::append(int32 i)
-{
-	char sz[128];
-	snprintf(sz, 128, "%i", (int) i);
-	append(sz);
-}
 #endif // UNICODE
 
 template class FUStringBuilderT<char>;
@@ -105,6 +63,10 @@ FCOLLADA_EXPORT void TrickLinker2()
 		b5.append(FMVector2::Zero); d5.append(FMVector2::Zero);
 		b5.append(FMVector3::Zero); d5.append(FMVector3::Zero);
 		b5.append(FMVector4::Zero); d5.append(FMVector4::Zero);
+		float f[1] = { 1.0f }; int32 i[1] = { -1 }; uint32 u[1] = { 1 };
+		b5.appendValues(f, 1); d5.appendValues(f, 1);
+		b5.appendValues(i, 1); d5.appendValues(i, 1);
+		b5.appendValues(u, 1); d5.appendValues(u, 1);
 		b5.back(); d5.back();
 		b1.appendLine("Test"); d1.appendLine(FC("Test"));
 		b1.appendHex((uint8) 4); d1.appendHex((uint8) 4);
@@ -144,10 +144,22 @@ public:
 		that represents infinity, the string "INF" is appended. If it represents
 		the negative infinity, the string "-INF" is appended. If it represents the
 		impossibility, the string "NaN" is appended.
+		The single-precision values are written with the fewest digits
+		that read back to the same value: see FUNumberFormatter.
+		The double-precision values are written with six significant digits.
 		@param f A floating-point value. */
 	void append(float f);
 	void append(double f); /**< See above. */
 
+	/** Appends a list of numerical values, separated by spaces,
+		to the content of the builder. The buffer is enlarged once,
+		and the values are written directly within it.
+		@param values The list of values.
+		@param count The number of values in the list. */
+	void appendValues(const float* values, size_t count);
+	void appendValues(const int32* values, size_t count); /**< See above. */
+	void appendValues(const uint32* values, size_t count); /**< See above. */
+
 	/** Appends a vector to the content of the builder.
 		@param v A vector. */
 	void append(const FMVector2& v);
@@ -18,6 +18,10 @@
 #include <float.h>
 #endif
 
+#ifndef _FU_NUMBER_FORMATTER_H_
+#include "FUtils/FUNumberFormatter.h"
+#endif // _FU_NUMBER_FORMATTER_H_
+
 #ifdef WIN32
 #define ecvt _ecvt
 #endif // WIN32
@@ -231,30 +235,32 @@ void FUStringBuilderT<Char>::append(const FUStringBuilderT& b)
 	size += b.size;
 }
 
+template <class Char>
+void FUStringBuilderT<Char>::append(int32 i)
+{
+	if (size + FUNumberFormatter::MAX_INT32_LENGTH >= reserved) enlarge(FUNumberFormatter::MAX_INT32_LENGTH);
+	size += FUNumberFormatter::FormatInt32(i, buffer + size);
+}
+
+template <class Char>
+void FUStringBuilderT<Char>::append(uint32 i)
+{
+	if (size + FUNumberFormatter::MAX_UINT32_LENGTH >= reserved) enlarge(FUNumberFormatter::MAX_UINT32_LENGTH);
+	size += FUNumberFormatter::FormatUInt32(i, buffer + size);
+}
+
+template <class Char>
+void FUStringBuilderT<Char>::append(uint64 i)
+{
+	if (size + FUNumberFormatter::MAX_UINT64_LENGTH >= reserved) enlarge(FUNumberFormatter::MAX_UINT64_LENGTH);
+	size += FUNumberFormatter::FormatUInt64(i, buffer + size);
+}
+
 template <class Char>
 void FUStringBuilderT<Char>::append(float f)
 {
-#ifdef WIN32
-	// use <float.h> _isnan method to detect the 1.#IND00 NaN.
-	if (f != std::numeric_limits<float>::infinity() && f != -std::numeric_limits<float>::infinity() && f != std::numeric_limits<float>::quiet_NaN() && f != std::numeric_limits<float>::signaling_NaN() && !_isnan((double)f))
-#else
-	if (f != std::numeric_limits<float>::infinity() && f != -std::numeric_limits<float>::infinity() && f != std::numeric_limits<float>::quiet_NaN() && f != std::numeric_limits<float>::signaling_NaN())
-#endif
-	{
-		if (IsEquivalent(f, 0.0f, std::numeric_limits<float>::epsilon())) append((Char)'0');
-		else
-		{
-			Char sz[128];
-			FloatToString(f, sz);
-			append(sz + 1);
-		}
-	}
-	else if (f == std::numeric_limits<float>::infinity())
-	{ append((Char)'I'); append((Char)'N'); append((Char)'F'); }
-	else if (f == -std::numeric_limits<float>::infinity())
-	{ append((Char)'-'); append((Char)'I'); append((Char)'N'); append((Char)'F'); }
-	else
-	{ append((Char)'N'); append((Char)'a'); append((Char)'N'); }
+	if (size + FUNumberFormatter::MAX_FLOAT_LENGTH >= reserved) enlarge(FUNumberFormatter::MAX_FLOAT_LENGTH);
+	size += FUNumberFormatter::FormatFloat(f, buffer + size);
 }
 
 template <class Char>
@@ -291,6 +297,57 @@ void FUStringBuilderT<Char>::append(double f)
 	}
 }
 
+template <class Char>
+void FUStringBuilderT<Char>::appendValues(const float* values, size_t count)
+{
+	if (count == 0) return;
+	size_t maximum = count * (FUNumberFormatter::MAX_FLOAT_LENGTH + 1);
+	if (size + maximum >= reserved) enlarge(size + maximum - reserved);
+
+	Char* c = buffer + size;
+	c += FUNumberFormatter::FormatFloat(*values, c);
+	for (const float* end = values + count; ++values != end;)
+	{
+		*(c++) = (Char) ' ';
+		c += FUNumberFormatter::FormatFloat(*values, c);
+	}
+	size = c - buffer;
+}
+
+template <class Char>
+void FUStringBuilderT<Char>::appendValues(const int32* values, size_t count)
+{
+	if (count == 0) return;
+	size_t maximum = count * (FUNumberFormatter::MAX_INT32_LENGTH + 1);
+	if (size + maximum >= reserved) enlarge(size + maximum - reserved);
+
+	Char* c = buffer + size;
+	c += FUNumberFormatter::FormatInt32(*values, c);
+	for (const int32* end = values + count; ++values != end;)
+	{
+		*(c++) = (Char) ' ';
+		c += FUNumberFormatter::FormatInt32(*values, c);
+	}
+	size = c - buffer;
+}
+
+template <class Char>
+void FUStringBuilderT<Char>::appendValues(const uint32* values, size_t count)
+{
+	if (count == 0) return;
+	size_t maximum = count * (FUNumberFormatter::MAX_UINT32_LENGTH + 1);
+	if (size + maximum >= reserved) enlarge(size + maximum - reserved);
+
+	Char* c = buffer + size;
+	c += FUNumberFormatter::FormatUInt32(*values, c);
+	for (const uint32* end = values + count; ++values != end;)
+	{
+		*(c++) = (Char) ' ';
+		c += FUNumberFormatter::FormatUInt32(*values, c);
+	}
+	size = c - buffer;
+}
+
 template <class Char>
 void FUStringBuilderT<Char>::append(const FMVector2& v)
 {
@@ -9,6 +9,7 @@
 #include "StdAfx.h"
 #include "FUTestBed.h"
 #include "FUString.h"
+#include <limits>
 
 TESTSUITE_START(FUStringBuilder)
 
@@ -48,14 +49,12 @@ TESTSUITE_TEST(1, Modifications)
 TESTSUITE_TEST(2, ExtremeNumbers)
 	FUSStringBuilder builder;
 
+	// The single-precision values are written with the fewest digits that read back to the same value.
 	builder.set(-10231.52f);
-	// Last time I checked: we had 6 digits of precision.
-	// If this one fails: the number of digits of precisions have changed
-	// and the strings below are now useless.
-	PassIf(IsEquivalent(builder.ToCharPtr(), "-10231.5"));
+	PassIf(IsEquivalent(builder.ToCharPtr(), "-10231.52"));
 
 	builder.set(123456789.0f);
-	PassIf(IsEquivalent(builder.ToCharPtr(), "1.23457e8"));
+	PassIf(IsEquivalent(builder.ToCharPtr(), "1.2345679e8"));
 
 	builder.set(1e16f);
 	PassIf(IsEquivalent(builder.ToCharPtr(), "1e16"));
@@ -69,8 +68,40 @@ TESTSUITE_TEST(2, ExtremeNumbers)
 	builder.set(9.55e9f);
 	PassIf(IsEquivalent(builder.ToCharPtr(), "9.55e9"));
 
-	// Right now, the expected behavior for very small numbers is to output a zero.
 	builder.set(-1e-16f);
-	PassIf(IsEquivalent(builder.ToCharPtr(), "0"));
+	PassIf(IsEquivalent(builder.ToCharPtr(), "-1e-16"));
+
+	builder.set(0.1f);
+	PassIf(IsEquivalent(builder.ToCharPtr(), "0.1"));
+
+	builder.set(1.0f / 3.0f);
+	PassIf(IsEquivalent(builder.ToCharPtr(), "0.33333334"));
+
+	builder.set(0.00001f);
+	PassIf(IsEquivalent(builder.ToCharPtr(), "0.00001"));
+
+	builder.set(100000.0f);
+	PassIf(IsEquivalent(builder.ToCharPtr(), "100000"));
+
+	builder.set(1e6f);
+	PassIf(IsEquivalent(builder.ToCharPtr(), "1e6"));
+
+	builder.set(-0.0f);
+	PassIf(IsEquivalent(builder.ToCharPtr(), "-0"));
+
+	builder.set(std::numeric_limits<float>::infinity());
+	PassIf(IsEquivalent(builder.ToCharPtr(), "INF"));
+
+	builder.set(-std::numeric_limits<float>::infinity());
+	PassIf(IsEquivalent(builder.ToCharPtr(), "-INF"));
+
+	builder.set(std::numeric_limits<float>::quiet_NaN());
+	PassIf(IsEquivalent(builder.ToCharPtr(), "NaN"));
+
+	builder.set((int32) -2147483647 - 1);
+	PassIf(IsEquivalent(builder.ToCharPtr(), "-2147483648"));
+
+	builder.set((uint64) 18446744073709551615ULL);
+	PassIf(IsEquivalent(builder.ToCharPtr(), "18446744073709551615"));
 
 TESTSUITE_END
@@ -14,6 +14,7 @@
 
 #include "StdAfx.h"
 #include "FUStringConversion.h"
+#include "FUNumberParser.h"
 #ifndef __APPLE__
 #include "FUStringConversion.hpp"
 #endif // __APPLE__
@@ -241,11 +242,84 @@ int32 FUStringConversion::ParseQualifier(const char* qualifier)
 	return returnValue;
 }
 
+template <>
+FCOLLADA_EXPORT void FUStringConversion::ToFloatList<char>(const char* value, FloatList& array)
+{
+	FUNumberParser parser(value);
+	array.resize(parser.CountValues());
+	array.resize(parser.ReadFloats(array.begin(), array.size()));
+}
+
+template <>
+FCOLLADA_EXPORT void FUStringConversion::ToInt32List<char>(const char* value, Int32List& array)
+{
+	FUNumberParser parser(value);
+	array.resize(parser.CountValues());
+	array.resize(parser.ReadInt32s(array.begin(), array.size()));
+}
+
+template <>
+FCOLLADA_EXPORT void FUStringConversion::ToUInt32List<char>(const char* value, UInt32List& array)
+{
+	FUNumberParser parser(value);
+	array.resize(parser.CountValues());
+	array.resize(parser.ReadUInt32s(array.begin(), array.size()));
+}
+
+template <>
+FCOLLADA_EXPORT void FUStringConversion::ToInterleavedFloatList<char>(const char* value, fm::pvector<FloatList>& arrays)
+{
+	size_t stride = arrays.size();
+	if (stride == 0) return;
+
+	FUNumberParser parser(value);
+	size_t count = parser.CountValues() / stride;
+	for (size_t i = 0; i < stride; ++i)
+	{
+		if (arrays[i] != nullptr) arrays[i]->resize(count);
+	}
+
+	// Only the complete sets of interleaved values are kept.
+	for (size_t index = 0; index < count; ++index)
+	{
+		for (size_t i = 0; i < stride; ++i)
+		{
+			float f = parser.ReadFloat();
+			if (arrays[i] != nullptr) arrays[i]->at(index) = f;
+		}
+	}
+}
+
+template <>
+FCOLLADA_EXPORT void FUStringConversion::ToInterleavedUInt32List<char>(const char* value, fm::pvector<UInt32List>& arrays)
+{
+	size_t stride = arrays.size();
+	if (stride == 0) return;
+
+	FUNumberParser parser(value);
+	size_t count = parser.CountValues() / stride;
+	for (size_t i = 0; i < stride; ++i)
+	{
+		if (arrays[i] != nullptr) arrays[i]->resize(count);
+	}
+
+	// Only the complete sets of interleaved values are kept.
+	for (size_t index = 0; index < count; ++index)
+	{
+		for (size_t i = 0; i < stride; ++i)
+		{
+			uint32 u = parser.ReadUInt32();
+			if (arrays[i] != nullptr) arrays[i]->at(index) = u;
+		}
+	}
+}
+
 #ifndef _MSC_VER
 template FMVector2 FUStringConversion::ToVector2<char>(const char**);
 template FMVector3 FUStringConversion::ToVector3<char>(const char**);
 template FMVector4 FUStringConversion::ToVector4<char>(const char**);
 
+template size_t FUStringConversion::CountValues<char>(const char*);
 template bool FUStringConversion::ToBoolean<char>(const char*);
 template int FUStringConversion::ToInt32<char>(const char**);
 template unsigned int FUStringConversion::ToUInt32<char>(const char**);
@@ -253,13 +327,8 @@ template unsigned int FUStringConversion::HexToUInt32<char>(const char**, unsign
 
 template void FUStringConversion::ToBooleanList<char>(const char*, fm::vector<bool, true>&);
 template void FUStringConversion::ToDateTime<char>(const char*, FUDateTime&);
-template void FUStringConversion::ToFloatList<char>(const char*, fm::vector<float, true>&);
-template void FUStringConversion::ToInt32List<char>(const char*, fm::vector<int, true>&);
-template void FUStringConversion::ToInterleavedFloatList<char>(char const*, fm::pvector<fm::vector<float, true> >&);
-template void FUStringConversion::ToInterleavedUInt32List<char>(char const*, fm::pvector<fm::vector<unsigned int, true> >&);
 template void FUStringConversion::ToMatrix<char>(const char**, FMMatrix44&);
 template void FUStringConversion::ToMatrixList<char>(const char*, fm::vector<FMMatrix44, false>&);
-template void FUStringConversion::ToUInt32List<char>(const char*, fm::vector<unsigned int, true>&);
 template void FUStringConversion::ToVector3List<char>(const char*, fm::vector<FMVector3, false>&);
 
 template void FUStringConversion::ToString<char>(FUStringBuilderT<char>&, const FMVector2&);
@@ -280,6 +349,8 @@ extern void TrickLinkerFUStringConversion(void)
 	const fchar* fc = emptyFCharString;
 	float f = FUStringConversion::ToFloat(&c);
 	f = FUStringConversion::ToFloat(&fc);
+	size_t count = FUStringConversion::CountValues(c);
+	count = FUStringConversion::CountValues(fc);
 	bool b = FUStringConversion::ToBoolean(c);
 	b = FUStringConversion::ToBoolean(fc);
 	int32 i32 = FUStringConversion::ToInt32(&c);
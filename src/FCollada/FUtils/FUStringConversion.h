@@ -387,6 +387,18 @@ public:
 	static FCOLLADA_EXPORT size_t CountValues(const CH* sz);
 };
 
+#ifdef HAS_VECTORTYPES
+
+// The lists of numbers within 8-bit strings, such as the ones read from the XML documents,
+// are parsed in bulk by the FUNumberParser, rather than one value at a time.
+template <> FCOLLADA_EXPORT void FUStringConversion::ToFloatList<char>(const char* value, FloatList& array);
+template <> FCOLLADA_EXPORT void FUStringConversion::ToInt32List<char>(const char* value, Int32List& array);
+template <> FCOLLADA_EXPORT void FUStringConversion::ToUInt32List<char>(const char* value, UInt32List& array);
+template <> FCOLLADA_EXPORT void FUStringConversion::ToInterleavedFloatList<char>(const char* value, fm::pvector<FloatList>& arrays);
+template <> FCOLLADA_EXPORT void FUStringConversion::ToInterleavedUInt32List<char>(const char* value, fm::pvector<UInt32List>& arrays);
+
+#endif // HAS_VECTORTYPES
+
 #ifdef __APPLE__
 #include "FUtils/FUStringConversion.hpp"
 #endif // __APPLE__
@@ -256,10 +256,15 @@ FCOLLADA_EXPORT FMVector4 FUStringConversion::ToVector4(const CH** value)
 template <class CH>
 FCOLLADA_EXPORT void FUStringConversion::ToString(FUStringBuilderT<CH>& builder, const FMMatrix44& m)
 {
-	VAL(m[0][0]); SPACE; VAL(m[1][0]); SPACE; VAL(m[2][0]); SPACE; VAL(m[3][0]); SPACE;
-	VAL(m[0][1]); SPACE; VAL(m[1][1]); SPACE; VAL(m[2][1]); SPACE; VAL(m[3][1]); SPACE;
-	VAL(m[0][2]); SPACE; VAL(m[1][2]); SPACE; VAL(m[2][2]); SPACE; VAL(m[3][2]); SPACE;
-	VAL(m[0][3]); SPACE; VAL(m[1][3]); SPACE; VAL(m[2][3]); SPACE; VAL(m[3][3]);
+	// COLLADA matrices are written row after row.
+	float values[16] =
+	{
+		m[0][0], m[1][0], m[2][0], m[3][0],
+		m[0][1], m[1][1], m[2][1], m[3][1],
+		m[0][2], m[1][2], m[2][2], m[3][2],
+		m[0][3], m[1][3], m[2][3], m[3][3]
+	};
+	builder.appendValues(values, 16);
 }
 
 template <class CH>
@@ -560,9 +565,7 @@ FCOLLADA_EXPORT void FUStringConversion::ToString(FUStringBuilderT<CH>& builder,
 {
 	if (values.empty()) return;
 	if (!builder.empty()) SPACE;
-	FloatList::const_iterator itV = values.begin();
-	builder.append(*itV);
-	for (++itV; itV != values.end(); ++itV) { SPACE; VAL(*itV); }
+	builder.appendValues(values.begin(), values.size());
 }
 
 template <class CH>
@@ -570,19 +573,15 @@ FCOLLADA_EXPORT void FUStringConversion::ToString(FUStringBuilderT<CH>& builder,
 {
 	if (values.empty()) return;
 	if (!builder.empty()) SPACE;
-	Int32List::const_iterator itV = values.begin();
-	builder.append(*itV);
-	for (++itV; itV != values.end(); ++itV) { SPACE; VAL(*itV); }
+	builder.appendValues(values.begin(), values.size());
 }
 
 template <class CH>
 FCOLLADA_EXPORT void FUStringConversion::ToString(FUStringBuilderT<CH>& builder, const uint32* values, size_t count)
 {
-	if (count > 0)
-	{
-		if (builder.empty()) { builder.append(*values++); --count; }
-		while (((intptr_t) count) > 0) { SPACE; VAL(*values++); --count; }
-	}
+	if (count == 0) return;
+	if (!builder.empty()) SPACE;
+	builder.appendValues(values, count);
 }
 
 #endif // HAS_VECTORTYPES
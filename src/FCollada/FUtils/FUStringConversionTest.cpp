@@ -9,6 +9,8 @@
 #include "StdAfx.h"
 #include "FUTestBed.h"
 #include "FUString.h"
+#include <cfloat>
+#include <limits>
 
 TESTSUITE_START(FUStringConversion)
 
@@ -93,4 +95,95 @@ TESTSUITE_TEST(6, FloatList)
 	PassIf(values.size() == 6);
 	PassIf(IsEquivalent(values, expected, expectedCount));
 
+TESTSUITE_TEST(7, FloatListRounding)
+	// The values close to half-way between two floats must be correctly rounded.
+	const char* sz = "1.00000005960464477539062499 1.000000059604644775390625 1.00000005960464477539062501 "
+		"7e-46 7.1e-46 3.4028235e38 3.4028236e38 -0 +2.5 -INF 0.1 33554431 1e-10";
+	FloatList values;
+	FUStringConversion::ToFloatList(sz, values);
+	PassIf(values.size() == 13);
+	PassIf(values[0] == 1.0f);
+	PassIf(values[1] == 1.0f);
+	PassIf(values[2] == 1.00000012f);
+	PassIf(values[3] == 0.0f);
+	PassIf(values[4] == std::numeric_limits<float>::denorm_min());
+	PassIf(values[5] == FLT_MAX);
+	PassIf(values[6] == std::numeric_limits<float>::infinity());
+	PassIf(values[7] == 0.0f);
+	PassIf(values[8] == 2.5f);
+	PassIf(values[9] == -std::numeric_limits<float>::infinity());
+	PassIf(values[10] == 0.1f);
+	PassIf(values[11] == 33554432.0f);
+	PassIf(values[12] == 1e-10f);
+
+TESTSUITE_TEST(8, BulkLists)
+	// Long lists are read with sixteen whitespaces and eight digits at a time.
+	FUSStringBuilder builder("  \n");
+	for (uint32 i = 0; i < 1000; ++i)
+	{
+		builder.append(i * 7919);
+		builder.append((i % 3) == 0 ? "\r\n\t\t\t\t\t\t\t\t\t " : " ");
+	}
+	UInt32List values;
+	FUStringConversion::ToUInt32List(builder.ToCharPtr(), values);
+	PassIf(values.size() == 1000);
+	bool valuesMatch = true;
+	for (uint32 i = 0; i < 1000 && valuesMatch; ++i) valuesMatch = values[i] == i * 7919;
+	PassIf(valuesMatch);
+
+	// Invalid values are read as zero, and the rest of their characters are skipped.
+	Int32List signedValues;
+	FUStringConversion::ToInt32List("12 abc -7 3.5 -2147483648 4294967295", signedValues);
+	const int32 expectedSigned[] = { 12, 0, -7, 3, INT_MIN, -1 };
+	PassIf(IsEquivalent(signedValues, expectedSigned, sizeof(expectedSigned) / sizeof(int32)));
+
+	// Only the complete sets of interleaved values are kept.
+	FloatList x, y;
+	fm::pvector<FloatList> arrays;
+	arrays.push_back(&x);
+	arrays.push_back(nullptr);
+	arrays.push_back(&y);
+	FUStringConversion::ToInterleavedFloatList("1 2 3 4.5 5 6.5 7", arrays);
+	const float expectedX[] = { 1.0f, 4.5f }, expectedY[] = { 3.0f, 6.5f };
+	PassIf(IsEquivalent(x, expectedX, 2));
+	PassIf(IsEquivalent(y, expectedY, 2));
+
+TESTSUITE_TEST(9, FloatListRoundTrip)
+	// The written values must read back to the exact same bits.
+	FloatList values;
+	uint32 bits = 0x3F800000;
+	for (uint32 i = 0; i < 5000; ++i)
+	{
+		bits = bits * 1664525 + 1013904223;
+		float f;
+		memcpy(&f, &bits, sizeof(f));
+		if (f == f) values.push_back(f);
+	}
+	values.push_back(FLT_MIN);
+	values.push_back(FLT_MAX);
+	values.push_back(-0.0f);
+	values.push_back(std::numeric_limits<float>::denorm_min());
+	values.push_back(std::numeric_limits<float>::infinity());
+
+	FUSStringBuilder builder;
+	FUStringConversion::ToString(builder, values);
+	FloatList readValues;
+	FUStringConversion::ToFloatList(builder.ToCharPtr(), readValues);
+	PassIf(readValues.size() == values.size());
+	PassIf(memcmp(readValues.begin(), values.begin(), values.size() * sizeof(float)) == 0);
+
+	// Matrices are written row after row.
+	FMMatrix44 m(FMMatrix44::Identity);
+	m[3][0] = 0.1f; m[3][1] = -2.5e-8f;
+	builder.clear();
+	FUStringConversion::ToString(builder, m);
+	PassIf(IsEquivalent(builder.ToCharPtr(), "1 0 0 0.1 0 1 0 -2.5e-8 0 0 1 0 0 0 0 1"));
+
+	Int32List signedValues;
+	const int32 expectedSigned[] = { 0, -1, 7, INT_MAX, INT_MIN };
+	for (size_t i = 0; i < sizeof(expectedSigned) / sizeof(int32); ++i) signedValues.push_back(expectedSigned[i]);
+	builder.set("x");
+	FUStringConversion::ToString(builder, signedValues);
+	PassIf(IsEquivalent(builder.ToCharPtr(), "x 0 -1 7 2147483647 -2147483648"));
+
 TESTSUITE_END
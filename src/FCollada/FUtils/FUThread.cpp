@@ -8,12 +8,17 @@
 
 #include "StdAfx.h"
 #include "FUThread.h"
+#ifndef WIN32
+#include <sched.h>
+#include <unistd.h>
+#endif
 
 FUThread::FUThread()
+:	function(nullptr), parameter(nullptr)
+{
 #ifdef WIN32
-:	thread(nullptr)
+	thread = nullptr;
 #endif
-{
 }
 
 FUThread::~FUThread()
@@ -24,6 +29,8 @@ void FUThread::YieldCurrentThread()
 {
 #ifdef WIN32
 	SwitchToThread();
+#else
+	sched_yield();
 #endif
 }
 
@@ -31,32 +38,59 @@ void FUThread::SleepCurrentThread(unsigned long milliseconds)
 {
 #ifdef WIN32
 	Sleep(milliseconds);
+#else
+	usleep((useconds_t) milliseconds * 1000);
 #endif
 }
 
 #ifdef WIN32
 FUThread* FUThread::CreateFUThread(LPTHREAD_START_ROUTINE lpStartAddress, void* lpParameter)
-#else
-FUThread* FUThread::CreateFUThread()
-#endif // WIN32
 {
-#ifdef WIN32
 	FUThread* newThread = new FUThread();
 	newThread->thread = CreateThread(nullptr, 0, lpStartAddress, lpParameter, 0, nullptr);
 	return newThread;
+}
+
+DWORD WINAPI FUThread::Run(void* thread)
+{
+	FUThread* fuThread = (FUThread*) thread;
+	(*fuThread->function)(fuThread->parameter);
+	return 0;
+}
 #else
+void* FUThread::Run(void* thread)
+{
+	FUThread* fuThread = (FUThread*) thread;
+	(*fuThread->function)(fuThread->parameter);
 	return nullptr;
+}
+#endif // WIN32
+
+FUThread* FUThread::CreateFUThread(ThreadFunction function, void* parameter)
+{
+	FUAssert(function != nullptr, return nullptr);
+	FUThread* newThread = new FUThread();
+	newThread->function = function;
+	newThread->parameter = parameter;
+#ifdef WIN32
+	newThread->thread = CreateThread(nullptr, 0, Run, newThread, 0, nullptr);
+	if (newThread->thread == nullptr) SAFE_DELETE(newThread);
+#else
+	if (pthread_create(&newThread->thread, nullptr, Run, newThread) != 0) SAFE_DELETE(newThread);
 #endif
+	return newThread;
 }
 
 void FUThread::ExitFUThread(FUThread* thread)
 {
-#ifdef WIN32
 	if (thread == nullptr) return;
 
+#ifdef WIN32
 	WaitForSingleObject(thread->thread, INFINITE);
 	CloseHandle(thread->thread); // delete the thread once it's finished
-	SAFE_DELETE(thread);
+#else
+	pthread_join(thread->thread, nullptr);
 #endif
+	SAFE_DELETE(thread);
 }
 
@@ -14,21 +14,32 @@
 #ifndef _FU_THREAD_H_
 #define _FU_THREAD_H_
 
+#ifndef WIN32
+#include <pthread.h>
+#endif
+
 /**
 	An OS independent thread.
 
-	Currently only supported for WIN32.
+	Based on the WIN32 threads and on the POSIX threads.
 
 	@ingroup FUtils
 */
 class FCOLLADA_EXPORT FUThread
 {
+public:
+	/** The procedure run by a thread.
+		@param parameter The parameter given to CreateFUThread. */
+	typedef void (*ThreadFunction)(void* parameter);
+
 private:
 #ifdef WIN32
 	HANDLE thread;
 #else
-#warning "Threads not yet implemented for non Windows."
+	pthread_t thread;
 #endif
+	ThreadFunction function;
+	void* parameter;
 
 private:
 	/** Constructor. */
@@ -40,13 +51,15 @@ public:
 
 	/** Creates a thread.
 		The thread must be passed to ExitFUThread for everything to be destroyed properly.
-		@param lpStartAddress The procedure to start the new thread running.
-		@param lpParameter The parameter to pass to the new thread.
-		@return The new OS independent thread. */
+		@param function The procedure to start the new thread running.
+		@param parameter The parameter to pass to the new thread.
+		@return The new OS independent thread. This pointer is nullptr
+			if the thread could not be created. */
+	static FUThread* CreateFUThread(ThreadFunction function, void* parameter);
+
 #ifdef WIN32
+	/** See above. */
 	static FUThread* CreateFUThread(LPTHREAD_START_ROUTINE lpStartAddress, void* lpParameter);
-#else
-	static FUThread* CreateFUThread(); // TODO: implement and merge with WIN32, removing the LPTHREAD_START_ROUTINE
 #endif
 
 	/** Waits for the thread to exit and clean up after it.
@@ -59,6 +72,13 @@ public:
 	/** Sleeps the current thread for a minimum specified duration.
 		@param milliseconds The duration to sleep. */
 	static void SleepCurrentThread(unsigned long milliseconds);
+
+private:
+#ifdef WIN32
+	static DWORD WINAPI Run(void* thread);
+#else
+	static void* Run(void* thread);
+#endif
 };
 
 #endif // _FU_THREAD_H_
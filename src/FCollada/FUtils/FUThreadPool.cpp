@@ -0,0 +1,125 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#include "StdAfx.h"
+#include "FUThreadPool.h"
+#include "FUThread.h"
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+//
+// FUThreadPool
+//
+
+static size_t GetWorkerCount(size_t threadCount)
+{
+	if (threadCount == 0) threadCount = FUThreadPool::GetProcessorCount();
+	return (threadCount > 1) ? threadCount - 1 : 0;
+}
+
+FUThreadPool::FUThreadPool(size_t threadCount)
+:	startSemaphore(0, (uint32) max(GetWorkerCount(threadCount), (size_t) 1))
+,	doneSemaphore(0, (uint32) max(GetWorkerCount(threadCount), (size_t) 1))
+,	busy(false), quitting(false)
+,	function(nullptr), userData(nullptr), taskCount(0), nextTask(0)
+{
+	size_t workerCount = GetWorkerCount(threadCount);
+	workers.reserve(workerCount);
+	for (size_t i = 0; i < workerCount; ++i)
+	{
+		FUThread* worker = FUThread::CreateFUThread(WorkerThread, this);
+		if (worker == nullptr) break;
+		workers.push_back(worker);
+	}
+}
+
+FUThreadPool::~FUThreadPool()
+{
+	// Wake up all the worker threads, so that they exit.
+	quitting = true;
+	for (size_t i = 0; i < workers.size(); ++i) startSemaphore.Up();
+	for (FUThread** it = workers.begin(); it != workers.end(); ++it)
+	{
+		FUThread::ExitFUThread(*it);
+	}
+	workers.clear();
+}
+
+void FUThreadPool::Run(TaskFunction _function, void* _userData, size_t _taskCount)
+{
+	FUAssert(_function != nullptr, return);
+
+	criticalSection.Enter();
+	bool available = !busy && !workers.empty() && _taskCount > 1;
+	if (available)
+	{
+		busy = true;
+		function = _function;
+		userData = _userData;
+		taskCount = _taskCount;
+		nextTask = 0;
+	}
+	criticalSection.Leave();
+
+	if (!available)
+	{
+		// Process all the tasks on the calling thread.
+		for (size_t i = 0; i < _taskCount; ++i) (*_function)(_userData, i);
+		return;
+	}
+
+	// Wake up the worker threads and help them until all the tasks are processed.
+	for (size_t i = 0; i < workers.size(); ++i) startSemaphore.Up();
+	ProcessTasks();
+	for (size_t i = 0; i < workers.size(); ++i) doneSemaphore.Down();
+
+	criticalSection.Enter();
+	busy = false;
+	function = nullptr;
+	userData = nullptr;
+	criticalSection.Leave();
+}
+
+void FUThreadPool::ProcessTasks()
+{
+	for (;;)
+	{
+		criticalSection.Enter();
+		size_t index = nextTask;
+		if (index < taskCount) ++nextTask;
+		criticalSection.Leave();
+
+		if (index >= taskCount) break;
+		(*function)(userData, index);
+	}
+}
+
+void FUThreadPool::WorkerThread(void* _pool)
+{
+	FUThreadPool* pool = (FUThreadPool*) _pool;
+	for (;;)
+	{
+		pool->startSemaphore.Down();
+		if (pool->quitting) break;
+		pool->ProcessTasks();
+		pool->doneSemaphore.Up();
+	}
+}
+
+size_t FUThreadPool::GetProcessorCount()
+{
+#ifdef WIN32
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	return max((size_t) systemInfo.dwNumberOfProcessors, (size_t) 1);
+#else
+	long processorCount = sysconf(_SC_NPROCESSORS_ONLN);
+	return (processorCount > 0) ? (size_t) processorCount : 1;
+#endif
+}
@@ -0,0 +1,90 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/**
+	@file FUThreadPool.h
+	This file contains the FUThreadPool class.
+*/
+
+#ifndef _FU_THREAD_POOL_H_
+#define _FU_THREAD_POOL_H_
+
+#ifndef _FU_SEMAPHORE_H_
+#include "FUtils/FUSemaphore.h"
+#endif // _FU_SEMAPHORE_H_
+
+class FUThread;
+
+/**
+	A pool of worker threads.
+
+	The worker threads are created once, with the pool, and sleep
+	until a set of tasks is given to the pool. The thread that gives the
+	tasks to the pool also processes tasks, until all of them are done.
+
+	Only one set of tasks runs on the pool at once. If the pool is busy, or
+	if a task itself tries to run tasks on the pool, the tasks are processed
+	directly on the calling thread.
+
+	@ingroup FUtils
+*/
+class FCOLLADA_EXPORT FUThreadPool
+{
+public:
+	/** A task function.
+		@param userData The data given to the Run function.
+		@param index The index of the task to process. */
+	typedef void (*TaskFunction)(void* userData, size_t index);
+
+private:
+	fm::pvector<FUThread> workers;
+	FUSemaphore startSemaphore;
+	FUSemaphore doneSemaphore;
+	FUCriticalSection criticalSection;
+	bool busy;
+	bool quitting;
+
+	// The set of tasks that currently runs on the pool.
+	TaskFunction function;
+	void* userData;
+	size_t taskCount;
+	size_t nextTask;
+
+public:
+	/** Constructor.
+		@param threadCount The number of threads that process the tasks,
+			including the thread that gives the tasks to the pool.
+			When zero, one thread per processor is used. */
+	FUThreadPool(size_t threadCount = 0);
+
+	/** Destructor.
+		Waits for the worker threads to exit. */
+	~FUThreadPool();
+
+	/** Retrieves the number of threads that process the tasks.
+		@return The number of threads, including the calling thread. */
+	inline size_t GetThreadCount() const { return workers.size() + 1; }
+
+	/** Processes a set of tasks on the pool.
+		This function returns once all the tasks are processed.
+		The tasks are not processed in any particular order.
+		@param function The task function.
+		@param userData The data given to the task function.
+		@param taskCount The number of tasks to process. */
+	void Run(TaskFunction function, void* userData, size_t taskCount);
+
+	/** Retrieves the number of processors of this computer.
+		@return The number of processors. */
+	static size_t GetProcessorCount();
+
+private:
+	void ProcessTasks();
+	static void WorkerThread(void* pool);
+};
+
+#endif // _FU_THREAD_POOL_H_
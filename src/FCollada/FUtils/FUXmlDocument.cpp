@@ -13,7 +13,41 @@
 #include "FUFile.h"
 #include "FCDocument/FCDocument.h"
 
+#include <libxml/parser.h>
+
 #define MAX_FILE_SIZE 10240000
+
+// Parses a XML document held in memory. LibXML takes int lengths,
+// so the documents over 2GB are pushed to the parser in blocks.
+static xmlDoc* ParseXmlMemory(const char* data, size_t length)
+{
+	// The arrays of large meshes and animations easily go over the default 10MB limit on text nodes.
+	if (length <= (size_t) INT_MAX) return xmlReadMemory(data, (int) length, nullptr, nullptr, XML_PARSE_HUGE);
+
+	xmlParserCtxt* context = xmlCreatePushParserCtxt(nullptr, nullptr, nullptr, 0, nullptr);
+	if (context == nullptr) return nullptr;
+	xmlCtxtUseOptions(context, XML_PARSE_HUGE);
+
+	static const size_t blockLength = 1 << 30;
+	bool parsed = true;
+	for (size_t offset = 0; offset < length && parsed; offset += blockLength)
+	{
+		size_t count = length - offset;
+		if (count > blockLength) count = blockLength;
+		parsed = xmlParseChunk(context, data + offset, (int) count, 0) == 0;
+	}
+	if (parsed) parsed = xmlParseChunk(context, nullptr, 0, 1) == 0;
+
+	xmlDoc* document = context->myDoc;
+	if ((!parsed || !context->wellFormed) && document != nullptr)
+	{
+		xmlFreeDoc(document);
+		document = nullptr;
+	}
+	xmlFreeParserCtxt(context);
+	return document;
+}
+
 //
 // FUXmlDocument
 //
@@ -25,10 +59,16 @@ FUXmlDocument::FUXmlDocument(FUFileManager* manager, const fchar* _filename, boo
 	if (isParsing)
 	{
 		FUFile* file = nullptr;
-		if (manager != nullptr) file = manager->OpenFile(filename, FUFile::READ);
-		else file = new FUFile(filename, FUFile::READ);
+		if (manager != nullptr) file = manager->OpenFile(filename, FUFile::READ_MAPPED);
+		else file = new FUFile(filename, FUFile::READ_MAPPED);
 
-		if (file->IsOpen())
+		if (file->IsOpen() && file->GetMappedData() != nullptr)
+		{
+			// Parse the file contents in place.
+			xmlDocument = ParseXmlMemory((const char*) file->GetMappedData(), file->GetLength());
+			file->Close();
+		}
+		else if (file->IsOpen())
 		{
 			size_t fileLength = file->GetLength();
 			uint8* fileData = new uint8[fileLength];
@@ -36,7 +76,7 @@ FUXmlDocument::FUXmlDocument(FUFileManager* manager, const fchar* _filename, boo
 			file->Close();
 
 			// Open the given XML file.
-			xmlDocument = xmlParseMemory((const char*) fileData, (int)fileLength);
+			xmlDocument = ParseXmlMemory((const char*) fileData, fileLength);
 			SAFE_DELETE_ARRAY(fileData);
 		}
 		SAFE_DELETE(file);
@@ -64,7 +104,7 @@ FUXmlDocument::FUXmlDocument(const char* data, size_t length)
 	}
 
 	// Open the given XML file.
-	xmlDocument = xmlParseMemory(data, (int)length);
+	xmlDocument = ParseXmlMemory(data, length);
 }
 
 FUXmlDocument::~FUXmlDocument()
@@ -185,9 +185,28 @@ namespace FUXmlParser
 		return ret;
 	}
 
+	// Gives its text content to a node that holds a list of numbers
+	static void WriteNodeValues(xmlNode* node, const FUXmlNodeValues* values)
+	{
+		if (values->count == 0) return;
+		FUSStringBuilder builder;
+		switch (values->type)
+		{
+		case FUXmlNodeValues::FLOAT: builder.appendValues((const float*) values->values, values->count); break;
+		case FUXmlNodeValues::INT32:
+		case FUXmlNodeValues::UINT32: builder.appendValues((const int32*) values->values, values->count); break;
+		default: FUFail(return);
+		}
+		xmlNodeAddContent(node, xmlT(builder.ToCharPtr()));
+	}
+
 	// Returns the text content directly attached to a node
 	const char* ReadNodeContentDirect(xmlNode* node)
 	{
+		if (node != nullptr && node->children == nullptr && node->_private != nullptr)
+		{
+			WriteNodeValues(node, (const FUXmlNodeValues*) node->_private);
+		}
 		if (node == nullptr || node->children == nullptr
 			|| node->children->type != XML_TEXT_NODE || node->children->content == nullptr) return emptyCharString;
 		return (const char*) node->children->content;
@@ -198,6 +217,10 @@ namespace FUXmlParser
 	{
 		if (node != nullptr)
 		{
+			if (node->children == nullptr && node->_private != nullptr)
+			{
+				WriteNodeValues(node, (const FUXmlNodeValues*) node->_private);
+			}
 			xmlChar* content = xmlNodeGetContent(node);
 			if (content != nullptr)
 			{
@@ -209,4 +232,82 @@ namespace FUXmlParser
 		}
 		return emptyString;
 	}
+
+	// Returns the list of numbers attached to a node
+	const FUXmlNodeValues* ReadNodeValues(xmlNode* node)
+	{
+		return (node != nullptr) ? (const FUXmlNodeValues*) node->_private : nullptr;
+	}
+
+	// Reads the numeric content of a node
+	void ReadNodeContentList(xmlNode* node, FloatList& array)
+	{
+		const FUXmlNodeValues* values = ReadNodeValues(node);
+		if (values != nullptr && values->type == FUXmlNodeValues::FLOAT)
+		{
+			array.resize(values->count);
+			if (values->count > 0) memcpy(array.begin(), values->values, values->count * sizeof(float));
+		}
+		else FUStringConversion::ToFloatList(ReadNodeContentDirect(node), array);
+	}
+
+	void ReadNodeContentList(xmlNode* node, Int32List& array)
+	{
+		const FUXmlNodeValues* values = ReadNodeValues(node);
+		if (values != nullptr && (values->type == FUXmlNodeValues::INT32 || values->type == FUXmlNodeValues::UINT32))
+		{
+			array.resize(values->count);
+			if (values->count > 0) memcpy(array.begin(), values->values, values->count * sizeof(int32));
+		}
+		else FUStringConversion::ToInt32List(ReadNodeContentDirect(node), array);
+	}
+
+	void ReadNodeContentList(xmlNode* node, UInt32List& array)
+	{
+		const FUXmlNodeValues* values = ReadNodeValues(node);
+		if (values != nullptr && values->type == FUXmlNodeValues::UINT32)
+		{
+			array.resize(values->count);
+			if (values->count > 0) memcpy(array.begin(), values->values, values->count * sizeof(uint32));
+		}
+		else FUStringConversion::ToUInt32List(ReadNodeContentDirect(node), array);
+	}
+
+	// Splits the numbers of a node into interleaved lists. Only the complete sets of values are kept.
+	template <class T>
+	static void ReadInterleavedValues(const T* values, size_t valueCount, fm::pvector<fm::vector<T, true> >& arrays)
+	{
+		size_t stride = arrays.size();
+		if (stride == 0) return;
+
+		size_t count = valueCount / stride;
+		for (size_t i = 0; i < stride; ++i)
+		{
+			fm::vector<T, true>* array = arrays[i];
+			if (array == nullptr) continue;
+			array->resize(count);
+			const T* value = values + i;
+			for (T* it = array->begin(); it != array->end(); ++it, value += stride) *it = *value;
+		}
+	}
+
+	void ReadNodeContentInterleaved(xmlNode* node, fm::pvector<FloatList>& arrays)
+	{
+		const FUXmlNodeValues* values = ReadNodeValues(node);
+		if (values != nullptr && values->type == FUXmlNodeValues::FLOAT)
+		{
+			ReadInterleavedValues((const float*) values->values, values->count, arrays);
+		}
+		else FUStringConversion::ToInterleavedFloatList(ReadNodeContentDirect(node), arrays);
+	}
+
+	void ReadNodeContentInterleaved(xmlNode* node, fm::pvector<UInt32List>& arrays)
+	{
+		const FUXmlNodeValues* values = ReadNodeValues(node);
+		if (values != nullptr && values->type == FUXmlNodeValues::UINT32)
+		{
+			ReadInterleavedValues((const uint32*) values->values, values->count, arrays);
+		}
+		else FUStringConversion::ToInterleavedUInt32List(ReadNodeContentDirect(node), arrays);
+	}
 };
@@ -19,6 +19,32 @@
 
 typedef fm::pvector<struct _xmlNode> xmlNodeList; /**< A dynamically-sized array of XML nodes. */
 
+/**
+	A list of numbers attached to an XML tree node in place of its text content.
+	The binary archives attach these lists to the array nodes that they load,
+	through the node's application data pointer, so that the numbers need not be
+	written out as text and parsed back. The numbers are not owned by the node.
+
+	The ReadNodeContentList and ReadNodeContentInterleaved functions read
+	these lists directly. The other content retrieval functions first give the node
+	its text content, written out exactly as the XML archive writes out these numbers.
+*/
+struct FUXmlNodeValues
+{
+	/** The types of numbers. */
+	enum Type
+	{
+		FLOAT, /**< 32-bit floating-point values. */
+		INT32, /**< 32-bit signed integer values. */
+		UINT32 /**< 32-bit integer values that are all positive or zero:
+					they may be read as signed or as unsigned values. */
+	};
+
+	Type type; /**< The type of the numbers. */
+	size_t count; /**< The number of values. */
+	const void* values; /**< The values. */
+};
+
 namespace FUXmlParser
 {
 	// Parse an XML compatable string for the std representation
@@ -40,6 +66,14 @@ namespace FUXmlParser
 	FCOLLADA_EXPORT FUCrc32::crc32 ReadNodePropertyCRC(xmlNode* node, const char* property);
 	FCOLLADA_EXPORT const char* ReadNodeContentDirect(xmlNode* node);
 	FCOLLADA_EXPORT fm::string ReadNodeContentFull(xmlNode* node);
+
+	// Retrieve the numeric content of a node
+	FCOLLADA_EXPORT const FUXmlNodeValues* ReadNodeValues(xmlNode* node);
+	FCOLLADA_EXPORT void ReadNodeContentList(xmlNode* node, FloatList& array);
+	FCOLLADA_EXPORT void ReadNodeContentList(xmlNode* node, Int32List& array);
+	FCOLLADA_EXPORT void ReadNodeContentList(xmlNode* node, UInt32List& array);
+	FCOLLADA_EXPORT void ReadNodeContentInterleaved(xmlNode* node, fm::pvector<FloatList>& arrays);
+	FCOLLADA_EXPORT void ReadNodeContentInterleaved(xmlNode* node, fm::pvector<UInt32List>& arrays);
 };
 
 inline bool IsEquivalent(const xmlChar* sz1, const char* sz2) { return IsEquivalent((const char*) sz1, sz2); }
@@ -0,0 +1,178 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#include "StdAfx.h"
+#include "FUXmlReader.h"
+#include "FUFileManager.h"
+#include "FUFile.h"
+
+#ifdef HAS_LIBXML
+
+#include <libxml/xmlreader.h>
+
+//
+// FUXmlReader
+//
+
+FUXmlReader::FUXmlReader(FUFileManager* manager, const fchar* _filename)
+:	reader(nullptr), file(nullptr)
+,	filename(_filename), data(nullptr), dataLength(0), dataOffset(0)
+,	hasPendingNode(false), failed(false)
+{
+	// Resolve the filename once, so that the document can be re-opened without the manager.
+	if (manager != nullptr)
+	{
+		file = manager->OpenFile(filename, false);
+		if (file != nullptr) filename = file->GetFilePath();
+		SAFE_DELETE(file);
+	}
+	Open();
+}
+
+FUXmlReader::FUXmlReader(const char* _data, size_t length)
+:	reader(nullptr), file(nullptr)
+,	data(_data), dataLength(length), dataOffset(0)
+,	hasPendingNode(false), failed(false)
+{
+	FUAssert(data != nullptr, return);
+	if (dataLength == (size_t) ~0) dataLength = strlen(data);
+	Open();
+}
+
+FUXmlReader::~FUXmlReader()
+{
+	Close();
+}
+
+bool FUXmlReader::Open()
+{
+	// The arrays of large meshes and animations easily go over the default 10MB limit on text nodes.
+	if (data != nullptr)
+	{
+		// The memory reader takes an int length: read the larger buffers in blocks.
+		dataOffset = 0;
+		if (dataLength <= (size_t) INT_MAX) reader = xmlReaderForMemory(data, (int) dataLength, nullptr, nullptr, XML_PARSE_HUGE);
+		else reader = xmlReaderForIO(ReadMemoryCallback, nullptr, this, nullptr, nullptr, XML_PARSE_HUGE);
+	}
+	else
+	{
+		file = new FUFile(filename, FUFile::READ);
+		if (!file->IsOpen())
+		{
+			SAFE_DELETE(file);
+			failed = true;
+			return false;
+		}
+		reader = xmlReaderForIO(ReadFileCallback, nullptr, file, nullptr, nullptr, XML_PARSE_HUGE);
+	}
+	hasPendingNode = false;
+	failed = (reader == nullptr);
+	return !failed;
+}
+
+void FUXmlReader::Close()
+{
+	if (reader != nullptr)
+	{
+		xmlFreeTextReader(reader);
+		reader = nullptr;
+	}
+	SAFE_DELETE(file);
+}
+
+bool FUXmlReader::Rewind()
+{
+	Close();
+	return Open();
+}
+
+int FUXmlReader::ReadFileCallback(void* context, char* buffer, int length)
+{
+	FUFile* file = (FUFile*) context;
+	return (int) file->ReadBlock(buffer, (size_t) length);
+}
+
+int FUXmlReader::ReadMemoryCallback(void* context, char* buffer, int length)
+{
+	FUXmlReader* reader = (FUXmlReader*) context;
+	size_t blockLength = reader->dataLength - reader->dataOffset;
+	if (blockLength > (size_t) length) blockLength = (size_t) length;
+	memcpy(buffer, reader->data + reader->dataOffset, blockLength);
+	reader->dataOffset += blockLength;
+	return (int) blockLength;
+}
+
+bool FUXmlReader::ReadElement(int depth)
+{
+	if (reader == nullptr) return false;
+
+	if (!hasPendingNode)
+	{
+		// Skip the sub-tree of the current element, if it is at least as deep as the wanted elements.
+		int result;
+		if (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT && xmlTextReaderDepth(reader) >= depth)
+		{
+			result = xmlTextReaderNext(reader);
+		}
+		else
+		{
+			result = xmlTextReaderRead(reader);
+		}
+		if (result != 1) { failed |= (result == -1); return false; }
+	}
+	hasPendingNode = false;
+
+	for (;;)
+	{
+		int nodeDepth = xmlTextReaderDepth(reader);
+		int nodeType = xmlTextReaderNodeType(reader);
+		if (nodeDepth < depth)
+		{
+			// We have left the parent element. Unless this is the end of
+			// the parent element, the caller will want to look at this node.
+			hasPendingNode = nodeType != XML_READER_TYPE_END_ELEMENT || nodeDepth < depth - 1;
+			return false;
+		}
+		if (nodeDepth == depth && nodeType == XML_READER_TYPE_ELEMENT) return true;
+
+		int result = (nodeType == XML_READER_TYPE_ELEMENT) ? xmlTextReaderNext(reader) : xmlTextReaderRead(reader);
+		if (result != 1) { failed |= (result == -1); return false; }
+	}
+}
+
+const char* FUXmlReader::GetElementName()
+{
+	if (reader == nullptr) return emptyCharString;
+	const xmlChar* name = xmlTextReaderConstLocalName(reader);
+	return (name != nullptr) ? (const char*) name : emptyCharString;
+}
+
+uint32 FUXmlReader::GetLineNumber()
+{
+	return (reader != nullptr) ? (uint32) xmlTextReaderGetParserLineNumber(reader) : 0;
+}
+
+fm::string FUXmlReader::ReadAttribute(const char* attribute)
+{
+	fm::string value;
+	if (reader == nullptr) return value;
+	xmlChar* v = xmlTextReaderGetAttribute(reader, (const xmlChar*) attribute);
+	if (v != nullptr)
+	{
+		value = (const char*) v;
+		xmlFree(v);
+	}
+	return value;
+}
+
+xmlNode* FUXmlReader::Expand()
+{
+	return (reader != nullptr) ? xmlTextReaderExpand(reader) : nullptr;
+}
+
+#endif // HAS_LIBXML
@@ -0,0 +1,126 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/**
+	@file FUXmlReader.h
+	This file contains the FUXmlReader class.
+*/
+
+#ifndef _FU_XML_READER_H_
+#define _FU_XML_READER_H_
+
+class FUFile;
+class FUFileManager;
+struct _xmlTextReader;
+
+#ifdef HAS_LIBXML
+
+/**
+	A forward-only XML reader.
+
+	Unlike the FUXmlDocument, this reader never builds the XML tree
+	for the whole document. It walks the document element by element
+	and only builds the XML tree nodes of the element that the caller
+	explicitly expands. These XML tree nodes are released as soon as the
+	reader moves past the expanded element, so the memory used by the reader
+	is bounded by the size of the largest expanded element.
+
+	Files are read in small blocks through the FUFile class,
+	so the file contents are never loaded in memory all at once.
+
+	Based on top of the LibXML2 xmlTextReader.
+
+	@ingroup FUtils
+*/
+class FCOLLADA_EXPORT FUXmlReader
+{
+private:
+	struct _xmlTextReader* reader;
+	FUFile* file;
+	fstring filename;
+	const char* data;
+	size_t dataLength;
+	size_t dataOffset;
+	bool hasPendingNode;
+	bool failed;
+
+public:
+	/** Constructor.
+		Opens the XML document for the given filename.
+		@param manager To handle non-file system opens and to handle relative paths.
+		@param filename The filename of the XML document to open. */
+	FUXmlReader(FUFileManager* manager, const fchar* filename);
+
+	/** Constructor.
+		Opens the XML document contained in the given data buffer.
+		The data buffer is not copied and must remain valid
+		for the lifetime of the reader.
+		@param data The data buffer containing the XML document.
+		@param length The length of the data. If this length is ~0,
+			the data buffer is assumed to be nullptr-terminated. */
+	FUXmlReader(const char* data, size_t length);
+
+	/** Destructor.
+		Releases the reader and closes the file. */
+	~FUXmlReader();
+
+	/** Retrieves whether the XML document was opened successfully.
+		@return Whether the reader is ready to read. */
+	inline bool IsOpen() const { return reader != nullptr; }
+
+	/** Restarts reading the XML document from its beginning.
+		All the XML tree nodes returned by the Expand function are released.
+		@return Whether the XML document could be re-opened. */
+	bool Rewind();
+
+	/** Moves the reader to the next element at the given depth.
+		If the reader currently sits on an element at this depth or deeper,
+		the element and its whole sub-tree are skipped. If the reader sits on an
+		element at a lower depth, the reader enters its children.
+		The root element of the document is at depth zero.
+		@param depth The depth of the wanted element.
+		@return Whether an element was found. False is returned when the end of
+			the parent element or the end of the document is reached. */
+	bool ReadElement(int depth);
+
+	/** Retrieves the name of the element the reader currently sits on.
+		@return The name of the current element. */
+	const char* GetElementName();
+
+	/** Retrieves the line number of the node the reader currently sits on.
+		@return The line number of the current node. */
+	uint32 GetLineNumber();
+
+	/** Retrieves the value of an attribute of the current element.
+		@param attribute The name of the attribute.
+		@return The value of the attribute. This string is empty if the
+			attribute is not present on the current element. */
+	fm::string ReadAttribute(const char* attribute);
+
+	/** Builds the XML tree for the current element.
+		The returned XML tree node and its children are released when the reader
+		moves past the current element: make a copy of the XML tree node if it
+		is needed for longer.
+		@return The XML tree node for the current element. This pointer is
+			nullptr if the element is malformed. */
+	xmlNode* Expand();
+
+	/** Retrieves whether the reader has encountered malformed XML.
+		@return Whether an error occured. */
+	inline bool HasFailed() const { return failed; }
+
+private:
+	bool Open();
+	void Close();
+	static int ReadFileCallback(void* context, char* buffer, int length);
+	static int ReadMemoryCallback(void* context, char* buffer, int length);
+};
+
+#endif // HAS_LIBXML
+
+#endif // _FU_XML_READER_H_
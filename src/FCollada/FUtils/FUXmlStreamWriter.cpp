@@ -0,0 +1,246 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#include "StdAfx.h"
+#include "FUXmlStreamWriter.h"
+#include "FUFile.h"
+#include "FUFileManager.h"
+
+#ifdef HAS_LIBXML
+
+#include <libxml/xmlIO.h>
+#include <libxml/xmlsave.h>
+
+// Same indentation as the LibXML2 formatted output: two spaces per level, up to thirty levels.
+static const char indentationString[] = "                                                            ";
+static const size_t maximumIndentationLevel = (sizeof(indentationString) - 1) / 2;
+
+//
+// FUXmlStreamWriter
+//
+
+FUXmlStreamWriter::FUXmlStreamWriter(FUFileManager* manager, const fchar* filename, const char* encoding)
+:	output(nullptr), fileManager(manager), file(nullptr)
+,	deferredFile(nullptr), isDeferring(false)
+,	hasPendingStartTag(false), failed(false)
+{
+	// The temporary file of the deferred XML data is kept next to the XML document.
+	deferredFilename = fstring(filename) + FC(".deferred");
+
+	file = OpenFile(filename, true);
+	if (!file->IsOpen())
+	{
+		SAFE_DELETE(file);
+		failed = true;
+		return;
+	}
+	output = xmlOutputBufferCreateIO(WriteCallback, nullptr, this, nullptr);
+	if (output == nullptr)
+	{
+		SAFE_DELETE(file);
+		failed = true;
+		return;
+	}
+
+	// Write out the XML declaration.
+	xmlOutputBufferWriteString(output, "<?xml version=\"1.0\" encoding=\"");
+	xmlOutputBufferWriteString(output, encoding);
+	xmlOutputBufferWriteString(output, "\"?>\n");
+}
+
+FUXmlStreamWriter::~FUXmlStreamWriter()
+{
+	Close();
+}
+
+FUFile* FUXmlStreamWriter::OpenFile(const fstring& filename, bool write)
+{
+	if (fileManager != nullptr) return fileManager->OpenFile(filename, write);
+	else return new FUFile(filename, write ? FUFile::WRITE : FUFile::READ);
+}
+
+void FUXmlStreamWriter::RemoveDeferredFile()
+{
+	// Remove the file at the path resolved by the file manager.
+	fstring path = deferredFile->GetFilePath();
+	SAFE_DELETE(deferredFile);
+	if (!FUFileManager::RemoveFile(path)) failed = true;
+}
+
+int FUXmlStreamWriter::WriteCallback(void* context, const char* buffer, int length)
+{
+	FUXmlStreamWriter* writer = (FUXmlStreamWriter*) context;
+	bool written;
+	if (writer->isDeferring) written = writer->deferredFile->Write(buffer, (size_t) length);
+	else written = writer->file->Write(buffer, (size_t) length);
+	if (!written) writer->failed = true;
+	return written ? length : -1;
+}
+
+void FUXmlStreamWriter::CloseStartTag()
+{
+	if (hasPendingStartTag)
+	{
+		xmlOutputBufferWrite(output, 1, ">");
+		hasPendingStartTag = false;
+	}
+}
+
+void FUXmlStreamWriter::WriteIndentation(size_t level)
+{
+	xmlOutputBufferWrite(output, 1, "\n");
+	if (level > maximumIndentationLevel) level = maximumIndentationLevel;
+	if (level > 0) xmlOutputBufferWrite(output, (int) (level * 2), indentationString);
+}
+
+void FUXmlStreamWriter::StartElement(xmlNode* node)
+{
+	FUAssert(node != nullptr && node->type == XML_ELEMENT_NODE, return);
+	if (output == nullptr) return;
+
+	CloseStartTag();
+	if (!openElements.empty()) WriteIndentation(openElements.size());
+
+	// Let LibXML2 write out the element without its children: this gives "<name attributes/>".
+	xmlOutputBuffer* startTag = xmlAllocOutputBuffer(nullptr);
+	if (startTag == nullptr) { failed = true; return; }
+	xmlNode* children = node->children;
+	xmlNode* last = node->last;
+	node->children = node->last = nullptr;
+	xmlNodeDumpOutput(startTag, node->doc, node, 0, 1, "utf-8");
+	node->children = children;
+	node->last = last;
+
+	// Drop the "/>", so that the element's children can follow.
+	size_t length = xmlOutputBufferGetSize(startTag);
+	FUAssert(length >= 3, length = 2);
+	xmlOutputBufferWrite(output, (int) (length - 2), (const char*) xmlOutputBufferGetContent(startTag));
+	xmlOutputBufferClose(startTag);
+
+	fm::string name;
+	if (node->ns != nullptr && node->ns->prefix != nullptr) { name = (const char*) node->ns->prefix; name.append(":"); }
+	name.append((const char*) node->name);
+	openElements.push_back(name);
+	hasPendingStartTag = true;
+}
+
+void FUXmlStreamWriter::WriteChildren(xmlNode* parent)
+{
+	FUAssert(parent != nullptr, return);
+	if (output == nullptr) return;
+
+	size_t level = openElements.size();
+	for (xmlNode* child = parent->children; child != nullptr; child = child->next)
+	{
+		CloseStartTag();
+		WriteIndentation(level);
+		xmlNodeDumpOutput(output, child->doc, child, (int) level, 1, "utf-8");
+	}
+
+	// Release the written XML tree nodes.
+	while (parent->children != nullptr)
+	{
+		xmlNode* child = parent->children;
+		xmlUnlinkNode(child);
+		xmlFreeNode(child);
+	}
+}
+
+void FUXmlStreamWriter::EndElement()
+{
+	FUAssert(!openElements.empty(), return);
+	if (output == nullptr) return;
+
+	if (hasPendingStartTag)
+	{
+		xmlOutputBufferWrite(output, 2, "/>");
+		hasPendingStartTag = false;
+	}
+	else
+	{
+		WriteIndentation(openElements.size() - 1);
+		xmlOutputBufferWrite(output, 2, "</");
+		xmlOutputBufferWriteString(output, openElements.back().c_str());
+		xmlOutputBufferWrite(output, 1, ">");
+	}
+	openElements.pop_back();
+
+	// As in the LibXML2 output, the root element is followed by a new line.
+	if (openElements.empty()) xmlOutputBufferWrite(output, 1, "\n");
+}
+
+bool FUXmlStreamWriter::StartDeferredOutput()
+{
+	FUAssert(!isDeferring && deferredFile == nullptr, return false);
+	if (output == nullptr) return false;
+
+	CloseStartTag();
+	xmlOutputBufferFlush(output);
+	deferredFile = OpenFile(deferredFilename, true);
+	if (!deferredFile->IsOpen())
+	{
+		SAFE_DELETE(deferredFile);
+		failed = true;
+		return false;
+	}
+	isDeferring = true;
+	return true;
+}
+
+void FUXmlStreamWriter::EndDeferredOutput()
+{
+	FUAssert(isDeferring, return);
+	if (output == nullptr) return;
+
+	CloseStartTag();
+	xmlOutputBufferFlush(output);
+	isDeferring = false;
+}
+
+void FUXmlStreamWriter::WriteDeferredOutput()
+{
+	FUAssert(!isDeferring, return);
+	if (output == nullptr || deferredFile == nullptr) return;
+
+	CloseStartTag();
+	xmlOutputBufferFlush(output);
+
+	// Re-open the temporary file for reading and copy it in blocks.
+	SAFE_DELETE(deferredFile);
+	deferredFile = OpenFile(deferredFilename, false);
+	if (deferredFile->IsOpen())
+	{
+		size_t remaining = deferredFile->GetLength();
+		char buffer[4096];
+		while (remaining > 0)
+		{
+			size_t length = deferredFile->ReadBlock(buffer, min(remaining, sizeof(buffer)));
+			if (length == 0 || !file->Write(buffer, length)) { failed = true; break; }
+			remaining -= length;
+		}
+	}
+	else failed = true;
+	RemoveDeferredFile();
+}
+
+bool FUXmlStreamWriter::Close()
+{
+	if (output != nullptr)
+	{
+		if (xmlOutputBufferClose(output) < 0) failed = true;
+		output = nullptr;
+	}
+	if (deferredFile != nullptr)
+	{
+		RemoveDeferredFile();
+	}
+	SAFE_DELETE(file);
+	return !failed;
+}
+
+#endif // HAS_LIBXML
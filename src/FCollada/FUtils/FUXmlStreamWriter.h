@@ -0,0 +1,127 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/**
+	@file FUXmlStreamWriter.h
+	This file contains the FUXmlStreamWriter class.
+*/
+
+#ifndef _FU_XML_STREAM_WRITER_H_
+#define _FU_XML_STREAM_WRITER_H_
+
+class FUFile;
+class FUFileManager;
+struct _xmlOutputBuffer;
+
+#ifdef HAS_LIBXML
+
+/**
+	A forward-only XML writer.
+
+	Unlike the FUXmlDocument, this writer never holds the XML tree
+	for the whole document. The caller opens the outer elements one at a time
+	and builds the XML tree of one inner element at a time: each inner element
+	is written out and its XML tree nodes are released right away. The memory
+	used by the writer is therefore bounded by the size of the largest
+	inner element.
+
+	The written XML data is formatted exactly as the FUXmlDocument::Write
+	function formats the equivalent whole XML tree, as long as the opened
+	elements contain only elements.
+
+	Part of the XML data may be deferred: it is then kept in a temporary file,
+	next to the XML document, and written out later. This allows the caller to
+	write out an element before elements that it builds earlier.
+
+	Based on top of the LibXML2 output buffers.
+
+	@ingroup FUtils
+*/
+class FCOLLADA_EXPORT FUXmlStreamWriter
+{
+private:
+	struct _xmlOutputBuffer* output;
+	FUFileManager* fileManager;
+	FUFile* file;
+	fstring deferredFilename;
+	FUFile* deferredFile;
+	bool isDeferring;
+	StringList openElements;
+	bool hasPendingStartTag;
+	bool failed;
+
+public:
+	/** Constructor.
+		Creates the XML document for the given filename and
+		writes out its XML declaration.
+		@param manager To handle non-file system opens and to handle relative paths.
+			The temporary file of the deferred XML data is also opened through it.
+		@param filename The filename of the XML document to write.
+		@param encoding The encoding written in the XML declaration.
+			The XML data is always written out in UTF-8. */
+	FUXmlStreamWriter(FUFileManager* manager, const fchar* filename, const char* encoding = "utf-8");
+
+	/** Destructor.
+		Closes the file. Closing the file before all the opened
+		elements are ended leaves the XML document incomplete. */
+	~FUXmlStreamWriter();
+
+	/** Retrieves whether the XML document was created successfully.
+		@return Whether the writer is ready to write. */
+	inline bool IsOpen() const { return output != nullptr; }
+
+	/** Opens an element.
+		The start tag of the given XML tree node is written out, with all its attributes.
+		The children of the XML tree node are not written out: write them out
+		with the WriteChildren function. The XML tree node is not released.
+		@param node The XML tree node of the element to open. */
+	void StartElement(xmlNode* node);
+
+	/** Writes out the children of an XML tree node within the last opened element.
+		The children and their whole sub-trees are then released.
+		@param parent The XML tree node whose children to write out. This is
+			usually the XML tree node given to the last StartElement call. */
+	void WriteChildren(xmlNode* parent);
+
+	/** Closes the last opened element. */
+	void EndElement();
+
+	/** Starts deferring the written XML data.
+		Until the EndDeferredOutput function is called, the XML data
+		is kept in a temporary file rather than written out.
+		@return Whether the temporary file was created. When it was not,
+			the XML data is not deferred and the writer has failed. */
+	bool StartDeferredOutput();
+
+	/** Stops deferring the written XML data.
+		The deferred XML data is kept until the WriteDeferredOutput function is called. */
+	void EndDeferredOutput();
+
+	/** Writes out the deferred XML data.
+		The temporary file is then removed. */
+	void WriteDeferredOutput();
+
+	/** Writes out all the buffered XML data and closes the file.
+		@return Whether all the XML data was written out successfully. */
+	bool Close();
+
+	/** Retrieves whether the writer could not write out XML data.
+		@return Whether an error occured. */
+	inline bool HasFailed() const { return failed; }
+
+private:
+	FUFile* OpenFile(const fstring& filename, bool write);
+	void RemoveDeferredFile();
+	void CloseStartTag();
+	void WriteIndentation(size_t level);
+	static int WriteCallback(void* context, const char* buffer, int length);
+};
+
+#endif // HAS_LIBXML
+
+#endif // _FU_XML_STREAM_WRITER_H_
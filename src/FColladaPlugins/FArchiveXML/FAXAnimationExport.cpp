@@ -23,7 +23,7 @@ xmlNode* FArchiveXML::WriteAnimationChannel(FCDObject* object, xmlNode* parentNo
 {
 	FCDAnimationChannel* animationChannel = (FCDAnimationChannel*)object;
 
-	FCDAnimationChannelData& data = FArchiveXML::documentLinkDataMap[animationChannel->GetDocument()].animationChannelData[animationChannel];
+	FCDAnimationChannelData& data = FArchiveXML::GetDocumentLinkData(animationChannel->GetDocument()).animationChannelData[animationChannel];
 	//FUAssert(!data.targetPointer.empty(), nullptr);
 	fm::string baseId = FCDObjectWithId::CleanId(animationChannel->GetParent()->GetDaeId() + "_" + data.targetPointer);
 
@@ -123,7 +123,7 @@ xmlNode* FArchiveXML::WriteAnimationChannel(FCDObject* object, xmlNode* parentNo
 			FCDAnimationCurve* curCurve = animationChannel->GetCurve(c);
 			if (curCurve != nullptr)
 			{
-				FCDAnimationCurveData& curveData = FArchiveXML::documentLinkDataMap[curCurve->GetDocument()].animationCurveData[curCurve];
+				FCDAnimationCurveData& curveData = FArchiveXML::GetDocumentLinkData(curCurve->GetDocument()).animationCurveData[curCurve];
 				//FUAssert(curveDataIt != FArchiveXML::animationCurveData.end(), nullptr);
 
 				// Generate a valid id for this curve
@@ -251,7 +251,7 @@ void FArchiveXML::WriteAnimatedValue(const FCDAnimated* _animated, xmlNode* valu
 	FCDAnimated* animated = const_cast<FCDAnimated*>(_animated);
 	int32 arrayElement = animated->GetArrayElement();
 
-	FCDAnimatedData& animatedData = FArchiveXML::documentLinkDataMap[animated->GetDocument()].animatedData[animated];
+	FCDAnimatedData& animatedData = FArchiveXML::GetDocumentLinkData(animated->GetDocument()).animatedData[animated];
 
 	// Set a sid unto the XML tree node, in order to support animations
 	if (!HasNodeProperty(valueNode, DAE_SID_ATTRIBUTE) && !HasNodeProperty(valueNode, DAE_ID_ATTRIBUTE))
@@ -272,7 +272,7 @@ void FArchiveXML::WriteAnimatedValue(const FCDAnimated* _animated, xmlNode* valu
 			FCDAnimationCurveTrackList& curves = animated->GetCurves()[i];
 			for (FCDAnimationCurveTrackList::iterator itC = curves.begin(); itC != curves.end(); ++itC)
 			{
-				FCDAnimationCurveData& curveData = FArchiveXML::documentLinkDataMap[(*itC)->GetDocument()].animationCurveData[*itC];
+				FCDAnimationCurveData& curveData = FArchiveXML::GetDocumentLinkData((*itC)->GetDocument()).animationCurveData[*itC];
 
 				(*itC)->SetTargetElement(arrayElement);
 				(*itC)->SetTargetQualifier(animated->GetQualifier(i));
@@ -280,7 +280,7 @@ void FArchiveXML::WriteAnimatedValue(const FCDAnimated* _animated, xmlNode* valu
 				curveData.targetQualifier = animated->GetQualifier(i);
 
 				FCDAnimationChannel* channel = (*itC)->GetParent();
-				FCDAnimationChannelData& channelData = FArchiveXML::documentLinkDataMap[channel->GetDocument()].animationChannelData[channel];
+				FCDAnimationChannelData& channelData = FArchiveXML::GetDocumentLinkData(channel->GetDocument()).animationChannelData[channel];
 
 				FUAssert(channel != nullptr, continue);
 
@@ -295,7 +295,7 @@ void FArchiveXML::WriteAnimatedValue(const FCDAnimated* _animated, xmlNode* valu
 		for (FCDAnimationChannelList::iterator itC = channels.begin(); itC != channels.end(); ++itC)
 		{
 			FCDAnimationChannel* channel = (*itC);
-			FCDAnimationChannelData& channelData = FArchiveXML::documentLinkDataMap[channel->GetDocument()].animationChannelData[channel];
+			FCDAnimationChannelData& channelData = FArchiveXML::GetDocumentLinkData(channel->GetDocument()).animationChannelData[channel];
 
 			for (size_t i = 0; i < animated->GetValueCount(); ++i)
 			{
@@ -321,8 +321,8 @@ void FArchiveXML::WriteAnimatedValue(const FCDAnimated* _animated, xmlNode* valu
 
 void FArchiveXML::WriteSourceFCDAnimationCurve(FCDAnimationCurve* animationCurve, xmlNode* parentNode, const fm::string& baseId)
 {
-	FCDAnimationCurveDataMap::iterator it = FArchiveXML::documentLinkDataMap[animationCurve->GetDocument()].animationCurveData.find(animationCurve);
-	FUAssert(it != FArchiveXML::documentLinkDataMap[animationCurve->GetDocument()].animationCurveData.end(),);
+	FCDAnimationCurveDataMap::iterator it = FArchiveXML::GetDocumentLinkData(animationCurve->GetDocument()).animationCurveData.find(animationCurve);
+	FUAssert(it != FArchiveXML::GetDocumentLinkData(animationCurve->GetDocument()).animationCurveData.end(),);
 	FCDAnimationCurveData& data = it->second;
 
 	const char* parameter = data.targetQualifier.c_str();
@@ -454,8 +454,8 @@ xmlNode* FArchiveXML::WriteSamplerFCDAnimationCurve(FCDAnimationCurve* animation
 	// Add the driver input
 	if (animationCurve->HasDriver())
 	{
-		FCDAnimatedDataMap::iterator it = FArchiveXML::documentLinkDataMap[animationCurve->GetDriverPtr()->GetDocument()].animatedData.find(animationCurve->GetDriverPtr());
-		FUAssert(it != FArchiveXML::documentLinkDataMap[animationCurve->GetDriverPtr()->GetDocument()].animatedData.end(),);
+		FCDAnimatedDataMap::iterator it = FArchiveXML::GetDocumentLinkData(animationCurve->GetDriverPtr()->GetDocument()).animatedData.find(animationCurve->GetDriverPtr());
+		FUAssert(it != FArchiveXML::GetDocumentLinkData(animationCurve->GetDriverPtr()->GetDocument()).animatedData.end(),);
 		FCDAnimatedData& data = it->second;
 
 		FUSStringBuilder builder(data.pointer);
@@ -479,8 +479,8 @@ xmlNode* FArchiveXML::WriteChannelFCDAnimationCurve(FCDAnimationCurve* animation
 	xmlNode* channelNode = AddChild(parentNode, DAE_CHANNEL_ELEMENT);
 	AddAttribute(channelNode, DAE_SOURCE_ATTRIBUTE, fm::string("#") + baseId + "-sampler");
 
-	FCDAnimationCurveDataMap::iterator it = FArchiveXML::documentLinkDataMap[animationCurve->GetDocument()].animationCurveData.find(animationCurve);
-	FUAssert(it != FArchiveXML::documentLinkDataMap[animationCurve->GetDocument()].animationCurveData.end(),);
+	FCDAnimationCurveDataMap::iterator it = FArchiveXML::GetDocumentLinkData(animationCurve->GetDocument()).animationCurveData.find(animationCurve);
+	FUAssert(it != FArchiveXML::GetDocumentLinkData(animationCurve->GetDocument()).animationCurveData.end(),);
 	FCDAnimationCurveData& data = it->second;
 
 	// Generate and export the channel target
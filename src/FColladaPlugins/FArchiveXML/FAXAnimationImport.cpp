@@ -27,7 +27,8 @@
 bool FArchiveXML::LoadAnimationChannel(FCDObject* object, xmlNode* channelNode)
 {
 	FCDAnimationChannel* animationChannel = (FCDAnimationChannel*)object;
-	FCDAnimationChannelData& data = FArchiveXML::documentLinkDataMap[animationChannel->GetDocument()].animationChannelData[animationChannel];
+	FCDocumentLinkData& linkData = FArchiveXML::GetDocumentLinkData(animationChannel->GetDocument());
+	FCDAnimationChannelData& data = linkData.animationChannelData[animationChannel];
 
 	bool status = true;
 
@@ -36,6 +37,9 @@ bool FArchiveXML::LoadAnimationChannel(FCDObject* object, xmlNode* channelNode)
 	fm::string samplerId = ReadNodeSource(channelNode);
 	ReadNodeTargetProperty(channelNode, data.targetPointer, data.targetQualifier);
 
+	// Index the channel on its target, for the linking of the animated values.
+	if (!data.targetPointer.empty()) linkData.targetChannelMap[data.targetPointer].push_back(animationChannel);
+
 #ifdef DONT_DEFINE_THIS
 	FCDAnimation* anim = animationChannel->GetParent();
 	FCDExtra* extra = anim->GetExtra();
@@ -110,6 +114,14 @@ bool FArchiveXML::LoadAnimationChannel(FCDObject* object, xmlNode* channelNode)
 		interpolations.insert(interpolations.end(), keyCount - interpolations.size(), FUDaeInterpolation::FromString(""));
 	}
 
+	// Find the largest key class, to reserve the key storage of the curves at once.
+	FUDaeInterpolation::Interpolation reservedInterpolation = FUDaeInterpolation::LINEAR;
+	for (size_t j = 0; j < keyCount; ++j)
+	{
+		if (interpolations[j] == FUDaeInterpolation::TCB) { reservedInterpolation = FUDaeInterpolation::TCB; break; }
+		else if (interpolations[j] == FUDaeInterpolation::BEZIER) reservedInterpolation = FUDaeInterpolation::BEZIER;
+	}
+
 	// Read in the interleaved outputs as floats
 	fm::vector<FloatList> tempFloatArrays;
 	tempFloatArrays.resize(curveCount);
@@ -126,6 +138,7 @@ bool FArchiveXML::LoadAnimationChannel(FCDObject* object, xmlNode* channelNode)
 		}
 
 		// Create all the keys, on the curves, according to the interpolation types.
+		animationChannel->GetCurve(i)->ReserveKeys(keyCount, reservedInterpolation);
 		for (size_t j = 0; j < keyCount; ++j)
 		{
 			FCDAnimationKey* key = animationChannel->GetCurve(i)->AddKey((FUDaeInterpolation::Interpolation) interpolations[j]);
@@ -353,6 +366,7 @@ bool FArchiveXML::LoadAnimationChannel(FCDObject* object, xmlNode* channelNode)
 			FUStringConversion::SplitTarget(driverTarget, data.driverPointer, driverQualifierValue);
 			data.driverQualifier = FUStringConversion::ParseQualifier(driverQualifierValue);
 			if (data.driverQualifier < 0) data.driverQualifier = 0;
+			if (!data.driverPointer.empty()) linkData.driverChannelMap[data.driverPointer].push_back(animationChannel);
 		}
 	}
 	animationChannel->SetDirtyFlag();
@@ -363,15 +377,12 @@ bool FArchiveXML::LoadAnimationChannel(FCDObject* object, xmlNode* channelNode)
 
 xmlNode* FArchiveXML::FindChildByIdFCDAnimation(FCDAnimation* animation, const fm::string& _id)
 {
-	FCDAnimationDataMap::iterator animationIt = FArchiveXML::documentLinkDataMap[animation->GetDocument()].animationData.find(animation);
-	FUAssert(animationIt != FArchiveXML::documentLinkDataMap[animation->GetDocument()].animationData.end(),);
+	FCDAnimationDataMap::iterator animationIt = FArchiveXML::GetDocumentLinkData(animation->GetDocument()).animationData.find(animation);
+	FUAssert(animationIt != FArchiveXML::GetDocumentLinkData(animation->GetDocument()).animationData.end(),);
 	FCDAnimationData& data = animationIt->second;
 
-	FUCrc32::crc32 id = FUCrc32::CRC32(_id.c_str() + ((_id[0] == '#') ? 1 : 0));
-	for (FAXNodeIdPair* it = data.childNodes.begin(); it != data.childNodes.end(); ++it)
-	{
-		if (it->second == id) return it->first;
-	}
+	FAXNodeIdMap::iterator it = data.childNodes.find((!_id.empty() && _id[0] == '#') ? fm::string(_id.c_str() + 1) : _id);
+	if (it != data.childNodes.end()) return it->second;
 
 	return (animation->GetParent() != nullptr) ? FArchiveXML::FindChildByIdFCDAnimation(animation->GetParent(), _id) : nullptr;
 }
@@ -399,7 +410,7 @@ bool FArchiveXML::LoadAnimationMultiCurve(FCDObject* UNUSED(object), xmlNode* UN
 bool FArchiveXML::LoadAnimation(FCDObject* object, xmlNode* node)
 {
 	FCDAnimation* animation = (FCDAnimation*)object;
-	FCDAnimationData& data = FArchiveXML::documentLinkDataMap[animation->GetDocument()].animationData[animation];
+	FCDAnimationData& data = FArchiveXML::GetDocumentLinkData(animation->GetDocument()).animationData[animation];
 
 	bool status = FArchiveXML::LoadEntity(animation, node);
 	if (!status) return status;
@@ -482,6 +493,7 @@ bool FArchiveXML::LoadAnimationClip(FCDObject* object, xmlNode* clipNode)
 void FArchiveXML::LoadAnimatable(FCDParameterAnimatable* animatable, xmlNode* node)
 {
 	if (animatable == nullptr || node == nullptr) return;
+	FAXSharedImportContextScope sharedImportContext;
 	FCDAnimated* animated = animatable->GetAnimated();
 	if (!FArchiveXML::LinkAnimated(animated, node)) SAFE_RELEASE(animated);
 }
@@ -489,6 +501,7 @@ void FArchiveXML::LoadAnimatable(FCDParameterAnimatable* animatable, xmlNode* no
 void FArchiveXML::LoadAnimatable(FCDocument* document, FCDParameterListAnimatable* animatable, xmlNode* node)
 {
 	if (animatable == nullptr || node == nullptr) return;
+	FAXSharedImportContextScope sharedImportContext;
 
 	// Look for an animation on this list object
 	Int32List animatedIndices;
@@ -515,8 +528,8 @@ bool FArchiveXML::ProcessChannels(FCDAnimated* animated, FCDAnimationChannelList
 		if (curveCount == 0) continue;
 
 		// Retrieve the channel's qualifier and check for a requested matrix element
-		FCDAnimationChannelDataMap::iterator itChannelData = FArchiveXML::documentLinkDataMap[channel->GetDocument()].animationChannelData.find(channel);
-		FUAssert(itChannelData != FArchiveXML::documentLinkDataMap[channel->GetDocument()].animationChannelData.end(),);
+		FCDAnimationChannelDataMap::iterator itChannelData = FArchiveXML::GetDocumentLinkData(channel->GetDocument()).animationChannelData.find(channel);
+		FUAssert(itChannelData != FArchiveXML::GetDocumentLinkData(channel->GetDocument()).animationChannelData.end(),);
 		FCDAnimationChannelData& channelData = itChannelData->second;
 
 		const fm::string& qualifier = channelData.targetQualifier;
@@ -597,7 +610,7 @@ bool FArchiveXML::ProcessChannels(FCDAnimated* animated, FCDAnimationChannelList
 		{
 			for (size_t j = 0; j < animated->GetCurves()[i].size(); ++j)
 			{
-				FCDAnimationCurveData& curveData = FArchiveXML::documentLinkDataMap[animated->GetCurves()[i][j]->GetDocument()].animationCurveData[animated->GetCurves()[i][j]];
+				FCDAnimationCurveData& curveData = FArchiveXML::GetDocumentLinkData(animated->GetCurves()[i][j]->GetDocument()).animationCurveData[animated->GetCurves()[i][j]];
 
 				curveData.targetElement = animated->GetArrayElement();
 				curveData.targetQualifier = qualifiers[i];
@@ -613,32 +626,10 @@ void FArchiveXML::FindAnimationChannels(FCDocument* fcdocument, const fm::string
 {
 	if (pointer.empty()) return;
 
-	size_t animationCount = (uint32) fcdocument->GetAnimationLibrary()->GetEntityCount();
-	for (size_t i = 0; i < animationCount; ++i)
-	{
-		FCDAnimation* animation = fcdocument->GetAnimationLibrary()->GetEntity(i);
-		FArchiveXML::FindAnimationChannels(animation, pointer, channels);
-	}
-}
-
-void FArchiveXML::FindAnimationChannels(FCDAnimation* animation, const fm::string& pointer, FCDAnimationChannelList& targetChannels)
-{
-	// Look for channels locally
-	for (size_t i = 0; i < animation->GetChannelCount(); ++i)
-	{
-		FCDAnimationChannelDataMap::iterator itChannelData = FArchiveXML::documentLinkDataMap[animation->GetChannel(i)->GetDocument()].animationChannelData.find(animation->GetChannel(i));
-		FUAssert(itChannelData != FArchiveXML::documentLinkDataMap[animation->GetChannel(i)->GetDocument()].animationChannelData.end(),);
-		FCDAnimationChannelData& channelData = itChannelData->second;
-
-		if (channelData.targetPointer == pointer)
-		{
-			targetChannels.push_back(animation->GetChannel(i));
-		}
-	}
-
-	// Look for channel(s) within the child animations
-	for (size_t i = 0; i < animation->GetChildrenCount(); ++i)
+	FCDocumentLinkData& data = FArchiveXML::GetDocumentLinkData(fcdocument);
+	FCDAnimationChannelPointerMap::iterator it = data.targetChannelMap.find(pointer);
+	if (it != data.targetChannelMap.end())
 	{
-		FArchiveXML::FindAnimationChannels(animation->GetChild(i), pointer, targetChannels);
+		channels.insert(channels.end(), it->second.begin(), it->second.end());
 	}
 }
@@ -140,8 +140,7 @@ namespace FUDaeParser
 			array.resize(ReadNodeCount(accessorNode) * stride);
 
 			xmlNode* arrayNode = FindChildByType(sourceNode, DAE_FLOAT_ARRAY_ELEMENT);
-			const char* arrayContent = ReadNodeContentDirect(arrayNode);
-			FUStringConversion::ToFloatList(arrayContent, array);
+			ReadNodeContentList(arrayNode, array);
 		}
 		return stride;
 	}
@@ -227,8 +226,7 @@ namespace FUDaeParser
 
 			// Read and parse the float array
    			xmlNode* arrayNode = FindChildByType(sourceNode, DAE_FLOAT_ARRAY_ELEMENT);
-			const char* arrayContent = ReadNodeContentDirect(arrayNode);
-			FUStringConversion::ToInterleavedFloatList(arrayContent, arrays);
+			ReadNodeContentInterleaved(arrayNode, arrays);
 		}
 	}
 
@@ -515,8 +513,8 @@ namespace FUDaeParser
 		return stride;
 	}
 
-	// Pre-buffer the children of a node, with their ids for performance optimization
-	void ReadChildrenIds(xmlNode* node, FAXNodeIdPairList& pairs)
+	// Pre-buffer the children of a node, indexed on their ids for performance optimization
+	void ReadChildrenIds(xmlNode* node, FAXNodeIdMap& ids)
 	{
 		// To avoid unnecessary memory copies:
 		// Start with calculating the maximum child count
@@ -526,15 +524,15 @@ namespace FUDaeParser
 			if (child->type == XML_ELEMENT_NODE) ++nodeCount;
 		}
 
-		// Now, buffer the child nodes and their ids
-		pairs.reserve(nodeCount);
+		// Now, buffer the child nodes: the first child with a given id wins
+		ids.reserve(nodeCount);
 		for (xmlNode* child = node->children; child != nullptr; child = child->next)
 		{
 			if (child->type == XML_ELEMENT_NODE)
 			{
-				FAXNodeIdPair* it = pairs.insert(pairs.end(), FAXNodeIdPair());
-				it->first = child;
-				it->second = ReadNodePropertyCRC(child, DAE_ID_ATTRIBUTE);
+				// Index on the full id: their CRCs collide in the large animations.
+				fm::string id = ReadNodeProperty(child, DAE_ID_ATTRIBUTE);
+				if (!ids.contains(id)) ids.insert(id, child);
 			}
 		}
 	}
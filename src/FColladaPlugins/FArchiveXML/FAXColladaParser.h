@@ -26,9 +26,11 @@
 #ifndef _FU_XML_PARSER_H_
 #include "FUtils/FUXmlParser.h"
 #endif // _FU_XML_PARSER_H_
+#ifndef _FM_HASH_MAP_H_
+#include "FMath/FMHashMap.h"
+#endif // _FM_HASH_MAP_H_
 
-typedef fm::pair<xmlNode*, uint32> FAXNodeIdPair;
-typedef fm::vector<FAXNodeIdPair> FAXNodeIdPairList;
+typedef fm::hash_map<fm::string, xmlNode*> FAXNodeIdMap;
 namespace FUDaeParser
 {
 	using namespace FUXmlParser;
@@ -68,8 +70,8 @@ namespace FUDaeParser
 	uint32 ReadNodeCount(xmlNode* node);
 	uint32 ReadNodeStride(xmlNode* node);
 
-	// Pre-buffer the children of a node, with their ids, for performance optimization
-	void ReadChildrenIds(xmlNode* node, FAXNodeIdPairList& pairs);
+	// Pre-buffer the children of a node, indexed on their ids, for performance optimization
+	void ReadChildrenIds(xmlNode* node, FAXNodeIdMap& ids);
 
 	// Skip the pound(#) character from a COLLADA id string
 	const char* SkipPound(const fm::string& id);
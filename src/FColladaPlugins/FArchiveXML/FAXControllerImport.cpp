@@ -57,7 +57,7 @@ bool FArchiveXML::LoadController(FCDObject* object, xmlNode* controllerNode)
 bool FArchiveXML::LoadSkinController(FCDObject* object, xmlNode* skinNode)
 {
 	FCDSkinController* skinController = (FCDSkinController*)object;
-	FCDSkinControllerDataMap& skinDataMap = FArchiveXML::documentLinkDataMap[skinController->GetDocument()].skinControllerDataMap;
+	FCDSkinControllerDataMap& skinDataMap = FArchiveXML::GetDocumentLinkData(skinController->GetDocument()).skinControllerDataMap;
 	if (skinDataMap.find(skinController) == skinDataMap.end())
 	{
 		FCDSkinControllerData data;
@@ -165,8 +165,7 @@ bool FArchiveXML::LoadSkinController(FCDObject* object, xmlNode* skinNode)
 	{
 		FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_VCOUNT_MISSING, firstCombinerValueNode->line);
 	}
-	const char* content = ReadNodeContentDirect(firstCombinerValueNode);
-	FUStringConversion::ToUInt32List(content, combinerVertexCounts);
+	ReadNodeContentList(firstCombinerValueNode, combinerVertexCounts);
 
 	// Read the <v> element second.
 	xmlNode* vNode = firstCombinerValueNode->next;
@@ -175,8 +174,7 @@ bool FArchiveXML::LoadSkinController(FCDObject* object, xmlNode* skinNode)
 	{
 		FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_V_ELEMENT_MISSING, vNode->line);
 	}
-	content = ReadNodeContentDirect(vNode);
-	FUStringConversion::ToInt32List(content, combinerVertexIndices);
+	ReadNodeContentList(vNode, combinerVertexIndices);
 	size_t combinerVertexIndexCount = combinerVertexIndices.size();
 
 	// Validate the inputs
@@ -245,7 +243,7 @@ bool FArchiveXML::LoadSkinController(FCDObject* object, xmlNode* skinNode)
 bool FArchiveXML::LoadMorphController(FCDObject* object, xmlNode* morphNode)
 {
 	FCDMorphController* morphController = (FCDMorphController*)object;
-	FCDMorphControllerData& data = FArchiveXML::documentLinkDataMap[morphController->GetDocument()].morphControllerDataMap[morphController];
+	FCDMorphControllerData& data = FArchiveXML::GetDocumentLinkData(morphController->GetDocument()).morphControllerDataMap[morphController];
 
 	bool status = true;
 	if (!IsEquivalent(morphNode->name, DAE_CONTROLLER_MORPH_ELEMENT))
@@ -58,7 +58,10 @@ bool FArchiveXML::LoadExtraNode(FCDObject* object, xmlNode* customNode)
 		fstring content = TO_FSTRING(ReadNodeContentFull(customNode));
 		if (!content.empty()) fcdenode->SetContent(content);
 	}
-	FArchiveXML::LinkAnimatedCustom(fcdenode->GetAnimated(), customNode);
+	{
+		FAXSharedImportContextScope sharedImportContext;
+		FArchiveXML::LinkAnimatedCustom(fcdenode->GetAnimated(), customNode);
+	}
 
 	// Read in the node's attributes
 	for (xmlAttr* a = customNode->properties; a != nullptr; a = a->next)
@@ -256,8 +259,8 @@ void FArchiveXML::FindAnimationChannelsArrayIndices(FCDocument* fcdocument, xmlN
 	FArchiveXML::FindAnimationChannels(fcdocument, pointer, channels);
 	for (FCDAnimationChannelList::iterator it = channels.begin(); it != channels.end(); ++it)
 	{
-		FCDAnimationChannelDataMap::iterator itData = FArchiveXML::documentLinkDataMap[(*it)->GetDocument()].animationChannelData.find(*it);
-		FUAssert(itData != FArchiveXML::documentLinkDataMap[(*it)->GetDocument()].animationChannelData.end(),);
+		FCDAnimationChannelDataMap::iterator itData = FArchiveXML::GetDocumentLinkData((*it)->GetDocument()).animationChannelData.find(*it);
+		FUAssert(itData != FArchiveXML::GetDocumentLinkData((*it)->GetDocument()).animationChannelData.end(),);
 		FCDAnimationChannelData& data = itData->second;
 
 		int32 animatedIndex = FUStringConversion::ParseQualifier(data.targetQualifier);
@@ -265,8 +268,13 @@ void FArchiveXML::FindAnimationChannelsArrayIndices(FCDocument* fcdocument, xmlN
 	}
 }
 
+// Documents loaded on different threads are registered one at a time.
+static FUCriticalSection registerDocumentCriticalSection;
+
 void FArchiveXML::RegisterLoadedDocument(FCDocument* document)
 {
+	registerDocumentCriticalSection.Enter();
+
 	fm::pvector<FCDocument> allDocuments;
 	FCollada::GetAllDocuments(allDocuments);
 	for (FCDocument** it = allDocuments.begin(); it != allDocuments.end(); ++it)
@@ -296,4 +304,6 @@ void FArchiveXML::RegisterLoadedDocument(FCDocument* document)
 			if (pHolder->GetFileUrl() == (*itD)->GetFileUrl()) pHolder->LoadTarget(*itD);
 		}
 	}
+
+	registerDocumentCriticalSection.Leave();
 }
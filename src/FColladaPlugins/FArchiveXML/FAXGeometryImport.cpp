@@ -24,7 +24,7 @@ bool FArchiveXML::LoadGeometrySource(FCDObject* object, xmlNode* sourceNode)
 	FCDGeometrySource* geometrySource = (FCDGeometrySource*) object;
 	FCDGeometrySourceData data;
 	data.sourceNode = sourceNode;
-	FArchiveXML::documentLinkDataMap[geometrySource->GetDocument()].geometrySourceDataMap.insert(geometrySource, data);
+	FArchiveXML::GetDocumentLinkData(geometrySource->GetDocument()).geometrySourceDataMap.insert(geometrySource, data);
 
 	bool status = true;
 
@@ -391,9 +391,8 @@ bool FArchiveXML::LoadGeometryPolygons(FCDObject* object, xmlNode* baseNode)
 		else if (isPolylist)
 		{
 			// Process the vertex counts.
-			const char* vCountDataString = ReadNodeContentDirect(vCountNode);
 			UInt32List vCountData;
-			if (vCountDataString != nullptr) FUStringConversion::ToUInt32List(vCountDataString, vCountData);
+			ReadNodeContentList(vCountNode, vCountData);
 			size_t vCountCount = vCountData.size();
 			geometryPolygons->SetFaceVertexCountCount(vCountCount);
 			memcpy((void*) geometryPolygons->GetFaceVertexCounts(), vCountData.begin(), sizeof(uint32) * vCountCount);
@@ -448,10 +447,10 @@ bool FArchiveXML::LoadGeometryPolygons(FCDObject* object, xmlNode* baseNode)
 		{
 			// Retrieve the indices
 			xmlNode* holeNode = nullptr;
-			const char* content = nullptr;
+			xmlNode* indexNode = nullptr;
 			if (!IsEquivalent(itNode->name, DAE_POLYGONHOLED_ELEMENT)) 
 			{
-				content = ReadNodeContentDirect(itNode);
+				indexNode = itNode;
 			} 
 			else 
 			{
@@ -461,7 +460,7 @@ bool FArchiveXML::LoadGeometryPolygons(FCDObject* object, xmlNode* baseNode)
 					if (child->type != XML_ELEMENT_NODE) continue;
 					if (IsEquivalent(child->name, DAE_POLYGON_ELEMENT)) 
 					{
-						content = ReadNodeContentDirect(child);
+						indexNode = child;
 					}
 					else if (IsEquivalent(child->name, DAE_HOLE_ELEMENT)) 
 					{ 
@@ -476,10 +475,17 @@ bool FArchiveXML::LoadGeometryPolygons(FCDObject* object, xmlNode* baseNode)
 			}
 
 			// Parse the indices
-			FUStringConversion::ToInterleavedUInt32List(content, allIndices);
+			ReadNodeContentInterleaved(indexNode, allIndices);
 			uint32 localFaceVertexCount = (uint32) masterIndices->size();
 
-			if (isTriangles) for (uint32 i = 0; i < localFaceVertexCount / 3; ++i) geometryPolygons->AddFaceVertexCount(3);
+			if (isTriangles)
+			{
+				// Add all the triangles at once: the face-vertex count list grows by small steps.
+				size_t faceCount = geometryPolygons->GetFaceVertexCountCount();
+				geometryPolygons->SetFaceVertexCountCount(faceCount + localFaceVertexCount / 3);
+				uint32* faceVertexCounts = (uint32*) geometryPolygons->GetFaceVertexCounts();
+				for (size_t i = faceCount; i < faceCount + localFaceVertexCount / 3; ++i) faceVertexCounts[i] = 3;
+			}
 			else if (isPolygons) geometryPolygons->AddFaceVertexCount(localFaceVertexCount);
 
 			// Push the indices to the index buffers
@@ -495,8 +501,7 @@ bool FArchiveXML::LoadGeometryPolygons(FCDObject* object, xmlNode* baseNode)
 				if (holeNode->type != XML_ELEMENT_NODE) continue;
 
 				// Read in the hole indices and push them on top of the other indices
-				content = ReadNodeContentDirect(holeNode);
-				FUStringConversion::ToInterleavedUInt32List(content, allIndices);
+				ReadNodeContentInterleaved(holeNode, allIndices);
 				for (size_t k = 0; k < indexStride; ++k)
 				{
 					FCDGeometryPolygonsInput* input = idxOwners[k];
@@ -705,8 +710,8 @@ bool FArchiveXML::LoadNURBSSpline(FCDObject* object, xmlNode* splineNode)
 
 void FArchiveXML::SetTypeFCDGeometrySource(FCDGeometrySource* geometrySource, FUDaeGeometryInput::Semantic type)
 {
-	FCDGeometrySourceDataMap::iterator it = FArchiveXML::documentLinkDataMap[geometrySource->GetDocument()].geometrySourceDataMap.find(geometrySource);
-	FUAssert(it != FArchiveXML::documentLinkDataMap[geometrySource->GetDocument()].geometrySourceDataMap.end(),);
+	FCDGeometrySourceDataMap::iterator it = FArchiveXML::GetDocumentLinkData(geometrySource->GetDocument()).geometrySourceDataMap.find(geometrySource);
+	FUAssert(it != FArchiveXML::GetDocumentLinkData(geometrySource->GetDocument()).geometrySourceDataMap.end(),);
 	FCDGeometrySourceData& data = it->second;
 
 	geometrySource->SetSourceType(type);
@@ -41,34 +41,25 @@
 
 bool FArchiveXML::LinkDriver(FCDocument* fcdoument, FCDAnimated* animated, const fm::string& animatedTargetPointer)
 {
+	if (animatedTargetPointer.empty()) return false;
+
 	bool driven = false;
-	size_t animationCount = fcdoument->GetAnimationLibrary()->GetEntityCount();
-	for (size_t i = 0; i < animationCount; ++i)
+	FCDocumentLinkData& data = FArchiveXML::GetDocumentLinkData(fcdoument);
+	FCDAnimationChannelPointerMap::iterator it = data.driverChannelMap.find(animatedTargetPointer);
+	if (it != data.driverChannelMap.end())
 	{
-		FCDAnimation* animation = fcdoument->GetAnimationLibrary()->GetEntity(i);
-		driven |= FArchiveXML::LinkDriver(animation, animated, animatedTargetPointer);
+		for (FCDAnimationChannelList::iterator itC = it->second.begin(); itC != it->second.end(); ++itC)
+		{
+			driven |= FArchiveXML::LinkDriver(*itC, animated, animatedTargetPointer);
+		}
 	}
 	return driven;
 }
 
-bool FArchiveXML::LinkDriver(FCDAnimation* animation, FCDAnimated* animated, const fm::string& animatedTargetPointer)
-{
-	bool driver = false;
-	for (size_t i = 0; i < animation->GetChannelCount(); ++i)
-	{
-		driver |= FArchiveXML::LinkDriver(animation->GetChannel(i), animated, animatedTargetPointer);
-	}
-	for (size_t i = 0; i < animation->GetChildrenCount(); ++i)
-	{
-		driver |= FArchiveXML::LinkDriver(animation->GetChild(i), animated, animatedTargetPointer);
-	}
-	return driver;
-}
-
 bool FArchiveXML::LinkDriver(FCDAnimationChannel* animationChannel, FCDAnimated* animated, const fm::string& animatedTargetPointer)
 {
-	FCDAnimationChannelDataMap::iterator it = FArchiveXML::documentLinkDataMap[animationChannel->GetDocument()].animationChannelData.find(animationChannel);
-	FUAssert(it != FArchiveXML::documentLinkDataMap[animationChannel->GetDocument()].animationChannelData.end(),);
+	FCDAnimationChannelDataMap::iterator it = FArchiveXML::GetDocumentLinkData(animationChannel->GetDocument()).animationChannelData.find(animationChannel);
+	FUAssert(it != FArchiveXML::GetDocumentLinkData(animationChannel->GetDocument()).animationChannelData.end(),);
 	FCDAnimationChannelData& data = it->second;
 
 	bool driver = !data.driverPointer.empty();
@@ -94,11 +85,11 @@ bool FArchiveXML::LinkAnimation(FCDAnimation* animation)
 	for (size_t i = 0; i < animation->GetChannelCount(); ++i)
 	{
 		FCDAnimationChannel* channel = animation->GetChannel(i);
-		FCDAnimationChannelDataMap::iterator it = FArchiveXML::documentLinkDataMap[channel->GetDocument()].animationChannelData.find(channel);
-		FUAssert(it != FArchiveXML::documentLinkDataMap[channel->GetDocument()].animationChannelData.end(), continue);
+		FCDAnimationChannelDataMap::iterator it = FArchiveXML::GetDocumentLinkData(channel->GetDocument()).animationChannelData.find(channel);
+		FUAssert(it != FArchiveXML::GetDocumentLinkData(channel->GetDocument()).animationChannelData.end(), continue);
 		FCDAnimationChannelData& data = it->second;
 
-		if (!data.driverPointer.empty() && channel->GetCurveCount() > 0 && channel->GetCurve(0)->HasDriver())
+		if (!data.driverPointer.empty() && channel->GetCurveCount() > 0 && !channel->GetCurve(0)->HasDriver())
 		{
 			status &= FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_ANIM_CURVE_DRIVER_MISSING);
 		}
@@ -131,7 +122,7 @@ bool FArchiveXML::LinkAnimated(FCDAnimated* animated, xmlNode* node)
 		linked |= FArchiveXML::ProcessChannels(animated, channels);
 		if (linked)
 		{
-			FArchiveXML::documentLinkDataMap[animated->GetDocument()].animatedData.insert(animated, data);
+			FArchiveXML::GetDocumentLinkData(animated->GetDocument()).animatedData.insert(animated, data);
 		}
 	}
 	else linked = true;
@@ -169,7 +160,7 @@ bool FArchiveXML::LinkAnimatedCustom(FCDAnimatedCustom* animatedCustom, xmlNode*
 			if (chanelCurveCount == 0) continue;
 			
 			// Retrieve the channel's qualifier
-			FCDAnimationChannelData& channelData = FArchiveXML::documentLinkDataMap[channel->GetDocument()].animationChannelData[channel];
+			FCDAnimationChannelData& channelData = FArchiveXML::GetDocumentLinkData(channel->GetDocument()).animationChannelData[channel];
 			fm::string qualifier = channelData.targetQualifier;
 			if (qualifier.empty())
 			{
@@ -191,7 +182,7 @@ bool FArchiveXML::LinkAnimatedCustom(FCDAnimatedCustom* animatedCustom, xmlNode*
 		linked |= FArchiveXML::LinkDriver(animatedCustom->GetDocument(), animatedCustom, data.pointer);
 		if (linked)
 		{
-			FArchiveXML::documentLinkDataMap[animatedCustom->GetDocument()].animatedData.insert(animatedCustom, data);
+			FArchiveXML::GetDocumentLinkData(animatedCustom->GetDocument()).animatedData.insert(animatedCustom, data);
 		}
 	}
 	else linked = true;
@@ -209,8 +200,8 @@ bool FArchiveXML::LinkTargetedEntity(FCDTargetedEntity* targetedEntity)
 {
 	bool status = true;
 
-	FCDTargetedEntityDataMap::iterator it = FArchiveXML::documentLinkDataMap[targetedEntity->GetDocument()].targetedEntityDataMap.find(targetedEntity);
-	FUAssert(it != FArchiveXML::documentLinkDataMap[targetedEntity->GetDocument()].targetedEntityDataMap.end(),);
+	FCDTargetedEntityDataMap::iterator it = FArchiveXML::GetDocumentLinkData(targetedEntity->GetDocument()).targetedEntityDataMap.find(targetedEntity);
+	FUAssert(it != FArchiveXML::GetDocumentLinkData(targetedEntity->GetDocument()).targetedEntityDataMap.end(),);
 	FCDTargetedEntityData& data = it->second;
 
 	if (data.targetId.empty()) return status;
@@ -341,8 +332,8 @@ void FArchiveXML::LinkEffectParameterSurface(FCDEffectParameterSurface* effectPa
 
 void FArchiveXML::LinkEffectParameterSampler(FCDEffectParameterSampler* effectParameterSampler, FCDEffectParameterList& parameters)
 {
-	FCDEffectParameterSamplerDataMap::iterator it = FArchiveXML::documentLinkDataMap[effectParameterSampler->GetDocument()].effectParameterSamplerDataMap.find(effectParameterSampler);
-	FUAssert(it != FArchiveXML::documentLinkDataMap[effectParameterSampler->GetDocument()].effectParameterSamplerDataMap.end(),);
+	FCDEffectParameterSamplerDataMap::iterator it = FArchiveXML::GetDocumentLinkData(effectParameterSampler->GetDocument()).effectParameterSamplerDataMap.find(effectParameterSampler);
+	FUAssert(it != FArchiveXML::GetDocumentLinkData(effectParameterSampler->GetDocument()).effectParameterSamplerDataMap.end(),);
 	FCDEffectParameterSamplerData& data = it->second;
 
 	FCDEffectParameter* surface = nullptr;
@@ -470,8 +461,8 @@ void FArchiveXML::LinkEffectTechnique(FCDEffectTechnique* effectTechnique)
 
 void FArchiveXML::LinkTexture(FCDTexture* texture, FCDEffectParameterList& parameters)
 {
-	FCDTextureDataMap::iterator it = FArchiveXML::documentLinkDataMap[texture->GetDocument()].textureDataMap.find(texture);
-	FUAssert(it != FArchiveXML::documentLinkDataMap[texture->GetDocument()].textureDataMap.end(),);
+	FCDTextureDataMap::iterator it = FArchiveXML::GetDocumentLinkData(texture->GetDocument()).textureDataMap.find(texture);
+	FUAssert(it != FArchiveXML::GetDocumentLinkData(texture->GetDocument()).textureDataMap.end(),);
 	FCDTextureData& data = it->second;
 
 	if (!data.samplerSid.empty())
@@ -540,8 +531,8 @@ bool FArchiveXML::LinkSkinController(FCDSkinController* UNUSED(skinController))
 
 bool FArchiveXML::LinkMorphController(FCDMorphController* morphController)
 {
-	FCDMorphControllerDataMap::iterator it = FArchiveXML::documentLinkDataMap[morphController->GetDocument()].morphControllerDataMap.find(morphController);
-	FUAssert(it != FArchiveXML::documentLinkDataMap[morphController->GetDocument()].morphControllerDataMap.end(),);
+	FCDMorphControllerDataMap::iterator it = FArchiveXML::GetDocumentLinkData(morphController->GetDocument()).morphControllerDataMap.find(morphController);
+	FUAssert(it != FArchiveXML::GetDocumentLinkData(morphController->GetDocument()).morphControllerDataMap.end(),);
 	FCDMorphControllerData& data = it->second;
 
 	if (morphController->GetBaseTarget() == nullptr)
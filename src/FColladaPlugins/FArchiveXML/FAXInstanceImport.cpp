@@ -380,7 +380,7 @@ bool FArchiveXML::LinkControllerInstance(FCDControllerInstance* controllerInstan
 {
 	const FCDSkinController* skin =  FArchiveXML::FindSkinController(controllerInstance, controllerInstance->GetEntity());
 	if (skin == nullptr) return true;
-	FCDSkinControllerData& data = FArchiveXML::documentLinkDataMap[skin->GetDocument()].skinControllerDataMap.find(const_cast<FCDSkinController*>(skin))->second;
+	FCDSkinControllerData& data = FArchiveXML::GetDocumentLinkData(skin->GetDocument()).skinControllerDataMap.find(const_cast<FCDSkinController*>(skin))->second;
 
 	// Look for each joint, by COLLADA id, within the scene graph
 	size_t jointCount = skin->GetJointCount();
@@ -342,3 +342,6 @@ xmlNode* FArchiveXML::AddPhysicsParameter(xmlNode* parentNode, const char* name,
 	}
 	return paramNode;
 }
+
+// Also used by the physics instance export: make sure the optimizer doesn't drop this one.
+template xmlNode* FArchiveXML::AddPhysicsParameter<FMVector3, 0>(xmlNode*, const char*, FCDParameterAnimatableT<FMVector3, 0>&);
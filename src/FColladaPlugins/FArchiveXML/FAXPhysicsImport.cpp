@@ -229,8 +229,8 @@ bool FArchiveXML::AttachModelInstancesFCDPhysicsModel(FCDPhysicsModel* physicsMo
 {
 	bool status = true;
 
-	FCDPhysicsModelDataMap::iterator it = FArchiveXML::documentLinkDataMap[physicsModel->GetDocument()].physicsModelDataMap.find(physicsModel);
-	FUAssert(it != FArchiveXML::documentLinkDataMap[physicsModel->GetDocument()].physicsModelDataMap.end(),);
+	FCDPhysicsModelDataMap::iterator it = FArchiveXML::GetDocumentLinkData(physicsModel->GetDocument()).physicsModelDataMap.find(physicsModel);
+	FUAssert(it != FArchiveXML::GetDocumentLinkData(physicsModel->GetDocument()).physicsModelDataMap.end(),);
 	FCDPhysicsModelData& data = it->second;
 
 	for (ModelInstanceNameNodeMap::iterator node = data.modelInstancesMap.begin(); node != data.modelInstancesMap.end(); ++node)
@@ -645,7 +645,7 @@ bool FArchiveXML::LoadPhysicsModel(FCDObject* object, xmlNode* physicsModelNode)
 
 	bool status = true;
 	FCDPhysicsModel* physicsModel = (FCDPhysicsModel*)object;
-	FCDPhysicsModelData& data = FArchiveXML::documentLinkDataMap[physicsModel->GetDocument()].physicsModelDataMap[physicsModel];
+	FCDPhysicsModelData& data = FArchiveXML::GetDocumentLinkData(physicsModel->GetDocument()).physicsModelDataMap[physicsModel];
 	if (!IsEquivalent(physicsModelNode->name, DAE_PHYSICS_MODEL_ELEMENT))
 	{
 		FUError::Error(FUError::WARNING_LEVEL, FUError::WARNING_UNKNOWN_PHYS_LIB_ELEMENT, physicsModelNode->line);
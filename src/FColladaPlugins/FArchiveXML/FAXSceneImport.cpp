@@ -27,8 +27,10 @@ bool FArchiveXML::LoadEntity(FCDObject* object, xmlNode* entityNode)
 
 	bool status = true;
 
+	// The ids of the entities loaded in parallel are reserved in the document order, before their load.
 	fm::string fileId = FUDaeParser::ReadNodeId(entityNode);
-	if (!fileId.empty()) entity->SetDaeId(fileId);
+	if (entity == FArchiveXML::GetImportContext().reservedIdEntity) { if (!fileId.empty()) fileId = entity->GetDaeId(); }
+	else if (!fileId.empty()) entity->SetDaeId(fileId);
 	else entity->RemoveDaeId();
 
 	entity->SetName(TO_FSTRING(FUDaeParser::ReadNodeName(entityNode)));
@@ -83,7 +85,7 @@ bool FArchiveXML::LoadTargetedEntity(FCDObject* object, xmlNode* entityNode)
 
 	bool status = true;
 	FCDTargetedEntity* targetedEntity = (FCDTargetedEntity*)object;
-	FCDTargetedEntityData& data = FArchiveXML::documentLinkDataMap[targetedEntity->GetDocument()].targetedEntityDataMap[targetedEntity];
+	FCDTargetedEntityData& data = FArchiveXML::GetDocumentLinkData(targetedEntity->GetDocument()).targetedEntityDataMap[targetedEntity];
 
 	// Look for and extract the target information from the extra tree nodes.
 	// For backward-compatibility: we want to process the <technique> straight into the extra tree..
@@ -194,7 +196,7 @@ bool FArchiveXML::LoadSceneNode(FCDObject* object, xmlNode* node)
 	}
 
 	status &= FArchiveXML::LoadFromExtraSceneNode(sceneNode);
-	sceneNode->SetTransformsDirtyFlag();
+	sceneNode->InvalidateTransforms();
 	sceneNode->SetDirtyFlag();
 	return status;
 }		
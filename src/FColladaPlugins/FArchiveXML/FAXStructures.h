@@ -9,6 +9,10 @@
 #ifndef _FAXSTRUCTURES_H_
 #define _FAXSTRUCTURES_H_
 
+#ifndef _FM_HASH_MAP_H_
+#include "FMath/FMHashMap.h"
+#endif // _FM_HASH_MAP_H_
+
 class FCDObject;
 class FCDENode;
 class FCDEType;
@@ -164,7 +168,7 @@ typedef fm::map<FCDAnimationCurve*, FCDAnimationCurveData> FCDAnimationCurveData
 //
 struct FCDAnimationData
 {
-	FAXNodeIdPairList childNodes; // import-only.
+	FAXNodeIdMap childNodes; // import-only.
 };
 typedef fm::map<FCDAnimation*, FCDAnimationData> FCDAnimationDataMap;
 
@@ -226,6 +230,11 @@ typedef fm::map<FCDGeometrySource*, FCDGeometrySourceData> FCDGeometrySourceData
 
 typedef fm::pvector<FCDAnimationChannel> FCDAnimationChannelList;
 
+//
+// For the animation linking: the animation channels, by target or driver pointer.
+//
+typedef fm::hash_map<fm::string, FCDAnimationChannelList> FCDAnimationChannelPointerMap;
+
 #endif //_FAXSTRUCTURES_H_
 
 //
@@ -245,6 +254,72 @@ struct FCDocumentLinkData
 	FCDSkinControllerDataMap skinControllerDataMap;
 	FCDMorphControllerDataMap morphControllerDataMap;
 	FCDGeometrySourceDataMap geometrySourceDataMap;
+
+	// The animation channels, indexed on their target and driver pointers as they are loaded.
+	FCDAnimationChannelPointerMap targetChannelMap;
+	FCDAnimationChannelPointerMap driverChannelMap;
+
+	/** Merges in the link data of another import context.
+		Used to gather the link data of the entities loaded in parallel.
+		@param source The link data to merge in. */
+	void Merge(FCDocumentLinkData& source)
+	{
+		MergeMap(emitterInstanceDataMap, source.emitterInstanceDataMap);
+		MergeMap(targetedEntityDataMap, source.targetedEntityDataMap);
+		MergeMap(animatedData, source.animatedData);
+		MergeMap(animationCurveData, source.animationCurveData);
+		MergeMap(animationData, source.animationData);
+		MergeMap(physicsModelDataMap, source.physicsModelDataMap);
+		MergeMap(effectParameterSamplerDataMap, source.effectParameterSamplerDataMap);
+		MergeMap(textureDataMap, source.textureDataMap);
+		MergeMap(skinControllerDataMap, source.skinControllerDataMap);
+		MergeMap(morphControllerDataMap, source.morphControllerDataMap);
+		MergeMap(geometrySourceDataMap, source.geometrySourceDataMap);
+		MergeMap(animationChannelData, source.animationChannelData);
+		MergeChannelMap(targetChannelMap, source.targetChannelMap);
+		MergeChannelMap(driverChannelMap, source.driverChannelMap);
+	}
+
+private:
+	template <class MapType>
+	static void MergeMap(MapType& target, MapType& source)
+	{
+		for (typename MapType::iterator it = source.begin(); it != source.end(); ++it)
+		{
+			target.insert(it->first, it->second);
+		}
+	}
+
+	static void MergeChannelMap(FCDAnimationChannelPointerMap& target, FCDAnimationChannelPointerMap& source)
+	{
+		for (FCDAnimationChannelPointerMap::iterator it = source.begin(); it != source.end(); ++it)
+		{
+			FCDAnimationChannelList& channels = target[it->first];
+			channels.insert(channels.end(), it->second.begin(), it->second.end());
+		}
+	}
 };
 
 typedef fm::map<const FCDocument*, FCDocumentLinkData> DocumentLinkDataMap;
+
+//
+// Intermediate data of one import or export.
+// Each ImportFile/ImportFileFromMemory/ExportFile call owns its own context,
+// so that different documents may be processed on different threads.
+//
+struct FAXImportContext
+{
+	DocumentLinkDataMap documentLinkDataMap;
+	int loadedDocumentCount;
+
+	// When library entities are loaded in parallel, each entity has its own context.
+	// The animations are linked in the shared context of the import, one entity at a time.
+	FAXImportContext* sharedContext;
+	FUCriticalSection* sharedCriticalSection;
+
+	// The library entity loaded within this context, when its library is loaded in parallel:
+	// its id was reserved before the load.
+	FCDObject* reservedIdEntity;
+
+	FAXImportContext() : loadedDocumentCount(0), sharedContext(nullptr), sharedCriticalSection(nullptr), reservedIdEntity(nullptr) {}
+};
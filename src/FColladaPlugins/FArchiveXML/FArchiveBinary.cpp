@@ -0,0 +1,629 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#include "StdAfx.h"
+#include "FArchiveBinary.h"
+#include "FCDocument/FCDocument.h"
+#include "FUtils/FUFile.h"
+#include "FUtils/FUFileManager.h"
+#include "FUtils/FUXmlDocument.h"
+#include <libxml/parserInternals.h>
+
+// The binary archives are little-endian: on big-endian hosts, the numbers are swapped.
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define FAB_BIG_ENDIAN
+#endif
+
+//
+// Constants
+//
+
+static const char* kBinaryArchiveExtension = "fcb";
+static const uint8 kBinaryArchiveTag[4] = { 'F', 'C', 'B', 'A' };
+static const size_t kValueAlignment = 16;
+
+// The record types
+enum FABRecordType
+{
+	FAB_ELEMENT_RECORD = 1,
+	FAB_TEXT_RECORD,
+	FAB_FLOAT_VALUES_RECORD,
+	FAB_INT32_VALUES_RECORD,
+	FAB_UINT32_VALUES_RECORD
+};
+
+static inline uint32 SwapBytes(uint32 value)
+{
+	return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+}
+
+static inline uint32 ToLittleEndian(uint32 value)
+{
+#ifdef FAB_BIG_ENDIAN
+	return SwapBytes(value);
+#else
+	return value;
+#endif // FAB_BIG_ENDIAN
+}
+
+// Retrieves whether the numbers of an element may be written out as raw values.
+static bool IsValueElement(xmlNode* node)
+{
+	if (node->children == nullptr || node->children != node->last || node->children->type != XML_TEXT_NODE) return false;
+
+	const char* name = (const char*) node->name;
+	return IsEquivalent(name, DAE_FLOAT_ARRAY_ELEMENT) || IsEquivalent(name, DAE_INT_ARRAY_ELEMENT)
+		|| IsEquivalent(name, DAE_POLYGON_ELEMENT) || IsEquivalent(name, DAE_HOLE_ELEMENT)
+		|| IsEquivalent(name, DAE_VERTEX_ELEMENT) || IsEquivalent(name, DAE_VERTEXCOUNT_ELEMENT);
+}
+
+//
+// FABWriter
+//
+
+// Writes out the binary form of a XML tree.
+class FABWriter
+{
+private:
+	FUFile file;
+	size_t offset;
+	bool failed;
+	fm::map<fm::string, uint32> nameIndices;
+	StringList names;
+
+public:
+	FABWriter(const fchar* filename) : file(filename, FUFile::WRITE), offset(0), failed(!file.IsOpen()) {}
+
+	bool Write(xmlNode* rootNode)
+	{
+		if (failed) return false;
+
+		// Build the name table.
+		AddNames(rootNode);
+
+		// Write out the header.
+		WriteBytes(kBinaryArchiveTag, sizeof(kBinaryArchiveTag));
+		WriteUInt32(FAB_ARCHIVE_VERSION);
+		WriteUInt32((uint32) names.size());
+		for (StringList::iterator it = names.begin(); it != names.end(); ++it)
+		{
+			WriteString(it->c_str(), it->length());
+		}
+
+		// Write out the whole XML tree.
+		WriteNode(rootNode, 1);
+		file.Close();
+		return !failed;
+	}
+
+private:
+	void AddName(const xmlChar* _name)
+	{
+		fm::string name((const char*) _name);
+		if (nameIndices.find(name) == nameIndices.end())
+		{
+			nameIndices.insert(name, (uint32) names.size());
+			names.push_back(name);
+		}
+	}
+
+	void AddNames(xmlNode* node)
+	{
+		AddName(node->name);
+		for (xmlAttr* attribute = node->properties; attribute != nullptr; attribute = attribute->next)
+		{
+			AddName(attribute->name);
+		}
+		for (xmlNode* child = node->children; child != nullptr; child = child->next)
+		{
+			if (child->type == XML_ELEMENT_NODE) AddNames(child);
+		}
+	}
+
+	uint32 GetNameIndex(const xmlChar* name)
+	{
+		fm::map<fm::string, uint32>::iterator it = nameIndices.find(fm::string((const char*) name));
+		FUAssert(it != nameIndices.end(), return 0);
+		return it->second;
+	}
+
+	void WriteBytes(const void* data, size_t length)
+	{
+		if (length == 0 || failed) return;
+		failed = !file.Write(data, length);
+		offset += length;
+	}
+
+	void WriteUInt8(uint8 value) { WriteBytes(&value, 1); }
+	void WriteUInt32(uint32 value) { value = ToLittleEndian(value); WriteBytes(&value, sizeof(value)); }
+
+	void WriteString(const char* value, size_t length)
+	{
+		WriteUInt32((uint32) length);
+		WriteBytes(value, length + 1);
+	}
+
+	void WriteValues(FABRecordType type, const void* values, size_t count)
+	{
+		WriteUInt8((uint8) type);
+		WriteUInt32((uint32) count);
+
+		// Pad the values up to the next aligned offset.
+		static const uint8 padding[kValueAlignment] = { 0 };
+		WriteBytes(padding, (kValueAlignment - offset % kValueAlignment) % kValueAlignment);
+
+#ifdef FAB_BIG_ENDIAN
+		const uint32* words = (const uint32*) values;
+		for (size_t i = 0; i < count; ++i) WriteUInt32(words[i]);
+#else
+		WriteBytes(values, count * sizeof(uint32));
+#endif // FAB_BIG_ENDIAN
+	}
+
+	// Writes out the numbers of an element as raw values.
+	// The text content was written out by the XML archive: it holds only numbers.
+	void WriteElementValues(xmlNode* node)
+	{
+		const char* content = (const char*) node->children->content;
+
+		if (IsEquivalent(node->name, DAE_FLOAT_ARRAY_ELEMENT))
+		{
+			FloatList values;
+			FUStringConversion::ToFloatList(content, values);
+			WriteValues(FAB_FLOAT_VALUES_RECORD, values.begin(), values.size());
+		}
+		else
+		{
+			Int32List values;
+			FUStringConversion::ToInt32List(content, values);
+
+			bool isUnsigned = true;
+			for (Int32List::iterator it = values.begin(); it != values.end() && isUnsigned; ++it) isUnsigned = *it >= 0;
+			WriteValues(isUnsigned ? FAB_UINT32_VALUES_RECORD : FAB_INT32_VALUES_RECORD, values.begin(), values.size());
+		}
+	}
+
+	void WriteNode(xmlNode* node, uint32 depth)
+	{
+		// The trees nested too deeply could not be read back in.
+		if (depth > FAB_MAX_ELEMENT_DEPTH) { failed = true; return; }
+
+		WriteUInt8(FAB_ELEMENT_RECORD);
+		WriteUInt32(GetNameIndex(node->name));
+
+		// Write out the attributes.
+		uint32 attributeCount = 0;
+		for (xmlAttr* attribute = node->properties; attribute != nullptr; attribute = attribute->next) ++attributeCount;
+		WriteUInt32(attributeCount);
+		for (xmlAttr* attribute = node->properties; attribute != nullptr; attribute = attribute->next)
+		{
+			WriteUInt32(GetNameIndex(attribute->name));
+			const char* value = (attribute->children != nullptr && attribute->children->content != nullptr) ? (const char*) attribute->children->content : emptyCharString;
+			WriteString(value, strlen(value));
+		}
+
+		// Write out the children: only the elements and the texts are kept.
+		if (IsValueElement(node) && node->children->content != nullptr)
+		{
+			WriteUInt32(1);
+			WriteElementValues(node);
+			return;
+		}
+		else
+		{
+			uint32 childCount = 0;
+			for (xmlNode* child = node->children; child != nullptr; child = child->next)
+			{
+				if (child->type == XML_ELEMENT_NODE || child->type == XML_TEXT_NODE || child->type == XML_CDATA_SECTION_NODE) ++childCount;
+			}
+			WriteUInt32(childCount);
+		}
+		for (xmlNode* child = node->children; child != nullptr; child = child->next)
+		{
+			if (child->type == XML_ELEMENT_NODE) WriteNode(child, depth + 1);
+			else if (child->type == XML_TEXT_NODE || child->type == XML_CDATA_SECTION_NODE)
+			{
+				const char* content = (child->content != nullptr) ? (const char*) child->content : emptyCharString;
+				WriteUInt8(FAB_TEXT_RECORD);
+				WriteString(content, strlen(content));
+			}
+		}
+	}
+};
+
+//
+// FABReader
+//
+
+// Builds a XML tree from its binary form, without copying the names and the contents.
+// The tree nodes are allocated in blocks and point into the binary form, which must
+// be kept until the reader is released. The lists of numbers are attached to their
+// nodes, in place of their text content.
+class FABReader
+{
+private:
+	const uint8* data;
+	size_t length;
+	size_t offset;
+	bool failed;
+	fm::vector<const char*> names;
+
+	fm::pvector<uint8> blocks;
+	uint8* block;
+	size_t blockOffset;
+	xmlNodeList valueNodes;
+#ifdef FAB_BIG_ENDIAN
+	fm::pvector<UInt32List> swappedValues;
+#endif // FAB_BIG_ENDIAN
+
+public:
+	FABReader(const uint8* _data, size_t _length) : data(_data), length(_length), offset(0), failed(false), block(nullptr), blockOffset(kBlockSize) {}
+
+	~FABReader()
+	{
+		// The value nodes may have been given a text content by the XML parser.
+		for (xmlNode** it = valueNodes.begin(); it != valueNodes.end(); ++it)
+		{
+			if ((*it)->children != nullptr) xmlFreeNodeList((*it)->children);
+		}
+		for (uint8** it = blocks.begin(); it != blocks.end(); ++it) SAFE_DELETE_ARRAY(*it);
+#ifdef FAB_BIG_ENDIAN
+		CLEAR_POINTER_VECTOR(swappedValues);
+#endif // FAB_BIG_ENDIAN
+	}
+
+	// The tree is released with this reader.
+	xmlNode* Read()
+	{
+		// Verify the header.
+		uint32 version = 0, nameCount = 0;
+		if (length < sizeof(kBinaryArchiveTag) || memcmp(data, kBinaryArchiveTag, sizeof(kBinaryArchiveTag)) != 0) return nullptr;
+		offset = sizeof(kBinaryArchiveTag);
+		if (!ReadUInt32(version) || version != FAB_ARCHIVE_VERSION) return nullptr;
+		if (!ReadUInt32(nameCount) || nameCount > length - offset) return nullptr;
+
+		// Read in the name table.
+		names.resize(nameCount);
+		for (uint32 i = 0; i < nameCount; ++i)
+		{
+			uint32 nameLength;
+			if (!ReadString(names[i], nameLength)) return nullptr;
+		}
+
+		// Read in the whole XML tree.
+		uint8 recordType;
+		uint32 nameIndex;
+		if (!ReadUInt8(recordType) || recordType != FAB_ELEMENT_RECORD || !ReadName(nameIndex)) return nullptr;
+		xmlNode* rootNode = NewNode(XML_ELEMENT_NODE, nullptr, names[nameIndex]);
+		if (!ReadElement(rootNode, 1) || offset != length) return nullptr;
+		return rootNode;
+	}
+
+private:
+	static const size_t kBlockSize = 64 * 1024;
+
+	// Allocates a cleared structure from the current block.
+	template <class T>
+	T* Allocate()
+	{
+		size_t size = (sizeof(T) + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+		if (blockOffset + size > kBlockSize)
+		{
+			block = new uint8[kBlockSize];
+			blocks.push_back(block);
+			blockOffset = 0;
+		}
+		T* value = (T*) (block + blockOffset);
+		blockOffset += size;
+		memset(value, 0, sizeof(T));
+		return value;
+	}
+
+	xmlNode* NewNode(xmlElementType type, xmlNode* parent, const char* name)
+	{
+		xmlNode* node = Allocate<xmlNode>();
+		node->type = type;
+		node->name = (const xmlChar*) name;
+		if (parent != nullptr)
+		{
+			node->parent = parent;
+			node->prev = parent->last;
+			if (parent->last != nullptr) parent->last->next = node;
+			else parent->children = node;
+			parent->last = node;
+		}
+		return node;
+	}
+
+	xmlNode* NewTextNode(xmlNode* parent, const char* content)
+	{
+		xmlNode* node = NewNode(XML_TEXT_NODE, parent, (const char*) xmlStringText);
+		node->content = (xmlChar*) content;
+		return node;
+	}
+
+	xmlAttr* NewAttribute(xmlNode* node, xmlAttr* previous, const char* name, const char* value)
+	{
+		xmlAttr* attribute = Allocate<xmlAttr>();
+		attribute->type = XML_ATTRIBUTE_NODE;
+		attribute->name = (const xmlChar*) name;
+		attribute->parent = node;
+		xmlNode* valueNode = NewTextNode(nullptr, value);
+		valueNode->parent = (xmlNode*) attribute;
+		attribute->children = attribute->last = valueNode;
+
+		attribute->prev = previous;
+		if (previous != nullptr) previous->next = attribute;
+		else node->properties = attribute;
+		return attribute;
+	}
+
+	bool ReadUInt8(uint8& value)
+	{
+		if (failed || length - offset < 1) return failed = true, false;
+		value = data[offset++];
+		return true;
+	}
+
+	bool ReadUInt32(uint32& value)
+	{
+		if (failed || length - offset < sizeof(uint32)) return failed = true, false;
+		memcpy(&value, data + offset, sizeof(uint32));
+		value = ToLittleEndian(value);
+		offset += sizeof(uint32);
+		return true;
+	}
+
+	bool ReadName(uint32& index)
+	{
+		if (!ReadUInt32(index)) return false;
+		if (index >= names.size()) return failed = true, false;
+		return true;
+	}
+
+	bool ReadString(const char*& value, uint32& valueLength)
+	{
+		if (!ReadUInt32(valueLength)) return false;
+		if (valueLength >= length - offset || data[offset + valueLength] != 0) return failed = true, false;
+		value = (const char*) (data + offset);
+		offset += valueLength + 1;
+		return true;
+	}
+
+	bool ReadValues(xmlNode* node, FUXmlNodeValues::Type type)
+	{
+		uint32 count;
+		if (!ReadUInt32(count)) return false;
+		offset += (kValueAlignment - offset % kValueAlignment) % kValueAlignment;
+		if (offset > length || count > (length - offset) / sizeof(uint32)) return failed = true, false;
+
+		FUXmlNodeValues* values = Allocate<FUXmlNodeValues>();
+		values->type = type;
+		values->count = count;
+#ifdef FAB_BIG_ENDIAN
+		UInt32List* swapped = new UInt32List(count, 0);
+		swappedValues.push_back(swapped);
+		for (uint32 i = 0; i < count; ++i)
+		{
+			uint32 value;
+			memcpy(&value, data + offset + i * sizeof(uint32), sizeof(uint32));
+			swapped->at(i) = SwapBytes(value);
+		}
+		values->values = swapped->begin();
+#else
+		values->values = data + offset;
+#endif // FAB_BIG_ENDIAN
+		offset += count * sizeof(uint32);
+
+		// Attach the numbers to the element node.
+		node->_private = values;
+		valueNodes.push_back(node);
+		return true;
+	}
+
+	bool ReadElement(xmlNode* node, uint32 depth)
+	{
+		// Reject the trees nested too deeply to be read in safely.
+		if (depth > FAB_MAX_ELEMENT_DEPTH) return failed = true, false;
+
+		uint32 attributeCount, childCount;
+		if (!ReadUInt32(attributeCount)) return false;
+		xmlAttr* attribute = nullptr;
+		for (uint32 i = 0; i < attributeCount; ++i)
+		{
+			uint32 nameIndex, valueLength;
+			const char* value;
+			if (!ReadName(nameIndex) || !ReadString(value, valueLength)) return false;
+			attribute = NewAttribute(node, attribute, names[nameIndex], value);
+		}
+
+		if (!ReadUInt32(childCount)) return false;
+		for (uint32 i = 0; i < childCount; ++i)
+		{
+			uint8 recordType;
+			if (!ReadUInt8(recordType)) return false;
+			switch (recordType)
+			{
+			case FAB_ELEMENT_RECORD: {
+				uint32 nameIndex;
+				if (!ReadName(nameIndex)) return false;
+				xmlNode* child = NewNode(XML_ELEMENT_NODE, node, names[nameIndex]);
+				if (!ReadElement(child, depth + 1)) return false;
+				break; }
+
+			case FAB_TEXT_RECORD: {
+				uint32 contentLength;
+				const char* content;
+				if (!ReadString(content, contentLength)) return false;
+				NewTextNode(node, content);
+				break; }
+
+			case FAB_FLOAT_VALUES_RECORD: if (childCount != 1 || !ReadValues(node, FUXmlNodeValues::FLOAT)) return failed = true, false; break;
+			case FAB_INT32_VALUES_RECORD: if (childCount != 1 || !ReadValues(node, FUXmlNodeValues::INT32)) return failed = true, false; break;
+			case FAB_UINT32_VALUES_RECORD: if (childCount != 1 || !ReadValues(node, FUXmlNodeValues::UINT32)) return failed = true, false; break;
+			default: return failed = true, false;
+			}
+		}
+		return true;
+	}
+};
+
+//
+// FArchiveBinary
+//
+
+ImplementObjectType(FArchiveBinary)
+
+FArchiveBinary::FArchiveBinary()
+{
+}
+
+FArchiveBinary::~FArchiveBinary()
+{
+}
+
+bool FArchiveBinary::IsExtensionSupported(const char* ext)
+{
+	return IsEquivalentI(ext, kBinaryArchiveExtension);
+}
+
+const char* FArchiveBinary::GetSupportedExtensionAt(int index)
+{
+	return (index == 0) ? kBinaryArchiveExtension : nullptr;
+}
+
+bool FArchiveBinary::AddExtraExtension(const char* UNUSED(ext))
+{
+	return false;
+}
+
+bool FArchiveBinary::RemoveExtraExtension(const char* UNUSED(ext))
+{
+	return false;
+}
+
+bool FArchiveBinary::ImportBinary(FCDocument* theDocument, const uint8* data, size_t length)
+{
+	// Build the XML tree in place and read it in as a COLLADA document.
+	// The tree points into the data: the data must be kept until the document is read in.
+	FABReader reader(data, length);
+	xmlNode* rootNode = reader.Read();
+	if (rootNode == nullptr)
+	{
+		FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_PARSING_FAILED);
+		return false;
+	}
+	return Import(theDocument, rootNode);
+}
+
+bool FArchiveBinary::ImportFile(const fchar* filePath, FCDocument* fcdocument)
+{
+	bool status = true;
+	FAXImportContextScope importContext;
+
+	fcdocument->SetFileUrl(fstring(filePath));
+
+	_FTRY
+	{
+		FUFile* file = fcdocument->GetFileManager()->OpenFile(fcdocument->GetFileUrl(), FUFile::READ_MAPPED);
+		if (file->IsOpen() && file->GetMappedData() != nullptr)
+		{
+			// Read the file contents in place.
+			status = ImportBinary(fcdocument, (const uint8*) file->GetMappedData(), file->GetLength());
+		}
+		else if (file->IsOpen())
+		{
+			size_t fileLength = file->GetLength();
+			uint8* fileData = new uint8[fileLength];
+			status = file->Read(fileData, fileLength) && ImportBinary(fcdocument, fileData, fileLength);
+			SAFE_DELETE_ARRAY(fileData);
+		}
+		else
+		{
+			status = false;
+			FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_PARSING_FAILED);
+		}
+		SAFE_DELETE(file);
+
+		// Clean-up the intermediate data
+		FArchiveXML::ClearIntermediateData();
+	}
+	_FCATCH_ALL
+	{
+		FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_PARSING_FAILED);
+		status = false;
+	}
+
+	if (status) FUError::Error(FUError::DEBUG_LEVEL, FUError::DEBUG_LOAD_SUCCESSFUL);
+	return status;
+}
+
+bool FArchiveBinary::ImportFileFromMemory(const fchar* filePath, FCDocument* fcdocument, const void* contents, size_t length)
+{
+	bool status = true;
+	FAXImportContextScope importContext;
+
+	_FTRY
+	{
+		fcdocument->SetFileUrl(fstring(filePath));
+		status = ImportBinary(fcdocument, (const uint8*) contents, length);
+
+		// Clean-up the intermediate data
+		FArchiveXML::ClearIntermediateData();
+	}
+	_FCATCH_ALL
+	{
+		FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_PARSING_FAILED);
+		status = false;
+	}
+
+	if (status) FUError::Error(FUError::DEBUG_LEVEL, FUError::DEBUG_LOAD_SUCCESSFUL);
+	return status;
+}
+
+bool FArchiveBinary::ExportFile(FCDocument* fcdocument, const fchar* filePath)
+{
+	bool status = true;
+	FAXImportContextScope importContext;
+
+	fcdocument->SetFileUrl(fstring(filePath));
+
+	_FTRY
+	{
+		// Build the whole XML tree, then write out its binary form
+		FUXmlDocument daeDocument(nullptr, filePath, false);
+		xmlNode* rootNode = daeDocument.CreateRootNode(DAE_COLLADA_ELEMENT);
+		status = ExportDocument(fcdocument, rootNode);
+		if (status)
+		{
+			FABWriter writer(filePath);
+			if (!writer.Write(rootNode))
+			{
+				status = false;
+				FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_WRITE_FILE, 0);
+			}
+			else
+			{
+				FUError::Error(FUError::DEBUG_LEVEL, FUError::DEBUG_WRITE_SUCCESSFUL);
+			}
+		}
+	}
+	_FCATCH_ALL
+	{
+		FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_PARSING_FAILED);
+	}
+
+	return status;
+}
+
+// The binary archives hold whole documents only.
+bool FArchiveBinary::StartExport(const fchar* UNUSED(absoluteFilePath)) { return false; }
+bool FArchiveBinary::ExportObject(FCDObject* UNUSED(object)) { return false; }
+bool FArchiveBinary::EndExport(fm::vector<uint8>& UNUSED(outData)) { return false; }
+bool FArchiveBinary::EndExport(const fchar* UNUSED(filePath)) { return false; }
+bool FArchiveBinary::ImportObject(FCDObject* UNUSED(object), const fm::vector<uint8>& UNUSED(data)) { return false; }
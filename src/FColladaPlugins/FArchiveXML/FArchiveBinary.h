@@ -0,0 +1,100 @@
+/*
+	Copyright (C) 2005-2007 Feeling Software Inc.
+	Portions of the code are:
+	Copyright (C) 2005-2007 Sony Computer Entertainment America
+
+	MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#ifndef _FCPARCHIVEBINARY_H_
+#define _FCPARCHIVEBINARY_H_
+
+#ifndef _FCPARCHIVECOLLADA_H_
+#include "FArchiveXML.h"
+#endif // _FCPARCHIVECOLLADA_H_
+
+#define FCP_ARCHIVEBINARY_NAME "Binary Archive Plug-in"
+
+/** The current version of the binary archive format. */
+#define FAB_ARCHIVE_VERSION 1
+
+/** The deepest nesting of elements within a binary archive.
+	The deeper archives are neither written out nor read in. */
+#define FAB_MAX_ELEMENT_DEPTH 2048
+
+/**
+	The binary archive plug-in.
+
+	Writes out and reads in a compact binary form of the COLLADA document,
+	meant to be used as a cache for documents that are loaded often.
+	The binary form holds the same COLLADA elements as the XML archive:
+	the documents are written out and read in by the XML archive functions,
+	so every library supported by the XML archive is supported.
+
+	The element names are written out once, in a name table. The numbers of the
+	<float_array>, <int_array>, <p>, <h>, <v> and <vcount> elements are always written
+	out as raw little-endian 32-bit values, aligned on 16 bytes from the start of the file.
+	The file is mapped in memory when read in. The XML tree is then built in place:
+	its nodes point to the names, the texts and the numbers within the file, which
+	are neither copied nor parsed.
+
+	The file layout is:
+	- The header: the "FCBA" tag, the format version and the number of names, as 32-bit values.
+	- The name table: each name is a string.
+	- The root element record.
+
+	The records start with a record type byte:
+	- An element: its name index, its attribute count, the attributes,
+		its child record count and the child records. Each attribute is
+		a name index followed by a string.
+	- A text: a string.
+	- A list of numbers: the number count, padding up to the next 16-byte boundary
+		and the numbers. This record is always the sole child of an element.
+
+	The counts and indices are 32-bit values. The strings are their
+	32-bit length, their characters and a terminating null character.
+*/
+class FArchiveBinary : public FArchiveXML
+{
+private:
+	DeclareObjectType(FArchiveXML);
+
+public:
+	FArchiveBinary();
+	virtual ~FArchiveBinary();
+
+	/**
+		See FColladaPlugin.h
+	*/
+	virtual bool IsPartialExportSupported(){ return false; }
+
+	virtual bool IsExtensionSupported(const char* ext);
+	virtual int GetSupportedExtensionsCount(){ return 1; }
+	virtual const char* GetSupportedExtensionAt(int index);
+
+	virtual bool AddExtraExtension(const char* ext);
+	virtual bool RemoveExtraExtension(const char* ext);
+
+	virtual bool ImportFile(const fchar* filePath, FCDocument* fcdocument);
+	virtual bool ImportFileFromMemory(const fchar* filePath, FCDocument* fcdocument, const void* contents, size_t length);
+
+	virtual bool ExportFile(FCDocument* fcdocument, const fchar* filePath);
+
+	virtual bool StartExport(const fchar* absoluteFilePath);
+	virtual bool ExportObject(FCDObject* object);
+	virtual bool EndExport(fm::vector<uint8>& outData);
+	virtual bool EndExport(const fchar* filePath);
+
+	virtual bool ImportObject(FCDObject* object, const fm::vector<uint8>& data);
+
+	/**
+		See FUPlugin.h
+	*/
+	virtual const char* GetPluginName() const { return FCP_ARCHIVEBINARY_NAME; }
+	virtual uint32 GetPluginVersion() const { return FAB_ARCHIVE_VERSION; }
+
+private:
+	bool ImportBinary(FCDocument* theDocument, const uint8* data, size_t length);
+};
+
+#endif //_FCPARCHIVEBINARY_H_
@@ -8,6 +8,7 @@
 
 #include "StdAfx.h"
 #include "FArchiveXML.h"
+#include "FArchiveBinary.h"
 #include "FCDocument/FCDObject.h"
 #include "FCDocument/FCDAnimated.h"
 #include "FCDocument/FCDAnimationKey.h"
@@ -76,6 +77,9 @@
 #include "FCDocument/FCDLibrary.h"
 #include "FCDocument/FCDVersion.h"
 #include "FUtils/FUXmlDocument.h"
+#include "FUtils/FUXmlReader.h"
+#include "FUtils/FUXmlStreamWriter.h"
+#include "FUtils/FUThreadPool.h"
 
 
 //
@@ -92,16 +96,42 @@ ImplementObjectType(FArchiveXML)
 XMLLoadFuncMap FArchiveXML::xmlLoadFuncs;
 XMLWriteFuncMap FArchiveXML::xmlWriteFuncs;
 
-DocumentLinkDataMap FArchiveXML::documentLinkDataMap;
-int FArchiveXML::loadedDocumentCount = 0;
+// The intermediate data of the import or export running on each thread.
+static thread_local FAXImportContext defaultImportContext;
+static thread_local FAXImportContext* currentImportContext = nullptr;
+
+// The number of archive plug-ins that share the load and write function maps.
+static size_t archiveInstanceCount = 0;
+
+// The worker threads used to load the library entities in parallel.
+// Created with the first parallel import and shared by all the imports.
+static FUThreadPool* parallelImportPool = nullptr;
+static FUCriticalSection parallelImportPoolCriticalSection;
+
+static FUThreadPool* GetParallelImportPool()
+{
+	parallelImportPoolCriticalSection.Enter();
+	if (parallelImportPool == nullptr) parallelImportPool = new FUThreadPool();
+	FUThreadPool* pool = parallelImportPool;
+	parallelImportPoolCriticalSection.Leave();
+	return pool;
+}
 
 FArchiveXML::FArchiveXML(void)
 {
+	++archiveInstanceCount;
 	Initialize();
 }
 
 FArchiveXML::~FArchiveXML(void)
 {
+	// The function maps and the worker threads are shared with the other archive plug-ins.
+	if (--archiveInstanceCount > 0) return;
+
+	parallelImportPoolCriticalSection.Enter();
+	SAFE_DELETE(parallelImportPool);
+	parallelImportPoolCriticalSection.Leave();
+
 	xmlLoadFuncs.clear();
 	xmlWriteFuncs.clear();
 }
@@ -164,6 +194,9 @@ const char* FArchiveXML::GetSupportedExtensionAt(int index)
 
 void FArchiveXML::Initialize()
 {
+	// The XML parser must be initialized once, before any document is loaded on another thread.
+	xmlInitParser();
+
 	if (xmlLoadFuncs.empty())
 	{
 		xmlLoadFuncs.insert(&FCDObject::GetClassType(), FArchiveXML::LoadObject);
@@ -371,31 +404,80 @@ void FArchiveXML::Initialize()
 
 void FArchiveXML::ClearIntermediateData()
 {
-	FArchiveXML::documentLinkDataMap.clear();
+	FArchiveXML::GetImportContext().documentLinkDataMap.clear();
+}
+
+FAXImportContext& FArchiveXML::GetImportContext()
+{
+	return (currentImportContext != nullptr) ? *currentImportContext : defaultImportContext;
+}
+
+FAXImportContext* FArchiveXML::SetImportContext(FAXImportContext* context)
+{
+	FAXImportContext* previousContext = currentImportContext;
+	currentImportContext = context;
+	return previousContext;
+}
+
+FAXImportContext* FArchiveXML::EnterSharedImportContext()
+{
+	FAXImportContext* entityContext = currentImportContext;
+	if (entityContext == nullptr || entityContext->sharedContext == nullptr) return nullptr;
+
+	entityContext->sharedCriticalSection->Enter();
+	currentImportContext = entityContext->sharedContext;
+	return entityContext;
+}
+
+void FArchiveXML::LeaveSharedImportContext(FAXImportContext* entityContext)
+{
+	if (entityContext == nullptr) return;
+
+	FUAssert(currentImportContext == entityContext->sharedContext,);
+	currentImportContext = entityContext;
+	entityContext->sharedCriticalSection->Leave();
 }
 
 bool FArchiveXML::ImportFile(const fchar* filePath, FCDocument* fcdocument)
 {
 	bool status = true;
+	FAXImportContextScope importContext;
 
 	fcdocument->SetFileUrl(fstring(filePath));
 
 	_FTRY
 	{
-		// Parse the document into a XML tree
-		FUXmlDocument daeDocument(fcdocument->GetFileManager(), fcdocument->GetFileUrl(), true);
-		xmlNode* rootNode = daeDocument.GetRootNode();
-		if (rootNode != nullptr)
+		if (FCollada::GetStreamingImportFlag())
 		{
-			//fcdocument->GetFileManager()->PushRootFile(filePath);
-			// Read in the whole document from the root node
-			status &= (Import(fcdocument, rootNode));
-			//fcdocument->GetFileManager()->PopRootFile();
+			// Read in the document one element at a time, without building the whole XML tree
+			FUXmlReader daeReader(fcdocument->GetFileManager(), fcdocument->GetFileUrl());
+			if (daeReader.IsOpen())
+			{
+				status &= (ImportStreamed(fcdocument, daeReader));
+			}
+			else
+			{
+				status = false;
+				FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_MALFORMED_XML);
+			}
 		}
 		else
 		{
-			status = false;
-    		FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_MALFORMED_XML);
+			// Parse the document into a XML tree
+			FUXmlDocument daeDocument(fcdocument->GetFileManager(), fcdocument->GetFileUrl(), true);
+			xmlNode* rootNode = daeDocument.GetRootNode();
+			if (rootNode != nullptr)
+			{
+				//fcdocument->GetFileManager()->PushRootFile(filePath);
+				// Read in the whole document from the root node
+				status &= (Import(fcdocument, rootNode));
+				//fcdocument->GetFileManager()->PopRootFile();
+			}
+			else
+			{
+				status = false;
+	    		FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_MALFORMED_XML);
+			}
 		}
 
 		// Clean-up the XML reader
@@ -413,23 +495,41 @@ bool FArchiveXML::ImportFile(const fchar* filePath, FCDocument* fcdocument)
 bool FArchiveXML::ImportFileFromMemory(const fchar* filePath, FCDocument* fcdocument, const void* contents, size_t length)
 {
 	bool status = true;
+	FAXImportContextScope importContext;
 
     _FTRY
     {
 		fcdocument->SetFileUrl(fstring(filePath));
 
-		// Parse the document into a XML tree
-		FUXmlDocument daeDocument((const char*) contents, length);
-		xmlNode* rootNode = daeDocument.GetRootNode();
-		if (rootNode != nullptr)
+		if (FCollada::GetStreamingImportFlag())
 		{
-			// Read in the whole document from the root node
-			status &= (Import(fcdocument, rootNode));
+			// Read in the document one element at a time, without building the whole XML tree
+			FUXmlReader daeReader((const char*) contents, length);
+			if (daeReader.IsOpen())
+			{
+				status &= (ImportStreamed(fcdocument, daeReader));
+			}
+			else
+			{
+				status = false;
+				FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_MALFORMED_XML);
+			}
 		}
 		else
 		{
-			status = false;
-			FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_MALFORMED_XML);
+			// Parse the document into a XML tree
+			FUXmlDocument daeDocument((const char*) contents, length);
+			xmlNode* rootNode = daeDocument.GetRootNode();
+			if (rootNode != nullptr)
+			{
+				// Read in the whole document from the root node
+				status &= (Import(fcdocument, rootNode));
+			}
+			else
+			{
+				status = false;
+				FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_MALFORMED_XML);
+			}
 		}
 
 		// Clean-up the XML reader
@@ -448,6 +548,7 @@ bool FArchiveXML::ImportFileFromMemory(const fchar* filePath, FCDocument* fcdocu
 bool FArchiveXML::ExportFile(FCDocument* fcdocument, const fchar* filePath)
 {
 	bool status = true;
+	FAXImportContextScope importContext;
 
 	fcdocument->SetFileUrl(fstring(filePath));
 
@@ -456,11 +557,27 @@ bool FArchiveXML::ExportFile(FCDocument* fcdocument, const fchar* filePath)
 		// Create a new XML document
 		FUXmlDocument daeDocument(nullptr, filePath, false);
 		xmlNode* rootNode = daeDocument.CreateRootNode(DAE_COLLADA_ELEMENT);
-		status = ExportDocument(fcdocument, rootNode);
+		bool written;
+		if (FCollada::GetStreamingExportFlag())
+		{
+			// Write out the XML tree as it is built, one library entity at a time
+			FUXmlStreamWriter writer(fcdocument->GetFileManager(), filePath);
+			if (writer.IsOpen())
+			{
+				status = ExportDocument(fcdocument, rootNode, &writer);
+				written = writer.Close();
+			}
+			else written = false;
+		}
+		else
+		{
+			// Build the whole XML tree, then write it out to the given filename
+			status = ExportDocument(fcdocument, rootNode);
+			written = status && daeDocument.Write();
+		}
 		if (status)
 		{
-			// Create the XML document and write it out to the given filename
-			if (!daeDocument.Write())
+			if (!written)
 			{
 				FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_WRITE_FILE, rootNode->line);
 			}
@@ -536,7 +653,7 @@ bool FArchiveXML::ImportObject(FCDObject* object, const fm::vector<uint8>& data)
 {
 	FUXmlDocument loadDocument((const char*) data.begin(), data.size());
 	bool retVal = LoadSwitch(object, &object->GetObjectType(), loadDocument.GetRootNode());
-	if (FArchiveXML::loadedDocumentCount == 0)
+	if (FArchiveXML::GetImportContext().loadedDocumentCount == 0)
 		FArchiveXML::ClearIntermediateData();
 	return retVal;
 }
@@ -546,13 +663,124 @@ enum nodeOrder { ANIMATION=0, ANIMATION_CLIP, IMAGE, EFFECT, MATERIAL, GEOMETRY,
 struct xmlOrderedNode { xmlNode* node; nodeOrder order; };
 typedef fm::vector<xmlOrderedNode> xmlOrderedNodeList;
 
-bool FArchiveXML::Import(FCDocument* theDocument, xmlNode* colladaNode)
+// Retrieves the loading order of a top-level library element.
+static nodeOrder GetLibraryOrder(const char* name)
 {
-	bool status = true;
+	if (IsEquivalent(name, DAE_LIBRARY_ANIMATION_ELEMENT)) return ANIMATION;
+	else if (IsEquivalent(name, DAE_LIBRARY_ANIMATION_CLIP_ELEMENT)) return ANIMATION_CLIP;
+	else if (IsEquivalent(name, DAE_LIBRARY_CAMERA_ELEMENT)) return CAMERA;
+	else if (IsEquivalent(name, DAE_LIBRARY_CONTROLLER_ELEMENT)) return CONTROLLER;
+	else if (IsEquivalent(name, DAE_LIBRARY_EFFECT_ELEMENT)) return EFFECT;
+	else if (IsEquivalent(name, DAE_LIBRARY_GEOMETRY_ELEMENT)) return GEOMETRY;
+	else if (IsEquivalent(name, DAE_LIBRARY_IMAGE_ELEMENT)) return IMAGE;
+	else if (IsEquivalent(name, DAE_LIBRARY_LIGHT_ELEMENT)) return LIGHT;
+	else if (IsEquivalent(name, DAE_LIBRARY_MATERIAL_ELEMENT)) return MATERIAL;
+	else if (IsEquivalent(name, DAE_LIBRARY_VSCENE_ELEMENT)) return VISUAL_SCENE;
+	else if (IsEquivalent(name, DAE_LIBRARY_FFIELDS_ELEMENT)) return FORCE_FIELD;
+	else if (IsEquivalent(name, DAE_LIBRARY_NODE_ELEMENT)) return VISUAL_SCENE; // Process them as visual scenes.
+	else if (IsEquivalent(name, DAE_LIBRARY_PMATERIAL_ELEMENT)) return PHYSICS_MATERIAL;
+	else if (IsEquivalent(name, DAE_LIBRARY_PMODEL_ELEMENT)) return PHYSICS_MODEL;
+	else if (IsEquivalent(name, DAE_LIBRARY_PSCENE_ELEMENT)) return PHYSICS_SCENE;
+	return UNKNOWN;
+}
+
+// Retrieves the document library for a given loading order, along with
+// the functions that load the whole library and one library element.
+static FCDObject* GetOrderedLibrary(FCDocument* document, nodeOrder order, XMLLoadFunc& loadLibrary, XMLLoadFunc& loadEntry)
+{
+	switch (order)
+	{
+	case ANIMATION: loadLibrary = FArchiveXML::LoadAnimationLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDAnimation>; return document->GetAnimationLibrary();
+	case ANIMATION_CLIP: loadLibrary = FArchiveXML::LoadAnimationClipLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDAnimationClip>; return document->GetAnimationClipLibrary();
+	case CAMERA: loadLibrary = FArchiveXML::LoadCameraLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDCamera>; return document->GetCameraLibrary();
+	case CONTROLLER: loadLibrary = FArchiveXML::LoadControllerLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDController>; return document->GetControllerLibrary();
+	case EFFECT: loadLibrary = FArchiveXML::LoadEffectLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDEffect>; return document->GetEffectLibrary();
+	case EMITTER: loadLibrary = FArchiveXML::LoadEmitterLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDEmitter>; return document->GetEmitterLibrary();
+	case FORCE_FIELD: loadLibrary = FArchiveXML::LoadForceFieldLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDForceField>; return document->GetForceFieldLibrary();
+	case GEOMETRY: loadLibrary = FArchiveXML::LoadGeometryLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDGeometry>; return document->GetGeometryLibrary();
+	case IMAGE: loadLibrary = FArchiveXML::LoadImageLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDImage>; return document->GetImageLibrary();
+	case LIGHT: loadLibrary = FArchiveXML::LoadLightLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDLight>; return document->GetLightLibrary();
+	case MATERIAL: loadLibrary = FArchiveXML::LoadMaterialLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDMaterial>; return document->GetMaterialLibrary();
+	case PHYSICS_MODEL: loadLibrary = FArchiveXML::LoadPhysicsModelLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDPhysicsModel>; return document->GetPhysicsModelLibrary();
+	case PHYSICS_MATERIAL: loadLibrary = FArchiveXML::LoadPhysicsMaterialLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDPhysicsMaterial>; return document->GetPhysicsMaterialLibrary();
+	case PHYSICS_SCENE: loadLibrary = FArchiveXML::LoadPhysicsSceneLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDPhysicsScene>; return document->GetPhysicsSceneLibrary();
+	case VISUAL_SCENE: loadLibrary = FArchiveXML::LoadVisualSceneNodeLibrary; loadEntry = FArchiveXML::LoadLibraryEntry<FCDSceneNode>; return document->GetVisualSceneLibrary();
+	case UNKNOWN: default: loadLibrary = nullptr; loadEntry = nullptr; return nullptr;
+	}
+}
 
-	if (FArchiveXML::loadedDocumentCount == 0)
+// Loads one whole library element of the given loading order.
+static bool LoadOrderedLibrary(FCDocument* document, nodeOrder order, xmlNode* libraryNode)
+{
+	XMLLoadFunc loadLibrary, loadEntry;
+	FCDObject* library = GetOrderedLibrary(document, order, loadLibrary, loadEntry);
+	if (library == nullptr) return true;
+
+	bool status = (*loadLibrary)(library, libraryNode);
+	if (order == PHYSICS_MODEL)
+	{
+		size_t physicsModelCount = document->GetPhysicsModelLibrary()->GetEntityCount();
+		for (size_t physicsModelCounter = 0; physicsModelCounter < physicsModelCount; physicsModelCounter++)
+		{
+			FCDPhysicsModel* model = document->GetPhysicsModelLibrary()->GetEntity(physicsModelCounter);
+			status &= FArchiveXML::AttachModelInstancesFCDPhysicsModel(model);
+		}
+	}
+	return status;
+}
+
+// Reads in the <scene> element.
+static bool LoadSceneInstances(FCDocument* document, xmlNode* sceneNode)
+{
+	bool oneVisualSceneInstanceFound = false;
+	for (xmlNode* child = sceneNode->children; child != nullptr; child = child->next)
+	{
+		if (child->type != XML_ELEMENT_NODE) continue;
+		bool isVisualSceneInstance = IsEquivalent(child->name, DAE_INSTANCE_VSCENE_ELEMENT) && !oneVisualSceneInstanceFound;
+		bool isPhysicsSceneInstance = IsEquivalent(child->name, DAE_INSTANCE_PHYSICS_SCENE_ELEMENT);
+		if (!isVisualSceneInstance && !isPhysicsSceneInstance)
+		{
+			FUError::Error(FUError::WARNING_LEVEL, FUError::ERROR_INVALID_ELEMENT, child->line);
+			continue;
+		}
+
+		FUUri instanceUri = ReadNodeUrl(child);
+		if (instanceUri.GetFragment().empty())
+		{
+			FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_INVALID_URI, child->line);
+		}
+		else
+		{
+			FCDEntityReference* reference = (isVisualSceneInstance) ? document->GetVisualSceneInstanceReference() : document->AddPhysicsSceneInstanceReference();
+			reference->SetUri(instanceUri);
+			if (reference->IsLocal() && reference->GetEntity() == nullptr)
+			{
+				FUError::Error(FUError::WARNING_LEVEL, FUError::WARNING_MISSING_URI_TARGET, child->line);
+			}
+		}
+	}
+	return true;
+}
+
+bool FArchiveXML::Import(FCDocument* theDocument, xmlNode* colladaNode)
+{
+	if (FArchiveXML::GetImportContext().loadedDocumentCount == 0)
 		FArchiveXML::ClearIntermediateData();
-	++FArchiveXML::loadedDocumentCount;
+	++FArchiveXML::GetImportContext().loadedDocumentCount;
+
+	bool status = FArchiveXML::ImportLibraries(theDocument, colladaNode);
+	if (!FCollada::CancelLoading())
+	{
+		status &= FArchiveXML::LinkImportedDocument(theDocument);
+	}
+
+	--FArchiveXML::GetImportContext().loadedDocumentCount;
+	return status;
+}
+
+bool FArchiveXML::ImportLibraries(FCDocument* theDocument, xmlNode* colladaNode)
+{
+	bool status = true;
 
 	// The only root node supported is "COLLADA"
 	if (!IsEquivalent(colladaNode->name, DAE_COLLADA_ELEMENT))
@@ -575,22 +803,11 @@ bool FArchiveXML::Import(FCDocument* theDocument, xmlNode* colladaNode)
 
 		xmlOrderedNode n;
 		n.node = child;
-		n.order = UNKNOWN;
-		if (IsEquivalent(child->name, DAE_LIBRARY_ANIMATION_ELEMENT)) n.order = ANIMATION;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_ANIMATION_CLIP_ELEMENT)) n.order = ANIMATION_CLIP;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_CAMERA_ELEMENT)) n.order = CAMERA;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_CONTROLLER_ELEMENT)) n.order = CONTROLLER;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_EFFECT_ELEMENT)) n.order = EFFECT;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_GEOMETRY_ELEMENT)) n.order = GEOMETRY;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_IMAGE_ELEMENT)) n.order = IMAGE;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_LIGHT_ELEMENT)) n.order = LIGHT;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_MATERIAL_ELEMENT)) n.order = MATERIAL;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_VSCENE_ELEMENT)) n.order = VISUAL_SCENE;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_FFIELDS_ELEMENT)) n.order = FORCE_FIELD;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_NODE_ELEMENT)) n.order = VISUAL_SCENE; // Process them as visual scenes.
-		else if (IsEquivalent(child->name, DAE_LIBRARY_PMATERIAL_ELEMENT)) n.order = PHYSICS_MATERIAL;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_PMODEL_ELEMENT)) n.order = PHYSICS_MODEL;
-		else if (IsEquivalent(child->name, DAE_LIBRARY_PSCENE_ELEMENT)) n.order = PHYSICS_SCENE;
+		n.order = GetLibraryOrder((const char*) child->name);
+		if (n.order != UNKNOWN)
+		{
+			// This is a library: bucket it below.
+		}
 		else if (IsEquivalent(child->name, DAE_ASSET_ELEMENT)) 
 		{
 			// Read in the asset information
@@ -644,7 +861,7 @@ bool FArchiveXML::Import(FCDocument* theDocument, xmlNode* colladaNode)
 
 					// Insert the library node at the correct place in the ordered list.
 					xmlOrderedNodeList::iterator orderedNode;
-					for (orderedNode = orderedLibraryNodes.begin(); orderedNode != orderedLibraryNodes.end(); ++it)
+					for (orderedNode = orderedLibraryNodes.begin(); orderedNode != orderedLibraryNodes.end(); ++orderedNode)
 					{
 						if (static_cast<uint32> (n.order) < static_cast<uint32>( (*orderedNode).order))
 							break;
@@ -667,68 +884,20 @@ bool FArchiveXML::Import(FCDocument* theDocument, xmlNode* colladaNode)
 		if (FCollada::CancelLoading()) return false;
 
 		xmlOrderedNode& n = orderedLibraryNodes[i];
-		switch (n.order)
-		{
-		case ANIMATION: status &= (FArchiveXML::LoadAnimationLibrary(theDocument->GetAnimationLibrary(), n.node)); break;
-		case ANIMATION_CLIP: status &= (FArchiveXML::LoadAnimationClipLibrary(theDocument->GetAnimationClipLibrary(), n.node)); break;
-		case CAMERA: status &= (FArchiveXML::LoadCameraLibrary(theDocument->GetCameraLibrary(), n.node)); break;
-		case CONTROLLER: status &= (FArchiveXML::LoadControllerLibrary(theDocument->GetControllerLibrary(), n.node)); break;
-		case EFFECT: status &= (FArchiveXML::LoadEffectLibrary(theDocument->GetEffectLibrary(), n.node)); break;
-		case EMITTER: status &= (FArchiveXML::LoadEmitterLibrary(theDocument->GetEmitterLibrary(), n.node)); break;
-		case FORCE_FIELD: status &= (FArchiveXML::LoadForceFieldLibrary(theDocument->GetForceFieldLibrary(), n.node)); break;
-		case GEOMETRY: status &= (FArchiveXML::LoadGeometryLibrary(theDocument->GetGeometryLibrary(), n.node)); break;
-		case IMAGE: status &= (FArchiveXML::LoadImageLibrary(theDocument->GetImageLibrary(), n.node)); break;
-		case LIGHT: status &= (FArchiveXML::LoadLightLibrary(theDocument->GetLightLibrary(), n.node)); break;
-		case MATERIAL: status &= (FArchiveXML::LoadMaterialLibrary(theDocument->GetMaterialLibrary(), n.node)); break;
-		case PHYSICS_MODEL: 
-			{
-				status &= (FArchiveXML::LoadPhysicsModelLibrary(theDocument->GetPhysicsModelLibrary(), n.node)); 
-				size_t physicsModelCount = theDocument->GetPhysicsModelLibrary()->GetEntityCount();
-				for (size_t physicsModelCounter = 0; physicsModelCounter < physicsModelCount; physicsModelCounter++)
-				{
-					FCDPhysicsModel* model = theDocument->GetPhysicsModelLibrary()->GetEntity(physicsModelCounter);
-					status &= FArchiveXML::AttachModelInstancesFCDPhysicsModel(model);
-				}
-				break;
-			}
-		case PHYSICS_MATERIAL: status &= (FArchiveXML::LoadPhysicsMaterialLibrary(theDocument->GetPhysicsMaterialLibrary(), n.node)); break;
-		case PHYSICS_SCENE: status &= (FArchiveXML::LoadPhysicsSceneLibrary(theDocument->GetPhysicsSceneLibrary(), n.node)); break;
-		case VISUAL_SCENE: status &= (FArchiveXML::LoadVisualSceneNodeLibrary(theDocument->GetVisualSceneLibrary(), n.node)); break;
-		case UNKNOWN: default: break;
-		}
+		status &= LoadOrderedLibrary(theDocument, n.order, n.node);
 	}
 
 	// Read in the <scene> element
 	if (sceneNode != nullptr)
 	{
-		bool oneVisualSceneInstanceFound = false;
-		for (xmlNode* child = sceneNode->children; child != nullptr; child = child->next)
-		{
-			if (child->type != XML_ELEMENT_NODE) continue;
-			bool isVisualSceneInstance = IsEquivalent(child->name, DAE_INSTANCE_VSCENE_ELEMENT) && !oneVisualSceneInstanceFound;
-			bool isPhysicsSceneInstance = IsEquivalent(child->name, DAE_INSTANCE_PHYSICS_SCENE_ELEMENT);
-			if (!isVisualSceneInstance && !isPhysicsSceneInstance)
-			{
-				FUError::Error(FUError::WARNING_LEVEL, FUError::ERROR_INVALID_ELEMENT, child->line);
-				continue;
-			}
-
-			FUUri instanceUri = ReadNodeUrl(child);
-			if (instanceUri.GetFragment().empty())
-			{
-				FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_INVALID_URI, child->line);
-			}
-			else
-			{
-				FCDEntityReference* reference = (isVisualSceneInstance) ? theDocument->GetVisualSceneInstanceReference() : theDocument->AddPhysicsSceneInstanceReference();
-				reference->SetUri(instanceUri);
-				if (reference->IsLocal() && reference->GetEntity() == nullptr)
-				{
-					FUError::Error(FUError::WARNING_LEVEL, FUError::WARNING_MISSING_URI_TARGET, child->line);
-				}
-			}
-		}
+		status &= LoadSceneInstances(theDocument, sceneNode);
 	}
+	return status;
+}
+
+bool FArchiveXML::LinkImportedDocument(FCDocument* theDocument)
+{
+	bool status = true;
 
 	// Link the effect surface parameters with the images
 	for (size_t i = 0; i < theDocument->GetMaterialLibrary()->GetEntityCount(); ++i)
@@ -762,7 +931,7 @@ bool FArchiveXML::Import(FCDocument* theDocument, xmlNode* colladaNode)
 	for (size_t i = 0; i < cameraCount; ++i)
 	{
 		FCDCamera* camera = theDocument->GetCameraLibrary()->GetEntity(i);
-		FCDTargetedEntityDataMap::iterator it = FArchiveXML::documentLinkDataMap[theDocument].targetedEntityDataMap.find(camera);
+		FCDTargetedEntityDataMap::iterator it = FArchiveXML::GetDocumentLinkData(theDocument).targetedEntityDataMap.find(camera);
 		if (!it->second.targetId.empty())
 		{
 			status &= (FArchiveXML::LinkTargetedEntity(camera));
@@ -772,7 +941,7 @@ bool FArchiveXML::Import(FCDocument* theDocument, xmlNode* colladaNode)
 	for (size_t i = 0; i < lightCount; ++i)
 	{
 		FCDLight* light = theDocument->GetLightLibrary()->GetEntity(i);
-		FCDTargetedEntityDataMap::iterator it = FArchiveXML::documentLinkDataMap[theDocument].targetedEntityDataMap.find(light);
+		FCDTargetedEntityDataMap::iterator it = FArchiveXML::GetDocumentLinkData(theDocument).targetedEntityDataMap.find(light);
 		if (!it->second.targetId.empty())
 		{
 			status &= (FArchiveXML::LinkTargetedEntity(light));
@@ -796,18 +965,280 @@ bool FArchiveXML::Import(FCDocument* theDocument, xmlNode* colladaNode)
 		//FCDExternalReferenceManager::RegisterLoadedDocument(theDocument);
 	}
 
-	--FArchiveXML::loadedDocumentCount;
 	return status;
 }
 
+//
+// Streaming import
+//
+
+// Loads the libraries read from a FUXmlReader in the same order as the ordered libraries of
+// the DOM import: a library is loaded, one entity at a time, as soon as the asset and all the
+// libraries that come before it in the loading order are loaded. Otherwise, the library is
+// skipped without building its xml nodes, and it is loaded by a later reading pass of the
+// document. Each pass loads at least the libraries that come first in the loading order, so
+// that the number of passes is bounded by the number of library types.
+class FAXStreamedLibraryLoader
+{
+private:
+	FCDocument* document;
+	FUXmlReader& reader;
+	size_t pendingLibraryCounts[UNKNOWN];
+	bool isAssetPending;
+	BooleanList loadedLibraries; // Indexed on the position of the library in the document.
+	size_t libraryIndex;
+	bool isOrderSkipped[UNKNOWN];
+	size_t loadedLibraryCount;
+	bool forceLoading;
+
+public:
+	bool status;
+
+	FAXStreamedLibraryLoader(FCDocument* _document, FUXmlReader& _reader)
+	:	document(_document), reader(_reader)
+	,	isAssetPending(false), libraryIndex(0), loadedLibraryCount(0), forceLoading(false), status(true)
+	{
+		for (size_t i = 0; i < UNKNOWN; ++i) { pendingLibraryCounts[i] = 0; isOrderSkipped[i] = false; }
+	}
+
+	void AddPendingLibrary(nodeOrder order) { ++pendingLibraryCounts[order]; loadedLibraries.push_back(false); }
+	void SetAssetPending(bool pending) { isAssetPending = pending; }
+
+	// Starts a new reading pass of the document. If the previous pass could not load any
+	// library, which only happens with malformed documents, force the loading of the libraries left.
+	void StartPass()
+	{
+		forceLoading = libraryIndex > 0 && loadedLibraryCount == 0;
+		libraryIndex = 0;
+		loadedLibraryCount = 0;
+		for (size_t i = 0; i < UNKNOWN; ++i) isOrderSkipped[i] = false;
+	}
+
+	// Retrieves whether the reading pass has gone past all the libraries left to load.
+	bool IsPassDone() const
+	{
+		for (size_t i = libraryIndex; i < loadedLibraries.size(); ++i)
+		{
+			if (!loadedLibraries[i]) return false;
+		}
+		return true;
+	}
+
+	// Retrieves whether all the libraries of the document are loaded.
+	bool IsDone() const
+	{
+		for (size_t i = 0; i < UNKNOWN; ++i)
+		{
+			if (pendingLibraryCounts[i] > 0) return false;
+		}
+		return true;
+	}
+
+	// Loads, or skips until a later pass, the library element that the reader currently sits on.
+	void LoadLibrary(nodeOrder order, int depth)
+	{
+		size_t index = libraryIndex++;
+		if (index >= loadedLibraries.size() || loadedLibraries[index]) return;
 
-bool FArchiveXML::ExportDocument(FCDocument* theDocument, xmlNode* colladaNode)
+		// The libraries of the same type are loaded in the document order.
+		bool isReady = forceLoading || (!isAssetPending && !isOrderSkipped[order] && IsOrderLoaded(order));
+		if (isReady)
+		{
+			status &= StreamLibrary(order, depth);
+			--pendingLibraryCounts[order];
+			loadedLibraries[index] = true;
+			++loadedLibraryCount;
+		}
+		else
+		{
+			isOrderSkipped[order] = true;
+		}
+	}
+
+private:
+	bool IsOrderLoaded(nodeOrder order)
+	{
+		for (size_t i = 0; i < (size_t) order; ++i)
+		{
+			if (pendingLibraryCounts[i] > 0) return false;
+		}
+		return true;
+	}
+
+	bool StreamLibrary(nodeOrder order, int depth)
+	{
+		XMLLoadFunc loadLibrary, loadEntry;
+		FCDObject* library = GetOrderedLibrary(document, order, loadLibrary, loadEntry);
+		if (library == nullptr) return true;
+
+		if (order == PHYSICS_MODEL)
+		{
+			// The physics model instances are attached once the whole library is loaded,
+			// so their xml nodes must remain available until then.
+			xmlNode* libraryNode = reader.Expand();
+			return (libraryNode != nullptr) ? LoadOrderedLibrary(document, order, libraryNode) : false;
+		}
+
+		bool libraryStatus = true;
+		while (reader.ReadElement(depth + 1))
+		{
+			xmlNode* entryNode = reader.Expand();
+			if (entryNode == nullptr) return false;
+			libraryStatus &= (*loadEntry)(library, entryNode);
+
+			if (FCollada::CancelLoading()) return false;
+		}
+
+		library->SetDirtyFlag();
+		return libraryStatus;
+	}
+};
+
+// Reads the libraries listed in the <extra> element of the document, for the emitters.
+static void LoadStreamedExtraLibraries(FAXStreamedLibraryLoader& loader, FUXmlReader& reader)
+{
+	while (reader.ReadElement(2))
+	{
+		if (!IsEquivalent(reader.GetElementName(), DAE_TECHNIQUE_ELEMENT)) continue;
+		while (reader.ReadElement(3))
+		{
+			if (IsEquivalent(reader.GetElementName(), DAE_LIBRARY_EMITTER_ELEMENT)) loader.LoadLibrary(EMITTER, 3);
+		}
+	}
+}
+
+bool FArchiveXML::ImportStreamed(FCDocument* theDocument, FUXmlReader& reader)
+{
+	if (FArchiveXML::GetImportContext().loadedDocumentCount == 0)
+		FArchiveXML::ClearIntermediateData();
+	++FArchiveXML::GetImportContext().loadedDocumentCount;
+
+	// The only root node supported is "COLLADA"
+	if (!reader.ReadElement(0) || !IsEquivalent(reader.GetElementName(), DAE_COLLADA_ELEMENT))
+	{
+		FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_INVALID_ELEMENT, reader.GetLineNumber());
+		--FArchiveXML::GetImportContext().loadedDocumentCount;
+		return false;
+	}
+
+	fm::string strVersion = reader.ReadAttribute(DAE_VERSION_ATTRIBUTE);
+	theDocument->GetVersion().ParseVersionNumbers(strVersion);
+
+	// First pass: count the libraries, without building their xml nodes,
+	// so that we can read them in our specific order.
+	FAXStreamedLibraryLoader loader(theDocument, reader);
+	while (reader.ReadElement(1))
+	{
+		const char* name = reader.GetElementName();
+		nodeOrder order = GetLibraryOrder(name);
+		if (order != UNKNOWN) loader.AddPendingLibrary(order);
+		else if (IsEquivalent(name, DAE_ASSET_ELEMENT)) loader.SetAssetPending(true);
+		else if (IsEquivalent(name, DAE_EXTRA_ELEMENT) && IsEquivalent(reader.ReadAttribute(DAE_TYPE_ATTRIBUTE), DAEFC_LIBRARIES_TYPE))
+		{
+			// Look in the <extra> element for libaries
+			while (reader.ReadElement(2))
+			{
+				if (!IsEquivalent(reader.GetElementName(), DAE_TECHNIQUE_ELEMENT)) continue;
+				while (reader.ReadElement(3))
+				{
+					if (IsEquivalent(reader.GetElementName(), DAE_LIBRARY_EMITTER_ELEMENT)) loader.AddPendingLibrary(EMITTER);
+				}
+			}
+		}
+	}
+
+	// Following passes: load the elements in the order they are read. The elements other than
+	// the libraries are all read on the first of these passes.
+	xmlNode* sceneNode = nullptr;
+	bool isFirstPass = true;
+	do
+	{
+		if (reader.HasFailed() || !reader.Rewind() || !reader.ReadElement(0))
+		{
+			FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_MALFORMED_XML);
+			loader.status = false;
+			break;
+		}
+
+		loader.StartPass();
+		while (reader.ReadElement(1))
+		{
+			if (FCollada::CancelLoading())
+			{
+				if (sceneNode != nullptr) xmlFreeNode(sceneNode);
+				return false;
+			}
+
+			// Stop reading once the libraries left to load are all read.
+			if (!isFirstPass && loader.IsPassDone()) break;
+
+			const char* name = reader.GetElementName();
+			nodeOrder order = GetLibraryOrder(name);
+			if (order != UNKNOWN)
+			{
+				loader.LoadLibrary(order, 1);
+			}
+			else if (IsEquivalent(name, DAE_EXTRA_ELEMENT) && IsEquivalent(reader.ReadAttribute(DAE_TYPE_ATTRIBUTE), DAEFC_LIBRARIES_TYPE))
+			{
+				LoadStreamedExtraLibraries(loader, reader);
+			}
+			else if (!isFirstPass) continue;
+			else if (IsEquivalent(name, DAE_ASSET_ELEMENT))
+			{
+				// Read in the asset information
+				xmlNode* assetNode = reader.Expand();
+				if (assetNode != nullptr) loader.status &= (FArchiveXML::LoadAsset(theDocument->GetAsset(), assetNode));
+				loader.SetAssetPending(false);
+			}
+			else if (IsEquivalent(name, DAE_SCENE_ELEMENT))
+			{
+				// The <scene> element is processed once all the libraries are loaded
+				xmlNode* node = reader.Expand();
+				if (node != nullptr && sceneNode == nullptr) sceneNode = xmlCopyNode(node, 1);
+			}
+			else if (IsEquivalent(name, DAE_EXTRA_ELEMENT))
+			{
+				// Dump this extra in the document's extra.
+				xmlNode* extraNode = reader.Expand();
+				if (extraNode != nullptr) FArchiveXML::LoadExtra(theDocument->GetExtra(), extraNode);
+			}
+			else
+			{
+				FUError::Error(FUError::WARNING_LEVEL, FUError::WARNING_BASE_NODE_TYPE, reader.GetLineNumber());
+			}
+		}
+		isFirstPass = false;
+	}
+	while (!loader.IsDone());
+
+	bool status = loader.status;
+	if (reader.HasFailed())
+	{
+		FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_MALFORMED_XML);
+		status = false;
+	}
+
+	// Read in the <scene> element
+	if (sceneNode != nullptr)
+	{
+		status &= LoadSceneInstances(theDocument, sceneNode);
+		xmlFreeNode(sceneNode);
+	}
+
+	status &= FArchiveXML::LinkImportedDocument(theDocument);
+
+	--FArchiveXML::GetImportContext().loadedDocumentCount;
+	return status;
+}
+
+
+bool FArchiveXML::ExportDocument(FCDocument* theDocument, xmlNode* colladaNode, FUXmlStreamWriter* writer)
 {
 	bool status = true;
 
-	if (FArchiveXML::loadedDocumentCount == 0)
+	if (FArchiveXML::GetImportContext().loadedDocumentCount == 0)
 		FArchiveXML::ClearIntermediateData();
-	++FArchiveXML::loadedDocumentCount;
+	++FArchiveXML::GetImportContext().loadedDocumentCount;
 
 	if (colladaNode != nullptr)
 	{
@@ -816,13 +1247,24 @@ bool FArchiveXML::ExportDocument(FCDocument* theDocument, xmlNode* colladaNode)
 		AddAttribute(colladaNode, DAE_VERSION_ATTRIBUTE, DAE_SCHEMA_VERSION);
 
 		// Write out the asset tag
+		if (writer != nullptr) writer->StartElement(colladaNode);
 		FArchiveXML::LetWriteObject(theDocument->GetAsset(), colladaNode);
+		if (writer != nullptr) writer->WriteChildren(colladaNode);
 
 		// Record the animation library. This library is built at the end, but should appear before the <scene> element.
+		// When streaming, the other libraries are written out to a temporary file until the animation library is written out.
 		xmlNode* animationLibraryNode = nullptr;
-		if (!theDocument->GetAnimationLibrary()->IsEmpty())
+		bool hasAnimationLibrary = !theDocument->GetAnimationLibrary()->IsEmpty();
+		if (hasAnimationLibrary)
 		{
-			animationLibraryNode = AddChild(colladaNode, DAE_LIBRARY_ANIMATION_ELEMENT);
+			if (writer == nullptr) animationLibraryNode = AddChild(colladaNode, DAE_LIBRARY_ANIMATION_ELEMENT);
+			else if (!writer->StartDeferredOutput())
+			{
+				// Without the temporary file, the animation library cannot keep its place.
+				FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_WRITE_FILE);
+				--FArchiveXML::GetImportContext().loadedDocumentCount;
+				return false;
+			}
 		}
 
 		// clean up the sub ids
@@ -840,7 +1282,7 @@ bool FArchiveXML::ExportDocument(FCDocument* theDocument, xmlNode* colladaNode)
 		// Export the libraries
 #define EXPORT_LIBRARY(memberName, daeElementName) if (!(memberName)->IsEmpty() || (memberName)->GetExtra()->HasContent()) { \
 	xmlNode* libraryNode = AddChild(colladaNode, daeElementName); \
-	FArchiveXML::WriteLibrary(memberName, libraryNode); }
+	FArchiveXML::WriteLibrary(memberName, libraryNode, writer); }
 
 		EXPORT_LIBRARY(theDocument->GetAnimationClipLibrary(), DAE_LIBRARY_ANIMATION_CLIP_ELEMENT);
 		EXPORT_LIBRARY(theDocument->GetPhysicsMaterialLibrary(), DAE_LIBRARY_PMATERIAL_ELEMENT);
@@ -895,19 +1337,35 @@ bool FArchiveXML::ExportDocument(FCDocument* theDocument, xmlNode* colladaNode)
 			if (!theDocument->GetEmitterLibrary()->GetTransientFlag()) 
 				FArchiveXML::WriteLibrary(theDocument->GetEmitterLibrary(), libraryNode);
 		}
+		if (writer != nullptr) writer->WriteChildren(colladaNode);
 
 		// Write out the animations
-		if (animationLibraryNode != nullptr)
+		if (hasAnimationLibrary)
 		{
+			if (writer != nullptr)
+			{
+				writer->EndDeferredOutput();
+				animationLibraryNode = AddChild(colladaNode, DAE_LIBRARY_ANIMATION_ELEMENT);
+			}
 			if (!theDocument->GetAnimationLibrary()->GetTransientFlag()) 
-				FArchiveXML::WriteLibrary(theDocument->GetAnimationLibrary(), animationLibraryNode);
+				FArchiveXML::WriteLibrary(theDocument->GetAnimationLibrary(), animationLibraryNode, writer);
+			if (writer != nullptr)
+			{
+				writer->WriteChildren(colladaNode);
+				writer->WriteDeferredOutput();
+			}
 		}
 
 		// Write out the document extra.
 		FArchiveXML::WriteExtra(theDocument->GetExtra(), colladaNode);
+		if (writer != nullptr)
+		{
+			writer->WriteChildren(colladaNode);
+			writer->EndElement();
+		}
 	}
 
-	--FArchiveXML::loadedDocumentCount;
+	--FArchiveXML::GetImportContext().loadedDocumentCount;
 
 	return status;
 }
@@ -935,31 +1393,225 @@ bool FArchiveXML::LoadLibrary(FCDObject* object, xmlNode* node)
 	{
 		if (child->type == XML_ELEMENT_NODE)
 		{
-			if (IsEquivalent(child->name, DAE_ASSET_ELEMENT))
-			{
-				// Import the <asset> tag for this library.
-				LoadAsset(library->GetAsset(true), child);
-			}
-			else if (IsEquivalent(child->name, DAE_EXTRA_ELEMENT))
-			{
-				// Import the <extra> tag for this library.
-				LoadExtra(library->GetExtra(), child);
-			}
-			else
-			{
-				// Attempt to import this node as an entity of the library.
-				T* entity = library->AddEntity();
-				status &= (FArchiveXML::LoadSwitch(entity, &entity->GetObjectType(), child));
-			}
+			status &= (FArchiveXML::LoadLibraryEntry<T>(library, child));
+		}
+
+		if (FCollada::CancelLoading()) return false;
+	}
+
+	library->SetDirtyFlag();
+	return status;
+}
+
+// The library entities loaded on the worker threads, with their import contexts.
+struct FAXParallelLoad
+{
+	fm::pvector<FCDObject> entities;
+	fm::pvector<xmlNode> nodes;
+	FAXImportContext* contexts;
+	bool* statuses;
+};
+
+static void LoadParallelEntity(void* userData, size_t index)
+{
+	FAXParallelLoad* load = (FAXParallelLoad*) userData;
+	FAXImportContext* previousContext = currentImportContext;
+	currentImportContext = &load->contexts[index];
+
+	_FTRY
+	{
+		FCDObject* entity = load->entities[index];
+		load->statuses[index] = FArchiveXML::LoadSwitch(entity, &entity->GetObjectType(), load->nodes[index]);
+	}
+	_FCATCH_ALL
+	{
+		FUError::Error(FUError::ERROR_LEVEL, FUError::ERROR_PARSING_FAILED);
+		load->statuses[index] = false;
+	}
+
+	currentImportContext = previousContext;
+}
+
+static void MergeImportContext(FAXImportContext& target, FAXImportContext& source)
+{
+	for (DocumentLinkDataMap::iterator it = source.documentLinkDataMap.begin(); it != source.documentLinkDataMap.end(); ++it)
+	{
+		target.documentLinkDataMap[it->first].Merge(it->second);
+	}
+}
+
+// Lists the ids held by the elements below a node.
+static void ReadChildHierarchyIds(xmlNode* node, StringList& ids)
+{
+	for (xmlNode* child = node->children; child != nullptr; child = child->next)
+	{
+		if (child->type != XML_ELEMENT_NODE) continue;
+		fm::string id = ReadNodeId(child);
+		if (!id.empty()) ids.push_back(id);
+		ReadChildHierarchyIds(child, ids);
+	}
+}
+
+template <class T>
+bool FArchiveXML::LoadLibraryParallel(FCDObject* object, xmlNode* node, bool (*isIndependent)(xmlNode*))
+{
+	FCDLibrary<T>* library = (FCDLibrary<T>*)object;
+	FCDocument* document = library->GetDocument();
+
+	// The ids made unique with a suffix depend on the order in which they are registered.
+	// Count the ids held within the entities: an entity that holds an id also held
+	// elsewhere is loaded serially, so that its ids get the same suffixes on every load.
+	fm::hash_map<fm::string, size_t> idCounts;
+	fm::vector<StringList> childIds;
+	for (xmlNode* child = node->children; child != nullptr; child = child->next)
+	{
+		if (child->type != XML_ELEMENT_NODE) continue;
+		childIds.push_back(StringList());
+		ReadChildHierarchyIds(child, childIds.back());
+		for (StringList::iterator it = childIds.back().begin(); it != childIds.back().end(); ++it) ++idCounts[*it];
+		fm::string id = ReadNodeId(child);
+		if (!id.empty()) ++idCounts[id];
+	}
+
+	// Create all the entities first, so that they keep the document order, and reserve their ids.
+	// The independent entities are loaded on the worker threads, each with its own import context.
+	// The other entities, and the library <asset> and <extra> elements, are loaded once they are done.
+	FAXParallelLoad load;
+	fm::pvector<FCDObject> serialEntities;
+	fm::pvector<xmlNode> serialNodes;
+	size_t childIndex = 0;
+	for (xmlNode* child = node->children; child != nullptr; child = child->next)
+	{
+		if (child->type != XML_ELEMENT_NODE) continue;
+		const StringList& ids = childIds[childIndex++];
+		bool hasSharedIds = false;
+		for (StringList::const_iterator it = ids.begin(); it != ids.end() && !hasSharedIds; ++it)
+		{
+			hasSharedIds = idCounts[*it] > 1 || document->FindDaeId(*it) != nullptr;
+		}
+
+		if (IsEquivalent(child->name, DAE_ASSET_ELEMENT) || IsEquivalent(child->name, DAE_EXTRA_ELEMENT))
+		{
+			serialEntities.push_back(nullptr);
+			serialNodes.push_back(child);
+			continue;
+		}
+
+		T* entity = library->AddEntity();
+		fm::string id = ReadNodeId(child);
+		if (!id.empty()) entity->SetDaeId(id);
+		if (!hasSharedIds && (*isIndependent)(child))
+		{
+			load.entities.push_back(entity);
+			load.nodes.push_back(child);
+		}
+		else
+		{
+			serialEntities.push_back(entity);
+			serialNodes.push_back(child);
+		}
+	}
+
+	bool status = true;
+	size_t entityCount = load.entities.size();
+	if (entityCount > 0)
+	{
+		FUCriticalSection sharedCriticalSection;
+		load.contexts = new FAXImportContext[entityCount];
+		load.statuses = new bool[entityCount];
+		for (size_t i = 0; i < entityCount; ++i)
+		{
+			load.contexts[i].sharedContext = &FArchiveXML::GetImportContext();
+			load.contexts[i].sharedCriticalSection = &sharedCriticalSection;
+			load.contexts[i].reservedIdEntity = load.entities[i];
+			load.statuses[i] = false;
+		}
+
+		GetParallelImportPool()->Run(LoadParallelEntity, &load, entityCount);
+
+		// Merge the intermediate data of the entities, in the document order.
+		for (size_t i = 0; i < entityCount; ++i)
+		{
+			MergeImportContext(FArchiveXML::GetImportContext(), load.contexts[i]);
+			status &= load.statuses[i];
 		}
+		SAFE_DELETE_ARRAY(load.contexts);
+		SAFE_DELETE_ARRAY(load.statuses);
+	}
 
+	for (size_t i = 0; i < serialNodes.size(); ++i)
+	{
 		if (FCollada::CancelLoading()) return false;
+
+		FCDObject* entity = serialEntities[i];
+		if (entity != nullptr)
+		{
+			FAXImportContext& context = FArchiveXML::GetImportContext();
+			context.reservedIdEntity = entity;
+			status &= FArchiveXML::LoadSwitch(entity, &entity->GetObjectType(), serialNodes[i]);
+			context.reservedIdEntity = nullptr;
+		}
+		else status &= FArchiveXML::LoadLibraryEntry<T>(library, serialNodes[i]);
 	}
+	if (FCollada::CancelLoading()) return false;
 
 	library->SetDirtyFlag();
 	return status;
 }
 
+static bool HasHierarchyChildOfType(xmlNode* node, const char* type)
+{
+	for (xmlNode* child = node->children; child != nullptr; child = child->next)
+	{
+		if (child->type != XML_ELEMENT_NODE) continue;
+		if (IsEquivalent(child->name, type) || HasHierarchyChildOfType(child, type)) return true;
+	}
+	return false;
+}
+
+// Whether a library entity may be loaded while other entities of its library are loaded.
+static bool IsEntityIndependent(xmlNode* UNUSED(node))
+{
+	return true;
+}
+
+// The effects that contain <image> elements add them to the image library.
+static bool IsEffectIndependent(xmlNode* node)
+{
+	return !HasHierarchyChildOfType(node, DAE_IMAGE_ELEMENT);
+}
+
+// The <extra> trees of the animations are linked with the animation channels of the library.
+static bool IsAnimationIndependent(xmlNode* node)
+{
+	return !HasHierarchyChildOfType(node, DAE_EXTRA_ELEMENT);
+}
+
+template <class T>
+bool FArchiveXML::LoadLibraryEntry(FCDObject* object, xmlNode* child)
+{
+	FCDLibrary<T>* library = (FCDLibrary<T>*)object;
+
+	if (IsEquivalent(child->name, DAE_ASSET_ELEMENT))
+	{
+		// Import the <asset> tag for this library.
+		LoadAsset(library->GetAsset(true), child);
+		return true;
+	}
+	else if (IsEquivalent(child->name, DAE_EXTRA_ELEMENT))
+	{
+		// Import the <extra> tag for this library.
+		LoadExtra(library->GetExtra(), child);
+		return true;
+	}
+	else
+	{
+		// Attempt to import this node as an entity of the library.
+		T* entity = library->AddEntity();
+		return FArchiveXML::LoadSwitch(entity, &entity->GetObjectType(), child);
+	}
+}
+
 xmlNode* FArchiveXML::WriteSwitch(FCDObject* object, const FUObjectType* objectType, xmlNode* node)
 {
 	XMLWriteFuncMap::iterator it = FArchiveXML::xmlWriteFuncs.find(objectType);
@@ -988,6 +1640,7 @@ xmlNode* FArchiveXML::WriteParentSwitch(FCDObject* object, const FUObjectType* o
 
 bool FArchiveXML::LoadAnimationLibrary(FCDObject* object, xmlNode* node)
 { 
+	if (FCollada::GetParallelImportFlag()) return FArchiveXML::LoadLibraryParallel<FCDAnimation>(object, node, IsAnimationIndependent);
 	return FArchiveXML::LoadLibrary<FCDAnimation>(object, node);
 }
 
@@ -1008,6 +1661,7 @@ bool FArchiveXML::LoadControllerLibrary(FCDObject* object, xmlNode* node)
 
 bool FArchiveXML::LoadEffectLibrary(FCDObject* object, xmlNode* node)
 { 
+	if (FCollada::GetParallelImportFlag()) return FArchiveXML::LoadLibraryParallel<FCDEffect>(object, node, IsEffectIndependent);
 	return FArchiveXML::LoadLibrary<FCDEffect>(object, node);
 }
 
@@ -1023,11 +1677,13 @@ bool FArchiveXML::LoadForceFieldLibrary(FCDObject* object, xmlNode* node)
 
 bool FArchiveXML::LoadGeometryLibrary(FCDObject* object, xmlNode* node)
 {
+	if (FCollada::GetParallelImportFlag()) return FArchiveXML::LoadLibraryParallel<FCDGeometry>(object, node, IsEntityIndependent);
 	return FArchiveXML::LoadLibrary<FCDGeometry>(object, node);
 }
 
 bool FArchiveXML::LoadImageLibrary(FCDObject* object, xmlNode* node)
 {
+	if (FCollada::GetParallelImportFlag()) return FArchiveXML::LoadLibraryParallel<FCDImage>(object, node, IsEntityIndependent);
 	return FArchiveXML::LoadLibrary<FCDImage>(object, node);
 }
 
@@ -1062,21 +1718,36 @@ bool FArchiveXML::LoadPhysicsSceneLibrary(FCDObject* object, xmlNode* node)
 }
 
 template <class T>
-xmlNode* FArchiveXML::WriteLibrary(FCDLibrary<T>* library, xmlNode* node)
+xmlNode* FArchiveXML::WriteLibrary(FCDLibrary<T>* library, xmlNode* node, FUXmlStreamWriter* writer)
 {
+	// When streaming, the xml nodes of each entity are written out and released as soon as they are built.
+	if (writer != nullptr) writer->StartElement(node);
+
 	// If present, write out the <asset>.
 	FCDAsset* asset = library->GetAsset(false);
 	if (asset != nullptr) WriteAsset(asset, node);
+	if (writer != nullptr) writer->WriteChildren(node);
 
 	// Write out all the entities.
 	for (size_t i = 0; i < library->GetEntityCount(); ++i)
 	{
 		T* entity = (T*)library->GetEntity(i);
 		FArchiveXML::LetWriteObject(entity, node);
+		if (writer != nullptr) writer->WriteChildren(node);
 	}
 
 	// Write out the extra tree.
 	FArchiveXML::LetWriteObject(library->GetExtra(), node);
+	if (writer != nullptr)
+	{
+		writer->WriteChildren(node);
+		writer->EndElement();
+
+		// The library element is complete: release its xml node.
+		xmlUnlinkNode(node);
+		xmlFreeNode(node);
+		return nullptr;
+	}
 	return node;
 }
 
@@ -1088,7 +1759,7 @@ xmlNode* FArchiveXML::WriteLibrary(FCDLibrary<T>* library, xmlNode* node)
 
 extern "C"
 {
-	PLUGIN_EXPORT uint32 GetPluginCount() { return 1; }
-	PLUGIN_EXPORT const FUObjectType* GetPluginType(uint32) { return &FArchiveXML::GetClassType(); }
-	PLUGIN_EXPORT FUPlugin* CreatePlugin(uint32) { return new FArchiveXML(); }
+	PLUGIN_EXPORT uint32 GetPluginCount() { return 2; }
+	PLUGIN_EXPORT const FUObjectType* GetPluginType(uint32 index) { return (index == 0) ? &FArchiveXML::GetClassType() : &FArchiveBinary::GetClassType(); }
+	PLUGIN_EXPORT FUPlugin* CreatePlugin(uint32 index) { return (index == 0) ? (FUPlugin*) new FArchiveXML() : (FUPlugin*) new FArchiveBinary(); }
 }
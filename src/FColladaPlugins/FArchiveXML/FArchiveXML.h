@@ -10,6 +10,8 @@
 #define _FCPARCHIVECOLLADA_H_
 
 class FCDParameterAnimatable;
+class FUXmlReader;
+class FUXmlStreamWriter;
 
 #ifndef _FAXSTRUCTURES_H_
 #include "FAXStructures.h"
@@ -48,12 +50,6 @@ private:
 	// 
 	static XMLWriteFuncMap xmlWriteFuncs;
 
-	//
-	// Link data used in 2nd passing of loading.
-	//
-	static DocumentLinkDataMap documentLinkDataMap;
-	static int loadedDocumentCount;
-
 	//
 	// Extra extension registration
 	// These are useful when the DAE files are encapsulated within some
@@ -108,6 +104,44 @@ public:
 	*/
 	static void ClearIntermediateData();
 
+	/**
+		Retrieves the intermediate data of the import or export running on the calling thread.
+		Outside of ImportFile, ImportFileFromMemory and ExportFile, a per-thread
+		context is used, which is kept between the partial import/export calls.
+		@return The current import context.
+	*/
+	static FAXImportContext& GetImportContext();
+
+	/**
+		Makes an import context current on the calling thread.
+		See FAXImportContextScope.
+		@param context The import context. nullptr to use the per-thread context.
+		@return The import context that was current.
+	*/
+	static FAXImportContext* SetImportContext(FAXImportContext* context);
+
+	/**
+		Retrieves the link data of a document, for the current import context.
+		@param document The document.
+		@return The link data used in the 2nd pass of the loading/writing process.
+	*/
+	static FCDocumentLinkData& GetDocumentLinkData(const FCDocument* document) { return GetImportContext().documentLinkDataMap[document]; }
+
+	/**
+		Makes the shared import context current, when called while a library entity
+		is loaded in parallel. Used to link the animations, which are listed only in
+		the shared import context. Calls are serialized across the worker threads.
+		@return The import context of the library entity, to give back to
+			LeaveSharedImportContext. nullptr if the entity is not loaded in parallel.
+	*/
+	static FAXImportContext* EnterSharedImportContext();
+
+	/**
+		Restores the import context of a library entity loaded in parallel.
+		@param entityContext The import context returned by EnterSharedImportContext.
+	*/
+	static void LeaveSharedImportContext(FAXImportContext* entityContext);
+
 	/** 
 		Imports the parsed xml data into the FCDocument.
 		@param theDocument the FCDocument to be filled with imported data.
@@ -116,13 +150,42 @@ public:
 	*/
 	bool Import(FCDocument* theDocument, xmlNode* colladaNode);
 
+	/**
+		Loads the libraries and the scene instances of the parsed xml data into the FCDocument.
+		This is the 1st pass of the loading process: the entities are not linked together.
+		@param theDocument the FCDocument to be filled with imported data.
+		@param colladaNode the xmlNode containing the parsed data.
+		@return 'true' if the operation is successful.
+	*/
+	static bool ImportLibraries(FCDocument* theDocument, xmlNode* colladaNode);
+
+	/** 
+		Imports the xml data, read one element at a time, into the FCDocument.
+		The whole xml tree is never built: only the xml nodes for one library
+		entity are kept in memory at any given time.
+		@param theDocument the FCDocument to be filled with imported data.
+		@param reader the xml reader opened on the COLLADA document.
+		@return 'true' if the operation is successful.
+	*/
+	bool ImportStreamed(FCDocument* theDocument, FUXmlReader& reader);
+
+	/**
+		Links the entities of a newly imported FCDocument together.
+		This is the 2nd pass of the loading process, done once all the libraries are loaded.
+		@param theDocument the FCDocument that was just imported.
+		@return 'true' if the operation is successful.
+	*/
+	static bool LinkImportedDocument(FCDocument* theDocument);
+
 	/**
 		Export the existing FCOLLADA document to the given xml node.
 		@param theDocument. The FCOLLADA document to be exported.
 		@param colladaNode. The root of the xml tree to be filled with the document content.
+		@param writer. When given, the xml tree is written out through this xml writer
+			one library entity at a time, and the written xml nodes are released.
 		@return true if the document is exported correctly.
 	*/
-	bool ExportDocument(FCDocument* theDocument, xmlNode* colladaNode);
+	bool ExportDocument(FCDocument* theDocument, xmlNode* colladaNode, FUXmlStreamWriter* writer = nullptr);
 
 	/**
 		Takes care of calling the right function to load the FCDObject
@@ -322,6 +385,8 @@ public:
 	// Library related functions
 	//
 	template <class T> static bool LoadLibrary(FCDObject* object, xmlNode* node);
+	template <class T> static bool LoadLibraryParallel(FCDObject* object, xmlNode* node, bool (*isIndependent)(xmlNode*));
+	template <class T> static bool LoadLibraryEntry(FCDObject* object, xmlNode* node);
 	static bool LoadAnimationLibrary(FCDObject* object, xmlNode* node);
 	static bool LoadAnimationClipLibrary(FCDObject* object, xmlNode* node);
 	static bool LoadCameraLibrary(FCDObject* object, xmlNode* node);
@@ -353,7 +418,6 @@ public:
 	static xmlNode* FindChildByIdFCDAnimation(FCDAnimation* animation, const fm::string& _id);
 
 	static void FindAnimationChannels(FCDocument* fcdocument, const fm::string& pointer, FCDAnimationChannelList& channels);
-	static void FindAnimationChannels(FCDAnimation* animation, const fm::string& pointer, FCDAnimationChannelList& targetChannels);
 
 	static FCDAnimatedCustom* CreateFCDAnimatedCustom(FCDObject* document, xmlNode* node);
 
@@ -362,7 +426,6 @@ public:
 	// Linking functions used in the 2nd pass.
 	//
 	static bool LinkDriver(FCDocument* fcdoument, FCDAnimated* animated, const fm::string& animatedTargetPointer);
-	static bool LinkDriver(FCDAnimation* animation, FCDAnimated* animated, const fm::string& animatedTargetPointer);
 	static bool LinkDriver(FCDAnimationChannel* animationChannel, FCDAnimated* animated, const fm::string& animatedTargetPointer);
 	static bool LinkAnimated(FCDAnimated* animated, xmlNode* node);
 	static bool LinkAnimatedCustom(FCDAnimatedCustom* animatedCustom, xmlNode* node);
@@ -570,7 +633,36 @@ public:
 	// Library related functions
 	//
 	template <class T>
-	static xmlNode* WriteLibrary(FCDLibrary<T>* library, xmlNode* node);
+	static xmlNode* WriteLibrary(FCDLibrary<T>* library, xmlNode* node, FUXmlStreamWriter* writer = nullptr);
+};
+
+/**
+	Makes a new import context current for the lifetime of this object.
+	Each file import or export runs within its own import context.
+*/
+class FAXImportContextScope
+{
+private:
+	FAXImportContext context;
+	FAXImportContext* previousContext;
+
+public:
+	FAXImportContextScope() : previousContext(FArchiveXML::SetImportContext(&context)) {}
+	~FAXImportContextScope() { FArchiveXML::SetImportContext(previousContext); }
+};
+
+/**
+	Makes the shared import context current for the lifetime of this object.
+	See FArchiveXML::EnterSharedImportContext.
+*/
+class FAXSharedImportContextScope
+{
+private:
+	FAXImportContext* entityContext;
+
+public:
+	FAXSharedImportContextScope() : entityContext(FArchiveXML::EnterSharedImportContext()) {}
+	~FAXSharedImportContextScope() { FArchiveXML::LeaveSharedImportContext(entityContext); }
 };
 
 #endif //_FCPARCHIVECOLLADA_H_
@@ -0,0 +1,208 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Animation playback benchmark: plays back a scene of 25,000 nodes, each
+	with an animated translation and an animated rotation angle, for 100,000
+	animation channels in all. The curves have one key every third of a second,
+	half of them with linear keys and half of them with Bezier keys. Ten seconds
+	are played back at 30 frames per second, by evaluating each FCDAnimated
+	in turn, as FCDocument::SetCurrentTime formerly did, and through the
+	animation program of the document, on the calling thread and in parallel.
+	The frame times are given, along with the parallel scaling.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDAnimated.h"
+#include "FCDocument/FCDAnimation.h"
+#include "FCDocument/FCDAnimationChannel.h"
+#include "FCDocument/FCDAnimationCurve.h"
+#include "FCDocument/FCDAnimationKey.h"
+#include "FCDocument/FCDLibrary.h"
+#include "FCDocument/FCDSceneNode.h"
+#include "FCDocument/FCDTransform.h"
+#include "FUtils/FUThreadPool.h"
+#include <cstdio>
+
+static const size_t animatedNodeCount = 25000;
+static const size_t nodeGroupSize = 250;
+static const float playbackDuration = 10.0f;
+static const float playbackFrameRate = 30.0f;
+static const float playbackKeyInterval = 1.0f / 3.0f;
+
+struct AnimationData
+{
+	FCDocument* document;
+	fm::pvector<FCDAnimated> animateds;
+	FloatList values;
+	size_t channelCount;
+	size_t frameCount;
+};
+
+static FCDAnimationCurve* AddPlaybackCurve(FCDAnimation* animation, size_t index)
+{
+	// Alternate the linear and the Bezier curves.
+	FCDAnimationCurve* curve = animation->AddChannel()->AddCurve();
+	bool isBezier = (index & 1) != 0;
+	size_t keyCount = (size_t) (playbackDuration / playbackKeyInterval) + 1;
+	curve->ReserveKeys(keyCount, isBezier ? FUDaeInterpolation::BEZIER : FUDaeInterpolation::LINEAR);
+	for (size_t k = 0; k < keyCount; ++k)
+	{
+		float input = (float) k * playbackKeyInterval;
+		FCDAnimationKey* key = curve->AddKey(isBezier ? FUDaeInterpolation::BEZIER : FUDaeInterpolation::LINEAR);
+		key->input = input;
+		key->output = (float) ((index + k * 7) % 101);
+		if (isBezier)
+		{
+			FCDAnimationKeyBezier* bkey = (FCDAnimationKeyBezier*) key;
+			bkey->inTangent = FMVector2(input - playbackKeyInterval / 3.0f, key->output);
+			bkey->outTangent = FMVector2(input + playbackKeyInterval / 3.0f, key->output);
+		}
+	}
+	return curve;
+}
+
+static void BuildAnimatedScene(AnimationData& data)
+{
+	data.document = FCollada::NewTopDocument();
+	FCDSceneNode* visualScene = data.document->AddVisualScene();
+	FCDAnimation* animation = data.document->GetAnimationLibrary()->AddEntity();
+	FCDSceneNode* group = nullptr;
+	data.channelCount = 0;
+	for (size_t i = 0; i < animatedNodeCount; ++i)
+	{
+		if (i % nodeGroupSize == 0) group = visualScene->AddChildNode();
+		FCDSceneNode* node = group->AddChildNode();
+		FCDAnimated* translation = node->AddTransform(FCDTransform::TRANSLATION)->GetAnimated();
+		FCDAnimated* rotation = node->AddTransform(FCDTransform::ROTATION)->GetAnimated();
+		for (size_t d = 0; d < 3; ++d) translation->AddCurve(d, AddPlaybackCurve(animation, data.channelCount++));
+		rotation->AddCurve(3, AddPlaybackCurve(animation, data.channelCount++));
+		data.animateds.push_back(translation);
+		data.animateds.push_back(rotation);
+	}
+	data.frameCount = (size_t) (playbackDuration * playbackFrameRate);
+}
+
+static void ReadValues(AnimationData& data, FloatList& values)
+{
+	values.clear();
+	for (fm::pvector<FCDAnimated>::iterator it = data.animateds.begin(); it != data.animateds.end(); ++it)
+	{
+		for (size_t i = 0; i < (*it)->GetValueCount(); ++i) values.push_back(*(*it)->GetValue(i));
+	}
+}
+
+static bool PlayByAnimated(void* userData)
+{
+	AnimationData* data = (AnimationData*) userData;
+	for (size_t f = 0; f < data->frameCount; ++f)
+	{
+		float time = (float) f / playbackFrameRate;
+		for (fm::pvector<FCDAnimated>::iterator it = data->animateds.begin(); it != data->animateds.end(); ++it)
+		{
+			(*it)->Evaluate(time);
+		}
+	}
+	return true;
+}
+
+static bool PlayByProgram(void* userData)
+{
+	AnimationData* data = (AnimationData*) userData;
+	for (size_t f = 0; f < data->frameCount; ++f)
+	{
+		data->document->SetCurrentTime((float) f / playbackFrameRate);
+	}
+	return true;
+}
+
+static bool PlayByProgramInParallel(void* userData)
+{
+	// The worker threads are created within the child processes only.
+	FCollada::SetParallelAnimationFlag(true);
+	PlayByProgram(userData);
+	FCollada::SetParallelAnimationFlag(false);
+	return true;
+}
+
+// Checks that the parallel playback gives the same values as the evaluation of each animated.
+static bool CheckParallelPlayback(void* userData)
+{
+	AnimationData* data = (AnimationData*) userData;
+	FloatList values;
+	PlayByProgramInParallel(userData);
+	ReadValues(*data, values);
+	PlayByAnimated(userData);
+	ReadValues(*data, data->values);
+	return values == data->values;
+}
+
+// Checks that the animation program gives the same values as the evaluation of each animated.
+static bool CheckPlayback(AnimationData& data)
+{
+	FloatList values;
+	for (float time = 0.0f; time <= playbackDuration; time += 1.7f)
+	{
+		data.document->SetCurrentTime(time);
+		ReadValues(data, values);
+		for (fm::pvector<FCDAnimated>::iterator it = data.animateds.begin(); it != data.animateds.end(); ++it) (*it)->Evaluate(time);
+		ReadValues(data, data.values);
+		if (!(values == data.values)) return false;
+	}
+	return true;
+}
+
+static void PrintFrameTime(const char* variant, const fstring& name, const BenchmarkMeasure& measure, size_t frameCount)
+{
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.3f ms/frame", "animation", variant, TO_STRING(name).c_str(),
+		measure.seconds * 1000.0 / frameCount);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+}
+
+bool BenchmarkAnimation(const FilenameList& UNUSED(filenames), const BenchmarkOptions& options)
+{
+	AnimationData data;
+	BuildAnimatedScene(data);
+	bool status = CheckPlayback(data);
+	if (!status)
+	{
+		std::cout << "animation: the animation program differs from the evaluation of each animated." << std::endl;
+	}
+
+	fstring name = FC("100k-channels-30fps-10s");
+	BenchmarkMeasure checkMeasure, animatedMeasure, serialMeasure, parallelMeasure;
+	if (status && !RunMeasured(CheckParallelPlayback, &data, 1, checkMeasure))
+	{
+		std::cout << "animation: the parallel animation program differs from the evaluation of each animated." << std::endl;
+		status = false;
+	}
+	status &= RunMeasured(PlayByAnimated, &data, options.iterations, animatedMeasure);
+	status &= RunMeasured(PlayByProgram, &data, options.iterations, serialMeasure);
+	status &= RunMeasured(PlayByProgramInParallel, &data, options.iterations, parallelMeasure);
+	SAFE_RELEASE(data.document);
+	if (!status)
+	{
+		std::cout << "animation: could not measure " << TO_STRING(name).c_str() << std::endl;
+		return false;
+	}
+
+	PrintMeasure("animation", "per-animated", name, animatedMeasure);
+	PrintMeasure("animation", "program", name, serialMeasure);
+	PrintMeasure("animation", "parallel", name, parallelMeasure);
+	PrintFrameTime("per-animated", name, animatedMeasure, data.frameCount);
+	PrintFrameTime("program", name, serialMeasure, data.frameCount);
+	PrintFrameTime("parallel", name, parallelMeasure, data.frameCount);
+
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.2f x on %u threads", "animation", "scaling", TO_STRING(name).c_str(),
+		(parallelMeasure.seconds > 0.0) ? serialMeasure.seconds / parallelMeasure.seconds : 0.0, (uint32) FUThreadPool::GetProcessorCount());
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+	return true;
+}
@@ -0,0 +1,137 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Arena benchmark: generates a document with 50,000 named scene nodes, each
+	with a translation, a rotation and a scale, then loads it, along with each
+	document given on the command line, with the objects allocated from the
+	heap and from a document arena. The loading is measured in a child process
+	and the document is left to it. The teardown, the release of the loaded
+	document, is measured on its own, in the benchmark process.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDSceneNode.h"
+#include "FCDocument/FCDTransform.h"
+#include <cstdio>
+
+static const size_t generatedSceneNodeCount = 50000;
+
+struct ArenaData
+{
+	const fstring* filename;
+	bool useArena;
+};
+
+static FCDocument* LoadArenaDocument(const ArenaData& data)
+{
+	FUErrorSimpleHandler errorHandler;
+	FCDocument* document = FCollada::NewTopDocument();
+	document->SetArenaAllocation(data.useArena);
+	if (!FCollada::LoadDocumentFromFile(document, data.filename->c_str()) || !errorHandler.IsSuccessful()) SAFE_RELEASE(document);
+	return document;
+}
+
+// The loaded document is left to the measuring child process.
+static bool LoadDocument(void* userData)
+{
+	return LoadArenaDocument(*(const ArenaData*) userData) != nullptr;
+}
+
+// Measures the average time taken to release the loaded documents.
+static bool MeasureTeardown(const ArenaData& data, uint32 iterations, double& seconds)
+{
+	seconds = 0.0;
+	for (uint32 i = 0; i < iterations; ++i)
+	{
+		FCDocument* document = LoadArenaDocument(data);
+		if (document == nullptr) return false;
+		double start = GetBenchmarkTime();
+		document->Release();
+		seconds += GetBenchmarkTime() - start;
+	}
+	seconds /= (double) max(iterations, 1u);
+	return true;
+}
+
+static bool GenerateDocument(void* userData)
+{
+	const fstring& filename = *(const fstring*) userData;
+	FCDocument* document = FCollada::NewTopDocument();
+	FCDSceneNode* root = document->AddVisualScene();
+	fm::pvector<FCDSceneNode> nodes;
+	nodes.reserve(generatedSceneNodeCount);
+	nodes.push_back(root);
+	for (size_t i = 1; i < generatedSceneNodeCount; ++i)
+	{
+		FCDSceneNode* node = nodes[(i - 1) / 4]->AddChildNode();
+		node->SetName(FC("node"));
+		float f = (float) i;
+		((FCDTTranslation*) node->AddTransform(FCDTransform::TRANSLATION))->SetTranslation(f * 0.01f, 1.0f, -0.5f);
+		((FCDTRotation*) node->AddTransform(FCDTransform::ROTATION))->SetRotation(FMVector3::YAxis, f * 0.1f);
+		((FCDTScale*) node->AddTransform(FCDTransform::SCALE))->SetScale(1.0f, 0.99f, 1.01f);
+		nodes.push_back(node);
+	}
+	bool status = FCollada::SaveDocument(document, filename.c_str());
+	SAFE_RELEASE(document);
+	return status;
+}
+
+static bool MeasureArena(const fstring& filename, const BenchmarkOptions& options)
+{
+	ArenaData data;
+	data.filename = &filename;
+	BenchmarkMeasure heapLoadMeasure, arenaLoadMeasure;
+	double heapTeardown = 0.0, arenaTeardown = 0.0;
+	data.useArena = false;
+	bool status = RunMeasured(LoadDocument, &data, options.iterations, heapLoadMeasure);
+	status &= MeasureTeardown(data, options.iterations, heapTeardown);
+	data.useArena = true;
+	status &= RunMeasured(LoadDocument, &data, options.iterations, arenaLoadMeasure);
+	status &= MeasureTeardown(data, options.iterations, arenaTeardown);
+	if (!status)
+	{
+		std::cout << "arena: could not load " << TO_STRING(filename).c_str() << std::endl;
+		return false;
+	}
+
+	PrintMeasure("arena", "heap-load", filename, heapLoadMeasure);
+	PrintMeasure("arena", "arena-load", filename, arenaLoadMeasure);
+
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %12.3f ms", "arena", "heap-teardown", TO_STRING(filename).c_str(), heapTeardown * 1000.0);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %12.3f ms", "arena", "arena-teardown", TO_STRING(filename).c_str(), arenaTeardown * 1000.0);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+	return true;
+}
+
+bool BenchmarkArena(const FilenameList& filenames, const BenchmarkOptions& options)
+{
+	bool status = true;
+	// Generate the document in a child process, so that its memory does not weigh on the measures.
+	fstring generatedFilename = FC("arena-generated.dae");
+	BenchmarkMeasure generateMeasure;
+	if (RunMeasured(GenerateDocument, &generatedFilename, 1, generateMeasure))
+	{
+		status &= MeasureArena(generatedFilename, options);
+	}
+	else
+	{
+		std::cout << "arena: could not generate " << TO_STRING(generatedFilename).c_str() << std::endl;
+		status = false;
+	}
+	remove(TO_STRING(generatedFilename).c_str());
+
+	for (const fstring* it = filenames.begin(); it != filenames.end(); ++it)
+	{
+		status &= MeasureArena(*it, options);
+	}
+	return status;
+}
@@ -0,0 +1,277 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Animation baking benchmark: builds a 300-bone rig, a chain of joints ten
+	bones deep, where each bone has an animated translation and three animated
+	rotations keyed at 30 frames per second over 20 seconds, as motion capture
+	data is. The local transforms of all the bones are then baked with the
+	former FCDSceneNodeTools::GenerateSampledAnimation implementation, which
+	merges the key times one insertion at a time and searches the curve keys at
+	each sample, with the reentrant GenerateSampledAnimation, one bone after the
+	other, and with GenerateSampledAnimations, which bakes the bones in parallel.
+	The baked animations are checked to be identical beforehand.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDAnimated.h"
+#include "FCDocument/FCDAnimation.h"
+#include "FCDocument/FCDAnimationChannel.h"
+#include "FCDocument/FCDAnimationCurve.h"
+#include "FCDocument/FCDAnimationKey.h"
+#include "FCDocument/FCDLibrary.h"
+#include "FCDocument/FCDSceneNode.h"
+#include "FCDocument/FCDSceneNodeTools.h"
+#include "FCDocument/FCDTransform.h"
+#include "FUtils/FUThreadPool.h"
+#include <cstdio>
+
+static const size_t boneCount = 300;
+static const size_t boneChainLength = 10;
+static const float bakedDuration = 20.0f;
+static const float bakedFrameRate = 30.0f;
+
+struct BakeData
+{
+	FCDocument* document;
+	FCDSceneNode* root;
+	fm::pvector<FCDSceneNode> bones;
+};
+
+static void AddBakedCurve(FCDAnimation* animation, FCDAnimated* animated, size_t valueIndex, size_t curveIndex, float amplitude)
+{
+	FCDAnimationCurve* curve = animation->AddChannel()->AddCurve();
+	size_t keyCount = (size_t) (bakedDuration * bakedFrameRate) + 1;
+	curve->ReserveKeys(keyCount, FUDaeInterpolation::BEZIER);
+	for (size_t k = 0; k < keyCount; ++k)
+	{
+		float input = (float) k / bakedFrameRate;
+		FCDAnimationKeyBezier* key = (FCDAnimationKeyBezier*) curve->AddKey(FUDaeInterpolation::BEZIER);
+		key->input = input;
+		key->output = amplitude * sinf(input * (1.0f + (float) (curveIndex % 7)) * 0.5f);
+		key->inTangent = FMVector2(input - 1.0f / (3.0f * bakedFrameRate), key->output);
+		key->outTangent = FMVector2(input + 1.0f / (3.0f * bakedFrameRate), key->output);
+	}
+	animated->AddCurve(valueIndex, curve);
+}
+
+static void BuildRig(BakeData& data)
+{
+	data.document = FCollada::NewTopDocument();
+	data.root = data.document->AddVisualScene();
+	FCDAnimation* animation = data.document->GetAnimationLibrary()->AddEntity();
+	FCDSceneNode* parent = data.root;
+	size_t curveIndex = 0;
+	for (size_t i = 0; i < boneCount; ++i)
+	{
+		if (i % boneChainLength == 0) parent = data.root;
+		FCDSceneNode* bone = parent->AddChildNode();
+		FCDAnimated* translation = bone->AddTransform(FCDTransform::TRANSLATION)->GetAnimated();
+		for (size_t d = 0; d < 3; ++d) AddBakedCurve(animation, translation, d, curveIndex++, 10.0f);
+		for (size_t r = 0; r < 3; ++r)
+		{
+			FCDTRotation* rotation = (FCDTRotation*) bone->AddTransform(FCDTransform::ROTATION);
+			rotation->SetAxis(FMVector3(r == 0 ? 1.0f : 0.0f, r == 1 ? 1.0f : 0.0f, r == 2 ? 1.0f : 0.0f));
+			AddBakedCurve(animation, rotation->GetAnimated(), 3, curveIndex++, 90.0f);
+		}
+		data.bones.push_back(bone);
+		parent = bone;
+	}
+}
+
+// The former FCDSceneNodeTools::GenerateSampledAnimation implementation.
+static void FormerGenerateSampledAnimation(FCDSceneNode* node, FloatList& sampleKeys, FMMatrix44List& sampleValues)
+{
+	sampleKeys.clear();
+	sampleValues.clear();
+
+	FCDAnimatedList animateds;
+	Int32List angleIndices;
+	size_t transformCount = node->GetTransformCount();
+	for (size_t t = 0; t < transformCount; ++t)
+	{
+		FCDTransform* transform = node->GetTransform(t);
+		FCDAnimated* animated = transform->GetAnimated();
+		if (animated != nullptr)
+		{
+			if (animated->HasCurve()) animateds.push_back(animated);
+			if (!transform->HasType(FCDTRotation::GetClassType())) angleIndices.push_back(-1);
+			else angleIndices.push_back((int32) animated->FindQualifier(".ANGLE"));
+		}
+	}
+	if (animateds.empty()) return;
+
+	size_t animatedsCount = animateds.size();
+	for (size_t i = 0; i < animatedsCount; ++i)
+	{
+		const FCDAnimated* animated = animateds[i];
+		int32 angleIndex = angleIndices[i];
+		const FCDAnimationCurveListList& allCurves = animated->GetCurves();
+		size_t valueCount = allCurves.size();
+		for (size_t curveIndex = 0; curveIndex < valueCount; ++curveIndex)
+		{
+			const FCDAnimationCurveTrackList& curves = allCurves[curveIndex];
+			if (curves.empty()) continue;
+
+			size_t curveKeyCount = curves.front()->GetKeyCount();
+			const FCDAnimationKey** curveKeys = curves.front()->GetKeys();
+			size_t sampleKeyCount = sampleKeys.size();
+			size_t s = 0;
+			size_t c = 0;
+			while (s < sampleKeyCount && c < curveKeyCount)
+			{
+				float sampleKey = sampleKeys[s], curveKey = curveKeys[c]->input;
+				if (IsEquivalent(sampleKey, curveKey)) { ++s; ++c; }
+				else if (sampleKey < curveKey) { ++s; }
+				else
+				{
+					sampleKeys.insert(sampleKeys.begin() + (s++), curveKeys[c++]->input);
+					sampleKeyCount++;
+				}
+			}
+			while (c < curveKeyCount) sampleKeys.push_back(curveKeys[c++]->input);
+
+			if (angleIndex == (intptr_t) curveIndex)
+			{
+				for (size_t f = 1; f < curveKeyCount; ++f)
+				{
+					const FCDAnimationKey* previousKey = curveKeys[f - 1];
+					const FCDAnimationKey* currentKey = curveKeys[f];
+					float halfWrapAmount = (currentKey->output - previousKey->output) / 180.0f;
+					halfWrapAmount *= FMath::Sign(halfWrapAmount);
+					if (halfWrapAmount >= 1.0f)
+					{
+						size_t addSampleCount = (size_t) floorf(halfWrapAmount);
+						for (size_t d = 1; d <= addSampleCount; ++d)
+						{
+							float fd = (float) d;
+							float fid = (float) (addSampleCount + 1 - d);
+							float addSampleTime = (currentKey->input * fd + previousKey->input * fid) / (fd + fid);
+							float* endIt = sampleKeys.end();
+							for (float* sampleKeyTime = sampleKeys.begin(); sampleKeyTime != endIt; ++sampleKeyTime)
+							{
+								if (IsEquivalent(*sampleKeyTime, addSampleTime)) break;
+								else if (*sampleKeyTime > addSampleTime)
+								{
+									sampleKeys.insert(sampleKeyTime, addSampleTime);
+									break;
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	size_t sampleKeyCount = sampleKeys.size();
+	if (sampleKeyCount == 0) return;
+
+	sampleValues.reserve(sampleKeyCount);
+	for (size_t i = 0; i < sampleKeyCount; ++i)
+	{
+		float sampleTime = sampleKeys[i];
+		for (FCDAnimatedList::iterator it = animateds.begin(); it != animateds.end(); ++it)
+		{
+			(*it)->Evaluate(sampleTime);
+		}
+		sampleValues.push_back(node->ToMatrix());
+	}
+}
+
+static bool BakeFormer(void* userData)
+{
+	BakeData* data = (BakeData*) userData;
+	FloatList keys;
+	FMMatrix44List matrices;
+	bool status = true;
+	for (size_t i = 0; i < data->bones.size(); ++i)
+	{
+		FormerGenerateSampledAnimation(data->bones[i], keys, matrices);
+		status &= !matrices.empty();
+	}
+	return status;
+}
+
+static bool BakeSerial(void* userData)
+{
+	BakeData* data = (BakeData*) userData;
+	FloatList keys;
+	FMMatrix44List matrices;
+	bool status = true;
+	for (size_t i = 0; i < data->bones.size(); ++i)
+	{
+		FCDSceneNodeTools::GenerateSampledAnimation(data->bones[i], keys, matrices);
+		status &= !matrices.empty();
+	}
+	return status;
+}
+
+static bool BakeParallel(void* userData)
+{
+	BakeData* data = (BakeData*) userData;
+	FCDSceneNodeSampledAnimationList animations;
+	FCDSceneNodeTools::GenerateSampledAnimations(data->root, animations);
+	return animations.size() == data->bones.size();
+}
+
+// Checks that the reentrant and the parallel baking give the same animations as the former baking.
+static bool CheckBake(BakeData& data)
+{
+	FCDSceneNodeSampledAnimationList animations;
+	FCDSceneNodeTools::GenerateSampledAnimations(data.root, animations);
+	if (animations.size() != data.bones.size()) return false;
+
+	FloatList keys, formerKeys;
+	FMMatrix44List matrices, formerMatrices;
+	for (size_t i = 0; i < animations.size(); ++i)
+	{
+		FCDSceneNode* bone = animations[i].sceneNode;
+		FormerGenerateSampledAnimation(bone, formerKeys, formerMatrices);
+		FCDSceneNodeTools::GenerateSampledAnimation(bone, keys, matrices);
+		if (!(keys == formerKeys) || !(animations[i].keys == formerKeys)) return false;
+		if (matrices.size() != formerMatrices.size() || animations[i].matrices.size() != formerMatrices.size()) return false;
+		for (size_t k = 0; k < formerMatrices.size(); ++k)
+		{
+			if (!(matrices[k] == formerMatrices[k]) || !(animations[i].matrices[k] == formerMatrices[k])) return false;
+		}
+	}
+	return true;
+}
+
+bool BenchmarkBake(const FilenameList& UNUSED(filenames), const BenchmarkOptions& options)
+{
+	BakeData data;
+	BuildRig(data);
+	bool status = CheckBake(data);
+	if (!status)
+	{
+		std::cout << "bake: the reentrant or the parallel baking differs from the former baking." << std::endl;
+	}
+
+	fstring name = FC("300-bones-30fps-20s");
+	BenchmarkMeasure formerMeasure, serialMeasure, parallelMeasure;
+	status &= RunMeasured(BakeFormer, &data, options.iterations, formerMeasure);
+	status &= RunMeasured(BakeSerial, &data, options.iterations, serialMeasure);
+	status &= RunMeasured(BakeParallel, &data, options.iterations, parallelMeasure);
+	SAFE_RELEASE(data.document);
+	if (!status)
+	{
+		std::cout << "bake: could not measure " << TO_STRING(name).c_str() << std::endl;
+		return false;
+	}
+
+	PrintMeasure("bake", "former", name, formerMeasure);
+	PrintMeasure("bake", "serial", name, serialMeasure);
+	PrintMeasure("bake", "parallel", name, parallelMeasure);
+
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.2f x on %u threads", "bake", "speed-up", TO_STRING(name).c_str(),
+		(parallelMeasure.seconds > 0.0) ? formerMeasure.seconds / parallelMeasure.seconds : 0.0, (uint32) FUThreadPool::GetProcessorCount());
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+	return true;
+}
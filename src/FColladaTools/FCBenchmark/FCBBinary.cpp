@@ -0,0 +1,80 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Binary benchmark: saves each document once to a temporary binary archive,
+	then compares the time taken to load the COLLADA document and the binary
+	archive. The throughput is given in megabytes of COLLADA document per second,
+	for both files, so that the two throughputs compare directly.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FUtils/FUFile.h"
+#include <cstdio>
+
+static bool LoadDocument(void* userData)
+{
+	const fstring* filename = (const fstring*) userData;
+	FUErrorSimpleHandler errorHandler;
+	FCDocument* document = FCollada::NewTopDocument();
+	bool status = FCollada::LoadDocumentFromFile(document, filename->c_str());
+	SAFE_RELEASE(document);
+	return status && errorHandler.IsSuccessful();
+}
+
+bool BenchmarkBinary(const FilenameList& filenames, const BenchmarkOptions& options)
+{
+	bool status = true;
+	for (const fstring* it = filenames.begin(); it != filenames.end(); ++it)
+	{
+		// Write out the binary archive.
+		fstring binaryFilename = *it + FC(".binary.fcb");
+		FCDocument* document = FCollada::NewTopDocument();
+		bool saved = FCollada::LoadDocumentFromFile(document, it->c_str())
+			&& FCollada::SaveDocument(document, binaryFilename.c_str());
+		SAFE_RELEASE(document);
+
+		size_t byteCount = 0, binaryByteCount = 0;
+		if (saved)
+		{
+			FUFile file(*it, FUFile::READ);
+			if (file.IsOpen()) byteCount = file.GetLength();
+			FUFile binaryFile(binaryFilename, FUFile::READ);
+			if (binaryFile.IsOpen()) binaryByteCount = binaryFile.GetLength();
+		}
+		if (!saved || byteCount == 0 || binaryByteCount == 0)
+		{
+			std::cout << "binary: could not save " << TO_STRING(*it).c_str() << std::endl;
+			remove(TO_STRING(binaryFilename).c_str());
+			status = false;
+			continue;
+		}
+
+		BenchmarkMeasure xmlMeasure, binaryMeasure;
+		bool loadStatus = RunMeasured(LoadDocument, (void*) it, options.iterations, xmlMeasure);
+		loadStatus &= RunMeasured(LoadDocument, &binaryFilename, options.iterations, binaryMeasure);
+		remove(TO_STRING(binaryFilename).c_str());
+		if (!loadStatus)
+		{
+			std::cout << "binary: could not load " << TO_STRING(*it).c_str() << std::endl;
+			status = false;
+			continue;
+		}
+
+		PrintMeasure("binary", "xml", *it, xmlMeasure);
+		PrintMeasure("binary", "binary", *it, binaryMeasure);
+		PrintThroughput("binary", "xml", *it, xmlMeasure, byteCount);
+		PrintThroughput("binary", "binary", *it, binaryMeasure, byteCount);
+
+		char line[1024];
+		snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.2fx %10u KB", "binary", "speedup", TO_STRING(*it).c_str(),
+			(binaryMeasure.seconds > 0.0) ? xmlMeasure.seconds / binaryMeasure.seconds : 0.0, (uint32) (binaryByteCount / 1024));
+		line[sizeof(line) - 1] = 0;
+		std::cout << line << std::endl;
+	}
+	return status;
+}
@@ -0,0 +1,162 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Animation curve benchmark: builds a dense curve set of 2,000 curves with
+	1,000 keys each, half of them with linear keys and half of them with Bezier
+	keys, each curve animating the translation of its own scene node. The time
+	and the peak memory are given for building the curve set and for loading it
+	back from a temporary file. The curves are then evaluated 4,000,000
+	times at scattered inputs: the evaluation rate is given in millions of
+	evaluations per second.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDAnimated.h"
+#include "FCDocument/FCDAnimation.h"
+#include "FCDocument/FCDAnimationChannel.h"
+#include "FCDocument/FCDAnimationCurve.h"
+#include "FCDocument/FCDAnimationKey.h"
+#include "FCDocument/FCDLibrary.h"
+#include "FCDocument/FCDSceneNode.h"
+#include "FCDocument/FCDTransform.h"
+#include <cstdio>
+
+static const size_t curveCount = 2000;
+static const size_t curveKeyCount = 1000;
+static const size_t nodeGroupSize = 200;
+static const size_t evaluationCount = 4000000;
+
+struct CurveData
+{
+	FCDocument* document;
+	const fstring* filename;
+	FCDAnimationCurveList curves;
+};
+
+static FCDocument* BuildCurveDocument(FCDAnimationCurveList& curves)
+{
+	FCDocument* document = FCollada::NewTopDocument();
+	FCDSceneNode* visualScene = document->AddVisualScene();
+	FCDAnimation* animation = document->GetAnimationLibrary()->AddEntity();
+	FCDSceneNode* group = nullptr;
+	for (size_t i = 0; i < curveCount; ++i)
+	{
+		if (i % nodeGroupSize == 0) group = visualScene->AddChildNode();
+		FCDSceneNode* node = group->AddChildNode();
+		FCDTransform* translation = node->AddTransform(FCDTransform::TRANSLATION);
+
+		// Alternate the linear and the Bezier curves.
+		FCDAnimationCurve* curve = animation->AddChannel()->AddCurve();
+		bool isBezier = (i & 1) != 0;
+		curve->ReserveKeys(curveKeyCount, isBezier ? FUDaeInterpolation::BEZIER : FUDaeInterpolation::LINEAR);
+		for (size_t k = 0; k < curveKeyCount; ++k)
+		{
+			float input = (float) k / 30.0f;
+			FCDAnimationKey* key = curve->AddKey(isBezier ? FUDaeInterpolation::BEZIER : FUDaeInterpolation::LINEAR);
+			key->input = input;
+			key->output = (float) ((i + k * 7) % 101);
+			if (isBezier)
+			{
+				FCDAnimationKeyBezier* bkey = (FCDAnimationKeyBezier*) key;
+				bkey->inTangent = FMVector2(input - 1.0f / 90.0f, key->output);
+				bkey->outTangent = FMVector2(input + 1.0f / 90.0f, key->output);
+			}
+		}
+		translation->GetAnimated()->AddCurve(0, curve);
+		curves.push_back(curve);
+	}
+	return document;
+}
+
+static bool BuildCurves(void* UNUSED(userData))
+{
+	FCDAnimationCurveList curves;
+	FCDocument* document = BuildCurveDocument(curves);
+	bool status = curves.size() == curveCount;
+	SAFE_RELEASE(document);
+	return status;
+}
+
+static bool SaveCurves(void* userData)
+{
+	CurveData* data = (CurveData*) userData;
+	FCDAnimationCurveList curves;
+	FCDocument* document = BuildCurveDocument(curves);
+	bool status = FCollada::SaveDocument(document, data->filename->c_str());
+	SAFE_RELEASE(document);
+	return status;
+}
+
+static bool LoadCurves(void* userData)
+{
+	CurveData* data = (CurveData*) userData;
+	FUErrorSimpleHandler errorHandler;
+	FCDocument* document = FCollada::NewTopDocument();
+	bool status = FCollada::LoadDocumentFromFile(document, data->filename->c_str());
+	SAFE_RELEASE(document);
+	return status && errorHandler.IsSuccessful();
+}
+
+static bool EvaluateCurves(void* userData)
+{
+	CurveData* data = (CurveData*) userData;
+	float inputEnd = (float) curveKeyCount / 30.0f;
+	float sum = 0.0f;
+	for (size_t i = 0; i < evaluationCount; ++i)
+	{
+		// Visit the curves and their inputs in a scattered order.
+		const FCDAnimationCurve* curve = data->curves[(i * 7919) % curveCount];
+		float input = (float) ((i * 104729) % 100000) / 100000.0f * inputEnd;
+		sum += curve->Evaluate(input);
+	}
+	return sum == sum;
+}
+
+static void PrintRate(const char* variant, const fstring& name, const BenchmarkMeasure& measure, size_t count)
+{
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.3f M/s", "curves", variant, TO_STRING(name).c_str(),
+		(measure.seconds > 0.0) ? count / measure.seconds / 1e6 : 0.0);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+}
+
+bool BenchmarkCurves(const FilenameList& UNUSED(filenames), const BenchmarkOptions& options)
+{
+	fstring name = FC("dense-2M-keys");
+	fstring filename = FC("dense-curves.dae");
+	CurveData data;
+	data.filename = &filename;
+	data.document = nullptr;
+
+	// Save the curve set from a child process too, so that the build and the load
+	// peak memory figures do not include the pages of an earlier curve set.
+	BenchmarkMeasure saveMeasure, buildMeasure, loadMeasure, evaluateMeasure;
+	if (!RunMeasured(SaveCurves, &data, 1, saveMeasure))
+	{
+		std::cout << "curves: could not save " << TO_STRING(filename).c_str() << std::endl;
+		remove(TO_STRING(filename).c_str());
+		return false;
+	}
+	bool status = RunMeasured(BuildCurves, &data, options.iterations, buildMeasure);
+	status &= RunMeasured(LoadCurves, &data, options.iterations, loadMeasure);
+	data.document = BuildCurveDocument(data.curves);
+	status &= RunMeasured(EvaluateCurves, &data, options.iterations, evaluateMeasure);
+	SAFE_RELEASE(data.document);
+	remove(TO_STRING(filename).c_str());
+	if (!status)
+	{
+		std::cout << "curves: could not measure " << TO_STRING(name).c_str() << std::endl;
+		return false;
+	}
+
+	PrintMeasure("curves", "build", name, buildMeasure);
+	PrintMeasure("curves", "load", name, loadMeasure);
+	PrintRate("evaluate", name, evaluateMeasure, evaluationCount);
+	return true;
+}
@@ -0,0 +1,84 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Export benchmark: loads each document once, then measures the time
+	taken to save it back to a temporary COLLADA file, building the whole
+	XML tree first and streaming the XML tree one library entity at a time.
+	The throughput is given in megabytes of written XML per second.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FUtils/FUFile.h"
+#include <cstdio>
+
+struct ExportData
+{
+	FCDocument* document;
+	fstring filename;
+	bool streaming;
+};
+
+static bool ExportDocument(void* userData)
+{
+	ExportData* data = (ExportData*) userData;
+	FUErrorSimpleHandler errorHandler;
+	FCollada::SetStreamingExportFlag(data->streaming);
+	bool status = FCollada::SaveDocument(data->document, data->filename.c_str());
+	FCollada::SetStreamingExportFlag(false);
+	return status && errorHandler.IsSuccessful();
+}
+
+bool BenchmarkExport(const FilenameList& filenames, const BenchmarkOptions& options)
+{
+	bool status = true;
+	for (const fstring* it = filenames.begin(); it != filenames.end(); ++it)
+	{
+		ExportData data;
+		data.filename = *it + FC(".export.dae");
+		data.document = FCollada::NewTopDocument();
+
+		// Stream the import too, so that the peak memory of the export is not hidden by the import's XML tree.
+		FCollada::SetStreamingImportFlag(true);
+		bool loaded = FCollada::LoadDocumentFromFile(data.document, it->c_str());
+		FCollada::SetStreamingImportFlag(false);
+		if (!loaded)
+		{
+			std::cout << "export: could not load " << TO_STRING(*it).c_str() << std::endl;
+			SAFE_RELEASE(data.document);
+			status = false;
+			continue;
+		}
+
+		BenchmarkMeasure treeMeasure, streamedMeasure;
+		data.streaming = false;
+		bool exportStatus = RunMeasured(ExportDocument, &data, options.iterations, treeMeasure);
+		data.streaming = true;
+		exportStatus &= RunMeasured(ExportDocument, &data, options.iterations, streamedMeasure);
+		SAFE_RELEASE(data.document);
+
+		size_t byteCount = 0;
+		if (exportStatus)
+		{
+			FUFile file(data.filename, FUFile::READ);
+			if (file.IsOpen()) byteCount = file.GetLength();
+		}
+		remove(TO_STRING(data.filename).c_str());
+
+		if (!exportStatus || byteCount == 0)
+		{
+			std::cout << "export: could not save " << TO_STRING(*it).c_str() << std::endl;
+			status = false;
+			continue;
+		}
+		PrintMeasure("export", "tree", *it, treeMeasure);
+		PrintMeasure("export", "streamed", *it, streamedMeasure);
+		PrintThroughput("export", "tree", *it, treeMeasure, byteCount);
+		PrintThroughput("export", "streamed", *it, streamedMeasure, byteCount);
+	}
+	return status;
+}
@@ -0,0 +1,183 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Id look-up benchmark: builds a synthetic document with 100,000 entities,
+	half of them visual scene nodes grouped under a few hundred parent nodes
+	and half of them geometries, then resolves one million ids through the
+	FCDocument::Find functions, which use the map of unique ids of the document.
+	The former look-up, which searches through the library entities and their
+	child nodes, is measured on one thousand ids only. Each document given on the
+	command line is then loaded and the ids of all its entities are resolved
+	the same way. The look-up rate is given in millions of look-ups per second.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDGeometry.h"
+#include "FCDocument/FCDLibrary.h"
+#include "FCDocument/FCDSceneNode.h"
+#include <cstdio>
+
+static const size_t syntheticNodeCount = 50000;
+static const size_t syntheticGeometryCount = 50000;
+static const size_t syntheticGroupSize = 200;
+static const size_t indexedLookupCount = 1000000;
+static const size_t linearLookupCount = 1000;
+
+struct FindData
+{
+	FCDocument* document;
+	StringList ids;
+	size_t lookupCount;
+	bool linear;
+};
+
+// The former FCDLibrary::FindDaeId implementation.
+template <class T>
+static const FCDEntity* LinearFind(const FCDLibrary<T>* library, const fm::string& daeId)
+{
+	size_t entityCount = library->GetEntityCount();
+	for (size_t i = 0; i < entityCount; ++i)
+	{
+		const FCDEntity* found = library->GetEntity(i)->FindDaeId(daeId);
+		if (found != nullptr && found->GetObjectType() == T::GetClassType()) return found;
+	}
+	return nullptr;
+}
+
+static bool FindIds(void* userData)
+{
+	FindData* data = (FindData*) userData;
+	const FCDocument* document = data->document;
+	size_t idCount = data->ids.size();
+	size_t foundCount = 0;
+	for (size_t i = 0; i < data->lookupCount; ++i)
+	{
+		// Visit the ids in a scattered order.
+		const fm::string& id = data->ids[(i * 7919) % idCount];
+		const FCDEntity* found;
+		if (data->linear)
+		{
+			found = LinearFind(document->GetVisualSceneLibrary(), id);
+			if (found == nullptr) found = LinearFind(document->GetGeometryLibrary(), id);
+		}
+		else
+		{
+			found = const_cast<FCDocument*>(document)->FindEntity(id);
+		}
+		if (found != nullptr) ++foundCount;
+	}
+	return foundCount == data->lookupCount;
+}
+
+static FCDocument* BuildSyntheticDocument(StringList& ids)
+{
+	FCDocument* document = FCollada::NewTopDocument();
+	FCDSceneNode* visualScene = document->AddVisualScene();
+	visualScene->SetDaeId("synthetic_scene");
+	char id[64];
+	FCDSceneNode* group = nullptr;
+	for (size_t i = 0; i < syntheticNodeCount; ++i)
+	{
+		if (i % syntheticGroupSize == 0)
+		{
+			group = visualScene->AddChildNode();
+			snprintf(id, sizeof(id), "group_%u", (uint32) (i / syntheticGroupSize));
+			group->SetDaeId(id);
+		}
+		FCDSceneNode* node = group->AddChildNode();
+		snprintf(id, sizeof(id), "node_%u", (uint32) i);
+		node->SetDaeId(id);
+		ids.push_back(node->GetDaeId());
+	}
+	FCDGeometryLibrary* geometryLibrary = document->GetGeometryLibrary();
+	for (size_t i = 0; i < syntheticGeometryCount; ++i)
+	{
+		FCDGeometry* geometry = geometryLibrary->AddEntity();
+		snprintf(id, sizeof(id), "geometry_%u", (uint32) i);
+		geometry->SetDaeId(id);
+		ids.push_back(geometry->GetDaeId());
+	}
+	return document;
+}
+
+static void ListIds(const FCDSceneNode* node, StringList& ids)
+{
+	ids.push_back(node->GetDaeId());
+	for (size_t i = 0; i < node->GetChildrenCount(); ++i) ListIds(node->GetChild(i), ids);
+}
+
+static void ListIds(FCDocument* document, StringList& ids)
+{
+	FCDVisualSceneNodeLibrary* visualSceneLibrary = document->GetVisualSceneLibrary();
+	for (size_t i = 0; i < visualSceneLibrary->GetEntityCount(); ++i)
+	{
+		ListIds(visualSceneLibrary->GetEntity(i), ids);
+	}
+	FCDGeometryLibrary* geometryLibrary = document->GetGeometryLibrary();
+	for (size_t i = 0; i < geometryLibrary->GetEntityCount(); ++i)
+	{
+		ids.push_back(geometryLibrary->GetEntity(i)->GetDaeId());
+	}
+}
+
+static void PrintRate(const char* variant, const fstring& name, const BenchmarkMeasure& measure, size_t lookupCount)
+{
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.3f M/s", "find", variant, TO_STRING(name).c_str(),
+		(measure.seconds > 0.0) ? lookupCount / measure.seconds / 1e6 : 0.0);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+}
+
+static bool MeasureFind(FindData& data, const fstring& name, const BenchmarkOptions& options)
+{
+	BenchmarkMeasure indexedMeasure, linearMeasure;
+	data.linear = false;
+	data.lookupCount = indexedLookupCount;
+	bool status = RunMeasured(FindIds, &data, options.iterations, indexedMeasure);
+	data.linear = true;
+	data.lookupCount = linearLookupCount;
+	status &= RunMeasured(FindIds, &data, options.iterations, linearMeasure);
+	if (!status)
+	{
+		std::cout << "find: could not resolve the ids of " << TO_STRING(name).c_str() << std::endl;
+		return false;
+	}
+
+	PrintMeasure("find", "indexed-1M", name, indexedMeasure);
+	PrintMeasure("find", "linear-1K", name, linearMeasure);
+	PrintRate("indexed", name, indexedMeasure, indexedLookupCount);
+	PrintRate("linear", name, linearMeasure, linearLookupCount);
+	return true;
+}
+
+bool BenchmarkFind(const FilenameList& filenames, const BenchmarkOptions& options)
+{
+	FindData data;
+	data.document = BuildSyntheticDocument(data.ids);
+	bool status = MeasureFind(data, FC("synthetic-100k"), options);
+	SAFE_RELEASE(data.document);
+
+	for (const fstring* it = filenames.begin(); it != filenames.end(); ++it)
+	{
+		data.ids.clear();
+		data.document = FCollada::NewTopDocument();
+		if (!FCollada::LoadDocumentFromFile(data.document, it->c_str()))
+		{
+			std::cout << "find: could not load " << TO_STRING(*it).c_str() << std::endl;
+			SAFE_RELEASE(data.document);
+			status = false;
+			continue;
+		}
+
+		ListIds(data.document, data.ids);
+		if (!data.ids.empty()) status &= MeasureFind(data, *it, options);
+		SAFE_RELEASE(data.document);
+	}
+	return status;
+}
@@ -0,0 +1,67 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Import benchmark: loads each document with the DOM import path,
+	where the whole XML tree is parsed before it is imported, with
+	the streaming import path, where the XML is read one element at a time,
+	and with the parallel import path, where the library entities of
+	the parsed XML tree are loaded on a pool of worker threads.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+
+struct ImportData
+{
+	const fstring* filename;
+	bool streaming;
+	bool parallel;
+};
+
+static bool ImportDocument(void* userData)
+{
+	ImportData* data = (ImportData*) userData;
+	FCollada::SetStreamingImportFlag(data->streaming);
+	FCollada::SetParallelImportFlag(data->parallel);
+
+	FUErrorSimpleHandler errorHandler;
+	FCDocument* document = FCollada::NewTopDocument();
+	bool status = FCollada::LoadDocumentFromFile(document, data->filename->c_str());
+	SAFE_RELEASE(document);
+	return status && errorHandler.IsSuccessful();
+}
+
+bool BenchmarkImport(const FilenameList& filenames, const BenchmarkOptions& options)
+{
+	bool status = true;
+	for (const fstring* it = filenames.begin(); it != filenames.end(); ++it)
+	{
+		ImportData data;
+		data.filename = it;
+
+		BenchmarkMeasure domMeasure, streamingMeasure, parallelMeasure;
+		data.streaming = false; data.parallel = false;
+		bool domStatus = RunMeasured(ImportDocument, &data, options.iterations, domMeasure);
+		data.streaming = true; data.parallel = false;
+		bool streamingStatus = RunMeasured(ImportDocument, &data, options.iterations, streamingMeasure);
+		data.streaming = false; data.parallel = true;
+		bool parallelStatus = RunMeasured(ImportDocument, &data, options.iterations, parallelMeasure);
+		FCollada::SetStreamingImportFlag(false);
+		FCollada::SetParallelImportFlag(false);
+
+		if (!domStatus || !streamingStatus || !parallelStatus)
+		{
+			std::cout << "import: could not load " << TO_STRING(*it).c_str() << std::endl;
+			status = false;
+			continue;
+		}
+		PrintMeasure("import", "dom", *it, domMeasure);
+		PrintMeasure("import", "streaming", *it, streamingMeasure);
+		PrintMeasure("import", "parallel", *it, parallelMeasure);
+	}
+	return status;
+}
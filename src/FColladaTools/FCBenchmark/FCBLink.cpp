@@ -0,0 +1,186 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Animation linking benchmark: generates documents with 5,000, 20,000 and
+	50,000 scene nodes, each with an animated translation that has its own
+	animation channel. Each document is saved once to a temporary file and
+	parsed. Its libraries are then loaded by FArchiveXML and only the linking
+	is timed: the look-ups of the channels that target each translation, as
+	done for the animated values while the scene nodes load, and the linking
+	pass, FArchiveXML::LinkImportedDocument. Both times are also given per
+	channel, in microseconds, and should stay flat as the number of channels
+	grows.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDAnimated.h"
+#include "FCDocument/FCDAnimation.h"
+#include "FCDocument/FCDAnimationChannel.h"
+#include "FCDocument/FCDAnimationCurve.h"
+#include "FCDocument/FCDAnimationKey.h"
+#include "FCDocument/FCDLibrary.h"
+#include "FCDocument/FCDSceneNode.h"
+#include "FCDocument/FCDTransform.h"
+
+// The benchmarks are built without the LibXML interface. The linking pass
+// is reached through the FArchiveXML plug-in, which needs it.
+#include <libxml/tree.h>
+#define HAS_LIBXML
+#include "FUtils/FUXmlDocument.h"
+#include "../../FColladaPlugins/FArchiveXML/FAXColladaParser.h"
+#include "../../FColladaPlugins/FArchiveXML/FArchiveXML.h"
+#undef HAS_LIBXML
+
+#include <cstdio>
+
+static const size_t channelCounts[] = { 5000, 20000, 50000 };
+static const size_t nodeGroupSize = 200;
+static const size_t keyCount = 4;
+
+static FCDocument* BuildLinkDocument(size_t nodeCount)
+{
+	FCDocument* document = FCollada::NewTopDocument();
+	FCDSceneNode* visualScene = document->AddVisualScene();
+	FCDAnimation* animation = document->GetAnimationLibrary()->AddEntity();
+	FCDSceneNode* group = nullptr;
+	for (size_t i = 0; i < nodeCount; ++i)
+	{
+		if (i % nodeGroupSize == 0) group = visualScene->AddChildNode();
+		FCDSceneNode* node = group->AddChildNode();
+		FCDTransform* translation = node->AddTransform(FCDTransform::TRANSLATION);
+
+		// One channel and one curve for the X coordinate of each translation.
+		FCDAnimationChannel* channel = animation->AddChannel();
+		FCDAnimationCurve* curve = channel->AddCurve();
+		for (size_t k = 0; k < keyCount; ++k)
+		{
+			FCDAnimationKey* key = curve->AddKey(FUDaeInterpolation::LINEAR, (float) k);
+			key->output = (float) (i + k);
+		}
+		translation->GetAnimated()->AddCurve(0, curve);
+	}
+	return document;
+}
+
+// Lists the target pointers of the translations within a parsed document.
+static void FindTranslationPointers(xmlNode* node, StringList& pointers)
+{
+	for (xmlNode* child = node->children; child != nullptr; child = child->next)
+	{
+		if (child->type != XML_ELEMENT_NODE) continue;
+		if (IsEquivalent(child->name, "translate"))
+		{
+			pointers.push_back(fm::string());
+			FUDaeParser::CalculateNodeTargetPointer(child, pointers.back());
+		}
+		else FindTranslationPointers(child, pointers);
+	}
+}
+
+// Loads the libraries of a parsed document, then links them.
+// Only the channel look-ups and the linking pass are timed.
+static bool LinkDocument(const fstring& filename, xmlNode* rootNode, const StringList& pointers, double& resolveSeconds, double& linkSeconds)
+{
+	FUErrorSimpleHandler errorHandler;
+	FCDocument* document = FCollada::NewTopDocument();
+	document->SetFileUrl(filename);
+	bool status;
+	{
+		FAXImportContextScope importContext;
+		status = FArchiveXML::ImportLibraries(document, rootNode);
+
+		double start = GetBenchmarkTime();
+		size_t channelCount = 0;
+		FCDAnimationChannelList channels;
+		for (StringList::const_iterator it = pointers.begin(); it != pointers.end(); ++it)
+		{
+			channels.clear();
+			FArchiveXML::FindAnimationChannels(document, *it, channels);
+			channelCount += channels.size();
+		}
+		resolveSeconds += GetBenchmarkTime() - start;
+		status &= channelCount == pointers.size();
+
+		start = GetBenchmarkTime();
+		status &= FArchiveXML::LinkImportedDocument(document);
+		linkSeconds += GetBenchmarkTime() - start;
+		FArchiveXML::ClearIntermediateData();
+	}
+	SAFE_RELEASE(document);
+	return status && errorHandler.IsSuccessful();
+}
+
+static bool SaveLinkDocument(const fstring& filename, size_t nodeCount)
+{
+	FCDocument* document = BuildLinkDocument(nodeCount);
+	bool status = FCollada::SaveDocument(document, filename.c_str());
+	SAFE_RELEASE(document);
+	return status;
+}
+
+bool BenchmarkLink(const FilenameList& UNUSED(filenames), const BenchmarkOptions& options)
+{
+	bool status = true;
+	for (size_t i = 0; i < sizeof(channelCounts) / sizeof(*channelCounts); ++i)
+	{
+		size_t channelCount = channelCounts[i];
+		char name[64];
+		snprintf(name, sizeof(name), "synthetic-%uk", (uint32) (channelCount / 1000));
+		fstring documentName = TO_FSTRING(name);
+		fstring filename = documentName + FC(".dae");
+		if (!SaveLinkDocument(filename, channelCount))
+		{
+			std::cout << "link: could not save " << name << std::endl;
+			remove(TO_STRING(filename).c_str());
+			status = false;
+			continue;
+		}
+
+		// The document is parsed once: each iteration loads and links it again.
+		BenchmarkMeasure resolveMeasure = { 0.0, 0 }, linkMeasure = { 0.0, 0 };
+		bool linkStatus;
+		{
+			FUObjectRef<FCDocument> parsingDocument = FCollada::NewTopDocument();
+			FUXmlDocument daeDocument(parsingDocument->GetFileManager(), filename.c_str(), true);
+			xmlNode* rootNode = daeDocument.GetRootNode();
+			linkStatus = rootNode != nullptr;
+			StringList pointers;
+			if (linkStatus) FindTranslationPointers(rootNode, pointers);
+			for (uint32 j = 0; j < options.iterations && linkStatus; ++j)
+			{
+				linkStatus &= LinkDocument(filename, rootNode, pointers, resolveMeasure.seconds, linkMeasure.seconds);
+			}
+			if (options.iterations > 0)
+			{
+				resolveMeasure.seconds /= options.iterations;
+				linkMeasure.seconds /= options.iterations;
+			}
+		}
+		remove(TO_STRING(filename).c_str());
+		if (!linkStatus)
+		{
+			std::cout << "link: could not load " << name << std::endl;
+			status = false;
+			continue;
+		}
+
+		PrintMeasure("link", "resolve", documentName, resolveMeasure);
+		PrintMeasure("link", "link", documentName, linkMeasure);
+
+		char line[1024];
+		snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.3f us", "link", "resolve/chan", name,
+			resolveMeasure.seconds / channelCount * 1e6);
+		line[sizeof(line) - 1] = 0;
+		std::cout << line << std::endl;
+		snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.3f us", "link", "link/chan", name,
+			linkMeasure.seconds / channelCount * 1e6);
+		line[sizeof(line) - 1] = 0;
+		std::cout << line << std::endl;
+	}
+	return status;
+}
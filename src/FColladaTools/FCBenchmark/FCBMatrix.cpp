@@ -0,0 +1,313 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Matrix benchmark: measures the FMMatrix44 kernels on 4,096 transforms and
+	one million points. The multiplication, the inverse, the determinant and the
+	point transform are compared with the former scalar implementations, and the
+	batch entry points with loops over the single operations. The times are
+	given in nanoseconds per matrix or per point.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include <cstdio>
+#include <limits>
+
+static const size_t matrixCount = 4096;
+static const size_t matrixRounds = 256;
+static const size_t pointCount = 1000000;
+static const size_t pointRounds = 8;
+
+struct MatrixData
+{
+	FMMatrix44List matrices;
+	FMMatrix44List results;
+	FMVector3List points;
+	FMVector3List transformed;
+	float sum;
+};
+
+// The former FMMatrix44 implementations.
+static FMMatrix44 FormerMultiply(const FMMatrix44& m1, const FMMatrix44& m2)
+{
+	FMMatrix44 mx;
+	for (size_t i = 0; i < 4; ++i)
+	{
+		for (size_t j = 0; j < 4; ++j)
+		{
+			mx.m[i][j] = m1.m[0][j] * m2.m[i][0] + m1.m[1][j] * m2.m[i][1] + m1.m[2][j] * m2.m[i][2] + m1.m[3][j] * m2.m[i][3];
+		}
+	}
+	return mx;
+}
+
+static float FormerDet2x2(float a1, float a2, float b1, float b2)
+{
+	return a1 * b2 - b1 * a2;
+}
+
+static float FormerDet3x3(float a1, float a2, float a3, float b1, float b2, float b3, float c1, float c2, float c3)
+{
+	return a1 * FormerDet2x2(b2, b3, c2, c3) - b1 * FormerDet2x2(a2, a3, c2, c3) + c1 * FormerDet2x2(a2, a3, b2, b3);
+}
+
+static float FormerDeterminant(const FMMatrix44& mx)
+{
+	const float (*m)[4] = mx.m;
+	float cofactor0 = FormerDet3x3(m[1][1], m[1][2], m[1][3], m[2][1], m[2][2], m[2][3], m[3][1], m[3][2], m[3][3]);
+	float cofactor1 = -FormerDet3x3(m[0][1], m[0][2], m[0][3], m[2][1], m[2][2], m[2][3], m[3][1], m[3][2], m[3][3]);
+	float cofactor2 = FormerDet3x3(m[0][1], m[0][2], m[0][3], m[1][1], m[1][2], m[1][3], m[3][1], m[3][2], m[3][3]);
+	float cofactor3 = -FormerDet3x3(m[0][1], m[0][2], m[0][3], m[1][1], m[1][2], m[1][3], m[2][1], m[2][2], m[2][3]);
+	return (m[0][0] * cofactor0) + (m[1][0] * cofactor1) + (m[2][0] * cofactor2) + (m[3][0] * cofactor3);
+}
+
+static FMMatrix44 FormerInverted(const FMMatrix44& mx)
+{
+	const float (*m)[4] = mx.m;
+	FMMatrix44 b;
+	b.m[0][0] =  FormerDet3x3(m[1][1], m[1][2], m[1][3], m[2][1], m[2][2], m[2][3], m[3][1], m[3][2], m[3][3]);
+	b.m[0][1] = -FormerDet3x3(m[0][1], m[0][2], m[0][3], m[2][1], m[2][2], m[2][3], m[3][1], m[3][2], m[3][3]);
+	b.m[0][2] =  FormerDet3x3(m[0][1], m[0][2], m[0][3], m[1][1], m[1][2], m[1][3], m[3][1], m[3][2], m[3][3]);
+	b.m[0][3] = -FormerDet3x3(m[0][1], m[0][2], m[0][3], m[1][1], m[1][2], m[1][3], m[2][1], m[2][2], m[2][3]);
+	b.m[1][0] = -FormerDet3x3(m[1][0], m[1][2], m[1][3], m[2][0], m[2][2], m[2][3], m[3][0], m[3][2], m[3][3]);
+	b.m[1][1] =  FormerDet3x3(m[0][0], m[0][2], m[0][3], m[2][0], m[2][2], m[2][3], m[3][0], m[3][2], m[3][3]);
+	b.m[1][2] = -FormerDet3x3(m[0][0], m[0][2], m[0][3], m[1][0], m[1][2], m[1][3], m[3][0], m[3][2], m[3][3]);
+	b.m[1][3] =  FormerDet3x3(m[0][0], m[0][2], m[0][3], m[1][0], m[1][2], m[1][3], m[2][0], m[2][2], m[2][3]);
+	b.m[2][0] =  FormerDet3x3(m[1][0], m[1][1], m[1][3], m[2][0], m[2][1], m[2][3], m[3][0], m[3][1], m[3][3]);
+	b.m[2][1] = -FormerDet3x3(m[0][0], m[0][1], m[0][3], m[2][0], m[2][1], m[2][3], m[3][0], m[3][1], m[3][3]);
+	b.m[2][2] =  FormerDet3x3(m[0][0], m[0][1], m[0][3], m[1][0], m[1][1], m[1][3], m[3][0], m[3][1], m[3][3]);
+	b.m[2][3] = -FormerDet3x3(m[0][0], m[0][1], m[0][3], m[1][0], m[1][1], m[1][3], m[2][0], m[2][1], m[2][3]);
+	b.m[3][0] = -FormerDet3x3(m[1][0], m[1][1], m[1][2], m[2][0], m[2][1], m[2][2], m[3][0], m[3][1], m[3][2]);
+	b.m[3][1] =  FormerDet3x3(m[0][0], m[0][1], m[0][2], m[2][0], m[2][1], m[2][2], m[3][0], m[3][1], m[3][2]);
+	b.m[3][2] = -FormerDet3x3(m[0][0], m[0][1], m[0][2], m[1][0], m[1][1], m[1][2], m[3][0], m[3][1], m[3][2]);
+	b.m[3][3] =  FormerDet3x3(m[0][0], m[0][1], m[0][2], m[1][0], m[1][1], m[1][2], m[2][0], m[2][1], m[2][2]);
+
+	double det = (m[0][0] * b.m[0][0]) + (m[1][0] * b.m[0][1]) + (m[2][0] * b.m[0][2]) + (m[3][0] * b.m[0][3]);
+	double epsilon = std::numeric_limits<double>::epsilon();
+	if (det + epsilon >= 0.0f && det - epsilon <= 0.0f) det = FMath::Sign(det) * 0.0001f;
+	float oodet = (float) (1.0 / det);
+	for (size_t i = 0; i < 4; ++i)
+	{
+		for (size_t j = 0; j < 4; ++j) b.m[i][j] *= oodet;
+	}
+	return b;
+}
+
+static FMVector3 FormerTransformCoordinate(const FMMatrix44& mx, const FMVector3& coordinate)
+{
+	const float (*m)[4] = mx.m;
+	return FMVector3(
+		m[0][0] * coordinate.m_X + m[1][0] * coordinate.m_Y + m[2][0] * coordinate.m_Z + m[3][0],
+		m[0][1] * coordinate.m_X + m[1][1] * coordinate.m_Y + m[2][1] * coordinate.m_Z + m[3][1],
+		m[0][2] * coordinate.m_X + m[1][2] * coordinate.m_Y + m[2][2] * coordinate.m_Z + m[3][2]);
+}
+
+static void BuildMatrices(MatrixData& data)
+{
+	data.matrices.reserve(matrixCount);
+	data.results.resize(matrixCount);
+	for (size_t i = 0; i < matrixCount; ++i)
+	{
+		float s = (float) (i % 97) * 0.01f;
+		FMMatrix44 mx;
+		mx.Recompose(FMVector3(1.0f + s, 2.0f - s, 0.5f + s), FMVector3(s * 3.0f, 1.0f - s, s * 7.0f), FMVector3(s * 100.0f, -s, 5.0f));
+		data.matrices.push_back(mx);
+	}
+	data.points.reserve(pointCount);
+	data.transformed.resize(pointCount);
+	for (size_t i = 0; i < pointCount; ++i)
+	{
+		data.points.push_back(FMVector3((float) (i % 1000), (float) (i % 777) * 0.5f, (float) (i % 13)));
+	}
+	data.sum = 0.0f;
+}
+
+// Each measured function walks the matrices in a chain, so that the results are all used.
+static bool MultiplyFormer(void* userData)
+{
+	MatrixData* data = (MatrixData*) userData;
+	for (size_t r = 0; r < matrixRounds; ++r)
+	{
+		for (size_t i = 1; i < matrixCount; ++i) data->results[i] = FormerMultiply(data->matrices[i - 1], data->matrices[i]);
+	}
+	return true;
+}
+
+static bool MultiplyCurrent(void* userData)
+{
+	MatrixData* data = (MatrixData*) userData;
+	for (size_t r = 0; r < matrixRounds; ++r)
+	{
+		for (size_t i = 1; i < matrixCount; ++i) data->results[i] = data->matrices[i - 1] * data->matrices[i];
+	}
+	return true;
+}
+
+static bool MultiplyBatch(void* userData)
+{
+	MatrixData* data = (MatrixData*) userData;
+	for (size_t r = 0; r < matrixRounds; ++r)
+	{
+		MultiplyMatrices(data->matrices.begin(), data->matrices.begin() + 1, matrixCount - 1, data->results.begin() + 1);
+	}
+	return true;
+}
+
+static bool MultiplyParentBatch(void* userData)
+{
+	MatrixData* data = (MatrixData*) userData;
+	for (size_t r = 0; r < matrixRounds; ++r)
+	{
+		MultiplyMatrices(data->matrices[r], data->matrices.begin() + 1, matrixCount - 1, data->results.begin() + 1);
+	}
+	return true;
+}
+
+static bool InvertFormer(void* userData)
+{
+	MatrixData* data = (MatrixData*) userData;
+	for (size_t r = 0; r < matrixRounds; ++r)
+	{
+		for (size_t i = 1; i < matrixCount; ++i) data->results[i] = FormerInverted(data->matrices[i]);
+	}
+	return true;
+}
+
+static bool InvertCurrent(void* userData)
+{
+	MatrixData* data = (MatrixData*) userData;
+	for (size_t r = 0; r < matrixRounds; ++r)
+	{
+		for (size_t i = 1; i < matrixCount; ++i) data->results[i] = data->matrices[i].Inverted();
+	}
+	return true;
+}
+
+static bool DeterminantFormer(void* userData)
+{
+	MatrixData* data = (MatrixData*) userData;
+	float sum = 0.0f;
+	for (size_t r = 0; r < matrixRounds; ++r)
+	{
+		for (size_t i = 1; i < matrixCount; ++i) sum += FormerDeterminant(data->matrices[i]);
+	}
+	data->sum = sum;
+	return true;
+}
+
+static bool DeterminantCurrent(void* userData)
+{
+	MatrixData* data = (MatrixData*) userData;
+	float sum = 0.0f;
+	for (size_t r = 0; r < matrixRounds; ++r)
+	{
+		for (size_t i = 1; i < matrixCount; ++i) sum += data->matrices[i].Determinant();
+	}
+	data->sum = sum;
+	return true;
+}
+
+static bool TransformFormer(void* userData)
+{
+	MatrixData* data = (MatrixData*) userData;
+	for (size_t r = 0; r < pointRounds; ++r)
+	{
+		const FMMatrix44& mx = data->matrices[r];
+		for (size_t i = 0; i < pointCount; ++i) data->transformed[i] = FormerTransformCoordinate(mx, data->points[i]);
+	}
+	return true;
+}
+
+static bool TransformCurrent(void* userData)
+{
+	MatrixData* data = (MatrixData*) userData;
+	for (size_t r = 0; r < pointRounds; ++r)
+	{
+		const FMMatrix44& mx = data->matrices[r];
+		for (size_t i = 0; i < pointCount; ++i) data->transformed[i] = mx.TransformCoordinate(data->points[i]);
+	}
+	return true;
+}
+
+static bool TransformBatch(void* userData)
+{
+	MatrixData* data = (MatrixData*) userData;
+	for (size_t r = 0; r < pointRounds; ++r)
+	{
+		data->matrices[r].TransformCoordinates(data->points.begin(), pointCount, data->transformed.begin());
+	}
+	return true;
+}
+
+// Checks that the current kernels agree with the former ones.
+static bool CheckKernels(MatrixData& data)
+{
+	for (size_t i = 1; i < matrixCount; ++i)
+	{
+		const FMMatrix44& m1 = data.matrices[i - 1];
+		const FMMatrix44& m2 = data.matrices[i];
+		if (!IsEquivalent(m1 * m2, FormerMultiply(m1, m2))) return false;
+		if (!IsEquivalent(m2.Inverted(), FormerInverted(m2))) return false;
+		if (!IsEquivalent(m2.Determinant(), FormerDeterminant(m2))) return false;
+	}
+	data.matrices[0].TransformCoordinates(data.points.begin(), pointCount, data.transformed.begin());
+	for (size_t i = 0; i < pointCount; i += 1001)
+	{
+		if (!IsEquivalent(data.transformed[i], FormerTransformCoordinate(data.matrices[0], data.points[i]))) return false;
+	}
+	return true;
+}
+
+static void PrintOperationTime(const char* variant, const char* operation, const BenchmarkMeasure& measure, size_t operationCount)
+{
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.3f ns/op", "matrix", variant, operation, measure.seconds * 1e9 / operationCount);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+}
+
+bool BenchmarkMatrix(const FilenameList& UNUSED(filenames), const BenchmarkOptions& options)
+{
+	MatrixData data;
+	BuildMatrices(data);
+	bool status = CheckKernels(data);
+	if (!status)
+	{
+		std::cout << "matrix: the current kernels differ from the former kernels." << std::endl;
+	}
+
+	struct { const char* variant; const char* operation; MeasuredFunction function; size_t operationCount; } measured[] =
+	{
+		{ "former", "multiply", MultiplyFormer, matrixRounds * (matrixCount - 1) },
+		{ "current", "multiply", MultiplyCurrent, matrixRounds * (matrixCount - 1) },
+		{ "batch", "multiply", MultiplyBatch, matrixRounds * (matrixCount - 1) },
+		{ "batch-parent", "multiply", MultiplyParentBatch, matrixRounds * (matrixCount - 1) },
+		{ "former", "invert", InvertFormer, matrixRounds * (matrixCount - 1) },
+		{ "current", "invert", InvertCurrent, matrixRounds * (matrixCount - 1) },
+		{ "former", "determinant", DeterminantFormer, matrixRounds * (matrixCount - 1) },
+		{ "current", "determinant", DeterminantCurrent, matrixRounds * (matrixCount - 1) },
+		{ "former", "transform-coordinate", TransformFormer, pointRounds * pointCount },
+		{ "current", "transform-coordinate", TransformCurrent, pointRounds * pointCount },
+		{ "batch", "transform-coordinate", TransformBatch, pointRounds * pointCount },
+	};
+	static const size_t measuredCount = sizeof(measured) / sizeof(*measured);
+	BenchmarkMeasure measures[measuredCount];
+	for (size_t i = 0; i < measuredCount; ++i)
+	{
+		status &= RunMeasured(measured[i].function, &data, options.iterations, measures[i]);
+	}
+	if (!status)
+	{
+		std::cout << "matrix: could not measure the kernels" << std::endl;
+		return false;
+	}
+
+	for (size_t i = 0; i < measuredCount; ++i)
+	{
+		PrintOperationTime(measured[i].variant, measured[i].operation, measures[i], measured[i].operationCount);
+	}
+	return true;
+}
@@ -0,0 +1,197 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Morphing benchmark: builds a grid of 16,384 vertices, with one normal per
+	vertex, and a morph controller with 256 morph targets. Like the blend shapes
+	of a face, each morph target only moves a small patch of the grid. A quarter
+	of the morph targets have a non-zero weight. Each frame is blended through
+	a dense loop over the morph target geometries, and through the morph deformer
+	on the calling thread and on its pool of worker threads. The costs are given
+	per frame.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDController.h"
+#include "FCDocument/FCDGeometry.h"
+#include "FCDocument/FCDGeometryMesh.h"
+#include "FCDocument/FCDGeometrySource.h"
+#include "FCDocument/FCDLibrary.h"
+#include "FCDocument/FCDMorphController.h"
+#include "FCDocument/FCDMorphDeformer.h"
+#include "FUtils/FUThreadPool.h"
+#include <cstdio>
+
+static const size_t gridSize = 128;
+static const size_t targetCount = 256;
+static const size_t patchRadius = 12;
+
+struct MorphData
+{
+	FCDocument* document;
+	FCDMorphController* morph;
+	FCDMorphDeformer deformer;
+	FloatList weights;
+	FloatList positions;
+	FloatList normals;
+};
+
+static FCDGeometry* AddGridGeometry(FCDocument* document, const FloatList& positions, const FloatList& normals)
+{
+	FCDGeometry* geometry = document->GetGeometryLibrary()->AddEntity();
+	FCDGeometryMesh* mesh = geometry->CreateMesh();
+	mesh->AddVertexSource(FUDaeGeometryInput::POSITION)->SetData(positions, 3);
+	mesh->AddSource(FUDaeGeometryInput::NORMAL)->SetData(normals, 3);
+	return geometry;
+}
+
+static void BuildMorph(MorphData& data)
+{
+	data.document = FCollada::NewTopDocument();
+
+	// The flat grid, in the XY plane.
+	size_t vertexCount = gridSize * gridSize;
+	FloatList positions, normals;
+	positions.reserve(3 * vertexCount);
+	normals.reserve(3 * vertexCount);
+	for (size_t y = 0; y < gridSize; ++y)
+	{
+		for (size_t x = 0; x < gridSize; ++x)
+		{
+			positions.push_back((float) x); positions.push_back((float) y); positions.push_back(0.0f);
+			normals.push_back(0.0f); normals.push_back(0.0f); normals.push_back(1.0f);
+		}
+	}
+	FCDGeometry* base = AddGridGeometry(data.document, positions, normals);
+	FCDController* controller = data.document->GetControllerLibrary()->AddEntity();
+	data.morph = controller->CreateMorphController();
+	data.morph->SetBaseTarget(base);
+
+	// Each morph target raises a round patch of the grid and tilts its normals.
+	uint32 seed = 12345;
+	FloatList targetPositions, targetNormals;
+	for (size_t t = 0; t < targetCount; ++t)
+	{
+		seed = seed * 1664525 + 1013904223;
+		int32 centerX = (int32) ((seed >> 8) % gridSize), centerY = (int32) ((seed >> 20) % gridSize);
+		float height = 0.5f + (float) (t % 7) * 0.25f;
+		targetPositions.clear(); targetPositions.insert(targetPositions.end(), positions.begin(), positions.end());
+		targetNormals.clear(); targetNormals.insert(targetNormals.end(), normals.begin(), normals.end());
+		for (int32 y = max(0, centerY - (int32) patchRadius); y <= min((int32) gridSize - 1, centerY + (int32) patchRadius); ++y)
+		{
+			for (int32 x = max(0, centerX - (int32) patchRadius); x <= min((int32) gridSize - 1, centerX + (int32) patchRadius); ++x)
+			{
+				float dx = (float) (x - centerX), dy = (float) (y - centerY);
+				float falloff = 1.0f - sqrtf(dx * dx + dy * dy) / (float) patchRadius;
+				if (falloff <= 0.0f) continue;
+				size_t v = y * gridSize + x;
+				targetPositions[3 * v + 2] = height * falloff * falloff;
+				FMVector3 normal = FMVector3(dx, dy, (float) patchRadius).Normalize();
+				targetNormals[3 * v] = normal.m_X; targetNormals[3 * v + 1] = normal.m_Y; targetNormals[3 * v + 2] = normal.m_Z;
+			}
+		}
+		data.morph->AddTarget(AddGridGeometry(data.document, targetPositions, targetNormals), 0.0f);
+	}
+
+	// A quarter of the morph targets are blended.
+	data.weights.resize(targetCount, 0.0f);
+	for (size_t t = 0; t < targetCount; t += 4) data.weights[t] = 0.1f + (float) (t % 9) * 0.1f;
+	data.positions.resize(3 * vertexCount);
+	data.normals.resize(3 * vertexCount);
+}
+
+// A dense loop over the morph target geometries, with the NORMALIZED method.
+static bool MorphDense(void* userData)
+{
+	MorphData* data = (MorphData*) userData;
+	const FCDGeometryMesh* mesh = data->morph->GetParent()->GetBaseGeometry()->GetMesh();
+	const FCDGeometrySource* positionSource = mesh->FindSourceByType(FUDaeGeometryInput::POSITION);
+	const FCDGeometrySource* normalSource = mesh->FindSourceByType(FUDaeGeometryInput::NORMAL);
+	const float* basePositions = positionSource->GetData();
+	const float* baseNormals = normalSource->GetData();
+	size_t valueCount = 3 * positionSource->GetValueCount();
+	memcpy(data->positions.begin(), basePositions, sizeof(float) * valueCount);
+	memcpy(data->normals.begin(), baseNormals, sizeof(float) * valueCount);
+	for (size_t t = 0; t < data->morph->GetTargetCount(); ++t)
+	{
+		float weight = data->weights[t];
+		if (weight == 0.0f) continue;
+		const FCDGeometryMesh* targetMesh = data->morph->GetTarget(t)->GetGeometry()->GetMesh();
+		const float* targetPositions = targetMesh->FindSourceByType(FUDaeGeometryInput::POSITION)->GetData();
+		const float* targetNormals = targetMesh->FindSourceByType(FUDaeGeometryInput::NORMAL)->GetData();
+		for (size_t i = 0; i < valueCount; ++i)
+		{
+			data->positions[i] += weight * (targetPositions[i] - basePositions[i]);
+			data->normals[i] += weight * (targetNormals[i] - baseNormals[i]);
+		}
+	}
+	for (size_t i = 0; i < valueCount; i += 3)
+	{
+		FMVector3 normal = FMVector3(data->normals.begin(), (uint32) i).Normalize();
+		data->normals[i] = normal.m_X; data->normals[i + 1] = normal.m_Y; data->normals[i + 2] = normal.m_Z;
+	}
+	return true;
+}
+
+static bool MorphSerial(void* userData)
+{
+	MorphData* data = (MorphData*) userData;
+	FCollada::SetParallelAnimationFlag(false);
+	return data->deformer.Deform(data->weights.begin(), data->weights.size());
+}
+
+static bool MorphParallel(void* userData)
+{
+	MorphData* data = (MorphData*) userData;
+	FCollada::SetParallelAnimationFlag(true);
+	return data->deformer.Deform(data->weights.begin(), data->weights.size());
+}
+
+bool BenchmarkMorph(const FilenameList& UNUSED(filenames), const BenchmarkOptions& options)
+{
+	MorphData data;
+	BuildMorph(data);
+	double compileStart = GetBenchmarkTime();
+	bool status = data.deformer.Compile(data.morph);
+	double compileSeconds = GetBenchmarkTime() - compileStart;
+
+	fstring name = FC("16384-vertices-256-targets");
+	BenchmarkMeasure denseMeasure, serialMeasure, parallelMeasure;
+	status &= RunMeasured(MorphDense, &data, options.iterations, denseMeasure);
+	status &= RunMeasured(MorphSerial, &data, options.iterations, serialMeasure);
+	status &= RunMeasured(MorphParallel, &data, options.iterations, parallelMeasure);
+
+	// The deformer must match the dense loop.
+	status &= MorphDense(&data) && MorphSerial(&data);
+	for (size_t i = 0; i < data.positions.size() && status; ++i)
+	{
+		status = IsEquivalent(data.positions[i], data.deformer.GetPositions()[i]) && IsEquivalent(data.normals[i], data.deformer.GetNormals()[i]);
+	}
+	size_t activeTargetCount = data.deformer.GetActiveTargetCount();
+	size_t deltaCount = data.deformer.GetPositionDeltaCount();
+	SAFE_RELEASE(data.document);
+	if (!status)
+	{
+		std::cout << "morph: could not measure " << TO_STRING(name).c_str() << std::endl;
+		return false;
+	}
+
+	PrintMeasure("morph", "dense", name, denseMeasure);
+	PrintMeasure("morph", "serial", name, serialMeasure);
+	PrintMeasure("morph", "parallel", name, parallelMeasure);
+
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.2f x dense, %u active targets, %u position differences", "morph", "speedup", TO_STRING(name).c_str(),
+		(parallelMeasure.seconds > 0.0) ? denseMeasure.seconds / parallelMeasure.seconds : 0.0, (uint32) activeTargetCount, (uint32) deltaCount);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.3f ms to compile, on %u threads", "morph", "compile", TO_STRING(name).c_str(),
+		compileSeconds * 1000.0, (uint32) FUThreadPool::GetProcessorCount());
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+	return true;
+}
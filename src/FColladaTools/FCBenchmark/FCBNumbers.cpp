@@ -0,0 +1,135 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Number parsing benchmark: extracts the numeric lists of each document,
+	the <float_array> contents and the <int_array>, <p>, <v> and <vcount> indices,
+	and converts them with the former per-value conversion loop and with
+	the bulk conversion used by FUStringConversion::ToFloatList and ToUInt32List.
+	The throughput is given in megabytes of text per second.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FUtils/FUFile.h"
+
+struct NumberData
+{
+	StringList floatTexts;
+	StringList indexTexts;
+	size_t byteCount;
+	bool bulk;
+};
+
+static bool IsNumericElement(const char* name, size_t length, bool& isFloat)
+{
+	static const char* floatNames[] = { "float_array" };
+	static const char* indexNames[] = { "int_array", "p", "v", "vcount" };
+	for (size_t i = 0; i < sizeof(floatNames) / sizeof(*floatNames); ++i)
+	{
+		if (strlen(floatNames[i]) == length && strncmp(floatNames[i], name, length) == 0) { isFloat = true; return true; }
+	}
+	for (size_t i = 0; i < sizeof(indexNames) / sizeof(*indexNames); ++i)
+	{
+		if (strlen(indexNames[i]) == length && strncmp(indexNames[i], name, length) == 0) { isFloat = false; return true; }
+	}
+	return false;
+}
+
+static bool ExtractNumericLists(const fstring& filename, NumberData& data)
+{
+	FUFile file(filename, FUFile::READ);
+	if (!file.IsOpen()) return false;
+	size_t length = file.GetLength();
+	fm::vector<char> text;
+	text.resize(length + 1);
+	if (!file.Read(text.begin(), length)) return false;
+	text[length] = 0;
+
+	// A simple scan of the start tags is enough for the well-formed test documents.
+	data.byteCount = 0;
+	for (const char* c = strchr(text.begin(), '<'); c != nullptr; c = strchr(c, '<'))
+	{
+		const char* name = ++c;
+		while (*c != 0 && *c != '>' && *c != '/' && *c != ' ' && *c != '\t' && *c != '\r' && *c != '\n') ++c;
+		bool isFloat = false;
+		if (!IsNumericElement(name, c - name, isFloat)) continue;
+
+		while (*c != 0 && *c != '>') ++c;
+		if (*c == 0 || *(c - 1) == '/') continue;
+		const char* contents = ++c;
+		while (*c != 0 && *c != '<') ++c;
+
+		StringList& texts = isFloat ? data.floatTexts : data.indexTexts;
+		texts.push_back(fm::string(contents, c - contents));
+		data.byteCount += c - contents;
+	}
+	return true;
+}
+
+static bool ConvertNumbers(void* userData)
+{
+	NumberData* data = (NumberData*) userData;
+	FloatList floats;
+	UInt32List indices;
+	size_t valueCount = 0;
+	for (const fm::string* it = data->floatTexts.begin(); it != data->floatTexts.end(); ++it)
+	{
+		if (data->bulk) FUStringConversion::ToFloatList(it->c_str(), floats);
+		else
+		{
+			// The former FUStringConversion::ToFloatList implementation.
+			const char* value = it->c_str();
+			floats.clear();
+			floats.reserve(FUStringConversion::CountValues(value));
+			while (*value != 0) floats.push_back(FUStringConversion::ToFloat(&value));
+		}
+		valueCount += floats.size();
+	}
+	for (const fm::string* it = data->indexTexts.begin(); it != data->indexTexts.end(); ++it)
+	{
+		if (data->bulk) FUStringConversion::ToUInt32List(it->c_str(), indices);
+		else
+		{
+			// The former FUStringConversion::ToUInt32List implementation.
+			const char* value = it->c_str();
+			indices.clear();
+			indices.reserve(FUStringConversion::CountValues(value));
+			while (*value != 0) indices.push_back(FUStringConversion::ToUInt32(&value));
+		}
+		valueCount += indices.size();
+	}
+	return valueCount > 0;
+}
+
+bool BenchmarkNumbers(const FilenameList& filenames, const BenchmarkOptions& options)
+{
+	bool status = true;
+	for (const fstring* it = filenames.begin(); it != filenames.end(); ++it)
+	{
+		NumberData data;
+		if (!ExtractNumericLists(*it, data) || data.byteCount == 0)
+		{
+			std::cout << "numbers: no numeric lists in " << TO_STRING(*it).c_str() << std::endl;
+			status = false;
+			continue;
+		}
+
+		BenchmarkMeasure perValueMeasure, bulkMeasure;
+		data.bulk = false;
+		bool perValueStatus = RunMeasured(ConvertNumbers, &data, options.iterations, perValueMeasure);
+		data.bulk = true;
+		bool bulkStatus = RunMeasured(ConvertNumbers, &data, options.iterations, bulkMeasure);
+		if (!perValueStatus || !bulkStatus)
+		{
+			std::cout << "numbers: could not convert " << TO_STRING(*it).c_str() << std::endl;
+			status = false;
+			continue;
+		}
+		PrintThroughput("numbers", "per-value", *it, perValueMeasure, data.byteCount);
+		PrintThroughput("numbers", "bulk", *it, bulkMeasure, data.byteCount);
+	}
+	return status;
+}
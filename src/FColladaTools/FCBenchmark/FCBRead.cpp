@@ -0,0 +1,174 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Read benchmark: generates a large document, with a few meshes of 1.5 million
+	values each, then reads and parses it, along with each document given on the
+	command line. The contents are read through a buffer filled by FUFile::Read,
+	as FUXmlDocument formerly did, and through the file mapped in memory with the
+	READ_MAPPED mode. The read contents are summed up so that all the pages are
+	touched. The parse variants build the XML tree of the document with
+	FUXmlDocument, from the read buffer and from the mapped file. The time and
+	the peak memory are given for each variant, along with the throughput in
+	megabytes per second.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDGeometry.h"
+#include "FCDocument/FCDGeometryMesh.h"
+#include "FCDocument/FCDGeometrySource.h"
+#include "FCDocument/FCDLibrary.h"
+#include "FUtils/FUFile.h"
+
+// The benchmarks are built without the LibXML interface. FUXmlDocument
+// only needs the LibXML types that are declared without it.
+#define HAS_LIBXML
+#include "FUtils/FUXmlDocument.h"
+#undef HAS_LIBXML
+
+#include <cstdio>
+
+static const size_t generatedMeshCount = 8;
+static const size_t generatedValueCount = 1500000;
+
+struct ReadData
+{
+	const fstring* filename;
+	bool mapped;
+};
+
+static uint32 SumContents(const uint8* data, size_t length)
+{
+	uint32 sum = 0;
+	for (size_t i = 0; i < length; ++i) sum += data[i];
+	return sum;
+}
+
+static bool ReadDocument(void* userData)
+{
+	ReadData* data = (ReadData*) userData;
+	static volatile uint32 sum = 0;
+	if (data->mapped)
+	{
+		FUFile file(*data->filename, FUFile::READ_MAPPED);
+		if (!file.IsOpen() || file.GetMappedData() == nullptr) return false;
+		sum += SumContents(file.GetMappedData(), file.GetLength());
+		return true;
+	}
+	else
+	{
+		FUFile file(*data->filename, FUFile::READ);
+		if (!file.IsOpen()) return false;
+		size_t length = file.GetLength();
+		uint8* fileData = new uint8[length];
+		bool read = file.Read(fileData, length);
+		if (read) sum += SumContents(fileData, length);
+		SAFE_DELETE_ARRAY(fileData);
+		return read;
+	}
+}
+
+static bool ParseDocument(void* userData)
+{
+	ReadData* data = (ReadData*) userData;
+	if (data->mapped)
+	{
+		FUXmlDocument document(nullptr, data->filename->c_str(), true);
+		return document.GetRootNode() != nullptr;
+	}
+	else
+	{
+		FUFile file(*data->filename, FUFile::READ);
+		if (!file.IsOpen()) return false;
+		size_t length = file.GetLength();
+		char* fileData = new char[length];
+		bool read = file.Read(fileData, length);
+		file.Close();
+		if (read)
+		{
+			FUXmlDocument document(fileData, length);
+			read = document.GetRootNode() != nullptr;
+		}
+		SAFE_DELETE_ARRAY(fileData);
+		return read;
+	}
+}
+
+static bool GenerateDocument(void* userData)
+{
+	const fstring& filename = *(const fstring*) userData;
+	FCDocument* document = FCollada::NewTopDocument();
+	FloatList values(generatedValueCount, 0.0f);
+	for (size_t i = 0; i < generatedValueCount; ++i) values[i] = 0.123456789f * (float) i;
+	for (size_t i = 0; i < generatedMeshCount; ++i)
+	{
+		FCDGeometry* geometry = document->GetGeometryLibrary()->AddEntity();
+		FCDGeometrySource* source = geometry->CreateMesh()->AddVertexSource(FUDaeGeometryInput::POSITION);
+		source->SetData(values, 3);
+	}
+	bool status = FCollada::SaveDocument(document, filename.c_str());
+	SAFE_RELEASE(document);
+	return status;
+}
+
+static bool MeasureRead(const fstring& filename, const BenchmarkOptions& options)
+{
+	ReadData data;
+	data.filename = &filename;
+
+	size_t byteCount = 0;
+	{
+		FUFile file(filename, FUFile::READ);
+		if (file.IsOpen()) byteCount = file.GetLength();
+	}
+
+	BenchmarkMeasure bufferedMeasure, mappedMeasure, bufferedParseMeasure, mappedParseMeasure;
+	data.mapped = false;
+	bool status = RunMeasured(ReadDocument, &data, options.iterations, bufferedMeasure);
+	status &= RunMeasured(ParseDocument, &data, options.iterations, bufferedParseMeasure);
+	data.mapped = true;
+	status &= RunMeasured(ReadDocument, &data, options.iterations, mappedMeasure);
+	status &= RunMeasured(ParseDocument, &data, options.iterations, mappedParseMeasure);
+	if (!status || byteCount == 0)
+	{
+		std::cout << "read: could not read " << TO_STRING(filename).c_str() << std::endl;
+		return false;
+	}
+	PrintMeasure("read", "buffered", filename, bufferedMeasure);
+	PrintMeasure("read", "mapped", filename, mappedMeasure);
+	PrintMeasure("read", "buffered-parse", filename, bufferedParseMeasure);
+	PrintMeasure("read", "mapped-parse", filename, mappedParseMeasure);
+	PrintThroughput("read", "buffered", filename, bufferedMeasure, byteCount);
+	PrintThroughput("read", "mapped", filename, mappedMeasure, byteCount);
+	PrintThroughput("read", "buffered-parse", filename, bufferedParseMeasure, byteCount);
+	PrintThroughput("read", "mapped-parse", filename, mappedParseMeasure, byteCount);
+	return true;
+}
+
+bool BenchmarkRead(const FilenameList& filenames, const BenchmarkOptions& options)
+{
+	bool status = true;
+	// Generate the document in a child process, so that its memory does not weigh on the measures.
+	fstring generatedFilename = FC("read-generated.dae");
+	BenchmarkMeasure generateMeasure;
+	if (RunMeasured(GenerateDocument, &generatedFilename, 1, generateMeasure))
+	{
+		status &= MeasureRead(generatedFilename, options);
+	}
+	else
+	{
+		std::cout << "read: could not generate " << TO_STRING(generatedFilename).c_str() << std::endl;
+		status = false;
+	}
+	remove(TO_STRING(generatedFilename).c_str());
+
+	for (const fstring* it = filenames.begin(); it != filenames.end(); ++it)
+	{
+		status &= MeasureRead(*it, options);
+	}
+	return status;
+}
@@ -0,0 +1,141 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Key reduction benchmark: builds the baked motion capture of a 300-bone rig,
+	where each bone has three translation and three rotation curves with one
+	linear key per frame, at 30 frames per second over 20 seconds. The motion is
+	a sum of three waves, with a little capture noise. The keys of all the curves
+	are reduced within a tolerance of 0.05, one curve after the other and through
+	the animation library, in parallel. The key counts, the compression ratio and
+	the maximum error are given, along with the time to play back the curves
+	before and after the reduction.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDAnimation.h"
+#include "FCDocument/FCDAnimationChannel.h"
+#include "FCDocument/FCDAnimationCurve.h"
+#include "FCDocument/FCDAnimationCurveTools.h"
+#include "FCDocument/FCDAnimationKey.h"
+#include "FCDocument/FCDLibrary.h"
+#include "FUtils/FUThreadPool.h"
+#include <cstdio>
+
+static const size_t boneCount = 300;
+static const size_t curvesPerBone = 6;
+static const float capturedDuration = 20.0f;
+static const float capturedFrameRate = 30.0f;
+static const float reductionTolerance = 0.05f;
+
+struct ReduceData
+{
+	FCDocument* document;
+	FCDAnimationCurveList curves;
+	size_t frameCount;
+};
+
+static void BuildCapture(ReduceData& data)
+{
+	data.document = FCollada::NewTopDocument();
+	data.curves.clear();
+	FCDAnimation* animation = data.document->GetAnimationLibrary()->AddEntity();
+	size_t keyCount = (size_t) (capturedDuration * capturedFrameRate) + 1;
+	uint32 noise = 12345;
+	for (size_t i = 0; i < boneCount * curvesPerBone; ++i)
+	{
+		// The translations are in centimeters, the rotations in degrees.
+		FCDAnimationCurve* curve = animation->AddChannel()->AddCurve();
+		float amplitude = (i % curvesPerBone < 3) ? 10.0f : 45.0f;
+		float frequency = 0.5f + (float) (i % 11) * 0.1f;
+		curve->ReserveKeys(keyCount, FUDaeInterpolation::LINEAR);
+		for (size_t k = 0; k < keyCount; ++k)
+		{
+			float input = (float) k / capturedFrameRate;
+			noise = noise * 1664525 + 1013904223;
+			FCDAnimationKey* key = curve->AddKey(FUDaeInterpolation::LINEAR);
+			key->input = input;
+			key->output = amplitude * (0.6f * sinf(frequency * input + (float) i) + 0.3f * sinf(2.7f * frequency * input) + 0.1f * sinf(7.1f * frequency * input))
+				+ 0.002f * ((float) (noise >> 16) / 65535.0f - 0.5f);
+		}
+		data.curves.push_back(curve);
+	}
+	data.frameCount = keyCount;
+}
+
+static bool ReduceSerial(void* userData)
+{
+	ReduceData* data = (ReduceData*) userData;
+	FCDAnimationCurveReduction reduction;
+	for (size_t i = 0; i < data->curves.size(); ++i)
+	{
+		FCDAnimationCurveTools::ReduceKeys(data->curves[i], reductionTolerance, &reduction);
+	}
+	return reduction.curveCount == data->curves.size();
+}
+
+static bool ReduceParallel(void* userData)
+{
+	ReduceData* data = (ReduceData*) userData;
+	FCDAnimationCurveReduction reduction;
+	return FCDAnimationCurveTools::ReduceKeys(data->document->GetAnimationLibrary(), reductionTolerance, reduction) == data->curves.size();
+}
+
+static bool PlayBack(void* userData)
+{
+	ReduceData* data = (ReduceData*) userData;
+	float sum = 0.0f;
+	for (size_t i = 0; i < data->curves.size(); ++i)
+	{
+		const FCDAnimationCurve* curve = data->curves[i];
+		size_t keyIndex = 0;
+		for (size_t f = 0; f < data->frameCount; ++f) sum += curve->Evaluate((float) f / capturedFrameRate, keyIndex);
+	}
+	return sum == sum;
+}
+
+bool BenchmarkReduce(const FilenameList& UNUSED(filenames), const BenchmarkOptions& options)
+{
+	// Each reduction modifies its document: measure them once, on their own documents.
+	ReduceData serialData, parallelData, data;
+	BuildCapture(serialData);
+	BuildCapture(parallelData);
+	BuildCapture(data);
+
+	fstring name = FC("300-bones-30fps-20s");
+	BenchmarkMeasure serialMeasure, parallelMeasure, originalMeasure, reducedMeasure;
+	bool status = RunMeasured(ReduceSerial, &serialData, 1, serialMeasure);
+	status &= RunMeasured(ReduceParallel, &parallelData, 1, parallelMeasure);
+	status &= RunMeasured(PlayBack, &data, options.iterations, originalMeasure);
+	FCDAnimationCurveReduction reduction;
+	status &= FCDAnimationCurveTools::ReduceKeys(data.document->GetAnimationLibrary(), reductionTolerance, reduction) == data.curves.size();
+	status &= RunMeasured(PlayBack, &data, options.iterations, reducedMeasure);
+	SAFE_RELEASE(serialData.document);
+	SAFE_RELEASE(parallelData.document);
+	SAFE_RELEASE(data.document);
+	if (!status)
+	{
+		std::cout << "reduce: could not measure " << TO_STRING(name).c_str() << std::endl;
+		return false;
+	}
+
+	PrintMeasure("reduce", "serial", name, serialMeasure);
+	PrintMeasure("reduce", "parallel", name, parallelMeasure);
+	PrintMeasure("reduce", "play-original", name, originalMeasure);
+	PrintMeasure("reduce", "play-reduced", name, reducedMeasure);
+
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10u -> %u keys, %.2f : 1, max error %g (tolerance %g)", "reduce", "keys", TO_STRING(name).c_str(),
+		(uint32) reduction.originalKeyCount, (uint32) reduction.reducedKeyCount, reduction.GetCompressionRatio(), reduction.maximumError, reductionTolerance);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.2f x on %u threads", "reduce", "scaling", TO_STRING(name).c_str(),
+		(parallelMeasure.seconds > 0.0) ? serialMeasure.seconds / parallelMeasure.seconds : 0.0, (uint32) FUThreadPool::GetProcessorCount());
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+	return true;
+}
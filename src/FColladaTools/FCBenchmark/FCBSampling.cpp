@@ -0,0 +1,217 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Animation sampling benchmark: samples 10,000 animation curves at 30 frames
+	per second over 10 minutes, as a baker does: each curve is sampled at all
+	the 18,000 frame times in turn. The curves have one key every two seconds,
+	half of them with linear keys and half of them with Bezier keys. The curves
+	are sampled with one FCDAnimationCurve::Evaluate call per frame, with a
+	FCDAnimationCurveCursor and with the batch evaluation. The curves are then
+	merged four by four into multi-dimensional curves, which are sampled with
+	one call per frame and with the batch evaluation. The results of all the
+	evaluation paths are checked to be identical beforehand.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDAnimation.h"
+#include "FCDocument/FCDAnimationChannel.h"
+#include "FCDocument/FCDAnimationCurve.h"
+#include "FCDocument/FCDAnimationCurveTools.h"
+#include "FCDocument/FCDAnimationKey.h"
+#include "FCDocument/FCDAnimationMultiCurve.h"
+#include "FCDocument/FCDLibrary.h"
+#include <cstdio>
+
+static const size_t sampledCurveCount = 10000;
+static const size_t mergedDimension = 4;
+static const float sampledDuration = 600.0f;
+static const float sampledFrameRate = 30.0f;
+static const float sampledKeyInterval = 2.0f;
+
+struct SamplingData
+{
+	FCDAnimationCurveList curves;
+	fm::pvector<FCDAnimationMultiCurve> multiCurves;
+	FloatList frames;
+	FloatList outputs;
+};
+
+static void BuildSampledCurves(FCDocument* document, SamplingData& data)
+{
+	FCDAnimation* animation = document->GetAnimationLibrary()->AddEntity();
+	size_t keyCount = (size_t) (sampledDuration / sampledKeyInterval) + 1;
+	for (size_t i = 0; i < sampledCurveCount; ++i)
+	{
+		// Alternate the linear and the Bezier curves.
+		FCDAnimationCurve* curve = animation->AddChannel()->AddCurve();
+		bool isBezier = (i & 1) != 0;
+		curve->ReserveKeys(keyCount, isBezier ? FUDaeInterpolation::BEZIER : FUDaeInterpolation::LINEAR);
+		for (size_t k = 0; k < keyCount; ++k)
+		{
+			float input = (float) k * sampledKeyInterval;
+			FCDAnimationKey* key = curve->AddKey(isBezier ? FUDaeInterpolation::BEZIER : FUDaeInterpolation::LINEAR);
+			key->input = input;
+			key->output = (float) ((i + k * 7) % 101);
+			if (isBezier)
+			{
+				FCDAnimationKeyBezier* bkey = (FCDAnimationKeyBezier*) key;
+				bkey->inTangent = FMVector2(input - sampledKeyInterval / 3.0f, key->output);
+				bkey->outTangent = FMVector2(input + sampledKeyInterval / 3.0f, key->output);
+			}
+		}
+		data.curves.push_back(curve);
+	}
+
+	// Merge the curves four by four.
+	FloatList defaultValues(mergedDimension, 0.0f);
+	for (size_t i = 0; i + mergedDimension <= sampledCurveCount; i += mergedDimension)
+	{
+		FCDAnimationCurveList toMerge;
+		for (size_t d = 0; d < mergedDimension; ++d) toMerge.push_back(data.curves[i + d]);
+		data.multiCurves.push_back(FCDAnimationCurveTools::MergeCurves(toMerge, defaultValues));
+	}
+
+	size_t frameCount = (size_t) (sampledDuration * sampledFrameRate);
+	data.frames.reserve(frameCount);
+	for (size_t f = 0; f < frameCount; ++f) data.frames.push_back((float) f / sampledFrameRate);
+	data.outputs.resize(frameCount * mergedDimension);
+}
+
+static bool SampleByCall(void* userData)
+{
+	SamplingData* data = (SamplingData*) userData;
+	size_t frameCount = data->frames.size();
+	for (size_t i = 0; i < data->curves.size(); ++i)
+	{
+		const FCDAnimationCurve* curve = data->curves[i];
+		for (size_t f = 0; f < frameCount; ++f) data->outputs[f] = curve->Evaluate(data->frames[f]);
+	}
+	return true;
+}
+
+static bool SampleByCursor(void* userData)
+{
+	SamplingData* data = (SamplingData*) userData;
+	size_t frameCount = data->frames.size();
+	for (size_t i = 0; i < data->curves.size(); ++i)
+	{
+		FCDAnimationCurveCursor cursor(data->curves[i]);
+		for (size_t f = 0; f < frameCount; ++f) data->outputs[f] = cursor.Evaluate(data->frames[f]);
+	}
+	return true;
+}
+
+static bool SampleByBatch(void* userData)
+{
+	SamplingData* data = (SamplingData*) userData;
+	for (size_t i = 0; i < data->curves.size(); ++i)
+	{
+		data->curves[i]->Evaluate(data->frames.begin(), data->frames.size(), data->outputs.begin());
+	}
+	return true;
+}
+
+static bool SampleMultiByCall(void* userData)
+{
+	SamplingData* data = (SamplingData*) userData;
+	size_t frameCount = data->frames.size();
+	for (size_t i = 0; i < data->multiCurves.size(); ++i)
+	{
+		const FCDAnimationMultiCurve* curve = data->multiCurves[i];
+		for (size_t f = 0; f < frameCount; ++f) curve->Evaluate(data->frames[f], data->outputs.begin() + f * mergedDimension);
+	}
+	return true;
+}
+
+static bool SampleMultiByBatch(void* userData)
+{
+	SamplingData* data = (SamplingData*) userData;
+	for (size_t i = 0; i < data->multiCurves.size(); ++i)
+	{
+		data->multiCurves[i]->Evaluate(data->frames.begin(), data->frames.size(), data->outputs.begin());
+	}
+	return true;
+}
+
+// Checks that the cursor and the batch evaluations give the same values as the single evaluations.
+static bool CheckSampling(SamplingData& data)
+{
+	size_t frameCount = data.frames.size();
+	FloatList expected(frameCount * mergedDimension, 0.0f);
+	for (size_t i = 0; i < data.curves.size(); i += 97)
+	{
+		const FCDAnimationCurve* curve = data.curves[i];
+		FCDAnimationCurveCursor cursor(curve);
+		curve->Evaluate(data.frames.begin(), frameCount, data.outputs.begin());
+		for (size_t f = 0; f < frameCount; ++f)
+		{
+			float value = curve->Evaluate(data.frames[f]);
+			if (value != data.outputs[f] || value != cursor.Evaluate(data.frames[f])) return false;
+		}
+	}
+	for (size_t i = 0; i < data.multiCurves.size(); i += 31)
+	{
+		const FCDAnimationMultiCurve* curve = data.multiCurves[i];
+		curve->Evaluate(data.frames.begin(), frameCount, data.outputs.begin());
+		for (size_t f = 0; f < frameCount; ++f) curve->Evaluate(data.frames[f], expected.begin() + f * mergedDimension);
+		if (memcmp(expected.begin(), data.outputs.begin(), frameCount * mergedDimension * sizeof(float)) != 0) return false;
+	}
+	return true;
+}
+
+static void PrintRate(const char* variant, const fstring& name, const BenchmarkMeasure& measure, size_t count)
+{
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.3f M/s", "sampling", variant, TO_STRING(name).c_str(),
+		(measure.seconds > 0.0) ? count / measure.seconds / 1e6 : 0.0);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+}
+
+bool BenchmarkSampling(const FilenameList& UNUSED(filenames), const BenchmarkOptions& options)
+{
+	FCDocument* document = FCollada::NewTopDocument();
+	SamplingData data;
+	BuildSampledCurves(document, data);
+	bool status = CheckSampling(data);
+	if (!status)
+	{
+		std::cout << "sampling: the cursor or the batch evaluation differs from the single evaluation." << std::endl;
+	}
+
+	fstring name = FC("10k-curves-30fps-10min");
+	fstring multiName = FC("2500x4-curves-30fps-10min");
+	size_t sampleCount = data.curves.size() * data.frames.size();
+	size_t multiSampleCount = data.multiCurves.size() * data.frames.size();
+	BenchmarkMeasure callMeasure, cursorMeasure, batchMeasure, multiCallMeasure, multiBatchMeasure;
+	status &= RunMeasured(SampleByCall, &data, options.iterations, callMeasure);
+	status &= RunMeasured(SampleByCursor, &data, options.iterations, cursorMeasure);
+	status &= RunMeasured(SampleByBatch, &data, options.iterations, batchMeasure);
+	status &= RunMeasured(SampleMultiByCall, &data, options.iterations, multiCallMeasure);
+	status &= RunMeasured(SampleMultiByBatch, &data, options.iterations, multiBatchMeasure);
+
+	for (size_t i = 0; i < data.multiCurves.size(); ++i) SAFE_RELEASE(data.multiCurves[i]);
+	SAFE_RELEASE(document);
+	if (!status)
+	{
+		std::cout << "sampling: could not measure " << TO_STRING(name).c_str() << std::endl;
+		return false;
+	}
+
+	PrintMeasure("sampling", "call", name, callMeasure);
+	PrintMeasure("sampling", "cursor", name, cursorMeasure);
+	PrintMeasure("sampling", "batch", name, batchMeasure);
+	PrintRate("call", name, callMeasure, sampleCount);
+	PrintRate("cursor", name, cursorMeasure, sampleCount);
+	PrintRate("batch", name, batchMeasure, sampleCount);
+	PrintMeasure("sampling", "multi-call", multiName, multiCallMeasure);
+	PrintMeasure("sampling", "multi-batch", multiName, multiBatchMeasure);
+	PrintRate("multi-call", multiName, multiCallMeasure, multiSampleCount);
+	PrintRate("multi-batch", multiName, multiBatchMeasure, multiSampleCount);
+	return true;
+}
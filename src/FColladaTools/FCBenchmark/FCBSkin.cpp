@@ -0,0 +1,222 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Skinning benchmark: builds a cylinder of 204,800 vertices, with one normal
+	per vertex, skinned to a chain of 64 joints with four influences per vertex.
+	The chain is bent and the cylinder is deformed through the former loop over
+	the vertex influences of the skin controller, and through the skin deformer
+	on the calling thread and on its pool of worker threads. The deformation
+	throughputs are given in millions of vertices per second.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDController.h"
+#include "FCDocument/FCDGeometry.h"
+#include "FCDocument/FCDGeometryMesh.h"
+#include "FCDocument/FCDGeometryPolygons.h"
+#include "FCDocument/FCDGeometryPolygonsInput.h"
+#include "FCDocument/FCDGeometrySource.h"
+#include "FCDocument/FCDLibrary.h"
+#include "FCDocument/FCDSkinController.h"
+#include "FCDocument/FCDSkinDeformer.h"
+#include "FUtils/FUThreadPool.h"
+#include <cstdio>
+
+static const size_t ringCount = 512;
+static const size_t ringVertexCount = 400;
+static const size_t jointCount = 64;
+static const size_t influencesPerVertex = 4;
+static const float cylinderHeight = 64.0f;
+
+struct SkinData
+{
+	FCDocument* document;
+	FCDSkinController* skin;
+	FCDSkinDeformer deformer;
+	FMMatrix44List jointWorldTransforms;
+	FloatList positions;
+	FloatList normals;
+};
+
+static void BuildSkin(SkinData& data)
+{
+	data.document = FCollada::NewTopDocument();
+	FCDGeometry* geometry = data.document->GetGeometryLibrary()->AddEntity();
+	FCDGeometryMesh* mesh = geometry->CreateMesh();
+
+	// The cylinder, along the Y axis.
+	size_t vertexCount = ringCount * ringVertexCount;
+	FloatList positions, normals;
+	positions.reserve(3 * vertexCount);
+	normals.reserve(3 * vertexCount);
+	for (size_t r = 0; r < ringCount; ++r)
+	{
+		float y = cylinderHeight * (float) r / (float) (ringCount - 1);
+		for (size_t c = 0; c < ringVertexCount; ++c)
+		{
+			float angle = 2.0f * (float) FMath::Pi * (float) c / (float) ringVertexCount;
+			positions.push_back(cosf(angle)); positions.push_back(y); positions.push_back(sinf(angle));
+			normals.push_back(cosf(angle)); normals.push_back(0.0f); normals.push_back(sinf(angle));
+		}
+	}
+	FCDGeometrySource* positionSource = mesh->AddVertexSource(FUDaeGeometryInput::POSITION);
+	positionSource->SetData(positions, 3);
+	FCDGeometrySource* normalSource = mesh->AddSource(FUDaeGeometryInput::NORMAL);
+	normalSource->SetData(normals, 3);
+
+	// Two triangles per quad of the cylinder, with the same position and normal indices.
+	UInt32List indices;
+	indices.reserve(6 * (ringCount - 1) * ringVertexCount);
+	for (size_t r = 0; r + 1 < ringCount; ++r)
+	{
+		for (size_t c = 0; c < ringVertexCount; ++c)
+		{
+			uint32 v0 = (uint32) (r * ringVertexCount + c), v1 = (uint32) (r * ringVertexCount + (c + 1) % ringVertexCount);
+			uint32 v2 = v0 + (uint32) ringVertexCount, v3 = v1 + (uint32) ringVertexCount;
+			indices.push_back(v0); indices.push_back(v2); indices.push_back(v1);
+			indices.push_back(v1); indices.push_back(v2); indices.push_back(v3);
+		}
+	}
+	FCDGeometryPolygons* polygons = mesh->AddPolygons();
+	polygons->AddInput(normalSource, 1);
+	for (size_t f = 0; f < indices.size() / 3; ++f) polygons->AddFaceVertexCount(3);
+	polygons->FindInput(positionSource)->SetIndices(indices.begin(), indices.size());
+	polygons->FindInput(normalSource)->SetIndices(indices.begin(), indices.size());
+
+	// The joints, evenly spaced along the cylinder, and bent around the Z axis.
+	FCDController* controller = data.document->GetControllerLibrary()->AddEntity();
+	data.skin = controller->CreateSkinController();
+	data.skin->SetTarget(geometry);
+	float jointLength = cylinderHeight / (float) jointCount;
+	FMMatrix44 world = FMMatrix44::Identity;
+	data.jointWorldTransforms.clear();
+	for (size_t j = 0; j < jointCount; ++j)
+	{
+		FMMatrix44 bind = FMMatrix44::TranslationMatrix(FMVector3(0.0f, jointLength * (float) j, 0.0f));
+		data.skin->AddJoint("joint", bind.Inverted());
+		FMMatrix44 local = FMMatrix44::TranslationMatrix(FMVector3(0.0f, (j > 0) ? jointLength : 0.0f, 0.0f)) * FMMatrix44::ZAxisRotationMatrix(0.02f);
+		world = world * local;
+		data.jointWorldTransforms.push_back(world);
+	}
+
+	// Four influences per vertex, on the closest joints.
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		float position = positions[3 * v + 1] / jointLength;
+		size_t first = (size_t) max(0.0f, position - 1.5f);
+		first = min(first, jointCount - influencesPerVertex);
+		FCDSkinControllerVertex* vertex = data.skin->GetVertexInfluence(v);
+		float weights[influencesPerVertex], total = 0.0f;
+		for (size_t i = 0; i < influencesPerVertex; ++i)
+		{
+			weights[i] = 1.0f / (1.0f + fabsf(position - (float) (first + i)));
+			total += weights[i];
+		}
+		for (size_t i = 0; i < influencesPerVertex; ++i) vertex->AddPair((int32) (first + i), weights[i] / total);
+	}
+	data.positions.resize(3 * vertexCount);
+	data.normals.resize(3 * vertexCount);
+}
+
+// The former loop over the vertex influences, with the normal indices matching the position indices.
+static bool SkinFormer(void* userData)
+{
+	SkinData* data = (SkinData*) userData;
+	const FCDSkinController* skin = data->skin;
+	const FCDGeometryMesh* mesh = ((const FCDController*) skin->GetParent())->GetBaseGeometry()->GetMesh();
+	const float* positions = mesh->FindSourceByType(FUDaeGeometryInput::POSITION)->GetData();
+	const float* normals = mesh->FindSourceByType(FUDaeGeometryInput::NORMAL)->GetData();
+	FMMatrix44List skinning;
+	for (size_t j = 0; j < skin->GetJointCount(); ++j)
+	{
+		skinning.push_back(data->jointWorldTransforms[j] * skin->GetJoint(j)->GetBindPoseInverse() * skin->GetBindShapeTransform());
+	}
+	size_t vertexCount = skin->GetInfluenceCount();
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		FMVector3 position(positions, (uint32) (3 * v)), normal(normals, (uint32) (3 * v));
+		FMVector3 skinnedPosition = FMVector3::Zero, skinnedNormal = FMVector3::Zero;
+		const FCDSkinControllerVertex* vertex = skin->GetVertexInfluence(v);
+		for (size_t p = 0; p < vertex->GetPairCount(); ++p)
+		{
+			const FCDJointWeightPair* pair = vertex->GetPair(p);
+			skinnedPosition += skinning[pair->jointIndex].TransformCoordinate(position) * pair->weight;
+			skinnedNormal += skinning[pair->jointIndex].TransformVector(normal) * pair->weight;
+		}
+		skinnedNormal.NormalizeIt();
+		data->positions[3 * v] = skinnedPosition.m_X; data->positions[3 * v + 1] = skinnedPosition.m_Y; data->positions[3 * v + 2] = skinnedPosition.m_Z;
+		data->normals[3 * v] = skinnedNormal.m_X; data->normals[3 * v + 1] = skinnedNormal.m_Y; data->normals[3 * v + 2] = skinnedNormal.m_Z;
+	}
+	return true;
+}
+
+static bool SkinSerial(void* userData)
+{
+	SkinData* data = (SkinData*) userData;
+	FCollada::SetParallelAnimationFlag(false);
+	return data->deformer.Deform(data->jointWorldTransforms.begin(), data->jointWorldTransforms.size());
+}
+
+static bool SkinParallel(void* userData)
+{
+	SkinData* data = (SkinData*) userData;
+	FCollada::SetParallelAnimationFlag(true);
+	return data->deformer.Deform(data->jointWorldTransforms.begin(), data->jointWorldTransforms.size());
+}
+
+static void PrintVertexThroughput(const char* variant, const fstring& name, const BenchmarkMeasure& measure, size_t vertexCount)
+{
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.1f M vertices/s", "skin", variant, TO_STRING(name).c_str(),
+		(measure.seconds > 0.0) ? (double) vertexCount / measure.seconds / 1000000.0 : 0.0);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+}
+
+bool BenchmarkSkin(const FilenameList& UNUSED(filenames), const BenchmarkOptions& options)
+{
+	SkinData data;
+	BuildSkin(data);
+	double compileStart = GetBenchmarkTime();
+	bool status = data.deformer.Compile(data.skin);
+	double compileSeconds = GetBenchmarkTime() - compileStart;
+
+	fstring name = FC("204800-vertices-64-joints");
+	BenchmarkMeasure formerMeasure, serialMeasure, parallelMeasure;
+	status &= RunMeasured(SkinFormer, &data, options.iterations, formerMeasure);
+	status &= RunMeasured(SkinSerial, &data, options.iterations, serialMeasure);
+	status &= RunMeasured(SkinParallel, &data, options.iterations, parallelMeasure);
+
+	// The deformer must match the former loop.
+	status &= SkinFormer(&data) && SkinSerial(&data);
+	for (size_t i = 0; i < data.positions.size() && status; ++i)
+	{
+		status = IsEquivalent(data.positions[i], data.deformer.GetPositions()[i]) && IsEquivalent(data.normals[i], data.deformer.GetNormals()[i]);
+	}
+	size_t vertexCount = data.deformer.GetVertexCount();
+	SAFE_RELEASE(data.document);
+	if (!status)
+	{
+		std::cout << "skin: could not measure " << TO_STRING(name).c_str() << std::endl;
+		return false;
+	}
+
+	PrintMeasure("skin", "former", name, formerMeasure);
+	PrintMeasure("skin", "serial", name, serialMeasure);
+	PrintMeasure("skin", "parallel", name, parallelMeasure);
+	PrintVertexThroughput("former", name, formerMeasure, vertexCount);
+	PrintVertexThroughput("serial", name, serialMeasure, vertexCount);
+	PrintVertexThroughput("parallel", name, parallelMeasure, vertexCount);
+
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.3f ms to compile, on %u threads", "skin", "compile", TO_STRING(name).c_str(),
+		compileSeconds * 1000.0, (uint32) FUThreadPool::GetProcessorCount());
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+	return true;
+}
@@ -0,0 +1,343 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Unique indices benchmark: builds a grid of 65,536 positions, split into
+	four polygons sets of triangles, with one normal per quad and one texture
+	coordinate per position, each input with its own indices. The unique index
+	buffers and the translation maps of the grid, and of the meshes of each
+	document given on the command line, are generated through the former
+	implementation, through the current one, and into translation tables.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDGeometry.h"
+#include "FCDocument/FCDGeometryMesh.h"
+#include "FCDocument/FCDGeometryPolygons.h"
+#include "FCDocument/FCDGeometryPolygonsInput.h"
+#include "FCDocument/FCDGeometryPolygonsTools.h"
+#include "FCDocument/FCDGeometrySource.h"
+#include "FCDocument/FCDLibrary.h"
+#include "FUtils/FUThreadPool.h"
+#include <cstdio>
+
+static const size_t gridSize = 256;
+static const size_t gridPolygonsCount = 4;
+
+typedef fm::pvector<FCDGeometryMesh> MeshList;
+
+// The former implementation, with a sorted map from the hash values to the unique vertices.
+namespace FormerUniqueIndices
+{
+	struct HashIndexMapItem { UInt32List allValues; UInt32List newIndex; };
+	typedef fm::pvector<FCDGeometryPolygonsInput> InputList;
+	typedef fm::map<uint32, HashIndexMapItem> HashIndexMap;
+
+	static void GenerateUniqueIndices(FCDGeometryMesh* mesh, FCDNewIndicesList& outIndices, FCDGeometryIndexTranslationMapList& outTranslationMaps)
+	{
+		size_t polygonsCount = mesh->GetPolygonsCount();
+		if (polygonsCount == 0) return;
+		size_t totalVertexCount = 0;
+		if (outIndices.size() < polygonsCount) outIndices.resize(polygonsCount);
+
+		for (size_t p = 0; p < polygonsCount; ++p)
+		{
+			FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
+			if (polygons->GetPrimitiveType() == FCDGeometryPolygons::POINTS) return;
+			UInt32List& outPolyIndices = outIndices[p];
+
+			InputList idxOwners;
+			size_t inputCount = polygons->GetInputCount();
+			for (size_t i = 0; i < inputCount; ++i)
+			{
+				if (polygons->GetInput(i)->OwnsIndices())
+				{
+					FUAssert(idxOwners.empty() || idxOwners.front()->GetIndexCount() == polygons->GetInput(i)->GetIndexCount(), continue);
+					if (idxOwners.find(polygons->GetInput(i)) == idxOwners.end()) idxOwners.push_back(polygons->GetInput(i));
+				}
+			}
+			size_t listCount = idxOwners.size();
+			if (listCount == 0) continue;
+
+			UInt32List hashingFunction;
+			uint32 hashSize = (uint32) listCount;
+			hashingFunction.reserve(hashSize);
+			for (uint32 h = 0; h < hashSize; ++h) hashingFunction.push_back(32 * h / hashSize);
+
+			HashIndexMap hashMap;
+			size_t originalIndexCount = idxOwners.front()->GetIndexCount();
+			outPolyIndices.reserve(originalIndexCount);
+			uint32** indices = new uint32*[listCount];
+			for (size_t l = 0; l < listCount; ++l) indices[l] = idxOwners[l]->GetIndices();
+			for (size_t i = 0; i < originalIndexCount; ++i)
+			{
+				uint32 hashValue = 0;
+				for (size_t l = 0; l < listCount; ++l) hashValue ^= (indices[l][i]) << hashingFunction[l];
+
+				HashIndexMap::iterator it = hashMap.find(hashValue);
+				HashIndexMapItem* hashItem;
+				uint32 newIndex = (uint32) totalVertexCount;
+				if (it != hashMap.end())
+				{
+					hashItem = &((*it).second);
+					size_t repeatCount = hashItem->allValues.size() / listCount;
+					for (size_t r = 0; r < repeatCount && newIndex == totalVertexCount; ++r)
+					{
+						size_t l;
+						for (l = 0; l < listCount; ++l)
+						{
+							if (indices[l][i] != hashItem->allValues[r * listCount + l]) break;
+						}
+						if (l == listCount) newIndex = hashItem->newIndex[r];
+					}
+				}
+				else
+				{
+					HashIndexMap::iterator k = hashMap.insert(hashValue, HashIndexMapItem());
+					hashItem = &k->second;
+					hashItem->allValues.reserve(listCount);
+				}
+
+				if (newIndex == totalVertexCount)
+				{
+					for (size_t l = 0; l < listCount; ++l) hashItem->allValues.push_back(indices[l][i]);
+					hashItem->newIndex.push_back(newIndex);
+					totalVertexCount++;
+				}
+				outPolyIndices.push_back(newIndex);
+			}
+			SAFE_DELETE_ARRAY(indices);
+		}
+
+		size_t meshSourceCount = mesh->GetSourceCount();
+		if (outTranslationMaps.size() < meshSourceCount) outTranslationMaps.resize(meshSourceCount);
+		for (size_t d = 0; d < meshSourceCount; ++d)
+		{
+			FCDGeometrySource* oldSource = mesh->GetSource(d);
+			FCDGeometryIndexTranslationMap* thisMap = new FCDGeometryIndexTranslationMap();
+			outTranslationMaps[d] = thisMap;
+			for (size_t p = 0; p < polygonsCount; ++p)
+			{
+				FCDGeometryPolygons* polygons = mesh->GetPolygons(p);
+				const UInt32List& outPolyIndices = outIndices[p];
+				FCDGeometryPolygonsInput* oldInput = polygons->FindInput(oldSource);
+				if (oldInput == nullptr) continue;
+				uint32* oldIndexList = oldInput->GetIndices();
+				size_t oldIndexCount = oldInput->GetIndexCount();
+				if (oldIndexList == nullptr || oldIndexCount == 0) continue;
+
+				size_t indexCount = min(oldIndexCount, outPolyIndices.size());
+				for (size_t i = 0; i < indexCount; ++i)
+				{
+					uint32 newIndex = outPolyIndices[i];
+					uint32 oldIndex = oldIndexList[i];
+					if (oldIndex >= oldSource->GetValueCount()) continue;
+					FCDGeometryIndexTranslationMap::iterator itU = thisMap->find(oldIndex);
+					if (itU == thisMap->end()) { itU = thisMap->insert(oldIndex, UInt32List()); }
+					UInt32List::iterator itF = itU->second.find(newIndex);
+					if (itF == itU->second.end()) itU->second.push_back(newIndex);
+				}
+			}
+		}
+	}
+};
+
+static void BuildGrid(FCDocument* document, MeshList& meshes)
+{
+	FCDGeometry* geometry = document->GetGeometryLibrary()->AddEntity();
+	FCDGeometryMesh* mesh = geometry->CreateMesh();
+	meshes.push_back(mesh);
+
+	size_t vertexCount = gridSize * gridSize, quadCount = (gridSize - 1) * (gridSize - 1);
+	FloatList positions, normals, texcoords;
+	positions.reserve(3 * vertexCount);
+	texcoords.reserve(2 * vertexCount);
+	for (size_t y = 0; y < gridSize; ++y)
+	{
+		for (size_t x = 0; x < gridSize; ++x)
+		{
+			float height = 0.1f * sinf(0.05f * (float) (x * y));
+			positions.push_back((float) x); positions.push_back((float) y); positions.push_back(height);
+			texcoords.push_back((float) x / (float) gridSize); texcoords.push_back((float) y / (float) gridSize);
+		}
+	}
+	normals.reserve(3 * quadCount);
+	for (size_t q = 0; q < quadCount; ++q)
+	{
+		FMVector3 normal = FMVector3(0.01f * (float) (q % 17), 0.01f * (float) (q % 13), 1.0f).Normalize();
+		normals.push_back(normal.m_X); normals.push_back(normal.m_Y); normals.push_back(normal.m_Z);
+	}
+	FCDGeometrySource* positionSource = mesh->AddVertexSource(FUDaeGeometryInput::POSITION);
+	positionSource->SetData(positions, 3);
+	FCDGeometrySource* normalSource = mesh->AddSource(FUDaeGeometryInput::NORMAL);
+	normalSource->SetData(normals, 3);
+	FCDGeometrySource* texcoordSource = mesh->AddSource(FUDaeGeometryInput::TEXCOORD);
+	texcoordSource->SetData(texcoords, 2);
+
+	// Two triangles per quad, in bands of rows.
+	size_t bandSize = (gridSize - 1 + gridPolygonsCount - 1) / gridPolygonsCount;
+	for (size_t b = 0; b < gridPolygonsCount; ++b)
+	{
+		UInt32List positionIndices, normalIndices;
+		positionIndices.reserve(6 * bandSize * (gridSize - 1));
+		normalIndices.reserve(6 * bandSize * (gridSize - 1));
+		for (size_t y = b * bandSize; y < min((b + 1) * bandSize, gridSize - 1); ++y)
+		{
+			for (size_t x = 0; x + 1 < gridSize; ++x)
+			{
+				uint32 v0 = (uint32) (y * gridSize + x), v1 = v0 + 1, v2 = v0 + (uint32) gridSize, v3 = v2 + 1;
+				uint32 q = (uint32) (y * (gridSize - 1) + x);
+				positionIndices.push_back(v0); positionIndices.push_back(v2); positionIndices.push_back(v1);
+				positionIndices.push_back(v1); positionIndices.push_back(v2); positionIndices.push_back(v3);
+				normalIndices.resize(normalIndices.size() + 6, q);
+			}
+		}
+		FCDGeometryPolygons* polygons = mesh->AddPolygons();
+		polygons->AddInput(normalSource, 1);
+		polygons->AddInput(texcoordSource, 2);
+		for (size_t f = 0; f < positionIndices.size() / 3; ++f) polygons->AddFaceVertexCount(3);
+		polygons->FindInput(positionSource)->SetIndices(positionIndices.begin(), positionIndices.size());
+		polygons->FindInput(normalSource)->SetIndices(normalIndices.begin(), normalIndices.size());
+		polygons->FindInput(texcoordSource)->SetIndices(positionIndices.begin(), positionIndices.size());
+	}
+	mesh->Recalculate();
+}
+
+static void ListMeshes(FCDocument* document, MeshList& meshes)
+{
+	FCDGeometryLibrary* library = document->GetGeometryLibrary();
+	for (size_t i = 0; i < library->GetEntityCount(); ++i)
+	{
+		FCDGeometry* geometry = library->GetEntity(i);
+		if (geometry->IsMesh()) meshes.push_back(geometry->GetMesh());
+	}
+}
+
+static bool GenerateFormer(void* userData)
+{
+	MeshList& meshes = *(MeshList*) userData;
+	for (FCDGeometryMesh** it = meshes.begin(); it != meshes.end(); ++it)
+	{
+		FCDNewIndicesList indices;
+		FCDGeometryIndexTranslationMapList translationMaps;
+		FormerUniqueIndices::GenerateUniqueIndices(*it, indices, translationMaps);
+		CLEAR_POINTER_VECTOR(translationMaps);
+	}
+	return true;
+}
+
+static bool GenerateMaps(void* userData)
+{
+	MeshList& meshes = *(MeshList*) userData;
+	for (FCDGeometryMesh** it = meshes.begin(); it != meshes.end(); ++it)
+	{
+		FCDNewIndicesList indices;
+		FCDGeometryIndexTranslationMapList translationMaps;
+		FCDGeometryPolygonsTools::GenerateUniqueIndices(*it, nullptr, indices, translationMaps);
+		CLEAR_POINTER_VECTOR(translationMaps);
+	}
+	return true;
+}
+
+static bool GenerateTables(void* userData)
+{
+	MeshList& meshes = *(MeshList*) userData;
+	for (FCDGeometryMesh** it = meshes.begin(); it != meshes.end(); ++it)
+	{
+		FCDNewIndicesList indices;
+		FCDGeometryIndexTranslationTableList translationTables;
+		FCDGeometryPolygonsTools::GenerateUniqueIndices(*it, nullptr, indices, translationTables);
+	}
+	return true;
+}
+
+// The current implementation must generate the same indices and translation maps as the former one.
+static bool VerifyMeshes(MeshList& meshes, size_t& vertexCount)
+{
+	vertexCount = 0;
+	bool status = true;
+	for (FCDGeometryMesh** it = meshes.begin(); it != meshes.end() && status; ++it)
+	{
+		FCDNewIndicesList formerIndices, indices;
+		FCDGeometryIndexTranslationMapList formerMaps, maps;
+		FormerUniqueIndices::GenerateUniqueIndices(*it, formerIndices, formerMaps);
+		FCDGeometryPolygonsTools::GenerateUniqueIndices(*it, nullptr, indices, maps);
+		status = formerIndices.size() == indices.size() && formerMaps.size() == maps.size();
+		for (size_t p = 0; p < indices.size() && status; ++p)
+		{
+			status = formerIndices[p] == indices[p];
+			for (size_t i = 0; i < indices[p].size(); ++i) vertexCount = max(vertexCount, (size_t) indices[p][i] + 1);
+		}
+		for (size_t d = 0; d < maps.size() && status; ++d)
+		{
+			status = formerMaps[d]->size() == maps[d]->size();
+			for (FCDGeometryIndexTranslationMap::iterator itF = formerMaps[d]->begin(), itN = maps[d]->begin(); itF != formerMaps[d]->end() && status; ++itF, ++itN)
+			{
+				status = itF->first == itN->first && itF->second == itN->second;
+			}
+		}
+		CLEAR_POINTER_VECTOR(formerMaps);
+		CLEAR_POINTER_VECTOR(maps);
+	}
+	return status;
+}
+
+static bool MeasureUnique(MeshList& meshes, const fstring& name, const BenchmarkOptions& options)
+{
+	size_t faceVertexCount = 0, vertexCount = 0;
+	for (FCDGeometryMesh** it = meshes.begin(); it != meshes.end(); ++it) faceVertexCount += (*it)->GetFaceVertexCount();
+
+	BenchmarkMeasure formerMeasure, mapsMeasure, tablesMeasure;
+	bool status = RunMeasured(GenerateFormer, &meshes, options.iterations, formerMeasure);
+	status &= RunMeasured(GenerateMaps, &meshes, options.iterations, mapsMeasure);
+	status &= RunMeasured(GenerateTables, &meshes, options.iterations, tablesMeasure);
+	status &= VerifyMeshes(meshes, vertexCount);
+	if (!status)
+	{
+		std::cout << "unique: could not measure " << TO_STRING(name).c_str() << std::endl;
+		return false;
+	}
+
+	PrintMeasure("unique", "former", name, formerMeasure);
+	PrintMeasure("unique", "maps", name, mapsMeasure);
+	PrintMeasure("unique", "tables", name, tablesMeasure);
+
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.2f x former, %u face-vertex pairs, %u unique vertices, on %u threads", "unique", "speedup", TO_STRING(name).c_str(),
+		(tablesMeasure.seconds > 0.0) ? formerMeasure.seconds / tablesMeasure.seconds : 0.0, (uint32) faceVertexCount, (uint32) vertexCount, (uint32) FUThreadPool::GetProcessorCount());
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+	return true;
+}
+
+bool BenchmarkUnique(const FilenameList& filenames, const BenchmarkOptions& options)
+{
+	FCDocument* document = FCollada::NewTopDocument();
+	MeshList meshes;
+	BuildGrid(document, meshes);
+	bool status = MeasureUnique(meshes, FC("65536-positions-4-sets"), options);
+	SAFE_RELEASE(document);
+
+	for (const fstring* it = filenames.begin(); it != filenames.end(); ++it)
+	{
+		FUErrorSimpleHandler errorHandler;
+		document = FCollada::NewTopDocument();
+		if (!FCollada::LoadDocumentFromFile(document, it->c_str()) || !errorHandler.IsSuccessful())
+		{
+			std::cout << "unique: could not load " << TO_STRING(*it).c_str() << std::endl;
+			status = false;
+		}
+		else
+		{
+			meshes.clear();
+			ListMeshes(document, meshes);
+			status &= MeasureUnique(meshes, *it, options);
+		}
+		SAFE_RELEASE(document);
+	}
+	return status;
+}
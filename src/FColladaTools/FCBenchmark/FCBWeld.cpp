@@ -0,0 +1,286 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Welding benchmark: builds two soups of triangles over a height field with
+	a 1 cm spacing, as scanned by photogrammetry: each triangle has its own
+	positions, jittered within the welding tolerance, and its own texture
+	coordinates. The positions of the 128x128 soup, and of the meshes of each
+	document given on the command line, are welded through the former sorted
+	list and through the spatial hash. The former sorted list is quadratic, so
+	the 1024x1024 soup, of 6,279,174 positions, is only welded through the
+	spatial hash. The positions are restored before each run.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDGeometry.h"
+#include "FCDocument/FCDGeometryMesh.h"
+#include "FCDocument/FCDGeometryPolygons.h"
+#include "FCDocument/FCDGeometryPolygonsInput.h"
+#include "FCDocument/FCDGeometryPolygonsTools.h"
+#include "FCDocument/FCDGeometrySource.h"
+#include "FCDocument/FCDLibrary.h"
+#include <cstdio>
+
+static const size_t smallSoupSize = 128;
+static const size_t largeSoupSize = 1024;
+static const float soupSpacing = 0.01f;
+
+// The former implementation, which kept the welded positions sorted on X.
+namespace FormerWeld
+{
+	static uint32 CompressSortedVector(FMVector3& toInsert, FloatList& insertedList, UInt32List& compressIndexReferences)
+	{
+		// Look for this vector within the already inserted list.
+		size_t start = 0, end = compressIndexReferences.size(), mid;
+		for (mid = (start + end) / 2; start < end; mid = (start + end) / 2)
+		{
+			uint32 index = compressIndexReferences[mid];
+			if (toInsert.m_X == insertedList[3 * index]) break;
+			else if (toInsert.m_X < insertedList[3 * index]) end = mid;
+			else start = mid + 1;
+		}
+
+		// Look for the tolerable range within the binary-sorted dimension.
+		size_t rangeStart, rangeEnd;
+		for (rangeStart = mid; rangeStart > 0; --rangeStart)
+		{
+			uint32 index = compressIndexReferences[rangeStart - 1];
+			if (!IsEquivalent(insertedList[3 * index], toInsert.m_X)) break;
+		}
+		for (rangeEnd = min(mid + 1, compressIndexReferences.size()); rangeEnd < compressIndexReferences.size(); ++rangeEnd)
+		{
+			uint32 index = compressIndexReferences[rangeEnd];
+			if (!IsEquivalent(insertedList[3 * index], toInsert.m_X)) break;
+		}
+		FUAssert(rangeStart < rangeEnd || (rangeStart == rangeEnd && rangeEnd == compressIndexReferences.size()), return 0);
+
+		// Look for an equivalent vector within the tolerable range
+		for (size_t g = rangeStart; g < rangeEnd; ++g)
+		{
+			uint32 index = compressIndexReferences[g];
+			if (IsEquivalent(toInsert, *(const FMVector3*) &insertedList[3 * index])) return index;
+		}
+
+		// Insert this new vector in the list and add the index reference at the correct position.
+		uint32 compressIndex = (uint32) (insertedList.size() / 3);
+		compressIndexReferences.insert(compressIndexReferences.begin() + mid, compressIndex);
+		insertedList.push_back(toInsert.m_X);
+		insertedList.push_back(toInsert.m_Y);
+		insertedList.push_back(toInsert.m_Z);
+		return compressIndex;
+	}
+
+	static void WeldSource(FCDGeometryMesh* mesh, FCDGeometrySource* source)
+	{
+		FloatList weldedData;
+		UInt32List references, remap;
+		size_t valueCount = source->GetValueCount();
+		remap.reserve(valueCount);
+		const float* data = source->GetData();
+		for (size_t i = 0; i < valueCount; ++i)
+		{
+			FMVector3 position(data + 3 * i);
+			remap.push_back(CompressSortedVector(position, weldedData, references));
+		}
+
+		for (size_t p = 0; p < mesh->GetPolygonsCount(); ++p)
+		{
+			FCDGeometryPolygonsInput* input = mesh->GetPolygons(p)->FindInput(source);
+			if (input == nullptr) continue;
+			uint32* indices = input->GetIndices();
+			size_t indexCount = input->GetIndexCount();
+			for (size_t i = 0; i < indexCount; ++i) indices[i] = remap[indices[i]];
+		}
+		source->SetData(weldedData, 3);
+	}
+};
+
+// A source to weld, with its data and the indices of its inputs, restored before each run.
+struct WeldedSource
+{
+	FCDGeometryMesh* mesh;
+	FCDGeometrySource* source;
+	FloatList data;
+	FCDNewIndicesList indices; // One list per polygons set.
+};
+typedef fm::vector<WeldedSource> WeldedSourceList;
+
+static void AddWeldedSource(FCDGeometryMesh* mesh, FCDGeometrySource* source, WeldedSourceList& sources)
+{
+	if (source == nullptr || source->GetStride() != 3 || source->GetValueCount() == 0) return;
+	sources.push_back(WeldedSource());
+	WeldedSource& welded = sources.back();
+	welded.mesh = mesh;
+	welded.source = source;
+	welded.data.insert(welded.data.end(), source->GetData(), source->GetData() + source->GetDataCount());
+	welded.indices.resize(mesh->GetPolygonsCount());
+	for (size_t p = 0; p < mesh->GetPolygonsCount(); ++p)
+	{
+		FCDGeometryPolygonsInput* input = mesh->GetPolygons(p)->FindInput(source);
+		if (input != nullptr) welded.indices[p].insert(welded.indices[p].end(), input->GetIndices(), input->GetIndices() + input->GetIndexCount());
+	}
+}
+
+static void RestoreSource(WeldedSource& welded)
+{
+	welded.source->SetData(welded.data, 3);
+	for (size_t p = 0; p < welded.indices.size(); ++p)
+	{
+		FCDGeometryPolygonsInput* input = welded.mesh->GetPolygons(p)->FindInput(welded.source);
+		if (input != nullptr) input->SetIndices(welded.indices[p].begin(), welded.indices[p].size());
+	}
+}
+
+static void BuildSoup(FCDocument* document, size_t soupSize, WeldedSourceList& sources)
+{
+	FCDGeometry* geometry = document->GetGeometryLibrary()->AddEntity();
+	FCDGeometryMesh* mesh = geometry->CreateMesh();
+
+	size_t cornerCount = 6 * (soupSize - 1) * (soupSize - 1);
+	FloatList positions, texcoords;
+	positions.reserve(3 * cornerCount);
+	texcoords.reserve(2 * cornerCount);
+	uint32 seed = 1;
+	for (size_t y = 0; y + 1 < soupSize; ++y)
+	{
+		for (size_t x = 0; x + 1 < soupSize; ++x)
+		{
+			static const size_t corners[6][2] = { { 0, 0 }, { 0, 1 }, { 1, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } };
+			for (size_t c = 0; c < 6; ++c)
+			{
+				size_t cx = x + corners[c][0], cy = y + corners[c][1];
+				float height = 0.2f * sinf(0.013f * (float) cx) * cosf(0.011f * (float) cy);
+				float position[3] = { soupSpacing * (float) cx, soupSpacing * (float) cy, height };
+				for (size_t k = 0; k < 3; ++k)
+				{
+					seed = seed * 1664525 + 1013904223;
+					positions.push_back(position[k] + ((float) ((seed >> 8) % 1001) / 1000.0f - 0.5f) * 0.4f * FLT_TOLERANCE);
+				}
+				texcoords.push_back((float) cx / (float) soupSize); texcoords.push_back((float) cy / (float) soupSize);
+			}
+		}
+	}
+	FCDGeometrySource* positionSource = mesh->AddVertexSource(FUDaeGeometryInput::POSITION);
+	positionSource->SetData(positions, 3);
+	FCDGeometrySource* texcoordSource = mesh->AddSource(FUDaeGeometryInput::TEXCOORD);
+	texcoordSource->SetData(texcoords, 2);
+
+	UInt32List indices;
+	indices.reserve(cornerCount);
+	for (uint32 i = 0; i < (uint32) cornerCount; ++i) indices.push_back(i);
+	FCDGeometryPolygons* polygons = mesh->AddPolygons();
+	polygons->AddInput(texcoordSource, 1);
+	polygons->FindInput(positionSource)->SetIndices(indices.begin(), indices.size());
+	polygons->FindInput(texcoordSource)->SetIndices(indices.begin(), indices.size());
+	for (size_t f = 0; f < cornerCount / 3; ++f) polygons->AddFaceVertexCount(3);
+	mesh->Recalculate();
+	AddWeldedSource(mesh, positionSource, sources);
+}
+
+static void ListSources(FCDocument* document, WeldedSourceList& sources)
+{
+	FCDGeometryLibrary* library = document->GetGeometryLibrary();
+	for (size_t i = 0; i < library->GetEntityCount(); ++i)
+	{
+		FCDGeometry* geometry = library->GetEntity(i);
+		if (!geometry->IsMesh()) continue;
+		FCDGeometryMesh* mesh = geometry->GetMesh();
+		AddWeldedSource(mesh, mesh->FindSourceByType(FUDaeGeometryInput::POSITION), sources);
+	}
+}
+
+// Measures the average time taken to weld the sources, and counts their welded values.
+static bool MeasureWeld(WeldedSourceList& sources, bool former, uint32 iterations, double& seconds, size_t& weldedCount)
+{
+	seconds = 0.0;
+	bool status = true;
+	for (uint32 i = 0; i < iterations; ++i)
+	{
+		weldedCount = 0;
+		for (WeldedSource* it = sources.begin(); it != sources.end(); ++it)
+		{
+			RestoreSource(*it);
+			double start = GetBenchmarkTime();
+			if (former) FormerWeld::WeldSource(it->mesh, it->source);
+			else status &= FCDGeometryPolygonsTools::WeldSource(it->mesh, it->source);
+			seconds += GetBenchmarkTime() - start;
+			weldedCount += it->source->GetValueCount();
+		}
+	}
+	seconds /= (double) max(iterations, 1u);
+	return status;
+}
+
+static void PrintWeld(const char* variant, const fstring& name, double seconds, size_t valueCount, size_t weldedCount)
+{
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %12.3f ms %10.2f Mpositions/s, %u positions welded into %u", "weld", variant, TO_STRING(name).c_str(),
+		seconds * 1000.0, (seconds > 0.0) ? (double) valueCount / seconds / 1000000.0 : 0.0, (uint32) valueCount, (uint32) weldedCount);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+}
+
+static bool MeasureSources(WeldedSourceList& sources, const fstring& name, bool measureFormer, const BenchmarkOptions& options)
+{
+	size_t valueCount = 0;
+	for (WeldedSource* it = sources.begin(); it != sources.end(); ++it) valueCount += it->data.size() / 3;
+
+	double formerSeconds = 0.0, gridSeconds = 0.0;
+	size_t formerCount = 0, gridCount = 0;
+	bool status = true;
+	if (measureFormer) MeasureWeld(sources, true, options.iterations, formerSeconds, formerCount);
+	status &= MeasureWeld(sources, false, options.iterations, gridSeconds, gridCount);
+	if (!status)
+	{
+		std::cout << "weld: could not weld " << TO_STRING(name).c_str() << std::endl;
+		return false;
+	}
+
+	if (measureFormer) PrintWeld("former", name, formerSeconds, valueCount, formerCount);
+	PrintWeld("grid", name, gridSeconds, valueCount, gridCount);
+	if (measureFormer)
+	{
+		char line[1024];
+		snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.2f x former", "weld", "speedup", TO_STRING(name).c_str(), (gridSeconds > 0.0) ? formerSeconds / gridSeconds : 0.0);
+		line[sizeof(line) - 1] = 0;
+		std::cout << line << std::endl;
+	}
+	return true;
+}
+
+bool BenchmarkWeld(const FilenameList& filenames, const BenchmarkOptions& options)
+{
+	FCDocument* document = FCollada::NewTopDocument();
+	WeldedSourceList sources;
+	BuildSoup(document, smallSoupSize, sources);
+	bool status = MeasureSources(sources, FC("soup-128x128"), true, options);
+	sources.clear();
+	BuildSoup(document, largeSoupSize, sources);
+	status &= MeasureSources(sources, FC("soup-1024x1024"), false, options);
+	sources.clear();
+	SAFE_RELEASE(document);
+
+	for (const fstring* it = filenames.begin(); it != filenames.end(); ++it)
+	{
+		FUErrorSimpleHandler errorHandler;
+		document = FCollada::NewTopDocument();
+		if (!FCollada::LoadDocumentFromFile(document, it->c_str()) || !errorHandler.IsSuccessful())
+		{
+			std::cout << "weld: could not load " << TO_STRING(*it).c_str() << std::endl;
+			status = false;
+		}
+		else
+		{
+			sources.clear();
+			ListSources(document, sources);
+			status &= MeasureSources(sources, *it, true, options);
+		}
+		SAFE_RELEASE(document);
+	}
+	return status;
+}
@@ -0,0 +1,137 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	World transform benchmark: builds a visual scene of 50,000 scene nodes, where
+	each scene node has three children and a translation, a rotation and a scale.
+	The world transform of every scene node is retrieved through the former
+	uncached implementation, then through the cache: once right after the root
+	transform changes, which recomputes every world transform, and once more
+	with all the world transforms cached. The bulk update of all the world
+	transforms after the root transform changes is measured on its own.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include "FCDocument/FCDocument.h"
+#include "FCDocument/FCDSceneNode.h"
+#include "FCDocument/FCDSceneNodeTools.h"
+#include "FCDocument/FCDTransform.h"
+#include "FUtils/FUThreadPool.h"
+#include <cstdio>
+
+static const size_t sceneNodeCount = 50000;
+static const size_t childrenPerNode = 3;
+
+struct WorldData
+{
+	FCDocument* document;
+	FCDSceneNode* root;
+	FCDTTranslation* rootTranslation;
+	fm::pvector<FCDSceneNode> nodes;
+	float sum;
+};
+
+static void BuildScene(WorldData& data)
+{
+	data.document = FCollada::NewTopDocument();
+	data.root = data.document->AddVisualScene();
+	data.rootTranslation = (FCDTTranslation*) data.root->AddTransform(FCDTransform::TRANSLATION);
+	data.nodes.clear();
+	data.nodes.reserve(sceneNodeCount);
+	data.nodes.push_back(data.root);
+	for (size_t i = 1; i < sceneNodeCount; ++i)
+	{
+		FCDSceneNode* node = data.nodes[(i - 1) / childrenPerNode]->AddChildNode();
+		float f = (float) i;
+		((FCDTTranslation*) node->AddTransform(FCDTransform::TRANSLATION))->SetTranslation(f * 0.01f, 1.0f, -0.5f);
+		((FCDTRotation*) node->AddTransform(FCDTransform::ROTATION))->SetRotation(FMVector3::YAxis, f * 0.1f);
+		((FCDTScale*) node->AddTransform(FCDTransform::SCALE))->SetScale(1.0f, 0.99f, 1.01f);
+		data.nodes.push_back(node);
+	}
+}
+
+// The former FCDSceneNode::CalculateWorldTransform implementation.
+static FMMatrix44 FormerCalculateWorldTransform(const FCDSceneNode* node)
+{
+	const FCDSceneNode* parent = node->GetParent();
+	if (parent != nullptr) return FormerCalculateWorldTransform(parent) * node->ToMatrix();
+	else return node->ToMatrix();
+}
+
+static void MoveRoot(WorldData* data)
+{
+	data->rootTranslation->SetTranslation(data->sum * 1e-30f, 0.0f, 0.0f);
+}
+
+static bool WorldFormer(void* userData)
+{
+	WorldData* data = (WorldData*) userData;
+	MoveRoot(data);
+	for (size_t i = 0; i < data->nodes.size(); ++i) data->sum += FormerCalculateWorldTransform(data->nodes[i])[3][0];
+	return data->sum == data->sum;
+}
+
+static bool WorldCold(void* userData)
+{
+	WorldData* data = (WorldData*) userData;
+	MoveRoot(data);
+	for (size_t i = 0; i < data->nodes.size(); ++i) data->sum += data->nodes[i]->CalculateWorldTransform()[3][0];
+	return data->sum == data->sum;
+}
+
+static bool WorldWarm(void* userData)
+{
+	WorldData* data = (WorldData*) userData;
+	for (size_t i = 0; i < data->nodes.size(); ++i) data->sum += data->nodes[i]->CalculateWorldTransform()[3][0];
+	return data->sum == data->sum;
+}
+
+static bool WorldUpdate(void* userData)
+{
+	WorldData* data = (WorldData*) userData;
+	MoveRoot(data);
+	return FCDSceneNodeTools::UpdateWorldTransforms(data->root) == data->nodes.size();
+}
+
+bool BenchmarkWorld(const FilenameList& UNUSED(filenames), const BenchmarkOptions& options)
+{
+	WorldData data;
+	data.sum = 0.0f;
+	BuildScene(data);
+
+	fstring name = FC("50000-nodes");
+	BenchmarkMeasure formerMeasure, coldMeasure, warmMeasure, updateMeasure;
+	bool status = RunMeasured(WorldFormer, &data, options.iterations, formerMeasure);
+	status &= RunMeasured(WorldCold, &data, options.iterations, coldMeasure);
+	FCDSceneNodeTools::UpdateWorldTransforms(data.root);
+	status &= RunMeasured(WorldWarm, &data, options.iterations, warmMeasure);
+	status &= RunMeasured(WorldUpdate, &data, options.iterations, updateMeasure);
+
+	// The cached world transforms must match the former ones.
+	FCDSceneNodeTools::UpdateWorldTransforms(data.root);
+	for (size_t i = 0; i < data.nodes.size() && status; ++i)
+	{
+		status = IsEquivalent(data.nodes[i]->CalculateWorldTransform(), FormerCalculateWorldTransform(data.nodes[i]));
+	}
+	SAFE_RELEASE(data.document);
+	if (!status)
+	{
+		std::cout << "world: could not measure " << TO_STRING(name).c_str() << std::endl;
+		return false;
+	}
+
+	PrintMeasure("world", "former", name, formerMeasure);
+	PrintMeasure("world", "cached-cold", name, coldMeasure);
+	PrintMeasure("world", "cached-warm", name, warmMeasure);
+	PrintMeasure("world", "update", name, updateMeasure);
+
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %10.2f x former, on %u threads", "world", "speedup", TO_STRING(name).c_str(),
+		(updateMeasure.seconds > 0.0) ? formerMeasure.seconds / updateMeasure.seconds : 0.0, (uint32) FUThreadPool::GetProcessorCount());
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+	return true;
+}
@@ -0,0 +1,197 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	FCBenchmark measures the time and memory taken by the FCollada
+	operations on a set of COLLADA documents.
+*/
+
+#include "StdAfx.h"
+#include "FCBenchmark.h"
+#include <chrono>
+#include <cstdio>
+
+#ifdef WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+struct BenchmarkEntry
+{
+	const char* name;
+	const char* description;
+	bool (*function)(const FilenameList& filenames, const BenchmarkOptions& options);
+};
+
+static const BenchmarkEntry benchmarks[] =
+{
+	{ "animation", "Compares the evaluation of each animated with the serial and the parallel animation programs.", BenchmarkAnimation },
+	{ "arena", "Compares loading and releasing the documents with the objects allocated from the heap and from a document arena.", BenchmarkArena },
+	{ "bake", "Compares the former, the reentrant and the parallel baking of the bones of a rig.", BenchmarkBake },
+	{ "binary", "Compares loading the documents and their binary archives.", BenchmarkBinary },
+	{ "curves", "Measures building, loading and evaluating a dense animation curve set.", BenchmarkCurves },
+	{ "export", "Compares saving the documents through the whole XML tree and streamed.", BenchmarkExport },
+	{ "find", "Compares the indexed and the former linear look-ups of the entity ids.", BenchmarkFind },
+	{ "import", "Compares the DOM, the streaming and the parallel import of the documents.", BenchmarkImport },
+	{ "link", "Measures linking the animation channels of generated documents.", BenchmarkLink },
+	{ "matrix", "Compares the FMMatrix44 kernels with their former scalar implementations.", BenchmarkMatrix },
+	{ "morph", "Compares a dense blend of 256 morph targets with the serial and the parallel morph deformer.", BenchmarkMorph },
+	{ "numbers", "Compares the per-value and the bulk conversions of the numeric lists.", BenchmarkNumbers },
+	{ "read", "Compares reading and parsing the documents through a buffer and through the mapped file.", BenchmarkRead },
+	{ "reduce", "Measures reducing the keys of baked motion capture curves.", BenchmarkReduce },
+	{ "sampling", "Compares the single, the cursor and the batch evaluations of animation curves.", BenchmarkSampling },
+	{ "skin", "Compares the former skinning loop with the serial and the parallel skin deformer.", BenchmarkSkin },
+	{ "unique", "Compares the former and the current generation of unique index buffers and translation maps.", BenchmarkUnique },
+	{ "weld", "Compares the former and the spatial hash welding of the positions of triangle soups.", BenchmarkWeld },
+	{ "world", "Compares the former and the cached world transforms of a large visual scene.", BenchmarkWorld },
+};
+static const size_t benchmarkCount = sizeof(benchmarks) / sizeof(*benchmarks);
+
+void PrintUsage()
+{
+	std::cout << "FCBenchmark.exe [-n iterations] <benchmark> <input_filename> [<input_filename> ...]" << std::endl;
+	std::cout << "-n The number of times each measured operation is repeated. Defaults to 5." << std::endl;
+	std::cout << "Available benchmarks:" << std::endl;
+	for (size_t i = 0; i < benchmarkCount; ++i)
+	{
+		std::cout << "  " << benchmarks[i].name << ": " << benchmarks[i].description << std::endl;
+	}
+	std::cout << "  all: Runs all the benchmarks." << std::endl;
+}
+
+int main(int argc, const char* argv[])
+{
+	BenchmarkOptions options;
+	options.iterations = 5;
+	const char* benchmarkName = nullptr;
+	FilenameList filenames;
+
+	// parse the arguments
+	for (int argCounter = 1; argCounter < argc; ++argCounter)
+	{
+		if (IsEquivalent(argv[argCounter], "-n") && argCounter + 1 < argc)
+		{
+			options.iterations = max(FUStringConversion::ToUInt32(argv[++argCounter]), (uint32) 1);
+		}
+		else if (argv[argCounter][0] == '-')
+		{
+			PrintUsage();
+			return -1;
+		}
+		else if (benchmarkName == nullptr) benchmarkName = argv[argCounter];
+		else filenames.push_back(TO_FSTRING(argv[argCounter]));
+	}
+	if (benchmarkName == nullptr || filenames.empty())
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	FCollada::Initialize();
+
+	bool found = false, status = true;
+	for (size_t i = 0; i < benchmarkCount; ++i)
+	{
+		if (IsEquivalent(benchmarkName, "all") || IsEquivalent(benchmarkName, benchmarks[i].name))
+		{
+			found = true;
+			status &= (*benchmarks[i].function)(filenames, options);
+		}
+	}
+	if (!found) PrintUsage();
+
+	FCollada::Release();
+	return (found && status) ? 0 : -1;
+}
+
+double GetBenchmarkTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool RunTimed(MeasuredFunction function, void* userData, uint32 iterations, double& seconds)
+{
+	bool status = true;
+	double start = GetBenchmarkTime();
+	for (uint32 i = 0; i < iterations; ++i)
+	{
+		status &= (*function)(userData);
+	}
+	seconds = (GetBenchmarkTime() - start) / iterations;
+	return status;
+}
+
+bool RunMeasured(MeasuredFunction function, void* userData, uint32 iterations, BenchmarkMeasure& measure)
+{
+	measure.seconds = 0.0;
+	measure.peakMemory = 0;
+
+#ifdef WIN32
+	// Windows: measure in-process. The peak memory includes the earlier operations.
+	bool status = RunTimed(function, userData, iterations, measure.seconds);
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		measure.peakMemory = counters.PeakWorkingSetSize / 1024;
+	}
+	return status;
+#else
+	// POSIX: run the operation in a child process, which reports its timing through a pipe.
+	int fds[2];
+	if (pipe(fds) != 0) return false;
+	fflush(stdout);
+	std::cout.flush();
+
+	pid_t pid = fork();
+	if (pid < 0) { close(fds[0]); close(fds[1]); return false; }
+	if (pid == 0)
+	{
+		close(fds[0]);
+		double seconds = 0.0;
+		bool status = RunTimed(function, userData, iterations, seconds);
+		ssize_t written = write(fds[1], &seconds, sizeof(seconds));
+		close(fds[1]);
+		_exit((status && written == sizeof(seconds)) ? 0 : 1);
+	}
+
+	close(fds[1]);
+	bool status = read(fds[0], &measure.seconds, sizeof(measure.seconds)) == sizeof(measure.seconds);
+	close(fds[0]);
+
+	int exitStatus = 0;
+	struct rusage usage;
+	if (wait4(pid, &exitStatus, 0, &usage) != pid) return false;
+#ifdef __APPLE__
+	measure.peakMemory = (size_t) usage.ru_maxrss / 1024; // bytes on MacOSX
+#else
+	measure.peakMemory = (size_t) usage.ru_maxrss; // kilobytes on Linux
+#endif
+	return status && WIFEXITED(exitStatus) && WEXITSTATUS(exitStatus) == 0;
+#endif // WIN32
+}
+
+void PrintMeasure(const char* benchmark, const char* variant, const fstring& filename, const BenchmarkMeasure& measure)
+{
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %12.3f ms %10u KB", benchmark, variant,
+		TO_STRING(filename).c_str(), measure.seconds * 1000.0, (uint32) measure.peakMemory);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+}
+
+void PrintThroughput(const char* benchmark, const char* variant, const fstring& filename, const BenchmarkMeasure& measure, size_t byteCount)
+{
+	double megabytes = (double) byteCount / (1024.0 * 1024.0);
+	char line[1024];
+	snprintf(line, sizeof(line), "%-10s %-14s %-40s %12.3f ms %10.1f MB/s", benchmark, variant,
+		TO_STRING(filename).c_str(), measure.seconds * 1000.0, (measure.seconds > 0.0) ? megabytes / measure.seconds : 0.0);
+	line[sizeof(line) - 1] = 0;
+	std::cout << line << std::endl;
+}
@@ -0,0 +1,129 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+/*
+	Shared helpers for the FCBenchmark tool.
+	Each benchmark is a function that takes the list of COLLADA documents
+	given on the command line and prints out its measurements.
+*/
+
+#ifndef _FC_BENCHMARK_H_
+#define _FC_BENCHMARK_H_
+
+typedef fm::vector<fstring> FilenameList;
+
+/** The options shared by all the benchmarks. */
+struct BenchmarkOptions
+{
+	uint32 iterations; /**< The number of times each measured operation is repeated. */
+};
+
+/** A measured operation. Returns whether the operation succeeded. */
+typedef bool (*MeasuredFunction)(void* userData);
+
+/** The measurements taken while running a measured operation. */
+struct BenchmarkMeasure
+{
+	double seconds; /**< The average wall-clock time of one run. */
+	size_t peakMemory; /**< The peak resident memory, in kilobytes. Zero when unavailable. */
+};
+
+/** Retrieves a monotonic wall-clock time, in seconds. */
+double GetBenchmarkTime();
+
+/** Runs an operation a number of times and measures it.
+	On POSIX systems, the operation runs in a separate process so that
+	the peak resident memory is measured for this operation alone.
+	@param function The operation to measure.
+	@param userData The data given to the operation.
+	@param iterations The number of times to run the operation.
+	@param measure The measurements.
+	@return Whether all the runs of the operation succeeded. */
+bool RunMeasured(MeasuredFunction function, void* userData, uint32 iterations, BenchmarkMeasure& measure);
+
+/** Prints out one line of measurements. */
+void PrintMeasure(const char* benchmark, const char* variant, const fstring& filename, const BenchmarkMeasure& measure);
+
+/** Prints out one line of throughput measurements.
+	@param byteCount The number of bytes processed by one run of the operation. */
+void PrintThroughput(const char* benchmark, const char* variant, const fstring& filename, const BenchmarkMeasure& measure, size_t byteCount);
+
+//
+// Benchmarks
+//
+
+/** Compares playing back a scene of 100,000 animation channels by evaluating each FCDAnimated
+	with playing it back through the animation program of the document, serially and in parallel. */
+bool BenchmarkAnimation(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares loading and releasing a generated document of 50,000 scene nodes and the
+	documents, with the objects allocated from the heap and from a document arena. */
+bool BenchmarkArena(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares baking the local transforms of the 300 bones of a rig with the former
+	FCDSceneNodeTools::GenerateSampledAnimation, with the reentrant one and in parallel. */
+bool BenchmarkBake(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares loading the COLLADA documents with loading their FArchiveBinary archives. */
+bool BenchmarkBinary(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Measures building, loading and evaluating 2,000 animation curves of 1,000 keys each:
+	the time, the peak memory and the evaluation rate. */
+bool BenchmarkCurves(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares the whole-tree and the streaming export paths of FArchiveXML. */
+bool BenchmarkExport(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares the indexed and the former linear look-ups of the entity ids,
+	on a synthetic 100,000-entity document and on the documents. */
+bool BenchmarkFind(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares the DOM, the streaming and the parallel import paths of FArchiveXML. */
+bool BenchmarkImport(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Measures the time taken by FArchiveXML to link the animation channels,
+	on synthetic documents with up to 50,000 channels. */
+bool BenchmarkLink(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares the FMMatrix44 multiplication, inverse, determinant and point transform
+	with their former scalar implementations, and measures the batch entry points. */
+bool BenchmarkMatrix(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares a dense loop over the morph target geometries with the morph deformer,
+	serial and parallel, on a grid of 16,384 vertices with 256 sparse morph targets. */
+bool BenchmarkMorph(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares the per-value and the bulk conversions of the numeric lists. */
+bool BenchmarkNumbers(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares reading and parsing the documents through a buffer and through the mapped file,
+	on a large generated document and on the documents. */
+bool BenchmarkRead(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Reduces the keys of the baked motion capture of a 300-bone rig, one curve after the other
+	and in parallel, and compares playing back the curves before and after the reduction. */
+bool BenchmarkReduce(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares the single, the cursor and the batch evaluations of 10,000 animation curves
+	sampled at 30 frames per second over 10 minutes, and of their multi-dimensional merges. */
+bool BenchmarkSampling(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares the former loop over the vertex influences of a skin controller with the skin
+	deformer, serial and parallel, on a cylinder of 204,800 vertices skinned to 64 joints. */
+bool BenchmarkSkin(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares the former generation of unique index buffers and translation maps with the current
+	one, and with the translation tables, on a grid of four polygons sets and on the given documents. */
+bool BenchmarkUnique(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares welding the positions of triangle soups through the former sorted list and through
+	the spatial hash of FCDGeometryPolygonsTools::WeldSource, up to 6,279,174 positions. */
+bool BenchmarkWeld(const FilenameList& filenames, const BenchmarkOptions& options);
+
+/** Compares the former and the cached world transforms of the 50,000 scene nodes
+	of a visual scene, and measures the bulk update of all the world transforms. */
+bool BenchmarkWorld(const FilenameList& filenames, const BenchmarkOptions& options);
+
+#endif // _FC_BENCHMARK_H_
@@ -0,0 +1,20 @@
+/*
+    Copyright (C) 2005-2007 Feeling Software Inc.
+    MIT License: http://www.opensource.org/licenses/mit-license.php
+*/
+
+#pragma once
+
+// Unlike the other tools, UNICODE is not forced here: the benchmarks
+// are built against the FCollada library configuration being measured.
+
+#ifndef WIN32
+#include <iostream>
+#endif
+
+#define NO_LIBXML
+#include "FCollada.h"
+
+#ifdef WIN32
+#include <iostream>
+#endif
@@ -31,6 +31,8 @@ struct ProcessMeshesOptions
 	bool fixModel;
 	bool textureTangents;
 	bool triangulate;
+	bool vertexCache;
+	bool overdraw;
 };
 
 void ProcessGeometryLibrary(FCDGeometryLibrary* library, const ProcessMeshesOptions& options);
@@ -39,10 +41,12 @@ void ProcessMesh(FCDGeometryMesh* mesh, const ProcessMeshesOptions& options);
 void PrintUsage()
 {
 	std::cout << "Expecting two arguments:" << std::endl;
-	std::cout << "FCProcessMeshes.exe [-fm][-t][-tt] <input_filename> <output_filename>" <<std::endl;
+	std::cout << "FCProcessMeshes.exe [-fm][-t][-tt][-vc][-od] <input_filename> <output_filename>" <<std::endl;
 	std::cout << "-fm Fix model for the viewer so there is less need for runtime processing." <<std::endl;
 	std::cout << "-t Triangulate the meshes." <<std::endl;
 	std::cout << "-tt Generate texture tangents for the meshes. This implies triangulating." <<std::endl;
+	std::cout << "-vc Reorder the triangles and the vertices for the vertex cache. This implies triangulating and unique indices." <<std::endl;
+	std::cout << "-od Also order the clusters of triangles to lower the overdraw. This implies -vc." <<std::endl;
 }
 
 int main(int argc, const char* argv[], char* envp[])
@@ -58,6 +62,8 @@ int main(int argc, const char* argv[], char* envp[])
 	options.fixModel = false;
 	options.textureTangents = false;
 	options.triangulate = false;
+	options.vertexCache = false;
+	options.overdraw = false;
 	fstring inputFilename;
 	fstring outputFilename;
 
@@ -79,6 +85,15 @@ int main(int argc, const char* argv[], char* envp[])
 			{
 				options.textureTangents = true;
 			}
+			else if (IsEquivalent(argv[argCounter], "-vc"))
+			{
+				options.vertexCache = true;
+			}
+			else if (IsEquivalent(argv[argCounter], "-od"))
+			{
+				options.vertexCache = true;
+				options.overdraw = true;
+			}
 			else
 			{
 				PrintUsage();
@@ -173,7 +188,7 @@ void ProcessGeometryLibrary(FCDGeometryLibrary* library, const ProcessMeshesOpti
 
 void ProcessMesh(FCDGeometryMesh* mesh, const ProcessMeshesOptions& options)
 {
-	if (options.triangulate || options.textureTangents)
+	if (options.triangulate || options.textureTangents || options.vertexCache)
 	{
 		FCDGeometryPolygonsTools::Triangulate(mesh);
 	}
@@ -189,9 +204,26 @@ void ProcessMesh(FCDGeometryMesh* mesh, const ProcessMeshesOptions& options)
 	}
 
 	// taken from FRMesh::TranslateFromFCD to determine what qualifies as fixedModel
-	if (options.fixModel)
+	if (options.fixModel || options.vertexCache)
 	{
 		FCDGeometryPolygonsTools::GenerateUniqueIndices(mesh);
+	}
+
+	if (options.vertexCache)
+	{
+		// Report the average cache miss ratio and the average transform to vertex ratio.
+		FCDVertexCacheStatistics before = FCDGeometryPolygonsTools::CalculateVertexCacheStatistics(mesh);
+		FCDGeometryPolygonsTools::OptimizeVertexCache(mesh, options.overdraw);
+		FCDVertexCacheStatistics after = FCDGeometryPolygonsTools::CalculateVertexCacheStatistics(mesh);
+		char statistics[1024];
+		snprintf(statistics, 1024, "%s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", mesh->GetParent()->GetDaeId().c_str(),
+			before.GetACMR(), after.GetACMR(), before.GetATVR(), after.GetATVR());
+		statistics[1023] = 0;
+		std::cout << statistics << std::endl;
+	}
+
+	if (options.fixModel)
+	{
 		FCDGeometryPolygonsTools::FitIndexBuffers(mesh, 1024*48); // 2 ^ 16 - 1: this is a hardware drawback.
 	}
 }